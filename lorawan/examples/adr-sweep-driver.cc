@@ -0,0 +1,285 @@
+/*
+ * Multi-run sweep driver that amortizes topology construction.
+ *
+ * Parameter sweeps launch adr-example dozens of times and re-pay process
+ * startup and topology construction for every point. This driver builds the
+ * channel, mobility, devices, gateways and network server once, then runs
+ * each point of the sweep in a forked worker. The workers inherit the
+ * immutable topology pages copy-on-write, so only the state a simulation
+ * actually touches is duplicated; at 50k devices this removes minutes of
+ * setup per point.
+ *
+ * Each worker sets its own RNG run number before Simulator::Run — random
+ * streams are instantiated lazily on first draw, so simulation-time
+ * randomness (channel loss, application jitter) differs per run even though
+ * the topology is shared. Workers report the LoraPacketTracker MAC-level
+ * summary of the measurement window over a pipe and the parent aggregates
+ * one line per run on standard output.
+ *
+ * Usage:
+ *   adr-sweep-driver --nDevices=400 --runs=20 --parallel=8
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/core-module.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/gateway-lora-phy.h"
+#include "ns3/hex-grid-position-allocator.h"
+#include "ns3/log.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-device-address-generator.h"
+#include "ns3/lora-helper.h"
+#include "ns3/lora-phy-helper.h"
+#include "ns3/lorawan-mac-helper.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/network-module.h"
+#include "ns3/network-server-helper.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/string.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("AdrSweepDriver");
+
+/**
+ * State of one in-flight worker process.
+ */
+struct Worker
+{
+    pid_t pid = -1;     //!< Process id of the forked worker
+    int pipeFd = -1;    //!< Read end of the worker's result pipe
+    uint64_t run = 0;   //!< RNG run number this worker simulates
+};
+
+/**
+ * Drain a worker's result pipe and print its lines prefixed with the run.
+ *
+ * @param worker The worker whose pipe to drain.
+ */
+void
+CollectWorkerOutput(const Worker& worker)
+{
+    std::string output;
+    char buffer[512];
+    ssize_t n;
+    while ((n = read(worker.pipeFd, buffer, sizeof(buffer))) > 0)
+    {
+        output.append(buffer, n);
+    }
+    close(worker.pipeFd);
+    std::cout << "run " << worker.run << " " << output;
+    if (!output.empty() && output.back() != '\n')
+    {
+        std::cout << std::endl;
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    bool adrEnabled = true;
+    int nDevices = 400;
+    int nPeriodsOf20Minutes = 20;
+    double sideLengthMeters = 10000;
+    int gatewayDistanceMeters = 5000;
+    double maxRandomLossDb = 10;
+    uint64_t runs = 10;
+    uint32_t parallel = 4;
+    std::string adrType = "ns3::AdrComponent";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("AdrEnabled", "Whether to enable Adaptive Data Rate (ADR)", adrEnabled);
+    cmd.AddValue("nDevices", "Number of devices to simulate", nDevices);
+    cmd.AddValue("PeriodsToSimulate", "Number of periods (20m) to simulate", nPeriodsOf20Minutes);
+    cmd.AddValue("sideLength",
+                 "Length (m) of the side of the rectangle nodes will be placed in",
+                 sideLengthMeters);
+    cmd.AddValue("gatewayDistance", "Distance (m) between gateways", gatewayDistanceMeters);
+    cmd.AddValue("maxRandomLoss",
+                 "Maximum amount (dB) of the random loss component",
+                 maxRandomLossDb);
+    cmd.AddValue("runs", "Number of RNG runs to sweep", runs);
+    cmd.AddValue("parallel", "Maximum number of concurrent workers", parallel);
+    cmd.Parse(argc, argv);
+
+    int gatewayRings = 2 + (std::sqrt(2) * sideLengthMeters) / (gatewayDistanceMeters);
+    int nGateways = 3 * gatewayRings * gatewayRings - 3 * gatewayRings + 1;
+
+    Config::SetDefault("ns3::EndDeviceLorawanMac::ADR", BooleanValue(true));
+
+    // Build the shared topology once: channel, mobility, devices, gateways
+    // and the network server. Everything below this point is inherited
+    // copy-on-write by the workers
+    ///////////////////////////////////////////////////////////////////////
+
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+
+    Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable>();
+    x->SetAttribute("Min", DoubleValue(0.0));
+    x->SetAttribute("Max", DoubleValue(maxRandomLossDb));
+
+    Ptr<RandomPropagationLossModel> randomLoss = CreateObject<RandomPropagationLossModel>();
+    randomLoss->SetAttribute("Variable", PointerValue(x));
+
+    loss->SetNext(randomLoss);
+
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    MobilityHelper mobilityEd;
+    MobilityHelper mobilityGw;
+    mobilityEd.SetPositionAllocator("ns3::RandomRectanglePositionAllocator",
+                                    "X",
+                                    PointerValue(CreateObjectWithAttributes<UniformRandomVariable>(
+                                        "Min",
+                                        DoubleValue(-sideLengthMeters),
+                                        "Max",
+                                        DoubleValue(sideLengthMeters))),
+                                    "Y",
+                                    PointerValue(CreateObjectWithAttributes<UniformRandomVariable>(
+                                        "Min",
+                                        DoubleValue(-sideLengthMeters),
+                                        "Max",
+                                        DoubleValue(sideLengthMeters))));
+    mobilityEd.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    Ptr<HexGridPositionAllocator> hexAllocator =
+        CreateObject<HexGridPositionAllocator>(gatewayDistanceMeters / 2);
+    mobilityGw.SetPositionAllocator(hexAllocator);
+    mobilityGw.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    LoraPhyHelper phyHelper = LoraPhyHelper();
+    phyHelper.SetChannel(channel);
+
+    LorawanMacHelper macHelper = LorawanMacHelper();
+
+    LoraHelper helper = LoraHelper();
+    helper.EnablePacketTracking();
+
+    NodeContainer gateways;
+    gateways.Create(nGateways);
+    mobilityGw.Install(gateways);
+
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, gateways);
+
+    NodeContainer endDevices;
+    endDevices.Create(nDevices);
+    mobilityEd.Install(endDevices);
+
+    uint8_t nwkId = 54;
+    uint32_t nwkAddr = 1864;
+    Ptr<LoraDeviceAddressGenerator> addrGen =
+        CreateObject<LoraDeviceAddressGenerator>(nwkId, nwkAddr);
+
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    macHelper.SetAddressGenerator(addrGen);
+    macHelper.SetRegion(LorawanMacHelper::EU);
+    helper.Install(phyHelper, macHelper, endDevices);
+
+    int appPeriodSeconds = 1200; // One packet every 20 minutes
+    PeriodicSenderHelper appHelper = PeriodicSenderHelper();
+    appHelper.SetPeriod(Seconds(appPeriodSeconds));
+    appHelper.Install(endDevices);
+
+    Ptr<Node> networkServer = CreateObject<Node>();
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+    P2PGwRegistration_t gwRegistration;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+    {
+        auto container = p2p.Install(networkServer, *gw);
+        auto serverP2PNetDev = DynamicCast<PointToPointNetDevice>(container.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, *gw);
+    }
+
+    NetworkServerHelper networkServerHelper;
+    networkServerHelper.EnableAdr(adrEnabled);
+    networkServerHelper.SetAdr(adrType);
+    networkServerHelper.SetGatewaysP2P(gwRegistration);
+    networkServerHelper.SetEndDevices(endDevices);
+    networkServerHelper.Install(networkServer);
+
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(gateways);
+
+    LoraPacketTracker& tracker = helper.GetPacketTracker();
+    Time simulationTime = Seconds(1200 * nPeriodsOf20Minutes);
+    Time windowStart = Seconds(1200 * (nPeriodsOf20Minutes - 2));
+    Time windowStop = Seconds(1200 * (nPeriodsOf20Minutes - 1));
+
+    // Run the sweep in forked workers sharing the topology copy-on-write
+    ///////////////////////////////////////////////////////////////////////
+
+    std::vector<Worker> active;
+    for (uint64_t run = 1; run <= runs; run++)
+    {
+        while (active.size() >= parallel)
+        {
+            // Reap the oldest worker before forking another
+            waitpid(active.front().pid, nullptr, 0);
+            CollectWorkerOutput(active.front());
+            active.erase(active.begin());
+        }
+
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            std::cerr << "pipe failed: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            std::cerr << "fork failed: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        if (pid == 0)
+        {
+            // Worker: simulate one run against the inherited topology and
+            // report the tracker summary over the pipe
+            close(fds[0]);
+            RngSeedManager::SetRun(run);
+
+            Simulator::Stop(simulationTime);
+            Simulator::Run();
+            Simulator::Destroy();
+
+            std::string summary = tracker.CountMacPacketsGlobally(windowStart, windowStop);
+            summary += "\n";
+            ssize_t written = write(fds[1], summary.data(), summary.size());
+            close(fds[1]);
+            _exit(written == static_cast<ssize_t>(summary.size()) ? 0 : 1);
+        }
+
+        close(fds[1]);
+        active.push_back(Worker{pid, fds[0], run});
+    }
+
+    for (const auto& worker : active)
+    {
+        waitpid(worker.pid, nullptr, 0);
+        CollectWorkerOutput(worker);
+    }
+
+    return 0;
+}
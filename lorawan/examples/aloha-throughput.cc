@@ -58,6 +58,11 @@ auto packetsSent = std::vector<int>(6, 0);
 /** Record received pkts by Data Rate (DR) [index 0 -> DR5, index 5 -> DR0]. */
 auto packetsReceived = std::vector<int>(6, 0);
 
+/** Offered packets of the current reporting interval, by SF [index 0 -> SF7]. */
+auto intervalSent = std::vector<int>(6, 0);
+/** Delivered packets of the current reporting interval, by SF [index 0 -> SF7]. */
+auto intervalReceived = std::vector<int>(6, 0);
+
 /**
  * Record the beginning of a transmission by an end device.
  *
@@ -71,6 +76,7 @@ OnTransmissionCallback(Ptr<const Packet> packet, uint32_t senderNodeId)
     LoraTag tag;
     packet->PeekPacketTag(tag);
     packetsSent.at(tag.GetSpreadingFactor() - 7)++;
+    intervalSent.at(tag.GetSpreadingFactor() - 7)++;
 }
 
 /**
@@ -86,16 +92,51 @@ OnPacketReceptionCallback(Ptr<const Packet> packet, uint32_t receiverNodeId)
     LoraTag tag;
     packet->PeekPacketTag(tag);
     packetsReceived.at(tag.GetSpreadingFactor() - 7)++;
+    intervalReceived.at(tag.GetSpreadingFactor() - 7)++;
+}
+
+/**
+ * Print the counters of the elapsed reporting interval and start a new one.
+ *
+ * Emitting (and flushing) results as the simulation progresses means a
+ * killed run still leaves every completed interval behind, and sweep
+ * wrappers can consume lines without waiting for a post-run scan.
+ *
+ * @param interval The reporting interval length.
+ */
+void
+ReportInterval(Time interval)
+{
+    std::cout << "interval " << Simulator::Now().GetSeconds() << "s sent=";
+    for (int i = 0; i < 6; i++)
+    {
+        std::cout << (i ? "," : "") << intervalSent.at(i);
+    }
+    std::cout << " received=";
+    for (int i = 0; i < 6; i++)
+    {
+        std::cout << (i ? "," : "") << intervalReceived.at(i);
+    }
+    std::cout << std::endl;
+
+    std::fill(intervalSent.begin(), intervalSent.end(), 0);
+    std::fill(intervalReceived.begin(), intervalReceived.end(), 0);
+
+    Simulator::Schedule(interval, &ReportInterval, interval);
 }
 
 int
 main(int argc, char* argv[])
 {
     std::string interferenceMatrix = "aloha";
+    double reportIntervalSeconds = 10;
 
     CommandLine cmd(__FILE__);
     cmd.AddValue("nDevices", "Number of end devices to include in the simulation", nDevices);
     cmd.AddValue("simulationTime", "Simulation Time (s)", simulationTimeSeconds);
+    cmd.AddValue("reportInterval",
+                 "Length (s) of the online throughput reporting intervals",
+                 reportIntervalSeconds);
     cmd.AddValue("interferenceMatrix",
                  "Interference matrix to use [aloha, goursaud]",
                  interferenceMatrix);
@@ -346,6 +387,11 @@ main(int argc, char* argv[])
 
     Simulator::Stop(appStopTime + Hours(1));
 
+    // First interval report; each report schedules the next one
+    Simulator::Schedule(Seconds(reportIntervalSeconds),
+                        &ReportInterval,
+                        Seconds(reportIntervalSeconds));
+
     NS_LOG_INFO("Running simulation...");
     Simulator::Run();
 
@@ -32,6 +32,7 @@
 #include "ns3/periodic-sender-helper.h"
 #include "ns3/pointer.h"
 #include "ns3/position-allocator.h"
+#include "ns3/propagation-loss-model.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
 
@@ -53,6 +54,10 @@ double simulationTimeSeconds = 600; //!< Scenario duration (s) in simulated time
 bool realisticChannelModel = false; //!< Whether to use a more realistic channel model with
                                     //!< Buildings and correlated shadowing
 
+bool scaleMode = false; //!< Whether to precompute the environment loss (building penetration and
+                        //!< shadowing) of every device-gateway pair during setup, instead of
+                        //!< re-evaluating the full chain on every packet
+
 int appPeriodSeconds = 600; //!< Duration (s) of the inter-transmission time of end devices
 
 // Output control
@@ -67,6 +72,10 @@ main(int argc, char* argv[])
     cmd.AddValue("realisticChannel",
                  "Whether to use a more realistic channel model",
                  realisticChannelModel);
+    cmd.AddValue("scale",
+                 "Use the realistic environment (buildings and shadowing) but cache the "
+                 "per-device environment loss at setup time, for large-scale runs",
+                 scaleMode);
     cmd.AddValue("simulationTime", "The time (s) for which to simulate", simulationTimeSeconds);
     cmd.AddValue("appPeriod",
                  "The period in seconds to be used by periodically transmitting applications",
@@ -126,19 +135,30 @@ main(int argc, char* argv[])
     loss->SetPathLossExponent(3.76);
     loss->SetReference(1, 7.7);
 
-    if (realisticChannelModel)
+    // In scale mode the environment chain is kept off the channel: it is only
+    // evaluated once per device-gateway pair during setup, and the cached
+    // values are fed back through a matrix loss model further down
+    Ptr<CorrelatedShadowingPropagationLossModel> environmentChain;
+    if (realisticChannelModel || scaleMode)
     {
         // Create the correlated shadowing component
         Ptr<CorrelatedShadowingPropagationLossModel> shadowing =
             CreateObject<CorrelatedShadowingPropagationLossModel>();
 
-        // Aggregate shadowing to the logdistance loss
-        loss->SetNext(shadowing);
-
         // Add the effect to the channel propagation loss
         Ptr<BuildingPenetrationLoss> buildingLoss = CreateObject<BuildingPenetrationLoss>();
 
         shadowing->SetNext(buildingLoss);
+
+        if (scaleMode)
+        {
+            environmentChain = shadowing;
+        }
+        else
+        {
+            // Aggregate shadowing to the logdistance loss
+            loss->SetNext(shadowing);
+        }
     }
 
     Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
@@ -238,7 +258,7 @@ main(int argc, char* argv[])
     double deltaY = 17;
     int gridWidth = 2 * radiusMeters / (xLength + deltaX);
     int gridHeight = 2 * radiusMeters / (yLength + deltaY);
-    if (!realisticChannelModel)
+    if (!realisticChannelModel && !scaleMode)
     {
         gridWidth = 0;
         gridHeight = 0;
@@ -282,6 +302,34 @@ main(int argc, char* argv[])
         myfile.close();
     }
 
+    /*******************************************************
+     *  Cache the environment loss of every device-gateway  *
+     *  pair (scale mode)                                   *
+     *******************************************************/
+
+    if (scaleMode)
+    {
+        // Evaluate the shadowing and building penetration chain once per
+        // device-gateway pair, now that positions and building information
+        // are final, and append the frozen values to the channel loss. Pairs
+        // not in the matrix (device to device) only see the log-distance loss
+        Ptr<MatrixPropagationLossModel> cachedLoss = CreateObject<MatrixPropagationLossModel>();
+        cachedLoss->SetDefaultLoss(0);
+        for (auto ed = endDevices.Begin(); ed != endDevices.End(); ++ed)
+        {
+            Ptr<MobilityModel> edMobility = (*ed)->GetObject<MobilityModel>();
+            for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+            {
+                Ptr<MobilityModel> gwMobility = (*gw)->GetObject<MobilityModel>();
+                double environmentDb = -environmentChain->CalcRxPower(0, edMobility, gwMobility);
+                cachedLoss->SetLoss(edMobility, gwMobility, environmentDb);
+            }
+        }
+        loss->SetNext(cachedLoss);
+        NS_LOG_INFO("Cached the environment loss of " << nDevices * nGateways
+                                                      << " device-gateway pairs");
+    }
+
     /**********************************************
      *  Set up the end device's spreading factor  *
      **********************************************/
@@ -0,0 +1,289 @@
+/*
+ * Microbenchmarks for the module's hot paths.
+ *
+ * Each benchmark times a tight loop around one of the operations that
+ * dominates large-scale runs and reports nanoseconds per iteration. Results
+ * are printed as a JSON document following the Google Benchmark schema
+ * ({"context": ..., "benchmarks": [...]}), so CI can store and diff the
+ * numbers run over run; the harness itself is a plain steady_clock loop to
+ * keep the module free of external dependencies.
+ *
+ * Covered paths:
+ *   - LoraChannel::Send fan-out at N connected receivers
+ *   - LoraInterferenceHelper::IsDestroyedByInterference at k overlapping
+ *     events
+ *   - LoraFrameHeader serialization and deserialization
+ *   - AdrComponent and ADRoptComponent decision time on a full history
+ *   - LoraPacketTracker MAC transmission insertion
+ *
+ * Usage:
+ *   lorawan-bench [--benchmark=<substring>]
+ */
+
+#include "ns3/adr-component.h"
+#include "ns3/adropt-component.h"
+#include "ns3/class-a-end-device-lorawan-mac.h"
+#include "ns3/command-line.h"
+#include "ns3/core-module.h"
+#include "ns3/end-device-status.h"
+#include "ns3/lora-channel.h"
+#include "ns3/lora-frame-header.h"
+#include "ns3/lora-interference-helper.h"
+#include "ns3/lora-packet-tracker.h"
+#include "ns3/lora-tag.h"
+#include "ns3/lorawan-mac-header.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-status.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simple-end-device-lora-phy.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+using namespace lorawan;
+
+NS_LOG_COMPONENT_DEFINE("LorawanBench");
+
+/// Result of one timed benchmark.
+struct BenchResult
+{
+    std::string name;   //!< Benchmark name, including the size parameter.
+    uint64_t iterations; //!< Number of iterations timed.
+    double nsPerIter;   //!< Wall-clock nanoseconds per iteration.
+};
+
+std::vector<BenchResult> g_results; //!< All results, printed as JSON at exit.
+std::string g_filter;               //!< Substring filter from the command line.
+
+/**
+ * Time a callable over the given number of iterations and record the result.
+ *
+ * @param name The benchmark name.
+ * @param iterations How many times to invoke the body.
+ * @param body The operation under test.
+ */
+template <typename Body>
+void
+RunBench(const std::string& name, uint64_t iterations, Body body)
+{
+    if (!g_filter.empty() && name.find(g_filter) == std::string::npos)
+    {
+        return;
+    }
+
+    // One untimed warmup pass populates caches and lazy structures
+    body();
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        body();
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    double totalNs = std::chrono::duration<double, std::nano>(stop - start).count();
+    g_results.push_back(BenchResult{name, iterations, totalNs / iterations});
+    std::cerr << name << ": " << totalNs / iterations << " ns/iter" << std::endl;
+}
+
+/**
+ * Benchmark LoraChannel::Send delivering to nReceivers connected PHYs.
+ *
+ * @param nReceivers The number of receiving PHYs on the channel.
+ */
+void
+BenchChannelSendFanout(uint32_t nReceivers)
+{
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    Ptr<SimpleEndDeviceLoraPhy> sender = CreateObject<SimpleEndDeviceLoraPhy>();
+    Ptr<ConstantPositionMobilityModel> senderMobility =
+        CreateObject<ConstantPositionMobilityModel>();
+    sender->SetMobility(senderMobility);
+    channel->Add(sender);
+
+    // Receivers on a spiral out to ~5 km, so distances are heterogeneous
+    for (uint32_t j = 0; j < nReceivers; j++)
+    {
+        Ptr<SimpleEndDeviceLoraPhy> receiver = CreateObject<SimpleEndDeviceLoraPhy>();
+        Ptr<ConstantPositionMobilityModel> mobility =
+            CreateObject<ConstantPositionMobilityModel>();
+        double radius = 100 + 5000.0 * j / nReceivers;
+        mobility->SetPosition(
+            Vector(radius * std::cos(0.1 * j), radius * std::sin(0.1 * j), 0));
+        receiver->SetMobility(mobility);
+        channel->Add(receiver);
+    }
+
+    Ptr<Packet> packet = Create<Packet>(23);
+    LoraTxParameters txParams;
+
+    RunBench("ChannelSendFanout/" + std::to_string(nReceivers), 100, [&] {
+        channel->Send(sender, packet, 14, txParams, MilliSeconds(50), 868100000);
+    });
+
+    // Drop the reception events Send scheduled
+    Simulator::Destroy();
+}
+
+/**
+ * Benchmark IsDestroyedByInterference against k overlapping events.
+ *
+ * @param nEvents The number of interfering events tracked by the helper.
+ */
+void
+BenchInterference(uint32_t nEvents)
+{
+    LoraInterferenceHelper helper;
+    Ptr<Packet> packet = Create<Packet>(23);
+
+    Ptr<LoraInterferenceHelper::Event> event =
+        helper.Add(MilliSeconds(100), -120, 7, packet, 868100000);
+    for (uint32_t k = 1; k < nEvents; k++)
+    {
+        // All on the same frequency, cycling over the spreading factors
+        helper.Add(MilliSeconds(100), -115 - double(k % 10), 7 + k % 6, packet, 868100000);
+    }
+
+    RunBench("InterferenceOverlap/" + std::to_string(nEvents), 1000, [&] {
+        helper.IsDestroyedByInterference(event);
+    });
+
+    Simulator::Destroy();
+}
+
+/**
+ * Benchmark LoraFrameHeader round-trip serialization on a packet.
+ */
+void
+BenchFrameHeaderSerDes()
+{
+    LoraFrameHeader header;
+    header.SetAsUplink();
+    header.SetAddress(LoraDeviceAddress(54, 1864));
+    header.SetAdr(true);
+    header.SetFCnt(4242);
+
+    RunBench("FrameHeaderSerDes", 100000, [&] {
+        Ptr<Packet> packet = Create<Packet>(20);
+        packet->AddHeader(header);
+        LoraFrameHeader removed;
+        removed.SetAsUplink();
+        packet->RemoveHeader(removed);
+    });
+}
+
+/**
+ * Build an EndDeviceStatus with a full uplink history, as the ADR
+ * components see it at decision time.
+ *
+ * @param nPackets The number of history entries to insert.
+ * @return The populated device status.
+ */
+Ptr<EndDeviceStatus>
+MakeStatusWithHistory(uint32_t nPackets)
+{
+    LoraDeviceAddress address(54, 1864);
+    Ptr<ClassAEndDeviceLorawanMac> mac = CreateObject<ClassAEndDeviceLorawanMac>();
+    mac->SetDeviceAddress(address);
+    Ptr<EndDeviceStatus> status = Create<EndDeviceStatus>(address, mac);
+
+    Address gwAddress;
+    for (uint32_t i = 0; i < nPackets; i++)
+    {
+        LoraFrameHeader frameHeader;
+        frameHeader.SetAsUplink();
+        frameHeader.SetAddress(address);
+        frameHeader.SetAdr(true);
+        frameHeader.SetFCnt(i);
+        LorawanMacHeader macHeader;
+        macHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_UP);
+
+        Ptr<Packet> packet = Create<Packet>(20);
+        packet->AddHeader(frameHeader);
+        packet->AddHeader(macHeader);
+
+        LoraTag tag;
+        tag.SetSpreadingFactor(7);
+        tag.SetFrequency(868100000);
+        tag.SetReceivePower(-115 + double(i % 7));
+        packet->AddPacketTag(tag);
+
+        status->InsertReceivedPacket(packet, gwAddress);
+    }
+    return status;
+}
+
+/**
+ * Benchmark the decision time of the two ADR implementations over a full
+ * packet history.
+ */
+void
+BenchAdrDecision()
+{
+    Ptr<NetworkStatus> networkStatus = Create<NetworkStatus>();
+    Ptr<EndDeviceStatus> status = MakeStatusWithHistory(30);
+
+    Ptr<AdrComponent> adr = CreateObject<AdrComponent>();
+    RunBench("AdrDecision", 10000, [&] { adr->BeforeSendingReply(status, networkStatus); });
+
+    Ptr<ADRoptComponent> adrOpt = CreateObject<ADRoptComponent>();
+    RunBench("AdrOptDecision", 10000, [&] { adrOpt->BeforeSendingReply(status, networkStatus); });
+
+    Simulator::Destroy();
+}
+
+/**
+ * Benchmark LoraPacketTracker's MAC transmission insertion path.
+ */
+void
+BenchTrackerInsertion()
+{
+    LoraPacketTracker tracker;
+
+    RunBench("TrackerInsertion", 100000, [&] {
+        // A fresh packet per iteration, as every uplink is a distinct entry
+        Ptr<Packet> packet = Create<Packet>(23);
+        tracker.MacTransmissionCallback(packet);
+    });
+}
+
+int
+main(int argc, char* argv[])
+{
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("benchmark", "Only run benchmarks whose name contains this string", g_filter);
+    cmd.Parse(argc, argv);
+
+    BenchChannelSendFanout(1000);
+    BenchChannelSendFanout(10000);
+    BenchInterference(10);
+    BenchInterference(100);
+    BenchInterference(1000);
+    BenchFrameHeaderSerDes();
+    BenchAdrDecision();
+    BenchTrackerInsertion();
+
+    // Google Benchmark JSON schema, so existing CI tooling can diff it
+    std::cout << "{\n  \"context\": {\"library\": \"lorawan\"},\n  \"benchmarks\": [\n";
+    for (uint32_t i = 0; i < g_results.size(); i++)
+    {
+        const BenchResult& result = g_results[i];
+        std::cout << "    {\"name\": \"" << result.name << "\", \"iterations\": "
+                  << result.iterations << ", \"real_time\": " << result.nsPerIter
+                  << ", \"cpu_time\": " << result.nsPerIter << ", \"time_unit\": \"ns\"}"
+                  << (i + 1 < g_results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}" << std::endl;
+
+    return 0;
+}
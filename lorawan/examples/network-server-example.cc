@@ -7,9 +7,29 @@
  */
 
 /*
- * This example creates a simple network in which all LoRaWAN components are
- * simulated: end devices, some gateways and a network server.
- * Two end devices are already configured to send unconfirmed and confirmed messages respectively.
+ * Downlink saturation scenario for the network server.
+ *
+ * A configurable fraction of the end devices sends confirmed traffic, so
+ * every one of their uplinks forces the server to schedule and send a
+ * reply. The script measures the downlink path under this load:
+ *
+ *   - the scheduler's own counters (reply opportunities serviced,
+ *     controller evaluations, replies actually sent);
+ *   - reply latency, from the uplink's arrival at the server application
+ *     to the reply leaving a gateway PHY (mean and maximum);
+ *   - RX1 vs RX2 usage, classified by the reply's carrier frequency;
+ *   - per-gateway downlink duty-cycle utilization, as accumulated reply
+ *     airtime over the simulated duration;
+ *   - the wall-clock seconds the configuration took.
+ *
+ * Identical load across revisions makes the numbers directly comparable,
+ * so downlink-path changes (reply timer wheel, gateway availability
+ * caching) can be quantified by sweeping the relevant attributes.
+ *
+ * Usage:
+ *   network-server-example [--nDevices=100] [--nGateways=1]
+ *                          [--confirmedFraction=0.5] [--period=600]
+ *                          [--duration=3600] [--replyWheelTick=0]
  */
 
 #include "ns3/command-line.h"
@@ -19,57 +39,130 @@
 #include "ns3/log.h"
 #include "ns3/lora-channel.h"
 #include "ns3/lora-device-address-generator.h"
+#include "ns3/lora-frame-header.h"
 #include "ns3/lora-helper.h"
 #include "ns3/lora-phy-helper.h"
+#include "ns3/lora-tag.h"
 #include "ns3/lorawan-mac-helper.h"
 #include "ns3/mobility-helper.h"
 #include "ns3/network-module.h"
 #include "ns3/network-server-helper.h"
-#include "ns3/one-shot-sender-helper.h"
+#include "ns3/network-server.h"
 #include "ns3/periodic-sender-helper.h"
 #include "ns3/periodic-sender.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/string.h"
 
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <vector>
+
 using namespace ns3;
 using namespace lorawan;
 
 NS_LOG_COMPONENT_DEFINE("NetworkServerExample");
 
+/// The EU868 RX2 carrier frequency [Hz], used to classify replies.
+constexpr uint32_t RX2_FREQUENCY_HZ = 869525000;
+
+std::map<uint32_t, Time> g_lastUplinkArrival; //!< Server arrival time of each device's last uplink.
+
+uint64_t g_rx1Replies = 0; //!< Replies sent in the first receive window.
+uint64_t g_rx2Replies = 0; //!< Replies sent in the second receive window.
+
+Time g_replyLatencySum;            //!< Sum of uplink-arrival-to-reply-start latencies.
+Time g_replyLatencyMax;            //!< Largest observed reply latency.
+uint64_t g_replyLatencySamples = 0; //!< Number of latency samples.
+
+std::vector<Time> g_gatewayAirtime; //!< Accumulated downlink airtime per gateway.
+
+/**
+ * Record the arrival of an uplink at the network server application.
+ *
+ * @param packet The received uplink.
+ */
+void
+OnServerReceivedPacket(Ptr<const Packet> packet)
+{
+    g_lastUplinkArrival[LoraFrameHeader::PeekFields(packet).address.Get()] = Simulator::Now();
+}
+
+/**
+ * Record a reply leaving a gateway PHY: window usage, latency from the
+ * uplink it answers, and the gateway's airtime.
+ *
+ * @param gatewayIndex Index of the gateway in the container.
+ * @param packet The downlink packet.
+ * @param index The transmitting PHY's identifier (unused).
+ */
+void
+OnGatewayStartSending(uint32_t gatewayIndex, Ptr<const Packet> packet, uint32_t index)
+{
+    LoraTag tag;
+    packet->PeekPacketTag(tag);
+
+    (tag.GetFrequency() == RX2_FREQUENCY_HZ) ? g_rx2Replies++ : g_rx1Replies++;
+
+    // Latency from the arrival of the device's last uplink at the server
+    auto arrival = g_lastUplinkArrival.find(LoraFrameHeader::PeekFields(packet).address.Get());
+    if (arrival != g_lastUplinkArrival.end())
+    {
+        Time latency = Simulator::Now() - arrival->second;
+        g_replyLatencySum += latency;
+        g_replyLatencyMax = Max(g_replyLatencyMax, latency);
+        g_replyLatencySamples++;
+    }
+
+    // Downlink airtime, for the duty-cycle utilization report
+    LoraTxParameters txParams;
+    txParams.sf = tag.GetSpreadingFactor();
+    txParams.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(txParams) > MilliSeconds(16);
+    g_gatewayAirtime.at(gatewayIndex) += LoraPhy::GetOnAirTime(packet->Copy(), txParams);
+}
+
 int
 main(int argc, char* argv[])
 {
     bool verbose = false;
+    int nDevices = 100;
+    int nGateways = 1;
+    double confirmedFraction = 0.5;
+    double periodSeconds = 600;
+    double durationSeconds = 3600;
+    double replyWheelTickMs = 0;
 
     CommandLine cmd(__FILE__);
     cmd.AddValue("verbose", "Whether to print output or not", verbose);
+    cmd.AddValue("nDevices", "Number of end devices to simulate", nDevices);
+    cmd.AddValue("nGateways", "Number of gateways to simulate", nGateways);
+    cmd.AddValue("confirmedFraction",
+                 "Fraction of devices sending confirmed traffic",
+                 confirmedFraction);
+    cmd.AddValue("period", "Send period (s) of every device", periodSeconds);
+    cmd.AddValue("duration", "Simulated duration (s)", durationSeconds);
+    cmd.AddValue("replyWheelTick",
+                 "ns3::NetworkScheduler::ReplyWheelTick (ms), 0 disables the wheel",
+                 replyWheelTickMs);
     cmd.Parse(argc, argv);
 
     // Logging
     //////////
 
-    LogComponentEnable("NetworkServerExample", LOG_LEVEL_ALL);
-    LogComponentEnable("NetworkServer", LOG_LEVEL_ALL);
-    LogComponentEnable("GatewayLorawanMac", LOG_LEVEL_ALL);
-    // LogComponentEnable("LoraFrameHeader", LOG_LEVEL_ALL);
-    // LogComponentEnable("LorawanMacHeader", LOG_LEVEL_ALL);
-    // LogComponentEnable("MacCommand", LOG_LEVEL_ALL);
-    // LogComponentEnable("GatewayLoraPhy", LOG_LEVEL_ALL);
-    // LogComponentEnable("LoraPhy", LOG_LEVEL_ALL);
-    // LogComponentEnable("LoraChannel", LOG_LEVEL_ALL);
-    // LogComponentEnable("EndDeviceLoraPhy", LOG_LEVEL_ALL);
-    // LogComponentEnable("LogicalLoraChannelHelper", LOG_LEVEL_ALL);
-    LogComponentEnable("EndDeviceLorawanMac", LOG_LEVEL_ALL);
-    LogComponentEnable("ClassAEndDeviceLorawanMac", LOG_LEVEL_ALL);
-    // LogComponentEnable ("OneShotSender", LOG_LEVEL_ALL);
-    // LogComponentEnable("PointToPointNetDevice", LOG_LEVEL_ALL);
-    // LogComponentEnable ("Forwarder", LOG_LEVEL_ALL);
-    // LogComponentEnable ("OneShotSender", LOG_LEVEL_ALL);
-    // LogComponentEnable ("DeviceStatus", LOG_LEVEL_ALL);
-    // LogComponentEnable ("GatewayStatus", LOG_LEVEL_ALL);
-    LogComponentEnableAll(LOG_PREFIX_FUNC);
-    LogComponentEnableAll(LOG_PREFIX_NODE);
-    LogComponentEnableAll(LOG_PREFIX_TIME);
+    if (verbose)
+    {
+        LogComponentEnable("NetworkServerExample", LOG_LEVEL_ALL);
+        LogComponentEnable("NetworkServer", LOG_LEVEL_ALL);
+        LogComponentEnable("GatewayLorawanMac", LOG_LEVEL_ALL);
+        LogComponentEnable("EndDeviceLorawanMac", LOG_LEVEL_ALL);
+        LogComponentEnable("ClassAEndDeviceLorawanMac", LOG_LEVEL_ALL);
+        LogComponentEnableAll(LOG_PREFIX_FUNC);
+        LogComponentEnableAll(LOG_PREFIX_NODE);
+        LogComponentEnableAll(LOG_PREFIX_TIME);
+    }
+
+    Config::SetDefault("ns3::NetworkScheduler::ReplyWheelTick",
+                       TimeValue(MilliSeconds(replyWheelTickMs)));
 
     // Create a simple wireless channel
     ///////////////////////////////////
@@ -88,18 +181,23 @@ main(int argc, char* argv[])
     // End device mobility
     MobilityHelper mobilityEd;
     MobilityHelper mobilityGw;
-    Ptr<ListPositionAllocator> positionAllocEd = CreateObject<ListPositionAllocator>();
-    positionAllocEd->Add(Vector(6000.0, 0.0, 0.0));
-    positionAllocEd->Add(Vector(0.0, 100.0, 0.0));
-    mobilityEd.SetPositionAllocator(positionAllocEd);
+    mobilityEd.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                    "rho",
+                                    DoubleValue(5000),
+                                    "X",
+                                    DoubleValue(0.0),
+                                    "Y",
+                                    DoubleValue(0.0));
     mobilityEd.SetMobilityModel("ns3::ConstantPositionMobilityModel");
 
     // Gateway mobility
-    Ptr<ListPositionAllocator> positionAllocGw = CreateObject<ListPositionAllocator>();
-    positionAllocGw->Add(Vector(0.0, 0.0, 0.0));
-    positionAllocGw->Add(Vector(-2000.0, 0.0, 0.0));
-    positionAllocGw->Add(Vector(500.0, 0.0, 0.0));
-    mobilityGw.SetPositionAllocator(positionAllocGw);
+    mobilityGw.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                    "rho",
+                                    DoubleValue(1000),
+                                    "X",
+                                    DoubleValue(0.0),
+                                    "Y",
+                                    DoubleValue(0.0));
     mobilityGw.SetMobilityModel("ns3::ConstantPositionMobilityModel");
 
     // Create the LoraPhyHelper
@@ -116,7 +214,7 @@ main(int argc, char* argv[])
     /////////////
 
     NodeContainer endDevices;
-    endDevices.Create(2);
+    endDevices.Create(nDevices);
     mobilityEd.Install(endDevices);
 
     // Create a LoraDeviceAddressGenerator
@@ -132,28 +230,31 @@ main(int argc, char* argv[])
     macHelper.SetRegion(LorawanMacHelper::EU);
     helper.Install(phyHelper, macHelper, endDevices);
 
-    // Set message type (Default is unconfirmed)
-    Ptr<LorawanMac> edMac1 = DynamicCast<LoraNetDevice>(endDevices.Get(1)->GetDevice(0))->GetMac();
-    Ptr<ClassAEndDeviceLorawanMac> edLorawanMac1 = DynamicCast<ClassAEndDeviceLorawanMac>(edMac1);
-    edLorawanMac1->SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
-
-    // Install applications in end devices
-    OneShotSenderHelper oneShotHelper = OneShotSenderHelper();
-    oneShotHelper.SetSendTime(Seconds(4));
-    oneShotHelper.Install(endDevices.Get(0));
-    oneShotHelper.SetSendTime(Seconds(10));
-    oneShotHelper.Install(endDevices.Get(1));
-    // oneShotHelper.SetSendTime (Seconds (8));
-    // oneShotHelper.Install(endDevices.Get (1));
-    // oneShotHelper.SetSendTime (Seconds (12));
-    // oneShotHelper.Install(endDevices.Get (2));
+    // The first confirmedFraction of the devices send confirmed traffic, so
+    // each of their uplinks forces a downlink through the server
+    int nConfirmed = confirmedFraction * nDevices;
+    for (int i = 0; i < nConfirmed; i++)
+    {
+        DynamicCast<ClassAEndDeviceLorawanMac>(
+            DynamicCast<LoraNetDevice>(endDevices.Get(i)->GetDevice(0))->GetMac())
+            ->SetMType(LorawanMacHeader::CONFIRMED_DATA_UP);
+    }
+
+    // Install applications in end devices: identical periods, staggered
+    // deterministically so the offered load is repeatable across runs
+    PeriodicSenderHelper appHelper = PeriodicSenderHelper();
+    appHelper.SetPeriod(Seconds(periodSeconds));
+    appHelper.SetDeterministicStagger(true);
+    ApplicationContainer appContainer = appHelper.Install(endDevices);
+    appContainer.Start(Time(0));
+    appContainer.Stop(Seconds(durationSeconds));
 
     ////////////////
     // Create gateways //
     ////////////////
 
     NodeContainer gateways;
-    gateways.Create(1);
+    gateways.Create(nGateways);
     mobilityGw.Install(gateways);
 
     // Create the LoraNetDevices of the gateways
@@ -165,7 +266,7 @@ main(int argc, char* argv[])
     LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
 
     ////////////
-    // Create network serverNS
+    // Create network server
     ////////////
 
     Ptr<Node> networkServer = CreateObject<Node>();
@@ -187,16 +288,52 @@ main(int argc, char* argv[])
     NetworkServerHelper networkServerHelper;
     networkServerHelper.SetGatewaysP2P(gwRegistration);
     networkServerHelper.SetEndDevices(endDevices);
-    networkServerHelper.Install(networkServer);
+    ApplicationContainer serverApps = networkServerHelper.Install(networkServer);
+    Ptr<NetworkServer> server = DynamicCast<NetworkServer>(serverApps.Get(0));
 
     // Install the Forwarder application on the gateways
     ForwarderHelper forwarderHelper;
     forwarderHelper.Install(gateways);
 
+    // Wire the measurements: uplink arrivals at the server, replies at the
+    // gateway PHYs
+    server->TraceConnectWithoutContext("ReceivedPacket",
+                                       MakeCallback(&OnServerReceivedPacket));
+    g_gatewayAirtime.assign(nGateways, Time(0));
+    for (int i = 0; i < nGateways; i++)
+    {
+        DynamicCast<LoraNetDevice>(gateways.Get(i)->GetDevice(0))
+            ->GetPhy()
+            ->TraceConnectWithoutContext("StartSending",
+                                         MakeBoundCallback(&OnGatewayStartSending, i));
+    }
+
     // Start simulation
-    Simulator::Stop(Seconds(800));
+    Simulator::Stop(Seconds(durationSeconds) + Hours(1));
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    double wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
     Simulator::Destroy();
 
+    // Report
+    NetworkScheduler::Stats stats = server->GetNetworkScheduler()->GetStats();
+    std::cout << "scheduler opportunities=" << stats.replyOpportunities
+              << " evaluations=" << stats.controllerEvaluations
+              << " repliesSent=" << stats.repliesSent << std::endl;
+    std::cout << "replies rx1=" << g_rx1Replies << " rx2=" << g_rx2Replies;
+    if (g_replyLatencySamples)
+    {
+        std::cout << " latencyMean=" << (g_replyLatencySum / g_replyLatencySamples).GetSeconds()
+                  << "s latencyMax=" << g_replyLatencyMax.GetSeconds() << "s";
+    }
+    std::cout << std::endl;
+    for (int i = 0; i < nGateways; i++)
+    {
+        std::cout << "gateway " << i << " downlinkUtilization="
+                  << g_gatewayAirtime.at(i).GetSeconds() / durationSeconds << std::endl;
+    }
+    std::cout << "wall=" << wallSeconds << "s" << std::endl;
+
     return 0;
 }
@@ -0,0 +1,348 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "checkpoint-helper.h"
+
+#include "ns3/class-a-end-device-lorawan-mac.h"
+#include "ns3/log.h"
+#include "ns3/lora-net-device.h"
+#include "ns3/network-status.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("CheckpointHelper");
+
+namespace
+{
+
+/// Magic bytes of the checkpoint format.
+const char CHECKPOINT_MAGIC[4] = {'L', 'W', 'C', 'K'};
+
+/// Fixed-width per-device record of the checkpoint.
+struct CheckpointDeviceRecord
+{
+    uint32_t address;  //!< LoraDeviceAddress as a raw integer
+    uint8_t dataRate;  //!< Data rate at checkpoint time
+    double txPowerDbm; //!< Transmission power at checkpoint time
+    uint16_t fCnt;     //!< Uplink frame counter at checkpoint time
+};
+
+/**
+ * Find the end device MAC on a node.
+ *
+ * @param node The node holding a LoraNetDevice.
+ * @return The MAC layer, asserting it exists.
+ */
+Ptr<ClassAEndDeviceLorawanMac>
+GetEndDeviceMac(Ptr<Node> node)
+{
+    Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(node->GetDevice(0));
+    NS_ASSERT(loraNetDevice);
+    Ptr<ClassAEndDeviceLorawanMac> mac =
+        DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+    NS_ASSERT(mac);
+    return mac;
+}
+
+} // namespace
+
+bool
+CheckpointHelper::SaveCheckpoint(NodeContainer endDevices, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    // Rewrite atomically enough for a crash between runs: write a sibling
+    // file first, then replace the previous checkpoint
+    std::string tmpFilename = filename + ".tmp";
+    std::ofstream file(tmpFilename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        NS_LOG_ERROR("Could not open checkpoint file: " << tmpFilename);
+        return false;
+    }
+
+    uint32_t version = FORMAT_VERSION;
+    uint32_t nDevices = endDevices.GetN();
+    uint64_t timeNs = static_cast<uint64_t>(Simulator::Now().GetNanoSeconds());
+    uint32_t seed = RngSeedManager::GetSeed();
+    uint64_t run = RngSeedManager::GetRun();
+    file.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&timeNs), sizeof(timeNs));
+    file.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+    file.write(reinterpret_cast<const char*>(&run), sizeof(run));
+    file.write(reinterpret_cast<const char*>(&nDevices), sizeof(nDevices));
+
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        Ptr<ClassAEndDeviceLorawanMac> mac = GetEndDeviceMac(*j);
+
+        CheckpointDeviceRecord record;
+        record.address = mac->GetDeviceAddress().Get();
+        record.dataRate = mac->GetDataRate();
+        record.txPowerDbm = mac->GetTransmissionPowerDbm();
+        record.fCnt = mac->GetFrameCounter();
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    file.close();
+
+    if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+        NS_LOG_ERROR("Could not replace checkpoint file: " << filename);
+        return false;
+    }
+
+    NS_LOG_INFO("Checkpointed " << nDevices << " devices at " << Simulator::Now().As(Time::S)
+                                << " to " << filename);
+    return true;
+}
+
+bool
+CheckpointHelper::RestoreCheckpoint(NodeContainer endDevices, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        NS_LOG_ERROR("Could not open checkpoint file: " << filename);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t timeNs = 0;
+    uint32_t seed = 0;
+    uint64_t run = 0;
+    uint32_t nDevices = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&timeNs), sizeof(timeNs));
+    file.read(reinterpret_cast<char*>(&seed), sizeof(seed));
+    file.read(reinterpret_cast<char*>(&run), sizeof(run));
+    file.read(reinterpret_cast<char*>(&nDevices), sizeof(nDevices));
+    if (!file || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 ||
+        version != FORMAT_VERSION)
+    {
+        NS_LOG_ERROR(filename << " is not a version " << FORMAT_VERSION << " checkpoint");
+        return false;
+    }
+    if (nDevices != endDevices.GetN())
+    {
+        NS_LOG_ERROR("Checkpoint holds " << nDevices << " devices, container holds "
+                                         << endDevices.GetN());
+        return false;
+    }
+
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        CheckpointDeviceRecord record;
+        file.read(reinterpret_cast<char*>(&record), sizeof(record));
+        if (!file)
+        {
+            NS_LOG_ERROR("Truncated checkpoint: " << filename);
+            return false;
+        }
+
+        Ptr<ClassAEndDeviceLorawanMac> mac = GetEndDeviceMac(*j);
+        mac->SetDeviceAddress(LoraDeviceAddress(record.address));
+        mac->SetDataRate(record.dataRate);
+        mac->SetTransmissionPowerDbm(record.txPowerDbm);
+        mac->SetFrameCounter(record.fCnt);
+    }
+
+    m_checkpointTime = NanoSeconds(timeNs);
+    NS_LOG_INFO("Restored " << nDevices << " devices from checkpoint taken at "
+                            << m_checkpointTime.As(Time::S) << " (seed " << seed << ", run "
+                            << run << ")");
+    return true;
+}
+
+bool
+CheckpointHelper::SaveLinkParameters(NodeContainer endDevices, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ofstream file(filename, std::ios::trunc);
+    if (!file.is_open())
+    {
+        NS_LOG_ERROR("Could not open link parameter file: " << filename);
+        return false;
+    }
+
+    file << "# address dataRate txPowerDbm nbTrans\n";
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        Ptr<ClassAEndDeviceLorawanMac> mac = GetEndDeviceMac(*j);
+        file << mac->GetDeviceAddress().Get() << ' ' << unsigned(mac->GetDataRate()) << ' '
+             << mac->GetTransmissionPowerDbm() << ' '
+             << unsigned(mac->GetMaxNumberOfTransmissions()) << '\n';
+    }
+
+    NS_LOG_INFO("Saved link parameters of " << endDevices.GetN() << " devices to " << filename);
+    return true;
+}
+
+namespace
+{
+
+/// Converged link parameters of one device, as read back from the file.
+struct LinkParameterRecord
+{
+    uint8_t dataRate;   //!< Converged data rate
+    double txPowerDbm;  //!< Converged transmission power
+    uint8_t nbTrans;    //!< Converged number of transmissions
+};
+
+/**
+ * Parse an exported link parameter file into an address-keyed map.
+ *
+ * @param filename The parameter file to read.
+ * @param records [out] The parsed records, keyed by raw device address.
+ * @return True on success, false if the file is missing or malformed.
+ */
+bool
+ParseLinkParameters(const std::string& filename,
+                    std::unordered_map<uint32_t, LinkParameterRecord>& records)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        NS_LOG_ERROR("Could not open link parameter file: " << filename);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        uint32_t address;
+        unsigned dataRate;
+        double txPowerDbm;
+        unsigned nbTrans;
+        if (!(fields >> address >> dataRate >> txPowerDbm >> nbTrans))
+        {
+            NS_LOG_ERROR("Malformed link parameter line: " << line);
+            return false;
+        }
+        records[address] = {static_cast<uint8_t>(dataRate),
+                            txPowerDbm,
+                            static_cast<uint8_t>(nbTrans)};
+    }
+    return true;
+}
+
+} // namespace
+
+bool
+CheckpointHelper::LoadLinkParameters(NodeContainer endDevices, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::unordered_map<uint32_t, LinkParameterRecord> records;
+    if (!ParseLinkParameters(filename, records))
+    {
+        return false;
+    }
+
+    uint32_t initialized = 0;
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        Ptr<ClassAEndDeviceLorawanMac> mac = GetEndDeviceMac(*j);
+        auto record = records.find(mac->GetDeviceAddress().Get());
+        if (record == records.end())
+        {
+            continue;
+        }
+        mac->SetDataRate(record->second.dataRate);
+        mac->SetTransmissionPowerDbm(record->second.txPowerDbm);
+        mac->SetMaxNumberOfTransmissions(record->second.nbTrans);
+        initialized++;
+    }
+
+    NS_LOG_INFO("Warm-started " << initialized << " of " << endDevices.GetN() << " devices from "
+                                << filename);
+    return true;
+}
+
+bool
+CheckpointHelper::LoadLinkParameters(Ptr<NetworkStatus> networkStatus, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::unordered_map<uint32_t, LinkParameterRecord> records;
+    if (!ParseLinkParameters(filename, records))
+    {
+        return false;
+    }
+
+    uint32_t initialized = 0;
+    for (const auto& [address, record] : records)
+    {
+        Ptr<EndDeviceStatus> status = networkStatus->GetEndDeviceStatus(LoraDeviceAddress(address));
+        if (!status)
+        {
+            continue;
+        }
+        // The server tracks the device's uplink parameters to answer in the
+        // first receive window; seed them so the very first downlink already
+        // uses the converged settings
+        status->SetFirstReceiveWindowSpreadingFactor(12 - record.dataRate);
+        initialized++;
+    }
+
+    NS_LOG_INFO("Warm-started server state of " << initialized << " devices from " << filename);
+    return true;
+}
+
+void
+CheckpointHelper::EnablePeriodicCheckpoint(NodeContainer endDevices,
+                                           std::string filename,
+                                           Time interval)
+{
+    NS_LOG_FUNCTION(this << filename << interval);
+
+    Simulator::Schedule(interval,
+                        &CheckpointHelper::PeriodicSave,
+                        this,
+                        endDevices,
+                        filename,
+                        interval);
+}
+
+void
+CheckpointHelper::PeriodicSave(NodeContainer endDevices, std::string filename, Time interval)
+{
+    SaveCheckpoint(endDevices, filename);
+    Simulator::Schedule(interval,
+                        &CheckpointHelper::PeriodicSave,
+                        this,
+                        endDevices,
+                        filename,
+                        interval);
+}
+
+Time
+CheckpointHelper::GetCheckpointTime() const
+{
+    return m_checkpointTime;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,147 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef CHECKPOINT_HELPER_H
+#define CHECKPOINT_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <string>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+class NetworkStatus;
+
+/**
+ * @ingroup lorawan
+ *
+ * Coarse-grained checkpointing of end device state for long campaigns.
+ *
+ * Month-scale simulations lost to node preemption restart from zero.
+ * SaveCheckpoint() serializes the persistent per-device state — device
+ * address, data rate, transmission power and uplink frame counter — plus
+ * the RNG seed/run configuration to a versioned binary file, and
+ * EnablePeriodicCheckpoint() rewrites it on a timer so a fresh copy is
+ * always on disk. Saves land between simulation events, i.e. at quiescent
+ * points between transmissions.
+ *
+ * RestoreCheckpoint() loads the state back into a rebuilt scenario before
+ * Simulator::Run. The event queue and the positions of already-drawn RNG
+ * streams are not part of the checkpoint: the restored run starts its clock
+ * from zero with warm device state (ADR-assigned parameters and frame
+ * counters continue where they left off, and network-server components
+ * re-accumulate their packet history within their history range). For the
+ * steady-state metrics a month-scale campaign measures this is equivalent
+ * to resuming, without re-simulating the elapsed weeks.
+ */
+class CheckpointHelper
+{
+  public:
+    static const uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * Write a checkpoint of the end devices' persistent state.
+     *
+     * @param endDevices The end devices to checkpoint.
+     * @param filename The checkpoint file to (re)write.
+     * @return True on success.
+     */
+    bool SaveCheckpoint(NodeContainer endDevices, std::string filename);
+
+    /**
+     * Restore device state from a checkpoint into a rebuilt scenario.
+     *
+     * The container must hold as many devices as the checkpoint records,
+     * in the same order, with LoraNetDevices already installed.
+     *
+     * @param endDevices The end devices to restore into.
+     * @param filename The checkpoint file to read.
+     * @return True on success, false if the file is missing, malformed or
+     * sized for a different population.
+     */
+    bool RestoreCheckpoint(NodeContainer endDevices, std::string filename);
+
+    /**
+     * Export the converged link parameters of the end devices.
+     *
+     * Writes one text line per device — address, data rate, transmission
+     * power [dBm] and NbTrans — keyed by device address, so the file
+     * survives scenario changes that reorder or subset the population
+     * (unlike the positional binary checkpoint). Meant to be called after a
+     * campaign whose ADR has settled, so follow-up experiments can start
+     * converged instead of re-simulating hours of warm-up.
+     *
+     * @param endDevices The end devices whose parameters to export.
+     * @param filename The parameter file to (re)write.
+     * @return True on success.
+     */
+    bool SaveLinkParameters(NodeContainer endDevices, std::string filename);
+
+    /**
+     * Initialize end devices from an exported parameter file.
+     *
+     * Devices whose address appears in the file get their data rate,
+     * transmission power and NbTrans set; devices without a file entry are
+     * left at their configured defaults. Call after installing the MAC
+     * layers and assigning addresses, before Simulator::Run.
+     *
+     * @param endDevices The end devices to initialize.
+     * @param filename The parameter file to read.
+     * @return True on success, false if the file is missing or malformed.
+     */
+    bool LoadLinkParameters(NodeContainer endDevices, std::string filename);
+
+    /**
+     * Initialize server-side device state from an exported parameter file.
+     *
+     * Seeds the first receive window spreading factor of every registered
+     * EndDeviceStatus whose address appears in the file, so the network
+     * server answers the very first uplink with the converged downlink
+     * parameters instead of waiting to observe traffic. Call after the
+     * network server has been set up with its device population.
+     *
+     * @param networkStatus The network server's device state registry.
+     * @param filename The parameter file to read.
+     * @return True on success, false if the file is missing or malformed.
+     */
+    bool LoadLinkParameters(Ptr<NetworkStatus> networkStatus, std::string filename);
+
+    /**
+     * Rewrite the checkpoint file every interval for the rest of the run.
+     *
+     * @param endDevices The end devices to checkpoint.
+     * @param filename The checkpoint file to keep fresh.
+     * @param interval The time between checkpoints.
+     */
+    void EnablePeriodicCheckpoint(NodeContainer endDevices, std::string filename, Time interval);
+
+    /**
+     * The simulation time at which the last restored checkpoint was taken.
+     *
+     * @return The capture time, zero if nothing was restored.
+     */
+    Time GetCheckpointTime() const;
+
+  private:
+    /**
+     * Timer body: save and reschedule.
+     *
+     * @param endDevices The end devices to checkpoint.
+     * @param filename The checkpoint file.
+     * @param interval The rescheduling interval.
+     */
+    void PeriodicSave(NodeContainer endDevices, std::string filename, Time interval);
+
+    Time m_checkpointTime; //!< Capture time of the last restored checkpoint
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif /* CHECKPOINT_HELPER_H */
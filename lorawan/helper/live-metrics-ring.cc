@@ -0,0 +1,177 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "live-metrics-ring.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("LiveMetricsRing");
+
+LiveMetricsRing::~LiveMetricsRing()
+{
+    Disable();
+}
+
+bool
+LiveMetricsRing::Enable(const std::string& filename, uint32_t capacity)
+{
+    NS_LOG_FUNCTION(this << filename << capacity);
+
+    Disable();
+
+    size_t size = sizeof(Header) + size_t(capacity) * sizeof(Record);
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        NS_LOG_ERROR("Could not open " << filename << " for the live metrics ring");
+        return false;
+    }
+    if (ftruncate(fd, off_t(size)) != 0)
+    {
+        NS_LOG_ERROR("Could not size " << filename << " to " << size << " bytes");
+        close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        NS_LOG_ERROR("Could not map " << filename);
+        return false;
+    }
+
+    m_map = map;
+    m_mapSize = size;
+    m_capacity = capacity;
+
+    auto* header = static_cast<Header*>(m_map);
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->recordSize = sizeof(Record);
+    header->capacity = capacity;
+    std::atomic_ref<uint64_t>(header->writeSeq).store(0, std::memory_order_release);
+
+    NS_LOG_INFO("Live metrics ring mapped at " << filename << " with " << capacity << " slots");
+    return true;
+}
+
+void
+LiveMetricsRing::SetPacketTracker(LoraPacketTracker* tracker)
+{
+    m_tracker = tracker;
+}
+
+void
+LiveMetricsRing::SetStatisticsCollector(Ptr<StatisticsCollectorComponent> collector)
+{
+    m_collector = collector;
+}
+
+void
+LiveMetricsRing::StartPublishing(Time interval)
+{
+    NS_LOG_FUNCTION(this << interval);
+
+    m_sampleEvent.Cancel();
+    m_lastPhySent = 0;
+    m_lastSampleTime = Simulator::Now();
+    m_sampleEvent = Simulator::Schedule(interval, &LiveMetricsRing::Sample, this, interval);
+}
+
+void
+LiveMetricsRing::Disable()
+{
+    m_sampleEvent.Cancel();
+    if (m_map)
+    {
+        munmap(m_map, m_mapSize);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+}
+
+void
+LiveMetricsRing::Sample(Time interval)
+{
+    Record record{};
+    record.simTimeS = Simulator::Now().GetSeconds();
+    record.wallTimeS =
+        std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if (m_tracker)
+    {
+        for (uint8_t sf = 7; sf <= 12; sf++)
+        {
+            auto& counters = m_tracker->GetSfCounters(sf);
+            record.phySent += counters.sent.Get();
+            record.phyReceived += counters.outcomes.at(RECEIVED).Get();
+        }
+    }
+    if (m_collector)
+    {
+        record.nsSent = m_collector->GetNetworkTotalPacketsSent();
+        record.nsReceived = m_collector->GetNetworkTotalPacketsReceived();
+        record.pdr = m_collector->GetNetworkPacketDeliveryRate();
+        for (uint32_t deviceAddr : m_collector->GetTrackedDevices())
+        {
+            record.adrAdjustments += m_collector->GetAdrAdjustmentCount(deviceAddr);
+        }
+    }
+
+    Time elapsed = Simulator::Now() - m_lastSampleTime;
+    if (elapsed.IsStrictlyPositive())
+    {
+        record.uplinkRateHz = double(record.phySent - m_lastPhySent) / elapsed.GetSeconds();
+    }
+    m_lastPhySent = record.phySent;
+    m_lastSampleTime = Simulator::Now();
+
+    Push(record);
+
+    m_sampleEvent = Simulator::Schedule(interval, &LiveMetricsRing::Sample, this, interval);
+}
+
+void
+LiveMetricsRing::Push(Record record)
+{
+    if (!m_map)
+    {
+        return;
+    }
+
+    auto* header = static_cast<Header*>(m_map);
+    std::atomic_ref<uint64_t> writeSeq(header->writeSeq);
+    uint64_t seq = writeSeq.load(std::memory_order_relaxed) + 1;
+
+    auto* slots = reinterpret_cast<Record*>(static_cast<char*>(m_map) + sizeof(Header));
+    Record& slot = slots[(seq - 1) % m_capacity];
+
+    // Seqlock store order: invalidate, fill, publish, then advance the
+    // header count. A reader that sees slot.seq == 0 or a mismatch with the
+    // header retries; the single writer never blocks
+    std::atomic_ref<uint64_t> slotSeq(slot.seq);
+    slotSeq.store(0, std::memory_order_release);
+    record.seq = seq;
+    std::memcpy(reinterpret_cast<char*>(&slot) + sizeof(slot.seq),
+                reinterpret_cast<const char*>(&record) + sizeof(record.seq),
+                sizeof(Record) - sizeof(slot.seq));
+    slotSeq.store(seq, std::memory_order_release);
+    writeSeq.store(seq, std::memory_order_release);
+}
+
+} // namespace lorawan
+} // namespace ns3
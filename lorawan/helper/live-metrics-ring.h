@@ -0,0 +1,139 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LIVE_METRICS_RING_H
+#define LIVE_METRICS_RING_H
+
+#include "lora-packet-tracker.h"
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/statistics-collector.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Lock-free shared-memory publication of live run metrics.
+ *
+ * Monitoring a multi-day run by tailing its CSVs forces a choice between
+ * frequent flushes (stalling the simulation) and stale data. This ring is
+ * an mmap'd file of fixed-layout records: the simulation samples the
+ * online counters on a timer and stores each sample into the next slot
+ * with plain memory writes — the kernel pages the data out on its own
+ * schedule, so no file I/O ever happens on the simulation's critical path.
+ * An external dashboard mmaps the same file read-only and polls.
+ *
+ * Consistency uses a per-record sequence number: the writer zeroes it,
+ * fills the payload, then publishes the sequence, so a reader seeing a
+ * nonzero sequence that matches the header's latest count has a complete
+ * record, and a torn read is detected by a zero or changed sequence. There
+ * is exactly one writer (the simulation), so no locks are needed on either
+ * side.
+ */
+class LiveMetricsRing
+{
+  public:
+    /// File magic identifying the ring layout version.
+    static constexpr char MAGIC[8] = {'L', 'W', 'L', 'I', 'V', 'E', '1', '\0'};
+
+    /// Fixed layout of the mmap'd file header.
+    struct Header
+    {
+        char magic[8];       //!< MAGIC, for readers to sanity-check
+        uint32_t recordSize; //!< sizeof(Record) at write time
+        uint32_t capacity;   //!< Number of record slots
+        uint64_t writeSeq;   //!< Records published so far; latest slot is (writeSeq - 1) % capacity
+    };
+
+    /// One published sample, fixed layout.
+    struct Record
+    {
+        uint64_t seq;             //!< Publication sequence, 1-based; 0 marks in-progress
+        double simTimeS;          //!< Simulated time of the sample [s]
+        double wallTimeS;         //!< Wall-clock time of the sample, seconds since the epoch
+        uint64_t phySent;         //!< Uplink transmissions so far, all SFs
+        uint64_t phyReceived;     //!< Gateway copies received so far, all SFs
+        uint64_t nsSent;          //!< Packets sent as seen by the collector
+        uint64_t nsReceived;      //!< Packets received by the network server
+        double pdr;               //!< The collector's network delivery rate
+        uint64_t adrAdjustments;  //!< ADR adjustments across all tracked devices
+        double uplinkRateHz;      //!< Transmissions per simulated second since the last sample
+    };
+
+    ~LiveMetricsRing();
+
+    /**
+     * Create (truncating) and map the ring file.
+     *
+     * @param filename The file to map.
+     * @param capacity The number of record slots.
+     * @return True on success.
+     */
+    bool Enable(const std::string& filename, uint32_t capacity = 1024);
+
+    /**
+     * Set the packet tracker sampled for the PHY counters.
+     *
+     * @param tracker The tracker, typically LoraHelper::GetPacketTracker().
+     */
+    void SetPacketTracker(LoraPacketTracker* tracker);
+
+    /**
+     * Set the collector sampled for delivery and ADR metrics.
+     *
+     * @param collector The statistics collector component.
+     */
+    void SetStatisticsCollector(Ptr<StatisticsCollectorComponent> collector);
+
+    /**
+     * Publish one sample per interval for the rest of the run.
+     *
+     * @param interval The simulated time between samples.
+     */
+    void StartPublishing(Time interval);
+
+    /**
+     * Stop sampling and unmap the file. The file itself is left behind for
+     * post-mortem inspection.
+     */
+    void Disable();
+
+  private:
+    /**
+     * Timer body: sample the counters, store the record, reschedule.
+     *
+     * @param interval The rescheduling interval.
+     */
+    void Sample(Time interval);
+
+    /**
+     * Store one record into the next slot, with the seqlock protocol.
+     *
+     * @param record The record to store; its seq field is assigned here.
+     */
+    void Push(Record record);
+
+    void* m_map = nullptr;                         //!< The mapped region
+    size_t m_mapSize = 0;                          //!< Size of the mapped region
+    uint32_t m_capacity = 0;                       //!< Number of record slots
+    uint64_t m_lastPhySent = 0;                    //!< phySent at the previous sample
+    Time m_lastSampleTime;                         //!< Simulated time of the previous sample
+    EventId m_sampleEvent;                         //!< The pending sampling event
+    LoraPacketTracker* m_tracker = nullptr;        //!< Source of the PHY counters
+    Ptr<StatisticsCollectorComponent> m_collector; //!< Source of delivery and ADR metrics
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif /* LIVE_METRICS_RING_H */
@@ -9,8 +9,13 @@
 #include "lora-helper.h"
 
 #include "ns3/log.h"
+#include "ns3/lora-interference-helper.h"
+#include "ns3/position-snapshot.h"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <sstream>
 
 namespace ns3
 {
@@ -20,7 +25,8 @@ namespace lorawan
 NS_LOG_COMPONENT_DEFINE("LoraHelper");
 
 LoraHelper::LoraHelper()
-    : m_lastPhyPerformanceUpdate(Time(0)),
+    : m_setupStartWall(std::chrono::steady_clock::now()),
+      m_lastPhyPerformanceUpdate(Time(0)),
       m_lastGlobalPerformanceUpdate(Time(0))
 {
 }
@@ -38,6 +44,17 @@ LoraHelper::Install(const LoraPhyHelper& phyHelper,
 
     NetDeviceContainer devices;
 
+    // Resolve the device kind once instead of looking the TypeIds up by
+    // name for every node of the container
+    bool isEndDevice =
+        phyHelper.GetDeviceType() == TypeId::LookupByName("ns3::SimpleEndDeviceLoraPhy");
+    bool isGateway =
+        phyHelper.GetDeviceType() == TypeId::LookupByName("ns3::SimpleGatewayLoraPhy");
+
+    // Draw the whole container's device addresses as one contiguous block
+    // (a no-op for gateways or when no address generator is configured)
+    macHelper.PrefetchAddresses(c.GetN());
+
     // Go over the various nodes in which to install the NetDevice
     for (auto i = c.Begin(); i != c.End(); ++i)
     {
@@ -55,13 +72,13 @@ LoraHelper::Install(const LoraPhyHelper& phyHelper,
         // Connect Trace Sources if necessary
         if (m_packetTracker)
         {
-            if (phyHelper.GetDeviceType() == TypeId::LookupByName("ns3::SimpleEndDeviceLoraPhy"))
+            if (isEndDevice)
             {
                 phy->TraceConnectWithoutContext(
                     "StartSending",
                     MakeCallback(&LoraPacketTracker::TransmissionCallback, m_packetTracker));
             }
-            else if (phyHelper.GetDeviceType() == TypeId::LookupByName("ns3::SimpleGatewayLoraPhy"))
+            else if (isGateway)
             {
                 phy->TraceConnectWithoutContext(
                     "StartSending",
@@ -93,7 +110,7 @@ LoraHelper::Install(const LoraPhyHelper& phyHelper,
 
         if (m_packetTracker)
         {
-            if (phyHelper.GetDeviceType() == TypeId::LookupByName("ns3::SimpleEndDeviceLoraPhy"))
+            if (isEndDevice)
             {
                 mac->TraceConnectWithoutContext(
                     "SentNewPacket",
@@ -104,7 +121,7 @@ LoraHelper::Install(const LoraPhyHelper& phyHelper,
                     MakeCallback(&LoraPacketTracker::RequiredTransmissionsCallback,
                                  m_packetTracker));
             }
-            else if (phyHelper.GetDeviceType() == TypeId::LookupByName("ns3::SimpleGatewayLoraPhy"))
+            else if (isGateway)
             {
                 mac->TraceConnectWithoutContext(
                     "SentNewPacket",
@@ -121,6 +138,11 @@ LoraHelper::Install(const LoraPhyHelper& phyHelper,
         NS_LOG_DEBUG("node=" << node
                              << ", mob=" << node->GetObject<MobilityModel>()->GetPosition());
     }
+
+    // Freeze the container's positions into the flat snapshot; nodes that
+    // later move are evicted by their CourseChange trace
+    PositionSnapshot::Capture(c);
+
     return devices;
 }
 
@@ -139,6 +161,208 @@ LoraHelper::EnablePacketTracking()
     m_packetTracker = new LoraPacketTracker();
 }
 
+namespace
+{
+
+/// Magic bytes and version of the binary topology snapshot format.
+const char TOPOLOGY_SNAPSHOT_MAGIC[4] = {'L', 'W', 'T', 'S'};
+const uint32_t TOPOLOGY_SNAPSHOT_VERSION = 1;
+
+/**
+ * Fixed-width end device record of the topology snapshot. Records are laid
+ * out back to back after the header, so the file can be mapped and indexed
+ * directly.
+ */
+struct SnapshotDeviceRecord
+{
+    double x;           //!< Position
+    double y;           //!< Position
+    double z;           //!< Position
+    uint32_t address;   //!< LoraDeviceAddress as a raw integer
+    uint8_t dataRate;   //!< Configured data rate
+    double txPowerDbm;  //!< Configured transmission power
+};
+
+/// Fixed-width gateway record of the topology snapshot.
+struct SnapshotGatewayRecord
+{
+    double x; //!< Position
+    double y; //!< Position
+    double z; //!< Position
+};
+
+/**
+ * Find the end device MAC on a node.
+ *
+ * @param node The node holding a LoraNetDevice.
+ * @return The MAC layer, asserting it exists.
+ */
+Ptr<ClassAEndDeviceLorawanMac>
+GetEndDeviceMac(Ptr<Node> node)
+{
+    Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(node->GetDevice(0));
+    NS_ASSERT(loraNetDevice);
+    Ptr<ClassAEndDeviceLorawanMac> mac =
+        DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+    NS_ASSERT(mac);
+    return mac;
+}
+
+} // namespace
+
+bool
+LoraHelper::SaveTopology(NodeContainer endDevices, NodeContainer gateways, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        NS_LOG_ERROR("Could not open topology snapshot file: " << filename);
+        return false;
+    }
+
+    uint32_t nDevices = endDevices.GetN();
+    uint32_t nGateways = gateways.GetN();
+    file.write(TOPOLOGY_SNAPSHOT_MAGIC, sizeof(TOPOLOGY_SNAPSHOT_MAGIC));
+    file.write(reinterpret_cast<const char*>(&TOPOLOGY_SNAPSHOT_VERSION),
+               sizeof(TOPOLOGY_SNAPSHOT_VERSION));
+    file.write(reinterpret_cast<const char*>(&nDevices), sizeof(nDevices));
+    file.write(reinterpret_cast<const char*>(&nGateways), sizeof(nGateways));
+
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        Ptr<Node> node = *j;
+        Ptr<MobilityModel> mobility = node->GetObject<MobilityModel>();
+        NS_ASSERT(mobility);
+        Ptr<ClassAEndDeviceLorawanMac> mac = GetEndDeviceMac(node);
+        Vector pos = mobility->GetPosition();
+
+        SnapshotDeviceRecord record;
+        record.x = pos.x;
+        record.y = pos.y;
+        record.z = pos.z;
+        record.address = mac->GetDeviceAddress().Get();
+        record.dataRate = mac->GetDataRate();
+        record.txPowerDbm = mac->GetTransmissionPowerDbm();
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    for (auto j = gateways.Begin(); j != gateways.End(); ++j)
+    {
+        Ptr<MobilityModel> mobility = (*j)->GetObject<MobilityModel>();
+        NS_ASSERT(mobility);
+        Vector pos = mobility->GetPosition();
+
+        SnapshotGatewayRecord record;
+        record.x = pos.x;
+        record.y = pos.y;
+        record.z = pos.z;
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    NS_LOG_INFO("Saved topology snapshot with " << nDevices << " devices and " << nGateways
+                                                << " gateways to " << filename);
+    return true;
+}
+
+bool
+LoraHelper::LoadTopology(NodeContainer endDevices, NodeContainer gateways, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        NS_LOG_ERROR("Could not open topology snapshot file: " << filename);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t nDevices = 0;
+    uint32_t nGateways = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&nDevices), sizeof(nDevices));
+    file.read(reinterpret_cast<char*>(&nGateways), sizeof(nGateways));
+    if (!file || std::memcmp(magic, TOPOLOGY_SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+        version != TOPOLOGY_SNAPSHOT_VERSION)
+    {
+        NS_LOG_ERROR(filename << " is not a version " << TOPOLOGY_SNAPSHOT_VERSION
+                              << " topology snapshot");
+        return false;
+    }
+    if (nDevices != endDevices.GetN() || nGateways != gateways.GetN())
+    {
+        NS_LOG_ERROR("Topology snapshot holds " << nDevices << " devices and " << nGateways
+                                                << " gateways, containers hold "
+                                                << endDevices.GetN() << " and "
+                                                << gateways.GetN());
+        return false;
+    }
+
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        SnapshotDeviceRecord record;
+        file.read(reinterpret_cast<char*>(&record), sizeof(record));
+        if (!file)
+        {
+            NS_LOG_ERROR("Truncated topology snapshot: " << filename);
+            return false;
+        }
+
+        Ptr<Node> node = *j;
+        Ptr<MobilityModel> mobility = node->GetObject<MobilityModel>();
+        NS_ASSERT(mobility);
+        mobility->SetPosition(Vector(record.x, record.y, record.z));
+
+        Ptr<ClassAEndDeviceLorawanMac> mac = GetEndDeviceMac(node);
+        mac->SetDeviceAddress(LoraDeviceAddress(record.address));
+        mac->SetDataRate(record.dataRate);
+        mac->SetTransmissionPowerDbm(record.txPowerDbm);
+    }
+
+    for (auto j = gateways.Begin(); j != gateways.End(); ++j)
+    {
+        SnapshotGatewayRecord record;
+        file.read(reinterpret_cast<char*>(&record), sizeof(record));
+        if (!file)
+        {
+            NS_LOG_ERROR("Truncated topology snapshot: " << filename);
+            return false;
+        }
+
+        Ptr<MobilityModel> mobility = (*j)->GetObject<MobilityModel>();
+        NS_ASSERT(mobility);
+        mobility->SetPosition(Vector(record.x, record.y, record.z));
+    }
+
+    NS_LOG_INFO("Loaded topology snapshot with " << nDevices << " devices and " << nGateways
+                                                 << " gateways from " << filename);
+    return true;
+}
+
+int64_t
+LoraHelper::AssignStreams(NodeContainer nodes, int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+
+    uint32_t maxNodeId = 0;
+    for (auto j = nodes.Begin(); j != nodes.End(); ++j)
+    {
+        Ptr<Node> node = *j;
+        maxNodeId = std::max(maxNodeId, node->GetId());
+
+        // Purpose offset 0: MAC channel selection and backoff draws. The
+        // remaining offsets of the node's block are reserved
+        int64_t base = stream + STREAMS_PER_NODE * node->GetId();
+        GetEndDeviceMac(node)->AssignStreams(base);
+    }
+
+    return nodes.GetN() > 0 ? STREAMS_PER_NODE * (int64_t(maxNodeId) + 1) : 0;
+}
+
 LoraPacketTracker&
 LoraHelper::GetPacketTracker()
 {
@@ -154,6 +378,85 @@ LoraHelper::EnableSimulationTimePrinting(Time interval)
     Simulator::Schedule(Time(0), &LoraHelper::DoPrintSimulationTime, this, interval);
 }
 
+void
+LoraHelper::EnableProgressReporting(Time endTime, Time targetWallInterval)
+{
+    NS_LOG_FUNCTION(this << endTime << targetWallInterval);
+
+    m_progressEndTime = endTime;
+    m_progressTargetWall = targetWallInterval;
+    // Conservative first guess; the interval converges on the measured
+    // rate after the first sample
+    m_progressInterval = Seconds(1);
+    m_progressStartWall = std::chrono::steady_clock::now();
+    m_progressLastWall = m_progressStartWall;
+    m_progressLastSimTime = Simulator::Now();
+    m_progressLastEventCount = Simulator::GetEventCount();
+    Simulator::Schedule(m_progressInterval, &LoraHelper::DoReportProgress, this);
+}
+
+void
+LoraHelper::SetProgressCallback(ProgressCallback callback)
+{
+    m_progressCallback = callback;
+}
+
+void
+LoraHelper::DoReportProgress()
+{
+    auto nowWall = std::chrono::steady_clock::now();
+    double wallDelta = std::chrono::duration<double>(nowWall - m_progressLastWall).count();
+    uint64_t eventCount = Simulator::GetEventCount();
+
+    ProgressSample sample;
+    sample.simTime = Simulator::Now();
+    sample.wallSeconds = std::chrono::duration<double>(nowWall - m_progressStartWall).count();
+    double simDelta = (sample.simTime - m_progressLastSimTime).GetSeconds();
+    sample.rate = (wallDelta > 0) ? simDelta / wallDelta : 0;
+    sample.eventsPerSecond =
+        (wallDelta > 0) ? double(eventCount - m_progressLastEventCount) / wallDelta : 0;
+    double secondsLeft = (m_progressEndTime - sample.simTime).GetSeconds();
+    sample.etaSeconds = (sample.rate > 0 && secondsLeft > 0) ? secondsLeft / sample.rate : -1;
+
+    double percent = m_progressEndTime.IsStrictlyPositive()
+                         ? 100 * sample.simTime.GetSeconds() / m_progressEndTime.GetSeconds()
+                         : 0;
+    std::cout << "Progress: " << sample.simTime.As(Time::S) << " / "
+              << m_progressEndTime.As(Time::S) << " (" << uint32_t(percent) << "%), "
+              << sample.rate << "x real time, " << uint64_t(sample.eventsPerSecond) << " ev/s";
+    if (sample.etaSeconds >= 0)
+    {
+        std::cout << ", ETA " << uint64_t(sample.etaSeconds) << " s";
+    }
+    std::cout << std::endl;
+
+    if (!m_progressCallback.IsNull())
+    {
+        m_progressCallback(sample);
+    }
+
+    m_progressLastWall = nowWall;
+    m_progressLastSimTime = sample.simTime;
+    m_progressLastEventCount = eventCount;
+
+    if (sample.simTime >= m_progressEndTime)
+    {
+        return;
+    }
+
+    // Adapt the interval so the next report lands about one
+    // targetWallInterval of wall-clock time later, moving at most one order
+    // of magnitude per step to smooth out bursty stretches
+    if (sample.rate > 0)
+    {
+        double next = sample.rate * m_progressTargetWall.GetSeconds();
+        double current = m_progressInterval.GetSeconds();
+        next = std::max(current / 10, std::min(next, current * 10));
+        m_progressInterval = Seconds(next);
+    }
+    Simulator::Schedule(m_progressInterval, &LoraHelper::DoReportProgress, this);
+}
+
 void
 LoraHelper::EnablePeriodicDeviceStatusPrinting(NodeContainer endDevices,
                                                NodeContainer gateways,
@@ -193,11 +496,15 @@ LoraHelper::DoPrintDeviceStatus(NodeContainer endDevices,
     }
 
     Time currentTime = Now();
+    bool keyframe = IsDeviceStatusKeyframe();
     for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
     {
         Ptr<Node> object = *j;
-        Ptr<MobilityModel> position = object->GetObject<MobilityModel>();
-        NS_ASSERT(position);
+        if (!keyframe && m_dirtyDevices.count(object->GetId()) == 0)
+        {
+            // Delta mode: nothing changed for this device since the last pass
+            continue;
+        }
         Ptr<NetDevice> netDevice = object->GetDevice(0);
         Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(netDevice);
         NS_ASSERT(loraNetDevice);
@@ -205,10 +512,11 @@ LoraHelper::DoPrintDeviceStatus(NodeContainer endDevices,
             DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
         int dr = int(mac->GetDataRate());
         double txPower = mac->GetTransmissionPowerDbm();
-        Vector pos = position->GetPosition();
+        Vector pos = PositionSnapshot::Get(object);
         outputFile << currentTime.As(Time::S) << " " << object->GetId() << " " << pos.x << " "
                    << pos.y << " " << dr << " " << unsigned(txPower) << std::endl;
     }
+    FinishDeviceStatusPass(keyframe);
     // for (NodeContainer::Iterator j = gateways.Begin (); j != gateways.End (); ++j)
     //   {
     //     Ptr<Node> object = *j;
@@ -221,6 +529,146 @@ LoraHelper::DoPrintDeviceStatus(NodeContainer endDevices,
     outputFile.close();
 }
 
+void
+LoraHelper::EnableDeviceStatusDeltaMode(NodeContainer endDevices, uint32_t keyframeEvery)
+{
+    NS_LOG_FUNCTION(this << keyframeEvery);
+
+    m_deviceStatusDeltaMode = true;
+    m_keyframeEvery = (keyframeEvery > 0) ? keyframeEvery : 1;
+    m_intervalsSinceKeyframe = 0;
+
+    // Connect the traces that invalidate a device's status row. The context
+    // string carries the node id so one sink serves every device
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        Ptr<Node> node = *j;
+        std::string context = std::to_string(node->GetId());
+        Ptr<MobilityModel> mobility = node->GetObject<MobilityModel>();
+        if (mobility)
+        {
+            mobility->TraceConnect("CourseChange",
+                                   context,
+                                   MakeCallback(&LoraHelper::OnDeviceCourseChange, this));
+        }
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(node->GetDevice(0));
+        if (loraNetDevice && loraNetDevice->GetMac())
+        {
+            loraNetDevice->GetMac()->TraceConnect(
+                "DataRate",
+                context,
+                MakeCallback(&LoraHelper::OnDeviceDataRateChange, this));
+            loraNetDevice->GetMac()->TraceConnect(
+                "TxPower",
+                context,
+                MakeCallback(&LoraHelper::OnDeviceTxPowerChange, this));
+        }
+    }
+}
+
+void
+LoraHelper::OnDeviceCourseChange(std::string context, Ptr<const MobilityModel> model)
+{
+    m_dirtyDevices.insert(std::stoul(context));
+}
+
+void
+LoraHelper::OnDeviceDataRateChange(std::string context, uint8_t oldDr, uint8_t newDr)
+{
+    m_dirtyDevices.insert(std::stoul(context));
+}
+
+void
+LoraHelper::OnDeviceTxPowerChange(std::string context, double oldTxPower, double newTxPower)
+{
+    m_dirtyDevices.insert(std::stoul(context));
+}
+
+bool
+LoraHelper::IsDeviceStatusKeyframe() const
+{
+    if (!m_deviceStatusDeltaMode)
+    {
+        return true;
+    }
+    return Now().IsZero() || m_intervalsSinceKeyframe >= m_keyframeEvery;
+}
+
+void
+LoraHelper::FinishDeviceStatusPass(bool keyframe)
+{
+    if (!m_deviceStatusDeltaMode)
+    {
+        return;
+    }
+    m_dirtyDevices.clear();
+    m_intervalsSinceKeyframe = keyframe ? 0 : m_intervalsSinceKeyframe + 1;
+}
+
+void
+LoraHelper::EnablePeriodicDeviceStatusBinaryPrinting(NodeContainer endDevices,
+                                                     NodeContainer gateways,
+                                                     std::string filename,
+                                                     Time interval)
+{
+    NS_LOG_FUNCTION(this);
+
+    DoPrintDeviceStatusBinary(endDevices, gateways, filename);
+
+    // Schedule periodic printing
+    Simulator::Schedule(interval,
+                        &LoraHelper::EnablePeriodicDeviceStatusBinaryPrinting,
+                        this,
+                        endDevices,
+                        gateways,
+                        filename,
+                        interval);
+}
+
+void
+LoraHelper::DoPrintDeviceStatusBinary(NodeContainer endDevices,
+                                      NodeContainer gateways,
+                                      std::string filename)
+{
+    if (Now().IsZero() || !m_deviceStatusWriter.IsOpen())
+    {
+        // Truncates the file and writes the column header
+        m_deviceStatusWriter.SetColumns(
+            {"Time", "NodeID", "PosX", "PosY", "DataRate", "TxPower_dBm"});
+        if (!m_deviceStatusWriter.Open(filename))
+        {
+            NS_LOG_ERROR("Could not open binary device status file: " << filename);
+            return;
+        }
+    }
+
+    double currentTime = Now().GetSeconds();
+    bool keyframe = IsDeviceStatusKeyframe();
+    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    {
+        Ptr<Node> object = *j;
+        if (!keyframe && m_dirtyDevices.count(object->GetId()) == 0)
+        {
+            // Delta mode: nothing changed for this device since the last pass
+            continue;
+        }
+        Ptr<NetDevice> netDevice = object->GetDevice(0);
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(netDevice);
+        NS_ASSERT(loraNetDevice);
+        Ptr<ClassAEndDeviceLorawanMac> mac =
+            DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+        Vector pos = PositionSnapshot::Get(object);
+        m_deviceStatusWriter.AppendRow({currentTime,
+                                        static_cast<double>(object->GetId()),
+                                        pos.x,
+                                        pos.y,
+                                        static_cast<double>(mac->GetDataRate()),
+                                        mac->GetTransmissionPowerDbm()});
+    }
+    m_deviceStatusWriter.WriteBlock();
+    FinishDeviceStatusPass(keyframe);
+}
+
 void
 LoraHelper::EnablePeriodicPhyPerformancePrinting(NodeContainer gateways,
                                                  std::string filename,
@@ -312,6 +760,208 @@ LoraHelper::DoPrintGlobalPerformance(std::string filename)
     outputFile.close();
 }
 
+void
+LoraHelper::EnablePeriodicHotPathStatsPrinting(Ptr<LoraChannel> channel,
+                                               Ptr<NetworkServer> server,
+                                               std::string filename,
+                                               Time interval)
+{
+    NS_LOG_FUNCTION(this << channel << server << filename << interval);
+
+    DoPrintHotPathStats(channel, server, filename);
+
+    Simulator::Schedule(interval,
+                        &LoraHelper::EnablePeriodicHotPathStatsPrinting,
+                        this,
+                        channel,
+                        server,
+                        filename,
+                        interval);
+}
+
+void
+LoraHelper::DoPrintHotPathStats(Ptr<LoraChannel> channel,
+                                Ptr<NetworkServer> server,
+                                std::string filename)
+{
+    NS_LOG_FUNCTION(this);
+
+    const char* c = filename.c_str();
+    std::ofstream outputFile;
+    if (Now().IsZero())
+    {
+        // Delete contents of the file as it is opened
+        outputFile.open(c, std::ofstream::out | std::ofstream::trunc);
+    }
+    else
+    {
+        // Only append to the file
+        outputFile.open(c, std::ofstream::out | std::ofstream::app);
+    }
+
+    outputFile << Now().As(Time::S);
+
+    if (channel)
+    {
+        LoraChannel::Stats channelStats = channel->GetStats();
+        outputFile << " " << channelStats.sends << " " << channelStats.receptionsScheduled;
+    }
+
+    // The interference counters aggregate over every PHY, so they are always
+    // available
+    LoraInterferenceHelper::Stats interferenceStats = LoraInterferenceHelper::GetStats();
+    outputFile << " " << interferenceStats.eventsAdded << " "
+               << interferenceStats.interferenceChecks << " " << interferenceStats.eventsExamined;
+
+    if (server)
+    {
+        NetworkServer::Stats serverStats = server->GetStats();
+        NetworkScheduler::Stats schedulerStats = server->GetNetworkScheduler()->GetStats();
+        outputFile << " " << serverStats.uplinksReceived << " "
+                   << serverStats.duplicatesShortCircuited << " "
+                   << schedulerStats.replyOpportunities << " "
+                   << schedulerStats.controllerEvaluations << " " << schedulerStats.repliesSent;
+    }
+
+    outputFile << std::endl;
+
+    outputFile.close();
+}
+
+void
+LoraHelper::EnableRunReport(std::string filename,
+                            Ptr<LoraChannel> channel,
+                            Ptr<NetworkServer> server)
+{
+    NS_LOG_FUNCTION(this << filename << channel << server);
+
+    m_runReportFilename = filename;
+    m_runReportChannel = channel;
+    m_runReportServer = server;
+
+    // Everything before this call counts as setup, everything after as run
+    m_runStartWall = std::chrono::steady_clock::now();
+
+    if (!m_runReportEnabled)
+    {
+        m_runReportEnabled = true;
+        Simulator::ScheduleDestroy(&LoraHelper::DoWriteRunReport, this);
+    }
+}
+
+void
+LoraHelper::DoWriteRunReport()
+{
+    NS_LOG_FUNCTION(this);
+
+    auto endWall = std::chrono::steady_clock::now();
+    double setupSeconds = std::chrono::duration<double>(m_runStartWall - m_setupStartWall).count();
+    double runSeconds = std::chrono::duration<double>(endWall - m_runStartWall).count();
+    double simSeconds = Now().GetSeconds();
+    uint64_t events = Simulator::GetEventCount();
+    double rate = (runSeconds > 0) ? simSeconds / runSeconds : 0;
+    double eventsPerWallSecond = (runSeconds > 0) ? events / runSeconds : 0;
+
+    // Global uplink delivery from the tracker, when packet tracking is on
+    uint64_t uplinksSent = 0;
+    uint64_t uplinksDelivered = 0;
+    if (m_packetTracker)
+    {
+        std::istringstream counts(m_packetTracker->CountMacPacketsGlobally(Time(0), Now()));
+        counts >> uplinksSent >> uplinksDelivered;
+    }
+
+    std::ofstream out(m_runReportFilename.c_str(), std::ofstream::out | std::ofstream::trunc);
+    if (!out.is_open())
+    {
+        NS_LOG_ERROR("Could not open run report file " << m_runReportFilename);
+        return;
+    }
+
+    out << "{\n";
+    out << "  \"schema\": 1,\n";
+    out << "  \"phases\": {\n";
+    out << "    \"setupWallSeconds\": " << setupSeconds << ",\n";
+    out << "    \"runWallSeconds\": " << runSeconds << ",\n";
+    out << "    \"simulatedSeconds\": " << simSeconds << ",\n";
+    out << "    \"simSecondsPerWallSecond\": " << rate << "\n";
+    out << "  },\n";
+    out << "  \"events\": {\n";
+    out << "    \"executed\": " << events << ",\n";
+    out << "    \"perWallSecond\": " << eventsPerWallSecond << "\n";
+    out << "  },\n";
+
+    // The interference counters aggregate over every PHY, so they are always
+    // available; the channel and server sections depend on the pointers
+    out << "  \"counters\": {\n";
+    LoraInterferenceHelper::Stats interferenceStats = LoraInterferenceHelper::GetStats();
+    out << "    \"interference\": {\"eventsAdded\": " << interferenceStats.eventsAdded
+        << ", \"interferenceChecks\": " << interferenceStats.interferenceChecks
+        << ", \"eventsExamined\": " << interferenceStats.eventsExamined << "}";
+    if (m_runReportChannel)
+    {
+        LoraChannel::Stats channelStats = m_runReportChannel->GetStats();
+        out << ",\n    \"channel\": {\"sends\": " << channelStats.sends
+            << ", \"receptionsScheduled\": " << channelStats.receptionsScheduled
+            << ", \"fanOutEvents\": " << channelStats.fanOutEvents << "}";
+    }
+    if (m_runReportServer)
+    {
+        NetworkServer::Stats serverStats = m_runReportServer->GetStats();
+        NetworkScheduler::Stats schedulerStats =
+            m_runReportServer->GetNetworkScheduler()->GetStats();
+        out << ",\n    \"server\": {\"uplinksReceived\": " << serverStats.uplinksReceived
+            << ", \"duplicatesShortCircuited\": " << serverStats.duplicatesShortCircuited
+            << ", \"stagingOverflows\": " << serverStats.stagingOverflows << "}";
+        out << ",\n    \"scheduler\": {\"replyOpportunities\": " << schedulerStats.replyOpportunities
+            << ", \"controllerEvaluations\": " << schedulerStats.controllerEvaluations
+            << ", \"repliesSent\": " << schedulerStats.repliesSent
+            << ", \"duplicateTriggersAbsorbed\": " << schedulerStats.duplicateTriggersAbsorbed
+            << "}";
+    }
+    out << "\n  },\n";
+
+    out << "  \"memoryBytes\": {";
+    bool firstMemoryEntry = true;
+    if (m_packetTracker)
+    {
+        out << "\"packetTracker\": " << m_packetTracker->MemoryReport();
+        firstMemoryEntry = false;
+    }
+    if (m_runReportServer)
+    {
+        out << (firstMemoryEntry ? "" : ", ")
+            << "\"networkStatus\": " << m_runReportServer->GetNetworkStatus()->MemoryReport();
+    }
+    out << "}";
+
+    if (m_packetTracker)
+    {
+        double deliveryRatio = (uplinksSent > 0) ? double(uplinksDelivered) / uplinksSent : 0;
+        double uplinksPerSimSecond = (simSeconds > 0) ? uplinksSent / simSeconds : 0;
+        out << ",\n  \"throughput\": {\n";
+        out << "    \"uplinksSent\": " << uplinksSent << ",\n";
+        out << "    \"uplinksDelivered\": " << uplinksDelivered << ",\n";
+        out << "    \"deliveryRatio\": " << deliveryRatio << ",\n";
+        out << "    \"uplinksPerSimulatedSecond\": " << uplinksPerSimSecond << "\n";
+        out << "  }";
+    }
+    out << "\n}\n";
+    out.close();
+
+    // Compact human summary of the same numbers
+    std::cout << "Run report written to " << m_runReportFilename << std::endl;
+    std::cout << "  setup " << setupSeconds << " s wall, run " << runSeconds << " s wall for "
+              << simSeconds << " s simulated (" << rate << "x real time)" << std::endl;
+    std::cout << "  " << events << " events (" << eventsPerWallSecond << "/s)";
+    if (m_packetTracker && uplinksSent > 0)
+    {
+        std::cout << ", " << uplinksDelivered << "/" << uplinksSent << " uplinks delivered ("
+                  << 100.0 * uplinksDelivered / uplinksSent << "%)";
+    }
+    std::cout << std::endl;
+}
+
 void
 LoraHelper::DoPrintSimulationTime(Time interval)
 {
@@ -13,12 +13,18 @@
 #include "lora-phy-helper.h"
 #include "lorawan-mac-helper.h"
 
+#include "ns3/columnar-export.h"
+#include "ns3/lora-channel.h"
 #include "ns3/lora-net-device.h"
+#include "ns3/network-server.h"
+#include "ns3/mobility-model.h"
 #include "ns3/net-device-container.h"
 #include "ns3/net-device.h"
 #include "ns3/node-container.h"
 
+#include <chrono>
 #include <ctime>
+#include <set>
 
 namespace ns3
 {
@@ -74,10 +80,56 @@ class LoraHelper
     /**
      * Periodically prints the simulation time to the standard output.
      *
+     * @see EnableProgressReporting for a rate and ETA report whose overhead
+     * adapts to the actual simulation speed.
+     *
      * @param interval The time period of the interval.
      */
     void EnableSimulationTimePrinting(Time interval);
 
+    /**
+     * A progress sample of the running simulation.
+     */
+    struct ProgressSample
+    {
+        Time simTime;         //!< The simulation time of the sample.
+        double wallSeconds;   //!< Wall-clock seconds since reporting was enabled.
+        double rate;          //!< Simulated seconds per wall-clock second over the last interval.
+        double etaSeconds;    //!< Estimated wall-clock seconds left, negative if unknown.
+        double eventsPerSecond; //!< Events executed per wall-clock second over the last interval.
+    };
+
+    /**
+     * Callback type for progress samples.
+     */
+    typedef Callback<void, const ProgressSample&> ProgressCallback;
+
+    /**
+     * Periodically report simulation progress with bounded overhead.
+     *
+     * Each report prints one line with the simulation time, the rate of
+     * simulated versus wall-clock time, the event execution rate and the
+     * estimated wall-clock time left to reach endTime. The sampling interval
+     * adapts to the measured rate so that, whether the run crawls or flies,
+     * roughly one report lands per targetWallInterval of wall-clock time and
+     * the reporting cost stays negligible.
+     *
+     * @param endTime The simulation time the run is expected to stop at,
+     * used for the ETA and the progress percentage.
+     * @param targetWallInterval The desired wall-clock time between reports.
+     */
+    void EnableProgressReporting(Time endTime, Time targetWallInterval = Seconds(10));
+
+    /**
+     * Register a callback invoked with every progress sample.
+     *
+     * The callback receives the same data the report line prints, so an
+     * external orchestrator can watch for stalls without parsing output.
+     *
+     * @param callback The callback to invoke.
+     */
+    void SetProgressCallback(ProgressCallback callback);
+
     /**
      * Periodically prints the status of devices in the network to a file.
      *
@@ -95,6 +147,46 @@ class LoraHelper
                                             std::string filename,
                                             Time interval);
 
+    /**
+     * Only write changed device status rows between periodic full keyframes.
+     *
+     * The periodic device status printers re-dump every device each interval
+     * even though, once ADR has converged, almost nothing changes. In delta
+     * mode a per-device dirty flag is set by the MAC DataRate/TxPower trace
+     * sources and the mobility CourseChange trace, and intermediate intervals
+     * only write the dirty rows; every keyframeEvery-th interval still writes
+     * a full keyframe so readers can resynchronize. Rows keep their format,
+     * with last-value-wins semantics per device.
+     *
+     * Call this before the first scheduled print. The dirty set is shared, so
+     * enable only one of the text and binary periodic printers with delta
+     * mode active.
+     *
+     * @param endDevices The devices whose traces set the dirty flags.
+     * @param keyframeEvery Write a full keyframe every this many intervals.
+     */
+    void EnableDeviceStatusDeltaMode(NodeContainer endDevices, uint32_t keyframeEvery = 12);
+
+    /**
+     * Periodically writes the status of devices to a binary columnar file.
+     *
+     * Same content as EnablePeriodicDeviceStatusPrinting, but serialized as
+     * raw per-column doubles via BinaryColumnarWriter, which avoids the
+     * double-to-text formatting cost on long runs. Convert the output with
+     * the columnar-to-csv example.
+     *
+     * @param endDevices The devices to track.
+     * @param gateways The gateways in the network (this is only a placeholder parameter).
+     * @param filename The output filename.
+     * @param interval The time interval for printing.
+     *
+     * @todo Remove unused parameter gateways.
+     */
+    void EnablePeriodicDeviceStatusBinaryPrinting(NodeContainer endDevices,
+                                                  NodeContainer gateways,
+                                                  std::string filename,
+                                                  Time interval);
+
     /**
      * Periodically prints PHY-level performance at every gateway in the container.
      *
@@ -138,6 +230,119 @@ class LoraHelper
      */
     void DoPrintGlobalPerformance(std::string filename);
 
+    /**
+     * Periodically dump the hot-path counters of the main simulation engines
+     * to a file, one row per interval.
+     *
+     * Each row holds the current time followed by the cumulative counters of
+     * the channel (sends, receptions scheduled), the interference helper
+     * (events added, checks, events examined), the network server (uplinks,
+     * duplicates short-circuited) and the scheduler (opportunities,
+     * controller evaluations, replies sent). Either pointer may be null to
+     * omit that engine's columns.
+     *
+     * @param channel The channel to track, or nullptr.
+     * @param server The network server application to track, or nullptr.
+     * @param filename The output filename.
+     * @param interval The time interval for printing.
+     */
+    void EnablePeriodicHotPathStatsPrinting(Ptr<LoraChannel> channel,
+                                            Ptr<NetworkServer> server,
+                                            std::string filename,
+                                            Time interval);
+
+    /**
+     * Write one row of hot-path counters.
+     *
+     * @param channel The channel to track, or nullptr.
+     * @param server The network server application to track, or nullptr.
+     * @param filename The output filename.
+     */
+    void DoPrintHotPathStats(Ptr<LoraChannel> channel,
+                             Ptr<NetworkServer> server,
+                             std::string filename);
+
+    /**
+     * Leave a consolidated performance fingerprint behind at the end of the
+     * run.
+     *
+     * Call this right before Simulator::Run(): the call marks the boundary
+     * between the setup and run phases, and schedules the report to be
+     * written when the simulator is destroyed. The report folds the module's
+     * always-on instrumentation into one machine-readable JSON file --
+     * wall-clock time per phase, executed event count, the hot-path counters
+     * of the channel, interference helper, network server and scheduler, the
+     * memory reports of the packet tracker and network status, and global
+     * uplink throughput -- so consecutive runs can be diffed without
+     * stitching together the periodic dumps. A compact human summary of the
+     * same numbers is printed to the standard output.
+     *
+     * Sections whose source is missing (null pointers, tracking disabled)
+     * are omitted from the JSON rather than written as zeros.
+     *
+     * @param filename The JSON file to write.
+     * @param channel The channel whose counters to include, or nullptr.
+     * @param server The network server application whose counters and status
+     * memory report to include, or nullptr.
+     */
+    void EnableRunReport(std::string filename,
+                         Ptr<LoraChannel> channel = nullptr,
+                         Ptr<NetworkServer> server = nullptr);
+
+    /**
+     * Save the configured topology to a versioned binary snapshot.
+     *
+     * Captures each end device's position, device address, data rate and
+     * transmission power, and each gateway's position, as fixed-width
+     * records. Together with LoadTopology this skips re-running the helper
+     * loops and propagation evaluations (SetSpreadingFactorsUp) that produce
+     * identical state between runs.
+     *
+     * @param endDevices The end devices to snapshot.
+     * @param gateways The gateways to snapshot.
+     * @param filename The snapshot file to write.
+     * @return True on success.
+     */
+    bool SaveTopology(NodeContainer endDevices, NodeContainer gateways, std::string filename);
+
+    /**
+     * Restore device and gateway state from a snapshot written by
+     * SaveTopology.
+     *
+     * The containers must hold as many nodes as the snapshot records; nodes
+     * must already have their mobility models and LoraNetDevices installed,
+     * since the snapshot restores state into them rather than creating them.
+     *
+     * @param endDevices The end devices to restore into.
+     * @param gateways The gateways to restore into.
+     * @param filename The snapshot file to read.
+     * @return True on success, false if the file is missing, malformed or
+     * sized for a different topology.
+     */
+    bool LoadTopology(NodeContainer endDevices, NodeContainer gateways, std::string filename);
+
+    /**
+     * Assign fixed, node-id-derived RNG streams to the random variables of
+     * the given nodes' LoRaWAN MAC layers.
+     *
+     * Each node gets a block of STREAMS_PER_NODE stream indices at
+     * stream + STREAMS_PER_NODE * nodeId, with a fixed purpose offset inside
+     * the block, so a device's random draws depend only on (seed, run,
+     * node id, purpose) and not on container order, on what other models
+     * allocate, or on the interleaving of any parallel execution stage.
+     * Unused offsets in each block are reserved for future per-node purposes
+     * so assignments never shift across versions.
+     *
+     * @param nodes The nodes whose MAC random variables to pin.
+     * @param stream The first stream index of node id 0's block.
+     * @return The number of stream indices consumed, covering every block up
+     * to the highest node id seen.
+     */
+    int64_t AssignStreams(NodeContainer nodes, int64_t stream);
+
+    /// Stream indices reserved per node by AssignStreams.
+    static constexpr int64_t STREAMS_PER_NODE = 8;
+
     /**
      * Get a reference to the Packet Tracker object.
      *
@@ -163,6 +368,20 @@ class LoraHelper
                              NodeContainer gateways,
                              std::string filename);
 
+    /**
+     * Write a summary of the current status of input devices as one binary
+     * columnar block.
+     *
+     * @param endDevices The devices to track.
+     * @param gateways The gateways in the network (this is only a placeholder parameter).
+     * @param filename The output filename.
+     *
+     * @todo Remove unused parameter gateways.
+     */
+    void DoPrintDeviceStatusBinary(NodeContainer endDevices,
+                                   NodeContainer gateways,
+                                   std::string filename);
+
   private:
     /**
      * Actually print the simulation time and re-schedule execution of this
@@ -172,8 +391,89 @@ class LoraHelper
      */
     void DoPrintSimulationTime(Time interval);
 
+    /**
+     * Take a progress sample, print the report line, invoke the callback
+     * and schedule the next sample at the adapted interval.
+     */
+    void DoReportProgress();
+
+    Time m_progressEndTime;        //!< The expected end of the simulation.
+    Time m_progressTargetWall;     //!< Desired wall-clock time between reports.
+    Time m_progressInterval;       //!< The current (adapted) sampling interval.
+    ProgressCallback m_progressCallback; //!< Optional per-sample callback.
+
+    /// When progress reporting was enabled.
+    std::chrono::steady_clock::time_point m_progressStartWall;
+    /// When the last progress sample was taken.
+    std::chrono::steady_clock::time_point m_progressLastWall;
+    Time m_progressLastSimTime;        //!< Simulation time of the last sample.
+    uint64_t m_progressLastEventCount; //!< Executed event count at the last sample.
+
+    /**
+     * Trace sink marking a device dirty after a mobility course change.
+     *
+     * @param context The node id, set at trace connect time.
+     * @param model The mobility model that changed (unused).
+     */
+    void OnDeviceCourseChange(std::string context, Ptr<const MobilityModel> model);
+
+    /**
+     * Trace sink marking a device dirty after a data rate change.
+     *
+     * @param context The node id, set at trace connect time.
+     * @param oldDr The previous data rate (unused).
+     * @param newDr The new data rate (unused).
+     */
+    void OnDeviceDataRateChange(std::string context, uint8_t oldDr, uint8_t newDr);
+
+    /**
+     * Trace sink marking a device dirty after a transmission power change.
+     *
+     * @param context The node id, set at trace connect time.
+     * @param oldTxPower The previous transmission power (unused).
+     * @param newTxPower The new transmission power (unused).
+     */
+    void OnDeviceTxPowerChange(std::string context, double oldTxPower, double newTxPower);
+
+    /**
+     * Whether the current device status pass should write every row.
+     *
+     * @return True outside delta mode, at time zero and on keyframe intervals.
+     */
+    bool IsDeviceStatusKeyframe() const;
+
+    /**
+     * Advance the delta-mode bookkeeping after a device status pass.
+     *
+     * @param keyframe Whether the pass that just finished was a keyframe.
+     */
+    void FinishDeviceStatusPass(bool keyframe);
+
+    bool m_deviceStatusDeltaMode = false;  //!< Whether delta mode is active
+    uint32_t m_keyframeEvery = 12;         //!< Full keyframe period, in intervals
+    uint32_t m_intervalsSinceKeyframe = 0; //!< Intervals since the last keyframe
+    std::set<uint32_t> m_dirtyDevices;     //!< Node ids with pending status changes
+
+    /**
+     * Write the consolidated run report and print the human summary.
+     *
+     * Runs at Simulator::Destroy time, after the last event, so every
+     * counter it reads holds its end-of-run value.
+     */
+    void DoWriteRunReport();
+
+    bool m_runReportEnabled = false;       //!< Whether a run report is scheduled
+    std::string m_runReportFilename;       //!< Destination of the JSON report
+    Ptr<LoraChannel> m_runReportChannel;   //!< Channel whose counters to report, or nullptr
+    Ptr<NetworkServer> m_runReportServer;  //!< Server whose counters to report, or nullptr
+    /// When the helper was constructed, taken as the start of the setup phase.
+    std::chrono::steady_clock::time_point m_setupStartWall;
+    /// When EnableRunReport was called, taken as the start of the run phase.
+    std::chrono::steady_clock::time_point m_runStartWall;
+
     Time m_lastPhyPerformanceUpdate;    //!< Timestamp of the last PHY performance update
     Time m_lastGlobalPerformanceUpdate; //!< Timestamp of the last global performance update
+    BinaryColumnarWriter m_deviceStatusWriter; //!< Columnar sink for the binary device status file
 };
 
 } // namespace lorawan
@@ -8,12 +8,19 @@
 
 #include "lora-packet-tracker.h"
 
+#include "ns3/assert.h"
+#include "ns3/device-registry.h"
 #include "ns3/log.h"
+#include "ns3/lora-phy.h"
+#include "ns3/lora-tag.h"
 #include "ns3/lorawan-mac-header.h"
+#include "ns3/memory-report.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 namespace ns3
 {
@@ -43,12 +50,23 @@ LoraPacketTracker::MacTransmissionCallback(Ptr<const Packet> packet)
         NS_LOG_INFO("A new packet was sent by the MAC layer");
 
         MacPacketStatus status;
-        status.packet = packet;
         status.sendTime = Now();
         status.senderId = Simulator::GetContext();
         status.receivedTime = Time::Max();
 
-        m_macPacketTracker.insert(std::pair<Ptr<const Packet>, MacPacketStatus>(packet, status));
+        bool inserted =
+            m_macPacketTracker
+                .insert(std::pair<uint64_t, MacPacketStatus>(packet->GetUid(), status))
+                .second;
+        // SentNewPacket fires once per fresh MAC packet (retransmissions do
+        // not re-fire it), so a key collision can only mean payloads were
+        // handed out with non-unique UIDs, which would silently corrupt
+        // every UID-keyed record in this tracker
+        NS_ASSERT_MSG(inserted,
+                      "Duplicate packet UID " << packet->GetUid() << " on a fresh MAC send");
+        BucketFor(status.sendTime).macSent++;
+
+        EvictFinalizedEntries();
     }
 }
 
@@ -68,7 +86,24 @@ LoraPacketTracker::RequiredTransmissionsCallback(uint8_t reqTx,
     entry.reTxAttempts = reqTx;
     entry.successful = success;
 
-    m_reTransmissionTracker.insert(std::pair<Ptr<Packet>, RetransmissionStatus>(packet, entry));
+    bool inserted =
+        m_reTransmissionTracker
+            .insert(std::pair<uint64_t, RetransmissionStatus>(packet->GetUid(), entry))
+            .second;
+    // The retransmission procedure of one packet finishes exactly once, so
+    // as above a key collision flags non-unique payload UIDs
+    NS_ASSERT_MSG(inserted,
+                  "Duplicate packet UID " << packet->GetUid()
+                                          << " finishing the retransmission procedure");
+    IntervalBucket& bucket = BucketFor(entry.firstAttempt);
+    bucket.cpsrSent++;
+    if (success)
+    {
+        bucket.cpsrAcked++;
+    }
+    bucket.retxHistogram[std::clamp<size_t>(reqTx, 1, MAX_RETX_ATTEMPTS) - 1]++;
+
+    EvictFinalizedEntries();
 }
 
 void
@@ -80,14 +115,21 @@ LoraPacketTracker::MacGwReceptionCallback(Ptr<const Packet> packet)
                     << Simulator::GetContext());
 
         // Find the received packet in the m_macPacketTracker
-        auto it = m_macPacketTracker.find(packet);
+        auto it = m_macPacketTracker.find(packet->GetUid());
         if (it != m_macPacketTracker.end())
         {
+            if ((*it).second.receptionTimes.empty())
+            {
+                // First gateway to get this packet: it flips to received
+                BucketFor((*it).second.sendTime).macReceived++;
+            }
             (*it).second.receptionTimes.insert(
                 std::pair<int, Time>(Simulator::GetContext(), Now()));
         }
-        else
+        else if (m_retentionTime.IsZero() && m_maxTrackedPackets == 0)
         {
+            // With eviction enabled a missing entry is expected; without it,
+            // this still flags a broken trace wiring
             NS_ABORT_MSG("Packet not found in tracker");
         }
     }
@@ -105,11 +147,22 @@ LoraPacketTracker::TransmissionCallback(Ptr<const Packet> packet, uint32_t edId)
         NS_LOG_INFO("PHY packet " << packet << " was transmitted by device " << edId);
         // Create a packetStatus
         PacketStatus status;
-        status.packet = packet;
         status.sendTime = Now();
         status.senderId = edId;
 
-        m_packetTracker.insert(std::pair<Ptr<const Packet>, PacketStatus>(packet, status));
+        // Unlike the MAC-level sinks, retransmissions of a confirmed packet
+        // re-enter this callback with the same UID: only the first attempt
+        // creates the record and counts as phySent, so a guard (not an
+        // assertion) is the correct behavior here
+        if (m_packetTracker.insert(std::pair<uint64_t, PacketStatus>(packet->GetUid(), status))
+                .second)
+        {
+            BucketFor(status.sendTime).phySent++;
+            UpdatePhyBreakdowns(packet, -1);
+            RecordAirtime(packet, edId);
+        }
+
+        EvictFinalizedEntries();
     }
 }
 
@@ -121,8 +174,17 @@ LoraPacketTracker::PacketReceptionCallback(Ptr<const Packet> packet, uint32_t gw
         // Remove the successfully received packet from the list of sent ones
         NS_LOG_INFO("PHY packet " << packet << " was successfully received at gateway " << gwId);
 
-        auto it = m_packetTracker.find(packet);
-        (*it).second.outcomes.insert(std::pair<int, enum PhyPacketOutcome>(gwId, RECEIVED));
+        auto it = m_packetTracker.find(packet->GetUid());
+        if (it == m_packetTracker.end())
+        {
+            return; // Evicted under the retention policy
+        }
+        if ((*it).second.outcomes.insert(std::pair<int, enum PhyPacketOutcome>(gwId, RECEIVED))
+                .second)
+        {
+            BucketFor((*it).second.sendTime).gwOutcomes[gwId][RECEIVED]++;
+            UpdatePhyBreakdowns(packet, RECEIVED);
+        }
     }
 }
 
@@ -133,8 +195,17 @@ LoraPacketTracker::InterferenceCallback(Ptr<const Packet> packet, uint32_t gwId)
     {
         NS_LOG_INFO("PHY packet " << packet << " was interfered at gateway " << gwId);
 
-        auto it = m_packetTracker.find(packet);
-        (*it).second.outcomes.insert(std::pair<int, enum PhyPacketOutcome>(gwId, INTERFERED));
+        auto it = m_packetTracker.find(packet->GetUid());
+        if (it == m_packetTracker.end())
+        {
+            return; // Evicted under the retention policy
+        }
+        if ((*it).second.outcomes.insert(std::pair<int, enum PhyPacketOutcome>(gwId, INTERFERED))
+                .second)
+        {
+            BucketFor((*it).second.sendTime).gwOutcomes[gwId][INTERFERED]++;
+            UpdatePhyBreakdowns(packet, INTERFERED);
+        }
     }
 }
 
@@ -145,9 +216,18 @@ LoraPacketTracker::NoMoreReceiversCallback(Ptr<const Packet> packet, uint32_t gw
     {
         NS_LOG_INFO("PHY packet " << packet << " was lost because no more receivers at gateway "
                                   << gwId);
-        auto it = m_packetTracker.find(packet);
-        (*it).second.outcomes.insert(
-            std::pair<int, enum PhyPacketOutcome>(gwId, NO_MORE_RECEIVERS));
+        auto it = m_packetTracker.find(packet->GetUid());
+        if (it == m_packetTracker.end())
+        {
+            return; // Evicted under the retention policy
+        }
+        if ((*it).second.outcomes
+                .insert(std::pair<int, enum PhyPacketOutcome>(gwId, NO_MORE_RECEIVERS))
+                .second)
+        {
+            BucketFor((*it).second.sendTime).gwOutcomes[gwId][NO_MORE_RECEIVERS]++;
+            UpdatePhyBreakdowns(packet, NO_MORE_RECEIVERS);
+        }
     }
 }
 
@@ -159,9 +239,18 @@ LoraPacketTracker::UnderSensitivityCallback(Ptr<const Packet> packet, uint32_t g
         NS_LOG_INFO("PHY packet " << packet << " was lost because under sensitivity at gateway "
                                   << gwId);
 
-        auto it = m_packetTracker.find(packet);
-        (*it).second.outcomes.insert(
-            std::pair<int, enum PhyPacketOutcome>(gwId, UNDER_SENSITIVITY));
+        auto it = m_packetTracker.find(packet->GetUid());
+        if (it == m_packetTracker.end())
+        {
+            return; // Evicted under the retention policy
+        }
+        if ((*it).second.outcomes
+                .insert(std::pair<int, enum PhyPacketOutcome>(gwId, UNDER_SENSITIVITY))
+                .second)
+        {
+            BucketFor((*it).second.sendTime).gwOutcomes[gwId][UNDER_SENSITIVITY]++;
+            UpdatePhyBreakdowns(packet, UNDER_SENSITIVITY);
+        }
     }
 }
 
@@ -175,9 +264,192 @@ LoraPacketTracker::LostBecauseTxCallback(Ptr<const Packet> packet, uint32_t gwId
                           << " was lost because of concurrent downlink transmission at gateway "
                           << gwId);
 
-        auto it = m_packetTracker.find(packet);
-        (*it).second.outcomes.insert(std::pair<int, enum PhyPacketOutcome>(gwId, LOST_BECAUSE_TX));
+        auto it = m_packetTracker.find(packet->GetUid());
+        if (it == m_packetTracker.end())
+        {
+            return; // Evicted under the retention policy
+        }
+        if ((*it).second.outcomes
+                .insert(std::pair<int, enum PhyPacketOutcome>(gwId, LOST_BECAUSE_TX))
+                .second)
+        {
+            BucketFor((*it).second.sendTime).gwOutcomes[gwId][LOST_BECAUSE_TX]++;
+            UpdatePhyBreakdowns(packet, LOST_BECAUSE_TX);
+        }
+    }
+}
+
+void
+LoraPacketTracker::UpdatePhyBreakdowns(Ptr<const Packet> packet, int outcome)
+{
+    LoraTag tag;
+    if (!packet->PeekPacketTag(tag))
+    {
+        return; // No radio metadata to break down by
+    }
+
+    uint8_t sf = tag.GetSpreadingFactor();
+    PhyOutcomeCounters* bySf = (sf >= 7 && sf <= 12) ? &m_sfCounters[sf - 7] : nullptr;
+    PhyOutcomeCounters* byChannel = ChannelSlot(tag.GetFrequency());
+
+    for (auto* counters : {bySf, byChannel})
+    {
+        if (!counters)
+        {
+            continue;
+        }
+        if (outcome < 0)
+        {
+            counters->sent += 1;
+        }
+        else
+        {
+            counters->outcomes[outcome] += 1;
+        }
+    }
+}
+
+void
+LoraPacketTracker::RecordAirtime(Ptr<const Packet> packet, uint32_t senderId)
+{
+    LoraTag tag;
+    if (!packet->PeekPacketTag(tag))
+    {
+        return; // No radio metadata to price the transmission with
+    }
+    uint8_t sf = tag.GetSpreadingFactor();
+    if (sf < 7 || sf > 12)
+    {
+        return;
+    }
+
+    LoraTxParameters txParams;
+    txParams.sf = sf;
+    txParams.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(txParams) > MilliSeconds(16);
+    // GetOnAirTime memoizes per (parameters, size), so this is a lookup on
+    // the hot path
+    Time airtime = LoraPhy::GetOnAirTime(packet->Copy(), txParams);
+
+    uint32_t deviceIndex = tag.GetDeviceIndex();
+    if (deviceIndex != DeviceRegistry::INVALID_INDEX)
+    {
+        if (deviceIndex >= m_airtimeByDeviceIndex.size())
+        {
+            m_airtimeByDeviceIndex.resize(std::max<size_t>(deviceIndex + 1,
+                                                           DeviceRegistry::Count()));
+        }
+        m_airtimeByDeviceIndex[deviceIndex] += airtime;
+    }
+    else
+    {
+        m_airtimeByDevice[senderId] += airtime;
+    }
+    m_airtimeBySf[sf - 7] += airtime;
+    if (PhyOutcomeCounters* slot = ChannelSlot(tag.GetFrequency()))
+    {
+        m_airtimeByChannel[slot - m_channelCounters.data()] += airtime;
+    }
+    m_totalAirtime += airtime;
+}
+
+Time
+LoraPacketTracker::GetDeviceAirtime(uint32_t nodeId) const
+{
+    uint32_t deviceIndex = DeviceRegistry::IndexOfNode(nodeId);
+    if (deviceIndex != DeviceRegistry::INVALID_INDEX &&
+        deviceIndex < m_airtimeByDeviceIndex.size())
+    {
+        return m_airtimeByDeviceIndex[deviceIndex];
+    }
+    auto it = m_airtimeByDevice.find(nodeId);
+    return it != m_airtimeByDevice.end() ? it->second : Time(0);
+}
+
+Time
+LoraPacketTracker::GetSfAirtime(uint8_t sf) const
+{
+    NS_ASSERT_MSG(sf >= 7 && sf <= 12, "Spreading factor out of range: " << unsigned(sf));
+    return m_airtimeBySf[sf - 7];
+}
+
+Time
+LoraPacketTracker::GetChannelAirtime(uint32_t frequencyHz) const
+{
+    for (size_t i = 0; i < m_channelFrequencies.size(); i++)
+    {
+        if (m_channelFrequencies[i] == frequencyHz)
+        {
+            return m_airtimeByChannel[i];
+        }
+    }
+    return Time(0);
+}
+
+Time
+LoraPacketTracker::GetTotalAirtime() const
+{
+    return m_totalAirtime;
+}
+
+std::string
+LoraPacketTracker::PrintAirtimeLedger() const
+{
+    std::stringstream output;
+    for (uint8_t sf = 7; sf <= 12; sf++)
+    {
+        output << "sf " << unsigned(sf) << " " << m_airtimeBySf[sf - 7].GetSeconds() << std::endl;
+    }
+    for (size_t i = 0; i < m_channelFrequencies.size(); i++)
+    {
+        output << "channel " << m_channelFrequencies[i] << " "
+               << m_airtimeByChannel[i].GetSeconds() << std::endl;
     }
+    output << "total " << m_totalAirtime.GetSeconds() << std::endl;
+    return output.str();
+}
+
+PhyOutcomeCounters*
+LoraPacketTracker::ChannelSlot(uint32_t frequencyHz)
+{
+    for (size_t i = 0; i < m_channelFrequencies.size(); i++)
+    {
+        if (m_channelFrequencies[i] == frequencyHz)
+        {
+            return &m_channelCounters[i];
+        }
+    }
+    if (m_channelFrequencies.size() >= MAX_TRACKED_CHANNELS)
+    {
+        return nullptr; // Slots exhausted; further frequencies are not broken down
+    }
+    m_channelFrequencies.push_back(frequencyHz);
+    return &m_channelCounters[m_channelFrequencies.size() - 1];
+}
+
+PhyOutcomeCounters&
+LoraPacketTracker::GetSfCounters(uint8_t sf)
+{
+    NS_ASSERT_MSG(sf >= 7 && sf <= 12, "Spreading factor out of range: " << unsigned(sf));
+    return m_sfCounters[sf - 7];
+}
+
+const PhyOutcomeCounters*
+LoraPacketTracker::GetChannelCounters(uint32_t frequencyHz) const
+{
+    for (size_t i = 0; i < m_channelFrequencies.size(); i++)
+    {
+        if (m_channelFrequencies[i] == frequencyHz)
+        {
+            return &m_channelCounters[i];
+        }
+    }
+    return nullptr;
+}
+
+const std::vector<uint32_t>&
+LoraPacketTracker::GetTrackedChannelFrequencies() const
+{
+    return m_channelFrequencies;
 }
 
 bool
@@ -191,66 +463,169 @@ LoraPacketTracker::IsUplink(Ptr<const Packet> packet)
     return mHdr.IsUplink();
 }
 
-////////////////////////
-// Counting Functions //
-////////////////////////
+////////////////////
+// Interval index //
+////////////////////
 
-std::vector<int>
-LoraPacketTracker::CountPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
+LoraPacketTracker::IntervalBucket&
+LoraPacketTracker::BucketFor(Time t)
 {
-    // Vector packetCounts will contain - for the interval given in the input of
-    // the function, the following fields: totPacketsSent receivedPackets
-    // interferedPackets noMoreGwPackets underSensitivityPackets lostBecauseTxPackets
+    return m_intervalIndex[t.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds()];
+}
 
-    std::vector<int> packetCounts(6, 0);
+bool
+LoraPacketTracker::IsBucketAligned(Time t) const
+{
+    return t.GetNanoSeconds() % m_indexBucketWidth.GetNanoSeconds() == 0;
+}
 
-    for (auto itPhy = m_packetTracker.begin(); itPhy != m_packetTracker.end(); ++itPhy)
+void
+LoraPacketTracker::SetIntervalIndexBucketWidth(Time width)
+{
+    NS_ASSERT_MSG(width.IsStrictlyPositive(), "Bucket width must be strictly positive");
+
+    m_indexBucketWidth = width;
+
+    // Re-index packets tracked so far under the new width
+    m_intervalIndex.clear();
+    for (const auto& entry : m_packetTracker)
     {
-        if ((*itPhy).second.sendTime >= startTime && (*itPhy).second.sendTime <= stopTime)
+        IntervalBucket& bucket = BucketFor(entry.second.sendTime);
+        bucket.phySent++;
+        for (const auto& outcome : entry.second.outcomes)
         {
-            packetCounts.at(0)++;
+            if (outcome.second < UNSET)
+            {
+                bucket.gwOutcomes[outcome.first][outcome.second]++;
+            }
+        }
+    }
+    for (const auto& entry : m_macPacketTracker)
+    {
+        IntervalBucket& bucket = BucketFor(entry.second.sendTime);
+        bucket.macSent++;
+        if (!entry.second.receptionTimes.empty())
+        {
+            bucket.macReceived++;
+        }
+    }
+    for (const auto& entry : m_reTransmissionTracker)
+    {
+        IntervalBucket& bucket = BucketFor(entry.second.firstAttempt);
+        bucket.cpsrSent++;
+        if (entry.second.successful)
+        {
+            bucket.cpsrAcked++;
+        }
+        bucket.retxHistogram[std::clamp<size_t>(entry.second.reTxAttempts, 1, MAX_RETX_ATTEMPTS) -
+                             1]++;
+    }
+}
 
-            NS_LOG_DEBUG("Dealing with packet " << (*itPhy).second.packet);
-            NS_LOG_DEBUG("This packet was received by " << (*itPhy).second.outcomes.size()
-                                                        << " gateways");
+void
+LoraPacketTracker::SetRetentionPolicy(Time retention, size_t maxTrackedPackets)
+{
+    NS_LOG_FUNCTION(this << retention << maxTrackedPackets);
 
-            if ((*itPhy).second.outcomes.count(gwId) > 0)
+    m_retentionTime = retention;
+    m_maxTrackedPackets = maxTrackedPackets;
+    EvictFinalizedEntries();
+}
+
+void
+LoraPacketTracker::SetEvictionSpillFile(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    if (m_spillFile.is_open())
+    {
+        m_spillFile.close();
+    }
+    m_spillFileName = filename;
+}
+
+void
+LoraPacketTracker::EvictFinalizedEntries()
+{
+    if (m_retentionTime.IsZero() && m_maxTrackedPackets == 0)
+    {
+        return;
+    }
+
+    if (!m_spillFileName.empty() && !m_spillFile.is_open())
+    {
+        m_spillFile.open(m_spillFileName, std::ofstream::out | std::ofstream::app);
+    }
+
+    Time cutoff = m_retentionTime.IsZero() ? Time() : Now() - m_retentionTime;
+
+    // UID order tracks packet creation order, so the front of each map holds
+    // the oldest entries. Entries are already folded into the interval index
+    // by the trace sinks; eviction only drops (or spills) per-packet detail
+    while (!m_packetTracker.empty())
+    {
+        auto it = m_packetTracker.begin();
+        bool overCap = m_maxTrackedPackets != 0 && m_packetTracker.size() > m_maxTrackedPackets;
+        if (!overCap && (m_retentionTime.IsZero() || it->second.sendTime >= cutoff))
+        {
+            break;
+        }
+        if (m_spillFile.is_open())
+        {
+            m_spillFile << "PHY " << it->first << " " << it->second.senderId << " "
+                        << it->second.sendTime.GetNanoSeconds();
+            for (const auto& outcome : it->second.outcomes)
             {
-                switch ((*itPhy).second.outcomes.at(gwId))
-                {
-                case RECEIVED: {
-                    packetCounts.at(1)++;
-                    break;
-                }
-                case INTERFERED: {
-                    packetCounts.at(2)++;
-                    break;
-                }
-                case NO_MORE_RECEIVERS: {
-                    packetCounts.at(3)++;
-                    break;
-                }
-                case UNDER_SENSITIVITY: {
-                    packetCounts.at(4)++;
-                    break;
-                }
-                case LOST_BECAUSE_TX: {
-                    packetCounts.at(5)++;
-                    break;
-                }
-                case UNSET: {
-                    break;
-                }
-                }
+                m_spillFile << " " << outcome.first << ":" << outcome.second;
             }
+            m_spillFile << std::endl;
         }
+        m_packetTracker.erase(it);
     }
 
-    return packetCounts;
+    while (!m_macPacketTracker.empty())
+    {
+        auto it = m_macPacketTracker.begin();
+        bool overCap = m_maxTrackedPackets != 0 && m_macPacketTracker.size() > m_maxTrackedPackets;
+        if (!overCap && (m_retentionTime.IsZero() || it->second.sendTime >= cutoff))
+        {
+            break;
+        }
+        if (m_spillFile.is_open())
+        {
+            m_spillFile << "MAC " << it->first << " " << it->second.senderId << " "
+                        << it->second.sendTime.GetNanoSeconds() << " "
+                        << it->second.receptionTimes.size() << std::endl;
+        }
+        m_macPacketTracker.erase(it);
+    }
+
+    while (!m_reTransmissionTracker.empty())
+    {
+        auto it = m_reTransmissionTracker.begin();
+        bool overCap =
+            m_maxTrackedPackets != 0 && m_reTransmissionTracker.size() > m_maxTrackedPackets;
+        if (!overCap && (m_retentionTime.IsZero() || it->second.firstAttempt >= cutoff))
+        {
+            break;
+        }
+        if (m_spillFile.is_open())
+        {
+            m_spillFile << "RTX " << it->first << " " << unsigned(it->second.reTxAttempts) << " "
+                        << it->second.successful << " "
+                        << it->second.firstAttempt.GetNanoSeconds() << " "
+                        << it->second.finishTime.GetNanoSeconds() << std::endl;
+        }
+        m_reTransmissionTracker.erase(it);
+    }
 }
 
-std::string
-LoraPacketTracker::PrintPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
+////////////////////////
+// Counting Functions //
+////////////////////////
+
+std::vector<int>
+LoraPacketTracker::CountPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
 {
     // Vector packetCounts will contain - for the interval given in the input of
     // the function, the following fields: totPacketsSent receivedPackets
@@ -258,13 +633,38 @@ LoraPacketTracker::PrintPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
 
     std::vector<int> packetCounts(6, 0);
 
+    // Windows aligned to the interval index sum a handful of buckets instead
+    // of scanning every tracked packet. The fast path treats the window as
+    // half-open [startTime, stopTime), which also avoids double counting a
+    // packet sent exactly on the edge of two consecutive windows
+    if (IsBucketAligned(startTime) && IsBucketAligned(stopTime) && startTime < stopTime)
+    {
+        int64_t firstBucket = startTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        int64_t endBucket = stopTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        for (auto it = m_intervalIndex.lower_bound(firstBucket);
+             it != m_intervalIndex.end() && it->first < endBucket;
+             ++it)
+        {
+            packetCounts.at(0) += it->second.phySent;
+            auto gwIt = it->second.gwOutcomes.find(gwId);
+            if (gwIt != it->second.gwOutcomes.end())
+            {
+                for (int outcome = 0; outcome < 5; ++outcome)
+                {
+                    packetCounts.at(outcome + 1) += gwIt->second[outcome];
+                }
+            }
+        }
+        return packetCounts;
+    }
+
     for (auto itPhy = m_packetTracker.begin(); itPhy != m_packetTracker.end(); ++itPhy)
     {
         if ((*itPhy).second.sendTime >= startTime && (*itPhy).second.sendTime <= stopTime)
         {
             packetCounts.at(0)++;
 
-            NS_LOG_DEBUG("Dealing with packet " << (*itPhy).second.packet);
+            NS_LOG_DEBUG("Dealing with packet UID " << (*itPhy).first);
             NS_LOG_DEBUG("This packet was received by " << (*itPhy).second.outcomes.size()
                                                         << " gateways");
 
@@ -300,6 +700,14 @@ LoraPacketTracker::PrintPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
         }
     }
 
+    return packetCounts;
+}
+
+std::string
+LoraPacketTracker::PrintPhyPacketsPerGw(Time startTime, Time stopTime, int gwId)
+{
+    std::vector<int> packetCounts = CountPhyPacketsPerGw(startTime, stopTime, gwId);
+
     std::string output("");
     for (int i = 0; i < 6; ++i)
     {
@@ -316,6 +724,23 @@ LoraPacketTracker::CountMacPacketsGlobally(Time startTime, Time stopTime)
 
     double sent = 0;
     double received = 0;
+
+    // Aligned windows are served by the interval index (half-open, see
+    // CountPhyPacketsPerGw)
+    if (IsBucketAligned(startTime) && IsBucketAligned(stopTime) && startTime < stopTime)
+    {
+        int64_t firstBucket = startTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        int64_t endBucket = stopTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        for (auto it = m_intervalIndex.lower_bound(firstBucket);
+             it != m_intervalIndex.end() && it->first < endBucket;
+             ++it)
+        {
+            sent += it->second.macSent;
+            received += it->second.macReceived;
+        }
+        return std::to_string(sent) + " " + std::to_string(received);
+    }
+
     for (auto it = m_macPacketTracker.begin(); it != m_macPacketTracker.end(); ++it)
     {
         if ((*it).second.sendTime >= startTime && (*it).second.sendTime <= stopTime)
@@ -338,6 +763,23 @@ LoraPacketTracker::CountMacPacketsGloballyCpsr(Time startTime, Time stopTime)
 
     double sent = 0;
     double received = 0;
+
+    // Aligned windows are served by the interval index (half-open, see
+    // CountPhyPacketsPerGw)
+    if (IsBucketAligned(startTime) && IsBucketAligned(stopTime) && startTime < stopTime)
+    {
+        int64_t firstBucket = startTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        int64_t endBucket = stopTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        for (auto it = m_intervalIndex.lower_bound(firstBucket);
+             it != m_intervalIndex.end() && it->first < endBucket;
+             ++it)
+        {
+            sent += it->second.cpsrSent;
+            received += it->second.cpsrAcked;
+        }
+        return std::to_string(sent) + " " + std::to_string(received);
+    }
+
     for (auto it = m_reTransmissionTracker.begin(); it != m_reTransmissionTracker.end(); ++it)
     {
         if ((*it).second.firstAttempt >= startTime && (*it).second.firstAttempt <= stopTime)
@@ -356,5 +798,112 @@ LoraPacketTracker::CountMacPacketsGloballyCpsr(Time startTime, Time stopTime)
     return std::to_string(sent) + " " + std::to_string(received);
 }
 
+std::vector<int>
+LoraPacketTracker::CountRetransmissionAttempts(Time startTime, Time stopTime)
+{
+    NS_LOG_FUNCTION(this << startTime << stopTime);
+
+    std::vector<int> histogram(MAX_RETX_ATTEMPTS, 0);
+
+    // Aligned windows are served by the interval index (half-open, see
+    // CountPhyPacketsPerGw)
+    if (IsBucketAligned(startTime) && IsBucketAligned(stopTime) && startTime < stopTime)
+    {
+        int64_t firstBucket = startTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        int64_t endBucket = stopTime.GetNanoSeconds() / m_indexBucketWidth.GetNanoSeconds();
+        for (auto it = m_intervalIndex.lower_bound(firstBucket);
+             it != m_intervalIndex.end() && it->first < endBucket;
+             ++it)
+        {
+            for (size_t i = 0; i < MAX_RETX_ATTEMPTS; ++i)
+            {
+                histogram[i] += it->second.retxHistogram[i];
+            }
+        }
+        return histogram;
+    }
+
+    for (const auto& entry : m_reTransmissionTracker)
+    {
+        if (entry.second.firstAttempt >= startTime && entry.second.firstAttempt <= stopTime)
+        {
+            histogram[std::clamp<size_t>(entry.second.reTxAttempts, 1, MAX_RETX_ATTEMPTS) - 1]++;
+        }
+    }
+
+    return histogram;
+}
+
+std::string
+LoraPacketTracker::PrintRetransmissionAttempts(Time startTime, Time stopTime)
+{
+    std::vector<int> histogram = CountRetransmissionAttempts(startTime, stopTime);
+
+    std::string output("");
+    for (size_t i = 0; i < MAX_RETX_ATTEMPTS; ++i)
+    {
+        output += std::to_string(histogram.at(i)) + " ";
+    }
+
+    return output;
+}
+
+void
+LoraPacketTracker::AddWeightedLossSample(uint8_t sf, double lossProbability)
+{
+    NS_ASSERT_MSG(sf >= 7 && sf <= 12, "Spreading factor out of range");
+
+    m_weightedLossSums[sf - 7] += lossProbability;
+    m_weightedLossCounts[sf - 7]++;
+}
+
+double
+LoraPacketTracker::GetWeightedPerEstimate(uint8_t sf) const
+{
+    NS_ASSERT_MSG(sf >= 7 && sf <= 12, "Spreading factor out of range");
+
+    if (m_weightedLossCounts[sf - 7] == 0)
+    {
+        return -1;
+    }
+    return m_weightedLossSums[sf - 7] / m_weightedLossCounts[sf - 7];
+}
+
+std::string
+LoraPacketTracker::PrintWeightedPerEstimates() const
+{
+    std::string output("");
+    for (uint8_t sf = 7; sf <= 12; sf++)
+    {
+        output += "SF" + std::to_string(sf) + " " +
+                  std::to_string(m_weightedLossCounts[sf - 7]) + " " +
+                  std::to_string(GetWeightedPerEstimate(sf)) + "\n";
+    }
+    return output;
+}
+
+uint64_t
+LoraPacketTracker::MemoryReport() const
+{
+    uint64_t bytes = EstimateMemory(m_packetTracker) + EstimateMemory(m_macPacketTracker) +
+                     EstimateMemory(m_reTransmissionTracker) + EstimateMemory(m_intervalIndex) +
+                     EstimateMemory(m_airtimeByDevice) + EstimateMemory(m_airtimeByDeviceIndex);
+
+    for (const auto& [uid, status] : m_packetTracker)
+    {
+        bytes += EstimateMemory(status.outcomes);
+    }
+    for (const auto& [uid, status] : m_macPacketTracker)
+    {
+        bytes += EstimateMemory(status.receptionTimes);
+    }
+    for (const auto& [index, bucket] : m_intervalIndex)
+    {
+        bytes += EstimateMemory(bucket.gwOutcomes);
+    }
+
+    return bytes;
+}
+
 } // namespace lorawan
 } // namespace ns3
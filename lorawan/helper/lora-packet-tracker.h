@@ -11,9 +11,13 @@
 
 #include "ns3/nstime.h"
 #include "ns3/packet.h"
+#include "ns3/traced-value.h"
 
+#include <array>
+#include <fstream>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace ns3
 {
@@ -37,7 +41,6 @@ enum PhyPacketOutcome
  */
 struct PacketStatus
 {
-    Ptr<const Packet> packet;                      //!< Packet being tracked
     uint32_t senderId;                             //!< Node id of the packet sender
     Time sendTime;                                 //!< Timestamp of pkt radio tx start
     std::map<int, enum PhyPacketOutcome> outcomes; //!< Reception outcome of this pkt at the end of
@@ -53,7 +56,6 @@ struct PacketStatus
  */
 struct MacPacketStatus
 {
-    Ptr<const Packet> packet; //!< Packet being tracked
     uint32_t senderId;        //!< Node id of the packet sender
     Time sendTime;     //!< Timestamp of the pkt leaving MAC layer to go down the stack of sender
     Time receivedTime; //!< Time of first reception (placeholder field)
@@ -75,9 +77,32 @@ struct RetransmissionStatus
     bool successful;      //!< Whether the retransmission procedure was successful
 };
 
-typedef std::map<Ptr<const Packet>, MacPacketStatus> MacPacketData;
-typedef std::map<Ptr<const Packet>, PacketStatus> PhyPacketData;
-typedef std::map<Ptr<const Packet>, RetransmissionStatus> RetransmissionData;
+/**
+ * @ingroup lorawan
+ *
+ * PHY uplink outcome counters for one spreading factor or one channel,
+ * maintained online by the tracker's trace sinks.
+ *
+ * The members are TracedValues so live dashboards can watch PDR evolve by
+ * connecting to them directly (TracedValue::ConnectWithoutContext) without
+ * ever touching the per-packet maps. `sent` counts transmissions; the
+ * outcome entries count gateway copies, so a packet heard by three
+ * gateways contributes three outcomes.
+ */
+struct PhyOutcomeCounters
+{
+    TracedValue<uint32_t> sent; //!< Uplink transmissions over the radio medium
+    std::array<TracedValue<uint32_t>, 5> outcomes; //!< Per-gateway-copy counts,
+                                                   //!< indexed by PhyPacketOutcome
+};
+
+// Trackers are keyed by packet UID rather than by Ptr<const Packet>: the UID
+// is stable across the copies the stack hands to the trace sinks, and not
+// holding the pointer lets packet buffers be freed as soon as the simulator
+// is done with them instead of living until the end of the run
+typedef std::map<uint64_t, MacPacketStatus> MacPacketData;
+typedef std::map<uint64_t, PacketStatus> PhyPacketData;
+typedef std::map<uint64_t, RetransmissionStatus> RetransmissionData;
 
 /**
  * @ingroup lorawan
@@ -231,6 +256,14 @@ class LoraPacketTracker
     /** @copydoc ns3::lorawan::LoraPacketTracker::CountMacPacketsPerGw */
     std::string PrintMacPacketsPerGw(Time startTime, Time stopTime, int systemId);
 
+    /**
+     * Estimate the heap bytes held by the tracking maps, including the
+     * per-entry outcome and reception-time maps.
+     *
+     * @return The estimated heap bytes.
+     */
+    uint64_t MemoryReport() const;
+
     /**
      * In a time interval, count the number of retransmissions that were needed to correctly deliver
      * a packet and receive the corresponding acknowledgment.
@@ -243,6 +276,60 @@ class LoraPacketTracker
      */
     std::string CountRetransmissions(Time startTime, Time stopTime);
 
+    /**
+     * In a time interval, count completed retransmission processes by the
+     * number of transmissions they took.
+     *
+     * Aligned windows are answered from per-bucket histograms maintained
+     * online when RequiredTransmissionsCallback fires, so periodic
+     * dashboards never re-scan the retransmission map.
+     *
+     * @param startTime Timestamp of the start of the measurement.
+     * @param stopTime Timestamp of the end of the measurement.
+     * @return A vector of MAX_RETX_ATTEMPTS counts; element i holds the
+     * processes that ended after i + 1 transmissions (processes taking more
+     * are folded into the last element).
+     */
+    std::vector<int> CountRetransmissionAttempts(Time startTime, Time stopTime);
+    /**
+     * @copydoc ns3::lorawan::LoraPacketTracker::CountRetransmissionAttempts
+     * @return Values in the output vector are formatted into a space-separated string.
+     */
+    std::string PrintRetransmissionAttempts(Time startTime, Time stopTime);
+
+    /// Number of attempt slots in the retransmission histograms (NbTrans tops out at 8).
+    static constexpr size_t MAX_RETX_ATTEMPTS = 8;
+
+    /**
+     * Accumulate one weighted loss outcome from the rare-event splitting
+     * engine.
+     *
+     * Meant as the sink of
+     * LoraInterferenceHelper::EnableRareEventSplitting: every evaluated
+     * packet reports a loss probability in [0, 1], and the running per-SF
+     * sums form a smoothed tail-PER estimator with far lower variance than
+     * the binary counters for rates around 1e-5 and below.
+     *
+     * @param sf The packet's spreading factor, in [7, 12].
+     * @param lossProbability The packet's weighted loss outcome.
+     */
+    void AddWeightedLossSample(uint8_t sf, double lossProbability);
+
+    /**
+     * Get the weighted PER estimate for one spreading factor.
+     *
+     * @param sf The spreading factor, in [7, 12].
+     * @return The estimate, or -1 if no sample was recorded for this SF.
+     */
+    double GetWeightedPerEstimate(uint8_t sf) const;
+
+    /**
+     * Print the per-SF weighted PER estimates with their sample counts.
+     *
+     * @return One "SF<n> <samples> <estimate>" triple per line.
+     */
+    std::string PrintWeightedPerEstimates() const;
+
     /**
      * In a time interval, count packets to evaluate the global performance at MAC level of the
      * whole network. In this case, a MAC layer packet is labeled as successful if it was successful
@@ -268,10 +355,224 @@ class LoraPacketTracker
      */
     std::string CountMacPacketsGloballyCpsr(Time startTime, Time stopTime);
 
+    /**
+     * Set the bucket width of the time interval index used to answer the
+     * counting functions, re-indexing any packets tracked so far.
+     *
+     * Queries whose bounds fall on bucket edges are answered by summing
+     * bucket aggregates instead of scanning the packet maps, so align the
+     * width with the windows the post-processing scripts ask for.
+     *
+     * @param width The bucket duration; must be strictly positive.
+     */
+    void SetIntervalIndexBucketWidth(Time width);
+
+    /**
+     * Enable eviction of finalized tracker entries.
+     *
+     * An entry is considered finalized once it is older than the retention
+     * time: radio and MAC events for a packet all happen within seconds of
+     * its transmission, so nothing will touch it again. Finalized entries
+     * are already folded into the interval index when their trace sinks
+     * fire, so evicting them keeps every aligned-window query exact while
+     * freeing the per-packet detail; scans for misaligned windows only see
+     * the retained entries. The cap bounds the number of tracked packets
+     * regardless of age, evicting oldest first.
+     *
+     * @param retention Age after which entries are evicted; zero disables
+     * age-based eviction.
+     * @param maxTrackedPackets Hard cap on entries per tracker map; zero
+     * means unlimited.
+     */
+    void SetRetentionPolicy(Time retention, size_t maxTrackedPackets = 0);
+
+    /**
+     * Spill evicted entries to a file, one text line each, for runs where
+     * per-packet detail is still wanted after eviction.
+     *
+     * @param filename Path of the spill file; empty disables spilling.
+     */
+    void SetEvictionSpillFile(const std::string& filename);
+
+    /**
+     * Get the on-air time consumed so far by one device's uplinks.
+     *
+     * The ledger is maintained online at transmission time from the
+     * memoized time-on-air lookup, so reading it never scans the packet
+     * maps.
+     *
+     * @param nodeId The device's node id.
+     * @return The accumulated time on air, zero for unknown devices.
+     */
+    Time GetDeviceAirtime(uint32_t nodeId) const;
+
+    /**
+     * Get the on-air time consumed so far at one spreading factor.
+     *
+     * @param sf The spreading factor, in [7, 12].
+     * @return The accumulated time on air.
+     */
+    Time GetSfAirtime(uint8_t sf) const;
+
+    /**
+     * Get the on-air time consumed so far on one channel.
+     *
+     * Channels map one-to-one onto regional sub-bands, so per-sub-band
+     * occupancy is the sum over the sub-band's channel frequencies.
+     *
+     * @param frequencyHz The channel's center frequency.
+     * @return The accumulated time on air, zero for untracked frequencies.
+     */
+    Time GetChannelAirtime(uint32_t frequencyHz) const;
+
+    /**
+     * Get the network-wide on-air time consumed so far by uplinks.
+     *
+     * @return The accumulated time on air.
+     */
+    Time GetTotalAirtime() const;
+
+    /**
+     * Print the airtime ledger rollups.
+     *
+     * @return One "sf <n> <seconds>" line per spreading factor followed by
+     * one "channel <frequencyHz> <seconds>" line per tracked channel and a
+     * final "total <seconds>" line.
+     */
+    std::string PrintAirtimeLedger() const;
+
+    /**
+     * Get the online outcome counters for a spreading factor.
+     *
+     * @param sf The spreading factor, in [7, 12].
+     * @return Reference to the counters.
+     */
+    PhyOutcomeCounters& GetSfCounters(uint8_t sf);
+
+    /**
+     * Get the online outcome counters for a channel.
+     *
+     * Channels are assigned indices in first-seen order; up to
+     * MAX_TRACKED_CHANNELS channels are tracked and traffic on further
+     * frequencies is not broken down.
+     *
+     * @param frequencyHz The channel's center frequency.
+     * @return Pointer to the counters, or nullptr if the frequency has not
+     * been seen (or the channel slots are exhausted).
+     */
+    const PhyOutcomeCounters* GetChannelCounters(uint32_t frequencyHz) const;
+
+    /**
+     * Get the channel frequencies seen so far, in channel index order.
+     *
+     * @return The tracked frequencies.
+     */
+    const std::vector<uint32_t>& GetTrackedChannelFrequencies() const;
+
+    /// Number of channel slots in the per-channel breakdown.
+    static constexpr size_t MAX_TRACKED_CHANNELS = 16;
+
   private:
+    /**
+     * Per-bucket aggregates maintained online at insertion time. A bucket
+     * covers the half-open interval [i * width, (i + 1) * width).
+     */
+    struct IntervalBucket
+    {
+        int phySent = 0;     //!< Uplink packets sent over the radio medium
+        int macSent = 0;     //!< Uplink packets leaving an end device's MAC layer
+        int macReceived = 0; //!< MAC packets received by at least one gateway
+        int cpsrSent = 0;    //!< Completed retransmission processes
+        int cpsrAcked = 0;   //!< Retransmission processes ending in an acknowledgment
+        std::array<int, MAX_RETX_ATTEMPTS> retxHistogram{}; //!< Processes by number of
+                                                            //!< transmissions taken, 1-based
+        std::map<int, std::array<int, 5>> gwOutcomes; //!< Per-gateway PHY outcome
+                                                      //!< counts, indexed by outcome
+    };
+
+    /**
+     * Get (creating if needed) the interval bucket covering a timestamp.
+     *
+     * @param t The timestamp.
+     * @return Reference to the bucket.
+     */
+    IntervalBucket& BucketFor(Time t);
+    /**
+     * Check whether a timestamp lies exactly on a bucket edge.
+     *
+     * @param t The timestamp.
+     * @return True if the timestamp is a multiple of the bucket width.
+     */
+    bool IsBucketAligned(Time t) const;
+
+    /**
+     * Evict entries allowed to go by the retention policy, oldest first.
+     *
+     * Called from the insertion trace sinks; UID order tracks packet
+     * creation order, so eviction walks the maps from the front.
+     */
+    void EvictFinalizedEntries();
+
+    /**
+     * Bump the per-SF and per-channel breakdowns for one PHY event, reading
+     * the spreading factor and frequency from the packet's LoraTag.
+     *
+     * @param packet The packet the trace sink fired for.
+     * @param outcome The gateway outcome, or -1 for a transmission.
+     */
+    void UpdatePhyBreakdowns(Ptr<const Packet> packet, int outcome);
+
+    /**
+     * Get (registering on first sight) the channel slot for a frequency.
+     *
+     * @param frequencyHz The channel's center frequency.
+     * @return Pointer to the slot, or nullptr if the slots are exhausted.
+     */
+    PhyOutcomeCounters* ChannelSlot(uint32_t frequencyHz);
+
+    /**
+     * Charge one transmission's time on air to the ledger rollups, reading
+     * the radio parameters from the packet's LoraTag.
+     *
+     * @param packet The transmitted packet.
+     * @param senderId The transmitting device's node id.
+     */
+    void RecordAirtime(Ptr<const Packet> packet, uint32_t senderId);
+
     PhyPacketData m_packetTracker;              //!< Packet map of PHY layer metrics
     MacPacketData m_macPacketTracker;           //!< Packet map of MAC layer metrics
     RetransmissionData m_reTransmissionTracker; //!< Packet map of retransmission process metrics
+
+    std::map<int64_t, IntervalBucket> m_intervalIndex; //!< Aggregates by bucket index
+    Time m_indexBucketWidth = Hours(1);                //!< Width of one index bucket
+
+    Time m_retentionTime = Seconds(0);  //!< Entry age before eviction; zero keeps all
+    size_t m_maxTrackedPackets = 0;     //!< Hard cap on entries per map; zero is unlimited
+    std::string m_spillFileName;        //!< Where evicted entries are appended, if anywhere
+    std::ofstream m_spillFile;          //!< Stream to the spill file, opened lazily
+
+    std::array<double, 6> m_weightedLossSums{};     //!< Summed loss probabilities by SF, 7 to 12
+    std::array<uint64_t, 6> m_weightedLossCounts{}; //!< Weighted samples recorded by SF, 7 to 12
+
+    /**
+     * Accumulated uplink ToA by dense device index (see DeviceRegistry),
+     * grown on demand. Charging a transmission is an array load when the
+     * packet's tag carries the sender's index; senders without one (not
+     * registered at install time) fall back to the node-id map below.
+     */
+    std::vector<Time> m_airtimeByDeviceIndex;
+
+    std::map<uint32_t, Time> m_airtimeByDevice; //!< Accumulated uplink ToA by node id
+                                                //!< for unregistered senders
+    std::array<Time, 6> m_airtimeBySf{};        //!< Accumulated uplink ToA by SF, 7 to 12
+    std::array<Time, MAX_TRACKED_CHANNELS> m_airtimeByChannel{}; //!< Accumulated uplink ToA
+                                                                 //!< by channel index
+    Time m_totalAirtime;                        //!< Accumulated uplink ToA, network-wide
+
+    std::array<PhyOutcomeCounters, 6> m_sfCounters; //!< Online breakdown by SF, 7 to 12
+    std::array<PhyOutcomeCounters, MAX_TRACKED_CHANNELS>
+        m_channelCounters;                    //!< Online breakdown by channel index
+    std::vector<uint32_t> m_channelFrequencies; //!< Channel index to frequency, first-seen order
 };
 } // namespace lorawan
 } // namespace ns3
@@ -20,7 +20,8 @@ NS_LOG_COMPONENT_DEFINE("LoraPhyHelper");
 
 LoraPhyHelper::LoraPhyHelper()
     : m_maxReceptionPaths(8),
-      m_txPriority(true)
+      m_txPriority(true),
+      m_hasOverrides(false)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -57,6 +58,7 @@ void
 LoraPhyHelper::Set(std::string name, const AttributeValue& v)
 {
     m_phy.Set(name, v);
+    m_hasOverrides = true;
 }
 
 Ptr<LoraPhy>
@@ -64,13 +66,28 @@ LoraPhyHelper::Install(Ptr<Node> node, Ptr<NetDevice> device) const
 {
     NS_LOG_FUNCTION(this << node->GetId() << device);
 
-    // Create the PHY and set its channel
-    Ptr<LoraPhy> phy = m_phy.Create<LoraPhy>();
+    // Create the PHY and set its channel. With no attribute overrides the
+    // typed constructors are equivalent to the factory and skip its
+    // per-object attribute list resolution, which adds up over large
+    // populations
+    TypeId tid = m_phy.GetTypeId();
+    Ptr<LoraPhy> phy;
+    if (!m_hasOverrides && tid == SimpleGatewayLoraPhy::GetTypeId())
+    {
+        phy = CreateObject<SimpleGatewayLoraPhy>();
+    }
+    else if (!m_hasOverrides && tid == SimpleEndDeviceLoraPhy::GetTypeId())
+    {
+        phy = CreateObject<SimpleEndDeviceLoraPhy>();
+    }
+    else
+    {
+        phy = m_phy.Create<LoraPhy>();
+    }
     phy->SetChannel(m_channel);
 
     // Configuration is different based on the kind of device we have to create
-    std::string typeId = m_phy.GetTypeId().GetName();
-    if (typeId == "ns3::SimpleGatewayLoraPhy")
+    if (tid == SimpleGatewayLoraPhy::GetTypeId())
     {
         // Inform the channel of the presence of this PHY
         m_channel->Add(phy);
@@ -102,7 +119,7 @@ LoraPhyHelper::Install(Ptr<Node> node, Ptr<NetDevice> device) const
             receptionPaths++;
         }
     }
-    else if (typeId == "ns3::SimpleEndDeviceLoraPhy")
+    else if (tid == SimpleEndDeviceLoraPhy::GetTypeId())
     {
         // The line below can be commented to speed up uplink-only simulations.
         // This implies that the LoraChannel instance will only know about
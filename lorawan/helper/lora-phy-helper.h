@@ -99,7 +99,18 @@ class LoraPhyHelper
     void SetGatewayTransmissionPriority(bool txPriority);
 
   private:
-    ObjectFactory m_phy;        //!< The PHY layer factory object.
+    ObjectFactory m_phy; //!< The PHY layer factory object.
+
+    /**
+     * Whether Set was called to override a PHY attribute.
+     *
+     * When no overrides exist, Install constructs PHYs through the typed
+     * CreateObject fast path instead of the ObjectFactory, skipping the
+     * factory's per-object attribute list resolution. This matters when
+     * installing very large device populations.
+     */
+    bool m_hasOverrides;
+
     Ptr<LoraChannel> m_channel; //!< The channel instance the PHYs will be connected to.
     int m_maxReceptionPaths;    //!< The maximum number of receive paths at the gateway.
     bool m_txPriority; //!< Whether to give priority to downlink transmission over reception at the
@@ -8,10 +8,15 @@
 
 #include "lora-radio-energy-model-helper.h"
 
+#include "ns3/columnar-export.h"
 #include "ns3/end-device-lora-phy.h"
 #include "ns3/lora-net-device.h"
 #include "ns3/lora-tx-current-model.h"
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
 namespace ns3
 {
 namespace lorawan
@@ -99,8 +104,137 @@ LoraRadioEnergyModelHelper::DoInstall(Ptr<NetDevice> device, Ptr<EnergySource> s
         Ptr<LoraTxCurrentModel> txcurrent = m_txCurrentModel.Create<LoraTxCurrentModel>();
         model->SetTxCurrentModel(txcurrent);
     }
+
+    if (m_fleetTrackingEnabled)
+    {
+        m_fleet.emplace_back(node->GetId(), model);
+    }
+
     return model;
 }
 
+void
+LoraRadioEnergyModelHelper::EnableFleetTracking()
+{
+    m_fleetTrackingEnabled = true;
+}
+
+LoraRadioEnergyModelHelper::FleetEnergySummary
+LoraRadioEnergyModelHelper::GetFleetEnergySummary() const
+{
+    FleetEnergySummary summary;
+    summary.nodeIds.reserve(m_fleet.size());
+    summary.totalJ.reserve(m_fleet.size());
+    summary.txJ.reserve(m_fleet.size());
+    summary.rxJ.reserve(m_fleet.size());
+    summary.standbyJ.reserve(m_fleet.size());
+    summary.sleepJ.reserve(m_fleet.size());
+
+    for (const auto& [nodeId, model] : m_fleet)
+    {
+        summary.nodeIds.push_back(nodeId);
+        summary.totalJ.push_back(model->GetTotalEnergyConsumption());
+        summary.txJ.push_back(model->GetStateEnergyConsumption(EndDeviceLoraPhy::TX));
+        summary.rxJ.push_back(model->GetStateEnergyConsumption(EndDeviceLoraPhy::RX));
+        summary.standbyJ.push_back(model->GetStateEnergyConsumption(EndDeviceLoraPhy::STANDBY));
+        summary.sleepJ.push_back(model->GetStateEnergyConsumption(EndDeviceLoraPhy::SLEEP));
+    }
+
+    return summary;
+}
+
+double
+LoraRadioEnergyModelHelper::GetFleetTotalEnergy() const
+{
+    double total = 0;
+    for (const auto& [nodeId, model] : m_fleet)
+    {
+        total += model->GetTotalEnergyConsumption();
+    }
+    return total;
+}
+
+double
+LoraRadioEnergyModelHelper::GetFleetEnergyPercentile(double percentile) const
+{
+    NS_ASSERT_MSG(percentile >= 0 && percentile <= 100, "Percentile out of [0, 100]");
+
+    if (m_fleet.empty())
+    {
+        return 0;
+    }
+
+    std::vector<double> totals;
+    totals.reserve(m_fleet.size());
+    for (const auto& [nodeId, model] : m_fleet)
+    {
+        totals.push_back(model->GetTotalEnergyConsumption());
+    }
+
+    auto nth = totals.begin() + std::min(totals.size() - 1,
+                                         static_cast<size_t>(percentile / 100 * totals.size()));
+    std::nth_element(totals.begin(), nth, totals.end());
+    return *nth;
+}
+
+double
+LoraRadioEnergyModelHelper::GetFleetEnergyPerDeliveredByte(LoraPacketTracker& tracker,
+                                                           Time startTime,
+                                                           Time stopTime,
+                                                           uint32_t payloadBytes) const
+{
+    // The tracker reports "sent received" as a space-separated string
+    std::stringstream counts(tracker.CountMacPacketsGlobally(startTime, stopTime));
+    double sent;
+    double received;
+    counts >> sent >> received;
+
+    double deliveredBytes = received * payloadBytes;
+    if (deliveredBytes <= 0)
+    {
+        return 0;
+    }
+    return GetFleetTotalEnergy() / deliveredBytes;
+}
+
+void
+LoraRadioEnergyModelHelper::PrintFleetSummary(std::string filename) const
+{
+    FleetEnergySummary summary = GetFleetEnergySummary();
+
+    std::ofstream outputFile(filename, std::ofstream::out | std::ofstream::trunc);
+    outputFile << "nodeId,totalJ,txJ,rxJ,standbyJ,sleepJ" << std::endl;
+    for (size_t i = 0; i < summary.nodeIds.size(); i++)
+    {
+        outputFile << summary.nodeIds[i] << "," << summary.totalJ[i] << "," << summary.txJ[i]
+                   << "," << summary.rxJ[i] << "," << summary.standbyJ[i] << ","
+                   << summary.sleepJ[i] << std::endl;
+    }
+    outputFile.close();
+}
+
+void
+LoraRadioEnergyModelHelper::PrintFleetSummaryBinary(std::string filename) const
+{
+    FleetEnergySummary summary = GetFleetEnergySummary();
+
+    BinaryColumnarWriter writer;
+    writer.SetColumns({"nodeId", "totalJ", "txJ", "rxJ", "standbyJ", "sleepJ"});
+    if (!writer.Open(filename))
+    {
+        return;
+    }
+    for (size_t i = 0; i < summary.nodeIds.size(); i++)
+    {
+        writer.AppendRow({static_cast<double>(summary.nodeIds[i]),
+                          summary.totalJ[i],
+                          summary.txJ[i],
+                          summary.rxJ[i],
+                          summary.standbyJ[i],
+                          summary.sleepJ[i]});
+    }
+    writer.Close();
+}
+
 } // namespace lorawan
 } // namespace ns3
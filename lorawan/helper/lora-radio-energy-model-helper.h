@@ -10,8 +10,12 @@
 #define LORA_RADIO_ENERGY_MODEL_HELPER_H
 
 #include "ns3/energy-model-helper.h"
+#include "ns3/lora-packet-tracker.h"
 #include "ns3/lora-radio-energy-model.h"
 
+#include <string>
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -77,6 +81,85 @@ class LoraRadioEnergyModelHelper : public DeviceEnergyModelHelper
                            std::string n7 = "",
                            const AttributeValue& v7 = EmptyAttributeValue());
 
+    /**
+     * Per-device energy figures for the whole installed fleet, as one flat
+     * array per column so summary statistics are single passes over
+     * contiguous memory.
+     */
+    struct FleetEnergySummary
+    {
+        std::vector<uint32_t> nodeIds; //!< Node id of each device, in installation order.
+        std::vector<double> totalJ;    //!< Total consumed energy per device [J].
+        std::vector<double> txJ;       //!< Energy spent transmitting per device [J].
+        std::vector<double> rxJ;       //!< Energy spent receiving per device [J].
+        std::vector<double> standbyJ;  //!< Energy spent in standby per device [J].
+        std::vector<double> sleepJ;    //!< Energy spent sleeping per device [J].
+    };
+
+    /**
+     * Track every energy model installed from now on, so fleet-level
+     * summaries can be computed without walking node and device containers
+     * after the run.
+     */
+    void EnableFleetTracking();
+
+    /**
+     * Collect the current per-device energy figures of the tracked fleet in
+     * one pass.
+     *
+     * @return The fleet summary, one entry per tracked device.
+     */
+    FleetEnergySummary GetFleetEnergySummary() const;
+
+    /**
+     * Get the total energy consumed by the tracked fleet.
+     *
+     * @return The total consumed energy [J].
+     */
+    double GetFleetTotalEnergy() const;
+
+    /**
+     * Get a percentile of the per-device total energy distribution.
+     *
+     * @param percentile The percentile of interest, in [0, 100].
+     * @return The per-device consumed energy at that percentile [J].
+     */
+    double GetFleetEnergyPercentile(double percentile) const;
+
+    /**
+     * Get the fleet energy spent per application byte delivered to the
+     * network server in a time interval.
+     *
+     * The packet tracker counts packets rather than bytes, so the caller
+     * provides the application payload size used by the senders.
+     *
+     * @param tracker The packet tracker of the run.
+     * @param startTime Timestamp of the start of the measurement.
+     * @param stopTime Timestamp of the end of the measurement.
+     * @param payloadBytes The application payload size per delivered packet.
+     * @return The consumed energy per delivered byte [J], or zero when
+     * nothing was delivered.
+     */
+    double GetFleetEnergyPerDeliveredByte(LoraPacketTracker& tracker,
+                                          Time startTime,
+                                          Time stopTime,
+                                          uint32_t payloadBytes) const;
+
+    /**
+     * Dump the fleet summary as CSV, one row per device.
+     *
+     * @param filename The output filename.
+     */
+    void PrintFleetSummary(std::string filename) const;
+
+    /**
+     * Dump the fleet summary as a binary columnar file, convertible with
+     * the columnar-to-csv example.
+     *
+     * @param filename The output filename.
+     */
+    void PrintFleetSummaryBinary(std::string filename) const;
+
   private:
     /**
      * @param device Pointer to the NetDevice to install DeviceEnergyModel.
@@ -91,6 +174,15 @@ class LoraRadioEnergyModelHelper : public DeviceEnergyModelHelper
   private:
     ObjectFactory m_radioEnergy;    ///< radio energy
     ObjectFactory m_txCurrentModel; ///< transmit current model
+
+    bool m_fleetTrackingEnabled = false; ///< whether DoInstall registers models in the fleet
+
+    /**
+     * The tracked energy models and their node ids, in installation order.
+     * Mutable because DoInstall is const in the DeviceEnergyModelHelper
+     * interface.
+     */
+    mutable std::vector<std::pair<uint32_t, Ptr<LoraRadioEnergyModel>>> m_fleet;
 };
 
 } // namespace lorawan
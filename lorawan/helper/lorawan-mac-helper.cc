@@ -8,12 +8,17 @@
 
 #include "lorawan-mac-helper.h"
 
+#include "ns3/device-registry.h"
 #include "ns3/end-device-lora-phy.h"
 #include "ns3/gateway-lora-phy.h"
 #include "ns3/log.h"
 #include "ns3/lora-net-device.h"
+#include "ns3/propagation-loss-model.h"
 #include "ns3/random-variable-stream.h"
 
+#include <algorithm>
+#include <thread>
+
 namespace ns3
 {
 namespace lorawan
@@ -21,8 +26,12 @@ namespace lorawan
 
 NS_LOG_COMPONENT_DEFINE("LorawanMacHelper");
 
+std::vector<std::vector<double>> LorawanMacHelper::m_lastGainMatrix;
+
 LorawanMacHelper::LorawanMacHelper()
-    : m_region(LorawanMacHelper::EU)
+    : m_hasOverrides(false),
+      m_region(LorawanMacHelper::EU),
+      m_shareFrequencyPlan(false)
 {
 }
 
@@ -30,6 +39,7 @@ void
 LorawanMacHelper::Set(std::string name, const AttributeValue& v)
 {
     m_mac.Set(name, v);
+    m_hasOverrides = true;
 }
 
 void
@@ -54,6 +64,24 @@ LorawanMacHelper::SetAddressGenerator(Ptr<LoraDeviceAddressGenerator> addrGen)
     NS_LOG_FUNCTION(this);
 
     m_addrGen = addrGen;
+    m_addrBlock.clear();
+    m_addrBlockNext = 0;
+}
+
+void
+LorawanMacHelper::PrefetchAddresses(uint32_t count) const
+{
+    NS_LOG_FUNCTION(this << count);
+
+    if (m_deviceType != ED_A || !m_addrGen || count == 0)
+    {
+        return;
+    }
+
+    // Sized exactly to the population being installed, so the block leaves
+    // no holes in the address space if fewer Install calls follow
+    m_addrBlock = m_addrGen->NextAddresses(count);
+    m_addrBlockNext = 0;
 }
 
 void
@@ -62,16 +90,44 @@ LorawanMacHelper::SetRegion(enum LorawanMacHelper::Regions region)
     m_region = region;
 }
 
+void
+LorawanMacHelper::SetFrequencyPlanSharing(bool share)
+{
+    NS_LOG_FUNCTION(this << share);
+    m_shareFrequencyPlan = share;
+    m_sharedFrequencyPlan = nullptr; // Rebuilt on the next Install
+}
+
 Ptr<LorawanMac>
 LorawanMacHelper::Install(Ptr<Node> node, Ptr<NetDevice> device) const
 {
-    Ptr<LorawanMac> mac = m_mac.Create<LorawanMac>();
+    // With no attribute overrides the typed constructors are equivalent to
+    // the factory and skip its per-object attribute list resolution
+    Ptr<LorawanMac> mac;
+    if (!m_hasOverrides)
+    {
+        mac = (m_deviceType == ED_A)
+                  ? StaticCast<LorawanMac>(CreateObject<ClassAEndDeviceLorawanMac>())
+                  : StaticCast<LorawanMac>(CreateObject<GatewayLorawanMac>());
+    }
+    else
+    {
+        mac = m_mac.Create<LorawanMac>();
+    }
     mac->SetDevice(device);
 
-    // If we are operating on an end device, add an address to it
+    // If we are operating on an end device, add an address to it, preferring
+    // the prefetched block over a per-device generator call
     if (m_deviceType == ED_A && m_addrGen)
     {
-        DynamicCast<ClassAEndDeviceLorawanMac>(mac)->SetDeviceAddress(m_addrGen->NextAddress());
+        LoraDeviceAddress address = (m_addrBlockNext < m_addrBlock.size())
+                                        ? m_addrBlock[m_addrBlockNext++]
+                                        : m_addrGen->NextAddress();
+        DynamicCast<ClassAEndDeviceLorawanMac>(mac)->SetDeviceAddress(address);
+
+        // Register the device's identities (node id, address, dense index)
+        // so components can key per-device state by the dense index
+        DeviceRegistry::Register(node->GetId(), address.Get());
     }
 
     // Add a basic list of channels based on the region where the device is
@@ -200,14 +256,29 @@ LorawanMacHelper::ApplyCommonAlohaConfigurations(Ptr<LorawanMac> lorawanMac) con
     // SubBands //
     //////////////
 
+    if (m_shareFrequencyPlan && !m_sharedFrequencyPlan)
+    {
+        // Build the plan once; every installed device shares it
+        m_sharedFrequencyPlan = Create<LogicalLoraChannelHelper>(1);
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(868000000, 868600000, 1, 14));
+        m_sharedFrequencyPlan->SetChannel(0, Create<LogicalLoraChannel>(868100000, 0, 5));
+    }
+
     auto channelHelper = Create<LogicalLoraChannelHelper>(1);
-    channelHelper->AddSubBand(Create<SubBand>(868000000, 868600000, 1, 14));
+    if (m_shareFrequencyPlan)
+    {
+        channelHelper->ShareFrom(m_sharedFrequencyPlan);
+    }
+    else
+    {
+        channelHelper->AddSubBand(Create<SubBand>(868000000, 868600000, 1, 14));
 
-    //////////////////////
-    // Default channels //
-    //////////////////////
-    Ptr<LogicalLoraChannel> lc1 = Create<LogicalLoraChannel>(868100000, 0, 5);
-    channelHelper->SetChannel(0, lc1);
+        //////////////////////
+        // Default channels //
+        //////////////////////
+        Ptr<LogicalLoraChannel> lc1 = Create<LogicalLoraChannel>(868100000, 0, 5);
+        channelHelper->SetChannel(0, lc1);
+    }
 
     lorawanMac->SetLogicalLoraChannelHelper(channelHelper);
 
@@ -306,23 +377,45 @@ LorawanMacHelper::ApplyCommonEuConfigurations(Ptr<LorawanMac> lorawanMac) const
     // SubBands //
     //////////////
 
+    if (m_shareFrequencyPlan && !m_sharedFrequencyPlan)
+    {
+        // Build the plan once; every installed device shares it
+        m_sharedFrequencyPlan = Create<LogicalLoraChannelHelper>(16);
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(863000000, 865000000, 0.001, 14));
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(865000000, 868000000, 0.01, 14));
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(868000000, 868600000, 0.01, 14));
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(868700000, 869200000, 0.001, 14));
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(869400000, 869650000, 0.1, 27));
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(869700000, 870000000, 0.01, 14));
+        m_sharedFrequencyPlan->SetChannel(0, Create<LogicalLoraChannel>(868100000, 0, 5));
+        m_sharedFrequencyPlan->SetChannel(1, Create<LogicalLoraChannel>(868300000, 0, 5));
+        m_sharedFrequencyPlan->SetChannel(2, Create<LogicalLoraChannel>(868500000, 0, 5));
+    }
+
     auto channelHelper = Create<LogicalLoraChannelHelper>(16);
-    channelHelper->AddSubBand(Create<SubBand>(863000000, 865000000, 0.001, 14));
-    channelHelper->AddSubBand(Create<SubBand>(865000000, 868000000, 0.01, 14));
-    channelHelper->AddSubBand(Create<SubBand>(868000000, 868600000, 0.01, 14));
-    channelHelper->AddSubBand(Create<SubBand>(868700000, 869200000, 0.001, 14));
-    channelHelper->AddSubBand(Create<SubBand>(869400000, 869650000, 0.1, 27));
-    channelHelper->AddSubBand(Create<SubBand>(869700000, 870000000, 0.01, 14));
-
-    //////////////////////
-    // Default channels //
-    //////////////////////
-    Ptr<LogicalLoraChannel> lc1 = Create<LogicalLoraChannel>(868100000, 0, 5);
-    Ptr<LogicalLoraChannel> lc2 = Create<LogicalLoraChannel>(868300000, 0, 5);
-    Ptr<LogicalLoraChannel> lc3 = Create<LogicalLoraChannel>(868500000, 0, 5);
-    channelHelper->SetChannel(0, lc1);
-    channelHelper->SetChannel(1, lc2);
-    channelHelper->SetChannel(2, lc3);
+    if (m_shareFrequencyPlan)
+    {
+        channelHelper->ShareFrom(m_sharedFrequencyPlan);
+    }
+    else
+    {
+        channelHelper->AddSubBand(Create<SubBand>(863000000, 865000000, 0.001, 14));
+        channelHelper->AddSubBand(Create<SubBand>(865000000, 868000000, 0.01, 14));
+        channelHelper->AddSubBand(Create<SubBand>(868000000, 868600000, 0.01, 14));
+        channelHelper->AddSubBand(Create<SubBand>(868700000, 869200000, 0.001, 14));
+        channelHelper->AddSubBand(Create<SubBand>(869400000, 869650000, 0.1, 27));
+        channelHelper->AddSubBand(Create<SubBand>(869700000, 870000000, 0.01, 14));
+
+        //////////////////////
+        // Default channels //
+        //////////////////////
+        Ptr<LogicalLoraChannel> lc1 = Create<LogicalLoraChannel>(868100000, 0, 5);
+        Ptr<LogicalLoraChannel> lc2 = Create<LogicalLoraChannel>(868300000, 0, 5);
+        Ptr<LogicalLoraChannel> lc3 = Create<LogicalLoraChannel>(868500000, 0, 5);
+        channelHelper->SetChannel(0, lc1);
+        channelHelper->SetChannel(1, lc2);
+        channelHelper->SetChannel(2, lc3);
+    }
 
     lorawanMac->SetLogicalLoraChannelHelper(channelHelper);
 
@@ -421,14 +514,29 @@ LorawanMacHelper::ApplyCommonSingleChannelConfigurations(Ptr<LorawanMac> lorawan
     // SubBands //
     //////////////
 
+    if (m_shareFrequencyPlan && !m_sharedFrequencyPlan)
+    {
+        // Build the plan once; every installed device shares it
+        m_sharedFrequencyPlan = Create<LogicalLoraChannelHelper>(1);
+        m_sharedFrequencyPlan->AddSubBand(Create<SubBand>(868000000, 868600000, 0.01, 14));
+        m_sharedFrequencyPlan->SetChannel(0, Create<LogicalLoraChannel>(868100000, 0, 5));
+    }
+
     auto channelHelper = Create<LogicalLoraChannelHelper>(1);
-    channelHelper->AddSubBand(Create<SubBand>(868000000, 868600000, 0.01, 14));
+    if (m_shareFrequencyPlan)
+    {
+        channelHelper->ShareFrom(m_sharedFrequencyPlan);
+    }
+    else
+    {
+        channelHelper->AddSubBand(Create<SubBand>(868000000, 868600000, 0.01, 14));
 
-    //////////////////////
-    // Default channels //
-    //////////////////////
-    Ptr<LogicalLoraChannel> lc1 = Create<LogicalLoraChannel>(868100000, 0, 5);
-    channelHelper->SetChannel(0, lc1);
+        //////////////////////
+        // Default channels //
+        //////////////////////
+        Ptr<LogicalLoraChannel> lc1 = Create<LogicalLoraChannel>(868100000, 0, 5);
+        channelHelper->SetChannel(0, lc1);
+    }
 
     lorawanMac->SetLogicalLoraChannelHelper(channelHelper);
 
@@ -447,50 +555,133 @@ std::vector<int>
 LorawanMacHelper::SetSpreadingFactorsUp(NodeContainer endDevices,
                                         NodeContainer gateways,
                                         Ptr<LoraChannel> channel)
+{
+    return SetSpreadingFactorsUp(endDevices, gateways, channel, 1);
+}
+
+std::vector<int>
+LorawanMacHelper::SetSpreadingFactorsUp(NodeContainer endDevices,
+                                        NodeContainer gateways,
+                                        Ptr<LoraChannel> channel,
+                                        uint32_t numThreads)
 {
     NS_LOG_FUNCTION_NOARGS();
 
     std::vector<int> sfQuantity(7, 0);
-    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+
+    // Batch the position and MAC reads up front, so the gain computation
+    // only touches plain vectors
+    uint32_t nDevices = endDevices.GetN();
+    uint32_t nGateways = gateways.GetN();
+    std::vector<Ptr<MobilityModel>> edPositions(nDevices);
+    std::vector<Ptr<ClassAEndDeviceLorawanMac>> edMacs(nDevices);
+    for (uint32_t d = 0; d < nDevices; d++)
     {
-        Ptr<Node> object = *j;
-        Ptr<MobilityModel> position = object->GetObject<MobilityModel>();
-        NS_ASSERT(position);
-        Ptr<NetDevice> netDevice = object->GetDevice(0);
-        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(netDevice);
+        Ptr<Node> object = endDevices.Get(d);
+        edPositions[d] = object->GetObject<MobilityModel>();
+        NS_ASSERT(edPositions[d]);
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(object->GetDevice(0));
         NS_ASSERT(loraNetDevice);
-        Ptr<ClassAEndDeviceLorawanMac> mac =
-            DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
-        NS_ASSERT(mac);
-
-        // Try computing the distance from each gateway and find the best one
-        Ptr<Node> bestGateway = gateways.Get(0);
-        Ptr<MobilityModel> bestGatewayPosition = bestGateway->GetObject<MobilityModel>();
-
-        // Assume devices transmit at 14 dBm
-        double highestRxPower = channel->GetRxPower(14, position, bestGatewayPosition);
+        edMacs[d] = DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+        NS_ASSERT(edMacs[d]);
+    }
+    std::vector<Ptr<MobilityModel>> gwPositions(nGateways);
+    for (uint32_t g = 0; g < nGateways; g++)
+    {
+        gwPositions[g] = gateways.Get(g)->GetObject<MobilityModel>();
+    }
 
-        for (auto currentGw = gateways.Begin() + 1; currentGw != gateways.End(); ++currentGw)
+    // Compute the full device-gateway gain matrix, chunking devices across
+    // worker threads when asked to. The matrix is kept for reuse by other
+    // components (see GetLastGainMatrix). Assume devices transmit at 14 dBm.
+    Ptr<PropagationLossModel> lossModel = channel->GetLossModel();
+    uint32_t effectiveThreads = numThreads;
+    if (effectiveThreads > 1)
+    {
+        // Worker threads bypass the channel's cache but still run
+        // CalcRxPower concurrently, so every model in the chain must be
+        // pure: no RandomVariableStream draws and no lazily filled caches.
+        // Only models known to be pure are allowed; anything else -- the
+        // stochastic core models, but also this module's correlated
+        // shadowing and building penetration models, which both draw and
+        // cache lazily inside DoCalcRxPower -- falls back to one thread
+        auto isKnownPure = [](Ptr<PropagationLossModel> loss) {
+            return bool(DynamicCast<LogDistancePropagationLossModel>(loss)) ||
+                   bool(DynamicCast<ThreeLogDistancePropagationLossModel>(loss)) ||
+                   bool(DynamicCast<FriisPropagationLossModel>(loss)) ||
+                   bool(DynamicCast<TwoRayGroundPropagationLossModel>(loss)) ||
+                   bool(DynamicCast<FixedRssLossModel>(loss)) ||
+                   bool(DynamicCast<RangePropagationLossModel>(loss)) ||
+                   bool(DynamicCast<MatrixPropagationLossModel>(loss));
+        };
+        for (Ptr<PropagationLossModel> loss = lossModel; loss; loss = loss->GetNext())
         {
-            // Compute the power received from the current gateway
-            Ptr<Node> curr = *currentGw;
-            Ptr<MobilityModel> currPosition = curr->GetObject<MobilityModel>();
-            double currentRxPower = channel->GetRxPower(14, position, currPosition); // dBm
-
-            if (currentRxPower > highestRxPower)
+            if (!isKnownPure(loss))
+            {
+                NS_LOG_WARN("Propagation loss model "
+                            << loss->GetInstanceTypeId().GetName()
+                            << " is not known to be thread-safe: computing the gain matrix "
+                               "single-threaded");
+                effectiveThreads = 1;
+                break;
+            }
+        }
+    }
+    m_lastGainMatrix.assign(nDevices, std::vector<double>(nGateways, 0));
+    auto computeRows = [&](uint32_t first, uint32_t last) {
+        for (uint32_t d = first; d < last; d++)
+        {
+            for (uint32_t g = 0; g < nGateways; g++)
+            {
+                // Workers query the loss model directly: GetRxPower would do
+                // unsynchronized find/emplace on the channel's mutable
+                // path-loss cache when CachePathLoss is enabled, a data race
+                // across workers
+                m_lastGainMatrix[d][g] =
+                    lossModel->CalcRxPower(14, edPositions[d], gwPositions[g]);
+            }
+        }
+    };
+    if (effectiveThreads <= 1 || nDevices < 2 * effectiveThreads)
+    {
+        // Serial path: go through the channel, so the path-loss cache (when
+        // enabled) is both used and warmed for the simulation itself
+        for (uint32_t d = 0; d < nDevices; d++)
+        {
+            for (uint32_t g = 0; g < nGateways; g++)
+            {
+                m_lastGainMatrix[d][g] = channel->GetRxPower(14, edPositions[d], gwPositions[g]);
+            }
+        }
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        uint32_t chunk = (nDevices + effectiveThreads - 1) / effectiveThreads;
+        for (uint32_t t = 0; t < effectiveThreads; t++)
+        {
+            uint32_t first = t * chunk;
+            uint32_t last = std::min(first + chunk, nDevices);
+            if (first >= last)
             {
-                bestGateway = curr;
-                bestGatewayPosition = currPosition;
-                highestRxPower = currentRxPower;
+                break;
             }
+            workers.emplace_back(computeRows, first, last);
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
         }
+    }
 
-        // NS_LOG_DEBUG ("Rx Power: " << highestRxPower);
-        double rxPower = highestRxPower;
+    for (uint32_t d = 0; d < nDevices; d++)
+    {
+        Ptr<ClassAEndDeviceLorawanMac> mac = edMacs[d];
+        const std::vector<double>& gains = m_lastGainMatrix[d];
+        double rxPower = *std::max_element(gains.begin(), gains.end());
 
         // Get the end device sensitivity
-        Ptr<EndDeviceLoraPhy> edPhy = DynamicCast<EndDeviceLoraPhy>(loraNetDevice->GetPhy());
-        const double* edSensitivity = EndDeviceLoraPhy::sensitivity;
+        const double* edSensitivity = EndDeviceLoraPhy::sensitivity.data();
 
         if (rxPower > *edSensitivity)
         {
@@ -586,6 +777,12 @@ LorawanMacHelper::SetSpreadingFactorsUp(NodeContainer endDevices,
 
 } //  end function
 
+const std::vector<std::vector<double>>&
+LorawanMacHelper::GetLastGainMatrix()
+{
+    return m_lastGainMatrix;
+}
+
 std::vector<int>
 LorawanMacHelper::SetSpreadingFactorsGivenDistribution(NodeContainer endDevices,
                                                        NodeContainer gateways,
@@ -596,67 +793,80 @@ LorawanMacHelper::SetSpreadingFactorsGivenDistribution(NodeContainer endDevices,
 
     std::vector<int> sfQuantity(7, 0);
     Ptr<UniformRandomVariable> uniformRV = CreateObject<UniformRandomVariable>();
-    std::vector<double> cumdistr(6);
-    cumdistr[0] = distribution[0];
-    for (int i = 1; i < 6; ++i)
-    {
-        cumdistr[i] = distribution[i] + cumdistr[i - 1];
-    }
 
     NS_LOG_DEBUG("Distribution: " << distribution[0] << " " << distribution[1] << " "
                                   << distribution[2] << " " << distribution[3] << " "
                                   << distribution[4] << " " << distribution[5]);
-    NS_LOG_DEBUG("Cumulative distribution: " << cumdistr[0] << " " << cumdistr[1] << " "
-                                             << cumdistr[2] << " " << cumdistr[3] << " "
-                                             << cumdistr[4] << " " << cumdistr[5]);
 
-    for (auto j = endDevices.Begin(); j != endDevices.End(); ++j)
+    // Build a Walker alias table over the six buckets, so each device costs
+    // one uniform draw and two table reads instead of a cumulative scan.
+    // Bucket k maps to DR 5-k, as in the distribution parameter
+    const int nBuckets = 6;
+    double total = 0;
+    for (int i = 0; i < nBuckets; ++i)
+    {
+        total += distribution[i];
+    }
+    NS_ASSERT_MSG(total > 0, "Data rate distribution must have positive mass");
+
+    std::vector<double> acceptProb(nBuckets);
+    std::vector<int> alias(nBuckets);
+    std::vector<double> scaled(nBuckets);
+    std::vector<int> small;
+    std::vector<int> large;
+    for (int i = 0; i < nBuckets; ++i)
+    {
+        scaled[i] = distribution[i] / total * nBuckets;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        int l = large.back();
+        small.pop_back();
+        large.pop_back();
+        acceptProb[s] = scaled[s];
+        alias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        (scaled[l] < 1.0 ? small : large).push_back(l);
+    }
+    for (int i : small)
+    {
+        acceptProb[i] = 1.0;
+        alias[i] = i;
+    }
+    for (int i : large)
+    {
+        acceptProb[i] = 1.0;
+        alias[i] = i;
+    }
+
+    // Sample every device's bucket first, then write the data rates through
+    // the MAC setters in one assignment pass
+    uint32_t nDevices = endDevices.GetN();
+    std::vector<uint8_t> bucketPerDevice(nDevices);
+    for (uint32_t d = 0; d < nDevices; ++d)
+    {
+        // One draw provides both the column and the accept/alias coin
+        double u = uniformRV->GetValue(0, 1) * nBuckets;
+        int column = std::min(static_cast<int>(u), nBuckets - 1);
+        double coin = u - column;
+        bucketPerDevice[d] = (coin < acceptProb[column]) ? column : alias[column];
+    }
+
+    for (uint32_t d = 0; d < nDevices; ++d)
     {
-        Ptr<Node> object = *j;
-        Ptr<MobilityModel> position = object->GetObject<MobilityModel>();
-        NS_ASSERT(position);
-        Ptr<NetDevice> netDevice = object->GetDevice(0);
-        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(netDevice);
+        Ptr<Node> object = endDevices.Get(d);
+        Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(object->GetDevice(0));
         NS_ASSERT(loraNetDevice);
         Ptr<ClassAEndDeviceLorawanMac> mac =
             DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
         NS_ASSERT(mac);
 
-        double prob = uniformRV->GetValue(0, 1);
-
-        // NS_LOG_DEBUG ("Probability: " << prob);
-        if (prob < cumdistr[0])
-        {
-            mac->SetDataRate(5);
-            sfQuantity[0] = sfQuantity[0] + 1;
-        }
-        else if (prob > cumdistr[0] && prob < cumdistr[1])
-        {
-            mac->SetDataRate(4);
-            sfQuantity[1] = sfQuantity[1] + 1;
-        }
-        else if (prob > cumdistr[1] && prob < cumdistr[2])
-        {
-            mac->SetDataRate(3);
-            sfQuantity[2] = sfQuantity[2] + 1;
-        }
-        else if (prob > cumdistr[2] && prob < cumdistr[3])
-        {
-            mac->SetDataRate(2);
-            sfQuantity[3] = sfQuantity[3] + 1;
-        }
-        else if (prob > cumdistr[3] && prob < cumdistr[4])
-        {
-            mac->SetDataRate(1);
-            sfQuantity[4] = sfQuantity[4] + 1;
-        }
-        else
-        {
-            mac->SetDataRate(0);
-            sfQuantity[5] = sfQuantity[5] + 1;
-        }
-
-    } // end loop on nodes
+        uint8_t bucket = bucketPerDevice[d];
+        mac->SetDataRate(5 - bucket);
+        sfQuantity[bucket] = sfQuantity[bucket] + 1;
+    }
 
     return sfQuantity;
 
@@ -19,6 +19,8 @@
 #include "ns3/node-container.h"
 #include "ns3/random-variable-stream.h"
 
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -76,6 +78,20 @@ class LorawanMacHelper
      */
     void SetAddressGenerator(Ptr<LoraDeviceAddressGenerator> addrGen);
 
+    /**
+     * Draw a contiguous block of addresses from the generator for the next
+     * count Install calls to consume.
+     *
+     * One bulk allocation replaces count per-device NextAddress calls, and
+     * because the block size matches the device population exactly the
+     * assigned addresses stay dense: the same sequence per-device allocation
+     * would have produced. A no-op unless this helper creates end devices
+     * and has an address generator.
+     *
+     * @param count Number of devices about to be installed.
+     */
+    void PrefetchAddresses(uint32_t count) const;
+
     /**
      * Set the kind of MAC this helper will create.
      *
@@ -90,6 +106,21 @@ class LorawanMacHelper
      */
     void SetRegion(enum Regions region);
 
+    /**
+     * Enable or disable sharing of one frequency plan across installed devices.
+     *
+     * Regional frequency plans are identical for every device, so when enabled
+     * this helper builds the plan's SubBand and LogicalLoraChannel objects
+     * once and installs LogicalLoraChannelHelper instances that share them
+     * (see LogicalLoraChannelHelper::ShareFrom). Devices whose plan diverges
+     * at runtime, e.g. via LinkAdrReq or NewChannelReq, transparently detach
+     * onto a private copy. Disabled by default, preserving the historical
+     * one-plan-per-device behavior.
+     *
+     * @param share Whether devices should share a single frequency plan.
+     */
+    void SetFrequencyPlanSharing(bool share);
+
     /**
      * Create the LorawanMac instance and connect it to a device.
      *
@@ -137,6 +168,43 @@ class LorawanMacHelper
                                                   NodeContainer gateways,
                                                   Ptr<LoraChannel> channel);
 
+    /**
+     * @copydoc ns3::lorawan::LorawanMacHelper::SetSpreadingFactorsUp(NodeContainer,NodeContainer,Ptr<LoraChannel>)
+     *
+     * This overload chunks the device-gateway gain computation — the O(N·G)
+     * cost that dominates setup for large scenarios — across numThreads
+     * worker threads, after batching all position reads up front. The full
+     * gain matrix is retained and can be fetched with GetLastGainMatrix()
+     * so other components need not recompute it.
+     *
+     * Worker threads query the propagation loss model directly, bypassing
+     * the channel's path-loss cache (whose unsynchronized inserts are not
+     * thread-safe); the serial path still uses and warms it. Parallelism is
+     * only applied when every model in the loss chain is on an allowlist of
+     * known-pure models (LogDistance, ThreeLogDistance, Friis,
+     * TwoRayGround, FixedRss, Range, Matrix); any other model -- stochastic
+     * ones drawing from RandomVariableStream, or models that lazily fill
+     * internal caches in DoCalcRxPower, such as this module's correlated
+     * shadowing and building penetration losses -- forces a fallback to a
+     * single thread.
+     *
+     * @param numThreads The number of worker threads to use (1 = serial).
+     */
+    static std::vector<int> SetSpreadingFactorsUp(NodeContainer endDevices,
+                                                  NodeContainer gateways,
+                                                  Ptr<LoraChannel> channel,
+                                                  uint32_t numThreads);
+
+    /**
+     * Get the device-gateway gain matrix computed by the last call to
+     * SetSpreadingFactorsUp.
+     *
+     * @return Received power in dBm at 14 dBm transmit power, indexed as
+     * [device index in the container][gateway index]. Empty if
+     * SetSpreadingFactorsUp has not run.
+     */
+    static const std::vector<std::vector<double>>& GetLastGainMatrix();
+
     /**
      * Randomly initialize the end devices' data rate parameter according to the given
      * distribution.
@@ -177,6 +245,12 @@ class LorawanMacHelper
                                                                  std::vector<double> distribution);
 
   private:
+    /**
+     * Gain matrix retained by the last SetSpreadingFactorsUp run, for reuse
+     * by components that would otherwise recompute the same link gains.
+     */
+    static std::vector<std::vector<double>> m_lastGainMatrix;
+
     /**
      * Perform region-specific configurations for the 868 MHz EU band.
      *
@@ -243,10 +317,37 @@ class LorawanMacHelper
      */
     void ApplyCommonAlohaConfigurations(Ptr<LorawanMac> lorawanMac) const;
 
-    ObjectFactory m_mac;                       //!< MAC-layer object factory
+    ObjectFactory m_mac; //!< MAC-layer object factory
+
+    /**
+     * Whether Set was called to override a MAC attribute.
+     *
+     * When no overrides exist, Install constructs MACs through the typed
+     * CreateObject fast path instead of the ObjectFactory, skipping the
+     * factory's per-object attribute list resolution. This matters when
+     * installing very large device populations.
+     */
+    bool m_hasOverrides;
+
     Ptr<LoraDeviceAddressGenerator> m_addrGen; //!< Pointer to the address generator to use
+
+    /**
+     * Addresses prefetched from the generator and not yet assigned, consumed
+     * front to back by Install. Empty when running without prefetching, in
+     * which case Install falls back to one NextAddress call per device.
+     */
+    mutable std::vector<LoraDeviceAddress> m_addrBlock;
+    mutable size_t m_addrBlockNext = 0; //!< Index of the next unassigned prefetched address
+
     enum DeviceType m_deviceType;              //!< The kind of device to install
     enum Regions m_region;                     //!< The region in which the device will operate
+    bool m_shareFrequencyPlan; //!< Whether to share one frequency plan across devices
+
+    /**
+     * The frequency plan prototype shared by installed devices, lazily built
+     * on the first Install call when plan sharing is enabled.
+     */
+    mutable Ptr<LogicalLoraChannelHelper> m_sharedFrequencyPlan;
 };
 
 } // namespace lorawan
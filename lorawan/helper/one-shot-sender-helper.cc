@@ -22,6 +22,46 @@ namespace lorawan
 
 NS_LOG_COMPONENT_DEFINE("OneShotSenderHelper");
 
+void
+OneShotBatchDispatcher::Add(Time sendTime, Ptr<OneShotSender> app)
+{
+    m_schedule[sendTime].push_back(app);
+}
+
+void
+OneShotBatchDispatcher::Start()
+{
+    if (m_schedule.empty())
+    {
+        return;
+    }
+
+    // The event holds a Ptr to this dispatcher, keeping it alive until the
+    // last tick has been dispatched
+    Simulator::Schedule(m_schedule.begin()->first - Simulator::Now(),
+                        &OneShotBatchDispatcher::DispatchTick,
+                        Ptr<OneShotBatchDispatcher>(this));
+}
+
+void
+OneShotBatchDispatcher::DispatchTick()
+{
+    NS_LOG_FUNCTION(this);
+
+    auto tick = m_schedule.begin();
+    NS_ASSERT(tick != m_schedule.end());
+
+    NS_LOG_DEBUG("Dispatching " << tick->second.size() << " one-shot sends at "
+                                << tick->first.As(Time::S));
+    for (auto& app : tick->second)
+    {
+        app->SendPacket();
+    }
+    m_schedule.erase(tick);
+
+    Start();
+}
+
 OneShotSenderHelper::OneShotSenderHelper()
 {
     m_factory.SetTypeId("ns3::OneShotSender");
@@ -61,6 +101,30 @@ OneShotSenderHelper::Install(NodeContainer c) const
     return apps;
 }
 
+ApplicationContainer
+OneShotSenderHelper::Install(NodeContainer c, const std::vector<Time>& sendTimes) const
+{
+    NS_ASSERT_MSG(sendTimes.size() == c.GetN(),
+                  "One send time per node of the container is required");
+
+    Ptr<OneShotBatchDispatcher> dispatcher = Create<OneShotBatchDispatcher>();
+
+    ApplicationContainer apps;
+    uint32_t i = 0;
+    for (auto node = c.Begin(); node != c.End(); ++node, ++i)
+    {
+        Ptr<Application> app = InstallPriv(*node);
+        Ptr<OneShotSender> sender = DynamicCast<OneShotSender>(app);
+        sender->SetExternallyTriggered();
+        dispatcher->Add(sendTimes[i], sender);
+        apps.Add(app);
+    }
+
+    dispatcher->Start();
+
+    return apps;
+}
+
 Ptr<Application>
 OneShotSenderHelper::InstallPriv(Ptr<Node> node) const
 {
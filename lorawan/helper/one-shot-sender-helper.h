@@ -14,17 +14,61 @@
 #include "ns3/attribute.h"
 #include "ns3/net-device.h"
 #include "ns3/node-container.h"
+#include "ns3/nstime.h"
 #include "ns3/object-factory.h"
 #include "ns3/one-shot-sender.h"
+#include "ns3/simple-ref-count.h"
 
+#include <map>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace ns3
 {
 namespace lorawan
 {
 
+/**
+ * @ingroup lorawan
+ *
+ * Shared timer for a batch of externally triggered OneShotSender
+ * applications.
+ *
+ * Sends are grouped by timestamp and the dispatcher keeps exactly one
+ * pending simulator event at any moment: when a tick fires, every sender
+ * registered for that timestamp is dispatched and the event for the next
+ * distinct timestamp is scheduled. Burst scenarios with tens of thousands
+ * of senders thus cost one event-heap entry instead of one per
+ * application. Kept alive by the pending event itself, so the last tick
+ * releases the whole structure.
+ */
+class OneShotBatchDispatcher : public SimpleRefCount<OneShotBatchDispatcher>
+{
+  public:
+    /**
+     * Register one application's send.
+     *
+     * @param sendTime The absolute simulation time of the send.
+     * @param app The application to dispatch at that time.
+     */
+    void Add(Time sendTime, Ptr<OneShotSender> app);
+
+    /**
+     * Schedule the event for the earliest registered tick.
+     */
+    void Start();
+
+  private:
+    /**
+     * Dispatch all sends of the earliest pending tick, then schedule the
+     * next one.
+     */
+    void DispatchTick();
+
+    std::map<Time, std::vector<Ptr<OneShotSender>>> m_schedule; //!< Senders grouped by timestamp
+};
+
 /**
  * @ingroup lorawan
  *
@@ -53,6 +97,21 @@ class OneShotSenderHelper
      */
     ApplicationContainer Install(NodeContainer c) const;
 
+    /**
+     * Install one OneShotSender per node with an individual send time, all
+     * driven by one shared OneShotBatchDispatcher.
+     *
+     * The applications are marked externally triggered, so starting them
+     * only wires up their MAC layer; the dispatcher fires the sends with a
+     * single chained simulator event rather than one event per application.
+     * Send times are absolute simulation times.
+     *
+     * @param c NodeContainer of the set of nodes on which an OneShotSender will be installed.
+     * @param sendTimes One send time per node of the container, in the container's order.
+     * @return Container of Ptr to the applications installed.
+     */
+    ApplicationContainer Install(NodeContainer c, const std::vector<Time>& sendTimes) const;
+
     /**
      * Install a OneShotSender application on the input Node configured with all the attributes set
      * with SetAttribute or other functions of this class.
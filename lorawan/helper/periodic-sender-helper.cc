@@ -16,6 +16,8 @@
 #include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
 
+#include <cmath>
+
 namespace ns3
 {
 namespace lorawan
@@ -39,6 +41,7 @@ PeriodicSenderHelper::PeriodicSenderHelper()
 
     m_pktSize = 10;
     m_pktSizeRV = nullptr;
+    m_deterministicStagger = false;
 }
 
 PeriodicSenderHelper::~PeriodicSenderHelper()
@@ -63,7 +66,10 @@ PeriodicSenderHelper::Install(NodeContainer c) const
     ApplicationContainer apps;
     for (auto i = c.Begin(); i != c.End(); ++i)
     {
-        apps.Add(InstallPriv(*i));
+        if (auto app = InstallPriv(*i))
+        {
+            apps.Add(app);
+        }
     }
 
     return apps;
@@ -74,8 +80,6 @@ PeriodicSenderHelper::InstallPriv(Ptr<Node> node) const
 {
     NS_LOG_FUNCTION(this << node);
 
-    Ptr<PeriodicSender> app = m_factory.Create<PeriodicSender>();
-
     Time interval;
     if (m_period.IsZero())
     {
@@ -105,10 +109,34 @@ PeriodicSenderHelper::InstallPriv(Ptr<Node> node) const
         interval = m_period;
     }
 
+    Time initialDelay;
+    if (m_deterministicStagger)
+    {
+        // Golden-ratio (Weyl) sequence: successive node ids land at maximally
+        // spread fractions of the period, so first sends are provably even
+        constexpr double goldenRatioConjugate = 0.6180339887498949;
+        double fraction = std::fmod(node->GetId() * goldenRatioConjugate, 1.0);
+        initialDelay = Seconds(fraction * interval.GetSeconds());
+    }
+    else
+    {
+        initialDelay = Seconds(m_initialDelay->GetValue(0, interval.GetSeconds()));
+    }
+
+    if (m_trafficEngine)
+    {
+        // Hand the node over to the aggregated engine: no application needed
+        m_trafficEngine->Register(node, initialDelay, interval, m_pktSize, m_pktSizeRV);
+        NS_LOG_DEBUG("Registered node with the traffic engine, interval = " << interval.As(Time::H));
+        return nullptr;
+    }
+
+    Ptr<PeriodicSender> app = m_factory.Create<PeriodicSender>();
+
     app->SetInterval(interval);
     NS_LOG_DEBUG("Created an application with interval = " << interval.As(Time::H));
 
-    app->SetInitialDelay(Seconds(m_initialDelay->GetValue(0, interval.GetSeconds())));
+    app->SetInitialDelay(initialDelay);
     app->SetPacketSize(m_pktSize);
     if (m_pktSizeRV)
     {
@@ -139,5 +167,29 @@ PeriodicSenderHelper::SetPacketSize(uint8_t size)
     m_pktSize = size;
 }
 
+int64_t
+PeriodicSenderHelper::AssignStreams(int64_t stream)
+{
+    m_initialDelay->SetStream(stream);
+    m_intervalProb->SetStream(stream + 1);
+    if (m_pktSizeRV)
+    {
+        m_pktSizeRV->SetStream(stream + 2);
+    }
+    return 3;
+}
+
+void
+PeriodicSenderHelper::SetTrafficEngine(Ptr<PeriodicTrafficEngine> engine)
+{
+    m_trafficEngine = engine;
+}
+
+void
+PeriodicSenderHelper::SetDeterministicStagger(bool stagger)
+{
+    m_deterministicStagger = stagger;
+}
+
 } // namespace lorawan
 } // namespace ns3
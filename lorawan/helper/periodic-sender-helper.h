@@ -16,6 +16,7 @@
 #include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 #include "ns3/periodic-sender.h"
+#include "ns3/periodic-traffic-engine.h"
 
 #include <stdint.h>
 #include <string>
@@ -89,6 +90,45 @@ class PeriodicSenderHelper
      */
     void SetPacketSize(uint8_t size);
 
+    /**
+     * Enable or disable deterministic low-discrepancy staggering of initial
+     * delays.
+     *
+     * When enabled, the initial delay of each node is derived from its node
+     * id through the golden-ratio (Weyl) sequence mapped over the send
+     * interval, instead of being drawn from a random variable. This spreads
+     * first transmissions provably evenly over the period, avoiding the
+     * clumps a random draw can produce at large scale, and is reproducible
+     * without per-device RNG stream setup.
+     *
+     * @param stagger Whether to use the deterministic stagger policy.
+     */
+    void SetDeterministicStagger(bool stagger);
+
+    /**
+     * Set the fixed stream numbers of this helper's random variables.
+     *
+     * The initial delay and interval draws happen at Install time, so
+     * pinning their streams makes application timing independent of any
+     * other random variable the scenario creates before this helper.
+     *
+     * @param stream The first stream index to use.
+     * @return The number of stream indices consumed.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * Route the traffic of subsequently installed nodes through an aggregated
+     * PeriodicTrafficEngine instead of per-node PeriodicSender applications.
+     *
+     * In this mode Install registers each node with the engine, using the
+     * same interval and initial delay draws as the per-node applications,
+     * and returns an empty container since no applications are created.
+     *
+     * @param engine The traffic engine to register nodes with.
+     */
+    void SetTrafficEngine(Ptr<PeriodicTrafficEngine> engine);
+
   private:
     /**
      * Install a PeriodicSender application on the input Node configured with all the attributes set
@@ -109,6 +149,9 @@ class PeriodicSenderHelper
     Ptr<RandomVariableStream>
         m_pktSizeRV;   //!< Whether or not a random component is added to the packet size.
     uint8_t m_pktSize; //!< The base packet size.
+    Ptr<PeriodicTrafficEngine>
+        m_trafficEngine; //!< Optional aggregated engine replacing per-node applications.
+    bool m_deterministicStagger; //!< Whether initial delays follow the deterministic stagger.
 };
 
 } // namespace lorawan
@@ -0,0 +1,227 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "run-summary-helper.h"
+
+#include "ns3/log.h"
+#include "ns3/lora-phy.h"
+#include "ns3/node.h"
+
+#include <fstream>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("RunSummaryHelper");
+
+void
+RunSummaryHelper::SetPacketTracker(LoraPacketTracker* tracker)
+{
+    m_tracker = tracker;
+}
+
+void
+RunSummaryHelper::SetStatisticsCollector(Ptr<StatisticsCollectorComponent> collector)
+{
+    m_collector = collector;
+}
+
+void
+RunSummaryHelper::SetGateways(NodeContainer gateways)
+{
+    m_gateways = gateways;
+}
+
+void
+RunSummaryHelper::SetTxEnergyModel(double supplyVoltageV, double txCurrentA)
+{
+    m_supplyVoltageV = supplyVoltageV;
+    m_txCurrentA = txCurrentA;
+}
+
+void
+RunSummaryHelper::SetAirtimePayloadSize(uint32_t payloadBytes)
+{
+    m_airtimePayloadBytes = payloadBytes;
+}
+
+bool
+RunSummaryHelper::WriteSummary(std::string prefix, Time startTime, Time stopTime)
+{
+    NS_LOG_FUNCTION(this << prefix << startTime << stopTime);
+
+    bool ok = true;
+    if (m_tracker)
+    {
+        ok &= WriteSfSummary(prefix + "-sf.csv");
+    }
+    if (m_collector)
+    {
+        ok &= WriteDeviceSummary(prefix + "-devices.csv");
+    }
+    if (m_collector || (m_tracker && m_gateways.GetN() > 0))
+    {
+        ok &= WriteGatewaySummary(prefix + "-gateways.csv", startTime, stopTime);
+    }
+    return ok;
+}
+
+Time
+RunSummaryHelper::ReferenceAirtime(uint8_t sf) const
+{
+    LoraTxParameters txParams;
+    txParams.sf = sf;
+    txParams.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(txParams) > MilliSeconds(16);
+    return LoraPhy::GetOnAirTime(Create<Packet>(m_airtimePayloadBytes), txParams);
+}
+
+bool
+RunSummaryHelper::WriteSfSummary(const std::string& filename)
+{
+    std::ofstream output(filename);
+    if (!output.is_open())
+    {
+        NS_LOG_ERROR("Could not open " << filename << " for writing");
+        return false;
+    }
+
+    output << "sf,sent,received,interfered,noMoreReceivers,underSensitivity,lostBecauseTx,"
+              "deliveredCopiesPerTx,weightedPer,airtimeS\n";
+    for (uint8_t sf = 7; sf <= 12; sf++)
+    {
+        auto& counters = m_tracker->GetSfCounters(sf);
+        uint32_t sent = counters.sent.Get();
+        uint32_t received = counters.outcomes.at(RECEIVED).Get();
+        // With several gateways the outcome counters count gateway copies,
+        // so this ratio is the mean number of receiving gateways per
+        // transmission; with one gateway it is the plain PHY delivery ratio
+        double copiesPerTx = sent > 0 ? double(received) / sent : 0;
+        output << unsigned(sf) << "," << sent << "," << received << ","
+               << counters.outcomes.at(INTERFERED).Get() << ","
+               << counters.outcomes.at(NO_MORE_RECEIVERS).Get() << ","
+               << counters.outcomes.at(UNDER_SENSITIVITY).Get() << ","
+               << counters.outcomes.at(LOST_BECAUSE_TX).Get() << "," << copiesPerTx << ","
+               << m_tracker->GetWeightedPerEstimate(sf) << ","
+               << m_tracker->GetSfAirtime(sf).GetSeconds() << "\n";
+    }
+    return true;
+}
+
+bool
+RunSummaryHelper::WriteDeviceSummary(const std::string& filename)
+{
+    std::ofstream output(filename);
+    if (!output.is_open())
+    {
+        NS_LOG_ERROR("Could not open " << filename << " for writing");
+        return false;
+    }
+
+    // Price each device's SF distribution once; the distributions only ever
+    // contain SF7 to SF12
+    std::map<uint8_t, double> airtimePerPacket;
+    for (uint8_t sf = 7; sf <= 12; sf++)
+    {
+        airtimePerPacket[sf] = ReferenceAirtime(sf).GetSeconds();
+    }
+
+    output << "deviceAddr,sent,receivedByGateways,receivedByNetworkServer,endToEndErrorRate,"
+              "nbTrans,adrAdjustments,lastAdrChangeS,avgRssi,avgSnr,estAirtimeS,estTxEnergyJ\n";
+    for (uint32_t deviceAddr : m_collector->GetTrackedDevices())
+    {
+        auto pktStats = m_collector->GetPacketTrackingStats(deviceAddr);
+        auto devStats = m_collector->GetDeviceStats(deviceAddr);
+
+        double airtime = 0;
+        for (const auto& [sf, count] : pktStats.sfDistribution)
+        {
+            auto it = airtimePerPacket.find(sf);
+            if (it != airtimePerPacket.end())
+            {
+                airtime += count * it->second;
+            }
+        }
+
+        output << deviceAddr << "," << pktStats.totalPacketsSent << ","
+               << pktStats.packetsReceivedByGateways << ","
+               << pktStats.packetsReceivedByNetworkServer << "," << pktStats.endToEndErrorRate
+               << "," << unsigned(devStats.currentNbTrans) << "," << devStats.adrAdjustmentCount
+               << "," << devStats.lastNbTransChange.GetSeconds() << "," << devStats.averageRssi
+               << "," << devStats.averageSnr << "," << airtime << ","
+               << airtime * m_txCurrentA * m_supplyVoltageV << "\n";
+    }
+    return true;
+}
+
+bool
+RunSummaryHelper::WriteGatewaySummary(const std::string& filename, Time startTime, Time stopTime)
+{
+    std::ofstream output(filename);
+    if (!output.is_open())
+    {
+        NS_LOG_ERROR("Could not open " << filename << " for writing");
+        return false;
+    }
+
+    output << "gatewayId,packetsReceived,medianRssi,medianSnr,phySent,phyReceived,"
+              "phyInterfered,phyNoMoreReceivers,phyUnderSensitivity,phyLostBecauseTx\n";
+
+    // Aggregate the collector's per-device reception counts into the
+    // per-gateway load. Gateway ids are the indices the campaign fed to
+    // RecordRadioMeasurement, which by convention index the gateway
+    // container in order
+    std::map<uint32_t, uint64_t> load;
+    if (m_collector)
+    {
+        for (uint32_t deviceAddr : m_collector->GetTrackedDevices())
+        {
+            auto pktStats = m_collector->GetPacketTrackingStats(deviceAddr);
+            for (const auto& [gatewayId, receptions] : pktStats.perGatewayReceptions)
+            {
+                load[gatewayId] += receptions;
+            }
+        }
+    }
+    // Gateways without collector measurements (or collector-less runs)
+    // still get a row when the container was provided
+    for (uint32_t i = 0; i < m_gateways.GetN(); i++)
+    {
+        load.emplace(i, 0);
+    }
+
+    for (const auto& [gatewayId, packetsReceived] : load)
+    {
+        output << gatewayId << "," << packetsReceived << ",";
+        if (m_collector)
+        {
+            output << m_collector->GetGatewayRssiQuantile(gatewayId, 0.5) << ","
+                   << m_collector->GetGatewaySnrQuantile(gatewayId, 0.5);
+        }
+        else
+        {
+            output << "nan,nan";
+        }
+        if (m_tracker && gatewayId < m_gateways.GetN())
+        {
+            auto phy = m_tracker->CountPhyPacketsPerGw(startTime,
+                                                       stopTime,
+                                                       m_gateways.Get(gatewayId)->GetId());
+            for (int value : phy)
+            {
+                output << "," << value;
+            }
+        }
+        else
+        {
+            output << ",0,0,0,0,0,0";
+        }
+        output << "\n";
+    }
+    return true;
+}
+
+} // namespace lorawan
+} // namespace ns3
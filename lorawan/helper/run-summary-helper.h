@@ -0,0 +1,160 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef RUN_SUMMARY_HELPER_H
+#define RUN_SUMMARY_HELPER_H
+
+#include "lora-packet-tracker.h"
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/statistics-collector.h"
+
+#include <string>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * End-of-run aggregation of the module's online counters into compact
+ * summary files.
+ *
+ * Campaign pipelines used to dump multi-gigabyte per-measurement CSVs and
+ * re-derive per-SF delivery ratios, per-device error rates and per-gateway
+ * load in external scripts, often spending longer in pandas than in the
+ * simulator. Everything those scripts compute is already maintained online
+ * by LoraPacketTracker (per-SF and per-gateway PHY outcome counters) and
+ * StatisticsCollectorComponent (per-device packet tracking, streaming radio
+ * aggregates, ADR adjustment history), so WriteSummary() folds it into
+ * three small CSVs in one pass at the end of the run and the external step
+ * reduces to plotting.
+ *
+ * Per-device energy is a first-order transmit-window estimate: the
+ * collector's per-device spreading factor distribution priced at the
+ * time-on-air of a configurable reference payload, times a configurable
+ * transmit current and supply voltage (defaults match
+ * LoraRadioEnergyModel). Runs that install the energy model should prefer
+ * its per-node totals; the estimate here is for campaigns that do not.
+ */
+class RunSummaryHelper
+{
+  public:
+    /**
+     * Set the packet tracker feeding the per-SF and per-gateway rows.
+     *
+     * The tracker outlives the helper (LoraHelper owns it), so a plain
+     * pointer is taken.
+     *
+     * @param tracker The tracker, typically LoraHelper::GetPacketTracker().
+     */
+    void SetPacketTracker(LoraPacketTracker* tracker);
+
+    /**
+     * Set the server-side collector feeding the per-device rows.
+     *
+     * @param collector The statistics collector component.
+     */
+    void SetStatisticsCollector(Ptr<StatisticsCollectorComponent> collector);
+
+    /**
+     * Set the gateway nodes so the gateway summary can include the
+     * tracker's per-gateway PHY outcome breakdown (received, interfered,
+     * no-more-receivers, under-sensitivity, lost-to-downlink).
+     *
+     * @param gateways The gateway nodes.
+     */
+    void SetGateways(NodeContainer gateways);
+
+    /**
+     * Set the transmit power model behind the per-device energy estimate.
+     *
+     * @param supplyVoltageV The supply voltage [V].
+     * @param txCurrentA The radio current while transmitting [A].
+     */
+    void SetTxEnergyModel(double supplyVoltageV, double txCurrentA);
+
+    /**
+     * Set the reference PHY payload size used to price time-on-air in the
+     * per-device airtime and energy estimates.
+     *
+     * @param payloadBytes The PHY payload size [B].
+     */
+    void SetAirtimePayloadSize(uint32_t payloadBytes);
+
+    /**
+     * Aggregate the online counters into summary files, in one pass.
+     *
+     * Writes up to three CSVs next to each other: `<prefix>-sf.csv` (one
+     * row per spreading factor with transmission and outcome counts,
+     * delivered-copy ratio and the weighted PER estimate when rare-event
+     * splitting is on), `<prefix>-devices.csv` (one row per tracked device
+     * with sent/received counts, end-to-end error rate, NbTrans, ADR
+     * adjustment count, time of the last ADR adjustment as the convergence
+     * proxy, streaming RSSI/SNR averages and the airtime/energy estimates)
+     * and `<prefix>-gateways.csv` (one row per gateway with its reception
+     * load, median RSSI/SNR and, when the gateway nodes were provided, the
+     * tracker's PHY outcome breakdown over the measurement window).
+     *
+     * Sections whose source was not provided are skipped, so the helper is
+     * usable with only a tracker or only a collector.
+     *
+     * @param prefix The common path prefix of the summary files.
+     * @param startTime Start of the measurement window for windowed counts.
+     * @param stopTime End of the measurement window for windowed counts.
+     * @return True if every applicable file was written.
+     */
+    bool WriteSummary(std::string prefix, Time startTime, Time stopTime);
+
+  private:
+    /**
+     * Time-on-air of the reference payload at one spreading factor.
+     *
+     * @param sf The spreading factor, in [7, 12].
+     * @return The time on air.
+     */
+    Time ReferenceAirtime(uint8_t sf) const;
+
+    /**
+     * Write the per-SF summary.
+     *
+     * @param filename The output file.
+     * @return True on success.
+     */
+    bool WriteSfSummary(const std::string& filename);
+
+    /**
+     * Write the per-device summary.
+     *
+     * @param filename The output file.
+     * @return True on success.
+     */
+    bool WriteDeviceSummary(const std::string& filename);
+
+    /**
+     * Write the per-gateway summary.
+     *
+     * @param filename The output file.
+     * @param startTime Start of the measurement window.
+     * @param stopTime End of the measurement window.
+     * @return True on success.
+     */
+    bool WriteGatewaySummary(const std::string& filename, Time startTime, Time stopTime);
+
+    LoraPacketTracker* m_tracker = nullptr;            //!< Source of PHY outcome counters
+    Ptr<StatisticsCollectorComponent> m_collector;     //!< Source of per-device statistics
+    NodeContainer m_gateways;                          //!< Gateway nodes, optional
+    double m_supplyVoltageV = 3.3;                     //!< Supply voltage [V]
+    double m_txCurrentA = 0.028;                       //!< Transmit current [A]
+    uint32_t m_airtimePayloadBytes = 23;               //!< Reference PHY payload size [B]
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif /* RUN_SUMMARY_HELPER_H */
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#include "adaptive-fidelity-manager.h"
+
+#include "lora-net-device.h"
+
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("AdaptiveFidelityManager");
+
+NS_OBJECT_ENSURE_REGISTERED(AdaptiveFidelityManager);
+
+TypeId
+AdaptiveFidelityManager::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::AdaptiveFidelityManager")
+                            .SetParent<Object>()
+                            .AddConstructor<AdaptiveFidelityManager>()
+                            .SetGroupName("lorawan");
+    return tid;
+}
+
+AdaptiveFidelityManager::AdaptiveFidelityManager()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AdaptiveFidelityManager::~AdaptiveFidelityManager()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+AdaptiveFidelityManager::SetBackgroundGenerator(Ptr<BackgroundLoadGenerator> generator)
+{
+    NS_LOG_FUNCTION(this << generator);
+
+    m_generator = generator;
+}
+
+bool
+AdaptiveFidelityManager::Demote(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(this << node->GetId());
+
+    NS_ASSERT_MSG(m_generator, "No background generator set on this AdaptiveFidelityManager");
+
+    Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(node->GetDevice(0));
+    NS_ASSERT(loraNetDevice);
+    Ptr<ClassAEndDeviceLorawanMac> mac =
+        DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+    NS_ASSERT(mac);
+
+    uint32_t address = mac->GetDeviceAddress().Get();
+    if (m_demoted.find(address) != m_demoted.end())
+    {
+        NS_LOG_WARN("Node " << node->GetId() << " is already demoted");
+        return false;
+    }
+
+    // Find and silence the traffic source
+    Ptr<PeriodicSender> app;
+    for (uint32_t i = 0; i < node->GetNApplications(); i++)
+    {
+        app = DynamicCast<PeriodicSender>(node->GetApplication(i));
+        if (app)
+        {
+            break;
+        }
+    }
+    if (!app)
+    {
+        NS_LOG_WARN("Node " << node->GetId() << " has no PeriodicSender to demote");
+        return false;
+    }
+    app->StopApplication();
+
+    // Hand the statistical stand-in the device's current link parameters;
+    // the mobility model is shared, so a moving node keeps moving
+    uint8_t sf = 12 - std::min<uint8_t>(mac->GetDataRate(), 5);
+    m_generator->AddTrackedDevice(address,
+                                  node->GetObject<MobilityModel>(),
+                                  sf,
+                                  mac->GetTransmissionPowerDbm(),
+                                  app->GetInterval());
+
+    m_demoted[address] = {app, mac};
+
+    NS_LOG_INFO("Demoted node " << node->GetId() << " (address " << address << ") to SF"
+                                << unsigned(sf) << " statistical model");
+    return true;
+}
+
+bool
+AdaptiveFidelityManager::Promote(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(this << node->GetId());
+
+    Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(node->GetDevice(0));
+    NS_ASSERT(loraNetDevice);
+    Ptr<ClassAEndDeviceLorawanMac> mac =
+        DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+    NS_ASSERT(mac);
+
+    auto demoted = m_demoted.find(mac->GetDeviceAddress().Get());
+    if (demoted == m_demoted.end())
+    {
+        NS_LOG_WARN("Node " << node->GetId() << " is not demoted");
+        return false;
+    }
+
+    // Fold the statistical transmissions into the frame counter, so the
+    // uplink counting the network server sees stays consistent
+    uint32_t txCount = 0;
+    m_generator->RemoveTrackedDevice(demoted->first, &txCount);
+    mac->SetFrameCounter(mac->GetFrameCounter() + txCount);
+
+    demoted->second.app->StartApplication();
+    m_demoted.erase(demoted);
+
+    NS_LOG_INFO("Promoted node " << node->GetId() << " back to full fidelity after " << txCount
+                                 << " statistical transmissions");
+    return true;
+}
+
+bool
+AdaptiveFidelityManager::IsDemoted(Ptr<Node> node) const
+{
+    Ptr<LoraNetDevice> loraNetDevice = DynamicCast<LoraNetDevice>(node->GetDevice(0));
+    NS_ASSERT(loraNetDevice);
+    Ptr<ClassAEndDeviceLorawanMac> mac =
+        DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+    NS_ASSERT(mac);
+
+    return m_demoted.find(mac->GetDeviceAddress().Get()) != m_demoted.end();
+}
+
+uint32_t
+AdaptiveFidelityManager::GetNDemoted() const
+{
+    return m_demoted.size();
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef ADAPTIVE_FIDELITY_MANAGER_H
+#define ADAPTIVE_FIDELITY_MANAGER_H
+
+#include "background-load-generator.h"
+#include "class-a-end-device-lorawan-mac.h"
+#include "periodic-sender.h"
+
+#include "ns3/node.h"
+#include "ns3/object.h"
+
+#include <unordered_map>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Runtime fidelity switching between the full device stack and the
+ * statistical background model.
+ *
+ * A 200k-device scenario rarely needs every device at full fidelity at
+ * once: the experiment examines a focus set while the rest only matter as
+ * channel load. This class demotes a fully modeled end device to a tracked
+ * BackgroundLoadGenerator descriptor — its PeriodicSender is stopped and a
+ * statistical stand-in with the same position, spreading factor,
+ * transmission power and send period takes over — and promotes it back
+ * when the focus shifts.
+ *
+ * MAC state survives the round trip: data rate and transmission power stay
+ * on the (idle) MAC while demoted, and on promotion the uplink frame
+ * counter is advanced by the number of statistical transmissions performed
+ * in the meantime, so the frame counting the network server sees stays
+ * consistent. Duty-cycle bookkeeping is approximated: the statistical model
+ * transmits at the full model's period (compliant whenever the full model
+ * was), and a freshly promoted device restarts with an unencumbered duty
+ * cycle, which its period makes true in practice.
+ */
+class AdaptiveFidelityManager : public Object
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    AdaptiveFidelityManager();           //!< Default constructor
+    ~AdaptiveFidelityManager() override; //!< Destructor
+
+    /**
+     * Set the statistical model demoted devices are handed to.
+     *
+     * @param generator The background load generator.
+     */
+    void SetBackgroundGenerator(Ptr<BackgroundLoadGenerator> generator);
+
+    /**
+     * Demote a full-fidelity end device to its statistical stand-in.
+     *
+     * @param node The node holding the device; must carry a LoraNetDevice
+     * with a class A MAC and a PeriodicSender application.
+     * @return True on success, false if the node is already demoted or has
+     * no PeriodicSender to silence.
+     */
+    bool Demote(Ptr<Node> node);
+
+    /**
+     * Promote a demoted device back to the full stack.
+     *
+     * @param node The node to promote.
+     * @return True on success, false if the node is not demoted.
+     */
+    bool Promote(Ptr<Node> node);
+
+    /**
+     * Check whether a node currently runs as its statistical stand-in.
+     *
+     * @param node The node to check.
+     * @return True if the node is demoted.
+     */
+    bool IsDemoted(Ptr<Node> node) const;
+
+    /**
+     * Get the number of currently demoted devices.
+     *
+     * @return The number of demoted devices.
+     */
+    uint32_t GetNDemoted() const;
+
+  private:
+    /**
+     * What a demoted device needs to resume full fidelity.
+     */
+    struct DemotedState
+    {
+        Ptr<PeriodicSender> app;               //!< The silenced application.
+        Ptr<ClassAEndDeviceLorawanMac> mac;    //!< The device's (idle) MAC.
+    };
+
+    Ptr<BackgroundLoadGenerator> m_generator; //!< The statistical model.
+
+    /**
+     * The demoted devices, keyed by raw device address — the same identity
+     * their stand-ins are tracked under in the generator.
+     */
+    std::unordered_map<uint32_t, DemotedState> m_demoted;
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* ADAPTIVE_FIDELITY_MANAGER_H */
@@ -8,6 +8,10 @@
 
 #include "adr-component.h"
 
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
 namespace ns3
 {
 namespace lorawan
@@ -58,7 +62,15 @@ AdrComponent::GetTypeId()
                           "Whether to toggle the transmission power or not",
                           BooleanValue(true),
                           MakeBooleanAccessor(&AdrComponent::m_toggleTxPower),
-                          MakeBooleanChecker());
+                          MakeBooleanChecker())
+            .AddAttribute("EpochDuration",
+                          "Period of the batched ADR evaluation pass. Zero evaluates each "
+                          "device inline when its reply is prepared; a positive value marks "
+                          "devices dirty on uplink and evaluates all of them in one periodic "
+                          "batch",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&AdrComponent::m_epochDuration),
+                          MakeTimeChecker());
     return tid;
 }
 
@@ -86,21 +98,63 @@ AdrComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus>
 {
     NS_LOG_FUNCTION(this << status << networkStatus);
 
-    Ptr<Packet> myPacket = status->GetLastPacketReceivedFromDevice()->Copy();
-    LorawanMacHeader mHdr;
-    LoraFrameHeader fHdr;
-    fHdr.SetAsUplink();
-    myPacket->RemoveHeader(mHdr);
-    myPacket->RemoveHeader(fHdr);
+    const EndDeviceStatus::ReceivedPacketList& packetList = status->GetReceivedPacketList();
+
+    // Keep the device's rolling SNR window up to date, one sample per uplink.
+    // By now every gateway copy of the last uplink has been recorded, so its
+    // combined received power is final
+    SnrHistory& history = m_snrHistories[status->m_endDeviceAddress.Get()];
+    if (!packetList.empty() && history.lastPacket != packetList.back().first)
+    {
+        history.lastPacket = packetList.back().first;
+        PushSnrSample(history, RxPowerToSNR(GetReceivedPower(packetList.back().second.gwList)));
+    }
+
+    if (!m_epochDuration.IsZero())
+    {
+        // Batched mode: remember the device and let the periodic pass run
+        // the ADR math; the resulting LinkAdrReq rides the next reply
+        m_dirtyDevices[status->m_endDeviceAddress.Get()] = status;
+        if (!m_epochEvent.IsPending())
+        {
+            m_epochEvent =
+                Simulator::Schedule(m_epochDuration, &AdrComponent::EvaluateDirtyDevices, this);
+        }
+        return;
+    }
+
+    EvaluateAdr(status);
+}
+
+void
+AdrComponent::EvaluateDirtyDevices()
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_DEBUG("Batched ADR pass over " << m_dirtyDevices.size() << " dirty devices");
+
+    // Swap the dirty set out first, so devices marked while evaluating are
+    // picked up by the next epoch
+    std::unordered_map<uint32_t, Ptr<EndDeviceStatus>> dirty;
+    dirty.swap(m_dirtyDevices);
+    for (auto& [address, status] : dirty)
+    {
+        EvaluateAdr(status);
+    }
+}
+
+void
+AdrComponent::EvaluateAdr(Ptr<EndDeviceStatus> status)
+{
+    const EndDeviceStatus::ReceivedPacketList& packetList = status->GetReceivedPacketList();
 
     // Execute the Adaptive Data Rate (ADR) algorithm only if the request bit is set
-    if (fHdr.GetAdr())
+    if (LoraFrameHeader::PeekFields(status->GetLastPacketReceivedFromDevice()).adr)
     {
-        if (int(status->GetReceivedPacketList().size()) < historyRange)
+        if (int(packetList.size()) < historyRange)
         {
             NS_LOG_ERROR("Not enough packets received by this device ("
-                         << status->GetReceivedPacketList().size()
-                         << ") for the algorithm to work (need " << historyRange << ")");
+                         << packetList.size() << ") for the algorithm to work (need "
+                         << historyRange << ")");
         }
         else
         {
@@ -127,9 +181,8 @@ AdrComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus>
 
             if (newDataRate != SfToDr(spreadingFactor) || newTxPowerDbm != transmissionPowerDbm)
             {
-                // Create a list with mandatory channel indexes
-                int channels[] = {0, 1, 2};
-                std::list<int> enabledChannels(channels, channels + sizeof(channels) / sizeof(int));
+                // Mask with the mandatory channel indexes 0-2 enabled
+                const uint16_t channelMask = 0b111;
 
                 // Repetitions Setting
                 const int rep = 1;
@@ -137,14 +190,15 @@ AdrComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus>
                 NS_LOG_DEBUG("Sending LinkAdrReq with DR = "
                              << (unsigned)newDataRate << " and TP = " << newTxPowerDbm << "dBm");
 
-                status->m_reply.frameHeader.AddLinkAdrReq(newDataRate,
-                                                          GetTxPowerIndex(newTxPowerDbm),
-                                                          enabledChannels,
-                                                          rep);
+                // Queue the command: EndDeviceStatus coalesces everything
+                // pending into one FOpts block when the downlink goes out
+                status->AddMACCommand(Create<LinkAdrReq>(newDataRate,
+                                                         GetTxPowerIndex(newTxPowerDbm),
+                                                         channelMask,
+                                                         0,
+                                                         rep));
                 status->m_reply.frameHeader.SetAsDownlink();
                 status->m_reply.macHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
-
-                status->m_reply.needsReply = true;
             }
             else
             {
@@ -169,18 +223,20 @@ AdrComponent::AdrImplementation(uint8_t* newDataRate,
                                 double* newTxPower,
                                 Ptr<EndDeviceStatus> status)
 {
-    // Compute the maximum or median SNR, based on the boolean value historyAveraging
+    // Read the chosen aggregate from the device's rolling SNR window,
+    // maintained in BeforeSendingReply as uplinks are evaluated
+    const SnrHistory& history = m_snrHistories[status->m_endDeviceAddress.Get()];
     double m_SNR = 0;
     switch (historyAveraging)
     {
     case AdrComponent::AVERAGE:
-        m_SNR = GetAverageSNR(status->GetReceivedPacketList(), historyRange);
+        m_SNR = history.sum / history.window.size();
         break;
     case AdrComponent::MAXIMUM:
-        m_SNR = GetMaxSNR(status->GetReceivedPacketList(), historyRange);
+        m_SNR = history.maxDeque.front().second;
         break;
     case AdrComponent::MINIMUM:
-        m_SNR = GetMinSNR(status->GetReceivedPacketList(), historyRange);
+        m_SNR = history.minDeque.front().second;
     }
 
     NS_LOG_DEBUG("m_SNR = " << m_SNR);
@@ -190,8 +246,8 @@ AdrComponent::AdrImplementation(uint8_t* newDataRate,
 
     NS_LOG_DEBUG("SF = " << (unsigned)spreadingFactor);
 
-    // Get the device data rate and use it to get the SNR demodulation threshold
-    double req_SNR = threshold[SfToDr(spreadingFactor)];
+    // Get the SNR demodulation threshold from the shared radio tables
+    double req_SNR = SnrThresholdForSf(spreadingFactor);
 
     NS_LOG_DEBUG("Required SNR = " << req_SNR);
 
@@ -277,9 +333,45 @@ AdrComponent::RxPowerToSNR(double transmissionPower) const
     return transmissionPower + 174 - 10 * log10(B) - NF;
 }
 
+void
+AdrComponent::PushSnrSample(SnrHistory& history, double snr)
+{
+    history.count++;
+    history.sum += snr;
+    history.window.push_back(snr);
+    if (int(history.window.size()) > std::max(historyRange, 1))
+    {
+        history.sum -= history.window.front();
+        history.window.pop_front();
+    }
+
+    // Monotonic deques: drop candidates the new sample supersedes, then
+    // drop front candidates that fell out of the window
+    while (!history.minDeque.empty() && history.minDeque.back().second >= snr)
+    {
+        history.minDeque.pop_back();
+    }
+    history.minDeque.emplace_back(history.count, snr);
+    while (!history.maxDeque.empty() && history.maxDeque.back().second <= snr)
+    {
+        history.maxDeque.pop_back();
+    }
+    history.maxDeque.emplace_back(history.count, snr);
+
+    uint64_t oldest = history.count - history.window.size() + 1;
+    while (history.minDeque.front().first < oldest)
+    {
+        history.minDeque.pop_front();
+    }
+    while (history.maxDeque.front().first < oldest)
+    {
+        history.maxDeque.pop_front();
+    }
+}
+
 // Get the maximum received power (it considers the values in dB!)
 double
-AdrComponent::GetMinTxFromGateways(EndDeviceStatus::GatewayList gwList)
+AdrComponent::GetMinTxFromGateways(const EndDeviceStatus::GatewayList& gwList)
 {
     auto it = gwList.begin();
     double min = it->second.rxPower;
@@ -297,7 +389,7 @@ AdrComponent::GetMinTxFromGateways(EndDeviceStatus::GatewayList gwList)
 
 // Get the maximum received power (it considers the values in dB!)
 double
-AdrComponent::GetMaxTxFromGateways(EndDeviceStatus::GatewayList gwList)
+AdrComponent::GetMaxTxFromGateways(const EndDeviceStatus::GatewayList& gwList)
 {
     auto it = gwList.begin();
     double max = it->second.rxPower;
@@ -315,7 +407,7 @@ AdrComponent::GetMaxTxFromGateways(EndDeviceStatus::GatewayList gwList)
 
 // Get the maximum received power
 double
-AdrComponent::GetAverageTxFromGateways(EndDeviceStatus::GatewayList gwList)
+AdrComponent::GetAverageTxFromGateways(const EndDeviceStatus::GatewayList& gwList)
 {
     double sum = 0;
 
@@ -333,7 +425,7 @@ AdrComponent::GetAverageTxFromGateways(EndDeviceStatus::GatewayList gwList)
 }
 
 double
-AdrComponent::GetReceivedPower(EndDeviceStatus::GatewayList gwList)
+AdrComponent::GetReceivedPower(const EndDeviceStatus::GatewayList& gwList)
 {
     switch (tpAveraging)
     {
@@ -350,7 +442,7 @@ AdrComponent::GetReceivedPower(EndDeviceStatus::GatewayList gwList)
 
 // TODO Make this more elegant
 double
-AdrComponent::GetMinSNR(EndDeviceStatus::ReceivedPacketList packetList, int historyRange)
+AdrComponent::GetMinSNR(const EndDeviceStatus::ReceivedPacketList& packetList, int historyRange)
 {
     double m_SNR;
 
@@ -377,7 +469,7 @@ AdrComponent::GetMinSNR(EndDeviceStatus::ReceivedPacketList packetList, int hist
 }
 
 double
-AdrComponent::GetMaxSNR(EndDeviceStatus::ReceivedPacketList packetList, int historyRange)
+AdrComponent::GetMaxSNR(const EndDeviceStatus::ReceivedPacketList& packetList, int historyRange)
 {
     double m_SNR;
 
@@ -404,7 +496,7 @@ AdrComponent::GetMaxSNR(EndDeviceStatus::ReceivedPacketList packetList, int hist
 }
 
 double
-AdrComponent::GetAverageSNR(EndDeviceStatus::ReceivedPacketList packetList, int historyRange)
+AdrComponent::GetAverageSNR(const EndDeviceStatus::ReceivedPacketList& packetList, int historyRange)
 {
     double sum = 0;
     double m_SNR;
@@ -9,13 +9,20 @@
 #ifndef ADR_COMPONENT_H
 #define ADR_COMPONENT_H
 
+#include "lora-radio-tables.h"
 #include "network-controller-components.h"
 #include "network-status.h"
 
+#include "ns3/event-id.h"
 #include "ns3/log.h"
+#include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
 namespace ns3
 {
 namespace lorawan
@@ -57,6 +64,20 @@ class AdrComponent : public NetworkControllerComponent
     void OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
 
   private:
+    /**
+     * Run the ADR evaluation for one device, attaching a LinkAdrReq to its
+     * pending reply when the algorithm selects new parameters. Shared by the
+     * per-reply path and the epoch-batched pass.
+     *
+     * @param status State representation of the current end device.
+     */
+    void EvaluateAdr(Ptr<EndDeviceStatus> status);
+
+    /**
+     * Evaluate every device marked ADR-dirty since the last pass in one
+     * batch, then clear the dirty set.
+     */
+    void EvaluateDirtyDevices();
     /**
      * Implementation of the default Adaptive Data Rate (ADR) procedure.
      *
@@ -98,28 +119,28 @@ class AdrComponent : public NetworkControllerComponent
      * @param gwList List of gateways paired with reception information.
      * @return Min RSSI of transmission as double.
      */
-    double GetMinTxFromGateways(EndDeviceStatus::GatewayList gwList);
+    double GetMinTxFromGateways(const EndDeviceStatus::GatewayList& gwList);
     /**
      * Get the max RSSI (dBm) among gateways receiving the same transmission.
      *
      * @param gwList List of gateways paired with packet reception information.
      * @return Max RSSI of transmission as double.
      */
-    double GetMaxTxFromGateways(EndDeviceStatus::GatewayList gwList);
+    double GetMaxTxFromGateways(const EndDeviceStatus::GatewayList& gwList);
     /**
      * Get the average RSSI (dBm) of gateways receiving the same transmission.
      *
      * @param gwList List of gateways paired with packet reception information.
      * @return Average RSSI of transmission as double.
      */
-    double GetAverageTxFromGateways(EndDeviceStatus::GatewayList gwList);
+    double GetAverageTxFromGateways(const EndDeviceStatus::GatewayList& gwList);
     /**
      * Get RSSI metric for a transmission according to chosen gateway aggregation policy.
      *
      * @param gwList List of gateways paired with packet reception information.
      * @return RSSI of tranmsmission as double.
      */
-    double GetReceivedPower(EndDeviceStatus::GatewayList gwList);
+    double GetReceivedPower(const EndDeviceStatus::GatewayList& gwList);
 
     /**
      * Get the min Signal to Noise Ratio (SNR) of the receive packet history.
@@ -128,7 +149,7 @@ class AdrComponent : public NetworkControllerComponent
      * @param historyRange Number of packets to consider going back in time.
      * @return Min SNR among packets as double.
      */
-    double GetMinSNR(EndDeviceStatus::ReceivedPacketList packetList, int historyRange);
+    double GetMinSNR(const EndDeviceStatus::ReceivedPacketList& packetList, int historyRange);
     /**
      * Get the max Signal to Noise Ratio (SNR) of the receive packet history.
      *
@@ -136,7 +157,7 @@ class AdrComponent : public NetworkControllerComponent
      * @param historyRange Number of packets to consider going back in time.
      * @return Max SNR among packets as double.
      */
-    double GetMaxSNR(EndDeviceStatus::ReceivedPacketList packetList, int historyRange);
+    double GetMaxSNR(const EndDeviceStatus::ReceivedPacketList& packetList, int historyRange);
     /**
      * Get the average Signal to Noise Ratio (SNR) of the received packet history.
      *
@@ -144,7 +165,32 @@ class AdrComponent : public NetworkControllerComponent
      * @param historyRange Number of packets to consider going back in time.
      * @return Average SNR of packets as double.
      */
-    double GetAverageSNR(EndDeviceStatus::ReceivedPacketList packetList, int historyRange);
+    double GetAverageSNR(const EndDeviceStatus::ReceivedPacketList& packetList, int historyRange);
+
+    /**
+     * Rolling SNR aggregates over the last HistoryRange evaluated uplinks of
+     * a device, updated in O(1) per uplink. The running sum serves the
+     * average policy and two monotonic deques, indexed by sample number,
+     * serve the min and max policies without rescanning the window.
+     */
+    struct SnrHistory
+    {
+        uint64_t count = 0;                                //!< Samples pushed so far
+        double sum = 0;                                    //!< Sum of the SNRs in the window
+        std::deque<double> window;                         //!< SNRs in the window, oldest first
+        std::deque<std::pair<uint64_t, double>> minDeque;  //!< Increasing-SNR candidates
+        std::deque<std::pair<uint64_t, double>> maxDeque;  //!< Decreasing-SNR candidates
+        Ptr<const Packet> lastPacket;                      //!< Uplink of the newest sample
+    };
+
+    /**
+     * Append one uplink's SNR to a device's rolling window, evicting samples
+     * older than the history range.
+     *
+     * @param history The device's rolling aggregates.
+     * @param snr The SNR [dB] of the newly evaluated uplink.
+     */
+    void PushSnrSample(SnrHistory& history, double snr);
 
     /**
      * Get the LoRaWAN protocol TxPower parameter from the Equivalent Radiated Power (ERP) in dBm.
@@ -164,16 +210,33 @@ class AdrComponent : public NetworkControllerComponent
     // const int offset = 10;                //!< Device specific SNR margin (dB)
     const int B = 125000; //!< Bandwidth (Hz)
     const int NF = 6;     //!< Noise Figure (dB)
-    double threshold[6] = {
-        -20.0,
-        -17.5,
-        -15.0,
-        -12.5,
-        -10.0,
-        -7.5}; //!< Vector containing the required SNR for the 6 allowed spreading factor
-               //!< levels ranging from 7 to 12 (the SNR values are in dB).
-
     bool m_toggleTxPower; //!< Whether to control transmission power of end devices or not
+
+    /**
+     * Per-device rolling SNR aggregates, keyed by the raw device address and
+     * fed as reply opportunities come up, so ADR evaluations read their
+     * min/avg/max in constant time instead of rescanning the packet history.
+     */
+    std::unordered_map<uint32_t, SnrHistory> m_snrHistories;
+
+    /**
+     * Period of the batched ADR evaluation pass. Zero (the default) keeps
+     * the legacy behavior of evaluating each device inline in
+     * BeforeSendingReply; a positive value only marks devices dirty there
+     * and runs the ADR math for all of them in one periodic batch, so a
+     * selected LinkAdrReq piggybacks on the device's next reply opportunity
+     * instead of the current one.
+     */
+    Time m_epochDuration;
+
+    /**
+     * Devices with uplinks seen since the last batched pass, keyed by raw
+     * device address. A map rather than a list so a chatty device is only
+     * evaluated once per epoch.
+     */
+    std::unordered_map<uint32_t, Ptr<EndDeviceStatus>> m_dirtyDevices;
+
+    EventId m_epochEvent; //!< The pending batched evaluation event, if any.
 };
 } // namespace lorawan
 } // namespace ns3
@@ -0,0 +1,171 @@
+// model/adr-convergence-monitor.cc
+
+#include "adr-convergence-monitor.h"
+
+#include "end-device-lorawan-mac.h"
+
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("AdrConvergenceMonitor");
+NS_OBJECT_ENSURE_REGISTERED(AdrConvergenceMonitor);
+
+TypeId
+AdrConvergenceMonitor::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::lorawan::AdrConvergenceMonitor")
+            .SetGroupName("lorawan")
+            .SetParent<NetworkControllerComponent>()
+            .AddConstructor<AdrConvergenceMonitor>()
+            .AddAttribute("ConvergenceWindow",
+                          "Length of one change-rate evaluation window",
+                          TimeValue(Seconds(600)),
+                          MakeTimeAccessor(&AdrConvergenceMonitor::m_convergenceWindow),
+                          MakeTimeChecker())
+            .AddAttribute("MinObservationTime",
+                          "Never declare convergence before this simulation time",
+                          TimeValue(Seconds(1800)),
+                          MakeTimeAccessor(&AdrConvergenceMonitor::m_minObservationTime),
+                          MakeTimeChecker())
+            .AddAttribute("ChangeRateThreshold",
+                          "Parameter changes per device per window at or below which "
+                          "the network counts as converged",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&AdrConvergenceMonitor::m_changeRateThreshold),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("StopOnConvergence",
+                          "Stop the simulation when convergence is detected",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&AdrConvergenceMonitor::m_stopOnConvergence),
+                          MakeBooleanChecker())
+            .AddTraceSource("NetworkConverged",
+                            "Fired once per transition into convergence with the "
+                            "simulation time (s) and the deciding change rate",
+                            MakeTraceSourceAccessor(&AdrConvergenceMonitor::m_networkConvergedTrace),
+                            "ns3::TracedCallback::DoubleDouble")
+            .AddTraceSource("ChangeRate",
+                            "Fired after every evaluation window with the measured "
+                            "change rate (changes per device per window)",
+                            MakeTraceSourceAccessor(&AdrConvergenceMonitor::m_changeRateTrace),
+                            "ns3::TracedCallback::Double");
+    return tid;
+}
+
+AdrConvergenceMonitor::AdrConvergenceMonitor()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AdrConvergenceMonitor::~AdrConvergenceMonitor()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+AdrConvergenceMonitor::OnReceivedPacket(Ptr<const Packet> packet,
+                                        Ptr<EndDeviceStatus> status,
+                                        Ptr<NetworkStatus> networkStatus)
+{
+    NS_LOG_FUNCTION(this << packet << status->m_endDeviceAddress);
+
+    uint32_t deviceAddr = status->m_endDeviceAddress.Get();
+
+    // The parameters a LinkAdrReq changed show up on the device's next
+    // uplinks, so sampling them here sees every applied adjustment
+    uint8_t sf = status->GetFirstReceiveWindowSpreadingFactor();
+    double txPower = 0;
+    Ptr<EndDeviceLorawanMac> mac = DynamicCast<EndDeviceLorawanMac>(status->GetMac());
+    if (mac)
+    {
+        txPower = mac->GetTransmissionPowerDbm();
+    }
+
+    auto& observed = m_observedParams[deviceAddr];
+    if (observed.valid && (observed.spreadingFactor != sf || observed.txPowerDbm != txPower))
+    {
+        m_windowChanges++;
+        NS_LOG_DEBUG("Device " << deviceAddr << " changed parameters: SF "
+                               << unsigned(observed.spreadingFactor) << " -> " << unsigned(sf)
+                               << ", TP " << observed.txPowerDbm << " -> " << txPower << " dBm");
+    }
+    observed.spreadingFactor = sf;
+    observed.txPowerDbm = txPower;
+    observed.valid = true;
+
+    if (!m_checkScheduled)
+    {
+        m_checkScheduled = true;
+        Simulator::Schedule(m_convergenceWindow, &AdrConvergenceMonitor::EvaluateWindow, this);
+    }
+}
+
+void
+AdrConvergenceMonitor::BeforeSendingReply(Ptr<EndDeviceStatus> status,
+                                          Ptr<NetworkStatus> networkStatus)
+{
+    // Observation only; replies are not modified
+}
+
+void
+AdrConvergenceMonitor::OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus)
+{
+    // Observation only
+}
+
+bool
+AdrConvergenceMonitor::IsConverged() const
+{
+    return m_converged;
+}
+
+double
+AdrConvergenceMonitor::GetLastChangeRate() const
+{
+    return m_lastChangeRate;
+}
+
+void
+AdrConvergenceMonitor::EvaluateWindow()
+{
+    size_t devices = m_observedParams.size();
+    m_lastChangeRate = (devices > 0) ? static_cast<double>(m_windowChanges) / devices : 0.0;
+    m_windowChanges = 0;
+    m_changeRateTrace(m_lastChangeRate);
+
+    NS_LOG_DEBUG("Window change rate: " << m_lastChangeRate << " changes/device over " << devices
+                                        << " devices");
+
+    if (m_lastChangeRate <= m_changeRateThreshold && Simulator::Now() >= m_minObservationTime)
+    {
+        if (!m_converged)
+        {
+            m_converged = true;
+            NS_LOG_INFO("ADR converged at " << Simulator::Now().As(Time::S) << " (rate "
+                                            << m_lastChangeRate << ")");
+            m_networkConvergedTrace(Simulator::Now().GetSeconds(), m_lastChangeRate);
+            if (m_stopOnConvergence)
+            {
+                Simulator::Stop();
+                return;
+            }
+        }
+    }
+    else
+    {
+        // A converged verdict is revoked if the network starts moving again
+        m_converged = false;
+    }
+
+    Simulator::Schedule(m_convergenceWindow, &AdrConvergenceMonitor::EvaluateWindow, this);
+}
+
+} // namespace lorawan
+} // namespace ns3
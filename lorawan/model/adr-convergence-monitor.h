@@ -0,0 +1,110 @@
+// model/adr-convergence-monitor.h
+
+#ifndef ADR_CONVERGENCE_MONITOR_H
+#define ADR_CONVERGENCE_MONITOR_H
+
+#include "network-controller-components.h"
+#include "network-status.h"
+
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+
+#include <map>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Network controller component that detects ADR convergence.
+ *
+ * Many campaigns only run until ADR settles and then waste wall-time
+ * simulating a converged network. This component watches the transmission
+ * parameters (spreading factor and transmission power) observed on each
+ * device's uplinks and counts parameter changes per evaluation window. When
+ * the change rate across devices falls to the configured threshold it fires
+ * the NetworkConverged trace — so a driver can switch off expensive
+ * instrumentation — and, if StopOnConvergence is set, stops the simulation.
+ *
+ * The per-window change rate is also exported through the ChangeRate trace
+ * for calibration runs.
+ */
+class AdrConvergenceMonitor : public NetworkControllerComponent
+{
+  public:
+    /**
+     * Register this type.
+     * @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    AdrConvergenceMonitor();           //!< Default constructor
+    ~AdrConvergenceMonitor() override; //!< Destructor
+
+    void OnReceivedPacket(Ptr<const Packet> packet,
+                          Ptr<EndDeviceStatus> status,
+                          Ptr<NetworkStatus> networkStatus) override;
+    void BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
+    void OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
+
+    /**
+     * Whether the network is currently considered converged.
+     *
+     * @return True after a window evaluation found the change rate at or
+     * below the threshold, until a later window exceeds it again.
+     */
+    bool IsConverged() const;
+
+    /**
+     * The change rate measured in the last completed evaluation window.
+     *
+     * @return Parameter changes per tracked device in that window.
+     */
+    double GetLastChangeRate() const;
+
+  private:
+    /**
+     * Last transmission parameters observed for one device.
+     */
+    struct ObservedParams
+    {
+        uint8_t spreadingFactor = 0; //!< Spreading factor of the last uplink
+        double txPowerDbm = 0;       //!< Transmission power of the last uplink
+        bool valid = false;          //!< Whether an uplink has been observed
+    };
+
+    /**
+     * Evaluate the change rate of the window that just ended, fire traces,
+     * optionally stop the simulation and schedule the next evaluation.
+     */
+    void EvaluateWindow();
+
+    std::map<uint32_t, ObservedParams> m_observedParams; //!< Per-device last seen parameters
+    uint32_t m_windowChanges = 0;  //!< Parameter changes counted in the current window
+    double m_lastChangeRate = 0;   //!< Change rate of the last completed window
+    bool m_converged = false;      //!< Current convergence verdict
+    bool m_checkScheduled = false; //!< Whether the periodic evaluation is running
+
+    Time m_convergenceWindow;     //!< Length of one evaluation window
+    Time m_minObservationTime;    //!< Never declare convergence before this time
+    double m_changeRateThreshold; //!< Changes per device per window considered settled
+    bool m_stopOnConvergence;     //!< Whether to stop the simulation on convergence
+
+    /**
+     * Fired once per transition into convergence. Arguments: simulation time
+     * in seconds and the change rate of the deciding window.
+     */
+    TracedCallback<double, double> m_networkConvergedTrace;
+    /**
+     * Fired after every evaluation window with the measured change rate.
+     */
+    TracedCallback<double> m_changeRateTrace;
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif // ADR_CONVERGENCE_MONITOR_H
@@ -9,10 +9,12 @@
  */
 
 #include "adropt-component.h"
+#include "lora-radio-tables.h"
 #include "ns3/lorawan-mac-header.h"
 #include "ns3/lora-frame-header.h"
 #include "ns3/class-a-end-device-lorawan-mac.h"
 #include "ns3/end-device-lorawan-mac.h"
+#include "ns3/memory-report.h"
 #include <cmath>
 #include <algorithm>
 #include <numeric>
@@ -32,6 +34,8 @@ const double ADRoptComponent::BANDWIDTH_HZ = 125000.0;
 const uint8_t ADRoptComponent::MIN_TX_POWER = 2;
 const uint8_t ADRoptComponent::MAX_TX_POWER = 14;
 const uint8_t ADRoptComponent::PREAMBLE_LENGTH = 8;
+const size_t ADRoptComponent::MAX_PER_CACHE_ENTRIES = 4096;
+const uint32_t ADRoptComponent::MIN_FER_SAMPLES = 10;
 
 TypeId
 ADRoptComponent::GetTypeId()
@@ -76,7 +80,8 @@ ADRoptComponent::ADRoptComponent()
     : m_perTarget(0.3),
       m_historyRange(20),
       m_enablePowerControl(true),
-      m_payloadSize(20)
+      m_payloadSize(20),
+      m_fecAware(false)
 {
     NS_LOG_FUNCTION(this);
     NS_LOG_INFO("ADRopt Component initialized (optimization only)");
@@ -120,15 +125,31 @@ ADRoptComponent::OnReceivedPacket(Ptr<const Packet> packet,
     deviceStats.totalPackets++;
 
     // Get the latest received packet info for ADR processing
-    auto receivedPacketList = status->GetReceivedPacketList();
+    const auto& receivedPacketList = status->GetReceivedPacketList();
     if (!receivedPacketList.empty())
     {
         const auto& latestPacket = receivedPacketList.back().second;
         deviceStats.packetHistory.push_back(latestPacket);
+        for (const auto& gwPair : latestPacket.gwList)
+        {
+            auto& [sum, count] = deviceStats.gatewaySnrSums[gwPair.first];
+            sum += RxPowerToSNR(gwPair.second.rxPower);
+            count++;
+        }
 
-        // Keep history within range
+        // Keep history within range, retiring the evicted packet's
+        // contribution to the per-gateway sums
         if (deviceStats.packetHistory.size() > m_historyRange)
         {
+            for (const auto& gwPair : deviceStats.packetHistory.front().gwList)
+            {
+                auto it = deviceStats.gatewaySnrSums.find(gwPair.first);
+                it->second.first -= RxPowerToSNR(gwPair.second.rxPower);
+                if (--it->second.second == 0)
+                {
+                    deviceStats.gatewaySnrSums.erase(it);
+                }
+            }
             deviceStats.packetHistory.pop_front();
         }
     }
@@ -237,16 +258,16 @@ ADRoptComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status,
             UpdateTransmissionStats(deviceAddr, newNbTrans, oldNbTrans);
         }
 
-        // Create LinkAdrReq command
-        std::list<int> enabledChannels = {0, 1, 2}; // Standard channels
-        
-        status->m_reply.frameHeader.AddLinkAdrReq(newDataRate,
-                                                  GetTxPowerIndex(newTxPower),
-                                                  enabledChannels,
-                                                  newNbTrans);
+        // Queue the LinkAdrReq: EndDeviceStatus coalesces everything
+        // pending into one FOpts block when the downlink goes out
+        const uint16_t channelMask = 0b111; // Standard channels 0-2
+        status->AddMACCommand(Create<LinkAdrReq>(newDataRate,
+                                                 GetTxPowerIndex(newTxPower),
+                                                 channelMask,
+                                                 0,
+                                                 newNbTrans));
         status->m_reply.frameHeader.SetAsDownlink();
         status->m_reply.macHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
-        status->m_reply.needsReply = true;
 
         // Update internal tracking
         m_deviceNbTrans[deviceAddr] = newNbTrans;
@@ -264,6 +285,7 @@ ADRoptComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status,
 
         // Clear history to start fresh cycle
         deviceStats.packetHistory.clear();
+        deviceStats.gatewaySnrSums.clear();
         
     }
     else
@@ -366,38 +388,105 @@ ADRoptComponent::RunADRoptAlgorithm(uint8_t* newDataRate,
     double bestToA = CalculateToA(currentDR, currentNbTrans);
     bool foundBetter = false;
 
-    // Search for optimal configuration
-    // Try different data rates (DR0-DR5, i.e., SF12-SF7)
-    for (uint8_t dr = 0; dr <= 5; ++dr)
+    // Hoist the per-gateway mean SNRs out of the configuration loop: they
+    // only depend on the packet history, not on the candidate parameters
+    std::vector<double> gwMeanSnrs = ComputeGatewayMeanSnrs(deviceAddr);
+    uint64_t snrKey = QuantizeSnrKey(gwMeanSnrs, currentTxPower);
+    auto& perCache = m_perCache[deviceAddr];
+    if (perCache.size() > MAX_PER_CACHE_ENTRIES)
     {
-        // Try different power levels
-        double startPower = m_enablePowerControl ? MIN_TX_POWER : currentTxPower;
-        double endPower = m_enablePowerControl ? MAX_TX_POWER : currentTxPower;
-        
-        for (double power = startPower; power <= endPower; power += 2.0)
+        perCache.clear();
+    }
+
+    // Branch-and-bound search for the shortest-ToA configuration meeting
+    // the PER target. ToA does not depend on the power, shrinks as the data
+    // rate rises and grows with NbTrans, so candidates are visited in
+    // ascending-ToA order and whole branches are pruned as soon as their
+    // ToA lower bound reaches the best found: data rates from DR5 down,
+    // NbTrans upwards within a data rate, and powers upwards within a
+    // (DR, NbTrans) pair, stopping at the first (lowest) acceptable power
+    // since PER only improves and ToA stays the same at higher powers
+    // Effective PER target: once FEC-aware mode has decoder measurements
+    // for this device, size the raw-link allowance from the recovery ratio
+    // the decoder actually achieves instead of the fixed 0.30
+    const EndDeviceStatus::LinkQualityCache& linkQuality = status->m_linkQuality;
+    double perTarget = m_perTarget;
+    if (m_fecAware && linkQuality.fecLost + linkQuality.fecRecovered > 0)
+    {
+        double recovery = std::min(linkQuality.FecRecoveryRatio(), 0.9);
+        perTarget = std::min(0.5, 0.10 / (1.0 - recovery));
+        NS_LOG_DEBUG("ADRopt: FEC-measured recovery ratio " << recovery
+                     << ", effective PER target " << perTarget);
+    }
+
+    double startPower = m_enablePowerControl ? MIN_TX_POWER : currentTxPower;
+    double endPower = m_enablePowerControl ? MAX_TX_POWER : currentTxPower;
+
+    for (int dr = 5; dr >= 0; --dr)
+    {
+        if (CalculateToA(dr, 1) >= bestToA)
         {
-            // Try different NbTrans values
-            for (uint8_t nbt = 1; nbt <= 3; ++nbt)
+            // Every remaining data rate only offers longer candidates
+            break;
+        }
+
+        for (uint8_t nbt = 1; nbt <= 3; ++nbt)
+        {
+            double toa = CalculateToA(dr, nbt);
+            if (toa >= bestToA)
             {
-                double predictedPER = PredictPER(dr, power, nbt, status);
-                double toa = CalculateToA(dr, nbt);
-                
-                NS_LOG_DEBUG("ADRopt: Testing DR" << static_cast<uint32_t>(dr) 
-                            << ", Power:" << power 
-                            << ", NbTrans:" << static_cast<uint32_t>(nbt) 
-                            << " -> PER:" << predictedPER 
+                break; // ToA grows with NbTrans
+            }
+
+            for (double power = startPower; power <= endPower; power += 2.0)
+            {
+                double predictedPER;
+                const auto& drStats = linkQuality.perDataRate[dr];
+                if (power == currentTxPower &&
+                    drStats.delivered + drStats.lost >= MIN_FER_SAMPLES)
+                {
+                    // At the current power the decoder has already measured
+                    // this data rate's FER; one pow replaces the per-gateway
+                    // analytic model
+                    double fer =
+                        double(drStats.lost) / (drStats.delivered + drStats.lost);
+                    predictedPER = std::pow(fer, nbt);
+                }
+                else
+                {
+                    // Reuse the prediction memoized from an earlier round
+                    // with the same quantized SNR state, if there was one
+                    uint64_t packedConfig = dr | (uint64_t(GetTxPowerIndex(power)) << 3) |
+                                            (uint64_t(nbt) << 7);
+                    uint64_t configKey = snrKey ^ (packedConfig * 0x9E3779B97F4A7C15ULL);
+                    auto cacheIt = perCache.find(configKey);
+                    if (cacheIt != perCache.end())
+                    {
+                        predictedPER = cacheIt->second;
+                    }
+                    else
+                    {
+                        predictedPER = PredictPER(dr, power, nbt, currentTxPower, gwMeanSnrs);
+                        perCache.emplace(configKey, predictedPER);
+                    }
+                }
+
+                NS_LOG_DEBUG("ADRopt: Testing DR" << dr
+                            << ", Power:" << power
+                            << ", NbTrans:" << static_cast<uint32_t>(nbt)
+                            << " -> PER:" << predictedPER
                             << ", ToA:" << toa);
 
-                // Check if this configuration meets PER target and improves ToA
-                if (predictedPER <= m_perTarget && toa < bestToA)
+                if (predictedPER <= perTarget)
                 {
                     *newDataRate = dr;
                     *newTxPowerDbm = power;
                     *newNbTrans = nbt;
                     bestToA = toa;
                     foundBetter = true;
-                    
+
                     NS_LOG_DEBUG("ADRopt: New best config found");
+                    break;
                 }
             }
         }
@@ -439,53 +528,33 @@ ADRoptComponent::EstimateCurrentPER(Ptr<EndDeviceStatus> status)
 }
 
 double
-ADRoptComponent::PredictPER(uint8_t dataRate, double txPower, uint8_t nbTrans, 
-                           Ptr<EndDeviceStatus> status)
+ADRoptComponent::PredictPER(uint8_t dataRate, double txPower, uint8_t nbTrans,
+                           double currentTxPowerDbm, const std::vector<double>& gwMeanSnrs)
 {
     NS_LOG_FUNCTION(this);
-    
-    if (!status)
-    {
-        NS_LOG_ERROR("ADRopt: Null status in PredictPER");
-        return 1.0;
-    }
-    
-    std::set<Address> gateways = GetActiveGateways(status);
-    if (gateways.empty())
+
+    if (gwMeanSnrs.empty())
     {
         NS_LOG_DEBUG("ADRopt: No active gateways for PER prediction");
         return 1.0; // No gateways available
     }
 
     double combinedPER = 1.0;
-    
-    // Get current TX power from EndDeviceMac
-    Ptr<EndDeviceLorawanMac> endDeviceMac = DynamicCast<EndDeviceLorawanMac>(status->GetMac());
-    if (!endDeviceMac)
-    {
-        NS_LOG_ERROR("ADRopt: No EndDeviceLorawanMac available in PredictPER");
-        return 1.0;
-    }
-    
-    double currentTxPower = endDeviceMac->GetTransmissionPowerDbm();
-    
+
+    // Adjust SNR based on power difference from current
+    double snrAdjustment = txPower - currentTxPowerDbm;
+
     // For each gateway, calculate the individual PER
-    for (const Address& gwAddr : gateways)
+    for (double meanSNR : gwMeanSnrs)
     {
-        double meanSNR = GetMeanSNRForGateway(gwAddr, status);
-        
-        // Adjust SNR based on power difference from current
-        double snrAdjustment = txPower - currentTxPower;
-        double adjustedSNR = meanSNR + snrAdjustment;
-        
         // Calculate FER for this gateway and data rate
-        double fer = CalculateFER(dataRate, adjustedSNR);
-        
+        double fer = CalculateFER(dataRate, meanSNR + snrAdjustment);
+
         // Apply NbTrans (multiple transmission attempts)
         double perThisGW = std::pow(fer, nbTrans);
         combinedPER *= perThisGW;
     }
-    
+
     return std::min(combinedPER, 1.0);
 }
 
@@ -536,9 +605,8 @@ ADRoptComponent::CalculateFER(uint8_t dataRate, double snr)
 double
 ADRoptComponent::GetSNRThreshold(uint8_t dataRate)
 {
-    // LoRaWAN SNR thresholds for different data rates
-    uint8_t sf = DrToSf(dataRate);
-    return -20.0 + (12 - sf) * 2.5; // Standard LoRa SNR thresholds
+    // Shared module-wide table; DrToSf clamps out-of-range data rates
+    return SnrThresholdForSf(DrToSf(dataRate));
 }
 
 uint8_t
@@ -564,62 +632,72 @@ ADRoptComponent::GetTxPowerIndex(double txPowerDbm)
     return static_cast<uint8_t>((MAX_TX_POWER - txPowerDbm) / 2);
 }
 
-std::set<Address>
-ADRoptComponent::GetActiveGateways(Ptr<EndDeviceStatus> status)
+std::vector<double>
+ADRoptComponent::ComputeGatewayMeanSnrs(uint32_t deviceAddr)
 {
     NS_LOG_FUNCTION(this);
-    
-    std::set<Address> gateways;
-    uint32_t deviceAddr = status->m_endDeviceAddress.Get();
-    auto& deviceStats = m_deviceStats[deviceAddr];
-    
-    for (const auto& pktInfo : deviceStats.packetHistory)
+
+    // The per-gateway sums are maintained incrementally as packets enter and
+    // leave the bounded history, so each mean is a single division here
+    const auto& snrSums = m_deviceStats[deviceAddr].gatewaySnrSums;
+
+    std::vector<double> means;
+    means.reserve(snrSums.size());
+    for (const auto& [gwAddr, sumCount] : snrSums)
     {
-        for (const auto& gwPair : pktInfo.gwList)
-        {
-            gateways.insert(gwPair.first);
-        }
+        means.push_back(sumCount.first / sumCount.second);
     }
-    
-    return gateways;
+    return means;
 }
 
-double
-ADRoptComponent::GetMeanSNRForGateway(const Address& gwAddr, Ptr<EndDeviceStatus> status)
+uint64_t
+ADRoptComponent::QuantizeSnrKey(const std::vector<double>& gwMeanSnrs, double currentTxPowerDbm)
 {
-    NS_LOG_FUNCTION(this);
-    
-    uint32_t deviceAddr = status->m_endDeviceAddress.Get();
-    auto& deviceStats = m_deviceStats[deviceAddr];
-    
-    std::vector<double> snrValues;
-    
-    for (const auto& pktInfo : deviceStats.packetHistory)
+    // FNV-1a over the SNRs quantized to 0.25 dB; the current transmission
+    // power enters the key because predictions are relative to it
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](int64_t quantized) {
+        hash = (hash ^ static_cast<uint64_t>(quantized)) * 1099511628211ULL;
+    };
+    for (double snr : gwMeanSnrs)
     {
-        auto gwIt = pktInfo.gwList.find(gwAddr);
-        if (gwIt != pktInfo.gwList.end())
-        {
-            double snr = RxPowerToSNR(gwIt->second.rxPower);
-            snrValues.push_back(snr);
-        }
+        mix(std::lround(snr * 4.0));
     }
-    
-    if (snrValues.empty())
-    {
-        return -30.0; // Default low SNR
-    }
-    
-    double sum = std::accumulate(snrValues.begin(), snrValues.end(), 0.0);
-    return sum / snrValues.size();
+    mix(std::lround(currentTxPowerDbm * 4.0));
+    return hash;
 }
 
 void
 ADRoptComponent::SetFecAware(bool fecAware)
 {
+    m_fecAware = fecAware;
     m_perTarget = fecAware ? 0.30 : 0.10;
-    NS_LOG_INFO("ADRopt PER target set to " << m_perTarget 
+    NS_LOG_INFO("ADRopt PER target set to " << m_perTarget
                 << (fecAware ? " (FEC-aware)" : " (standard)"));
 }
 
+uint64_t
+ADRoptComponent::MemoryReport() const
+{
+    uint64_t bytes = EstimateMemory(m_deviceStats) + EstimateMemory(m_deviceNbTrans) +
+                     EstimateMemory(m_perCache);
+
+    for (const auto& pair : m_deviceStats)
+    {
+        const DeviceStats& stats = pair.second;
+        bytes += EstimateMemory(stats.packetHistory) + EstimateMemory(stats.gatewaySnrSums);
+        for (const auto& info : stats.packetHistory)
+        {
+            bytes += EstimateMemory(info.gwList);
+        }
+    }
+    for (const auto& pair : m_perCache)
+    {
+        bytes += EstimateMemory(pair.second);
+    }
+
+    return bytes;
+}
+
 } // namespace lorawan
 } // namespace ns3
\ No newline at end of file
@@ -25,6 +25,8 @@
 #include <set>
 #include <map>
 #include <list>
+#include <deque>
+#include <unordered_map>
 
 namespace ns3
 {
@@ -46,7 +48,11 @@ public:
 
     struct DeviceStats
     {
-        std::list<EndDeviceStatus::ReceivedPacketInfo> packetHistory;
+        // Bounded at HistoryRange entries; per-gateway SNR sums over the same
+        // window are maintained incrementally so mean SNRs come out as one
+        // division per gateway instead of a rescan of the whole history
+        std::deque<EndDeviceStatus::ReceivedPacketInfo> packetHistory;
+        std::map<Address, std::pair<double, uint32_t>> gatewaySnrSums;
         uint32_t totalPackets;
         uint8_t currentNbTrans;
         uint32_t adrAdjustmentCount;
@@ -81,13 +87,17 @@ public:
     uint8_t GetCurrentNbTrans(uint32_t deviceAddr) const;
     uint32_t GetAdrAdjustmentCount(uint32_t deviceAddr) const;
 
+    // Estimated heap bytes held by the device histories and the PER cache
+    uint64_t MemoryReport() const;
+
 private:
     bool RunADRoptAlgorithm(uint8_t* newDataRate,
                            double* newTxPowerDbm,
                            uint8_t* newNbTrans,
                            Ptr<EndDeviceStatus> status);
     double EstimateCurrentPER(Ptr<EndDeviceStatus> status);
-    double PredictPER(uint8_t dataRate, double txPower, uint8_t nbTrans, Ptr<EndDeviceStatus> status);
+    double PredictPER(uint8_t dataRate, double txPower, uint8_t nbTrans,
+                      double currentTxPowerDbm, const std::vector<double>& gwMeanSnrs);
     double CalculateToA(uint8_t dataRate, uint8_t nbTrans);
     double RxPowerToSNR(double rxPowerDbm);
     double CalculateFER(uint8_t dataRate, double snr);
@@ -95,8 +105,12 @@ private:
     uint8_t SfToDr(uint8_t sf);
     uint8_t DrToSf(uint8_t dr);
     uint8_t GetTxPowerIndex(double txPowerDbm);
-    std::set<Address> GetActiveGateways(Ptr<EndDeviceStatus> status);
-    double GetMeanSNRForGateway(const Address& gwAddr, Ptr<EndDeviceStatus> status);
+    // Compute every active gateway's mean SNR in one pass over the history,
+    // so the configuration search does not rescan per gateway per candidate
+    std::vector<double> ComputeGatewayMeanSnrs(uint32_t deviceAddr);
+    // Hash the per-gateway mean SNRs quantized to 0.25 dB; rounds with nearly
+    // unchanged link quality map to the same PER cache entries
+    uint64_t QuantizeSnrKey(const std::vector<double>& gwMeanSnrs, double currentTxPowerDbm);
     void UpdateTransmissionStats(uint32_t deviceAddr, uint8_t newNbTrans, uint8_t oldNbTrans);
 
     // Configuration parameters
@@ -104,10 +118,18 @@ private:
     uint32_t m_historyRange;
     bool m_enablePowerControl;
     uint8_t m_payloadSize;
-
-    // Device state tracking (for optimization only)
-    std::map<uint32_t, DeviceStats> m_deviceStats;
-    std::map<uint32_t, uint8_t> m_deviceNbTrans;
+    // FEC-aware mode: read the decoder's measurements from the device's
+    // shared link-quality cache instead of fixed allowances
+    bool m_fecAware;
+
+    // Device state tracking (for optimization only); hashed maps since these
+    // are hit on every uplink and never iterated in address order
+    std::unordered_map<uint32_t, DeviceStats> m_deviceStats;
+    std::unordered_map<uint32_t, uint8_t> m_deviceNbTrans;
+
+    // Memoized PredictPER results per device, keyed on the candidate config
+    // combined with the quantized SNR state the prediction was made under
+    std::unordered_map<uint32_t, std::unordered_map<uint64_t, double>> m_perCache;
     // Trace sources for optimization events
     
     // *** NEW: Trace source for ADR calculation start ***
@@ -121,6 +143,10 @@ private:
     static const uint8_t MIN_TX_POWER;
     static const uint8_t MAX_TX_POWER;
     static const uint8_t PREAMBLE_LENGTH;
+    static const size_t MAX_PER_CACHE_ENTRIES;
+    // Samples needed before a measured per-data-rate FER replaces the
+    // analytic PER prediction
+    static const uint32_t MIN_FER_SAMPLES;
 };
 
 } // namespace lorawan
@@ -0,0 +1,206 @@
+// model/async-trace-sink.cc
+
+#include "async-trace-sink.h"
+
+#include "ns3/log.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncTraceSink");
+
+namespace
+{
+
+bool
+HasZstSuffix(const std::string& filename)
+{
+    static const std::string suffix = ".zst";
+    return filename.size() > suffix.size() &&
+           filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+AsyncTraceSink::~AsyncTraceSink()
+{
+    Stop();
+}
+
+void
+AsyncTraceSink::Start(const std::string& filename, bool binary)
+{
+    Stop();
+
+    m_filename = filename;
+    std::ios::openmode mode = std::ios::trunc;
+    if (binary || HasZstSuffix(filename))
+    {
+        mode |= std::ios::binary;
+    }
+    m_file.open(m_filename, mode);
+    if (!m_file.is_open())
+    {
+        NS_LOG_ERROR("Could not open trace file: " << m_filename);
+        return;
+    }
+
+    if (HasZstSuffix(filename))
+    {
+#ifdef LORAWAN_HAVE_ZSTD
+        m_zstd = ZSTD_createCStream();
+        ZSTD_initCStream(m_zstd, ZSTD_CLEVEL_DEFAULT);
+        m_zstdBuffer.resize(ZSTD_CStreamOutSize());
+#else
+        NS_LOG_WARN(m_filename << " requests zstd compression but the module was built "
+                               << "without libzstd; writing uncompressed data");
+#endif
+    }
+
+    m_stopping = false;
+    m_pending.clear();
+    m_pendingBytes = 0;
+    m_droppedChunks = 0;
+    m_thread = std::thread(&AsyncTraceSink::Run, this);
+}
+
+void
+AsyncTraceSink::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    if (m_file.is_open())
+    {
+        FinishCompression();
+        m_file.close();
+    }
+}
+
+void
+AsyncTraceSink::Submit(std::string&& chunk)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_thread.joinable() || m_stopping)
+    {
+        return;
+    }
+    if (m_pendingBytes + chunk.size() > MAX_PENDING_BYTES)
+    {
+        if (!m_blockWhenFull)
+        {
+            // Backpressure: the disk cannot keep up; dropping is preferable
+            // to stalling the event loop, and the drop count makes it visible
+            m_droppedChunks++;
+            return;
+        }
+        // This sink's output must be complete, so wait for the writer to
+        // drain instead. The pause is bounded by the disk, not the queue
+        m_condition.wait(lock, [this, &chunk] {
+            return m_stopping || m_pendingBytes + chunk.size() <= MAX_PENDING_BYTES;
+        });
+        if (m_stopping)
+        {
+            return;
+        }
+    }
+    m_pendingBytes += chunk.size();
+    m_pending.push_back(std::move(chunk));
+    m_condition.notify_all();
+}
+
+void
+AsyncTraceSink::SetBlockWhenFull(bool block)
+{
+    m_blockWhenFull = block;
+}
+
+uint64_t
+AsyncTraceSink::GetDroppedChunks() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_droppedChunks;
+}
+
+bool
+AsyncTraceSink::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+void
+AsyncTraceSink::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_condition.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+        if (m_pending.empty())
+        {
+            break; // Stopping and nothing left to flush
+        }
+
+        // Swap the filled buffer out and write without holding the lock
+        std::vector<std::string> chunks;
+        chunks.swap(m_pending);
+        m_pendingBytes = 0;
+        m_condition.notify_all(); // Wake blocked submitters
+        lock.unlock();
+        for (const auto& chunk : chunks)
+        {
+            WriteChunk(chunk);
+        }
+        m_file.flush();
+        lock.lock();
+    }
+}
+
+void
+AsyncTraceSink::WriteChunk(const std::string& chunk)
+{
+#ifdef LORAWAN_HAVE_ZSTD
+    if (m_zstd)
+    {
+        ZSTD_inBuffer input = {chunk.data(), chunk.size(), 0};
+        while (input.pos < input.size)
+        {
+            ZSTD_outBuffer output = {m_zstdBuffer.data(), m_zstdBuffer.size(), 0};
+            ZSTD_compressStream(m_zstd, &output, &input);
+            m_file.write(m_zstdBuffer.data(), output.pos);
+        }
+        return;
+    }
+#endif
+    m_file << chunk;
+}
+
+void
+AsyncTraceSink::FinishCompression()
+{
+#ifdef LORAWAN_HAVE_ZSTD
+    if (!m_zstd)
+    {
+        return;
+    }
+    size_t remaining;
+    do
+    {
+        ZSTD_outBuffer output = {m_zstdBuffer.data(), m_zstdBuffer.size(), 0};
+        remaining = ZSTD_endStream(m_zstd, &output);
+        m_file.write(m_zstdBuffer.data(), output.pos);
+    } while (remaining > 0);
+    ZSTD_freeCStream(m_zstd);
+    m_zstd = nullptr;
+#endif
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,129 @@
+// model/async-trace-sink.h
+
+#ifndef ASYNC_TRACE_SINK_H
+#define ASYNC_TRACE_SINK_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef LORAWAN_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Double-buffered background file sink shared by the module's trace and
+ * export helpers.
+ *
+ * Packet-level tracing on large runs produces output volumes where
+ * synchronous ofstream writes measurably slow the simulation. With this
+ * sink the simulation thread only formats chunks and hands them over with
+ * Submit(); a worker thread swaps the pending buffer out and does the file
+ * I/O, so flushes never stall the event loop.
+ *
+ * Pending bytes are capped. What happens at the cap is chosen per sink:
+ * by default a chunk that would exceed it is dropped and counted, which is
+ * the right trade for periodic statistics exports where a missing snapshot
+ * row is harmless. Sinks whose output must be complete — e.g. the uplink
+ * capture trace, which is replayed later — call SetBlockWhenFull(true) and
+ * Submit() instead waits for the writer to drain.
+ *
+ * When the module is built with libzstd available, a sink whose file name
+ * ends in ".zst" stream-compresses in the worker thread. Without libzstd
+ * such a name produces a warning and uncompressed output.
+ */
+class AsyncTraceSink
+{
+  public:
+    ~AsyncTraceSink();
+
+    /**
+     * Open the output file, truncating any existing content, and start the
+     * writer thread.
+     *
+     * @param filename The output file name; a ".zst" suffix requests
+     * streaming compression when available.
+     * @param binary Whether to open the file in binary mode.
+     */
+    void Start(const std::string& filename, bool binary = false);
+
+    /**
+     * Flush everything still buffered, join the writer thread and close the
+     * file.
+     */
+    void Stop();
+
+    /**
+     * Hand one formatted chunk to the writer thread.
+     *
+     * @param chunk The bytes to append to the file.
+     */
+    void Submit(std::string&& chunk);
+
+    /**
+     * Choose the behavior when the pending-bytes cap is reached.
+     *
+     * @param block True to make Submit wait for the writer to drain instead
+     * of dropping the chunk. Takes effect on the next Start.
+     */
+    void SetBlockWhenFull(bool block);
+
+    /**
+     * Get the number of chunks dropped under backpressure.
+     *
+     * @return The drop count since the last Start.
+     */
+    uint64_t GetDroppedChunks() const;
+
+    /**
+     * Whether the sink is accepting chunks.
+     *
+     * @return True if the output file is open.
+     */
+    bool IsOpen() const;
+
+  private:
+    /// Writer thread body: swap the pending buffer out and write unlocked.
+    void Run();
+
+    /// Write one chunk, compressing it first when compression is active.
+    void WriteChunk(const std::string& chunk);
+
+    /// Flush the compression stream's final frame, if any.
+    void FinishCompression();
+
+    std::string m_filename;              //!< The output file name
+    std::ofstream m_file;                //!< The output file
+    std::thread m_thread;                //!< The writer thread
+    mutable std::mutex m_mutex;          //!< Guards the pending buffer
+    std::condition_variable m_condition; //!< Signals pending work or drained buffer
+    std::vector<std::string> m_pending;  //!< Chunks awaiting the writer thread
+    size_t m_pendingBytes = 0;           //!< Bytes in m_pending
+    uint64_t m_droppedChunks = 0;        //!< Chunks dropped under backpressure
+    bool m_stopping = false;             //!< Whether Stop was requested
+    bool m_blockWhenFull = false;        //!< Whether Submit blocks at the cap
+
+#ifdef LORAWAN_HAVE_ZSTD
+    ZSTD_CStream* m_zstd = nullptr;  //!< Compression stream, when active
+    std::vector<char> m_zstdBuffer;  //!< Reused compression output buffer
+#endif
+
+    /// Cap on bytes buffered ahead of the writer thread.
+    static const size_t MAX_PENDING_BYTES = 64 * 1024 * 1024;
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif /* ASYNC_TRACE_SINK_H */
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#include "background-interference-injector.h"
+
+#include "lora-packet-pool.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("BackgroundInterferenceInjector");
+
+NS_OBJECT_ENSURE_REGISTERED(BackgroundInterferenceInjector);
+
+TypeId
+BackgroundInterferenceInjector::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::BackgroundInterferenceInjector")
+            .SetParent<Object>()
+            .SetGroupName("lorawan")
+            .AddConstructor<BackgroundInterferenceInjector>()
+            .AddAttribute("PacketSize",
+                          "PHY payload size assumed for the injected events, in bytes. "
+                          "Determines their on-air duration per spreading factor.",
+                          UintegerValue(20),
+                          MakeUintegerAccessor(&BackgroundInterferenceInjector::m_packetSize),
+                          MakeUintegerChecker<uint8_t>());
+    return tid;
+}
+
+BackgroundInterferenceInjector::BackgroundInterferenceInjector()
+    : m_packetSize(20),
+      m_running(false)
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<UniformRandomVariable> rxPowerDbmRv = CreateObject<UniformRandomVariable>();
+    rxPowerDbmRv->SetAttribute("Min", DoubleValue(-120));
+    rxPowerDbmRv->SetAttribute("Max", DoubleValue(-80));
+    m_rxPowerDbmRv = rxPowerDbmRv;
+}
+
+BackgroundInterferenceInjector::~BackgroundInterferenceInjector()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+BackgroundInterferenceInjector::SetPhy(Ptr<LoraPhy> phy)
+{
+    NS_LOG_FUNCTION(this << phy);
+
+    m_phy = phy;
+}
+
+void
+BackgroundInterferenceInjector::SetRxPowerVariable(Ptr<RandomVariableStream> rxPowerDbmRv)
+{
+    NS_LOG_FUNCTION(this << rxPowerDbmRv);
+
+    m_rxPowerDbmRv = rxPowerDbmRv;
+}
+
+void
+BackgroundInterferenceInjector::AddStream(uint8_t sf,
+                                          uint32_t frequencyHz,
+                                          double arrivalsPerSecond)
+{
+    NS_LOG_FUNCTION(this << unsigned(sf) << frequencyHz << arrivalsPerSecond);
+
+    NS_ASSERT_MSG(sf >= 7 && sf <= 12, "Spreading factor out of range");
+    NS_ASSERT_MSG(arrivalsPerSecond > 0, "Stream intensity must be positive");
+
+    if (!m_dummyPacket)
+    {
+        m_dummyPacket = LoraPacketPool::CreatePacket(m_packetSize);
+    }
+
+    Stream stream;
+    stream.sf = sf;
+    stream.frequencyHz = frequencyHz;
+
+    LoraTxParameters params;
+    params.sf = sf;
+    params.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(params) > MilliSeconds(16);
+    stream.airtime = LoraPhy::GetOnAirTime(m_dummyPacket, params);
+
+    stream.intervalRv = CreateObject<ExponentialRandomVariable>();
+    stream.intervalRv->SetAttribute("Mean", DoubleValue(1.0 / arrivalsPerSecond));
+
+    m_streams.push_back(stream);
+
+    // Streams added while running join immediately
+    if (m_running)
+    {
+        std::size_t index = m_streams.size() - 1;
+        m_streams[index].nextEvent = Simulator::Schedule(Seconds(m_streams[index].intervalRv->GetValue()),
+                                                         &BackgroundInterferenceInjector::Inject,
+                                                         this,
+                                                         index);
+    }
+}
+
+void
+BackgroundInterferenceInjector::Start()
+{
+    NS_LOG_FUNCTION(this);
+
+    NS_ASSERT_MSG(m_phy, "No PHY set on this BackgroundInterferenceInjector");
+
+    if (m_running)
+    {
+        return;
+    }
+    m_running = true;
+
+    for (std::size_t index = 0; index < m_streams.size(); index++)
+    {
+        m_streams[index].nextEvent = Simulator::Schedule(Seconds(m_streams[index].intervalRv->GetValue()),
+                                                         &BackgroundInterferenceInjector::Inject,
+                                                         this,
+                                                         index);
+    }
+}
+
+void
+BackgroundInterferenceInjector::Stop()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_running = false;
+    for (auto& stream : m_streams)
+    {
+        Simulator::Cancel(stream.nextEvent);
+    }
+}
+
+void
+BackgroundInterferenceInjector::Inject(std::size_t index)
+{
+    Stream& stream = m_streams[index];
+
+    double rxPowerDbm = m_rxPowerDbmRv->GetValue();
+    NS_LOG_DEBUG("Synthetic interference: SF" << unsigned(stream.sf) << ", " << rxPowerDbm
+                                              << " dBm, " << stream.frequencyHz << " Hz, "
+                                              << stream.airtime.As(Time::S));
+
+    // The event only ever acts as an interferer; nothing downstream reads
+    // its payload
+    m_phy->GetInterferenceHelper().Add(stream.airtime,
+                                       rxPowerDbm,
+                                       stream.sf,
+                                       m_dummyPacket,
+                                       stream.frequencyHz);
+
+    stream.nextEvent = Simulator::Schedule(Seconds(stream.intervalRv->GetValue()),
+                                           &BackgroundInterferenceInjector::Inject,
+                                           this,
+                                           index);
+}
+
+} // namespace lorawan
+} // namespace ns3
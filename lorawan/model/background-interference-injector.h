@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef BACKGROUND_INTERFERENCE_INJECTOR_H
+#define BACKGROUND_INTERFERENCE_INJECTOR_H
+
+#include "lora-phy.h"
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * An analytic background-traffic process loading one gateway receiver.
+ *
+ * Where BackgroundLoadGenerator still sends real transmissions through the
+ * channel on behalf of compact device descriptors, this class goes one step
+ * further for the case where only the channel load matters: it registers
+ * synthetic interference events directly with the gateway PHY's
+ * LoraInterferenceHelper, with no device, MAC, mobility or channel objects
+ * behind them. Each configured (spreading factor, frequency) stream is an
+ * independent Poisson process whose arrivals cost one simulator event and
+ * one interference entry each, so a congested shared band can be modeled
+ * at a small fraction of the event and memory cost of simulating the
+ * interferer population.
+ *
+ * The injected events only ever appear as interferers: they are never
+ * candidates for reception, never generate downlink traffic and never
+ * appear in the packet tracker. Received powers are drawn from a
+ * configurable random variable; event durations are the airtime of a
+ * PacketSize-byte payload at the stream's spreading factor.
+ */
+class BackgroundInterferenceInjector : public Object
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    BackgroundInterferenceInjector();           //!< Default constructor
+    ~BackgroundInterferenceInjector() override; //!< Destructor
+
+    /**
+     * Set the gateway PHY whose interference helper is loaded.
+     *
+     * @param phy The receiving PHY.
+     */
+    void SetPhy(Ptr<LoraPhy> phy);
+
+    /**
+     * Set the random variable the received powers are drawn from.
+     *
+     * Defaults to a uniform draw in [-120, -80] dBm, roughly the spread of
+     * a device population scattered over a gateway's coverage area.
+     *
+     * @param rxPowerDbmRv A random variable providing received powers [dBm].
+     */
+    void SetRxPowerVariable(Ptr<RandomVariableStream> rxPowerDbmRv);
+
+    /**
+     * Configure one Poisson interference stream.
+     *
+     * @param sf The spreading factor of the stream's transmissions, in [7, 12].
+     * @param frequencyHz The carrier frequency [Hz] of the stream.
+     * @param arrivalsPerSecond The Poisson intensity of the stream.
+     */
+    void AddStream(uint8_t sf, uint32_t frequencyHz, double arrivalsPerSecond);
+
+    /**
+     * Start all configured streams, each at a random exponential offset.
+     */
+    void Start();
+
+    /**
+     * Cancel all pending stream events.
+     */
+    void Stop();
+
+  private:
+    /**
+     * One Poisson interference stream.
+     */
+    struct Stream
+    {
+        uint8_t sf;                                //!< Spreading factor of the stream.
+        uint32_t frequencyHz;                      //!< Carrier frequency of the stream.
+        Time airtime;                              //!< Duration of one injected event.
+        Ptr<ExponentialRandomVariable> intervalRv; //!< Inter-arrival time variable.
+        EventId nextEvent;                         //!< The stream's pending arrival.
+    };
+
+    /**
+     * Inject one arrival of a stream and schedule the next one.
+     *
+     * @param index The stream's index.
+     */
+    void Inject(std::size_t index);
+
+    Ptr<LoraPhy> m_phy;                        //!< The PHY being loaded.
+    uint8_t m_packetSize;                      //!< Payload size used for airtime computation.
+    Ptr<RandomVariableStream> m_rxPowerDbmRv;  //!< Received power variable.
+    Ptr<Packet> m_dummyPacket;                 //!< Shared payload carried by injected events.
+    std::vector<Stream> m_streams;             //!< The configured streams.
+    bool m_running;                            //!< Whether Start has been called.
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* BACKGROUND_INTERFERENCE_INJECTOR_H */
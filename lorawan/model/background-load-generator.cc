@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#include "background-load-generator.h"
+
+#include "lora-packet-pool.h"
+#include "simple-end-device-lora-phy.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("BackgroundLoadGenerator");
+
+NS_OBJECT_ENSURE_REGISTERED(BackgroundLoadGenerator);
+
+TypeId
+BackgroundLoadGenerator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::BackgroundLoadGenerator")
+            .SetParent<Object>()
+            .AddConstructor<BackgroundLoadGenerator>()
+            .SetGroupName("lorawan")
+            .AddAttribute("TickDuration",
+                          "Duration of one timer wheel tick. Transmission times are "
+                          "quantized to this resolution",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&BackgroundLoadGenerator::m_tickDuration),
+                          MakeTimeChecker())
+            .AddAttribute("WheelSize",
+                          "Number of buckets in the timer wheel",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&BackgroundLoadGenerator::m_wheelSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("PacketSize",
+                          "PHY payload size of the background packets, in bytes. Since "
+                          "the generator bypasses the MAC, this already includes what "
+                          "would be the MAC and frame header overhead",
+                          UintegerValue(23),
+                          MakeUintegerAccessor(&BackgroundLoadGenerator::m_packetSize),
+                          MakeUintegerChecker<uint8_t>(1));
+    return tid;
+}
+
+BackgroundLoadGenerator::BackgroundLoadGenerator()
+    : m_tickDuration(Seconds(1)),
+      m_wheelSize(1024),
+      m_packetSize(23),
+      m_frequenciesHz{868100000, 868300000, 868500000},
+      m_currentTick(0),
+      m_nDevices(0)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_uniformRV = CreateObject<UniformRandomVariable>();
+}
+
+BackgroundLoadGenerator::~BackgroundLoadGenerator()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+void
+BackgroundLoadGenerator::SetChannel(Ptr<LoraChannel> channel)
+{
+    NS_LOG_FUNCTION(this << channel);
+    m_channel = channel;
+}
+
+void
+BackgroundLoadGenerator::SetFrequencies(const std::vector<uint32_t>& frequenciesHz)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(!frequenciesHz.empty(), "At least one transmission frequency is needed");
+    m_frequenciesHz = frequenciesHz;
+}
+
+void
+BackgroundLoadGenerator::AddDevice(Vector position, uint8_t sf, double txPowerDbm, Time period)
+{
+    NS_LOG_FUNCTION(this << position << unsigned(sf) << txPowerDbm << period);
+    NS_ASSERT_MSG(sf >= 7 && sf <= 12, "Invalid spreading factor");
+
+    if (m_wheel.empty())
+    {
+        m_wheel.resize(m_wheelSize);
+        m_currentTick = uint64_t(Now() / m_tickDuration);
+    }
+
+    Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel>();
+    mobility->SetPosition(position);
+
+    Device device;
+    device.mobility = mobility;
+    device.id = 0;
+    device.sf = sf;
+    device.txPowerDbm = txPowerDbm;
+    device.periodTicks = std::max<uint64_t>(uint64_t(period / m_tickDuration), 1);
+
+    // Desynchronize the population: first send at a random tick within the
+    // first period
+    device.nextTick =
+        m_currentTick + 1 + uint64_t(m_uniformRV->GetValue(0, device.periodTicks));
+
+    Insert(std::move(device));
+    m_nDevices++;
+
+    ScheduleNextTick();
+}
+
+void
+BackgroundLoadGenerator::AddDevices(uint32_t count,
+                                    Ptr<PositionAllocator> positions,
+                                    Ptr<RandomVariableStream> sfRv,
+                                    Ptr<RandomVariableStream> txPowerRv,
+                                    Ptr<RandomVariableStream> periodRv)
+{
+    NS_LOG_FUNCTION(this << count << positions);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t sf = std::min<uint32_t>(std::max<uint32_t>(sfRv->GetInteger(), 7), 12);
+        AddDevice(positions->GetNext(), sf, txPowerRv->GetValue(), Seconds(periodRv->GetValue()));
+    }
+}
+
+uint32_t
+BackgroundLoadGenerator::GetNDevices() const
+{
+    return m_nDevices;
+}
+
+void
+BackgroundLoadGenerator::AddTrackedDevice(uint32_t id,
+                                          Ptr<MobilityModel> mobility,
+                                          uint8_t sf,
+                                          double txPowerDbm,
+                                          Time period)
+{
+    NS_LOG_FUNCTION(this << id << mobility << unsigned(sf) << txPowerDbm << period);
+    NS_ASSERT_MSG(sf >= 7 && sf <= 12, "Invalid spreading factor");
+    NS_ASSERT_MSG(id != 0, "Tracked devices need a nonzero identity");
+    NS_ASSERT_MSG(m_trackedTxCounts.find(id) == m_trackedTxCounts.end(),
+                  "Identity " << id << " is already registered");
+
+    if (m_wheel.empty())
+    {
+        m_wheel.resize(m_wheelSize);
+        m_currentTick = uint64_t(Now() / m_tickDuration);
+    }
+
+    Device device;
+    device.mobility = mobility;
+    device.id = id;
+    device.sf = sf;
+    device.txPowerDbm = txPowerDbm;
+    device.periodTicks = std::max<uint64_t>(uint64_t(period / m_tickDuration), 1);
+    device.nextTick =
+        m_currentTick + 1 + uint64_t(m_uniformRV->GetValue(0, device.periodTicks));
+
+    // A retired id may be re-registered before its old descriptor was
+    // reaped; the fresh registration wins
+    m_retired.erase(id);
+    m_trackedTxCounts[id] = 0;
+
+    Insert(std::move(device));
+    m_nDevices++;
+
+    ScheduleNextTick();
+}
+
+bool
+BackgroundLoadGenerator::RemoveTrackedDevice(uint32_t id, uint32_t* txCount)
+{
+    NS_LOG_FUNCTION(this << id);
+
+    auto tracked = m_trackedTxCounts.find(id);
+    if (tracked == m_trackedTxCounts.end())
+    {
+        return false;
+    }
+
+    if (txCount)
+    {
+        *txCount = tracked->second;
+    }
+    m_trackedTxCounts.erase(tracked);
+    m_retired.insert(id);
+    m_nDevices--;
+
+    return true;
+}
+
+void
+BackgroundLoadGenerator::Insert(Device device)
+{
+    m_wheel[device.nextTick % m_wheelSize].emplace_back(std::move(device));
+}
+
+void
+BackgroundLoadGenerator::Tick()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_currentTick = uint64_t(Now() / m_tickDuration);
+    auto& bucket = m_wheel[m_currentTick % m_wheelSize];
+
+    // Collect the devices that are due in this tick; devices hashed to this
+    // bucket but due on a later lap stay where they are
+    std::vector<Device> due;
+    for (auto it = bucket.begin(); it != bucket.end();)
+    {
+        if (it->id != 0 && m_retired.count(it->id) != 0)
+        {
+            // Reap a removed tracked device when its bucket comes around
+            m_retired.erase(it->id);
+            it = bucket.erase(it);
+        }
+        else if (it->nextTick <= m_currentTick)
+        {
+            due.emplace_back(std::move(*it));
+            it = bucket.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    NS_LOG_DEBUG("Tick " << m_currentTick << ": " << due.size() << " transmissions due");
+
+    for (auto& device : due)
+    {
+        Transmit(device);
+        device.nextTick = m_currentTick + device.periodTicks;
+        Insert(std::move(device));
+    }
+
+    ScheduleNextTick();
+}
+
+void
+BackgroundLoadGenerator::Transmit(const Device& device)
+{
+    NS_ASSERT_MSG(m_channel, "No channel set on this BackgroundLoadGenerator");
+
+    if (!m_senderPhy)
+    {
+        // One PHY serves the whole population: it is never added to the
+        // channel, so it does not receive and is not visited by Send
+        m_senderPhy = CreateObject<SimpleEndDeviceLoraPhy>();
+    }
+
+    LoraTxParameters params;
+    params.sf = device.sf;
+    params.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(params) > MilliSeconds(16);
+
+    Ptr<Packet> packet = LoraPacketPool::CreatePacket(m_packetSize);
+    Time duration = LoraPhy::GetOnAirTime(packet, params);
+    uint32_t frequencyHz =
+        m_frequenciesHz[m_uniformRV->GetInteger(0, m_frequenciesHz.size() - 1)];
+
+    // Point the shared PHY at the transmitting device's position
+    m_senderPhy->SetMobility(device.mobility);
+
+    if (device.id != 0)
+    {
+        auto tracked = m_trackedTxCounts.find(device.id);
+        if (tracked != m_trackedTxCounts.end())
+        {
+            tracked->second++;
+        }
+    }
+
+    NS_LOG_DEBUG("Background transmission: SF" << unsigned(device.sf) << ", "
+                                               << device.txPowerDbm << " dBm, " << frequencyHz
+                                               << " Hz, " << duration.As(Time::S));
+
+    m_channel->Send(m_senderPhy, packet, device.txPowerDbm, params, duration, frequencyHz);
+}
+
+void
+BackgroundLoadGenerator::ScheduleNextTick()
+{
+    if (m_tickEvent.IsPending())
+    {
+        return;
+    }
+
+    // Find the next non-empty bucket; a hit may still be a later-lap entry,
+    // in which case Tick simply reschedules, at most once per lap
+    for (uint32_t offset = 1; offset <= m_wheelSize; offset++)
+    {
+        if (!m_wheel[(m_currentTick + offset) % m_wheelSize].empty())
+        {
+            Time delay = Time((m_currentTick + offset) * m_tickDuration.GetTimeStep()) - Now();
+            m_tickEvent =
+                Simulator::Schedule(Max(delay, Time(0)), &BackgroundLoadGenerator::Tick, this);
+            return;
+        }
+    }
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef BACKGROUND_LOAD_GENERATOR_H
+#define BACKGROUND_LOAD_GENERATOR_H
+
+#include "lora-channel.h"
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * A statistical traffic source that loads the channel on behalf of a large
+ * background device population.
+ *
+ * Studying a small foreground of fully modeled devices often requires many
+ * more devices whose only role is to generate realistic interference.
+ * Instantiating the complete Node, ClassAEndDeviceLorawanMac, PHY and energy
+ * model stack for each of them is wasteful: none of that state is ever
+ * observed. This class keeps a compact descriptor (position, spreading
+ * factor, transmission power, period) per background device and injects
+ * their transmissions directly into LoraChannel::Send through a single
+ * shared sender PHY, so background load costs one small descriptor per
+ * device and one simulator event per transmission.
+ *
+ * The shared PHY never receives: background devices cause interference at
+ * the modeled receivers but do not themselves react to the channel, perform
+ * duty cycle bookkeeping or retransmit. Transmission times are quantized to
+ * the timer wheel tick like in PeriodicTrafficEngine.
+ */
+class BackgroundLoadGenerator : public Object
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    BackgroundLoadGenerator();           //!< Default constructor
+    ~BackgroundLoadGenerator() override; //!< Destructor
+
+    /**
+     * Set the channel the background transmissions are injected into.
+     *
+     * @param channel The channel to load.
+     */
+    void SetChannel(Ptr<LoraChannel> channel);
+
+    /**
+     * Set the frequencies the background devices transmit on.
+     *
+     * Each transmission picks one of these uniformly at random. Defaults to
+     * the three EU868 default channels.
+     *
+     * @param frequenciesHz The carrier frequencies [Hz] to use.
+     */
+    void SetFrequencies(const std::vector<uint32_t>& frequenciesHz);
+
+    /**
+     * Register one background device.
+     *
+     * The first transmission happens at a random time within the first
+     * period, to desynchronize the population.
+     *
+     * @param position The fixed position of the device.
+     * @param sf The spreading factor of the device's transmissions.
+     * @param txPowerDbm The transmission power of the device, in dBm.
+     * @param period The interval between two transmissions.
+     */
+    void AddDevice(Vector position, uint8_t sf, double txPowerDbm, Time period);
+
+    /**
+     * Register a population of background devices drawn from distributions.
+     *
+     * @param count The number of devices to register.
+     * @param positions The allocator providing the device positions.
+     * @param sfRv A random variable providing spreading factors in [7, 12].
+     * @param txPowerRv A random variable providing transmission powers [dBm].
+     * @param periodRv A random variable providing send periods [s].
+     */
+    void AddDevices(uint32_t count,
+                    Ptr<PositionAllocator> positions,
+                    Ptr<RandomVariableStream> sfRv,
+                    Ptr<RandomVariableStream> txPowerRv,
+                    Ptr<RandomVariableStream> periodRv);
+
+    /**
+     * Get the number of background devices registered with this generator.
+     *
+     * @return The number of registered devices.
+     */
+    uint32_t GetNDevices() const;
+
+    /**
+     * Register a tracked background device standing in for a demoted
+     * full-fidelity node.
+     *
+     * Unlike the anonymous population, tracked devices keep an identity and
+     * a transmission count, so they can later be removed and their
+     * transmissions folded back into the full model's frame counter. The
+     * mobility model is shared with the caller, so a moving node keeps
+     * moving while demoted.
+     *
+     * @param id A nonzero identity, typically the raw device address.
+     * @param mobility The device's mobility model.
+     * @param sf The spreading factor of the device's transmissions.
+     * @param txPowerDbm The transmission power of the device, in dBm.
+     * @param period The interval between two transmissions.
+     */
+    void AddTrackedDevice(uint32_t id,
+                          Ptr<MobilityModel> mobility,
+                          uint8_t sf,
+                          double txPowerDbm,
+                          Time period);
+
+    /**
+     * Remove a tracked background device.
+     *
+     * The descriptor is dropped lazily the next time its wheel bucket is
+     * visited; it stops transmitting immediately.
+     *
+     * @param id The identity the device was registered under.
+     * @param txCount [out] If non-null, receives the number of transmissions
+     * the device performed while registered.
+     * @return True if a device with this identity was registered.
+     */
+    bool RemoveTrackedDevice(uint32_t id, uint32_t* txCount = nullptr);
+
+  private:
+    /**
+     * The state kept for one background device.
+     */
+    struct Device
+    {
+        Ptr<MobilityModel> mobility; //!< The device's position.
+        uint8_t sf;            //!< The spreading factor of the device's transmissions.
+        double txPowerDbm;     //!< The transmission power of the device, in dBm.
+        uint64_t nextTick;     //!< The absolute tick of the next transmission.
+        uint64_t periodTicks;  //!< The send period, in ticks (at least 1).
+        uint32_t id;           //!< Identity of a tracked device, 0 for anonymous ones.
+    };
+
+    /**
+     * Process all transmissions due in the current bucket and advance the wheel.
+     */
+    void Tick();
+
+    /**
+     * Schedule the Tick event for the next non-empty bucket, if any.
+     */
+    void ScheduleNextTick();
+
+    /**
+     * Insert a device into the bucket its next transmission tick hashes to.
+     *
+     * @param device The device to insert.
+     */
+    void Insert(Device device);
+
+    /**
+     * Inject one transmission of the given device into the channel.
+     *
+     * @param device The device transmitting.
+     */
+    void Transmit(const Device& device);
+
+    Time m_tickDuration;  //!< Duration of one wheel tick.
+    uint32_t m_wheelSize; //!< Number of buckets in the wheel.
+    uint8_t m_packetSize; //!< PHY payload size of the background packets, in bytes.
+
+    Ptr<LoraChannel> m_channel; //!< The channel the transmissions are injected into.
+
+    /**
+     * The PHY all background transmissions are sent through. It is never
+     * connected to the channel, so it does not receive; its mobility model
+     * is pointed at the transmitting device's position before each send.
+     */
+    Ptr<LoraPhy> m_senderPhy;
+
+    std::vector<uint32_t> m_frequenciesHz; //!< The frequencies to transmit on.
+
+    /**
+     * The timer wheel. Bucket i holds the devices whose next transmission
+     * tick is congruent to i modulo m_wheelSize; devices due on a later lap
+     * are left in place when their bucket is processed.
+     */
+    std::vector<std::vector<Device>> m_wheel;
+
+    uint64_t m_currentTick; //!< The tick the wheel has been advanced to.
+    uint32_t m_nDevices;    //!< Number of registered devices.
+
+    std::unordered_map<uint32_t, uint32_t> m_trackedTxCounts; //!< Transmissions by tracked id.
+    std::unordered_set<uint32_t> m_retired; //!< Tracked ids awaiting lazy removal.
+    EventId m_tickEvent;    //!< The single pending Tick event.
+
+    /**
+     * A uniform random variable, used to desynchronize first transmissions
+     * and to pick transmission frequencies.
+     */
+    Ptr<UniformRandomVariable> m_uniformRV;
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* BACKGROUND_LOAD_GENERATOR_H */
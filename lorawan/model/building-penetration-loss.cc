@@ -6,6 +6,7 @@
 
 #include "building-penetration-loss.h"
 
+#include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/mobility-building-info.h"
@@ -24,10 +25,19 @@ NS_OBJECT_ENSURE_REGISTERED(BuildingPenetrationLoss);
 TypeId
 BuildingPenetrationLoss::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::BuildingPenetrationLoss")
-                            .SetParent<PropagationLossModel>()
-                            .SetGroupName("Lora")
-                            .AddConstructor<BuildingPenetrationLoss>();
+    static TypeId tid =
+        TypeId("ns3::BuildingPenetrationLoss")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Lora")
+            .AddConstructor<BuildingPenetrationLoss>()
+            .AddAttribute("CachePenetrationLoss",
+                          "Whether to draw the penetration loss of each (tx, rx)"
+                          "pair only once and reuse it for all later packets on"
+                          "the same link, keeping the loss physically constant"
+                          "across a run and avoiding per-packet RNG work",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&BuildingPenetrationLoss::m_cachePenetrationLoss),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -51,6 +61,16 @@ BuildingPenetrationLoss::DoCalcRxPower(double txPowerDbm,
 {
     NS_LOG_FUNCTION(this << txPowerDbm << a << b);
 
+    if (m_cachePenetrationLoss)
+    {
+        auto it = m_lossMap.find(std::make_pair(a, b));
+        if (it != m_lossMap.end())
+        {
+            NS_LOG_DEBUG("Reusing cached penetration loss: " << it->second);
+            return txPowerDbm - it->second;
+        }
+    }
+
     Ptr<MobilityBuildingInfo> a1 = a->GetObject<MobilityBuildingInfo>();
     Ptr<MobilityBuildingInfo> b1 = b->GetObject<MobilityBuildingInfo>();
 
@@ -114,6 +134,11 @@ BuildingPenetrationLoss::DoCalcRxPower(double txPowerDbm,
 
     NS_LOG_DEBUG("Total loss due to building penetration: " << loss);
 
+    if (m_cachePenetrationLoss)
+    {
+        m_lossMap[std::make_pair(a, b)] = loss;
+    }
+
     return txPowerDbm - loss;
 }
 
@@ -85,6 +85,19 @@ class BuildingPenetrationLoss : public PropagationLossModel
      * loss.
      */
     mutable std::map<Ptr<MobilityModel>, int> m_wallLossMap;
+
+    /**
+     * Whether to draw the total penetration loss of a link only once and
+     * reuse it for all subsequent packets on the same (tx, rx) pair. Enabled
+     * through the CachePenetrationLoss attribute.
+     */
+    bool m_cachePenetrationLoss;
+
+    /**
+     * A map linking each (tx, rx) mobility model pair to its drawn
+     * penetration loss, filled when m_cachePenetrationLoss is enabled.
+     */
+    mutable std::map<std::pair<Ptr<MobilityModel>, Ptr<MobilityModel>>, double> m_lossMap;
 };
 } // namespace lorawan
 } // namespace ns3
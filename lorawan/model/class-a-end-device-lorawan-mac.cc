@@ -16,6 +16,7 @@
 #include "end-device-lorawan-mac.h"
 #include "lora-tag.h"
 
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 
 namespace ns3
@@ -33,7 +34,15 @@ ClassAEndDeviceLorawanMac::GetTypeId()
     static TypeId tid = TypeId("ns3::ClassAEndDeviceLorawanMac")
                             .SetParent<EndDeviceLorawanMac>()
                             .SetGroupName("lorawan")
-                            .AddConstructor<ClassAEndDeviceLorawanMac>();
+                            .AddConstructor<ClassAEndDeviceLorawanMac>()
+                            .AddAttribute("ExpectsDownlink",
+                                          "Whether this device expects downlink traffic. When "
+                                          "false, unconfirmed uplinks schedule no receive "
+                                          "windows at all.",
+                                          BooleanValue(true),
+                                          MakeBooleanAccessor(
+                                              &ClassAEndDeviceLorawanMac::m_expectsDownlink),
+                                          MakeBooleanChecker());
     return tid;
 }
 
@@ -46,13 +55,10 @@ ClassAEndDeviceLorawanMac::ClassAEndDeviceLorawanMac()
 {
     NS_LOG_FUNCTION(this);
 
-    // Void the two receiveWindow events
-    m_closeFirstWindow = EventId();
-    m_closeFirstWindow.Cancel();
-    m_closeSecondWindow = EventId();
-    m_closeSecondWindow.Cancel();
-    m_secondReceiveWindow = EventId();
-    m_secondReceiveWindow.Cancel();
+    // Void the receive window state machine
+    m_windowStage = NO_WINDOWS;
+    m_windowEvent = EventId();
+    m_windowEvent.Cancel();
 }
 
 ClassAEndDeviceLorawanMac::~ClassAEndDeviceLorawanMac()
@@ -78,7 +84,7 @@ ClassAEndDeviceLorawanMac::SendToPhy(Ptr<Packet> packetToSend)
         (m_retxParams.retxLeft % 2 == 0))
     {
         m_txPowerDbm = 14; // Reset transmission power
-        m_dataRate = m_dataRate - 1;
+        SetDataRate(m_dataRate - 1);
     }
 
     // Craft LoraTxParameters object
@@ -161,9 +167,12 @@ ClassAEndDeviceLorawanMac::Receive(Ptr<const Packet> packet)
         {
             NS_LOG_INFO("The message is for us!");
 
-            // If it exists, cancel the second receive window event
-            // THIS WILL BE GetReceiveWindow()
-            Simulator::Cancel(m_secondReceiveWindow);
+            // If it is still to open, cancel the second receive window stage
+            if (SecondReceiveWindowPending())
+            {
+                m_windowEvent.Cancel();
+                m_windowStage = NO_WINDOWS;
+            }
 
             LoraTag tag;
             packet->PeekPacketTag(tag);
@@ -187,7 +196,7 @@ ClassAEndDeviceLorawanMac::Receive(Ptr<const Packet> packet)
             // packet in the second receive window and finding out, after the
             // fact, that the packet is not for us. In either case, if we no
             // longer have any retransmissions left, we declare failure.
-            if (m_retxParams.waitingAck && m_secondReceiveWindow.IsExpired())
+            if (m_retxParams.waitingAck && !SecondReceiveWindowPending())
             {
                 if (m_retxParams.retxLeft == 0)
                 {
@@ -211,7 +220,7 @@ ClassAEndDeviceLorawanMac::Receive(Ptr<const Packet> packet)
             }
         }
     }
-    else if (m_retxParams.waitingAck && m_secondReceiveWindow.IsExpired())
+    else if (m_retxParams.waitingAck && !SecondReceiveWindowPending())
     {
         NS_LOG_INFO("The packet we are receiving is in uplink.");
         if (m_retxParams.retxLeft > 0)
@@ -243,7 +252,7 @@ ClassAEndDeviceLorawanMac::FailedReception(Ptr<const Packet> packet)
     // Switch to sleep after a failed reception
     DynamicCast<EndDeviceLoraPhy>(m_phy)->SwitchToSleep();
 
-    if (m_secondReceiveWindow.IsExpired() && m_retxParams.waitingAck)
+    if (!SecondReceiveWindowPending() && m_retxParams.waitingAck)
     {
         if (m_retxParams.retxLeft > 0)
         {
@@ -269,26 +278,72 @@ ClassAEndDeviceLorawanMac::TxFinished(Ptr<const Packet> packet)
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    // Schedule the opening of the first receive window
-    Simulator::Schedule(m_receiveDelay1, &ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow, this);
-
-    // Schedule the opening of the second receive window
-    m_secondReceiveWindow = Simulator::Schedule(m_receiveDelay2,
-                                                &ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow,
-                                                this);
-    // // Schedule the opening of the first receive window
-    // Simulator::Schedule (m_receiveDelay1,
-    //                      &ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow, this);
-    //
-    // // Schedule the opening of the second receive window
-    // m_secondReceiveWindow = Simulator::Schedule (m_receiveDelay2,
-    //                                              &ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow,
-    //                                              this);
+    if (!m_expectsDownlink && !m_retxParams.waitingAck)
+    {
+        // Uplink-only device: skip the receive windows entirely, and settle
+        // right away the transmission bookkeeping that normally runs when
+        // the second window closes
+        NS_LOG_DEBUG("No downlink expected: not scheduling receive windows.");
+        uint8_t txs = m_nbTrans - (m_retxParams.retxLeft);
+        m_requiredTxCallback(txs, true, m_retxParams.firstAttempt, m_retxParams.packet);
+        resetRetransmissionParameters();
+        DynamicCast<EndDeviceLoraPhy>(m_phy)->SwitchToSleep();
+        return;
+    }
+
+    // Remember when the second receive window opens: the retransmission
+    // backoff is computed from that instant
+    m_rx2OpenTime = Now() + m_receiveDelay2;
+
+    // Schedule the opening of the first receive window; the later window
+    // edges are chained one at a time by the state machine
+    m_windowStage = RX1_PENDING;
+    m_windowEvent =
+        Simulator::Schedule(m_receiveDelay1, &ClassAEndDeviceLorawanMac::ReceiveWindowTick, this);
 
     // Switch the PHY to sleep
     DynamicCast<EndDeviceLoraPhy>(m_phy)->SwitchToSleep();
 }
 
+void
+ClassAEndDeviceLorawanMac::ReceiveWindowTick()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    switch (m_windowStage)
+    {
+    case RX1_PENDING:
+        m_windowStage = RX1_OPEN;
+        OpenFirstReceiveWindow();
+        break;
+    case RX1_OPEN:
+        m_windowStage = RX2_PENDING;
+        CloseFirstReceiveWindow();
+        m_windowEvent = Simulator::Schedule(m_rx2OpenTime - Now(),
+                                            &ClassAEndDeviceLorawanMac::ReceiveWindowTick,
+                                            this);
+        break;
+    case RX2_PENDING:
+        m_windowStage = RX2_OPEN;
+        OpenSecondReceiveWindow();
+        break;
+    case RX2_OPEN:
+        m_windowStage = NO_WINDOWS;
+        CloseSecondReceiveWindow();
+        break;
+    case NO_WINDOWS:
+        NS_ABORT_MSG("Receive window tick fired with no window activity pending.");
+        break;
+    }
+}
+
+bool
+ClassAEndDeviceLorawanMac::SecondReceiveWindowPending() const
+{
+    return m_windowStage == RX1_PENDING || m_windowStage == RX1_OPEN ||
+           m_windowStage == RX2_PENDING;
+}
+
 void
 ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow()
 {
@@ -304,9 +359,9 @@ ClassAEndDeviceLorawanMac::OpenFirstReceiveWindow()
     // Schedule return to sleep after "at least the time required by the end
     // device's radio transceiver to effectively detect a downlink preamble"
     // (LoraWAN specification)
-    m_closeFirstWindow = Simulator::Schedule(Seconds(m_receiveWindowDurationInSymbols * tSym),
-                                             &ClassAEndDeviceLorawanMac::CloseFirstReceiveWindow,
-                                             this); // m_receiveWindowDuration
+    m_windowEvent = Simulator::Schedule(Seconds(m_receiveWindowDurationInSymbols * tSym),
+                                        &ClassAEndDeviceLorawanMac::ReceiveWindowTick,
+                                        this); // m_receiveWindowDuration
 }
 
 void
@@ -349,6 +404,9 @@ ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow()
     {
         NS_LOG_INFO("Won't open second receive window since we are in RX mode.");
 
+        // No close stage to run either: the ongoing reception will put the
+        // PHY back to sleep
+        m_windowStage = NO_WINDOWS;
         return;
     }
 
@@ -370,9 +428,9 @@ ClassAEndDeviceLorawanMac::OpenSecondReceiveWindow()
     // Schedule return to sleep after "at least the time required by the end
     // device's radio transceiver to effectively detect a downlink preamble"
     // (LoraWAN specification)
-    m_closeSecondWindow = Simulator::Schedule(Seconds(m_receiveWindowDurationInSymbols * tSym),
-                                              &ClassAEndDeviceLorawanMac::CloseSecondReceiveWindow,
-                                              this);
+    m_windowEvent = Simulator::Schedule(Seconds(m_receiveWindowDurationInSymbols * tSym),
+                                        &ClassAEndDeviceLorawanMac::ReceiveWindowTick,
+                                        this);
 }
 
 void
@@ -456,8 +514,7 @@ ClassAEndDeviceLorawanMac::GetNextClassTransmissionDelay(Time waitTime)
     // second receive window (if the second receive window has not closed yet)
     if (!m_retxParams.waitingAck)
     {
-        if (!m_closeFirstWindow.IsExpired() || !m_closeSecondWindow.IsExpired() ||
-            !m_secondReceiveWindow.IsExpired())
+        if (m_windowStage != NO_WINDOWS)
         {
             NS_LOG_WARN(
                 "Attempting to send when there are receive windows: Transmission postponed.");
@@ -465,8 +522,8 @@ ClassAEndDeviceLorawanMac::GetNextClassTransmissionDelay(Time waitTime)
             double tSym = pow(2, GetSfFromDataRate(GetSecondReceiveWindowDataRate())) /
                           GetBandwidthFromDataRate(GetSecondReceiveWindowDataRate());
             // Compute the closing time of the second receive window
-            Time endSecondRxWindow = Time(m_secondReceiveWindow.GetTs()) +
-                                     Seconds(m_receiveWindowDurationInSymbols * tSym);
+            Time endSecondRxWindow =
+                m_rx2OpenTime + Seconds(m_receiveWindowDurationInSymbols * tSym);
 
             NS_LOG_DEBUG("Duration until endSecondRxWindow for new transmission:"
                          << (endSecondRxWindow - Now()).As(Time::S));
@@ -480,8 +537,7 @@ ClassAEndDeviceLorawanMac::GetNextClassTransmissionDelay(Time waitTime)
         double ack_timeout = m_uniformRV->GetValue(1, 3);
         // Compute the duration until ACK_TIMEOUT (It may be a negative number, but it doesn't
         // matter.)
-        Time retransmitWaitTime =
-            Time(m_secondReceiveWindow.GetTs()) - Now() + Seconds(ack_timeout);
+        Time retransmitWaitTime = m_rx2OpenTime - Now() + Seconds(ack_timeout);
 
         NS_LOG_DEBUG("ack_timeout:" << ack_timeout
                                     << " retransmitWaitTime:" << retransmitWaitTime.As(Time::S));
@@ -160,6 +160,36 @@ class ClassAEndDeviceLorawanMac : public EndDeviceLorawanMac
     void OnRxParamSetupReq(uint8_t rx1DrOffset, uint8_t rx2DataRate, double frequencyHz) override;
 
   private:
+    /**
+     * The stage of the per-uplink receive window state machine.
+     */
+    enum ReceiveWindowStage
+    {
+        NO_WINDOWS = 0, //!< No receive window activity is pending.
+        RX1_PENDING,    //!< Waiting to open the first receive window.
+        RX1_OPEN,       //!< The first receive window is open.
+        RX2_PENDING,    //!< Waiting to open the second receive window.
+        RX2_OPEN        //!< The second receive window is open.
+    };
+
+    /**
+     * Advance the receive window state machine by one stage.
+     *
+     * All four window edges of an uplink are driven by the single
+     * m_windowEvent: each stage performs its open or close actions and
+     * schedules the next one, instead of queueing separate open and close
+     * events per window up front.
+     */
+    void ReceiveWindowTick();
+
+    /**
+     * Check whether the second receive window is still to be opened.
+     *
+     * @return True until the second window open stage has run or the windows
+     * were canceled by a reception.
+     */
+    bool SecondReceiveWindowPending() const;
+
     Time m_receiveDelay1; //!< The interval between when a packet is done sending and when the first
                           //!< receive window is opened.
 
@@ -170,26 +200,33 @@ class ClassAEndDeviceLorawanMac : public EndDeviceLorawanMac
     Time m_receiveDelay2;
 
     /**
-     * The event of the closing the first receive window.
+     * The stage the receive window state machine is currently in.
+     */
+    ReceiveWindowStage m_windowStage;
+
+    /**
+     * The single event driving the receive window state machine.
      *
-     * This Event will be canceled if there's a successful reception of a packet.
+     * It is canceled if a reception makes the remaining stages unnecessary.
      */
-    EventId m_closeFirstWindow;
+    EventId m_windowEvent;
 
     /**
-     * The event of the closing the second receive window.
+     * When the second receive window of the last uplink opens (or opened).
      *
-     * This Event will be canceled if there's a successful reception of a packet.
+     * Kept beyond the windows themselves, since the retransmission backoff
+     * is computed from this instant.
      */
-    EventId m_closeSecondWindow;
+    Time m_rx2OpenTime;
 
     /**
-     * The event of the second receive window opening.
+     * Whether this device expects downlink traffic at all.
      *
-     * This Event is used to cancel the second window in case the first one is
-     * successful.
+     * When false, unconfirmed uplinks schedule no receive windows: the
+     * device is modeled as never listening, which halves the event load of
+     * uplink-only sensors. Confirmed traffic still opens its windows.
      */
-    EventId m_secondReceiveWindow;
+    bool m_expectsDownlink;
 
     /**
      * The frequency [Hz] to listen on for the second receive window.
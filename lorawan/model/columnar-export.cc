@@ -0,0 +1,242 @@
+// model/columnar-export.cc
+
+#include "columnar-export.h"
+
+#include "ns3/abort.h"
+
+#include <cstring>
+#include <iomanip>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+namespace
+{
+
+const char COLUMNAR_MAGIC[4] = {'L', 'W', 'C', 'B'};
+
+void
+AppendBytes(std::string& out, const void* data, size_t len)
+{
+    out.append(static_cast<const char*>(data), len);
+}
+
+void
+AppendU32(std::string& out, uint32_t value)
+{
+    AppendBytes(out, &value, sizeof(value));
+}
+
+void
+AppendU16(std::string& out, uint16_t value)
+{
+    AppendBytes(out, &value, sizeof(value));
+}
+
+bool
+ReadBytes(std::ifstream& in, void* data, size_t len)
+{
+    in.read(static_cast<char*>(data), len);
+    return in.gcount() == static_cast<std::streamsize>(len);
+}
+
+} // namespace
+
+void
+BinaryColumnarWriter::SetColumns(const std::vector<std::string>& columns)
+{
+    NS_ABORT_MSG_IF(m_bufferedRows > 0, "Cannot change columns with rows buffered");
+    m_columns = columns;
+    m_rows.clear();
+}
+
+void
+BinaryColumnarWriter::AppendRow(const std::vector<double>& values)
+{
+    NS_ABORT_MSG_IF(values.size() != m_columns.size(),
+                    "Row width " << values.size() << " does not match " << m_columns.size()
+                                 << " columns");
+    m_rows.insert(m_rows.end(), values.begin(), values.end());
+    m_bufferedRows++;
+}
+
+std::string
+BinaryColumnarWriter::SerializeHeader() const
+{
+    std::string out;
+    AppendBytes(out, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+    AppendU32(out, FORMAT_VERSION);
+    AppendU32(out, static_cast<uint32_t>(m_columns.size()));
+    for (const auto& name : m_columns)
+    {
+        AppendU16(out, static_cast<uint16_t>(name.size()));
+        AppendBytes(out, name.data(), name.size());
+    }
+    return out;
+}
+
+std::string
+BinaryColumnarWriter::SerializeBlock()
+{
+    if (m_bufferedRows == 0)
+    {
+        return std::string();
+    }
+
+    const size_t columnCount = m_columns.size();
+    std::string out;
+    out.reserve(sizeof(uint32_t) + m_rows.size() * sizeof(double));
+    AppendU32(out, m_bufferedRows);
+
+    // Transpose the row-major scratch buffer into per-column arrays so the
+    // reader can bulk-load each column with a single read
+    std::vector<double> column(m_bufferedRows);
+    for (size_t col = 0; col < columnCount; col++)
+    {
+        for (uint32_t row = 0; row < m_bufferedRows; row++)
+        {
+            column[row] = m_rows[row * columnCount + col];
+        }
+        AppendBytes(out, column.data(), column.size() * sizeof(double));
+    }
+
+    m_rows.clear();
+    m_bufferedRows = 0;
+    return out;
+}
+
+bool
+BinaryColumnarWriter::Open(const std::string& filename)
+{
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    m_file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        return false;
+    }
+    std::string header = SerializeHeader();
+    m_file.write(header.data(), header.size());
+    return true;
+}
+
+void
+BinaryColumnarWriter::WriteBlock()
+{
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    std::string block = SerializeBlock();
+    if (!block.empty())
+    {
+        m_file.write(block.data(), block.size());
+        m_file.flush();
+    }
+}
+
+void
+BinaryColumnarWriter::Close()
+{
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    WriteBlock();
+    m_file.close();
+}
+
+bool
+BinaryColumnarWriter::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+bool
+BinaryColumnarWriter::ConvertToCsv(const std::string& binaryFilename,
+                                   const std::string& csvFilename)
+{
+    std::ifstream in(binaryFilename, std::ios::binary);
+    if (!in.is_open())
+    {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t columnCount = 0;
+    if (!ReadBytes(in, magic, sizeof(magic)) || std::memcmp(magic, COLUMNAR_MAGIC, 4) != 0 ||
+        !ReadBytes(in, &version, sizeof(version)) || version != FORMAT_VERSION ||
+        !ReadBytes(in, &columnCount, sizeof(columnCount)) || columnCount == 0)
+    {
+        return false;
+    }
+
+    std::vector<std::string> columns(columnCount);
+    for (auto& name : columns)
+    {
+        uint16_t nameLen = 0;
+        if (!ReadBytes(in, &nameLen, sizeof(nameLen)))
+        {
+            return false;
+        }
+        name.resize(nameLen);
+        if (nameLen > 0 && !ReadBytes(in, name.data(), nameLen))
+        {
+            return false;
+        }
+    }
+
+    std::ofstream out(csvFilename, std::ios::trunc);
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    for (uint32_t col = 0; col < columnCount; col++)
+    {
+        out << (col > 0 ? "," : "") << columns[col];
+    }
+    out << std::endl;
+
+    // Blocks follow until EOF; a clean EOF at a block boundary ends the file
+    std::vector<std::vector<double>> block(columnCount);
+    while (true)
+    {
+        uint32_t rowCount = 0;
+        in.read(reinterpret_cast<char*>(&rowCount), sizeof(rowCount));
+        if (in.gcount() == 0)
+        {
+            break;
+        }
+        if (in.gcount() != sizeof(rowCount) || rowCount == 0)
+        {
+            return false;
+        }
+        for (auto& column : block)
+        {
+            column.resize(rowCount);
+            if (!ReadBytes(in, column.data(), rowCount * sizeof(double)))
+            {
+                return false;
+            }
+        }
+        for (uint32_t row = 0; row < rowCount; row++)
+        {
+            for (uint32_t col = 0; col < columnCount; col++)
+            {
+                out << (col > 0 ? "," : "") << std::setprecision(10) << block[col][row];
+            }
+            out << "\n";
+        }
+    }
+
+    return true;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,125 @@
+// model/columnar-export.h
+
+#ifndef COLUMNAR_EXPORT_H
+#define COLUMNAR_EXPORT_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Compact binary columnar sink for periodic statistics exports.
+ *
+ * Formatting doubles to text dominates the cost of the CSV exports on large
+ * runs, and multi-GB CSVs are slow to parse downstream. This writer stores
+ * every column as raw little-endian doubles instead, grouped per column so
+ * a block is one memcpy per column on both ends.
+ *
+ * File layout (version 1):
+ *   - magic "LWCB", uint32 version, uint32 columnCount
+ *   - per column: uint16 name length, name bytes
+ *   - blocks until EOF, each: uint32 rowCount, then columnCount contiguous
+ *     arrays of rowCount doubles (column-major)
+ *
+ * Rows are buffered row-major via AppendRow() and transposed when a block is
+ * serialized, so callers emit one block per export interval. The class can
+ * either own its output file (Open/WriteBlock/Close) or hand serialized
+ * chunks to an external sink (SerializeHeader/SerializeBlock), which lets
+ * StatisticsCollectorComponent reuse its background writer thread.
+ *
+ * ConvertToCsv() is the matching offline reader; see the columnar-to-csv
+ * example for a command line wrapper. Compression is left to external tools
+ * (e.g. piping through zstd): the format is already an order of magnitude
+ * smaller than the text it replaces and the module carries no compression
+ * dependency.
+ */
+class BinaryColumnarWriter
+{
+  public:
+    static const uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * Set the column names. Must be called before any row is appended and
+     * fixes the row width for the lifetime of the file.
+     *
+     * @param columns The ordered column names.
+     */
+    void SetColumns(const std::vector<std::string>& columns);
+
+    /**
+     * Buffer one row of values. The value count must match the column count.
+     *
+     * @param values One double per column, in column order.
+     */
+    void AppendRow(const std::vector<double>& values);
+
+    /**
+     * Serialize the file header (magic, version and column names).
+     *
+     * @return The header bytes.
+     */
+    std::string SerializeHeader() const;
+
+    /**
+     * Serialize all buffered rows as one column-major block and clear the
+     * buffer. Returns an empty string when no rows are buffered.
+     *
+     * @return The block bytes.
+     */
+    std::string SerializeBlock();
+
+    /**
+     * Open a file this writer owns and write the header. Truncates any
+     * existing file.
+     *
+     * @param filename The output file name.
+     * @return True if the file was opened.
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * Write the buffered rows as one block to the owned file.
+     */
+    void WriteBlock();
+
+    /**
+     * Flush and close the owned file, writing any buffered rows first.
+     */
+    void Close();
+
+    /**
+     * Whether Open() has been called successfully on this writer.
+     *
+     * @return True if the owned file is open.
+     */
+    bool IsOpen() const;
+
+    /**
+     * Offline conversion of a columnar file back to CSV.
+     *
+     * @param binaryFilename The columnar input file.
+     * @param csvFilename The CSV output file.
+     * @return True on success, false if either file cannot be opened or the
+     * input is malformed.
+     */
+    static bool ConvertToCsv(const std::string& binaryFilename, const std::string& csvFilename);
+
+  private:
+    std::vector<std::string> m_columns; //!< Ordered column names
+    std::vector<double> m_rows;         //!< Row-major scratch buffer
+    uint32_t m_bufferedRows = 0;        //!< Rows currently buffered
+    std::ofstream m_file;               //!< Owned output file, if any
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif // COLUMNAR_EXPORT_H
@@ -6,10 +6,12 @@
 
 #include "correlated-shadowing-propagation-loss-model.h"
 
+#include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
 
 #include <cmath>
+#include <fstream>
 
 namespace ns3
 {
@@ -34,6 +36,38 @@ CorrelatedShadowingPropagationLossModel::GetTypeId()
                 "uncorrelated",
                 DoubleValue(110.0),
                 MakeDoubleAccessor(&CorrelatedShadowingPropagationLossModel::m_correlationDistance),
+                MakeDoubleChecker<double>())
+            .AddAttribute(
+                "PrecomputeGrid",
+                "Whether to generate the whole grid of shadowing values as soon"
+                "as a square is first used, so that per-packet queries reduce to"
+                "a few array reads and an interpolation",
+                BooleanValue(false),
+                MakeBooleanAccessor(&CorrelatedShadowingPropagationLossModel::m_precomputeGrid),
+                MakeBooleanChecker())
+            .AddAttribute(
+                "GridMinX",
+                "Lower x bound of the area covered by precomputed grids [m]",
+                DoubleValue(-10000.0),
+                MakeDoubleAccessor(&CorrelatedShadowingPropagationLossModel::m_gridMinX),
+                MakeDoubleChecker<double>())
+            .AddAttribute(
+                "GridMinY",
+                "Lower y bound of the area covered by precomputed grids [m]",
+                DoubleValue(-10000.0),
+                MakeDoubleAccessor(&CorrelatedShadowingPropagationLossModel::m_gridMinY),
+                MakeDoubleChecker<double>())
+            .AddAttribute(
+                "GridMaxX",
+                "Upper x bound of the area covered by precomputed grids [m]",
+                DoubleValue(10000.0),
+                MakeDoubleAccessor(&CorrelatedShadowingPropagationLossModel::m_gridMaxX),
+                MakeDoubleChecker<double>())
+            .AddAttribute(
+                "GridMaxY",
+                "Upper y bound of the area covered by precomputed grids [m]",
+                DoubleValue(10000.0),
+                MakeDoubleAccessor(&CorrelatedShadowingPropagationLossModel::m_gridMaxY),
                 MakeDoubleChecker<double>());
     return tid;
 }
@@ -85,6 +119,11 @@ CorrelatedShadowingPropagationLossModel::DoCalcRxPower(double txPowerDbm,
         Ptr<ShadowingMap> shadowingMap =
             Create<CorrelatedShadowingPropagationLossModel::ShadowingMap>();
 
+        if (m_precomputeGrid)
+        {
+            shadowingMap->Precompute(m_gridMinX, m_gridMinY, m_gridMaxX, m_gridMaxY);
+        }
+
         m_shadowingGrid[coordinates] = shadowingMap;
     }
     else
@@ -114,6 +153,66 @@ CorrelatedShadowingPropagationLossModel::DoAssignStreams(int64_t stream)
     return 0;
 }
 
+void
+CorrelatedShadowingPropagationLossModel::SaveGrids(const std::string& filename) const
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ofstream os(filename, std::ios::binary);
+    if (!os)
+    {
+        NS_LOG_WARN("Could not open " << filename << " for writing");
+        return;
+    }
+
+    auto count = uint32_t(m_shadowingGrid.size());
+    os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& [coordinates, shadowingMap] : m_shadowingGrid)
+    {
+        int32_t xcoord = coordinates.first;
+        int32_t ycoord = coordinates.second;
+        os.write(reinterpret_cast<const char*>(&xcoord), sizeof(xcoord));
+        os.write(reinterpret_cast<const char*>(&ycoord), sizeof(ycoord));
+        shadowingMap->Serialize(os);
+    }
+}
+
+bool
+CorrelatedShadowingPropagationLossModel::LoadGrids(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ifstream is(filename, std::ios::binary);
+    if (!is)
+    {
+        NS_LOG_WARN("Could not open " << filename << " for reading");
+        return false;
+    }
+
+    uint32_t count = 0;
+    is.read(reinterpret_cast<char*>(&count), sizeof(count));
+    for (uint32_t i = 0; i < count && is; i++)
+    {
+        int32_t xcoord = 0;
+        int32_t ycoord = 0;
+        is.read(reinterpret_cast<char*>(&xcoord), sizeof(xcoord));
+        is.read(reinterpret_cast<char*>(&ycoord), sizeof(ycoord));
+
+        Ptr<ShadowingMap> shadowingMap =
+            Create<CorrelatedShadowingPropagationLossModel::ShadowingMap>();
+        if (!shadowingMap->Deserialize(is))
+        {
+            NS_LOG_WARN("Truncated shadowing grid file " << filename);
+            return false;
+        }
+
+        m_shadowingGrid[std::make_pair(int(xcoord), int(ycoord))] = shadowingMap;
+    }
+
+    NS_LOG_INFO("Loaded " << m_shadowingGrid.size() << " shadowing grids from " << filename);
+    return true;
+}
+
 /*********************************
  *  ShadowingMap implementation  *
  *********************************/
@@ -126,7 +225,11 @@ const double CorrelatedShadowingPropagationLossModel::ShadowingMap::m_kInv[4][4]
     {-0.366414485833771, -0.0415206295795327, -0.366414485833771, 1.27968707244633}};
 
 CorrelatedShadowingPropagationLossModel::ShadowingMap::ShadowingMap()
-    : m_correlationDistance(110)
+    : m_correlationDistance(110),
+      m_gridColumns(0),
+      m_gridRows(0),
+      m_gridMinX(0),
+      m_gridMinY(0)
 {
     NS_LOG_FUNCTION_NOARGS();
 
@@ -148,6 +251,32 @@ CorrelatedShadowingPropagationLossModel::ShadowingMap::GetLoss(
 {
     NS_LOG_FUNCTION(this << position.x << position.y);
 
+    if (!m_grid.empty())
+    {
+        // Corner columns and rows sit m_correlationDistance apart; locate the
+        // square enclosing the queried position
+        double d = m_correlationDistance;
+        int ix = int(std::floor((position.x - m_gridMinX) / d));
+        int iy = int(std::floor((position.y - m_gridMinY) / d));
+
+        if (ix >= 0 && iy >= 0 && uint32_t(ix) + 1 < m_gridColumns && uint32_t(iy) + 1 < m_gridRows)
+        {
+            double xmin = m_gridMinX + ix * d;
+            double xmax = xmin + d;
+            double ymin = m_gridMinY + iy * d;
+            double ymax = ymin + d;
+
+            double q11 = m_grid[size_t(iy) * m_gridColumns + ix];
+            double q12 = m_grid[size_t(iy + 1) * m_gridColumns + ix];
+            double q21 = m_grid[size_t(iy) * m_gridColumns + ix + 1];
+            double q22 = m_grid[size_t(iy + 1) * m_gridColumns + ix + 1];
+
+            return Interpolate(position.x, position.y, xmin, xmax, ymin, ymax, q11, q12, q21, q22);
+        }
+
+        NS_LOG_DEBUG("Position outside the precomputed area, using the lazy path");
+    }
+
     // Verify whether this position is already in the shadowingMap. Since the
     // Position implementation overloads the == operator, this comparison
     // between doubles is ok and we can use std::map's find function.
@@ -203,36 +332,7 @@ CorrelatedShadowingPropagationLossModel::ShadowingMap::GetLoss(
 
         NS_LOG_DEBUG(q11 << " " << q12 << " " << q21 << " " << q22 << " ");
 
-        // The c matrix contains the positions of the 4 vertices
-        double c[2][4] = {{xmin, xmax, xmax, xmin}, {ymin, ymin, ymax, ymax}};
-
-        // For the following procedure, reference:
-        // S. Schlegel et al., "On the Interpolation of Data with Normally
-        // Distributed Uncertainty for Visualization", IEEE Transactions on
-        // Visualization and Computer Graphics, vol. 18, no. 12, Dec. 2012.
-
-        // Compute the phi coefficients
-        double phi1 = 0;
-        double phi2 = 0;
-        double phi3 = 0;
-        double phi4 = 0;
-
-        for (int j = 0; j < 4; j++)
-        {
-            double distance = sqrt((c[0][j] - x) * (c[0][j] - x) + (c[1][j] - y) * (c[1][j] - y));
-
-            NS_LOG_DEBUG("Distance: " << distance);
-
-            double k = std::exp(-distance / m_correlationDistance);
-            phi1 = phi1 + m_kInv[0][j] * k;
-            phi2 = phi2 + m_kInv[1][j] * k;
-            phi3 = phi3 + m_kInv[2][j] * k;
-            phi4 = phi4 + m_kInv[3][j] * k;
-        }
-
-        NS_LOG_DEBUG("Phi: " << phi1 << " " << phi2 << " " << phi3 << " " << phi4 << " ");
-
-        double shadowing = q11 * phi1 + q21 * phi2 + q22 * phi3 + q12 * phi4;
+        double shadowing = Interpolate(x, y, xmin, xmax, ymin, ymax, q11, q12, q21, q22);
 
         // Add the newly computed shadowing value to the shadowing map
         m_shadowingMap[position] = shadowing;
@@ -246,6 +346,110 @@ CorrelatedShadowingPropagationLossModel::ShadowingMap::GetLoss(
     return m_shadowingMap[position];
 }
 
+void
+CorrelatedShadowingPropagationLossModel::ShadowingMap::Precompute(double minX,
+                                                                 double minY,
+                                                                 double maxX,
+                                                                 double maxY)
+{
+    NS_LOG_FUNCTION(this << minX << minY << maxX << maxY);
+
+    // Grid corners sit at (k + 1/2) * m_correlationDistance; cover the bounds
+    // so that every query inside them has its 4 surrounding corners
+    double d = m_correlationDistance;
+    int kMinX = int(std::floor(minX / d - 0.5));
+    int kMinY = int(std::floor(minY / d - 0.5));
+    int kMaxX = int(std::ceil(maxX / d - 0.5));
+    int kMaxY = int(std::ceil(maxY / d - 0.5));
+
+    m_gridMinX = (kMinX + 0.5) * d;
+    m_gridMinY = (kMinY + 0.5) * d;
+    m_gridColumns = uint32_t(kMaxX - kMinX + 1);
+    m_gridRows = uint32_t(kMaxY - kMinY + 1);
+
+    m_grid.resize(size_t(m_gridColumns) * m_gridRows);
+    for (auto& value : m_grid)
+    {
+        value = m_shadowingValue->GetValue();
+    }
+
+    NS_LOG_DEBUG("Precomputed a " << m_gridColumns << "x" << m_gridRows
+                                  << " grid of shadowing corners");
+}
+
+void
+CorrelatedShadowingPropagationLossModel::ShadowingMap::Serialize(std::ostream& os) const
+{
+    os.write(reinterpret_cast<const char*>(&m_gridColumns), sizeof(m_gridColumns));
+    os.write(reinterpret_cast<const char*>(&m_gridRows), sizeof(m_gridRows));
+    os.write(reinterpret_cast<const char*>(&m_gridMinX), sizeof(m_gridMinX));
+    os.write(reinterpret_cast<const char*>(&m_gridMinY), sizeof(m_gridMinY));
+    os.write(reinterpret_cast<const char*>(m_grid.data()),
+             std::streamsize(m_grid.size() * sizeof(double)));
+}
+
+bool
+CorrelatedShadowingPropagationLossModel::ShadowingMap::Deserialize(std::istream& is)
+{
+    is.read(reinterpret_cast<char*>(&m_gridColumns), sizeof(m_gridColumns));
+    is.read(reinterpret_cast<char*>(&m_gridRows), sizeof(m_gridRows));
+    is.read(reinterpret_cast<char*>(&m_gridMinX), sizeof(m_gridMinX));
+    is.read(reinterpret_cast<char*>(&m_gridMinY), sizeof(m_gridMinY));
+    if (!is)
+    {
+        return false;
+    }
+
+    m_grid.resize(size_t(m_gridColumns) * m_gridRows);
+    is.read(reinterpret_cast<char*>(m_grid.data()),
+            std::streamsize(m_grid.size() * sizeof(double)));
+    return bool(is);
+}
+
+double
+CorrelatedShadowingPropagationLossModel::ShadowingMap::Interpolate(double x,
+                                                                   double y,
+                                                                   double xmin,
+                                                                   double xmax,
+                                                                   double ymin,
+                                                                   double ymax,
+                                                                   double q11,
+                                                                   double q12,
+                                                                   double q21,
+                                                                   double q22) const
+{
+    // The c matrix contains the positions of the 4 vertices
+    double c[2][4] = {{xmin, xmax, xmax, xmin}, {ymin, ymin, ymax, ymax}};
+
+    // For the following procedure, reference:
+    // S. Schlegel et al., "On the Interpolation of Data with Normally
+    // Distributed Uncertainty for Visualization", IEEE Transactions on
+    // Visualization and Computer Graphics, vol. 18, no. 12, Dec. 2012.
+
+    // Compute the phi coefficients
+    double phi1 = 0;
+    double phi2 = 0;
+    double phi3 = 0;
+    double phi4 = 0;
+
+    for (int j = 0; j < 4; j++)
+    {
+        double distance = sqrt((c[0][j] - x) * (c[0][j] - x) + (c[1][j] - y) * (c[1][j] - y));
+
+        NS_LOG_DEBUG("Distance: " << distance);
+
+        double k = std::exp(-distance / m_correlationDistance);
+        phi1 = phi1 + m_kInv[0][j] * k;
+        phi2 = phi2 + m_kInv[1][j] * k;
+        phi3 = phi3 + m_kInv[2][j] * k;
+        phi4 = phi4 + m_kInv[3][j] * k;
+    }
+
+    NS_LOG_DEBUG("Phi: " << phi1 << " " << phi2 << " " << phi3 << " " << phi4 << " ");
+
+    return q11 * phi1 + q21 * phi2 + q22 * phi3 + q12 * phi4;
+}
+
 /*****************************
  *  Position Implementation  *
  *****************************/
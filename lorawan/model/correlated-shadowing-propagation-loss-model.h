@@ -12,6 +12,9 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/vector.h"
 
+#include <iosfwd>
+#include <vector>
+
 namespace ns3
 {
 class MobilityModel;
@@ -104,7 +107,66 @@ class CorrelatedShadowingPropagationLossModel : public PropagationLossModel
          */
         double GetLoss(CorrelatedShadowingPropagationLossModel::Position position);
 
+        /**
+         * Generate the whole grid of corner shadowing values covering the
+         * given bounds up front.
+         *
+         * After this call, GetLoss answers queries inside the bounds with a
+         * few array reads and an interpolation, instead of going through the
+         * lazily-filled position map. Queries outside the bounds fall back to
+         * the lazy path.
+         *
+         * @param minX The lower x bound of the area to cover, in meters.
+         * @param minY The lower y bound of the area to cover, in meters.
+         * @param maxX The upper x bound of the area to cover, in meters.
+         * @param maxY The upper y bound of the area to cover, in meters.
+         */
+        void Precompute(double minX, double minY, double maxX, double maxY);
+
+        /**
+         * Write the precomputed grid to an output stream in binary form.
+         *
+         * @param os The stream to write to.
+         */
+        void Serialize(std::ostream& os) const;
+
+        /**
+         * Read a precomputed grid from an input stream, replacing the current
+         * one.
+         *
+         * @param is The stream to read from.
+         * @return True if a grid could be read, false otherwise.
+         */
+        bool Deserialize(std::istream& is);
+
       private:
+        /**
+         * Interpolate the shadowing value at (x, y) from the four corner
+         * values of the enclosing grid square.
+         *
+         * @param x The x coordinate of the queried position.
+         * @param y The y coordinate of the queried position.
+         * @param xmin The x coordinate of the left corners.
+         * @param xmax The x coordinate of the right corners.
+         * @param ymin The y coordinate of the lower corners.
+         * @param ymax The y coordinate of the upper corners.
+         * @param q11 The shadowing value at the lower left corner.
+         * @param q12 The shadowing value at the upper left corner.
+         * @param q21 The shadowing value at the lower right corner.
+         * @param q22 The shadowing value at the upper right corner.
+         * @return The interpolated shadowing value.
+         */
+        double Interpolate(double x,
+                           double y,
+                           double xmin,
+                           double xmax,
+                           double ymin,
+                           double ymax,
+                           double q11,
+                           double q12,
+                           double q21,
+                           double q22) const;
+
         /**
          * For each Position, this map gives a corresponding loss.
          * The map contains a basic grid that is initialized at construction
@@ -129,6 +191,17 @@ class CorrelatedShadowingPropagationLossModel : public PropagationLossModel
          * interpolating the vertices of a grid square.
          */
         static const double m_kInv[4][4];
+
+        /**
+         * The precomputed corner shadowing values, in row-major order, or an
+         * empty vector when this map runs in the lazy mode.
+         */
+        std::vector<double> m_grid;
+
+        uint32_t m_gridColumns; //!< Number of corner columns in the precomputed grid.
+        uint32_t m_gridRows;    //!< Number of corner rows in the precomputed grid.
+        double m_gridMinX;      //!< The x coordinate of the first corner column.
+        double m_gridMinY;      //!< The y coordinate of the first corner row.
     };
 
     /**
@@ -139,6 +212,24 @@ class CorrelatedShadowingPropagationLossModel : public PropagationLossModel
 
     CorrelatedShadowingPropagationLossModel(); //!< Default constructor
 
+    /**
+     * Save all shadowing grids generated so far to a binary file.
+     *
+     * Together with LoadGrids, this allows a run to reuse the shadowing field
+     * of a previous one instead of regenerating it.
+     *
+     * @param filename The path of the file to write.
+     */
+    void SaveGrids(const std::string& filename) const;
+
+    /**
+     * Load shadowing grids previously written by SaveGrids.
+     *
+     * @param filename The path of the file to read.
+     * @return True if the file could be read, false otherwise.
+     */
+    bool LoadGrids(const std::string& filename);
+
   private:
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
@@ -148,6 +239,12 @@ class CorrelatedShadowingPropagationLossModel : public PropagationLossModel
 
     double m_correlationDistance; //!< The correlation distance for the ShadowingMap
 
+    bool m_precomputeGrid; //!< Whether new ShadowingMaps precompute their whole grid up front.
+    double m_gridMinX;     //!< Lower x bound of the precomputed area, in meters.
+    double m_gridMinY;     //!< Lower y bound of the precomputed area, in meters.
+    double m_gridMaxX;     //!< Upper x bound of the precomputed area, in meters.
+    double m_gridMaxY;     //!< Upper y bound of the precomputed area, in meters.
+
     /**
      * Map linking a square to a ShadowingMap.
      * Each square of the shadowing grid has a corresponding ShadowingMap, and a
@@ -0,0 +1,90 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "device-registry.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("DeviceRegistry");
+
+std::vector<DeviceRegistry::Entry> DeviceRegistry::m_entries;
+std::vector<uint32_t> DeviceRegistry::m_indexByNode;
+std::unordered_map<uint32_t, uint32_t> DeviceRegistry::m_indexByAddress;
+bool DeviceRegistry::m_clearScheduled = false;
+
+uint32_t
+DeviceRegistry::Register(uint32_t nodeId, uint32_t deviceAddress)
+{
+    NS_LOG_FUNCTION(nodeId << deviceAddress);
+
+    if (!m_clearScheduled)
+    {
+        Simulator::ScheduleDestroy(&DeviceRegistry::Clear);
+        m_clearScheduled = true;
+    }
+
+    auto [it, inserted] = m_indexByAddress.try_emplace(deviceAddress, m_entries.size());
+    uint32_t index = it->second;
+    if (inserted)
+    {
+        m_entries.push_back(Entry{nodeId, deviceAddress});
+    }
+    else
+    {
+        m_entries[index].nodeId = nodeId;
+    }
+
+    if (nodeId >= m_indexByNode.size())
+    {
+        m_indexByNode.resize(nodeId + 1, INVALID_INDEX);
+    }
+    m_indexByNode[nodeId] = index;
+
+    return index;
+}
+
+uint32_t
+DeviceRegistry::IndexOfAddress(uint32_t deviceAddress)
+{
+    auto it = m_indexByAddress.find(deviceAddress);
+    return it != m_indexByAddress.end() ? it->second : INVALID_INDEX;
+}
+
+uint32_t
+DeviceRegistry::AddressOf(uint32_t index)
+{
+    return index < m_entries.size() ? m_entries[index].deviceAddress : 0;
+}
+
+uint32_t
+DeviceRegistry::NodeOf(uint32_t index)
+{
+    return index < m_entries.size() ? m_entries[index].nodeId : 0;
+}
+
+uint32_t
+DeviceRegistry::Count()
+{
+    return m_entries.size();
+}
+
+void
+DeviceRegistry::Clear()
+{
+    m_entries.clear();
+    m_entries.shrink_to_fit();
+    m_indexByNode.clear();
+    m_indexByNode.shrink_to_fit();
+    m_indexByAddress.clear();
+    m_clearScheduled = false;
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,121 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef DEVICE_REGISTRY_H
+#define DEVICE_REGISTRY_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Process-wide registry of end device identities.
+ *
+ * The module juggles three names for the same device — the ns-3 node id,
+ * the LoraDeviceAddress and its raw uint32 form — and the tracker, the
+ * statistics collector and the controller components each keep their own
+ * map to translate between them, paying a hashed or linear lookup per
+ * uplink. The registry assigns every end device a dense index at install
+ * time (LorawanMacHelper registers a device as soon as its address is
+ * drawn) and answers all three translations in O(1): by-index and by-node
+ * queries are flat array loads, by-address goes through one shared hash
+ * map. The index is small and contiguous, so per-device component state
+ * can live in plain arrays indexed by it.
+ *
+ * The registry is cleared at Simulator::Destroy so consecutive runs in one
+ * process (e.g. the test suites, which restart node ids from zero) never
+ * see stale entries.
+ */
+class DeviceRegistry
+{
+  public:
+    /// Index returned for devices that were never registered.
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    /**
+     * Register a device and assign it the next dense index. Registering an
+     * address again refreshes its node id and returns the existing index.
+     *
+     * @param nodeId The device's node id.
+     * @param deviceAddress The device's address as a raw integer.
+     * @return The dense index assigned to the device.
+     */
+    static uint32_t Register(uint32_t nodeId, uint32_t deviceAddress);
+
+    /**
+     * Get the dense index of a device by its raw address.
+     *
+     * @param deviceAddress The device's address as a raw integer.
+     * @return The device's index, or INVALID_INDEX if never registered.
+     */
+    static uint32_t IndexOfAddress(uint32_t deviceAddress);
+
+    /**
+     * Get the dense index of a device by its node id.
+     *
+     * @param nodeId The device's node id.
+     * @return The device's index, or INVALID_INDEX if never registered.
+     */
+    static uint32_t IndexOfNode(uint32_t nodeId)
+    {
+        return nodeId < m_indexByNode.size() ? m_indexByNode[nodeId] : INVALID_INDEX;
+    }
+
+    /**
+     * Get the raw device address of a registered device.
+     *
+     * @param index The device's dense index.
+     * @return The raw address, or 0 for an invalid index.
+     */
+    static uint32_t AddressOf(uint32_t index);
+
+    /**
+     * Get the node id of a registered device.
+     *
+     * @param index The device's dense index.
+     * @return The node id, or 0 for an invalid index.
+     */
+    static uint32_t NodeOf(uint32_t index);
+
+    /**
+     * Get the number of registered devices. Dense indices run from 0 to
+     * this value (excluded), so it is the size to allocate for per-device
+     * state arrays.
+     *
+     * @return The number of registered devices.
+     */
+    static uint32_t Count();
+
+    /**
+     * Drop all registrations. Scheduled at Simulator::Destroy by
+     * Register(); callers rebuilding a topology mid-run can also invoke it
+     * directly.
+     */
+    static void Clear();
+
+  private:
+    /// The identities of one registered device.
+    struct Entry
+    {
+        uint32_t nodeId;        //!< The device's node id
+        uint32_t deviceAddress; //!< The device's address as a raw integer
+    };
+
+    static std::vector<Entry> m_entries;          //!< Identities, indexed by dense index
+    static std::vector<uint32_t> m_indexByNode;   //!< Dense index, indexed by node id
+    static std::unordered_map<uint32_t, uint32_t> m_indexByAddress; //!< Dense index by address
+    static bool m_clearScheduled; //!< Whether Clear() is pending at destroy time
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif /* DEVICE_REGISTRY_H */
@@ -10,6 +10,7 @@
 
 #include "lora-tag.h"
 
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 
@@ -39,6 +40,14 @@ EndDeviceLoraPhy::GetTypeId()
         TypeId("ns3::EndDeviceLoraPhy")
             .SetParent<LoraPhy>()
             .SetGroupName("lorawan")
+            .AddAttribute("DeregisterWhenSleeping",
+                          "Whether this PHY notifies the channel that it is not listening "
+                          "while in the SLEEP state, so that the channel skips it entirely "
+                          "when delivering transmissions. Skipped transmissions are not "
+                          "recorded as interference either.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&EndDeviceLoraPhy::m_deregisterWhenSleeping),
+                          MakeBooleanChecker())
             .AddTraceSource("LostPacketBecauseWrongFrequency",
                             "Trace source indicating a packet "
                             "could not be correctly decoded because"
@@ -63,7 +72,8 @@ EndDeviceLoraPhy::GetTypeId()
 EndDeviceLoraPhy::EndDeviceLoraPhy()
     : m_state(SLEEP),
       m_frequencyHz(868100000),
-      m_sf(7)
+      m_sf(7),
+      m_deregisterWhenSleeping(false)
 {
 }
 
@@ -71,11 +81,6 @@ EndDeviceLoraPhy::~EndDeviceLoraPhy()
 {
 }
 
-// Downlink sensitivity (from SX1272 datasheet)
-// {SF7, SF8, SF9, SF10, SF11, SF12}
-// These sensitivities are for a bandwidth of 125000 Hz
-const double EndDeviceLoraPhy::sensitivity[6] = {-124, -127, -130, -133, -135, -137};
-
 void
 EndDeviceLoraPhy::SetSpreadingFactor(uint8_t sf)
 {
@@ -104,6 +109,12 @@ void
 EndDeviceLoraPhy::SetFrequency(uint32_t frequencyHz)
 {
     m_frequencyHz = frequencyHz;
+
+    // Keep the channel's per-frequency delivery lists up to date
+    if (m_channel)
+    {
+        m_channel->SubscribeToFrequency(this, frequencyHz);
+    }
 }
 
 void
@@ -127,6 +138,12 @@ EndDeviceLoraPhy::SwitchToStandby()
 
     m_state = STANDBY;
 
+    // Resubscribe to the channel's delivery path
+    if (m_deregisterWhenSleeping && m_channel)
+    {
+        m_channel->SetListening(this, true);
+    }
+
     // Notify listeners of the state change
     for (auto i = m_listeners.begin(); i != m_listeners.end(); i++)
     {
@@ -175,6 +192,13 @@ EndDeviceLoraPhy::SwitchToSleep()
 
     m_state = SLEEP;
 
+    // A sleeping radio cannot lock on packets: take it off the channel's
+    // delivery path so it does not cost a reception event per transmission
+    if (m_deregisterWhenSleeping && m_channel)
+    {
+        m_channel->SetListening(this, false);
+    }
+
     // Notify listeners of the state change
     for (auto i = m_listeners.begin(); i != m_listeners.end(); i++)
     {
@@ -12,6 +12,7 @@
 #define END_DEVICE_LORA_PHY_H
 
 #include "lora-phy.h"
+#include "lora-radio-tables.h"
 
 #include "ns3/mobility-model.h"
 #include "ns3/net-device.h"
@@ -223,7 +224,12 @@ class EndDeviceLoraPhy : public LoraPhy
      */
     void UnregisterListener(EndDeviceLoraPhyListener* listener);
 
-    static const double sensitivity[6]; //!< The sensitivity vector of this device to different SFs
+    /**
+     * The sensitivity of this device to the different SFs, indexed by
+     * SF minus 7. An alias of the module-wide constexpr table so the PHY
+     * and the ADR logic can never disagree on the values.
+     */
+    static constexpr std::array<double, 6> sensitivity = END_DEVICE_SENSITIVITY_DBM;
 
   protected:
     /**
@@ -277,6 +283,13 @@ class EndDeviceLoraPhy : public LoraPhy
     typedef std::vector<EndDeviceLoraPhyListener*>::iterator ListenersI;
 
     Listeners m_listeners; //!< PHY listeners
+
+    /**
+     * Whether this PHY tells the channel it is not listening while in the
+     * SLEEP state, so that the channel does not schedule reception events on
+     * it at all.
+     */
+    bool m_deregisterWhenSleeping;
 };
 
 } // namespace lorawan
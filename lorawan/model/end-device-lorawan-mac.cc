@@ -113,6 +113,8 @@ EndDeviceLorawanMac::EndDeviceLorawanMac()
       // Max initial value
       m_lastRxSnr(32),
       m_adr(true),
+      m_txChannelCycleIndex(0),
+      m_txChannelCycleDirty(true),
       m_lastKnownLinkMarginDb(0),
       m_lastKnownGatewayCount(0),
       m_aggregatedDutyCycle(1),
@@ -254,6 +256,7 @@ EndDeviceLorawanMac::DoSend(Ptr<Packet> packet)
             m_retxParams.retxLeft = m_nbTrans;
             m_retxParams.waitingAck = true;
             m_retxParams.firstAttempt = Now();
+            m_retxParams.headerFCnt = m_currentFCnt;
             m_retxParams.retxLeft =
                 m_retxParams.retxLeft - 1; // decreasing the number of retransmissions
 
@@ -283,24 +286,35 @@ EndDeviceLorawanMac::DoSend(Ptr<Packet> packet)
     {
         if (m_retxParams.waitingAck)
         {
-            // Remove the headers
-            LorawanMacHeader macHdr;
-            LoraFrameHeader frameHdr;
-            packet->RemoveHeader(macHdr);
-            packet->RemoveHeader(frameHdr);
-
-            // Add the Lora Frame Header to the packet
-            frameHdr = LoraFrameHeader();
-            ApplyNecessaryOptions(frameHdr);
-            packet->AddHeader(frameHdr);
-
-            auto fhdrSize = frameHdr.GetSerializedSize();
-            NS_LOG_INFO("Added frame header of size " << fhdrSize << " bytes.");
-
-            // Add the Lorawan Mac header to the packet
-            macHdr = LorawanMacHeader();
-            ApplyNecessaryOptions(macHdr);
-            packet->AddHeader(macHdr);
+            // The saved packet already carries fully serialized headers: only
+            // rebuild them if their content would change, i.e. if the frame
+            // counter moved or MAC commands are waiting to be piggybacked
+            if (!m_macCommandList.empty() || m_retxParams.headerFCnt != m_currentFCnt)
+            {
+                // Remove the headers
+                LorawanMacHeader macHdr;
+                LoraFrameHeader frameHdr;
+                packet->RemoveHeader(macHdr);
+                packet->RemoveHeader(frameHdr);
+
+                // Add the Lora Frame Header to the packet
+                frameHdr = LoraFrameHeader();
+                ApplyNecessaryOptions(frameHdr);
+                packet->AddHeader(frameHdr);
+
+                auto fhdrSize = frameHdr.GetSerializedSize();
+                NS_LOG_INFO("Added frame header of size " << fhdrSize << " bytes.");
+
+                // Add the Lorawan Mac header to the packet
+                macHdr = LorawanMacHeader();
+                ApplyNecessaryOptions(macHdr);
+                packet->AddHeader(macHdr);
+                m_retxParams.headerFCnt = m_currentFCnt;
+            }
+            else
+            {
+                NS_LOG_DEBUG("Reusing the serialized frame of the previous attempt.");
+            }
             m_retxParams.retxLeft =
                 m_retxParams.retxLeft - 1; // decreasing the number of retransmissions
             NS_LOG_DEBUG("Retransmitting an old packet.");
@@ -483,56 +497,63 @@ Time
 EndDeviceLorawanMac::GetNextTransmissionDelay()
 {
     NS_LOG_FUNCTION(this);
-    // Check duty cycle
-    /// @todo possibly move to LogicalChannelHelper
-    auto waitTime = Time::Max();
+    // Check duty cycle: the channel helper keeps sub-bands sorted by
+    // availability, so one query replaces the per-channel scan
+    return GetNextClassTransmissionDelay(m_channelHelper->GetMinWaitTime());
+}
+
+void
+EndDeviceLorawanMac::RebuildTxChannelCycle()
+{
+    NS_LOG_FUNCTION(this);
+    m_txChannelCycle.clear();
     for (const auto& channel : m_channelHelper->GetRawChannelArray())
     {
         if (channel && channel->IsEnabledForUplink()) // Skip empty frequency channel slots
         {
-            auto curr = m_channelHelper->GetWaitTime(channel);
-            if (curr < waitTime)
+            uint8_t minDr = channel->GetMinimumDataRate();
+            uint8_t maxDr = channel->GetMaximumDataRate();
+            NS_LOG_DEBUG("Enabled channel: frequency=" << channel->GetFrequency()
+                                                       << " Hz, minDr=" << unsigned(minDr)
+                                                       << ", maxDr=" << unsigned(maxDr));
+            if (m_dataRate >= minDr && m_dataRate <= maxDr)
             {
-                waitTime = curr;
+                m_txChannelCycle.emplace_back(channel);
             }
-            NS_LOG_DEBUG("frequency=" << channel->GetFrequency() << "Hz,"
-                                      << " waitTime=" << waitTime.As(Time::S));
         }
     }
-    return GetNextClassTransmissionDelay(waitTime);
+    // Fisher-Yates shuffle, so each device walks the eligible channels in its
+    // own pseudo-random order without re-randomizing per transmission
+    for (size_t i = m_txChannelCycle.size(); i > 1; i--)
+    {
+        std::swap(m_txChannelCycle[i - 1], m_txChannelCycle[m_uniformRV->GetInteger(0, i - 1)]);
+    }
+    m_txChannelCycleIndex = 0;
+    m_txChannelCycleDirty = false;
 }
 
 Ptr<LogicalLoraChannel>
 EndDeviceLorawanMac::GetChannelForTx()
 {
     NS_LOG_FUNCTION(this);
-    /// @todo possibly move to LogicalChannelHelper
-    std::vector<Ptr<LogicalLoraChannel>> candidates;
-    for (const auto& channel : m_channelHelper->GetRawChannelArray())
+    if (m_txChannelCycleDirty)
     {
-        if (channel && channel->IsEnabledForUplink()) // Skip empty frequency channel slots
-        {
-            uint8_t minDr = channel->GetMinimumDataRate();
-            uint8_t maxDr = channel->GetMaximumDataRate();
-            Time waitTime = m_channelHelper->GetWaitTime(channel);
-            NS_LOG_DEBUG("Enabled channel: frequency="
-                         << channel->GetFrequency() << " Hz, minDr=" << unsigned(minDr)
-                         << ", maxDr=" << unsigned(maxDr) << ", waitTime=" << waitTime.As(Time::S));
-            if (m_dataRate >= minDr && m_dataRate <= maxDr && waitTime.IsZero())
-            {
-                candidates.emplace_back(channel);
-            }
-        }
+        RebuildTxChannelCycle();
     }
-    if (candidates.empty())
+    // Advance the rotation cycle, settling on the first channel that is not
+    // blocked by duty cycle; give up after one full revolution
+    for (size_t scanned = 0; scanned < m_txChannelCycle.size(); scanned++)
     {
-        NS_LOG_DEBUG("No suitable TX channel found");
-        return nullptr;
+        const auto& channel = m_txChannelCycle[m_txChannelCycleIndex];
+        m_txChannelCycleIndex = (m_txChannelCycleIndex + 1) % m_txChannelCycle.size();
+        if (m_channelHelper->GetWaitTime(channel).IsZero())
+        {
+            NS_LOG_DEBUG("Selected channel with frequency=" << channel->GetFrequency() << " Hz");
+            return channel;
+        }
     }
-    uint8_t i = m_uniformRV->GetInteger(0, candidates.size() - 1);
-    auto channel = candidates.at(i);
-    NS_LOG_DEBUG("Selected channel with frequency=" << channel->GetFrequency() << " Hz");
-    return channel;
+    NS_LOG_DEBUG("No suitable TX channel found");
+    return nullptr;
 }
 
 /////////////////////////
@@ -585,7 +606,11 @@ EndDeviceLorawanMac::SetDataRate(uint8_t dataRate)
 {
     NS_LOG_FUNCTION(this << unsigned(dataRate));
 
-    m_dataRate = dataRate;
+    if (dataRate != m_dataRate)
+    {
+        m_dataRate = dataRate;
+        m_txChannelCycleDirty = true;
+    }
 }
 
 uint8_t
@@ -610,6 +635,15 @@ EndDeviceLorawanMac::GetTransmissionPowerDbm()
     return m_txPowerDbm;
 }
 
+int64_t
+EndDeviceLorawanMac::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+
+    m_uniformRV->SetStream(stream);
+    return 1;
+}
+
 void
 EndDeviceLorawanMac::SetDeviceAddress(LoraDeviceAddress address)
 {
@@ -618,6 +652,20 @@ EndDeviceLorawanMac::SetDeviceAddress(LoraDeviceAddress address)
     m_address = address;
 }
 
+uint16_t
+EndDeviceLorawanMac::GetFrameCounter() const
+{
+    return m_currentFCnt;
+}
+
+void
+EndDeviceLorawanMac::SetFrameCounter(uint16_t fCnt)
+{
+    NS_LOG_FUNCTION(this << fCnt);
+
+    m_currentFCnt = fCnt;
+}
+
 LoraDeviceAddress
 EndDeviceLorawanMac::GetDeviceAddress()
 {
@@ -726,6 +774,9 @@ EndDeviceLorawanMac::OnLinkAdrReq(uint8_t dataRate,
             }
             else // apply channel mask configuration
             {
+                // Get a private plan copy before editing channels in place
+                m_channelHelper->Detach();
+                channels = m_channelHelper->GetRawChannelArray();
                 for (size_t i = 0; i < channels.size(); ++i)
                 {
                     if (auto c = channels.at(i); c)
@@ -792,6 +843,9 @@ EndDeviceLorawanMac::OnLinkAdrReq(uint8_t dataRate,
         // If no error, apply configurations
         if (channelMaskAck && dataRateAck && powerAck)
         {
+            // Get a private plan copy before editing channels in place
+            m_channelHelper->Detach();
+            channels = m_channelHelper->GetRawChannelArray();
             for (size_t i = 0; i < channels.size(); ++i)
             {
                 if (auto c = channels.at(i); c)
@@ -814,6 +868,9 @@ EndDeviceLorawanMac::OnLinkAdrReq(uint8_t dataRate,
         }
     }
 
+    // Channel mask and/or data rate may have changed
+    m_txChannelCycleDirty = true;
+
     NS_LOG_INFO("Adding LinkAdrAns reply");
     m_macCommandList.emplace_back(Create<LinkAdrAns>(powerAck, dataRateAck, channelMaskAck));
 }
@@ -914,6 +971,7 @@ EndDeviceLorawanMac::OnNewChannelReq(uint8_t chIndex,
         auto channel = Create<LogicalLoraChannel>(frequencyHz, minDataRate, maxDataRate);
         (frequencyHz == 0) ? channel->DisableForUplink() : channel->EnableForUplink();
         m_channelHelper->SetChannel(chIndex, channel);
+        m_txChannelCycleDirty = true;
         NS_LOG_DEBUG("MacTxFrequency[" << unsigned(chIndex) << "]=" << frequencyHz
                                        << ", DrMin=" << unsigned(minDataRate)
                                        << ", DrMax=" << unsigned(maxDataRate));
@@ -162,6 +162,29 @@ class EndDeviceLorawanMac : public LorawanMac
      */
     void SetTransmissionPowerDbm(double txPowerDbm);
 
+    /**
+     * Get the current value of the uplink frame counter.
+     *
+     * @return The frame counter of the next uplink.
+     */
+    uint16_t GetFrameCounter() const;
+
+    /**
+     * Set the uplink frame counter, e.g. when restoring device state from a
+     * checkpoint.
+     *
+     * @param fCnt The frame counter to continue from.
+     */
+    void SetFrameCounter(uint16_t fCnt);
+
+    /**
+     * Set the fixed stream numbers of this MAC's random variables.
+     *
+     * @param stream The first stream index to use.
+     * @return The number of stream indices consumed.
+     */
+    int64_t AssignStreams(int64_t stream);
+
     /**
      * Set the network address of this device.
      *
@@ -325,6 +348,7 @@ class EndDeviceLorawanMac : public LorawanMac
         Ptr<Packet> packet = nullptr; //!< A pointer to the packet being retransmitted
         bool waitingAck = false;      //!< Whether the packet requires explicit acknowledgment
         uint8_t retxLeft;             //!< Number of retransmission attempts left
+        uint16_t headerFCnt = 0;      //!< Frame counter the packet's headers were built with
     };
 
     bool
@@ -356,6 +380,18 @@ class EndDeviceLorawanMac : public LorawanMac
      */
     Ptr<LogicalLoraChannel> GetChannelForTx();
 
+    /**
+     * Rebuild the precomputed channel rotation cycle.
+     *
+     * The cycle holds the channels that are enabled for uplink and compatible
+     * with the current data rate, in a pseudo-random order drawn once from
+     * m_uniformRV. It is invalidated (and lazily rebuilt on the next
+     * transmission) whenever the channel plan or the data rate changes, so
+     * per-uplink channel choice reduces to advancing an index instead of
+     * re-filtering and re-randomizing the whole channel array.
+     */
+    void RebuildTxChannelCycle();
+
     /**
      * The duration of a receive window in number of symbols. This should be
      * converted to time based or the reception parameter used.
@@ -370,8 +406,12 @@ class EndDeviceLorawanMac : public LorawanMac
 
     /**
      * List of the MAC commands that need to be applied to the next UL packet.
+     *
+     * Kept as a vector: real frames carry at most a handful of commands, and
+     * the storage is reused across uplinks since clear() keeps the capacity,
+     * avoiding the per-command node allocations of a linked list.
      */
-    std::list<Ptr<MacCommand>> m_macCommandList;
+    std::vector<Ptr<MacCommand>> m_macCommandList;
 
     /**
      * Structure containing the retransmission parameters for this device.
@@ -428,6 +468,20 @@ class EndDeviceLorawanMac : public LorawanMac
      */
     EventId m_nextRetx;
 
+    /**
+     * Precomputed pseudo-random rotation cycle over the channels usable for
+     * uplink at the current data rate. See RebuildTxChannelCycle.
+     */
+    std::vector<Ptr<LogicalLoraChannel>> m_txChannelCycle;
+
+    size_t m_txChannelCycleIndex; //!< Next position in m_txChannelCycle.
+
+    /**
+     * Whether m_txChannelCycle is stale and must be rebuilt before use. Set
+     * at construction and whenever the channel plan or data rate changes.
+     */
+    bool m_txChannelCycleDirty;
+
     /**
      * The last known link margin in dB from the demodulation floor.
      *
@@ -10,6 +10,7 @@
 #include "end-device-status.h"
 
 #include "lora-frame-header.h"
+#include "lora-packet-pool.h"
 #include "lora-tag.h"
 #include "lorawan-mac-header.h"
 
@@ -18,8 +19,12 @@
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 namespace ns3
 {
@@ -34,7 +39,14 @@ EndDeviceStatus::GetTypeId()
     static TypeId tid = TypeId("ns3::EndDeviceStatus")
                             .SetParent<Object>()
                             .AddConstructor<EndDeviceStatus>()
-                            .SetGroupName("lorawan");
+                            .SetGroupName("lorawan")
+                            .AddAttribute("MaxReceivedPackets",
+                                          "Maximum number of entries kept in the received packet "
+                                          "list, 0 for unlimited. Keep this above the ADR history "
+                                          "range when bounding it",
+                                          UintegerValue(0),
+                                          MakeUintegerAccessor(&EndDeviceStatus::m_maxReceivedPackets),
+                                          MakeUintegerChecker<uint32_t>());
     return tid;
 }
 
@@ -42,19 +54,20 @@ EndDeviceStatus::EndDeviceStatus(LoraDeviceAddress endDeviceAddress,
                                  Ptr<ClassAEndDeviceLorawanMac> endDeviceMac)
     : m_reply(EndDeviceStatus::Reply()),
       m_endDeviceAddress(endDeviceAddress),
-      m_receivedPacketList(ReceivedPacketList()),
-      m_mac(endDeviceMac)
+      m_cold(std::make_unique<ColdState>())
 {
     NS_LOG_FUNCTION(endDeviceAddress);
+
+    m_cold->mac = endDeviceMac;
 }
 
 EndDeviceStatus::EndDeviceStatus()
+    : m_cold(std::make_unique<ColdState>())
 {
     NS_LOG_FUNCTION_NOARGS();
 
     // Initialize data structure
     m_reply = EndDeviceStatus::Reply();
-    m_receivedPacketList = ReceivedPacketList();
 }
 
 EndDeviceStatus::~EndDeviceStatus()
@@ -62,6 +75,35 @@ EndDeviceStatus::~EndDeviceStatus()
     NS_LOG_FUNCTION_NOARGS();
 }
 
+std::pair<EndDeviceStatus::GatewayList::iterator, bool>
+EndDeviceStatus::GatewayList::insert(value_type entry)
+{
+    for (auto it = begin(); it != end(); ++it)
+    {
+        if (it->first == entry.first)
+        {
+            return {it, false};
+        }
+    }
+    if (m_overflow.empty() && m_size < INLINE_CAPACITY)
+    {
+        m_inline[m_size] = std::move(entry);
+    }
+    else
+    {
+        if (m_overflow.empty())
+        {
+            // First spill: move the inline entries to the heap in one go
+            m_overflow.reserve(2 * INLINE_CAPACITY);
+            m_overflow.assign(std::make_move_iterator(m_inline.begin()),
+                              std::make_move_iterator(m_inline.end()));
+        }
+        m_overflow.push_back(std::move(entry));
+    }
+    m_size++;
+    return {end() - 1, true};
+}
+
 ///////////////
 //  Getters  //
 ///////////////
@@ -102,6 +144,20 @@ EndDeviceStatus::GetCompleteReplyPacket()
 {
     NS_LOG_FUNCTION_NOARGS();
 
+    // Pull in whatever pending MAC commands fit this downlink's FOpts
+    FlushPendingMacCommands();
+
+    // The frame counter to acknowledge comes from the last uplink
+    uint16_t fCnt = LoraFrameHeader::PeekFields(GetLastPacketReceivedFromDevice()).fCnt;
+
+    // Reuse the bytes assembled for a previous attempt (typically the first
+    // receive window) if nothing changed since
+    if (!m_replyDirty && m_cachedReplyPacket && m_cachedReplyFCnt == fCnt)
+    {
+        NS_LOG_DEBUG("Reusing the reply packet assembled for the previous attempt");
+        return m_cachedReplyPacket->Copy();
+    }
+
     // Start from reply payload
     Ptr<Packet> replyPacket;
     if (m_reply.payload) // If it has APP data to send
@@ -112,18 +168,12 @@ EndDeviceStatus::GetCompleteReplyPacket()
     else // If no APP data needs to be sent, use an empty payload
     {
         NS_LOG_DEBUG("Crafting reply packet using an empty payload");
-        replyPacket = Create<Packet>(0);
+        replyPacket = LoraPacketPool::CreatePacket(0);
     }
 
     // Add headers
     m_reply.frameHeader.SetAddress(m_endDeviceAddress);
-    Ptr<Packet> lastPacket = GetLastPacketReceivedFromDevice()->Copy();
-    LorawanMacHeader mHdr;
-    LoraFrameHeader fHdr;
-    fHdr.SetAsUplink();
-    lastPacket->RemoveHeader(mHdr);
-    lastPacket->RemoveHeader(fHdr);
-    m_reply.frameHeader.SetFCnt(fHdr.GetFCnt());
+    m_reply.frameHeader.SetFCnt(fCnt);
     m_reply.macHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
     replyPacket->AddHeader(m_reply.frameHeader);
     replyPacket->AddHeader(m_reply.macHeader);
@@ -131,7 +181,13 @@ EndDeviceStatus::GetCompleteReplyPacket()
     NS_LOG_DEBUG("Added MAC header" << m_reply.macHeader);
     NS_LOG_DEBUG("Added frame header" << m_reply.frameHeader);
 
-    return replyPacket;
+    // Cache the assembled reply; the caller receives a copy so packet tags
+    // added downstream do not end up in the cache
+    m_cachedReplyPacket = replyPacket;
+    m_cachedReplyFCnt = fCnt;
+    m_replyDirty = false;
+
+    return replyPacket->Copy();
 }
 
 bool
@@ -139,17 +195,18 @@ EndDeviceStatus::NeedsReply() const
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    return m_reply.needsReply;
+    // Leftover coalesced commands justify a downlink on their own
+    return m_reply.needsReply || !m_cold->pendingMacCommands.empty();
 }
 
-LorawanMacHeader
+const LorawanMacHeader&
 EndDeviceStatus::GetReplyMacHeader() const
 {
     NS_LOG_FUNCTION_NOARGS();
     return m_reply.macHeader;
 }
 
-LoraFrameHeader
+const LoraFrameHeader&
 EndDeviceStatus::GetReplyFrameHeader() const
 {
     NS_LOG_FUNCTION_NOARGS();
@@ -166,14 +223,14 @@ EndDeviceStatus::GetReplyPayload()
 Ptr<ClassAEndDeviceLorawanMac>
 EndDeviceStatus::GetMac()
 {
-    return m_mac;
+    return m_cold->mac;
 }
 
-EndDeviceStatus::ReceivedPacketList
+const EndDeviceStatus::ReceivedPacketList&
 EndDeviceStatus::GetReceivedPacketList() const
 {
     NS_LOG_FUNCTION_NOARGS();
-    return m_receivedPacketList;
+    return m_cold->receivedPacketList;
 }
 
 void
@@ -209,6 +266,7 @@ EndDeviceStatus::SetReplyMacHeader(LorawanMacHeader macHeader)
 {
     NS_LOG_FUNCTION_NOARGS();
     m_reply.macHeader = macHeader;
+    m_replyDirty = true;
 }
 
 void
@@ -216,6 +274,7 @@ EndDeviceStatus::SetReplyFrameHeader(LoraFrameHeader frameHeader)
 {
     NS_LOG_FUNCTION_NOARGS();
     m_reply.frameHeader = frameHeader;
+    m_replyDirty = true;
 }
 
 void
@@ -223,6 +282,7 @@ EndDeviceStatus::SetReplyPayload(Ptr<Packet> replyPayload)
 {
     NS_LOG_FUNCTION_NOARGS();
     m_reply.payload = replyPayload;
+    m_replyDirty = true;
 }
 
 ///////////////////////
@@ -234,52 +294,37 @@ EndDeviceStatus::InsertReceivedPacket(Ptr<const Packet> receivedPacket, const Ad
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    // Create a copy of the packet
-    Ptr<Packet> myPacket = receivedPacket->Copy();
-
-    // Extract the headers
-    LorawanMacHeader macHdr;
-    myPacket->RemoveHeader(macHdr);
-
-    LoraFrameHeader frameHdr;
-    frameHdr.SetAsUplink();
-    myPacket->RemoveHeader(frameHdr);
+    // Peek the frame counter in place, without copying the packet or
+    // deserializing its headers
+    uint16_t fCnt = LoraFrameHeader::PeekFields(receivedPacket).fCnt;
 
     // Update current parameters
     LoraTag tag;
-    myPacket->RemovePacketTag(tag);
+    receivedPacket->PeekPacketTag(tag);
     SetFirstReceiveWindowSpreadingFactor(tag.GetSpreadingFactor());
     SetFirstReceiveWindowFrequency(tag.GetFrequency());
 
-    // Update Information on the received packet
-    ReceivedPacketInfo info;
-    info.sf = tag.GetSpreadingFactor();
-    info.frequencyHz = tag.GetFrequency();
-    info.packet = receivedPacket;
-
     double rcvPower = tag.GetReceivePower();
 
     // Perform insertion in list, also checking that the packet isn't already in
-    // the list (it could have been already received by another gateway)
+    // the list (it could have been already received by another gateway).
+    // The frame counter index answers the "already seen?" question in two
+    // integer compares, so first receptions (the common case) skip the list
+    // scan entirely
 
     // Start searching from the end
-    auto it = m_receivedPacketList.rbegin();
-    for (; it != m_receivedPacketList.rend(); it++)
+    auto it = WasFCntSeen(fCnt) ? m_cold->receivedPacketList.rbegin() : m_cold->receivedPacketList.rend();
+    for (; it != m_cold->receivedPacketList.rend(); it++)
     {
         // Get the frame counter of the current packet to compare it with the
         // newly received one
-        Ptr<Packet> packetCopy = ((*it).first)->Copy();
-        LorawanMacHeader currentMacHdr;
-        packetCopy->RemoveHeader(currentMacHdr);
-        LoraFrameHeader currentFrameHdr;
-        frameHdr.SetAsUplink();
-        packetCopy->RemoveHeader(currentFrameHdr);
-
-        NS_LOG_DEBUG("Received packet's frame counter: " << unsigned(frameHdr.GetFCnt())
+        uint16_t currentFCnt = LoraFrameHeader::PeekFields(it->first).fCnt;
+
+        NS_LOG_DEBUG("Received packet's frame counter: " << unsigned(fCnt)
                                                          << "\nCurrent packet's frame counter: "
-                                                         << unsigned(currentFrameHdr.GetFCnt()));
+                                                         << unsigned(currentFCnt));
 
-        if (frameHdr.GetFCnt() == currentFrameHdr.GetFCnt())
+        if (fCnt == currentFCnt)
         {
             NS_LOG_INFO("Packet was already received by another gateway");
 
@@ -287,51 +332,115 @@ EndDeviceStatus::InsertReceivedPacket(Ptr<const Packet> receivedPacket, const Ad
             // add this gateway's reception information.
             GatewayList& gwList = it->second.gwList;
 
-            PacketInfoPerGw gwInfo;
-            gwInfo.receivedTime = Now();
-            gwInfo.rxPower = rcvPower;
-            gwInfo.gwAddress = gwAddress;
-            gwList.insert(std::pair<Address, PacketInfoPerGw>(gwAddress, gwInfo));
+            // Built as a temporary and moved all the way into the list slot
+            gwList.insert({gwAddress, PacketInfoPerGw{gwAddress, Now(), rcvPower}});
 
             NS_LOG_DEBUG("Size of gateway list: " << gwList.size());
 
+            // Keep the by-power gateway index of the last packet up to date
+            if (it == m_cold->receivedPacketList.rbegin())
+            {
+                auto pos = std::lower_bound(
+                    m_lastPacketGatewaysByPower.begin(),
+                    m_lastPacketGatewaysByPower.end(),
+                    rcvPower,
+                    [](const auto& entry, double power) { return entry.first < power; });
+                m_lastPacketGatewaysByPower.emplace(pos, rcvPower, gwAddress);
+            }
+
             break; // Exit from the cycle
         }
     }
-    if (it == m_receivedPacketList.rend())
+    if (it == m_cold->receivedPacketList.rend())
     {
         NS_LOG_INFO("Packet was received for the first time");
-        PacketInfoPerGw gwInfo;
-        gwInfo.receivedTime = Now();
-        gwInfo.rxPower = rcvPower;
-        gwInfo.gwAddress = gwAddress;
-        info.gwList.insert(std::pair<Address, PacketInfoPerGw>(gwAddress, gwInfo));
-        m_receivedPacketList.emplace_back(receivedPacket, info);
+
+        // Emplace the record and fill it in place, so neither the info
+        // struct nor its gateway list is ever copied into the history
+        auto& record = m_cold->receivedPacketList.emplace_back(receivedPacket, ReceivedPacketInfo{});
+        ReceivedPacketInfo& info = record.second;
+        info.packet = receivedPacket;
+        info.sf = tag.GetSpreadingFactor();
+        info.frequencyHz = tag.GetFrequency();
+        info.gwList.insert({gwAddress, PacketInfoPerGw{gwAddress, Now(), rcvPower}});
+
+        // A new packet resets the by-power gateway index
+        m_lastPacketGatewaysByPower.clear();
+        m_lastPacketGatewaysByPower.emplace_back(rcvPower, gwAddress);
+
+        // Advance the frame counter index
+        if (!m_anyFCntSeen)
+        {
+            m_anyFCntSeen = true;
+            m_lastSeenFCnt = fCnt;
+            m_fCntReorderBitmap = 1;
+        }
+        else
+        {
+            uint16_t ahead = static_cast<uint16_t>(fCnt - m_lastSeenFCnt);
+            if (ahead != 0 && ahead < 0x8000)
+            {
+                // Newer counter: shift the window along
+                m_fCntReorderBitmap = (ahead < 32) ? (m_fCntReorderBitmap << ahead) | 1 : 1;
+                m_lastSeenFCnt = fCnt;
+            }
+            else if (static_cast<uint16_t>(m_lastSeenFCnt - fCnt) < 32)
+            {
+                // Reordered counter inside the window: mark its bit
+                m_fCntReorderBitmap |= 1u << static_cast<uint16_t>(m_lastSeenFCnt - fCnt);
+            }
+        }
+
+        // Age out the oldest entries when the history is bounded, releasing
+        // their packet buffer references
+        while (m_maxReceivedPackets != 0 && m_cold->receivedPacketList.size() > m_maxReceivedPackets)
+        {
+            m_cold->receivedPacketList.pop_front();
+        }
     }
     NS_LOG_DEBUG(*this);
 }
 
-EndDeviceStatus::ReceivedPacketInfo
-EndDeviceStatus::GetLastReceivedPacketInfo()
+bool
+EndDeviceStatus::WasFCntSeen(uint16_t fCnt) const
+{
+    if (!m_anyFCntSeen)
+    {
+        return false;
+    }
+    uint16_t behind = static_cast<uint16_t>(m_lastSeenFCnt - fCnt);
+    return behind < 32 && ((m_fCntReorderBitmap >> behind) & 1);
+}
+
+const EndDeviceStatus::ReceivedPacketInfo&
+EndDeviceStatus::GetLastReceivedPacketInfo() const
 {
     NS_LOG_FUNCTION_NOARGS();
-    auto it = m_receivedPacketList.rbegin();
-    if (it != m_receivedPacketList.rend())
+    auto it = m_cold->receivedPacketList.rbegin();
+    if (it != m_cold->receivedPacketList.rend())
     {
         return it->second;
     }
     else
     {
-        return EndDeviceStatus::ReceivedPacketInfo();
+        static const ReceivedPacketInfo emptyInfo;
+        return emptyInfo;
     }
 }
 
+EndDeviceStatus::ReceivedPacketWindow
+EndDeviceStatus::GetLastReceivedPackets(size_t n) const
+{
+    size_t count = std::min(n, m_cold->receivedPacketList.size());
+    return {m_cold->receivedPacketList.end() - count, m_cold->receivedPacketList.end()};
+}
+
 Ptr<const Packet>
 EndDeviceStatus::GetLastPacketReceivedFromDevice()
 {
     NS_LOG_FUNCTION_NOARGS();
-    auto it = m_receivedPacketList.rbegin();
-    if (it != m_receivedPacketList.rend())
+    auto it = m_cold->receivedPacketList.rbegin();
+    if (it != m_cold->receivedPacketList.rend())
     {
         return it->first;
     }
@@ -347,12 +456,129 @@ EndDeviceStatus::InitializeReply()
     NS_LOG_FUNCTION_NOARGS();
     m_reply = Reply();
     m_reply.needsReply = false;
+    m_cachedReplyPacket = nullptr;
+    m_replyDirty = true;
+}
+
+void
+EndDeviceStatus::PrimeAckReply()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    m_confirmedTraffic = true;
+    if (!m_ackPrimed)
+    {
+        // Build the skeleton once: it only depends on the device address
+        m_cold->ackFrameHeader.SetAsDownlink();
+        m_cold->ackFrameHeader.SetAck(true);
+        m_cold->ackFrameHeader.SetAddress(m_endDeviceAddress);
+        m_cold->ackMacHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
+        m_ackPrimed = true;
+    }
+
+    m_reply.frameHeader = m_cold->ackFrameHeader;
+    m_reply.macHeader = m_cold->ackMacHeader;
+    m_reply.needsReply = true;
+    MarkReplyDirty();
+}
+
+bool
+EndDeviceStatus::SendsConfirmedTraffic() const
+{
+    return m_confirmedTraffic;
+}
+
+void
+EndDeviceStatus::MarkReplyDirty()
+{
+    m_replyDirty = true;
 }
 
 void
 EndDeviceStatus::AddMACCommand(Ptr<MacCommand> macCommand)
 {
-    m_reply.frameHeader.AddCommand(macCommand);
+    m_cold->pendingMacCommands.emplace_back(macCommand);
+    m_reply.needsReply = true;
+    m_replyDirty = true;
+}
+
+namespace
+{
+
+/**
+ * Rank a MAC command for downlink coalescing; lower goes first. Link
+ * parameter control is the most airtime-critical, then airtime budget
+ * control, then the rest in submission order.
+ *
+ * @param command The command to rank.
+ * @return The command's priority rank.
+ */
+uint8_t
+MacCommandPriority(const Ptr<MacCommand>& command)
+{
+    switch (command->GetCommandType())
+    {
+    case LINK_ADR_REQ:
+        return 0;
+    case DUTY_CYCLE_REQ:
+        return 1;
+    case RX_PARAM_SETUP_REQ:
+        return 2;
+    case NEW_CHANNEL_REQ:
+        return 3;
+    case DEV_STATUS_REQ:
+        return 4;
+    default:
+        return 5;
+    }
+}
+
+} // namespace
+
+void
+EndDeviceStatus::FlushPendingMacCommands()
+{
+    if (m_cold->pendingMacCommands.empty())
+    {
+        return;
+    }
+
+    // Highest priority first; the sort is stable so commands of equal
+    // priority keep the order the components queued them in
+    std::stable_sort(m_cold->pendingMacCommands.begin(),
+                     m_cold->pendingMacCommands.end(),
+                     [](const Ptr<MacCommand>& a, const Ptr<MacCommand>& b) {
+                         return MacCommandPriority(a) < MacCommandPriority(b);
+                     });
+
+    uint32_t usedBytes = 0;
+    for (const auto& command : m_reply.frameHeader.GetCommands())
+    {
+        usedBytes += command->GetSerializedSize();
+    }
+
+    auto it = m_cold->pendingMacCommands.begin();
+    for (; it != m_cold->pendingMacCommands.end(); ++it)
+    {
+        uint32_t commandBytes = (*it)->GetSerializedSize();
+        if (usedBytes + commandBytes > MAX_FOPTS_BYTES)
+        {
+            // Keep this and everything behind it for the next downlink, so
+            // a lower-priority command never jumps an overflowing one
+            break;
+        }
+        m_reply.frameHeader.AddCommand(*it);
+        usedBytes += commandBytes;
+        m_replyDirty = true;
+    }
+    if (it != m_cold->pendingMacCommands.begin())
+    {
+        NS_LOG_DEBUG("Coalesced " << std::distance(m_cold->pendingMacCommands.begin(), it)
+                                  << " MAC commands into the downlink, "
+                                  << std::distance(it, m_cold->pendingMacCommands.end())
+                                  << " left queued");
+    }
+    m_cold->pendingMacCommands.erase(m_cold->pendingMacCommands.begin(), it);
 }
 
 bool
@@ -379,27 +605,29 @@ EndDeviceStatus::GetPowerGatewayMap()
     // Create a map of the gateways
     // Key: received power
     // Value: address of the corresponding gateway
-    ReceivedPacketInfo info = m_receivedPacketList.back().second;
-    GatewayList gwList = info.gwList;
-
     std::map<double, Address> gatewayPowers;
 
-    for (auto it = gwList.begin(); it != gwList.end(); it++)
+    for (const auto& [rxPower, gwAddress] : m_lastPacketGatewaysByPower)
     {
-        Address currentGwAddress = (*it).first;
-        double currentRxPower = (*it).second.rxPower;
-        gatewayPowers.insert(std::pair<double, Address>(currentRxPower, currentGwAddress));
+        gatewayPowers.insert(std::pair<double, Address>(rxPower, gwAddress));
     }
 
     return gatewayPowers;
 }
 
+const std::vector<std::pair<double, Address>>&
+EndDeviceStatus::GetGatewaysByPower() const
+{
+    return m_lastPacketGatewaysByPower;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const EndDeviceStatus& status)
 {
-    os << "Total packets received: " << status.m_receivedPacketList.size() << std::endl;
+    os << "Total packets received: " << status.m_cold->receivedPacketList.size() << std::endl;
 
-    for (auto j = status.m_receivedPacketList.begin(); j != status.m_receivedPacketList.end(); j++)
+    const EndDeviceStatus::ReceivedPacketList& packetList = status.m_cold->receivedPacketList;
+    for (auto j = packetList.begin(); j != packetList.end(); j++)
     {
         EndDeviceStatus::ReceivedPacketInfo info = (*j).second;
         EndDeviceStatus::GatewayList gatewayList = info.gwList;
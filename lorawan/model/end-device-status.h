@@ -19,7 +19,13 @@
 #include "ns3/object.h"
 #include "ns3/pointer.h"
 
+#include <algorithm>
+#include <array>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -109,14 +115,14 @@ class EndDeviceStatus : public Object
      *
      * @return The packet reply mac header.
      */
-    LorawanMacHeader GetReplyMacHeader() const;
+    const LorawanMacHeader& GetReplyMacHeader() const;
 
     /**
      * Get the reply packet frame header.
      *
      * @return The packet reply frame header.
      */
-    LoraFrameHeader GetReplyFrameHeader() const;
+    const LoraFrameHeader& GetReplyFrameHeader() const;
 
     /**
      * Get the data of the reply packet.
@@ -141,9 +147,60 @@ class EndDeviceStatus : public Object
     };
 
     /**
-     * typedef of a list of gateways with relative reception information.
-     */
-    typedef std::map<Address, PacketInfoPerGw> GatewayList;
+     * List of gateways with relative reception information.
+     *
+     * Holds one entry per gateway that received a packet — in practice one
+     * to a handful — so entries live in inline storage searched linearly,
+     * which beats a node-based map at these sizes and removes the per-entry
+     * allocations on the server's per-uplink hot path. Lists that outgrow
+     * the inline slots spill to a heap vector transparently. Entries are
+     * (address, info) pairs iterated just like the std::map this replaces.
+     */
+    class GatewayList
+    {
+      public:
+        typedef std::pair<Address, PacketInfoPerGw> value_type; //!< Entry type
+        typedef value_type* iterator;                           //!< Iterator type
+        typedef const value_type* const_iterator;               //!< Const iterator type
+
+        iterator begin() { return Data(); }
+        iterator end() { return Data() + m_size; }
+        const_iterator begin() const { return Data(); }
+        const_iterator end() const { return Data() + m_size; }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        /**
+         * Insert a gateway entry unless its address is already present,
+         * mirroring std::map::insert semantics. The entry is taken by value
+         * and moved into storage, so call sites passing a temporary pay no
+         * second copy of the Address.
+         *
+         * @param entry The (gateway address, reception info) pair.
+         * @return The entry for the address and whether it was inserted.
+         */
+        std::pair<iterator, bool> insert(value_type entry);
+
+        /// Inline entries are part of the owning object, so only spilled
+        /// storage counts towards the heap estimate.
+        friend uint64_t EstimateMemory(const GatewayList& list);
+
+      private:
+        /// Number of entries stored inline before spilling to the heap.
+        static constexpr size_t INLINE_CAPACITY = 8;
+
+        value_type* Data() { return m_overflow.empty() ? m_inline.data() : m_overflow.data(); }
+
+        const value_type* Data() const
+        {
+            return m_overflow.empty() ? m_inline.data() : m_overflow.data();
+        }
+
+        std::array<value_type, INLINE_CAPACITY> m_inline{}; //!< Inline entry storage
+        std::vector<value_type> m_overflow; //!< Heap storage once the inline slots are full
+        size_t m_size = 0;                  //!< Number of valid entries
+    };
 
     /**
      * Structure saving information regarding all packet receptions.
@@ -159,8 +216,11 @@ class EndDeviceStatus : public Object
 
     /**
      * typedef of a list of packets paired to their reception info.
+     *
+     * Kept in arrival order; when the MaxReceivedPackets attribute is set,
+     * the oldest entries are dropped as new ones arrive.
      */
-    typedef std::list<std::pair<Ptr<const Packet>, ReceivedPacketInfo>> ReceivedPacketList;
+    typedef std::deque<std::pair<Ptr<const Packet>, ReceivedPacketInfo>> ReceivedPacketList;
 
     /*******************************************/
     /* Proper EndDeviceStatus class definition */
@@ -216,9 +276,9 @@ class EndDeviceStatus : public Object
     /**
      * Get the received packet list.
      *
-     * @return The received packet list.
+     * @return A const reference to the received packet list.
      */
-    ReceivedPacketList GetReceivedPacketList() const;
+    const ReceivedPacketList& GetReceivedPacketList() const;
 
     /**
      * Set the spreading factor this device is using in the first receive window.
@@ -288,6 +348,20 @@ class EndDeviceStatus : public Object
      */
     void InsertReceivedPacket(Ptr<const Packet> receivedPacket, const Address& gwAddress);
 
+    /**
+     * Whether an uplink with this frame counter has already been seen from
+     * this device, judged from the last-seen counter and the reorder window
+     * bitmap in two integer compares.
+     *
+     * Frame counters older than the reorder window are reported as new:
+     * they cannot be distinguished from a counter wrap without the full
+     * history scan this index exists to avoid.
+     *
+     * @param fCnt The frame counter of the uplink.
+     * @return True if the frame counter was already seen.
+     */
+    bool WasFCntSeen(uint16_t fCnt) const;
+
     /**
      * Return the last packet that was received from this device.
      *
@@ -299,9 +373,40 @@ class EndDeviceStatus : public Object
      * Return the information about the last packet that was received from the
      * device.
      *
+     * The reference points into the received packet list and copies nothing;
+     * it stays valid until the next packet from this device is recorded.
+     *
      * @return The information about the last received packet.
      */
-    EndDeviceStatus::ReceivedPacketInfo GetLastReceivedPacketInfo();
+    const ReceivedPacketInfo& GetLastReceivedPacketInfo() const;
+
+    /**
+     * Lightweight view over a contiguous stretch of the received packet
+     * list, oldest entry first. Iterating the view reads the stored entries
+     * in place, so taking one never copies packet histories.
+     */
+    struct ReceivedPacketWindow
+    {
+        ReceivedPacketList::const_iterator first; //!< Oldest entry in the window
+        ReceivedPacketList::const_iterator last;  //!< One past the newest entry
+
+        ReceivedPacketList::const_iterator begin() const { return first; }
+
+        ReceivedPacketList::const_iterator end() const { return last; }
+
+        size_t size() const { return last - first; }
+
+        bool empty() const { return first == last; }
+    };
+
+    /**
+     * Get a view over the most recent received packets.
+     *
+     * @param n The number of packets to cover, clamped to the number
+     * actually received.
+     * @return A window over the last n entries, oldest first.
+     */
+    ReceivedPacketWindow GetLastReceivedPackets(size_t n) const;
 
     /**
      * Reset the next reply state.
@@ -309,12 +414,47 @@ class EndDeviceStatus : public Object
     void InitializeReply();
 
     /**
-     * Add MAC command to the frame header of next reply.
+     * Arm the reply as an acknowledgment, reusing a cached ACK skeleton.
+     *
+     * The skeleton — a downlink frame header with the ACK bit and this
+     * device's address, under an unconfirmed-down MAC header — only depends
+     * on the device address, so it is built on the first confirmed uplink
+     * and copied into the reply afterwards instead of re-assembling the
+     * headers field by field on every acknowledgment.
+     */
+    void PrimeAckReply();
+
+    /**
+     * Whether a confirmed uplink was ever received from this device.
+     *
+     * @return True after the first PrimeAckReply call.
+     */
+    bool SendsConfirmedTraffic() const;
+
+    /**
+     * Invalidate the cached assembled reply packet.
+     *
+     * Components that mutate m_reply directly, rather than through the reply
+     * setters, must call this so the next GetCompleteReplyPacket call
+     * re-serializes the headers instead of reusing the cached bytes.
+     */
+    void MarkReplyDirty();
+
+    /**
+     * Queue a MAC command for delivery to this device.
+     *
+     * Commands queued by different components coalesce into one FOpts block
+     * per downlink: when the reply is assembled, pending commands are taken
+     * in priority order until the 15-byte FOpts limit is reached, and the
+     * rest stay queued for the next downlink opportunity.
      *
      * @param macCommand The MAC command.
      */
     void AddMACCommand(Ptr<MacCommand> macCommand);
 
+    /// The FOpts field holds at most this many bytes of MAC commands.
+    static constexpr uint32_t MAX_FOPTS_BYTES = 15;
+
     /**
      * Check if there is already a running reception window event scheduled for this end device.
      *
@@ -342,7 +482,75 @@ class EndDeviceStatus : public Object
      */
     std::map<double, Address> GetPowerGatewayMap();
 
-    struct Reply m_reply;                 //!< Next reply intended for this device
+    /**
+     * Get the gateways which received the last packet from the end device,
+     * sorted by ascending measured reception power.
+     *
+     * Unlike GetPowerGatewayMap, this reads an index that is maintained
+     * incrementally as InsertReceivedPacket records gateway receptions, so
+     * per-downlink gateway selection does not rebuild and sort a map.
+     *
+     * @return A reference to the sorted (reception power, gateway address)
+     * pairs of the last packet.
+     */
+    const std::vector<std::pair<double, Address>>& GetGatewaysByPower() const;
+
+    /**
+     * Measured link quality shared between network controller components.
+     *
+     * The FEC decoder effectively measures frame loss (a generation that
+     * times out short of full rank counts its missing frames) and its own
+     * recovery performance; FEC-aware ADR wants exactly those numbers.
+     * Keeping them here, one instance per device, lets both components read
+     * and update a single copy instead of each re-deriving the link state.
+     */
+    struct LinkQualityCache
+    {
+        /// Delivered/lost frame tallies for one data rate.
+        struct DrStats
+        {
+            uint32_t delivered = 0; //!< Frames that reached the server.
+            uint32_t lost = 0;      //!< Frames inferred lost at this data rate.
+        };
+
+        std::array<DrStats, 6> perDataRate{}; //!< Tallies indexed by data rate.
+
+        uint32_t fecOriginal = 0;  //!< Application frames delivered, including recovered.
+        uint32_t fecRecovered = 0; //!< Frames reconstructed by the FEC decoder.
+        uint32_t fecLost = 0;      //!< Frames lost past the decoder.
+
+        /**
+         * Get the measured frame error rate at a data rate.
+         *
+         * @param dataRate The data rate [0; 5].
+         * @return The lost fraction, or -1 when nothing was measured yet.
+         */
+        double MeasuredFer(uint8_t dataRate) const
+        {
+            const DrStats& stats = perDataRate[dataRate];
+            uint32_t total = stats.delivered + stats.lost;
+            return (total == 0) ? -1.0 : double(stats.lost) / total;
+        }
+
+        /**
+         * Get the fraction of lost frames the FEC decoder recovered.
+         *
+         * @return The recovery ratio in [0; 1], 0 when nothing was lost yet.
+         */
+        double FecRecoveryRatio() const
+        {
+            return (fecLost == 0) ? 0.0
+                                  : std::min(1.0, double(fecRecovered) / fecLost);
+        }
+    };
+
+    LinkQualityCache m_linkQuality; //!< Shared measured link state of this device.
+
+    /**
+     * Next reply intended for this device. Direct mutations must be followed
+     * by a MarkReplyDirty call, see GetCompleteReplyPacket.
+     */
+    struct Reply m_reply;
     LoraDeviceAddress m_endDeviceAddress; //!< The address of this device
 
     /**
@@ -355,19 +563,113 @@ class EndDeviceStatus : public Object
     friend std::ostream& operator<<(std::ostream& os, const EndDeviceStatus& status);
 
   private:
+    // The private state is split hot/cold: the scalar fields the per-uplink
+    // path reads and writes (frame counter index, receive window parameters,
+    // reply cache state) are declared together below, so they share one or
+    // two cache lines of the object, while the bulky, rarely-walked state
+    // lives in the heap-allocated ColdState behind a single pointer.
+
     // Receive window data
     uint8_t m_firstReceiveWindowSpreadingFactor = 0;  //!< Spreading Factor (SF) for RX1 window
-    uint32_t m_firstReceiveWindowFrequencyHz = 0;     //!< Frequency [Hz] for RX1 window
     uint8_t m_secondReceiveWindowSpreadingFactor = 0; //!< Spreading Factor (SF) for RX2 window.
+    uint32_t m_firstReceiveWindowFrequencyHz = 0;     //!< Frequency [Hz] for RX1 window
     uint32_t m_secondReceiveWindowFrequencyHz = 869525000; //!< Frequency [Hz] for RX2 window
+
+    /**
+     * Highest frame counter received from this device so far (in wraparound
+     * order). Together with m_fCntReorderBitmap it answers the duplicate
+     * test in O(1), so InsertReceivedPacket only scans the received packet
+     * list when the index says the counter was in fact already seen.
+     */
+    uint16_t m_lastSeenFCnt = 0;
+
+    uint16_t m_cachedReplyFCnt = 0; //!< Frame counter the cached reply was built against
+
+    /**
+     * Reception bitmap of the reorder window: bit i records whether the
+     * frame counter m_lastSeenFCnt - i was received. Shifted along as newer
+     * counters arrive.
+     */
+    uint32_t m_fCntReorderBitmap = 0;
+
+    /**
+     * Maximum number of entries kept in the received packet list, 0 for
+     * unlimited. Once the limit is reached, inserting a packet evicts the
+     * oldest entry, releasing its reference to the packet buffer. ADR and
+     * the other NetworkController components only ever look at the most
+     * recent entries, so on long runs a small bound keeps memory flat
+     * without affecting their decisions.
+     */
+    uint32_t m_maxReceivedPackets = 0;
+
+    bool m_anyFCntSeen = false;     //!< Whether any uplink was received yet.
+    bool m_replyDirty = true;       //!< Whether m_reply changed since the cached assembly
+    bool m_confirmedTraffic = false; //!< Whether a confirmed uplink was ever received
+    bool m_ackPrimed = false;        //!< Whether the cached ACK skeleton was built
+
     EventId m_receiveWindowEvent; //!< Event storing the next scheduled downlink transmission
 
-    ReceivedPacketList m_receivedPacketList; //!< List of received packets
+    /**
+     * The reply packet assembled by the last GetCompleteReplyPacket call,
+     * reused while no component has touched m_reply and the frame counter to
+     * acknowledge is unchanged, so a retry on the second receive window does
+     * not re-serialize the same headers.
+     */
+    Ptr<Packet> m_cachedReplyPacket;
+
+    /**
+     * The gateways that received the last packet, sorted by ascending
+     * reception power. Rebuilt from scratch when a new packet arrives and
+     * extended in place when another gateway reports the same packet, so
+     * downlink gateway selection only reads it.
+     */
+    std::vector<std::pair<double, Address>> m_lastPacketGatewaysByPower;
+
+    /**
+     * Cold, bulky state: the packet history, the pending MAC command queue
+     * and the MAC layer pointer are reached through one extra indirection,
+     * keeping the hot scalars above compact.
+     */
+    struct ColdState
+    {
+        ReceivedPacketList receivedPacketList; //!< List of received packets
+
+        /**
+         * MAC commands queued by controller components and not yet
+         * serialized into a downlink, see AddMACCommand.
+         */
+        std::vector<Ptr<MacCommand>> pendingMacCommands;
+
+        /// @note Using this attribute is 'cheating', since we are assuming perfect
+        /// synchronization between the info at the device and at the network server
+        Ptr<ClassAEndDeviceLorawanMac> mac; //!< Pointer to the MAC layer of this device
 
-    /// @note Using this attribute is 'cheating', since we are assuming perfect
-    /// synchronization between the info at the device and at the network server
-    Ptr<ClassAEndDeviceLorawanMac> m_mac; //!< Pointer to the MAC layer of this device
+        LorawanMacHeader ackMacHeader;  //!< Cached MAC header of the ACK skeleton
+        LoraFrameHeader ackFrameHeader; //!< Cached frame header of the ACK skeleton
+    };
+
+    std::unique_ptr<ColdState> m_cold; //!< The cold side of this device's state
+
+    /**
+     * Move pending MAC commands into the reply frame header, highest
+     * priority first, until the FOpts byte budget is exhausted. Commands
+     * that do not fit stay queued for the next downlink.
+     */
+    void FlushPendingMacCommands();
 };
+
+/**
+ * Estimate the heap bytes held by a gateway reception list.
+ *
+ * @param list The list to estimate.
+ * @return The estimated heap bytes.
+ */
+inline uint64_t
+EstimateMemory(const EndDeviceStatus::GatewayList& list)
+{
+    return list.m_overflow.capacity() * sizeof(EndDeviceStatus::GatewayList::value_type);
+}
+
 } // namespace lorawan
 
 } // namespace ns3
@@ -2,11 +2,16 @@
 
 #include "fec-component.h"
 #include "ns3/log.h"
+#include "ns3/memory-report.h"
 #include "ns3/simulator.h"
 #include <iostream>
 #include <numeric>
 #include <algorithm>
 
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
 namespace ns3
 {
 namespace lorawan
@@ -93,22 +98,57 @@ FecComponent::OnReceivedPacket(Ptr<const Packet> packet,
 
             auto& generation = m_deviceFecGenerations[deviceAddr][genId];
             generation.lastActivity = Simulator::Now();
+            if (generation.size == 0) {
+                generation.size = m_fecConfig.generationSize;
+            }
+
+            // Feed the shared link-quality cache: this frame made it at its
+            // data rate, and the generation remembers where to report losses
+            generation.deviceStatus = status;
+            uint8_t sf = status->GetFirstReceiveWindowSpreadingFactor();
+            if (sf >= 7 && sf <= 12) {
+                generation.dataRate = 12 - sf;
+            }
+            status->m_linkQuality.perDataRate[generation.dataRate].delivered++;
+            m_expiryHeap.push(
+                {generation.lastActivity + m_fecConfig.generationTimeout, deviceAddr, genId});
 
             // Store the application payload (packet after FEC header)
             packetCopy->RemoveAtStart(4);
 
+            // Build the arriving row: a unit vector for systematic packets,
+            // the deterministic combination for redundant ones
+            std::vector<uint8_t> coeffs;
             if (pktType == 0) { // Systematic packet
                 generation.systematicPackets[pktIndex] = packetCopy;
-                std::cout << "  Systematic packet " << static_cast<uint32_t>(pktIndex) 
-                          << " stored (" << generation.systematicPackets.size() 
+                if (pktIndex < generation.size) {
+                    coeffs = AcquireBuffer(generation.size);
+                    coeffs[pktIndex] = 1;
+                }
+                std::cout << "  Systematic packet " << static_cast<uint32_t>(pktIndex)
+                          << " stored (" << generation.systematicPackets.size()
                           << "/" << m_fecConfig.generationSize << ")" << std::endl;
             } else { // Redundant packet
-                std::vector<uint8_t> dummyCombination(1, 1);
-                generation.redundantPackets.push_back(std::make_pair(dummyCombination, packetCopy));
-                std::cout << "  Redundant packet stored (" << generation.redundantPackets.size() 
+                uint32_t redundantIndex =
+                    (pktIndex != 255) ? pktIndex : generation.redundantPackets.size();
+                coeffs = GenerateCoefficients(genId, redundantIndex, generation.size);
+                generation.redundantPackets.push_back(std::make_pair(coeffs, packetCopy));
+                std::cout << "  Redundant packet stored (" << generation.redundantPackets.size()
                           << " redundant packets)" << std::endl;
             }
 
+            // Reduce the row against the echelon form right away, so the
+            // decode cost is spread over arrivals and recovery triggers the
+            // moment the rank suffices
+            if (!coeffs.empty() && !generation.isComplete) {
+                std::vector<uint8_t> payload = AcquireBuffer(packetCopy->GetSize());
+                packetCopy->CopyData(payload.data(), payload.size());
+                bool innovative =
+                    ReduceIntoEchelon(generation, std::move(coeffs), std::move(payload));
+                NS_LOG_DEBUG("Row was " << (innovative ? "innovative" : "dependent")
+                             << ", rank " << generation.rank << "/" << generation.size);
+            }
+
             // *** IMMEDIATE RECOVERY ATTEMPT ***
             bool recovered = AttemptFecRecovery(deviceAddr, genId);
             if (recovered) {
@@ -149,9 +189,87 @@ FecComponent::InitializeGfTables()
         m_gfExp[i] = m_gfExp[i - 255];
     }
     m_gfLog[0] = 255; // Special case
+
+    // Split-nibble product tables: for every coefficient c, table entries
+    // c * n and c * (n << 4) for n in [0, 15]. A byte product is then the
+    // xor of the two, since multiplication distributes over the nibbles
+    m_gfMulNibbleLo.resize(256);
+    m_gfMulNibbleHi.resize(256);
+    for (int c = 0; c < 256; c++) {
+        for (int n = 0; n < 16; n++) {
+            m_gfMulNibbleLo[c][n] = GfMultiply(c, n);
+            m_gfMulNibbleHi[c][n] = GfMultiply(c, n << 4);
+        }
+    }
     NS_LOG_DEBUG("GF(256) tables initialized for FecComponent");
 }
 
+void
+FecComponent::GfMulAddRow(uint8_t* dst, const uint8_t* src, size_t len, uint8_t coeff)
+{
+    if (coeff == 0) {
+        return;
+    }
+
+    const std::array<uint8_t, 16>& lo = m_gfMulNibbleLo[coeff];
+    const std::array<uint8_t, 16>& hi = m_gfMulNibbleHi[coeff];
+    size_t i = 0;
+
+#ifdef __SSSE3__
+    // PSHUFB turns each split-nibble table into a 16-way parallel lookup,
+    // so one iteration multiply-accumulates 16 bytes
+    __m128i loTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo.data()));
+    __m128i hiTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi.data()));
+    __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    for (; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i loProd = _mm_shuffle_epi8(loTable, _mm_and_si128(s, nibbleMask));
+        __m128i hiProd =
+            _mm_shuffle_epi8(hiTable, _mm_and_si128(_mm_srli_epi64(s, 4), nibbleMask));
+        d = _mm_xor_si128(d, _mm_xor_si128(loProd, hiProd));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d);
+    }
+#endif
+
+    for (; i < len; i++) {
+        dst[i] ^= lo[src[i] & 0x0F] ^ hi[src[i] >> 4];
+    }
+}
+
+void
+FecComponent::GfMulRow(uint8_t* row, size_t len, uint8_t coeff)
+{
+    if (coeff == 1) {
+        return;
+    }
+    if (coeff == 0) {
+        std::fill(row, row + len, 0);
+        return;
+    }
+
+    const std::array<uint8_t, 16>& lo = m_gfMulNibbleLo[coeff];
+    const std::array<uint8_t, 16>& hi = m_gfMulNibbleHi[coeff];
+    size_t i = 0;
+
+#ifdef __SSSE3__
+    __m128i loTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo.data()));
+    __m128i hiTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi.data()));
+    __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    for (; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i loProd = _mm_shuffle_epi8(loTable, _mm_and_si128(s, nibbleMask));
+        __m128i hiProd =
+            _mm_shuffle_epi8(hiTable, _mm_and_si128(_mm_srli_epi64(s, 4), nibbleMask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_xor_si128(loProd, hiProd));
+    }
+#endif
+
+    for (; i < len; i++) {
+        row[i] = lo[row[i] & 0x0F] ^ hi[row[i] >> 4];
+    }
+}
+
 uint8_t
 FecComponent::GfMultiply(uint8_t a, uint8_t b)
 {
@@ -190,13 +308,13 @@ FecComponent::AttemptFecRecovery(uint32_t deviceAddr, uint16_t generationId)
         return true; // Already recovered
     }
     
-    uint32_t totalReceived = generation.systematicPackets.size() + generation.redundantPackets.size();
-    
-    NS_LOG_DEBUG("Recovery attempt: " << generation.systematicPackets.size() << " systematic, " 
-                 << generation.redundantPackets.size() << " redundant packets (total: " << totalReceived << ")");
-    
-    // Check if we have enough packets for recovery
-    if (totalReceived >= m_fecConfig.generationSize) { 
+    NS_LOG_DEBUG("Recovery attempt: " << generation.systematicPackets.size() << " systematic, "
+                 << generation.redundantPackets.size() << " redundant packets (rank: "
+                 << generation.rank << "/" << generation.size << ")");
+
+    // The echelon form is maintained on arrival, so recovery is possible
+    // exactly when the accumulated rank covers the generation
+    if (generation.rank >= generation.size) {
         std::vector<Ptr<Packet>> recovered = SolveFecSystem(generation);
         
         if (!recovered.empty()) { 
@@ -207,6 +325,11 @@ FecComponent::AttemptFecRecovery(uint32_t deviceAddr, uint16_t generationId)
             
             // Update statistics
             m_deviceRecoveredPackets[deviceAddr] += recovered.size();
+            if (generation.deviceStatus) {
+                auto& linkQuality = generation.deviceStatus->m_linkQuality;
+                linkQuality.fecRecovered += recovered.size();
+                linkQuality.fecOriginal += recovered.size();
+            }
             
             // Deliver to application
             DeliverApplicationPackets(deviceAddr, recovered);
@@ -217,39 +340,159 @@ FecComponent::AttemptFecRecovery(uint32_t deviceAddr, uint16_t generationId)
     return false; // Recovery not possible yet
 }
 
+bool
+FecComponent::ReduceIntoEchelon(FecGeneration& generation,
+                                std::vector<uint8_t> coeffs,
+                                std::vector<uint8_t> payload)
+{
+    NS_LOG_FUNCTION(this);
+
+    uint32_t n = generation.size;
+    if (generation.echelonCoeffs.empty()) {
+        generation.echelonCoeffs.resize(n);
+        generation.echelonPayloads.resize(n);
+    }
+
+    // Payloads in one generation can differ in length; rows are kept at the
+    // longest length seen so far, zero-padded
+    if (payload.size() < generation.payloadLen) {
+        payload.resize(generation.payloadLen, 0);
+    } else if (payload.size() > generation.payloadLen) {
+        generation.payloadLen = payload.size();
+        for (uint32_t col = 0; col < n; col++) {
+            if (!generation.echelonCoeffs[col].empty()) {
+                generation.echelonPayloads[col].resize(generation.payloadLen, 0);
+            }
+        }
+    }
+
+    for (uint32_t col = 0; col < n; col++) {
+        if (coeffs[col] == 0) {
+            continue;
+        }
+        std::vector<uint8_t>& pivotCoeffs = generation.echelonCoeffs[col];
+        if (!pivotCoeffs.empty()) {
+            // Cancel this column using the stored pivot row (pivots are
+            // normalized to 1, so the factor is the coefficient itself)
+            uint8_t factor = coeffs[col];
+            GfMulAddRow(coeffs.data(), pivotCoeffs.data(), n, factor);
+            GfMulAddRow(payload.data(),
+                        generation.echelonPayloads[col].data(),
+                        payload.size(),
+                        factor);
+            continue;
+        }
+
+        // New pivot: normalize it, then clear its column from the other
+        // stored rows so the form stays fully reduced and completion needs
+        // no back-substitution pass
+        uint8_t inverse = GfDivide(1, coeffs[col]);
+        GfMulRow(coeffs.data(), n, inverse);
+        GfMulRow(payload.data(), payload.size(), inverse);
+        for (uint32_t other = 0; other < n; other++) {
+            if (other == col || generation.echelonCoeffs[other].empty()) {
+                continue;
+            }
+            uint8_t factor = generation.echelonCoeffs[other][col];
+            if (factor != 0) {
+                GfMulAddRow(generation.echelonCoeffs[other].data(), coeffs.data(), n, factor);
+                GfMulAddRow(generation.echelonPayloads[other].data(),
+                            payload.data(),
+                            payload.size(),
+                            factor);
+            }
+        }
+        generation.echelonCoeffs[col] = std::move(coeffs);
+        generation.echelonPayloads[col] = std::move(payload);
+        generation.rank++;
+        return true;
+    }
+
+    // Linearly dependent on the rows already stored; recycle the buffers
+    ReleaseBuffer(std::move(coeffs));
+    ReleaseBuffer(std::move(payload));
+    return false;
+}
+
+std::vector<uint8_t>
+FecComponent::AcquireBuffer(size_t len)
+{
+    if (!m_bufferPool.empty()) {
+        std::vector<uint8_t> buffer = std::move(m_bufferPool.back());
+        m_bufferPool.pop_back();
+        buffer.assign(len, 0);
+        return buffer;
+    }
+    return std::vector<uint8_t>(len, 0);
+}
+
+void
+FecComponent::ReleaseBuffer(std::vector<uint8_t>&& buffer)
+{
+    // Keep enough buffers around for a few in-flight generations; beyond
+    // that, let them free normally
+    if (m_bufferPool.size() < 4 * m_fecConfig.generationSize) {
+        m_bufferPool.push_back(std::move(buffer));
+    }
+}
+
+void
+FecComponent::ReleaseGenerationBuffers(FecGeneration& generation)
+{
+    for (auto& row : generation.echelonCoeffs) {
+        if (!row.empty()) {
+            ReleaseBuffer(std::move(row));
+        }
+    }
+    for (auto& row : generation.echelonPayloads) {
+        if (!row.empty()) {
+            ReleaseBuffer(std::move(row));
+        }
+    }
+    generation.echelonCoeffs.clear();
+    generation.echelonPayloads.clear();
+}
+
+std::vector<uint8_t>
+FecComponent::GenerateCoefficients(uint16_t generationId,
+                                   uint32_t redundantIndex,
+                                   uint32_t generationSize)
+{
+    // Deterministic combination so encoder and decoder only have to agree
+    // on the (generation, redundant index) pair, not on transmitted
+    // coefficient bytes
+    uint64_t state = (static_cast<uint64_t>(generationId) << 32) | (redundantIndex + 1);
+    std::vector<uint8_t> coeffs = AcquireBuffer(generationSize);
+    bool nonZero = false;
+    for (auto& c : coeffs) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        c = static_cast<uint8_t>(state >> 56);
+        nonZero = nonZero || (c != 0);
+    }
+    if (!nonZero) {
+        coeffs[0] = 1;
+    }
+    return coeffs;
+}
+
 std::vector<Ptr<Packet>>
 FecComponent::SolveFecSystem(FecGeneration& generation)
 {
     NS_LOG_FUNCTION(this);
-    
+
     std::vector<Ptr<Packet>> result;
-    
-    // Simple recovery algorithm: prioritize systematic packets
-    // In a full implementation, this would use Gaussian elimination
-    
-    // Add all systematic packets we have
-    for (auto& pair : generation.systematicPackets) {
-        result.push_back(pair.second);
+
+    if (generation.rank < generation.size) {
+        return result; // Echelon form incomplete, nothing to extract yet
     }
-    
-    NS_LOG_DEBUG("Added " << result.size() << " systematic packets to recovery");
-    
-    // Simulate recovery of missing packets using redundant packets
-    uint32_t missing = m_fecConfig.generationSize - generation.systematicPackets.size();
-    uint32_t available = generation.redundantPackets.size();
-    
-    if (available >= missing) {
-        // We have enough redundant packets to recover missing data
-        for (uint32_t i = 0; i < missing && i < available; ++i) {
-            // In a real implementation, this would solve linear equations
-            // For simulation, we create placeholder packets representing recovered data
-            Ptr<Packet> recoveredPacket = Create<Packet>(10); // Dummy size
-            result.push_back(recoveredPacket);
-        }
-        
-        NS_LOG_DEBUG("Simulated recovery of " << std::min(missing, available) << " missing packets");
+
+    // The form is fully reduced, so pivot row i's payload is source packet i
+    for (uint32_t col = 0; col < generation.size; col++) {
+        result.push_back(Create<Packet>(generation.echelonPayloads[col].data(),
+                                        generation.echelonPayloads[col].size()));
     }
-    
+
+    NS_LOG_DEBUG("Extracted " << result.size() << " decoded packets from the echelon form");
     return result;
 }
 
@@ -274,31 +517,50 @@ FecComponent::CleanupOldGenerations()
     
     Time now = Simulator::Now();
     uint32_t cleaned = 0;
-    
-    for (auto deviceIt = m_deviceFecGenerations.begin(); 
-         deviceIt != m_deviceFecGenerations.end(); ++deviceIt) {
-        
-        auto& generations = deviceIt->second;
-        for (auto genIt = generations.begin(); genIt != generations.end();) {
-            if (now - genIt->second.lastActivity > m_fecConfig.generationTimeout) {
-                // Mark incomplete generations as lost
-                if (!genIt->second.isComplete) {
-                    uint32_t lost = m_fecConfig.generationSize - 
-                                   genIt->second.systematicPackets.size();
-                    m_deviceLostPackets[deviceIt->first] += lost;
-                    
-                    NS_LOG_DEBUG("Generation " << genIt->first << " timed out, " 
-                                << lost << " packets lost");
-                }
-                
-                genIt = generations.erase(genIt);
-                cleaned++;
-            } else {
-                ++genIt;
+
+    // Pop due deadlines off the heap instead of scanning every device.
+    // Later packets push fresher entries for the same generation, so an
+    // entry whose generation has since seen activity is simply stale and
+    // gets dropped here
+    while (!m_expiryHeap.empty() && m_expiryHeap.top().deadline <= now) {
+        ExpiryEntry entry = m_expiryHeap.top();
+        m_expiryHeap.pop();
+
+        auto deviceIt = m_deviceFecGenerations.find(entry.deviceAddr);
+        if (deviceIt == m_deviceFecGenerations.end()) {
+            continue;
+        }
+        auto genIt = deviceIt->second.find(entry.genId);
+        if (genIt == deviceIt->second.end()) {
+            continue; // Already expired via an earlier entry
+        }
+        if (now - genIt->second.lastActivity <= m_fecConfig.generationTimeout) {
+            continue; // Refreshed since this entry was pushed
+        }
+
+        // Mark incomplete generations as lost
+        if (!genIt->second.isComplete) {
+            uint32_t lost = m_fecConfig.generationSize -
+                           genIt->second.systematicPackets.size();
+            m_deviceLostPackets[entry.deviceAddr] += lost;
+            if (genIt->second.deviceStatus) {
+                auto& linkQuality = genIt->second.deviceStatus->m_linkQuality;
+                linkQuality.fecLost += lost;
+                linkQuality.perDataRate[genIt->second.dataRate].lost += lost;
             }
+
+            NS_LOG_DEBUG("Generation " << entry.genId << " timed out, "
+                        << lost << " packets lost");
+        }
+
+        ReleaseGenerationBuffers(genIt->second);
+        deviceIt->second.erase(genIt);
+        if (deviceIt->second.empty()) {
+            m_deviceFecGenerations.erase(deviceIt);
         }
+        cleaned++;
     }
-    
+
     if (cleaned > 0) {
         NS_LOG_DEBUG("Cleaned up " << cleaned << " old FEC generations");
     }
@@ -343,5 +605,53 @@ FecComponent::GetApplicationDER(uint32_t deviceAddr) const
     
     return std::min(applicationDER, 0.5); // Cap at 50%
 }
+
+uint64_t
+FecComponent::MemoryReport() const
+{
+    uint64_t bytes = EstimateMemory(m_deviceFecGenerations) +
+                     EstimateMemory(m_deviceOriginalPackets) +
+                     EstimateMemory(m_deviceRecoveredPackets) +
+                     EstimateMemory(m_deviceLostPackets) + EstimateMemory(m_gfExp) +
+                     EstimateMemory(m_gfLog) + EstimateMemory(m_gfMulNibbleLo) +
+                     EstimateMemory(m_gfMulNibbleHi) + EstimateMemory(m_bufferPool);
+
+    bytes += m_expiryHeap.size() * sizeof(ExpiryEntry);
+
+    for (const auto& buffer : m_bufferPool) {
+        bytes += EstimateMemory(buffer);
+    }
+
+    for (const auto& devicePair : m_deviceFecGenerations) {
+        bytes += EstimateMemory(devicePair.second);
+        for (const auto& genPair : devicePair.second) {
+            const FecGeneration& generation = genPair.second;
+            bytes += EstimateMemory(generation.systematicPackets) +
+                     EstimateMemory(generation.redundantPackets) +
+                     EstimateMemory(generation.recoveredIndices) +
+                     EstimateMemory(generation.echelonCoeffs) +
+                     EstimateMemory(generation.echelonPayloads);
+            for (const auto& packetPair : generation.systematicPackets) {
+                if (packetPair.second) {
+                    bytes += packetPair.second->GetSize();
+                }
+            }
+            for (const auto& redundant : generation.redundantPackets) {
+                bytes += EstimateMemory(redundant.first);
+                if (redundant.second) {
+                    bytes += redundant.second->GetSize();
+                }
+            }
+            for (const auto& row : generation.echelonCoeffs) {
+                bytes += EstimateMemory(row);
+            }
+            for (const auto& row : generation.echelonPayloads) {
+                bytes += EstimateMemory(row);
+            }
+        }
+    }
+
+    return bytes;
+}
 } // namespace lorawan
 } // namespace ns3
\ No newline at end of file
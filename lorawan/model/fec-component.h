@@ -10,10 +10,14 @@
 #include "lora-frame-header.h"
 #include "lorawan-mac-header.h"
 
+#include <array>
 #include <map>
 #include <vector>
 #include <queue>
 #include <set>
+#include <unordered_map>
+
+class FecGfKernelTest; // unit test with access to the private GF(256) kernels
 
 namespace ns3
 {
@@ -26,6 +30,10 @@ class FecComponent : public NetworkControllerComponent
     // Add to fec-component.h public section:
     double GetApplicationDER(uint32_t deviceAddr) const;
 
+    // Estimated heap bytes held by the in-flight generations, buffer pool
+    // and GF tables
+    uint64_t MemoryReport() const;
+
     static TypeId GetTypeId();
     FecComponent();
     virtual ~FecComponent();
@@ -44,6 +52,8 @@ class FecComponent : public NetworkControllerComponent
     void OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
 
   private:
+    friend class ::FecGfKernelTest;
+
     // FEC Configuration
     struct FecConfig {
         bool enabled = true;
@@ -59,19 +69,68 @@ class FecComponent : public NetworkControllerComponent
         std::set<uint8_t> recoveredIndices;
         Time lastActivity;
         bool isComplete = false;
-        
+
+        // Fully-reduced echelon form built one row reduction at a time as
+        // packets arrive; slot i holds the row whose pivot is column i, so
+        // once rank reaches size every payload row is one decoded packet
+        uint32_t size = 0;
+        uint32_t rank = 0;
+        size_t payloadLen = 0;
+
+        // Where this generation reports into the shared per-device
+        // link-quality cache, and the data rate its frames were seen at
+        Ptr<EndDeviceStatus> deviceStatus;
+        uint8_t dataRate = 0;
+        std::vector<std::vector<uint8_t>> echelonCoeffs;
+        std::vector<std::vector<uint8_t>> echelonPayloads;
+
         FecGeneration() : lastActivity(Simulator::Now()) {}
     };
     
-    // Per-device FEC state
-    std::map<uint32_t, std::map<uint16_t, FecGeneration>> m_deviceFecGenerations;
+    // Per-device FEC state; the outer map is hashed since it is hit on every
+    // FEC uplink, the inner one stays ordered as generations per device are
+    // few and short-lived
+    std::unordered_map<uint32_t, std::map<uint16_t, FecGeneration>> m_deviceFecGenerations;
+
+    // Min-heap of generation deadlines, one entry pushed per FEC packet;
+    // entries made stale by later activity are discarded lazily on pop, so
+    // the periodic cleanup touches only candidates instead of every device
+    struct ExpiryEntry {
+        Time deadline;
+        uint32_t deviceAddr;
+        uint16_t genId;
+    };
+    struct ExpiryAfter {
+        bool operator()(const ExpiryEntry& a, const ExpiryEntry& b) const {
+            return a.deadline > b.deadline;
+        }
+    };
+    std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, ExpiryAfter> m_expiryHeap;
+
+    // Recycled coefficient rows and payload buffers; capacity survives a
+    // round trip through the pool, so steady-state decoding stops hitting
+    // the allocator
+    std::vector<std::vector<uint8_t>> m_bufferPool;
+    std::vector<uint8_t> AcquireBuffer(size_t len);
+    void ReleaseBuffer(std::vector<uint8_t>&& buffer);
+    void ReleaseGenerationBuffers(FecGeneration& generation);
     
     // FEC Statistics
-    std::map<uint32_t, uint32_t> m_deviceOriginalPackets;
-    std::map<uint32_t, uint32_t> m_deviceRecoveredPackets;
-    std::map<uint32_t, uint32_t> m_deviceLostPackets;
+    std::unordered_map<uint32_t, uint32_t> m_deviceOriginalPackets;
+    std::unordered_map<uint32_t, uint32_t> m_deviceRecoveredPackets;
+    std::unordered_map<uint32_t, uint32_t> m_deviceLostPackets;
 
     // FEC Methods
+    // Reduce one (coefficients, payload) row against a generation's echelon
+    // form; returns whether the row was innovative (raised the rank)
+    bool ReduceIntoEchelon(FecGeneration& generation,
+                           std::vector<uint8_t> coeffs,
+                           std::vector<uint8_t> payload);
+    // Coefficient vector of a redundant packet, derived deterministically
+    // from its generation and index so the encoder can produce the same one
+    std::vector<uint8_t> GenerateCoefficients(uint16_t generationId,
+                                              uint32_t redundantIndex,
+                                              uint32_t generationSize);
     bool AttemptFecRecovery(uint32_t deviceAddr, uint16_t generationId);
     std::vector<Ptr<Packet>> SolveFecSystem(FecGeneration& generation);
     void DeliverApplicationPackets(uint32_t deviceAddr, const std::vector<Ptr<Packet>>& packets);
@@ -83,6 +142,16 @@ class FecComponent : public NetworkControllerComponent
     void InitializeGfTables();
     std::vector<uint8_t> m_gfExp;
     std::vector<uint8_t> m_gfLog;
+
+    // Whole-row GF(256) kernels for decoding: dst ^= coeff * src and
+    // row *= coeff over len bytes. Each coefficient has two 16-entry
+    // split-nibble product tables so a byte costs two lookups and a xor;
+    // on SSSE3 targets the same tables feed PSHUFB to process 16 bytes
+    // per step, with the scalar path covering tails and other targets
+    void GfMulAddRow(uint8_t* dst, const uint8_t* src, size_t len, uint8_t coeff);
+    void GfMulRow(uint8_t* row, size_t len, uint8_t coeff);
+    std::vector<std::array<uint8_t, 16>> m_gfMulNibbleLo;
+    std::vector<std::array<uint8_t, 16>> m_gfMulNibbleHi;
 };
 
 } // namespace lorawan
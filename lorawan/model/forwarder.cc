@@ -9,6 +9,7 @@
 #include "forwarder.h"
 
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 
 namespace ns3
 {
@@ -25,7 +26,14 @@ Forwarder::GetTypeId()
     static TypeId tid = TypeId("ns3::Forwarder")
                             .SetParent<Application>()
                             .AddConstructor<Forwarder>()
-                            .SetGroupName("lorawan");
+                            .SetGroupName("lorawan")
+                            .AddAttribute("UplinkBatchWindow",
+                                          "How long to hold received uplinks before handing "
+                                          "them to the point-to-point device in one burst; "
+                                          "zero forwards each uplink immediately.",
+                                          TimeValue(Seconds(0)),
+                                          MakeTimeAccessor(&Forwarder::m_batchWindow),
+                                          MakeTimeChecker());
     return tid;
 }
 
@@ -63,13 +71,38 @@ Forwarder::ReceiveFromLora(Ptr<NetDevice> loraNetDevice,
 {
     NS_LOG_FUNCTION(this << packet << protocol << sender);
 
-    Ptr<Packet> packetCopy = packet->Copy();
+    // Packet buffers are copy-on-write, so the original packet can go to
+    // the device as is: any header the device adds lands in a private
+    // buffer, and nothing upstream touches the packet after this callback
+    Ptr<Packet> uplink = ConstCast<Packet>(packet);
 
-    m_pointToPointNetDevice->Send(packetCopy, m_pointToPointNetDevice->GetBroadcast(), 0x800);
+    if (m_batchWindow.IsZero())
+    {
+        m_pointToPointNetDevice->Send(uplink, m_pointToPointNetDevice->GetBroadcast(), 0x800);
+        return true;
+    }
+
+    m_uplinkBatch.push_back(uplink);
+    if (!m_batchEvent.IsPending())
+    {
+        m_batchEvent = Simulator::Schedule(m_batchWindow, &Forwarder::FlushUplinkBatch, this);
+    }
 
     return true;
 }
 
+void
+Forwarder::FlushUplinkBatch()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto& uplink : m_uplinkBatch)
+    {
+        m_pointToPointNetDevice->Send(uplink, m_pointToPointNetDevice->GetBroadcast(), 0x800);
+    }
+    m_uplinkBatch.clear();
+}
+
 bool
 Forwarder::ReceiveFromPointToPoint(Ptr<NetDevice> pointToPointNetDevice,
                                    Ptr<const Packet> packet,
@@ -78,9 +111,8 @@ Forwarder::ReceiveFromPointToPoint(Ptr<NetDevice> pointToPointNetDevice,
 {
     NS_LOG_FUNCTION(this << packet << protocol << sender);
 
-    Ptr<Packet> packetCopy = packet->Copy();
-
-    m_loraNetDevice->Send(packetCopy);
+    // Same copy-on-write argument as the uplink direction
+    m_loraNetDevice->Send(ConstCast<Packet>(packet));
 
     return true;
 }
@@ -98,6 +130,10 @@ Forwarder::StopApplication()
 {
     NS_LOG_FUNCTION_NOARGS();
 
+    // Do not lose uplinks held in an open batch window
+    m_batchEvent.Cancel();
+    FlushUplinkBatch();
+
     // TODO Get rid of callbacks
 }
 
@@ -13,9 +13,12 @@
 
 #include "ns3/application.h"
 #include "ns3/attribute.h"
+#include "ns3/event-id.h"
 #include "ns3/nstime.h"
 #include "ns3/point-to-point-net-device.h"
 
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -88,10 +91,29 @@ class Forwarder : public Application
     void StopApplication() override;
 
   private:
+    /**
+     * Hand all uplinks buffered during the batch window to the
+     * point-to-point device in one burst.
+     */
+    void FlushUplinkBatch();
+
     Ptr<LoraNetDevice> m_loraNetDevice; //!< Pointer to the node's LoraNetDevice
 
     Ptr<PointToPointNetDevice> m_pointToPointNetDevice; //!< Pointer to the P2PNetDevice we use to
                                                         //!< communicate with the network server
+
+    /**
+     * How long to hold received uplinks before handing them to the
+     * point-to-point device in one burst. Zero (the default) forwards each
+     * uplink immediately. The device still serializes packets one by one;
+     * batching amortizes the per-uplink scheduling work, at the cost of
+     * delaying each uplink by up to one window. Keep it small against the
+     * receive window timing of the devices behind this gateway.
+     */
+    Time m_batchWindow;
+
+    std::vector<Ptr<Packet>> m_uplinkBatch; //!< Uplinks buffered during the current window.
+    EventId m_batchEvent;                   //!< The pending FlushUplinkBatch event.
 };
 
 } // namespace lorawan
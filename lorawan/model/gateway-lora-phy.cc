@@ -116,7 +116,9 @@ GatewayLoraPhy::GetTypeId()
 }
 
 GatewayLoraPhy::GatewayLoraPhy()
-    : m_isTransmitting(false)
+    : m_nReceptionPaths(0),
+      m_freeReceptionPathsMask(0),
+      m_isTransmitting(false)
 {
     NS_LOG_FUNCTION_NOARGS();
 }
@@ -126,16 +128,17 @@ GatewayLoraPhy::~GatewayLoraPhy()
     NS_LOG_FUNCTION_NOARGS();
 }
 
-// Uplink sensitivity (Source: SX1301 datasheet)
-// {SF7, SF8, SF9, SF10, SF11, SF12}
-const double GatewayLoraPhy::sensitivity[6] = {-130.0, -132.5, -135.0, -137.5, -140.0, -142.5};
-
 void
 GatewayLoraPhy::AddReceptionPath()
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    m_receptionPaths.push_back(Create<GatewayLoraPhy::ReceptionPath>());
+    NS_ASSERT_MSG(m_nReceptionPaths < MAX_RECEPTION_PATHS,
+                  "The SX1301 chip has at most " << MAX_RECEPTION_PATHS << " reception paths");
+
+    m_receptionPaths[m_nReceptionPaths] = Create<GatewayLoraPhy::ReceptionPath>();
+    m_freeReceptionPathsMask |= uint8_t(1 << m_nReceptionPaths);
+    m_nReceptionPaths++;
 }
 
 void
@@ -143,7 +146,9 @@ GatewayLoraPhy::ResetReceptionPaths()
 {
     NS_LOG_FUNCTION(this);
 
-    m_receptionPaths.clear();
+    m_receptionPaths.fill(nullptr);
+    m_nReceptionPaths = 0;
+    m_freeReceptionPathsMask = 0;
 }
 
 void
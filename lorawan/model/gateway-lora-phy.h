@@ -10,6 +10,7 @@
 #define GATEWAY_LORA_PHY_H
 
 #include "lora-phy.h"
+#include "lora-radio-tables.h"
 
 #include "ns3/mobility-model.h"
 #include "ns3/net-device.h"
@@ -18,6 +19,7 @@
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 
+#include <array>
 #include <list>
 
 namespace ns3
@@ -93,8 +95,12 @@ class GatewayLoraPhy : public LoraPhy
      */
     void AddFrequency(uint32_t frequencyHz);
 
-    static const double sensitivity[6]; //!< A vector containing the sensitivities required to
-                                        //!< correctly decode different spreading factors.
+    /**
+     * The sensitivities required to correctly decode the different
+     * spreading factors, indexed by SF minus 7. An alias of the
+     * module-wide constexpr table.
+     */
+    static constexpr std::array<double, 6> sensitivity = GATEWAY_SENSITIVITY_DBM;
     
     // Packet, RSSI, SNIR, Gateway Node ID
     TracedCallback<Ptr<const Packet>, double, double, uint32_t> m_phyRxOkRssiSnir;
@@ -185,8 +191,25 @@ class GatewayLoraPhy : public LoraPhy
                                      //!< locked on finishes reception.
     };
 
-    std::list<Ptr<ReceptionPath>> m_receptionPaths; //!< A list containing the various parallel
-                                                    //!< receivers that are managed by this gateway.
+    /**
+     * The maximum number of parallel receive paths of the SX1301 chip.
+     */
+    static constexpr uint32_t MAX_RECEPTION_PATHS = 8;
+
+    /**
+     * The parallel receivers managed by this gateway, in a fixed array so
+     * that availability can be tracked with the m_freeReceptionPathsMask
+     * bitmask. Only the first m_nReceptionPaths entries are configured.
+     */
+    std::array<Ptr<ReceptionPath>, MAX_RECEPTION_PATHS> m_receptionPaths;
+
+    uint32_t m_nReceptionPaths; //!< The number of configured reception paths.
+
+    /**
+     * Occupancy bitmask of the reception paths: bit i is set when path i is
+     * free, so finding an available demodulator is a count-trailing-zeros.
+     */
+    uint8_t m_freeReceptionPathsMask;
 
     TracedValue<int> m_occupiedReceptionPaths; //!< The number of occupied reception paths.
 
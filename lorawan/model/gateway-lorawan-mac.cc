@@ -13,6 +13,7 @@
 #include "lorawan-mac-header.h"
 
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 
 namespace ns3
 {
@@ -29,7 +30,14 @@ GatewayLorawanMac::GetTypeId()
     static TypeId tid = TypeId("ns3::GatewayLorawanMac")
                             .SetParent<LorawanMac>()
                             .AddConstructor<GatewayLorawanMac>()
-                            .SetGroupName("lorawan");
+                            .SetGroupName("lorawan")
+                            .AddAttribute("DownlinkQueueSlack",
+                                          "Maximum time a duty-cycle-blocked downlink may wait "
+                                          "in the gateway queue before being dropped. Zero keeps "
+                                          "the legacy behavior of dropping it immediately.",
+                                          TimeValue(Seconds(0)),
+                                          MakeTimeAccessor(&GatewayLorawanMac::m_downlinkQueueSlack),
+                                          MakeTimeChecker());
     return tid;
 }
 
@@ -48,25 +56,92 @@ GatewayLorawanMac::Send(Ptr<Packet> packet)
 {
     NS_LOG_FUNCTION(this << packet);
 
-    // Get data rate to send this packet with
     LoraTag tag;
-    packet->RemovePacketTag(tag);
-    uint8_t dataRate = tag.GetDataRate();
+    packet->PeekPacketTag(tag);
     uint32_t frequencyHz = tag.GetFrequency();
-    NS_LOG_DEBUG("DR: " << unsigned(dataRate));
-    NS_LOG_DEBUG("SF: " << unsigned(GetSfFromDataRate(dataRate)));
-    NS_LOG_DEBUG("BW: " << GetBandwidthFromDataRate(dataRate));
-    NS_LOG_DEBUG("Freq: " << frequencyHz << " Hz");
-    packet->AddPacketTag(tag);
 
     // Make sure we can transmit this packet
-    if (GetWaitTime(frequencyHz).IsStrictlyPositive())
+    Time waitTime = GetWaitTime(frequencyHz);
+    if (waitTime.IsStrictlyPositive())
     {
-        // We cannot send now!
-        NS_LOG_WARN("Trying to send a packet but Duty Cycle won't allow it. Aborting.");
+        if (m_downlinkQueueSlack.IsZero() || waitTime > m_downlinkQueueSlack)
+        {
+            // We cannot send now!
+            NS_LOG_WARN("Trying to send a packet but Duty Cycle won't allow it. Aborting.");
+            return;
+        }
+
+        // Book the first slot the sub-band budget allows and queue the packet
+        NS_LOG_INFO("Duty cycle blocks this downlink; booking a slot in "
+                    << waitTime.As(Time::S));
+        m_downlinkQueue.push(
+            {Now() + waitTime, Now() + m_downlinkQueueSlack, m_downlinkSeq++, packet});
+        if (!m_drainEvent.IsPending() || waitTime < Simulator::GetDelayLeft(m_drainEvent))
+        {
+            Simulator::Cancel(m_drainEvent);
+            m_drainEvent =
+                Simulator::Schedule(waitTime, &GatewayLorawanMac::DrainDownlinkQueue, this);
+        }
         return;
     }
 
+    DoSend(packet);
+}
+
+void
+GatewayLorawanMac::DrainDownlinkQueue()
+{
+    NS_LOG_FUNCTION(this);
+
+    while (!m_downlinkQueue.empty())
+    {
+        if (m_downlinkQueue.top().readyTime > Now())
+        {
+            m_drainEvent = Simulator::Schedule(m_downlinkQueue.top().readyTime - Now(),
+                                               &GatewayLorawanMac::DrainDownlinkQueue,
+                                               this);
+            return;
+        }
+
+        PendingDownlink next = m_downlinkQueue.top();
+        m_downlinkQueue.pop();
+
+        LoraTag tag;
+        next.packet->PeekPacketTag(tag);
+        Time waitTime = GetWaitTime(tag.GetFrequency());
+        if (waitTime.IsZero())
+        {
+            DoSend(next.packet);
+        }
+        else if (Now() + waitTime <= next.deadline)
+        {
+            // An earlier transmission consumed the budget again: re-book
+            next.readyTime = Now() + waitTime;
+            m_downlinkQueue.push(next);
+        }
+        else
+        {
+            NS_LOG_WARN("Dropping queued downlink: duty cycle still blocked at its deadline");
+        }
+    }
+}
+
+void
+GatewayLorawanMac::DoSend(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+
+    // Get data rate to send this packet with. The tag is only read here, so a
+    // peek avoids rewriting the packet's tag list on every downlink
+    LoraTag tag;
+    packet->PeekPacketTag(tag);
+    uint8_t dataRate = tag.GetDataRate();
+    uint32_t frequencyHz = tag.GetFrequency();
+    NS_LOG_DEBUG("DR: " << unsigned(dataRate));
+    NS_LOG_DEBUG("SF: " << unsigned(GetSfFromDataRate(dataRate)));
+    NS_LOG_DEBUG("BW: " << GetBandwidthFromDataRate(dataRate));
+    NS_LOG_DEBUG("Freq: " << frequencyHz << " Hz");
+
     LoraTxParameters params;
     params.sf = GetSfFromDataRate(dataRate);
     params.headerDisabled = false;
@@ -12,6 +12,11 @@
 #include "lora-tag.h"
 #include "lorawan-mac.h"
 
+#include "ns3/event-id.h"
+
+#include <queue>
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -62,6 +67,60 @@ class GatewayLorawanMac : public LorawanMac
     Time GetWaitTime(uint32_t frequencyHz);
 
   private:
+    /**
+     * Hand a packet to the PHY layer, registering the duty cycle consumption
+     * with the channel helper. Transmission parameters are read from the
+     * packet's LoraTag.
+     *
+     * @param packet The packet to send.
+     */
+    void DoSend(Ptr<Packet> packet);
+
+    /**
+     * Send or drop the queued downlinks whose booked slot has arrived, and
+     * re-arm the drain event for the earliest remaining booking.
+     */
+    void DrainDownlinkQueue();
+
+    /// A downlink waiting for its sub-band duty cycle budget to replenish.
+    struct PendingDownlink
+    {
+        Time readyTime;     //!< Earliest time the sub-band allows this transmission.
+        Time deadline;      //!< Latest acceptable transmission time before dropping.
+        uint64_t seq;       //!< Submission order, to break ties between equal bookings.
+        Ptr<Packet> packet; //!< The downlink packet.
+    };
+
+    /// Order pending downlinks by booked slot, then by submission order.
+    struct PendingDownlinkLater
+    {
+        bool operator()(const PendingDownlink& a, const PendingDownlink& b) const
+        {
+            return a.readyTime > b.readyTime ||
+                   (a.readyTime == b.readyTime && a.seq > b.seq);
+        }
+    };
+
+    /**
+     * Downlinks blocked by duty cycle, ordered by the future slot they
+     * booked. The channel helper already meters each sub-band's budget, so a
+     * booking is just the helper's wait time at submission; insertions and
+     * drains cost O(log n).
+     */
+    std::priority_queue<PendingDownlink, std::vector<PendingDownlink>, PendingDownlinkLater>
+        m_downlinkQueue;
+
+    /**
+     * How long a duty-cycle-blocked downlink may wait in the queue before
+     * being dropped. Zero (the default) keeps the legacy behavior of
+     * dropping blocked downlinks immediately.
+     */
+    Time m_downlinkQueueSlack;
+
+    EventId m_drainEvent; //!< The pending DrainDownlinkQueue event, if any.
+
+    uint64_t m_downlinkSeq{0}; //!< Monotonic counter stamping submission order.
+
   protected:
 };
 
@@ -10,6 +10,8 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 namespace lorawan
@@ -17,6 +19,49 @@ namespace lorawan
 
 NS_LOG_COMPONENT_DEFINE("GatewayStatus");
 
+namespace
+{
+/// One sub-band of the EU868 band plan, mirroring the MAC helpers'
+/// configuration.
+struct SubBandEntry
+{
+    uint32_t lowHz;    //!< Lower edge of the sub-band [Hz]
+    uint32_t highHz;   //!< Upper edge of the sub-band [Hz]
+    double dutyCycle;  //!< Regulatory duty cycle fraction
+};
+
+constexpr SubBandEntry EU868_SUB_BANDS[] = {
+    {863000000, 865000000, 0.001},
+    {865000000, 868000000, 0.01},
+    {868000000, 868600000, 0.01},
+    {868700000, 869200000, 0.001},
+    {869400000, 869650000, 0.1},
+    {869700000, 870000000, 0.01},
+};
+
+const SubBandEntry*
+FindSubBand(uint32_t frequencyHz)
+{
+    for (const auto& subBand : EU868_SUB_BANDS)
+    {
+        if (frequencyHz >= subBand.lowHz && frequencyHz <= subBand.highHz)
+        {
+            return &subBand;
+        }
+    }
+    return nullptr;
+}
+
+/// Bucket key of a frequency: the sub-band's lower edge, or the frequency
+/// itself for out-of-plan transmissions.
+uint32_t
+SubBandKey(uint32_t frequencyHz)
+{
+    const SubBandEntry* subBand = FindSubBand(frequencyHz);
+    return subBand ? subBand->lowHz : frequencyHz;
+}
+} // namespace
+
 TypeId
 GatewayStatus::GetTypeId()
 {
@@ -40,8 +85,7 @@ GatewayStatus::GatewayStatus(Address address,
                              Ptr<GatewayLorawanMac> gwMac)
     : m_address(address),
       m_netDevice(netDevice),
-      m_gatewayMac(gwMac),
-      m_nextTransmissionTime(Time(0))
+      m_gatewayMac(gwMac)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -85,13 +129,31 @@ GatewayStatus::IsAvailableForTransmission(uint32_t frequencyHz)
 {
     // We can't send multiple packets at once, see SX1301 V2.01 page 29
 
-    // Check that the gateway was not already "booked"
-    if (m_nextTransmissionTime > Now() - MilliSeconds(1))
+    // Check the sub-band's token bucket first: it accounts the downlinks
+    // the server has already committed, including those still in flight on
+    // the backhaul that the gateway MAC does not know about yet
+    DutyCycleBucket& bucket = BucketFor(frequencyHz);
+    Refill(bucket);
+    if (bucket.tokens.IsStrictlyNegative())
     {
-        NS_LOG_INFO("This gateway is already booked for a transmission");
+        NS_LOG_INFO("This gateway's sub-band is in duty cycle debt");
+
+        // Remember until when, so later polls can skip the full check
+        m_nextFreeTimes[frequencyHz] = GetWhenNextFree(frequencyHz);
+
         return false;
     }
 
+    if (!m_gatewayMac)
+    {
+        // Remote gateway (different MPI rank): the server only has
+        // message-level knowledge of it, so availability is judged from the
+        // bookings above. Radio and duty cycle constraints are enforced by
+        // the gateway's own MAC when the downlink arrives over the link,
+        // mirroring the stale view a real network server operates on.
+        return true;
+    }
+
     // Check that the gateway is not already in TX mode
     if (m_gatewayMac->IsTransmitting())
     {
@@ -106,16 +168,83 @@ GatewayStatus::IsAvailableForTransmission(uint32_t frequencyHz)
         NS_LOG_INFO("Gateway cannot be used because of duty cycle");
         NS_LOG_INFO("Wait time at current gateway: " << waitTime.As(Time::S));
 
+        // Remember until when, so later polls can skip the full check
+        m_nextFreeTimes[frequencyHz] = Now() + waitTime;
+
         return false;
     }
 
     return true;
 }
 
+Time
+GatewayStatus::GetNextFreeTime(uint32_t frequencyHz) const
+{
+    Time nextFreeTime = GetWhenNextFree(frequencyHz);
+    auto it = m_nextFreeTimes.find(frequencyHz);
+    if (it != m_nextFreeTimes.end())
+    {
+        nextFreeTime = std::max(nextFreeTime, it->second);
+    }
+    return nextFreeTime;
+}
+
 void
-GatewayStatus::SetNextTransmissionTime(Time nextTransmissionTime)
+GatewayStatus::BookTransmission(uint32_t frequencyHz, Time duration)
+{
+    NS_LOG_FUNCTION(this << frequencyHz << duration);
+
+    DutyCycleBucket& bucket = BucketFor(frequencyHz);
+    Refill(bucket);
+    bucket.tokens -= duration;
+}
+
+Time
+GatewayStatus::GetWhenNextFree(uint32_t frequencyHz) const
+{
+    auto it = m_dutyCycleBuckets.find(SubBandKey(frequencyHz));
+    if (it == m_dutyCycleBuckets.end())
+    {
+        return Time(0); // Nothing booked on this sub-band yet
+    }
+
+    const DutyCycleBucket& bucket = it->second;
+    Time tokens = std::min(MilliSeconds(MAX_CREDIT_MS),
+                           bucket.tokens + (Now() - bucket.lastRefill) * bucket.dutyCycle);
+    if (!tokens.IsStrictlyNegative())
+    {
+        return Now();
+    }
+    // Debt is repaid at the duty cycle rate
+    return Now() + Time(int64_t(-tokens.GetTimeStep() / bucket.dutyCycle));
+}
+
+GatewayStatus::DutyCycleBucket&
+GatewayStatus::BucketFor(uint32_t frequencyHz)
+{
+    auto [it, inserted] = m_dutyCycleBuckets.try_emplace(SubBandKey(frequencyHz));
+    if (inserted)
+    {
+        it->second.dutyCycle = SubBandDutyCycle(frequencyHz);
+        it->second.lastRefill = Now();
+    }
+    return it->second;
+}
+
+void
+GatewayStatus::Refill(DutyCycleBucket& bucket)
+{
+    Time now = Now();
+    bucket.tokens = std::min(MilliSeconds(MAX_CREDIT_MS),
+                             bucket.tokens + (now - bucket.lastRefill) * bucket.dutyCycle);
+    bucket.lastRefill = now;
+}
+
+double
+GatewayStatus::SubBandDutyCycle(uint32_t frequencyHz)
 {
-    m_nextTransmissionTime = nextTransmissionTime;
+    const SubBandEntry* subBand = FindSubBand(frequencyHz);
+    return subBand ? subBand->dutyCycle : 0.01;
 }
 } // namespace lorawan
 } // namespace ns3
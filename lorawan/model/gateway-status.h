@@ -15,6 +15,8 @@
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 
+#include <map>
+
 namespace ns3
 {
 namespace lorawan
@@ -49,7 +51,8 @@ class GatewayStatus : public Object
      *
      * @param address The Address of the P2PNetDevice of the gateway connected to the network
      * server. @param netDevice A pointer to the NetDevice through which to reach this gateway from
-     * the server. @param gwMac A pointer to the MAC layer of the gateway.
+     * the server. @param gwMac A pointer to the MAC layer of the gateway, or nullptr when the
+     * gateway lives on a different MPI rank and its MAC cannot be queried directly.
      */
     GatewayStatus(Address address, Ptr<NetDevice> netDevice, Ptr<GatewayLorawanMac> gwMac);
 
@@ -84,7 +87,8 @@ class GatewayStatus : public Object
     /**
      * Get a pointer to this gateway's MAC instance.
      *
-     * @return A pointer to the MAC layer object.
+     * @return A pointer to the MAC layer object, nullptr for a gateway on a
+     * different MPI rank.
      */
     Ptr<GatewayLorawanMac> GetGatewayMac();
 
@@ -97,20 +101,96 @@ class GatewayStatus : public Object
      * Query whether or not this gateway is available for immediate transmission
      * on this frequency.
      *
+     * For a gateway without a MAC pointer (one hosted on a different MPI
+     * rank), only the server-side bookings are consulted; the gateway's MAC
+     * enforces its own radio and duty cycle constraints on its rank.
+     *
      * @param frequencyHz The frequency [Hz] at which the gateway's availability should be queried.
      * @return True if the gateway's available, false otherwise.
      */
     bool IsAvailableForTransmission(uint32_t frequencyHz);
 
     /**
-     * Set the time of the next scheduled transmission for the gateway.
+     * Get the time at which this gateway is next expected to be free for
+     * transmission on a frequency, as last learned from an availability check.
+     *
+     * Duty cycle wait times only shrink as time passes (new bookings are
+     * re-learned at the next full check), so a caller can skip the full
+     * availability query, and its duty cycle computation in the gateway's
+     * MAC, while this time is in the future.
      *
-     * @param nextTransmissionTime The Time value.
+     * @param frequencyHz The frequency [Hz] the availability refers to.
+     * @return The cached next-free time, Time(0) if nothing was learned yet.
      */
-    void SetNextTransmissionTime(Time nextTransmissionTime);
-    // Time GetNextTransmissionTime ();
+    Time GetNextFreeTime(uint32_t frequencyHz) const;
+
+    /**
+     * Book a transmission's airtime against the sub-band's token bucket.
+     *
+     * Called by the server when it commits a downlink to this gateway, so
+     * availability checks made before the packet has crossed the backhaul
+     * link (and updated the gateway MAC's own duty cycle state) already see
+     * the capacity as spent. The bucket may go into debt; it earns credit
+     * back at the sub-band's duty cycle rate.
+     *
+     * @param frequencyHz The downlink frequency [Hz].
+     * @param duration The downlink's time on air.
+     */
+    void BookTransmission(uint32_t frequencyHz, Time duration);
+
+    /**
+     * Get the time at which the sub-band's token bucket is out of debt,
+     * i.e. the earliest instant a further downlink could be booked. O(1).
+     *
+     * @param frequencyHz The frequency [Hz] to query.
+     * @return Now or earlier if a booking is possible immediately.
+     */
+    Time GetWhenNextFree(uint32_t frequencyHz) const;
 
   private:
+    /**
+     * Per-sub-band transmission credit, the server-side model of the
+     * regulatory duty cycle. Credit accrues at the sub-band's duty cycle
+     * rate up to a small burst allowance and every booked downlink spends
+     * its time on air, so each sub-band is throttled independently instead
+     * of the whole gateway serializing on one timestamp.
+     */
+    struct DutyCycleBucket
+    {
+        double dutyCycle = 0.01; //!< Fraction of time the sub-band may be occupied
+        Time tokens;             //!< Accrued credit; negative while in debt
+        Time lastRefill;         //!< When the credit was last brought forward
+    };
+
+    /**
+     * Get (creating at the sub-band's duty cycle if needed) the bucket
+     * covering a frequency.
+     *
+     * @param frequencyHz The frequency [Hz].
+     * @return Reference to the bucket.
+     */
+    DutyCycleBucket& BucketFor(uint32_t frequencyHz);
+
+    /**
+     * Bring a bucket's credit forward to now.
+     *
+     * @param bucket The bucket to refill.
+     */
+    static void Refill(DutyCycleBucket& bucket);
+
+    /**
+     * Look up the regulatory duty cycle of the sub-band covering a
+     * frequency, from the EU868 band plan the MAC helpers configure.
+     *
+     * @param frequencyHz The frequency [Hz].
+     * @return The duty cycle fraction; 1% for frequencies outside the plan.
+     */
+    static double SubBandDutyCycle(uint32_t frequencyHz);
+
+    /// Burst allowance of each bucket: enough credit for one long downlink,
+    /// but not for the unbounded catch-up bursts real regulators disallow.
+    static constexpr int64_t MAX_CREDIT_MS = 2000;
+
     Address m_address; //!< The Address of the P2PNetDevice of this gateway
 
     Ptr<NetDevice>
@@ -118,7 +198,18 @@ class GatewayStatus : public Object
 
     Ptr<GatewayLorawanMac> m_gatewayMac; //!< The Mac layer of the gateway
 
-    Time m_nextTransmissionTime; //!< This gateway's next transmission time
+    /**
+     * The duty cycle buckets, keyed by the lower edge of their sub-band
+     * (or by the exact frequency for out-of-plan transmissions).
+     */
+    std::map<uint32_t, DutyCycleBucket> m_dutyCycleBuckets;
+
+    /**
+     * The next time this gateway is free on each frequency, learned from
+     * refused availability checks, so that repeated polls of a duty cycle
+     * constrained gateway do not query its MAC every time.
+     */
+    std::map<uint32_t, Time> m_nextFreeTimes;
 };
 } // namespace lorawan
 
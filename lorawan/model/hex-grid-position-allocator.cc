@@ -36,37 +36,12 @@ HexGridPositionAllocator::HexGridPositionAllocator()
     : m_radius(6000)
 {
     NS_LOG_FUNCTION_NOARGS();
-
-    // Create the first position
-    m_positions.emplace_back(0.0, 0.0, 0.0);
-
-    // Add rings
-    for (int i = 0; i < 20; i++)
-    {
-        m_positions = AddRing(m_positions);
-    }
-
-    // Set the iterator
-    m_next = m_positions.begin();
 }
 
 HexGridPositionAllocator::HexGridPositionAllocator(double radius)
     : m_radius(radius)
 {
     NS_LOG_FUNCTION_NOARGS();
-
-    // Create the first position
-    m_positions.emplace_back(0.0, 0.0, 0.0);
-
-    // Add a couple rings
-    // Add rings
-    for (int i = 0; i < 20; i++)
-    {
-        m_positions = AddRing(m_positions);
-    }
-
-    // Set the iterator
-    m_next = m_positions.begin();
 }
 
 HexGridPositionAllocator::~HexGridPositionAllocator()
@@ -91,62 +66,54 @@ HexGridPositionAllocator::SetRadius(double radius)
 Vector
 HexGridPositionAllocator::GetNext() const
 {
-    // TODO: Check that there is a next element
-    Vector position = *m_next;
-    m_next++;
-    return position;
+    return GetPosition(m_nextIndex++);
 }
 
-int64_t
-HexGridPositionAllocator::AssignStreams(int64_t stream)
+Vector
+HexGridPositionAllocator::GetPosition(uint32_t index) const
 {
-    return 0;
+    if (index == 0)
+    {
+        return Vector(0.0, 0.0, 0.0);
+    }
+
+    // Ring r >= 1 holds the 6r indices starting at f(r) = 3r(r-1) + 1; invert
+    // f to find the ring, with an integer fix-up for rounding at the seams
+    uint32_t ring = static_cast<uint32_t>((3.0 + std::sqrt(12.0 * index - 3.0)) / 6.0);
+    while (3 * ring * (ring - 1) + 1 > index)
+    {
+        ring--;
+    }
+    while (3 * (ring + 1) * ring + 1 <= index)
+    {
+        ring++;
+    }
+
+    // Walk the ring: start at the top corner, then cover one side per
+    // direction, each side being `ring` steps long
+    uint32_t offset = index - (3 * ring * (ring - 1) + 1);
+    uint32_t side = offset / ring;
+    uint32_t step = offset % ring;
+
+    Vector corner = Direction(side);
+    Vector next = Direction(side + 1);
+    return Vector(ring * corner.x + step * (next.x - corner.x),
+                  ring * corner.y + step * (next.y - corner.y),
+                  0.0);
 }
 
-std::vector<Vector>
-HexGridPositionAllocator::AddRing(std::vector<Vector> positions)
+Vector
+HexGridPositionAllocator::Direction(uint32_t k) const
 {
-    NS_LOG_FUNCTION(this);
-
-    // Make a copy of the vector
-    std::vector<Vector> copy = positions;
+    // Anti-clockwise from the top, measured against the vertical axis
+    double angle = (k % 6) * pi / 3;
+    return Vector(-2 * m_radius * std::sin(angle), 2 * m_radius * std::cos(angle), 0.0);
+}
 
-    // Iterate on the given vector
-    for (auto it = positions.begin(); it != positions.end(); it++)
-    {
-        // Get the current position
-        Vector currentPosition = *it;
-        NS_LOG_DEBUG("Current position " << currentPosition);
-
-        // Iterate to create the 6 surrounding positions
-        // The angle is with respect to a vertical line
-        Vector newPosition;
-        for (double angle = 0; angle < 2 * pi; angle += pi / 3)
-        {
-            newPosition = Vector(currentPosition.x + 2 * m_radius * std::sin(angle),
-                                 currentPosition.y + 2 * m_radius * std::cos(angle),
-                                 currentPosition.z);
-            NS_LOG_DEBUG("New position: " << newPosition);
-
-            // If the newly created position is not already in the copy, add it
-            bool found = false;
-            for (auto it = copy.begin(); it != copy.end(); it++)
-            {
-                // If the vector is already in the vector
-                // 1 is an EPSILON used to determine whether two floats are equal
-                if (CalculateDistance(newPosition, *it) < 10)
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
-            {
-                NS_LOG_DEBUG("Adding position " << newPosition);
-                copy.push_back(newPosition);
-            }
-        }
-    }
-    return copy;
+int64_t
+HexGridPositionAllocator::AssignStreams(int64_t stream)
+{
+    return 0;
 }
+
 } // namespace ns3
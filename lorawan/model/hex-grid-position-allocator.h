@@ -21,7 +21,8 @@ namespace ns3
  *
  * Starting with a first hexagon in the axes' center, following tiles are added in outward
  * rings. The first position returned for a new ring is always the top one, followed by the others
- * in anti-clockwise rotation.
+ * in anti-clockwise rotation. Positions are computed on demand from ring arithmetic, so the
+ * tiling is unbounded and no part of the grid is stored.
  *
  * Visual example with 10 tiles, indexed 0-9:
  *
@@ -84,6 +85,20 @@ class HexGridPositionAllocator : public PositionAllocator
 
     Vector GetNext() const override;
 
+    /**
+     * Compute the position of the tile with the given index in closed form.
+     *
+     * Index 0 is the central tile; ring \f$r\geq1\f$ holds the \f$6r\f$
+     * indices starting at \f$3r(r-1)+1\f$, beginning with the top position
+     * and proceeding anti-clockwise. Positions are derived from ring
+     * arithmetic alone, so no part of the grid is materialized and any index
+     * can be generated in O(1).
+     *
+     * @param index The tile index.
+     * @return The position of that tile's center.
+     */
+    Vector GetPosition(uint32_t index) const;
+
     int64_t AssignStreams(int64_t stream) override;
 
     /**
@@ -108,16 +123,16 @@ class HexGridPositionAllocator : public PositionAllocator
 
   private:
     /**
-     * This method adds to the given list of positions an outer ring of positions.
+     * The center offset of the k-th of the six neighbor directions,
+     * anti-clockwise from the top.
      *
-     * @param positions The list of position around which to create the new positions.
-     * @return The input list of position with an added outer ring.
+     * @param k The direction index (taken modulo 6).
+     * @return The offset between the centers of two adjacent tiles.
      */
-    std::vector<Vector> AddRing(std::vector<Vector> positions);
+    Vector Direction(uint32_t k) const;
+
+    mutable uint32_t m_nextIndex = 0; //!< The index of the next position to return
 
-    std::vector<Vector> m_positions; //!< The current list of positions
-    mutable std::vector<Vector>::const_iterator
-        m_next;      //!< The iterator pointing to the next position to return
     double m_radius; //!< The radius of a cell (defined as the half the distance between two
                      //!< adjacent nodes, that is, the radius of the circle inscribed in each
                      //!< hexagonal tile)
@@ -10,6 +10,9 @@
 
 #include "ns3/simulator.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace ns3
 {
 namespace lorawan
@@ -34,19 +37,129 @@ std::vector<Ptr<LogicalLoraChannel>>
 LogicalLoraChannelHelper::GetRawChannelArray() const
 {
     NS_LOG_FUNCTION(this);
-    return m_channelVec;
+    return Channels();
+}
+
+const std::vector<Ptr<SubBand>>&
+LogicalLoraChannelHelper::SubBands() const
+{
+    return m_sharedPlan ? m_sharedPlan->m_subBandList : m_subBandList;
+}
+
+const std::vector<Ptr<LogicalLoraChannel>>&
+LogicalLoraChannelHelper::Channels() const
+{
+    return m_sharedPlan ? m_sharedPlan->m_channelVec : m_channelVec;
+}
+
+int
+LogicalLoraChannelHelper::GetSubBandIndex(uint32_t frequencyHz) const
+{
+    const auto& index = m_sharedPlan ? m_sharedPlan->m_intervalIndex : m_intervalIndex;
+    // The only containment candidate is the last interval starting at or
+    // below the frequency, since sub-bands do not overlap
+    auto it = std::upper_bound(
+        index.begin(),
+        index.end(),
+        std::make_pair(frequencyHz, std::numeric_limits<uint32_t>::max()));
+    if (it == index.begin())
+    {
+        return -1;
+    }
+    --it;
+    return SubBands()[it->second]->Contains(frequencyHz) ? int(it->second) : -1;
+}
+
+void
+LogicalLoraChannelHelper::RebuildIntervalIndex()
+{
+    m_intervalIndex.clear();
+    m_intervalIndex.reserve(m_subBandList.size());
+    for (size_t i = 0; i < m_subBandList.size(); i++)
+    {
+        m_intervalIndex.emplace_back(m_subBandList[i]->GetFirstFrequency(), uint32_t(i));
+    }
+    std::sort(m_intervalIndex.begin(), m_intervalIndex.end());
+}
+
+void
+LogicalLoraChannelHelper::ShareFrom(Ptr<LogicalLoraChannelHelper> plan)
+{
+    NS_LOG_FUNCTION(this << plan);
+    NS_ASSERT_MSG(plan && !plan->m_sharedPlan, "Shared plans cannot be chained");
+
+    m_sharedPlan = plan;
+    m_subBandList.clear();
+    m_sortedSubBands.clear();
+    m_intervalIndex.clear();
+    m_subBandCache.clear();
+    m_channelVec.clear();
+    // Only the duty cycle timing state stays per device
+    m_nextTransmissionTimes.assign(plan->m_subBandList.size(), Time(0));
+}
+
+void
+LogicalLoraChannelHelper::Detach()
+{
+    if (!m_sharedPlan)
+    {
+        return;
+    }
+    NS_LOG_DEBUG("Materializing a private copy of the shared frequency plan");
+
+    for (size_t i = 0; i < m_sharedPlan->m_subBandList.size(); i++)
+    {
+        const auto& sb = m_sharedPlan->m_subBandList[i];
+        auto copy = Create<SubBand>(sb->GetFirstFrequency(),
+                                    sb->GetLastFrequency(),
+                                    sb->GetDutyCycle(),
+                                    sb->GetMaxTxPowerDbm());
+        copy->SetNextTransmissionTime(m_nextTransmissionTimes[i]);
+        m_subBandList.emplace_back(copy);
+    }
+    for (const auto& channel : m_sharedPlan->m_channelVec)
+    {
+        if (channel)
+        {
+            auto copy = Create<LogicalLoraChannel>(channel->GetFrequency(),
+                                                   channel->GetMinimumDataRate(),
+                                                   channel->GetMaximumDataRate());
+            if (!channel->IsEnabledForUplink())
+            {
+                copy->DisableForUplink();
+            }
+            m_channelVec.emplace_back(copy);
+        }
+        else
+        {
+            m_channelVec.emplace_back(nullptr);
+        }
+    }
+
+    m_sortedSubBands = m_subBandList;
+    m_subBandCache.clear();
+    m_nextTransmissionTimes.clear();
+    m_sharedPlan = nullptr;
+    SortSubBands();
+    RebuildIntervalIndex();
 }
 
 Ptr<SubBand>
 LogicalLoraChannelHelper::GetSubBandFromFrequency(uint32_t frequencyHz) const
 {
     NS_LOG_FUNCTION(this << frequencyHz);
-    for (const auto& sb : m_subBandList)
+    auto cached = m_subBandCache.find(frequencyHz);
+    if (cached != m_subBandCache.end())
     {
-        if (sb->Contains(frequencyHz))
-        {
-            return sb;
-        }
+        return cached->second;
+    }
+    int index = GetSubBandIndex(frequencyHz);
+    if (index >= 0)
+    {
+        // Sub-bands are never removed, so the resolution stays valid
+        auto subBand = SubBands()[index];
+        m_subBandCache[frequencyHz] = subBand;
+        return subBand;
     }
     NS_LOG_ERROR("[ERROR] Requested frequency " << frequencyHz << " Hz outside known sub-bands.");
     return nullptr; // If no SubBand is found, return nullptr
@@ -57,6 +170,7 @@ LogicalLoraChannelHelper::SetChannel(uint8_t chIndex, Ptr<LogicalLoraChannel> ch
 
 {
     NS_LOG_FUNCTION(this << unsigned(chIndex) << channel);
+    Detach(); // Mutations materialize a private copy of a shared plan
     NS_ASSERT_MSG(m_channelVec.size() > chIndex, "ChIndex > channel storage bounds");
     m_channelVec.at(chIndex) = channel;
 }
@@ -65,7 +179,74 @@ void
 LogicalLoraChannelHelper::AddSubBand(Ptr<SubBand> subBand)
 {
     NS_LOG_FUNCTION(this << subBand);
+    Detach(); // Mutations materialize a private copy of a shared plan
     m_subBandList.emplace_back(subBand);
+    m_sortedSubBands.emplace_back(subBand);
+    SortSubBands();
+    RebuildIntervalIndex();
+}
+
+void
+LogicalLoraChannelHelper::SortSubBands()
+{
+    std::sort(m_sortedSubBands.begin(),
+              m_sortedSubBands.end(),
+              [](const Ptr<SubBand>& a, const Ptr<SubBand>& b) {
+                  return a->GetNextTransmissionTime() < b->GetNextTransmissionTime();
+              });
+}
+
+Time
+LogicalLoraChannelHelper::GetMinWaitTime() const
+{
+    NS_LOG_FUNCTION(this);
+    if (m_sharedPlan)
+    {
+        // The availability order lives in the per-device timing state, so
+        // scan the (small) shared sub-band list instead
+        const auto& subBands = SubBands();
+        const auto& channels = Channels();
+        Time minNextTxTime = Time::Max();
+        for (size_t i = 0; i < subBands.size(); i++)
+        {
+            if (m_nextTransmissionTimes[i] >= minNextTxTime)
+            {
+                continue;
+            }
+            for (const auto& channel : channels)
+            {
+                if (channel && channel->IsEnabledForUplink() &&
+                    subBands[i]->Contains(channel->GetFrequency()))
+                {
+                    minNextTxTime = m_nextTransmissionTimes[i];
+                    break;
+                }
+            }
+        }
+        if (minNextTxTime == Time::Max())
+        {
+            return Time::Max();
+        }
+        Time waitTime = Max(minNextTxTime - Now(), Time(0));
+        NS_LOG_DEBUG("minWaitTime=" << waitTime.As(Time::S));
+        return waitTime;
+    }
+    // Sub-bands are sorted by availability: the first one serving an
+    // uplink-enabled channel yields the earliest possible transmission
+    for (const auto& subBand : m_sortedSubBands)
+    {
+        for (const auto& channel : m_channelVec)
+        {
+            if (channel && channel->IsEnabledForUplink() &&
+                subBand->Contains(channel->GetFrequency()))
+            {
+                Time waitTime = Max(subBand->GetNextTransmissionTime() - Now(), Time(0));
+                NS_LOG_DEBUG("minWaitTime=" << waitTime.As(Time::S));
+                return waitTime;
+            }
+        }
+    }
+    return Time::Max();
 }
 
 Time
@@ -79,9 +260,20 @@ Time
 LogicalLoraChannelHelper::GetWaitTime(uint32_t frequencyHz) const
 {
     NS_LOG_FUNCTION(this << frequencyHz);
-    auto subBand = GetSubBandFromFrequency(frequencyHz);
-    NS_ASSERT_MSG(subBand, "Input frequency is out-of-band");
-    Time waitTime = subBand->GetNextTransmissionTime() - Now();
+    Time nextTransmissionTime;
+    if (m_sharedPlan)
+    {
+        int index = GetSubBandIndex(frequencyHz);
+        NS_ASSERT_MSG(index >= 0, "Input frequency is out-of-band");
+        nextTransmissionTime = m_nextTransmissionTimes[index];
+    }
+    else
+    {
+        auto subBand = GetSubBandFromFrequency(frequencyHz);
+        NS_ASSERT_MSG(subBand, "Input frequency is out-of-band");
+        nextTransmissionTime = subBand->GetNextTransmissionTime();
+    }
+    Time waitTime = nextTransmissionTime - Now();
     waitTime = Max(waitTime, Time(0)); // Handle negative values
     NS_LOG_DEBUG("waitTime=" << waitTime.As(Time::S));
     return waitTime;
@@ -102,7 +294,17 @@ LogicalLoraChannelHelper::AddEvent(Time duration, uint32_t frequencyHz)
     auto subBand = GetSubBandFromFrequency(frequencyHz);
     NS_ASSERT_MSG(subBand, "Input frequency is out-of-band");
     Time nextTxTime = Now() + duration / subBand->GetDutyCycle();
-    subBand->SetNextTransmissionTime(nextTxTime);
+    if (m_sharedPlan)
+    {
+        // Timing state is private even when the plan is shared
+        m_nextTransmissionTimes[GetSubBandIndex(frequencyHz)] = nextTxTime;
+    }
+    else
+    {
+        subBand->SetNextTransmissionTime(nextTxTime);
+        // Keep the availability order up to date
+        SortSubBands();
+    }
     NS_LOG_DEBUG("now=" << Now().As(Time::S) << ", nextTxTime=" << nextTxTime.As(Time::S));
 }
 
@@ -16,6 +16,7 @@
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
 
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -65,6 +66,20 @@ class LogicalLoraChannelHelper : public SimpleRefCount<LogicalLoraChannelHelper>
      */
     Time GetWaitTime(uint32_t frequencyHz) const;
 
+    /**
+     * Get the time to wait before the earliest possible uplink transmission.
+     *
+     * Sub-bands are kept sorted by their next-available time, so this answers
+     * "when can I next transmit, and on which sub-band" without walking the
+     * full channel list. Only sub-bands serving at least one uplink-enabled
+     * channel are considered. The MAC can use the returned value to schedule
+     * a single wake-up instead of polling.
+     *
+     * @return The wait time before any transmission is allowed, Time::Max()
+     * if no sub-band serves an uplink-enabled channel.
+     */
+    Time GetMinWaitTime() const;
+
     /**
      * Register the transmission of a packet.
      *
@@ -124,6 +139,34 @@ class LogicalLoraChannelHelper : public SimpleRefCount<LogicalLoraChannelHelper>
      */
     double GetTxPowerForChannel(uint32_t frequencyHz) const;
 
+    /**
+     * Share another helper's frequency plan instead of owning a private copy.
+     *
+     * After this call, sub-band and channel lookups are answered from the
+     * shared plan, and only the duty cycle timing state is kept per device.
+     * Since regional frequency plans are identical across devices, sharing
+     * one immutable plan avoids materializing the same SubBand and
+     * LogicalLoraChannel objects once per device.
+     *
+     * The plan is copy-on-write: any mutation (SetChannel, AddSubBand, or an
+     * explicit Detach before direct channel edits) first materializes a
+     * private deep copy, so devices diverged by MAC commands stop affecting
+     * the others.
+     *
+     * @param plan The helper owning the frequency plan to share.
+     */
+    void ShareFrom(Ptr<LogicalLoraChannelHelper> plan);
+
+    /**
+     * Materialize a private deep copy of a shared frequency plan.
+     *
+     * Must be called before mutating channel objects obtained through
+     * GetRawChannelArray while the plan is shared; previously obtained
+     * channel pointers are invalidated. No-op when the plan is already
+     * private.
+     */
+    void Detach();
+
     /**
      * Check if a frequency is valid, that is, if it belongs to any of the sub-bands registered in
      * this class.
@@ -142,11 +185,84 @@ class LogicalLoraChannelHelper : public SimpleRefCount<LogicalLoraChannelHelper>
      */
     Ptr<SubBand> GetSubBandFromFrequency(uint32_t frequencyHz) const;
 
+    /**
+     * Re-establish the availability order of m_sortedSubBands.
+     */
+    void SortSubBands();
+
+    /**
+     * Get the sub-band list of this helper, following the shared plan if set.
+     *
+     * @return A reference to the effective sub-band list.
+     */
+    const std::vector<Ptr<SubBand>>& SubBands() const;
+
+    /**
+     * Get the channel storage array of this helper, following the shared plan
+     * if set.
+     *
+     * @return A reference to the effective channel storage array.
+     */
+    const std::vector<Ptr<LogicalLoraChannel>>& Channels() const;
+
+    /**
+     * Get the index of the sub-band a frequency belongs to, by binary
+     * search over the interval index.
+     *
+     * @param frequencyHz The frequency [Hz] to look up.
+     * @return The index into the effective sub-band list, -1 if none.
+     */
+    int GetSubBandIndex(uint32_t frequencyHz) const;
+
+    /**
+     * Rebuild the sorted interval index from the registered sub-bands.
+     */
+    void RebuildIntervalIndex();
+
     /**
      * A vector of the SubBands that are currently registered within this helper.
      */
     std::vector<Ptr<SubBand>> m_subBandList;
 
+    /**
+     * The registered SubBands sorted by ascending next-available time.
+     *
+     * The order is maintained by AddEvent, the only place in this module
+     * where a sub-band becomes unavailable. Since regions define only a
+     * handful of sub-bands, re-sorting this small array is cheaper than a
+     * heap.
+     */
+    std::vector<Ptr<SubBand>> m_sortedSubBands;
+
+    /**
+     * The registered sub-bands as (first frequency, sub-band list index)
+     * pairs sorted by frequency, rebuilt whenever a sub-band is added.
+     * Sub-bands do not overlap, so the last interval starting at or below a
+     * frequency is the only containment candidate and lookups are a single
+     * binary search instead of a list walk.
+     */
+    std::vector<std::pair<uint32_t, uint32_t>> m_intervalIndex;
+
+    /**
+     * Memoized frequency to sub-band resolutions, to avoid scanning the
+     * sub-band list on every duty cycle query for the same few channel
+     * frequencies.
+     */
+    mutable std::unordered_map<uint32_t, Ptr<SubBand>> m_subBandCache;
+
+    /**
+     * The helper owning the shared frequency plan, nullptr when this helper
+     * owns its plan privately.
+     */
+    Ptr<LogicalLoraChannelHelper> m_sharedPlan;
+
+    /**
+     * Per-device duty cycle state while the plan is shared: the next allowed
+     * transmission time for each sub-band of the shared plan, indexed like
+     * its sub-band list.
+     */
+    std::vector<Time> m_nextTransmissionTimes;
+
     /**
      * A vector of the LogicalLoraChannels that are currently registered within
      * this helper. This vector represents the node's channel mask. The first N
@@ -10,14 +10,23 @@
 
 #include "end-device-lora-phy.h"
 #include "gateway-lora-phy.h"
+#include "position-snapshot.h"
 
+#include "ns3/boolean.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/object-factory.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
+#include <cmath>
+#include <thread>
 
 namespace ns3
 {
@@ -46,6 +55,92 @@ LoraChannel::GetTypeId()
                           PointerValue(),
                           MakePointerAccessor(&LoraChannel::m_delay),
                           MakePointerChecker<PropagationDelayModel>())
+            .AddAttribute("EnableFrequencySubscriptions",
+                          "Whether Send should only deliver a transmission to the PHYs "
+                          "subscribed to its frequency, instead of all connected PHYs. "
+                          "Transmissions on other frequencies are then not delivered at "
+                          "all, so the per-receiver wrong-frequency traces do not fire.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraChannel::m_frequencySubscriptionsEnabled),
+                          MakeBooleanChecker())
+            .AddAttribute("CachePathLoss",
+                          "Whether to cache the total propagation gain of each "
+                          "(sender, receiver) pair on first use and reuse it for later "
+                          "transmissions. Only correct for static topologies: call "
+                          "ClearPathLossCache if nodes move. Loss models with random "
+                          "components are sampled once per link.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraChannel::m_cachePathLoss),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableBatchRxPower",
+                          "Whether Send should compute rx powers for all receivers of a "
+                          "transmission in one batch over a structure-of-arrays position "
+                          "snapshot, with a vectorizable fast path when the loss model is "
+                          "a plain LogDistancePropagationLossModel.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraChannel::m_batchRxPowerEnabled),
+                          MakeBooleanChecker())
+            .AddAttribute("BatchRxPowerThreads",
+                          "Number of worker threads splitting the batched rx-power kernel "
+                          "of Send. Each thread computes an independent slice of the "
+                          "receiver snapshot and all threads join before any reception "
+                          "event is scheduled, so results and event order are identical "
+                          "to the single-threaded kernel. Only consulted when "
+                          "EnableBatchRxPower is on and the fast path applies.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&LoraChannel::m_batchRxPowerThreads),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("EnableSpatialIndex",
+                          "Whether Send should use a uniform-grid spatial index to skip "
+                          "receivers whose best-case rx power cannot exceed the culling "
+                          "sensitivity.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraChannel::m_spatialIndexEnabled),
+                          MakeBooleanChecker())
+            .AddAttribute("SpatialIndexCellSize",
+                          "Side of the uniform grid cells of the spatial index, in meters.",
+                          DoubleValue(1000),
+                          MakeDoubleAccessor(&LoraChannel::m_spatialIndexCellSize),
+                          MakeDoubleChecker<double>(1))
+            .AddAttribute("SpatialIndexRefreshPeriod",
+                          "Maximum age of the spatial index before node positions are "
+                          "re-binned, to track mobile nodes.",
+                          TimeValue(Seconds(60)),
+                          MakeTimeAccessor(&LoraChannel::m_spatialIndexRefreshPeriod),
+                          MakeTimeChecker())
+            .AddAttribute("CullingSensitivityDbm",
+                          "Strictest sensitivity among the connected receivers, in dBm. "
+                          "Receivers beyond the distance at which the loss model brings "
+                          "the rx power below this value are not visited by Send.",
+                          DoubleValue(-142.5),
+                          MakeDoubleAccessor(&LoraChannel::m_cullingSensitivityDbm),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("CullingMarginDb",
+                          "Margin in dB subtracted from the culling sensitivity to absorb "
+                          "random components of the loss model (e.g. shadowing).",
+                          DoubleValue(10),
+                          MakeDoubleAccessor(&LoraChannel::m_cullingMarginDb),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("EnableFanOutDelivery",
+                          "Whether Send should schedule a single delivery event per "
+                          "transmission that fans out to all receivers in its handler, "
+                          "instead of one simulator event per receiver. All receivers "
+                          "then start reception at the smallest propagation delay of the "
+                          "set, so per-receiver delay differences (microseconds across a "
+                          "LoRa cell, well below a symbol) are flattened.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraChannel::m_fanOutEnabled),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableEarlyUnderSensitivityDrop",
+                          "Whether to suppress reception event scheduling entirely for "
+                          "signals whose rx power is below CullingSensitivityDbm minus "
+                          "CullingMarginDb. Such signals could neither be demodulated nor "
+                          "meaningfully interfere, but note that with this enabled they "
+                          "are not recorded as interference and the per-receiver "
+                          "under-sensitivity traces do not fire.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraChannel::m_earlyDropEnabled),
+                          MakeBooleanChecker())
             .AddTraceSource("PacketSent",
                             "Trace source fired whenever a packet goes out on the channel",
                             MakeTraceSourceAccessor(&LoraChannel::m_packetSent),
@@ -54,17 +149,20 @@ LoraChannel::GetTypeId()
 }
 
 LoraChannel::LoraChannel()
+    : m_spatialIndexStale(true)
 {
 }
 
 LoraChannel::~LoraChannel()
 {
     m_phyList.clear();
+    m_spatialIndex.clear();
 }
 
 LoraChannel::LoraChannel(Ptr<PropagationLossModel> loss, Ptr<PropagationDelayModel> delay)
     : m_loss(loss),
-      m_delay(delay)
+      m_delay(delay),
+      m_spatialIndexStale(true)
 {
 }
 
@@ -73,8 +171,16 @@ LoraChannel::Add(Ptr<LoraPhy> phy)
 {
     NS_LOG_FUNCTION(this << phy);
 
-    // Add the new phy to the vector
+    // Add the new phy to the vector, subscribed to all frequencies until it
+    // declares a specific one
     m_phyList.push_back(phy);
+    m_subscriptions.push_back(0);
+    m_listening.push_back(true);
+    m_frequencyLists[0].push_back(m_phyList.size() - 1);
+    m_phyIndices[PeekPointer(phy)] = m_phyList.size() - 1;
+
+    // The index no longer reflects the set of connected PHYs
+    m_spatialIndexStale = true;
 }
 
 void
@@ -83,7 +189,60 @@ LoraChannel::Remove(Ptr<LoraPhy> phy)
     NS_LOG_FUNCTION(this << phy);
 
     // Remove the phy from the vector
-    m_phyList.erase(find(m_phyList.begin(), m_phyList.end(), phy));
+    auto it = find(m_phyList.begin(), m_phyList.end(), phy);
+    m_subscriptions.erase(m_subscriptions.begin() + (it - m_phyList.begin()));
+    m_listening.erase(m_listening.begin() + (it - m_phyList.begin()));
+    m_phyList.erase(it);
+
+    // All indices past the removed one shifted: rebuild the derived structures
+    m_frequencyLists.clear();
+    m_phyIndices.clear();
+    for (uint32_t j = 0; j < m_phyList.size(); j++)
+    {
+        m_frequencyLists[m_subscriptions[j]].push_back(j);
+        m_phyIndices[PeekPointer(m_phyList[j])] = j;
+    }
+
+    // Indices into m_phyList shifted, so the index must be rebuilt
+    m_spatialIndexStale = true;
+}
+
+void
+LoraChannel::SubscribeToFrequency(Ptr<LoraPhy> phy, uint32_t frequencyHz)
+{
+    NS_LOG_FUNCTION(this << phy << frequencyHz);
+
+    auto indexIt = m_phyIndices.find(PeekPointer(phy));
+    if (indexIt == m_phyIndices.end())
+    {
+        // The PHY is being configured before being added to the channel
+        return;
+    }
+    uint32_t j = indexIt->second;
+
+    if (m_subscriptions[j] == frequencyHz)
+    {
+        return;
+    }
+
+    // Move the index from the old frequency's list to the new one
+    auto& oldList = m_frequencyLists[m_subscriptions[j]];
+    oldList.erase(find(oldList.begin(), oldList.end(), j));
+    m_subscriptions[j] = frequencyHz;
+    m_frequencyLists[frequencyHz].push_back(j);
+}
+
+void
+LoraChannel::SetListening(Ptr<LoraPhy> phy, bool listening)
+{
+    NS_LOG_FUNCTION(this << phy << listening);
+
+    auto indexIt = m_phyIndices.find(PeekPointer(phy));
+    if (indexIt == m_phyIndices.end())
+    {
+        return;
+    }
+    m_listening[indexIt->second] = listening;
 }
 
 std::size_t
@@ -108,71 +267,508 @@ LoraChannel::Send(Ptr<LoraPhy> sender,
 {
     NS_LOG_FUNCTION(this << sender << packet << txPowerDbm << txParams << duration << frequencyHz);
 
+    m_stats.sends++;
+
     // Get the mobility model of the sender
     Ptr<MobilityModel> senderMobility = sender->GetMobility()->GetObject<MobilityModel>();
 
     NS_ASSERT(senderMobility); // Make sure it's available
 
-    NS_LOG_INFO("Starting cycle over all " << m_phyList.size() << " PHYs");
     NS_LOG_INFO("Sender mobility: " << senderMobility->GetPosition());
 
+    if (m_batchRxPowerEnabled)
+    {
+        RefreshSpatialIndex();
+
+        std::vector<uint32_t> candidates;
+        CollectCandidates(sender, senderMobility, txPowerDbm, frequencyHz, candidates);
+        DeliverBatch(candidates, senderMobility, packet, txPowerDbm, txParams, duration,
+                     frequencyHz);
+        FlushFanOut(packet, txParams, duration, frequencyHz);
+        return;
+    }
+
+    if (m_spatialIndexEnabled)
+    {
+        RefreshSpatialIndex();
+
+        // Only visit PHYs whose cells fall within the culling range
+        double range = GetCullingRange(txPowerDbm);
+        std::vector<uint32_t> candidates;
+        GetCandidatesInRange(senderMobility->GetPosition(), range, candidates);
+
+        NS_LOG_INFO("Spatial index culling: visiting " << candidates.size() << " of "
+                                                       << m_phyList.size() << " PHYs (range "
+                                                       << range << " m)");
+
+        for (uint32_t j : candidates)
+        {
+            // Do not deliver to the sender, to PHYs that are not listening,
+            // nor to PHYs tuned elsewhere
+            if (sender != m_phyList[j] && m_listening[j] &&
+                (!m_frequencySubscriptionsEnabled || m_subscriptions[j] == 0 ||
+                 m_subscriptions[j] == frequencyHz))
+            {
+                DeliverToPhy(j, senderMobility, packet, txPowerDbm, txParams, duration, frequencyHz);
+            }
+        }
+        FlushFanOut(packet, txParams, duration, frequencyHz);
+        return;
+    }
+
+    if (m_frequencySubscriptionsEnabled)
+    {
+        // Only visit the PHYs tuned to this frequency, plus the ones (like
+        // gateways) that listen on all frequencies
+        for (uint32_t key : {frequencyHz, uint32_t(0)})
+        {
+            auto list = m_frequencyLists.find(key);
+            if (list == m_frequencyLists.end())
+            {
+                continue;
+            }
+            NS_LOG_INFO("Frequency subscriptions: visiting " << list->second.size()
+                                                             << " PHYs for key " << key);
+            for (uint32_t j : list->second)
+            {
+                if (sender != m_phyList[j] && m_listening[j])
+                {
+                    DeliverToPhy(j,
+                                 senderMobility,
+                                 packet,
+                                 txPowerDbm,
+                                 txParams,
+                                 duration,
+                                 frequencyHz);
+                }
+            }
+        }
+        FlushFanOut(packet, txParams, duration, frequencyHz);
+        return;
+    }
+
+    NS_LOG_INFO("Starting cycle over all " << m_phyList.size() << " PHYs");
+
     // Cycle over all registered PHYs
-    uint32_t j = 0;
-    std::vector<Ptr<LoraPhy>>::const_iterator i;
-    for (i = m_phyList.begin(); i != m_phyList.end(); i++, j++)
+    for (uint32_t j = 0; j < m_phyList.size(); j++)
     {
-        // Do not deliver to the sender (*i is the current PHY)
-        if (sender != (*i))
+        // Do not deliver to the sender or to PHYs that are not listening
+        if (sender != m_phyList[j] && m_listening[j])
         {
-            // Get the receiver's mobility model
-            Ptr<MobilityModel> receiverMobility = (*i)->GetMobility()->GetObject<MobilityModel>();
+            DeliverToPhy(j, senderMobility, packet, txPowerDbm, txParams, duration, frequencyHz);
+        }
+    }
+
+    FlushFanOut(packet, txParams, duration, frequencyHz);
+}
+
+void
+LoraChannel::DeliverToPhy(uint32_t j,
+                          Ptr<MobilityModel> senderMobility,
+                          Ptr<Packet> packet,
+                          double txPowerDbm,
+                          const LoraTxParameters& txParams,
+                          Time duration,
+                          uint32_t frequencyHz) const
+{
+    // Get the receiver's mobility model
+    Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility()->GetObject<MobilityModel>();
+
+    NS_LOG_INFO("Receiver mobility: " << receiverMobility->GetPosition());
+
+    // Compute delay using the delay model (served from the per-link cache
+    // when CachePathLoss is enabled)
+    Time delay = GetDelay(senderMobility, receiverMobility);
+
+    // Compute received power using the loss model
+    double rxPowerDbm = GetRxPower(txPowerDbm, senderMobility, receiverMobility);
+
+    // Signals this weak can neither be demodulated nor meaningfully
+    // interfere: do not even schedule a reception event for them
+    if (m_earlyDropEnabled && rxPowerDbm < m_cullingSensitivityDbm - m_cullingMarginDb)
+    {
+        NS_LOG_DEBUG("Early drop: rxPower=" << rxPowerDbm << "dBm is below the floor");
+        return;
+    }
 
-            NS_LOG_INFO("Receiver mobility: " << receiverMobility->GetPosition());
+    NS_LOG_DEBUG("Propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, "
+                                         << "distance="
+                                         << senderMobility->GetDistanceFrom(receiverMobility)
+                                         << "m, delay=" << delay);
 
-            // Compute delay using the delay model
-            Time delay = m_delay->GetDelay(senderMobility, receiverMobility);
+    if (m_fanOutEnabled)
+    {
+        // Stage the receiver; Send schedules one event for the whole set
+        m_fanOutMinDelay = m_fanOutTargets.empty() ? delay : std::min(m_fanOutMinDelay, delay);
+        m_fanOutTargets.push_back(FanOutTarget{j, rxPowerDbm});
+        LORAWAN_PHY_TRACE(m_packetSent, packet);
+        return;
+    }
 
-            // Compute received power using the loss model
-            double rxPowerDbm = GetRxPower(txPowerDbm, senderMobility, receiverMobility);
+    // Get the id of the destination PHY to correctly format the context
+    Ptr<NetDevice> dstNetDevice = m_phyList[j]->GetDevice();
+    uint32_t dstNode = 0;
+    if (dstNetDevice)
+    {
+        NS_LOG_INFO("Getting node index from NetDevice, since it exists");
+        dstNode = dstNetDevice->GetNode()->GetId();
+        NS_LOG_DEBUG("dstNode = " << dstNode);
+    }
+    else
+    {
+        NS_LOG_INFO("No net device connected to the PHY, using context 0");
+    }
 
-            NS_LOG_DEBUG("Propagation: txPower="
-                         << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, "
-                         << "distance=" << senderMobility->GetDistanceFrom(receiverMobility)
-                         << "m, delay=" << delay);
+    // Create the parameters object based on the calculations above
+    LoraChannelParameters parameters;
+    parameters.rxPowerDbm = rxPowerDbm;
+    parameters.sf = txParams.sf;
+    parameters.duration = duration;
+    parameters.frequencyHz = frequencyHz;
+
+    // Schedule the receive event
+    NS_LOG_INFO("Scheduling reception of the packet");
+    m_stats.receptionsScheduled++;
+    Simulator::ScheduleWithContext(dstNode,
+                                   delay,
+                                   &LoraChannel::Receive,
+                                   this,
+                                   j,
+                                   packet,
+                                   parameters);
+
+    // Fire the trace source for sent packet
+    LORAWAN_PHY_TRACE(m_packetSent, packet);
+}
 
-            // Get the id of the destination PHY to correctly format the context
-            Ptr<NetDevice> dstNetDevice = m_phyList[j]->GetDevice();
-            uint32_t dstNode = 0;
-            if (dstNetDevice)
+void
+LoraChannel::CollectCandidates(Ptr<LoraPhy> sender,
+                               Ptr<MobilityModel> senderMobility,
+                               double txPowerDbm,
+                               uint32_t frequencyHz,
+                               std::vector<uint32_t>& candidates) const
+{
+    std::vector<uint32_t> unfiltered;
+    if (m_spatialIndexEnabled)
+    {
+        GetCandidatesInRange(senderMobility->GetPosition(),
+                             GetCullingRange(txPowerDbm),
+                             unfiltered);
+    }
+    else if (m_frequencySubscriptionsEnabled)
+    {
+        for (uint32_t key : {frequencyHz, uint32_t(0)})
+        {
+            auto list = m_frequencyLists.find(key);
+            if (list != m_frequencyLists.end())
             {
-                NS_LOG_INFO("Getting node index from NetDevice, since it exists");
-                dstNode = dstNetDevice->GetNode()->GetId();
-                NS_LOG_DEBUG("dstNode = " << dstNode);
+                unfiltered.insert(unfiltered.end(), list->second.begin(), list->second.end());
             }
-            else
+        }
+    }
+    else
+    {
+        unfiltered.resize(m_phyList.size());
+        for (uint32_t j = 0; j < m_phyList.size(); j++)
+        {
+            unfiltered[j] = j;
+        }
+    }
+
+    candidates.reserve(unfiltered.size());
+    for (uint32_t j : unfiltered)
+    {
+        if (sender != m_phyList[j] && m_listening[j] &&
+            (!m_frequencySubscriptionsEnabled || m_subscriptions[j] == 0 ||
+             m_subscriptions[j] == frequencyHz))
+        {
+            candidates.push_back(j);
+        }
+    }
+}
+
+void
+LoraChannel::DeliverBatch(const std::vector<uint32_t>& candidates,
+                          Ptr<MobilityModel> senderMobility,
+                          Ptr<Packet> packet,
+                          double txPowerDbm,
+                          const LoraTxParameters& txParams,
+                          Time duration,
+                          uint32_t frequencyHz) const
+{
+    // The fast path only handles a loss model that is a plain log-distance
+    // model with no chained components, and a constant-speed delay model
+    Ptr<LogDistancePropagationLossModel> logDistance =
+        DynamicCast<LogDistancePropagationLossModel>(m_loss);
+    Ptr<ConstantSpeedPropagationDelayModel> constantSpeed =
+        DynamicCast<ConstantSpeedPropagationDelayModel>(m_delay);
+    if (!logDistance || logDistance->GetNext() || !constantSpeed)
+    {
+        NS_LOG_DEBUG("Loss or delay model unsupported by the batch kernel, "
+                     "falling back to per-receiver delivery");
+        for (uint32_t j : candidates)
+        {
+            DeliverToPhy(j, senderMobility, packet, txPowerDbm, txParams, duration, frequencyHz);
+        }
+        return;
+    }
+
+    DoubleValue exponent;
+    DoubleValue referenceDistance;
+    DoubleValue referenceLoss;
+    DoubleValue speed;
+    logDistance->GetAttribute("Exponent", exponent);
+    logDistance->GetAttribute("ReferenceDistance", referenceDistance);
+    logDistance->GetAttribute("ReferenceLoss", referenceLoss);
+    constantSpeed->GetAttribute("Speed", speed);
+
+    Vector senderPosition = senderMobility->GetPosition();
+
+    // Compute rx powers and delays in one pass over the snapshot arrays. The
+    // loop body is branch-light scalar math on contiguous doubles, which the
+    // compiler can vectorize.
+    std::vector<double> rxPowersDbm(candidates.size());
+    std::vector<double> distances(candidates.size());
+    auto computeSlice = [&](uint32_t first, uint32_t last) {
+        for (uint32_t k = first; k < last; k++)
+        {
+            uint32_t j = candidates[k];
+            double dx = m_snapshotX[j] - senderPosition.x;
+            double dy = m_snapshotY[j] - senderPosition.y;
+            double dz = m_snapshotZ[j] - senderPosition.z;
+            double distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+            double pathLossDb =
+                (distance > referenceDistance.Get())
+                    ? 10 * exponent.Get() * std::log10(distance / referenceDistance.Get())
+                    : 0;
+            rxPowersDbm[k] = txPowerDbm - referenceLoss.Get() - pathLossDb;
+            distances[k] = distance;
+        }
+    };
+
+    // Worker threads each fill a disjoint slice and all join before any
+    // reception event is scheduled, so the simulator core only ever runs
+    // single-threaded and the event order is unchanged. Small batches are
+    // not worth the spawn cost.
+    if (m_batchRxPowerThreads > 1 && candidates.size() >= 2048 * m_batchRxPowerThreads)
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(m_batchRxPowerThreads);
+        uint32_t sliceSize = (candidates.size() + m_batchRxPowerThreads - 1) /
+                             m_batchRxPowerThreads;
+        for (uint32_t t = 0; t < m_batchRxPowerThreads; t++)
+        {
+            uint32_t first = t * sliceSize;
+            uint32_t last = std::min<uint32_t>(first + sliceSize, candidates.size());
+            if (first < last)
             {
-                NS_LOG_INFO("No net device connected to the PHY, using context 0");
+                workers.emplace_back(computeSlice, first, last);
             }
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+    else
+    {
+        computeSlice(0, candidates.size());
+    }
+
+    for (uint32_t k = 0; k < candidates.size(); k++)
+    {
+        uint32_t j = candidates[k];
 
-            // Create the parameters object based on the calculations above
-            LoraChannelParameters parameters;
-            parameters.rxPowerDbm = rxPowerDbm;
-            parameters.sf = txParams.sf;
-            parameters.duration = duration;
-            parameters.frequencyHz = frequencyHz;
-
-            // Schedule the receive event
-            NS_LOG_INFO("Scheduling reception of the packet");
-            Simulator::ScheduleWithContext(dstNode,
-                                           delay,
-                                           &LoraChannel::Receive,
-                                           this,
-                                           j,
-                                           packet,
-                                           parameters);
-
-            // Fire the trace source for sent packet
-            m_packetSent(packet);
+        if (m_earlyDropEnabled && rxPowersDbm[k] < m_cullingSensitivityDbm - m_cullingMarginDb)
+        {
+            continue;
+        }
+
+        if (m_fanOutEnabled)
+        {
+            Time delay = Seconds(distances[k] / speed.Get());
+            m_fanOutMinDelay = m_fanOutTargets.empty() ? delay : std::min(m_fanOutMinDelay, delay);
+            m_fanOutTargets.push_back(FanOutTarget{j, rxPowersDbm[k]});
+            LORAWAN_PHY_TRACE(m_packetSent, packet);
+            continue;
+        }
+
+        LoraChannelParameters parameters;
+        parameters.rxPowerDbm = rxPowersDbm[k];
+        parameters.sf = txParams.sf;
+        parameters.duration = duration;
+        parameters.frequencyHz = frequencyHz;
+
+        m_stats.receptionsScheduled++;
+        Simulator::ScheduleWithContext(m_snapshotNodes[j],
+                                       Seconds(distances[k] / speed.Get()),
+                                       &LoraChannel::Receive,
+                                       this,
+                                       j,
+                                       packet,
+                                       parameters);
+
+        LORAWAN_PHY_TRACE(m_packetSent, packet);
+    }
+}
+
+void
+LoraChannel::FlushFanOut(Ptr<Packet> packet,
+                         const LoraTxParameters& txParams,
+                         Time duration,
+                         uint32_t frequencyHz) const
+{
+    if (m_fanOutTargets.empty())
+    {
+        return;
+    }
+
+    // The per-target rx power is filled in by the handler
+    LoraChannelParameters parameters;
+    parameters.sf = txParams.sf;
+    parameters.duration = duration;
+    parameters.frequencyHz = frequencyHz;
+
+    NS_LOG_INFO("Scheduling one fan-out delivery event for " << m_fanOutTargets.size()
+                                                             << " receivers");
+
+    m_stats.fanOutEvents++;
+    m_stats.receptionsScheduled += m_fanOutTargets.size();
+    Simulator::Schedule(m_fanOutMinDelay,
+                        &LoraChannel::ReceiveFanOut,
+                        this,
+                        std::move(m_fanOutTargets),
+                        packet,
+                        parameters);
+    m_fanOutTargets.clear();
+}
+
+void
+LoraChannel::ReceiveFanOut(std::vector<FanOutTarget> targets,
+                           Ptr<Packet> packet,
+                           LoraChannelParameters parameters) const
+{
+    NS_LOG_FUNCTION(this << targets.size() << packet << parameters);
+
+    for (const FanOutTarget& target : targets)
+    {
+        parameters.rxPowerDbm = target.rxPowerDbm;
+        Receive(target.phyIndex, packet, parameters);
+    }
+}
+
+uint64_t
+LoraChannel::GetCellKey(const Vector& position) const
+{
+    // Pack the two signed cell coordinates into a single map key
+    auto cx = int32_t(std::floor(position.x / m_spatialIndexCellSize));
+    auto cy = int32_t(std::floor(position.y / m_spatialIndexCellSize));
+    return (uint64_t(uint32_t(cx)) << 32) | uint64_t(uint32_t(cy));
+}
+
+void
+LoraChannel::RefreshSpatialIndex() const
+{
+    if (!m_spatialIndexStale &&
+        Simulator::Now() - m_spatialIndexBuiltAt < m_spatialIndexRefreshPeriod)
+    {
+        return;
+    }
+
+    NS_LOG_DEBUG("Rebuilding the spatial index over " << m_phyList.size() << " PHYs");
+
+    m_spatialIndex.clear();
+    m_snapshotX.resize(m_phyList.size());
+    m_snapshotY.resize(m_phyList.size());
+    m_snapshotZ.resize(m_phyList.size());
+    m_snapshotNodes.resize(m_phyList.size());
+    for (uint32_t j = 0; j < m_phyList.size(); j++)
+    {
+        Ptr<MobilityModel> mobility = m_phyList[j]->GetMobility();
+        NS_ASSERT_MSG(mobility, "Cannot index a PHY without a mobility model");
+        Ptr<NetDevice> device = m_phyList[j]->GetDevice();
+        // Static nodes are answered from the flat snapshot, skipping the
+        // virtual GetPosition call
+        Vector position =
+            device ? PositionSnapshot::Get(device->GetNode()) : mobility->GetPosition();
+        m_spatialIndex[GetCellKey(position)].push_back(j);
+        m_snapshotX[j] = position.x;
+        m_snapshotY[j] = position.y;
+        m_snapshotZ[j] = position.z;
+        m_snapshotNodes[j] = device ? device->GetNode()->GetId() : 0;
+    }
+
+    m_spatialIndexBuiltAt = Simulator::Now();
+    m_spatialIndexStale = false;
+}
+
+double
+LoraChannel::GetCullingRange(double txPowerDbm) const
+{
+    auto it = m_cullingRanges.find(txPowerDbm);
+    if (it != m_cullingRanges.end())
+    {
+        return it->second;
+    }
+
+    // Find, by bisection on the distance, the point at which the loss model
+    // brings the rx power below the strictest sensitivity minus the margin
+    double threshold = m_cullingSensitivityDbm - m_cullingMarginDb;
+    Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+    Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+    a->SetPosition(Vector(0, 0, 0));
+
+    double lo = 1;
+    double hi = 1e6; // 1000 km: beyond any terrestrial LoRa link
+    b->SetPosition(Vector(hi, 0, 0));
+    if (m_loss->CalcRxPower(txPowerDbm, a, b) >= threshold)
+    {
+        // The loss model never attenuates below threshold: no culling possible
+        m_cullingRanges[txPowerDbm] = hi;
+        return hi;
+    }
+    for (int i = 0; i < 50; i++)
+    {
+        double mid = (lo + hi) / 2;
+        b->SetPosition(Vector(mid, 0, 0));
+        if (m_loss->CalcRxPower(txPowerDbm, a, b) >= threshold)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    NS_LOG_DEBUG("Culling range for txPower=" << txPowerDbm << "dBm: " << hi << "m");
+
+    m_cullingRanges[txPowerDbm] = hi;
+    return hi;
+}
+
+void
+LoraChannel::GetCandidatesInRange(const Vector& senderPosition,
+                                  double range,
+                                  std::vector<uint32_t>& candidates) const
+{
+    // Half a cell diagonal accounts for positions anywhere inside a cell
+    double slack = m_spatialIndexCellSize * M_SQRT2 / 2;
+    auto cMinX = int32_t(std::floor((senderPosition.x - range - slack) / m_spatialIndexCellSize));
+    auto cMaxX = int32_t(std::floor((senderPosition.x + range + slack) / m_spatialIndexCellSize));
+    auto cMinY = int32_t(std::floor((senderPosition.y - range - slack) / m_spatialIndexCellSize));
+    auto cMaxY = int32_t(std::floor((senderPosition.y + range + slack) / m_spatialIndexCellSize));
+
+    for (int32_t cx = cMinX; cx <= cMaxX; cx++)
+    {
+        for (int32_t cy = cMinY; cy <= cMaxY; cy++)
+        {
+            uint64_t key = (uint64_t(uint32_t(cx)) << 32) | uint64_t(uint32_t(cy));
+            auto cell = m_spatialIndex.find(key);
+            if (cell != m_spatialIndex.end())
+            {
+                candidates.insert(candidates.end(), cell->second.begin(), cell->second.end());
+            }
         }
     }
 }
@@ -195,7 +791,66 @@ LoraChannel::GetRxPower(double txPowerDbm,
                         Ptr<MobilityModel> senderMobility,
                         Ptr<MobilityModel> receiverMobility) const
 {
-    return m_loss->CalcRxPower(txPowerDbm, senderMobility, receiverMobility);
+    if (!m_cachePathLoss)
+    {
+        return m_loss->CalcRxPower(txPowerDbm, senderMobility, receiverMobility);
+    }
+
+    uint64_t key = GetLinkKey(senderMobility, receiverMobility);
+    auto it = m_pathLossCache.find(key);
+    if (it == m_pathLossCache.end())
+    {
+        // Cache the total gain in dB, so that any tx power can be served
+        double gainDb = m_loss->CalcRxPower(0, senderMobility, receiverMobility);
+        it = m_pathLossCache.emplace(key, gainDb).first;
+    }
+    return txPowerDbm + it->second;
+}
+
+Ptr<PropagationLossModel>
+LoraChannel::GetLossModel() const
+{
+    return m_loss;
+}
+
+uint64_t
+LoraChannel::GetLinkKey(Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility)
+{
+    // Key the caches on the mobility model pair; positions are assumed static
+    return uint64_t(uintptr_t(PeekPointer(senderMobility))) * 2654435761u ^
+           uint64_t(uintptr_t(PeekPointer(receiverMobility)));
+}
+
+Time
+LoraChannel::GetDelay(Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility) const
+{
+    if (!m_cachePathLoss)
+    {
+        return m_delay->GetDelay(senderMobility, receiverMobility);
+    }
+
+    uint64_t key = GetLinkKey(senderMobility, receiverMobility);
+    auto it = m_delayCache.find(key);
+    if (it == m_delayCache.end())
+    {
+        it = m_delayCache.emplace(key, m_delay->GetDelay(senderMobility, receiverMobility)).first;
+    }
+    return it->second;
+}
+
+LoraChannel::Stats
+LoraChannel::GetStats() const
+{
+    return m_stats;
+}
+
+void
+LoraChannel::ClearPathLossCache()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_pathLossCache.clear();
+    m_delayCache.clear();
 }
 
 std::ostream&
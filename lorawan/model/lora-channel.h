@@ -23,6 +23,7 @@
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -112,6 +113,41 @@ class LoraChannel : public Channel
      */
     void Remove(Ptr<LoraPhy> phy);
 
+    /**
+     * Record the frequency a connected PHY is listening on.
+     *
+     * When frequency subscriptions are enabled, Send only delivers a
+     * transmission to the PHYs subscribed to its frequency (plus the ones that
+     * listen on all frequencies, like gateways). PHYs are subscribed to all
+     * frequencies when first added; EndDeviceLoraPhy updates its subscription
+     * whenever its listening frequency changes.
+     *
+     * Calls referring to PHYs that are not connected to this channel are
+     * ignored, so that a PHY can be configured before being added.
+     *
+     * @param phy The physical layer whose subscription to update.
+     * @param frequencyHz The frequency [Hz] the PHY listens on, or 0 to listen
+     * on all frequencies.
+     */
+    void SubscribeToFrequency(Ptr<LoraPhy> phy, uint32_t frequencyHz);
+
+    /**
+     * Mark a connected PHY as listening or not listening.
+     *
+     * Send skips PHYs that are marked as not listening, so radios that cannot
+     * receive anyway (e.g. end devices in the SLEEP state) do not cost a
+     * reception event per transmission. Note that a skipped PHY also does not
+     * record the transmission as interference, so a device waking up into an
+     * ongoing transmission will not see it as an interferer.
+     *
+     * Calls referring to PHYs that are not connected to this channel are
+     * ignored.
+     *
+     * @param phy The physical layer whose listening state to update.
+     * @param listening Whether the PHY is able to receive transmissions.
+     */
+    void SetListening(Ptr<LoraPhy> phy, bool listening);
+
     /**
      * Send a packet in the channel.
      *
@@ -155,6 +191,44 @@ class LoraChannel : public Channel
                       Ptr<MobilityModel> senderMobility,
                       Ptr<MobilityModel> receiverMobility) const;
 
+    /**
+     * Get the propagation loss model this channel computes rx powers with.
+     *
+     * Lets callers query the loss chain directly, e.g. to inspect it or to
+     * bypass the channel's path-loss cache.
+     *
+     * @return The head of the propagation loss model chain.
+     */
+    Ptr<PropagationLossModel> GetLossModel() const;
+
+    /**
+     * Drop all cached per-link path loss values.
+     *
+     * Must be called if node positions change while the CachePathLoss
+     * attribute is enabled, otherwise stale values will keep being served.
+     */
+    void ClearPathLossCache();
+
+    /**
+     * Monotonic hot-path counters of this channel.
+     *
+     * Kept as plain integer increments on the Send path, so the
+     * instrumentation costs nothing measurable and can stay always on.
+     */
+    struct Stats
+    {
+        uint64_t sends = 0;                //!< Transmissions handed to Send.
+        uint64_t receptionsScheduled = 0;  //!< Reception events scheduled on PHYs.
+        uint64_t fanOutEvents = 0;         //!< Single fan-out events covering many receptions.
+    };
+
+    /**
+     * Get a snapshot of this channel's hot-path counters.
+     *
+     * @return The counters accumulated since the channel was created.
+     */
+    Stats GetStats() const;
+
   private:
     /**
      * Private method that is scheduled by LoraChannel's Send method to happen
@@ -169,12 +243,275 @@ class LoraChannel : public Channel
      */
     void Receive(uint32_t i, Ptr<Packet> packet, LoraChannelParameters parameters) const;
 
+    /// One receiver of a fanned-out transmission, see FlushFanOut.
+    struct FanOutTarget
+    {
+        uint32_t phyIndex; //!< Index of the receiving PHY in m_phyList.
+        double rxPowerDbm; //!< Reception power of the packet at this PHY.
+    };
+
+    /**
+     * Schedule the single delivery event of a fanned-out transmission.
+     *
+     * Takes the receivers staged by DeliverToPhy (or the batch kernel) for
+     * the transmission being sent and schedules one simulator event at the
+     * smallest staged propagation delay, whose handler starts reception on
+     * every staged PHY. No-op when nothing is staged.
+     *
+     * @param packet The packet being sent.
+     * @param txParams The set of parameters that are used by the transmitter.
+     * @param duration The on-air duration of this packet.
+     * @param frequencyHz The frequency this transmission happens at.
+     */
+    void FlushFanOut(Ptr<Packet> packet,
+                     const LoraTxParameters& txParams,
+                     Time duration,
+                     uint32_t frequencyHz) const;
+
+    /**
+     * Handler of the single fan-out delivery event: start reception on every
+     * target PHY, each with its own rx power.
+     *
+     * @param targets The staged receivers of this transmission.
+     * @param packet The packet the PHYs will receive.
+     * @param parameters The transmission parameters shared by all targets,
+     * whose rxPowerDbm field is overwritten per target.
+     */
+    void ReceiveFanOut(std::vector<FanOutTarget> targets,
+                       Ptr<Packet> packet,
+                       LoraChannelParameters parameters) const;
+
+    /**
+     * Compute the delay and rx power for one receiving PHY and schedule its
+     * reception event.
+     *
+     * This contains the per-receiver part of the Send logic, so that Send can
+     * decide which PHYs to visit (all of them, or only the ones returned by the
+     * spatial index) without duplicating the delivery code.
+     *
+     * @param i The index of the candidate receiver in m_phyList.
+     * @param senderMobility The mobility model of the sender.
+     * @param packet The packet being sent.
+     * @param txPowerDbm The power of the transmission.
+     * @param txParams The set of parameters that are used by the transmitter.
+     * @param duration The on-air duration of this packet.
+     * @param frequencyHz The frequency this transmission happens at.
+     */
+    void DeliverToPhy(uint32_t i,
+                      Ptr<MobilityModel> senderMobility,
+                      Ptr<Packet> packet,
+                      double txPowerDbm,
+                      const LoraTxParameters& txParams,
+                      Time duration,
+                      uint32_t frequencyHz) const;
+
+    /**
+     * Collect the filtered list of receiver indices for one transmission.
+     *
+     * Applies the spatial index, frequency subscriptions and listening flags
+     * according to the enabled features, and never includes the sender.
+     *
+     * @param sender The phy that is sending.
+     * @param senderMobility The mobility model of the sender.
+     * @param txPowerDbm The power of the transmission.
+     * @param frequencyHz The frequency of the transmission.
+     * @param candidates Output vector of receiver indices in m_phyList.
+     */
+    void CollectCandidates(Ptr<LoraPhy> sender,
+                           Ptr<MobilityModel> senderMobility,
+                           double txPowerDbm,
+                           uint32_t frequencyHz,
+                           std::vector<uint32_t>& candidates) const;
+
+    /**
+     * Deliver one transmission to a batch of receivers using the
+     * structure-of-arrays position snapshot.
+     *
+     * When the loss model is a plain LogDistancePropagationLossModel (and the
+     * delay model a ConstantSpeedPropagationDelayModel), rx powers and delays
+     * are computed in a tight loop over the snapshot arrays, which the
+     * compiler can vectorize; otherwise each receiver goes through the
+     * regular virtual CalcRxPower path.
+     *
+     * @param candidates The receiver indices to deliver to.
+     * @param senderMobility The mobility model of the sender.
+     * @param packet The packet being sent.
+     * @param txPowerDbm The power of the transmission.
+     * @param txParams The set of parameters that are used by the transmitter.
+     * @param duration The on-air duration of this packet.
+     * @param frequencyHz The frequency this transmission happens at.
+     */
+    void DeliverBatch(const std::vector<uint32_t>& candidates,
+                      Ptr<MobilityModel> senderMobility,
+                      Ptr<Packet> packet,
+                      double txPowerDbm,
+                      const LoraTxParameters& txParams,
+                      Time duration,
+                      uint32_t frequencyHz) const;
+
+    /**
+     * Map a position to the key of the spatial index cell containing it.
+     *
+     * @param position The position to map.
+     * @return The packed (x, y) cell coordinates.
+     */
+    uint64_t GetCellKey(const Vector& position) const;
+
+    /**
+     * Rebuild the spatial index from the current positions of all connected
+     * PHYs.
+     *
+     * The index is rebuilt lazily: it is marked stale whenever a PHY is added
+     * or removed, and it expires after SpatialIndexRefreshPeriod so that
+     * mobile nodes are re-binned periodically.
+     */
+    void RefreshSpatialIndex() const;
+
+    /**
+     * Compute the distance beyond which the best-case rx power of a
+     * transmission at the given power is guaranteed to fall below the culling
+     * sensitivity.
+     *
+     * The loss model is probed by bisection using two temporary mobility
+     * models, and the result is cached per tx power. A configurable margin
+     * keeps the estimate conservative in the presence of random loss
+     * components (e.g. shadowing).
+     *
+     * @param txPowerDbm The power of the transmission.
+     * @return The culling range in meters.
+     */
+    double GetCullingRange(double txPowerDbm) const;
+
+    /**
+     * Collect the indices of the PHYs whose cells intersect a disc around the
+     * sender.
+     *
+     * @param senderPosition The position of the sender.
+     * @param range The radius [m] of the disc to cover.
+     * @param candidates Output vector of candidate indices in m_phyList.
+     */
+    void GetCandidatesInRange(const Vector& senderPosition,
+                              double range,
+                              std::vector<uint32_t>& candidates) const;
+
     /**
      * The vector containing the PHYs that are currently connected to the
      * channel.
      */
     std::vector<Ptr<LoraPhy>> m_phyList;
 
+    bool m_frequencySubscriptionsEnabled; //!< Whether Send only visits PHYs tuned to the tx
+                                          //!< frequency.
+
+    /**
+     * The frequency [Hz] each PHY in m_phyList is subscribed to, or 0 for all
+     * frequencies. Kept parallel to m_phyList.
+     */
+    std::vector<uint32_t> m_subscriptions;
+
+    /**
+     * Per-frequency lists of indices in m_phyList. The entry for key 0 holds
+     * the PHYs listening on all frequencies.
+     */
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_frequencyLists;
+
+    /**
+     * Whether each PHY in m_phyList is currently listening. Kept parallel to
+     * m_phyList.
+     */
+    std::vector<bool> m_listening;
+
+    /**
+     * Map from connected PHYs to their index in m_phyList, for O(1) lookup in
+     * SubscribeToFrequency and SetListening.
+     */
+    std::unordered_map<LoraPhy*, uint32_t> m_phyIndices;
+
+    bool m_spatialIndexEnabled; //!< Whether Send culls receivers via the spatial index.
+
+    double m_spatialIndexCellSize; //!< Side [m] of the uniform grid cells.
+
+    Time m_spatialIndexRefreshPeriod; //!< Maximum age of the index before positions are re-binned.
+
+    double m_cullingSensitivityDbm; //!< Strictest sensitivity [dBm] a receiver can have.
+
+    double m_cullingMarginDb; //!< Margin [dB] added to absorb random loss components.
+
+    bool m_earlyDropEnabled; //!< Whether receptions below the early-drop floor are not scheduled.
+
+    /**
+     * The spatial index: packed cell coordinates to indices in m_phyList.
+     */
+    mutable std::unordered_map<uint64_t, std::vector<uint32_t>> m_spatialIndex;
+
+    mutable Time m_spatialIndexBuiltAt; //!< Time the index was last rebuilt.
+
+    mutable bool m_spatialIndexStale; //!< Whether the index needs a rebuild before use.
+
+    bool m_batchRxPowerEnabled; //!< Whether Send uses the batched rx-power kernel.
+
+    uint32_t m_batchRxPowerThreads; //!< Worker threads splitting the batched rx-power kernel.
+
+    bool m_fanOutEnabled; //!< Whether Send schedules one delivery event per transmission.
+
+    /**
+     * Receivers staged for the transmission currently being sent, moved
+     * into the delivery event by FlushFanOut before Send returns. Only used
+     * when fan-out delivery is enabled.
+     */
+    mutable std::vector<FanOutTarget> m_fanOutTargets;
+
+    mutable Time m_fanOutMinDelay; //!< Smallest propagation delay staged so far.
+
+    mutable Stats m_stats; //!< Hot-path counters, mutable since Send is const.
+
+    // Structure-of-arrays snapshot of the connected PHYs, kept parallel to
+    // m_phyList and rebuilt together with the spatial index. Used by the
+    // batched rx-power kernel to avoid chasing pointers in the hot loop.
+    mutable std::vector<double> m_snapshotX;       //!< x coordinates [m].
+    mutable std::vector<double> m_snapshotY;       //!< y coordinates [m].
+    mutable std::vector<double> m_snapshotZ;       //!< z coordinates [m].
+    mutable std::vector<uint32_t> m_snapshotNodes; //!< Node ids for event contexts.
+
+    /**
+     * Cache of culling ranges, keyed by tx power [dBm].
+     */
+    mutable std::unordered_map<double, double> m_cullingRanges;
+
+    bool m_cachePathLoss; //!< Whether per-link path loss and delay values are cached.
+
+    /**
+     * Compute the cache key of a (sender, receiver) mobility model pair.
+     *
+     * @param senderMobility The mobility model of the sender.
+     * @param receiverMobility The mobility model of the receiver.
+     * @return The key for the per-link caches.
+     */
+    static uint64_t GetLinkKey(Ptr<MobilityModel> senderMobility,
+                               Ptr<MobilityModel> receiverMobility);
+
+    /**
+     * Get the propagation delay between two nodes, served from the per-link
+     * cache when the CachePathLoss attribute is enabled.
+     *
+     * @param senderMobility The mobility model of the sender.
+     * @param receiverMobility The mobility model of the receiver.
+     * @return The propagation delay.
+     */
+    Time GetDelay(Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility) const;
+
+    /**
+     * Cache of total propagation gain [dB], keyed by the (sender, receiver)
+     * mobility model pair. Only valid while nodes do not move.
+     */
+    mutable std::unordered_map<uint64_t, double> m_pathLossCache;
+
+    /**
+     * Cache of propagation delays, keyed like m_pathLossCache and cleared
+     * together with it.
+     */
+    mutable std::unordered_map<uint64_t, Time> m_delayCache;
+
     /**
      * Pointer to the loss model.
      *
@@ -57,6 +57,24 @@ LoraDeviceAddressGenerator::NextAddress()
     return LoraDeviceAddress(m_currentNwkId, oldNwkAddr);
 }
 
+std::vector<LoraDeviceAddress>
+LoraDeviceAddressGenerator::NextAddresses(uint32_t count)
+{
+    NS_LOG_FUNCTION(this << count);
+
+    std::vector<LoraDeviceAddress> addresses;
+    addresses.reserve(count);
+
+    uint32_t base = m_currentNwkAddr.Get();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        addresses.emplace_back(m_currentNwkId, NwkAddr(base + i));
+    }
+    m_currentNwkAddr.Set(base + count);
+
+    return addresses;
+}
+
 LoraDeviceAddress
 LoraDeviceAddressGenerator::GetNextAddress()
 {
@@ -13,6 +13,8 @@
 
 #include "ns3/object.h"
 
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -65,6 +67,19 @@ class LoraDeviceAddressGenerator : public Object
      */
     LoraDeviceAddress NextAddress();
 
+    /**
+     * Allocate a contiguous block of LoraDeviceAddress instances.
+     *
+     * Equivalent to count calls to NextAddress() but done as one increment,
+     * so bulk install loops pay the allocation bookkeeping once per block
+     * rather than once per device. The block never crosses into the next
+     * network: the nwkId stays constant for all returned addresses.
+     *
+     * @param count Number of addresses to allocate.
+     * @return The allocated addresses, in increasing order.
+     */
+    std::vector<LoraDeviceAddress> NextAddresses(uint32_t count);
+
     /**
      * Get the LoraDeviceAddress that will be allocated upon a call to
      * NextAddress.
@@ -11,6 +11,7 @@
 
 #include "ns3/address.h"
 
+#include <functional>
 #include <string>
 
 namespace ns3
@@ -280,4 +281,20 @@ std::ostream& operator<<(std::ostream& os, const LoraDeviceAddress& address);
 
 } // namespace lorawan
 } // namespace ns3
+
+/**
+ * Hash support so LoraDeviceAddress can key unordered containers.
+ *
+ * The address is a 32-bit value, so hashing the integer form directly is
+ * both cheap and collision-free.
+ */
+template <>
+struct std::hash<ns3::lorawan::LoraDeviceAddress>
+{
+    std::size_t operator()(const ns3::lorawan::LoraDeviceAddress& address) const noexcept
+    {
+        return std::hash<uint32_t>{}(address.Get());
+    }
+};
+
 #endif
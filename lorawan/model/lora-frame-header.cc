@@ -28,7 +28,8 @@ LoraFrameHeader::LoraFrameHeader()
       m_ack(false),
       m_fPending(false),
       m_fOptsLen(0),
-      m_fCnt(0)
+      m_fCnt(0),
+      m_commandTypeMask(0)
 {
 }
 
@@ -53,11 +54,10 @@ LoraFrameHeader::GetInstanceTypeId() const
 uint32_t
 LoraFrameHeader::GetSerializedSize() const
 {
-    NS_LOG_FUNCTION(this);
-    // 4 for DevAddr + 1 for FCtrl + 2 for FCnt + 1 for FPort + 0-15 for FOpts
-    uint32_t size = 8 + m_fOptsLen;
-    NS_LOG_INFO("LoraFrameHeader serialized size: " << size);
-    return size;
+    // 4 for DevAddr + 1 for FCtrl + 2 for FCnt + 1 for FPort + 0-15 for FOpts.
+    // m_fOptsLen is maintained incrementally by the Add* methods, so this is
+    // a constant-time query.
+    return 8 + m_fOptsLen;
 }
 
 void
@@ -65,9 +65,6 @@ LoraFrameHeader::Serialize(Buffer::Iterator start) const
 {
     NS_LOG_FUNCTION(this);
 
-    // Device Address field
-    start.WriteU32(m_address.Get());
-
     // fCtrl field
     //
     // TODO FCtrl has different meanings for UL and DL packets. Handle this
@@ -78,6 +75,29 @@ LoraFrameHeader::Serialize(Buffer::Iterator start) const
     fCtrl |= uint8_t(m_ack << 5 & 0b100000);
     fCtrl |= uint8_t(m_fPending << 4 & 0b10000);
     fCtrl |= m_fOptsLen & 0b1111;
+
+    if (m_macCommands.empty())
+    {
+        // Common case: no FOpts, the whole header has a fixed 8-byte layout
+        // and can be emitted with a single write. Byte order matches the
+        // WriteU32/WriteU16 calls of the general path below.
+        uint32_t address = m_address.Get();
+        uint8_t buf[8] = {uint8_t(address),
+                          uint8_t(address >> 8),
+                          uint8_t(address >> 16),
+                          uint8_t(address >> 24),
+                          fCtrl,
+                          uint8_t(m_fCnt),
+                          uint8_t(m_fCnt >> 8),
+                          m_fPort};
+        start.Write(buf, 8);
+        return;
+    }
+
+    // Device Address field
+    start.WriteU32(m_address.Get());
+
+    // fCtrl field
     start.WriteU8(fCtrl);
 
     // FCnt field
@@ -101,6 +121,7 @@ LoraFrameHeader::Deserialize(Buffer::Iterator start)
 
     // Empty the list of MAC commands
     m_macCommands.clear();
+    m_commandTypeMask = 0;
 
     // Read from buffer and save into local variables
     m_address.Set(start.ReadU32());
@@ -121,125 +142,143 @@ LoraFrameHeader::Deserialize(Buffer::Iterator start)
         uint8_t cid = start.PeekU8();
         NS_LOG_DEBUG("CID: " << unsigned(cid));
 
-        // Divide Uplink and Downlink messages
-        // This needs to be done because they have the same CID, and the context
-        // about where this message will be Serialized/Deserialized (i.e., at the
-        // end device or at the network server) is umportant.
-        Ptr<MacCommand> command;
-        if (m_isUplink)
+        // Commands are tiny objects decoded and consumed immediately, so
+        // deserialize into instances recycled from the previous parse
+        // instead of allocating one per command per frame
+        Ptr<MacCommand> command = PooledCommand(cid);
+        if (!command)
         {
-            switch (cid)
-            {
-            // In the case of Uplink messages, the network server will deserialize the
-            // request for a link check
-            case (0x02): {
-                NS_LOG_DEBUG("Creating a LinkCheckReq command");
-                command = Create<LinkCheckReq>();
-                break;
-            }
-            case (0x03): {
-                NS_LOG_DEBUG("Creating a LinkAdrAns command");
-                command = Create<LinkAdrAns>();
-                break;
-            }
-            case (0x04): {
-                NS_LOG_DEBUG("Creating a DutyCycleAns command");
-                command = Create<DutyCycleAns>();
-                break;
-            }
-            case (0x05): {
-                NS_LOG_DEBUG("Creating a RxParamSetupAns command");
-                command = Create<RxParamSetupAns>();
-                break;
-            }
-            case (0x06): {
-                NS_LOG_DEBUG("Creating a DevStatusAns command");
-                command = Create<DevStatusAns>();
-                break;
-            }
-            case (0x07): {
-                NS_LOG_DEBUG("Creating a NewChannelAns command");
-                command = Create<NewChannelAns>();
-                break;
-            }
-            case (0x08): {
-                NS_LOG_DEBUG("Creating a RxTimingSetupAns command");
-                command = Create<RxTimingSetupAns>();
-                break;
-            }
-            case (0x09): {
-                NS_LOG_DEBUG("Creating a TxParamSetupAns command");
-                command = Create<TxParamSetupAns>();
-                break;
-            }
-            case (0x0A): {
-                NS_LOG_DEBUG("Creating a DlChannelAns command");
-                command = Create<DlChannelAns>();
-                break;
-            }
-            default: {
-                NS_LOG_ERROR("CID not recognized during deserialization");
-            }
-            }
-        }
-        else
-        {
-            switch (cid)
-            {
-            // In the case of Downlink messages, the end device will deserialize the
-            // answer to a link check
-            case (0x02): {
-                NS_LOG_DEBUG("Creating a LinkCheckAns command");
-                command = Create<LinkCheckAns>();
-                break;
-            }
-            case (0x03): {
-                NS_LOG_DEBUG("Creating a LinkAdrReq command");
-                command = Create<LinkAdrReq>();
-                break;
-            }
-            case (0x04): {
-                NS_LOG_DEBUG("Creating a DutyCycleReq command");
-                command = Create<DutyCycleReq>();
-                break;
-            }
-            case (0x05): {
-                NS_LOG_DEBUG("Creating a RxParamSetupReq command");
-                command = Create<RxParamSetupReq>();
-                break;
-            }
-            case (0x06): {
-                NS_LOG_DEBUG("Creating a DevStatusReq command");
-                command = Create<DevStatusReq>();
-                break;
-            }
-            case (0x07): {
-                NS_LOG_DEBUG("Creating a NewChannelReq command");
-                command = Create<NewChannelReq>();
-                break;
-            }
-            case (0x08): {
-                NS_LOG_DEBUG("Creating a RxTimingSetupReq command");
-                command = Create<RxTimingSetupReq>();
-                break;
-            }
-            case (0x09): {
-                NS_LOG_DEBUG("Creating a TxParamSetupReq command");
-                command = Create<TxParamSetupReq>();
-                break;
-            }
-            default: {
-                NS_LOG_ERROR("CID not recognized during deserialization");
-            }
-            }
+            NS_LOG_ERROR("CID not recognized during deserialization");
+            break;
         }
         byteNumber += command->Deserialize(start);
         m_macCommands.emplace_back(command);
+        m_commandTypeMask |= 1 << command->GetCommandType();
     }
     m_fPort = start.ReadU8();
     return 8 + m_fOptsLen; // the number of bytes consumed.
 }
 
+Ptr<MacCommand>
+LoraFrameHeader::PooledCommand(uint8_t cid)
+{
+    if (cid < POOL_FIRST_CID || cid >= POOL_FIRST_CID + POOL_CIDS)
+    {
+        return nullptr;
+    }
+    Ptr<MacCommand>& slot = m_commandPool[(cid - POOL_FIRST_CID) + (m_isUplink ? 0 : POOL_CIDS)];
+    if (slot && slot->GetReferenceCount() == 1)
+    {
+        // The previous parse's consumers are done with it: recycle in place
+        return slot;
+    }
+    slot = NewCommand(cid);
+    return slot;
+}
+
+Ptr<MacCommand>
+LoraFrameHeader::NewCommand(uint8_t cid) const
+{
+    // Uplink and Downlink messages must be distinguished here: they share
+    // CIDs, and the context about where this message will be
+    // Serialized/Deserialized (i.e., at the end device or at the network
+    // server) decides which command the CID stands for.
+    if (m_isUplink)
+    {
+        switch (cid)
+        {
+        // In the case of Uplink messages, the network server will deserialize
+        // the request for a link check
+        case (0x02):
+            return Create<LinkCheckReq>();
+        case (0x03):
+            return Create<LinkAdrAns>();
+        case (0x04):
+            return Create<DutyCycleAns>();
+        case (0x05):
+            return Create<RxParamSetupAns>();
+        case (0x06):
+            return Create<DevStatusAns>();
+        case (0x07):
+            return Create<NewChannelAns>();
+        case (0x08):
+            return Create<RxTimingSetupAns>();
+        case (0x09):
+            return Create<TxParamSetupAns>();
+        case (0x0A):
+            return Create<DlChannelAns>();
+        default:
+            return nullptr;
+        }
+    }
+    switch (cid)
+    {
+    // In the case of Downlink messages, the end device will deserialize the
+    // answer to a link check
+    case (0x02):
+        return Create<LinkCheckAns>();
+    case (0x03):
+        return Create<LinkAdrReq>();
+    case (0x04):
+        return Create<DutyCycleReq>();
+    case (0x05):
+        return Create<RxParamSetupReq>();
+    case (0x06):
+        return Create<DevStatusReq>();
+    case (0x07):
+        return Create<NewChannelReq>();
+    case (0x08):
+        return Create<RxTimingSetupReq>();
+    case (0x09):
+        return Create<TxParamSetupReq>();
+    default:
+        return nullptr;
+    }
+}
+
+LoraFrameHeader::FieldView
+LoraFrameHeader::PeekFields(Buffer::Iterator start)
+{
+    FieldView view;
+    view.address.Set(start.ReadU32());
+    uint8_t fCtrl = start.ReadU8();
+    view.adr = (fCtrl >> 7) & 0b1;
+    view.adrAckReq = (fCtrl >> 6) & 0b1;
+    view.ack = (fCtrl >> 5) & 0b1;
+    view.fPending = (fCtrl >> 4) & 0b1;
+    view.fOptsLen = fCtrl & 0b1111;
+    view.fCnt = start.ReadU16();
+    // Skip the FOpts bytes without interpreting them
+    start.Next(view.fOptsLen);
+    view.fPort = start.ReadU8();
+    return view;
+}
+
+LoraFrameHeader::FieldView
+LoraFrameHeader::PeekFields(Ptr<const Packet> packet)
+{
+    // 1 byte of MHDR, 7 fixed FHDR bytes, up to 15 FOpts bytes and FPort
+    uint8_t bytes[24];
+    uint32_t read = packet->CopyData(bytes, sizeof(bytes));
+    NS_ASSERT_MSG(read >= 9, "Packet too short to hold the MAC and frame headers");
+
+    // Field layout and byte order match Serialize; the MHDR byte is skipped
+    FieldView view;
+    view.address.Set(uint32_t(bytes[1]) | uint32_t(bytes[2]) << 8 | uint32_t(bytes[3]) << 16 |
+                     uint32_t(bytes[4]) << 24);
+    uint8_t fCtrl = bytes[5];
+    view.adr = (fCtrl >> 7) & 0b1;
+    view.adrAckReq = (fCtrl >> 6) & 0b1;
+    view.ack = (fCtrl >> 5) & 0b1;
+    view.fPending = (fCtrl >> 4) & 0b1;
+    view.fOptsLen = fCtrl & 0b1111;
+    view.fCnt = uint16_t(bytes[6]) | uint16_t(bytes[7]) << 8;
+    NS_ASSERT_MSG(read >= uint32_t(9) + view.fOptsLen,
+                  "Packet too short to hold the advertised FOpts");
+    view.fPort = bytes[8 + view.fOptsLen];
+    return view;
+}
+
 void
 LoraFrameHeader::Print(std::ostream& os) const
 {
@@ -374,8 +413,7 @@ LoraFrameHeader::AddLinkCheckReq()
 {
     NS_LOG_FUNCTION(this);
     auto command = Create<LinkCheckReq>();
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -383,8 +421,7 @@ LoraFrameHeader::AddLinkCheckAns(uint8_t margin, uint8_t gwCnt)
 {
     NS_LOG_FUNCTION(this << unsigned(margin) << unsigned(gwCnt));
     auto command = Create<LinkCheckAns>(margin, gwCnt);
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -402,8 +439,7 @@ LoraFrameHeader::AddLinkAdrReq(uint8_t dataRate,
     }
     /// @todo Implement chMaskCntl field
     auto command = Create<LinkAdrReq>(dataRate, txPower, channelMask, 0, repetitions);
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -411,8 +447,7 @@ LoraFrameHeader::AddLinkAdrAns(bool powerAck, bool dataRateAck, bool channelMask
 {
     NS_LOG_FUNCTION(this << powerAck << dataRateAck << channelMaskAck);
     auto command = Create<LinkAdrAns>(powerAck, dataRateAck, channelMaskAck);
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -420,8 +455,7 @@ LoraFrameHeader::AddDutyCycleReq(uint8_t dutyCycle)
 {
     NS_LOG_FUNCTION(this << unsigned(dutyCycle));
     auto command = Create<DutyCycleReq>(dutyCycle);
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -429,8 +463,7 @@ LoraFrameHeader::AddDutyCycleAns()
 {
     NS_LOG_FUNCTION(this);
     auto command = Create<DutyCycleAns>();
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -440,8 +473,7 @@ LoraFrameHeader::AddRxParamSetupReq(uint8_t rx1DrOffset, uint8_t rx2DataRate, ui
     // Evaluate whether to eliminate this assert in case new offsets can be defined.
     NS_ASSERT(0 <= rx1DrOffset && rx1DrOffset <= 5);
     auto command = Create<RxParamSetupReq>(rx1DrOffset, rx2DataRate, frequencyHz);
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -449,8 +481,7 @@ LoraFrameHeader::AddRxParamSetupAns()
 {
     NS_LOG_FUNCTION(this);
     auto command = Create<RxParamSetupAns>();
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -458,8 +489,7 @@ LoraFrameHeader::AddDevStatusReq()
 {
     NS_LOG_FUNCTION(this);
     auto command = Create<DevStatusReq>();
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 void
@@ -471,8 +501,7 @@ LoraFrameHeader::AddNewChannelReq(uint8_t chIndex,
     NS_LOG_FUNCTION(this << unsigned(chIndex) << frequencyHz << unsigned(minDataRate)
                          << unsigned(maxDataRate));
     auto command = Create<NewChannelReq>(chIndex, frequencyHz, minDataRate, maxDataRate);
-    m_macCommands.emplace_back(command);
-    m_fOptsLen += command->GetSerializedSize();
+    AddCommand(command);
 }
 
 std::vector<Ptr<MacCommand>>
@@ -488,6 +517,13 @@ LoraFrameHeader::AddCommand(Ptr<MacCommand> macCommand)
     NS_LOG_FUNCTION(this << macCommand);
     m_macCommands.emplace_back(macCommand);
     m_fOptsLen += macCommand->GetSerializedSize();
+    m_commandTypeMask |= 1 << macCommand->GetCommandType();
+}
+
+bool
+LoraFrameHeader::HasCommand(enum MacCommandType type) const
+{
+    return m_commandTypeMask & (1 << type);
 }
 
 // =====================================================
@@ -13,7 +13,9 @@
 #include "mac-command.h"
 
 #include "ns3/header.h"
+#include "ns3/packet.h"
 
+#include <array>
 #include <vector>  // *** ADD THIS FOR FEC ***
 
 namespace ns3
@@ -205,6 +207,49 @@ class LoraFrameHeader : public Header
      */
     uint16_t GetFCnt() const;
 
+    /**
+     * A plain view over the fixed-layout fields of a serialized frame header.
+     *
+     * Filling a view reads the FHDR fields straight out of the buffer without
+     * creating MacCommand objects or copying FOpts bytes, which is all the
+     * network server needs to route most packets.
+     */
+    struct FieldView
+    {
+        LoraDeviceAddress address; //!< The DevAddr field
+        bool adr;                  //!< The ADR field of the FCtrl
+        bool adrAckReq;            //!< The ADRACKReq field of the FCtrl
+        bool ack;                  //!< The ACK field of the FCtrl
+        bool fPending;             //!< The FPending/ClassB field of the FCtrl
+        uint8_t fOptsLen;          //!< The FOptsLen field of the FCtrl
+        uint16_t fCnt;             //!< The FCnt field
+        uint8_t fPort;             //!< The FPort field
+    };
+
+    /**
+     * Read the fixed-layout fields of a serialized frame header in place.
+     *
+     * Unlike Deserialize, this does not interpret the FOpts MAC commands and
+     * performs no allocation, so it can be used as a zero-copy parse path on
+     * received buffers.
+     *
+     * @param start An iterator over the buffer holding the serialized header.
+     * @return The view of the header fields.
+     */
+    static FieldView PeekFields(Buffer::Iterator start);
+
+    /**
+     * Read the fixed-layout frame header fields of a complete LoRaWAN packet.
+     *
+     * The one-byte LorawanMacHeader preceding the frame header is skipped, so
+     * this can be called directly on a packet as received by the network
+     * server, without copying it or deserializing its headers into objects.
+     *
+     * @param packet The packet, with the MAC and frame headers still in place.
+     * @return The view of the frame header fields.
+     */
+    static FieldView PeekFields(Ptr<const Packet> packet);
+
     /**
      * Return a pointer to the first MacCommand of type T, or 0 if no such MacCommand exists
      * in this header.
@@ -313,7 +358,37 @@ class LoraFrameHeader : public Header
      */
     void AddCommand(Ptr<MacCommand> macCommand);
 
+    /**
+     * Check whether this header carries a MAC command of the given type.
+     *
+     * This is an O(1) bitmap test, maintained as commands are added or
+     * deserialized, so callers can avoid scanning the command list.
+     *
+     * @param type The MAC command type to look for.
+     * @return True if a command of that type is present.
+     */
+    bool HasCommand(enum MacCommandType type) const;
+
   private:
+    /**
+     * Get a command instance for a CID, recycling the one pooled from a
+     * previous parse when nobody else still references it, and allocating
+     * (and pooling) a fresh one otherwise.
+     *
+     * @param cid The command identifier read from the FOpts field.
+     * @return A command ready to deserialize into, nullptr for unknown CIDs.
+     */
+    Ptr<MacCommand> PooledCommand(uint8_t cid);
+
+    /**
+     * Allocate a new command instance for a CID, honoring the header's
+     * uplink/downlink context.
+     *
+     * @param cid The command identifier read from the FOpts field.
+     * @return The new command, nullptr for unknown CIDs.
+     */
+    Ptr<MacCommand> NewCommand(uint8_t cid) const;
+
     uint8_t m_fPort; //!< The FPort field
 
     LoraDeviceAddress m_address; //!< The DevAddr field
@@ -330,14 +405,31 @@ class LoraFrameHeader : public Header
     std::vector<Ptr<MacCommand>> m_macCommands; //!< Vector containing all the MacCommand instances
                                                 //!< that are contained in this LoraFrameHeader
 
+    uint32_t m_commandTypeMask; //!< Bitmap of carried command types, bit index = MacCommandType
+
     bool m_isUplink; //!< Whether this frame header is uplink or not
+
+    static constexpr uint8_t POOL_FIRST_CID = 0x02; //!< Lowest CID kept in the pool
+    static constexpr uint8_t POOL_CIDS = 9;         //!< Pooled CID range, 0x02 to 0x0A
+
+    /**
+     * Command instances recycled across parses, one slot per (CID,
+     * direction) pair. Commands are decoded and consumed immediately by
+     * every in-tree reader, so on the next Deserialize the pooled instance
+     * is usually the only remaining reference and can be deserialized into
+     * again instead of allocating; a slot still referenced elsewhere is
+     * simply replaced by a fresh allocation.
+     */
+    std::array<Ptr<MacCommand>, 2 * POOL_CIDS> m_commandPool;
 };
 
 template <typename T>
 Ptr<T>
 LoraFrameHeader::GetMacCommand()
 {
-    // Iterate on MAC commands and try casting
+    // Real frames carry at most a couple of commands, so a linear scan with
+    // a cast per element is fine; use HasCommand to cheaply rule out absent
+    // types before calling this.
     for (const auto& cmd : m_macCommands)
     {
         if (auto c = DynamicCast<T>(cmd); c)
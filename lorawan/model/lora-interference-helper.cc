@@ -8,10 +8,17 @@
 
 #include "lora-interference-helper.h"
 
+#include "lora-utils.h"
+
+#include "ns3/double.h"
 #include "ns3/enum.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <memory>
+#include <vector>
 
 namespace ns3
 {
@@ -34,6 +41,8 @@ LoraInterferenceHelper::Event::Event(Time duration,
       m_endTime(m_startTime + duration),
       m_sf(spreadingFactor),
       m_rxPowerdBm(rxPowerdBm),
+      // Quantized conversion: interference sums are insensitive to <0.1 dB
+      m_rxPowerW(DbmToWQuantized(rxPowerdBm)),
       m_packet(packet),
       m_frequencyHz(frequencyHz)
 {
@@ -46,6 +55,57 @@ LoraInterferenceHelper::Event::~Event()
     // NS_LOG_FUNCTION_NOARGS ();
 }
 
+namespace
+{
+/// Number of Event slots allocated per pool chunk.
+constexpr std::size_t eventPoolChunkSize = 64;
+/// Backing storage of the Event pool; chunks are only released at exit.
+std::vector<std::unique_ptr<char[]>> eventPoolChunks;
+/// Head of the free list, threaded through the unused slots themselves.
+void* eventFreeList = nullptr;
+} // namespace
+
+void*
+LoraInterferenceHelper::Event::operator new(std::size_t size)
+{
+    if (size != sizeof(Event))
+    {
+        // A derived type we do not know the layout of: use the default heap
+        return ::operator new(size);
+    }
+
+    if (!eventFreeList)
+    {
+        // Grow the pool by one chunk and thread its slots onto the free list
+        eventPoolChunks.emplace_back(new char[eventPoolChunkSize * sizeof(Event)]);
+        char* chunk = eventPoolChunks.back().get();
+        for (std::size_t i = 0; i < eventPoolChunkSize; i++)
+        {
+            void* slot = chunk + i * sizeof(Event);
+            *static_cast<void**>(slot) = eventFreeList;
+            eventFreeList = slot;
+        }
+    }
+
+    void* slot = eventFreeList;
+    eventFreeList = *static_cast<void**>(slot);
+    return slot;
+}
+
+void
+LoraInterferenceHelper::Event::operator delete(void* ptr, std::size_t size)
+{
+    if (size != sizeof(Event))
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    // Push the slot back onto the free list
+    *static_cast<void**>(ptr) = eventFreeList;
+    eventFreeList = ptr;
+}
+
 // Getters
 Time
 LoraInterferenceHelper::Event::GetStartTime() const
@@ -71,6 +131,12 @@ LoraInterferenceHelper::Event::GetRxPowerdBm() const
     return m_rxPowerdBm;
 }
 
+double
+LoraInterferenceHelper::Event::GetRxPowerWatts() const
+{
+    return m_rxPowerW;
+}
+
 uint8_t
 LoraInterferenceHelper::Event::GetSpreadingFactor() const
 {
@@ -107,36 +173,122 @@ operator<<(std::ostream& os, const LoraInterferenceHelper::Event& event)
 /****************************
  *  LoraInterferenceHelper  *
  ****************************/
-// This collision matrix can be used for comparisons with the performance of Aloha
-// systems, where collisions imply the loss of both packets.
-double inf = std::numeric_limits<double>::max();
-std::vector<std::vector<double>> LoraInterferenceHelper::collisionSnirAloha = {
-    //   7   8   9  10  11  12
-    {inf, -inf, -inf, -inf, -inf, -inf}, // SF7
-    {-inf, inf, -inf, -inf, -inf, -inf}, // SF8
-    {-inf, -inf, inf, -inf, -inf, -inf}, // SF9
-    {-inf, -inf, -inf, inf, -inf, -inf}, // SF10
-    {-inf, -inf, -inf, -inf, inf, -inf}, // SF11
-    {-inf, -inf, -inf, -inf, -inf, inf}  // SF12
-};
-
-// LoRa Collision Matrix (Goursaud)
-// Values are inverted w.r.t. the paper since here we interpret this as an
-// _isolation_ matrix instead of a cochannel _rejection_ matrix like in
-// Goursaud's paper.
-std::vector<std::vector<double>> LoraInterferenceHelper::collisionSnirGoursaud = {
-    // SF7  SF8  SF9  SF10 SF11 SF12
-    {6, -16, -18, -19, -19, -20}, // SF7
-    {-24, 6, -20, -22, -22, -22}, // SF8
-    {-27, -27, 6, -23, -25, -25}, // SF9
-    {-30, -30, -30, 6, -26, -28}, // SF10
-    {-33, -33, -33, -33, 6, -29}, // SF11
-    {-36, -36, -36, -36, -36, 6}  // SF12
-};
+namespace
+{
+/**
+ * Copy one of the compile-time isolation tables into the legacy vector form.
+ *
+ * @param table The constexpr table to copy.
+ * @return The table as a vector of vectors.
+ */
+std::vector<std::vector<double>>
+TableToVectors(const std::array<std::array<double, 6>, 6>& table)
+{
+    std::vector<std::vector<double>> matrix;
+    for (const auto& row : table)
+    {
+        matrix.emplace_back(row.begin(), row.end());
+    }
+    return matrix;
+}
+} // namespace
+
+constexpr std::array<std::array<double, 6>, 6> LoraInterferenceHelper::collisionSnirAlohaTable;
+constexpr std::array<std::array<double, 6>, 6> LoraInterferenceHelper::collisionSnirGoursaudTable;
+
+// The vector forms are kept for compatibility with code that indexes the
+// public matrices; the constexpr tables above are the source of truth.
+std::vector<std::vector<double>> LoraInterferenceHelper::collisionSnirAloha =
+    TableToVectors(LoraInterferenceHelper::collisionSnirAlohaTable);
+
+std::vector<std::vector<double>> LoraInterferenceHelper::collisionSnirGoursaud =
+    TableToVectors(LoraInterferenceHelper::collisionSnirGoursaudTable);
 
 LoraInterferenceHelper::CollisionMatrix LoraInterferenceHelper::collisionMatrix =
     LoraInterferenceHelper::GOURSAUD;
 
+bool LoraInterferenceHelper::useEnergyTimeline = false;
+
+LoraInterferenceHelper::Stats LoraInterferenceHelper::m_stats;
+
+bool LoraInterferenceHelper::m_splittingEnabled = false;
+double LoraInterferenceHelper::m_splittingBandDb = 0;
+uint32_t LoraInterferenceHelper::m_splittingTrials = 0;
+Ptr<NormalRandomVariable> LoraInterferenceHelper::m_splittingJitterRv;
+Callback<void, uint8_t, double> LoraInterferenceHelper::m_splittingSink;
+
+LoraInterferenceHelper::Stats
+LoraInterferenceHelper::GetStats()
+{
+    return m_stats;
+}
+
+void
+LoraInterferenceHelper::EnableRareEventSplitting(double bandDb,
+                                                 uint32_t trials,
+                                                 double jitterDb,
+                                                 Callback<void, uint8_t, double> sink)
+{
+    NS_ASSERT_MSG(bandDb > 0 && trials > 0 && jitterDb > 0,
+                  "Splitting band, trials and jitter must be positive");
+
+    m_splittingEnabled = true;
+    m_splittingBandDb = bandDb;
+    m_splittingTrials = trials;
+    m_splittingJitterRv = CreateObject<NormalRandomVariable>();
+    m_splittingJitterRv->SetAttribute("Mean", DoubleValue(0));
+    m_splittingJitterRv->SetAttribute("Variance", DoubleValue(jitterDb * jitterDb));
+    m_splittingSink = sink;
+}
+
+void
+LoraInterferenceHelper::DisableRareEventSplitting()
+{
+    m_splittingEnabled = false;
+    m_splittingJitterRv = nullptr;
+    m_splittingSink = MakeNullCallback<void, uint8_t, double>();
+}
+
+void
+LoraInterferenceHelper::ReportWeightedOutcome(uint8_t sf, double minRatioLinear)
+{
+    if (m_splittingSink.IsNull())
+    {
+        return;
+    }
+
+    // An infinite ratio means no interference at all: a certain survival
+    double marginDb = std::isinf(minRatioLinear) ? m_splittingBandDb
+                                                 : 10 * std::log10(minRatioLinear);
+
+    double lossProbability;
+    if (marginDb >= m_splittingBandDb)
+    {
+        lossProbability = 0;
+    }
+    else if (marginDb <= -m_splittingBandDb)
+    {
+        lossProbability = 1;
+    }
+    else
+    {
+        // Near-threshold packet: resample the outcome under a Gaussian dB
+        // perturbation of the margin, standing in for the unresolved fading
+        // realization, and report the destroyed fraction as its loss weight
+        uint32_t destroyed = 0;
+        for (uint32_t trial = 0; trial < m_splittingTrials; trial++)
+        {
+            if (marginDb + m_splittingJitterRv->GetValue() < 0)
+            {
+                destroyed++;
+            }
+        }
+        lossProbability = double(destroyed) / m_splittingTrials;
+    }
+
+    m_splittingSink(sf, lossProbability);
+}
+
 NS_OBJECT_ENSURE_REGISTERED(LoraInterferenceHelper);
 
 void
@@ -154,6 +306,17 @@ LoraInterferenceHelper::SetCollisionMatrix(
         m_collisionSnir = LoraInterferenceHelper::collisionSnirGoursaud;
         break;
     }
+
+    // Precompute the linear-scale form used by the collision inner loop.
+    // Overflow to +inf (always destroyed) and underflow to 0 (never
+    // destroyed) give exactly the semantics of the +-max dB entries.
+    for (std::size_t i = 0; i < 6; i++)
+    {
+        for (std::size_t j = 0; j < 6; j++)
+        {
+            m_collisionSnirLinear[i][j] = pow(10, m_collisionSnir[i][j] / 10);
+        }
+    }
 }
 
 TypeId
@@ -200,6 +363,31 @@ LoraInterferenceHelper::Add(Time duration,
 
     // Add the event to the list
     m_events.push_back(event);
+    m_stats.eventsAdded++;
+
+    if (useEnergyTimeline)
+    {
+        Time now = Now();
+        double powerW = event->GetRxPowerWatts();
+
+        // Register the signal on the timeline of its (frequency, SF) pair
+        SfTimeline& timeline = m_timelines[GetTimelineKey(frequencyHz, spreadingFactor)];
+        AdvanceTimeline(timeline, now);
+        timeline.currentPowerW += powerW;
+        timeline.endings.emplace(now + duration, powerW);
+
+        // Snapshot the six per-SF integrals of this frequency, so that the
+        // interference suffered by this event can later be read as a
+        // difference of integrals
+        std::array<double, 6> snapshot;
+        for (uint8_t sf = 7; sf <= 12; sf++)
+        {
+            SfTimeline& sfTimeline = m_timelines[GetTimelineKey(frequencyHz, sf)];
+            AdvanceTimeline(sfTimeline, now);
+            snapshot[sf - 7] = sfTimeline.cumulativeEnergyJ;
+        }
+        m_energySnapshots[PeekPointer(event)] = snapshot;
+    }
 
     // Clean the event list
     if (m_events.size() > 100)
@@ -210,6 +398,31 @@ LoraInterferenceHelper::Add(Time duration,
     return event;
 }
 
+void
+LoraInterferenceHelper::AdvanceTimeline(SfTimeline& timeline, Time now)
+{
+    // Fold in the signals that ended since the last update, in order
+    auto it = timeline.endings.begin();
+    while (it != timeline.endings.end() && it->first <= now)
+    {
+        timeline.cumulativeEnergyJ +=
+            timeline.currentPowerW * (it->first - timeline.lastUpdate).GetSeconds();
+        timeline.currentPowerW -= it->second;
+        timeline.lastUpdate = it->first;
+        it = timeline.endings.erase(it);
+    }
+
+    // Integrate the still-active signals up to the current instant
+    timeline.cumulativeEnergyJ += timeline.currentPowerW * (now - timeline.lastUpdate).GetSeconds();
+    timeline.lastUpdate = now;
+}
+
+uint64_t
+LoraInterferenceHelper::GetTimelineKey(uint32_t frequencyHz, uint8_t sf)
+{
+    return (uint64_t(frequencyHz) << 3) | uint64_t(sf - 7);
+}
+
 void
 LoraInterferenceHelper::CleanOldEvents()
 {
@@ -220,6 +433,9 @@ LoraInterferenceHelper::CleanOldEvents()
     {
         if ((*it)->GetEndTime() + oldEventThreshold < Now())
         {
+            // Drop the snapshot of events that were never queried (e.g. the
+            // ones the PHY could not lock on)
+            m_energySnapshots.erase(PeekPointer(*it));
             it = m_events.erase(it);
         }
         else
@@ -256,12 +472,13 @@ LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Ev
 
     NS_LOG_INFO("Current number of events in LoraInterferenceHelper: " << m_events.size());
 
+    m_stats.interferenceChecks++;
+
     // We want to see the interference affecting this event: cycle through events
     // that overlap with this one and see whether it survives the interference or
     // not.
 
     // Gather information about the event
-    double rxPowerDbm = event->GetRxPowerdBm();
     uint8_t sf = event->GetSpreadingFactor();
     uint32_t frequencyHz = event->GetFrequency();
 
@@ -276,73 +493,99 @@ LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Ev
     // Energy for interferers of various SFs
     std::vector<double> cumulativeInterferenceEnergy(6, 0);
 
-    // Cycle over the events
-    for (it = m_events.begin(); it != m_events.end();)
+    if (useEnergyTimeline)
     {
-        // Pointer to the current interferer
-        Ptr<LoraInterferenceHelper::Event> interferer = *it;
+        // Read the interference suffered by this event as the difference
+        // between the current per-SF energy integrals of its frequency and
+        // the snapshot taken when the event started
+        auto snapshot = m_energySnapshots.find(PeekPointer(event));
+        NS_ASSERT_MSG(snapshot != m_energySnapshots.end(),
+                      "No energy snapshot for the event under analysis");
+        for (uint8_t currentSf = 7; currentSf <= 12; currentSf++)
+        {
+            SfTimeline& timeline = m_timelines[GetTimelineKey(frequencyHz, currentSf)];
+            AdvanceTimeline(timeline, now);
+            cumulativeInterferenceEnergy.at(currentSf - 7) =
+                timeline.cumulativeEnergyJ - snapshot->second.at(currentSf - 7);
+        }
+
+        // The event's own energy was integrated on its own SF: take it out
+        cumulativeInterferenceEnergy.at(sf - 7) -=
+            event->GetRxPowerWatts() * duration.GetSeconds();
 
-        // Only consider the current event if the channel is the same: we
-        // assume there's no interchannel interference. Also skip the current
-        // event if it's the same that we want to analyze.
-        if (!(interferer->GetFrequency() == frequencyHz) || interferer == event)
+        m_energySnapshots.erase(snapshot);
+    }
+    else
+    {
+        // Cycle over the events
+        for (it = m_events.begin(); it != m_events.end();)
         {
-            NS_LOG_DEBUG("Different channel or same event");
+            // Pointer to the current interferer
+            Ptr<LoraInterferenceHelper::Event> interferer = *it;
+            m_stats.eventsExamined++;
+
+            // Only consider the current event if the channel is the same: we
+            // assume there's no interchannel interference. Also skip the current
+            // event if it's the same that we want to analyze.
+            if (!(interferer->GetFrequency() == frequencyHz) || interferer == event)
+            {
+                NS_LOG_DEBUG("Different channel or same event");
+                it++;
+                continue; // Continues from the first line inside the for cycle
+            }
+
+            NS_LOG_DEBUG("Interferer on same channel");
+
+            // Gather information about this interferer
+            uint8_t interfererSf = interferer->GetSpreadingFactor();
+            double interfererPower = interferer->GetRxPowerdBm();
+            Time interfererStartTime = interferer->GetStartTime();
+            Time interfererEndTime = interferer->GetEndTime();
+
+            NS_LOG_INFO("Found an interferer: sf = " << unsigned(interfererSf)
+                                                     << ", power = " << interfererPower
+                                                     << ", start time = " << interfererStartTime
+                                                     << ", end time = " << interfererEndTime);
+
+            // Compute the fraction of time the two events are overlapping
+            Time overlap = GetOverlapTime(event, interferer);
+
+            NS_LOG_DEBUG("The two events overlap for " << overlap.As(Time::S));
+
+            // Compute the equivalent energy of the interference, using the
+            // linear power precomputed by the Event constructor
+            double interfererPowerW = interferer->GetRxPowerWatts();
+            // Energy [J] = Time [s] * Power [W]
+            double interferenceEnergy = overlap.GetSeconds() * interfererPowerW;
+            cumulativeInterferenceEnergy.at(unsigned(interfererSf) - 7) += interferenceEnergy;
+            NS_LOG_DEBUG("Interferer power in W: " << interfererPowerW);
+            NS_LOG_DEBUG("Interference energy: " << interferenceEnergy);
             it++;
-            continue; // Continues from the first line inside the for cycle
         }
-
-        NS_LOG_DEBUG("Interferer on same channel");
-
-        // Gather information about this interferer
-        uint8_t interfererSf = interferer->GetSpreadingFactor();
-        double interfererPower = interferer->GetRxPowerdBm();
-        Time interfererStartTime = interferer->GetStartTime();
-        Time interfererEndTime = interferer->GetEndTime();
-
-        NS_LOG_INFO("Found an interferer: sf = " << unsigned(interfererSf)
-                                                 << ", power = " << interfererPower
-                                                 << ", start time = " << interfererStartTime
-                                                 << ", end time = " << interfererEndTime);
-
-        // Compute the fraction of time the two events are overlapping
-        Time overlap = GetOverlapTime(event, interferer);
-
-        NS_LOG_DEBUG("The two events overlap for " << overlap.As(Time::S));
-
-        // Compute the equivalent energy of the interference
-        // Power [mW] = 10^(Power[dBm]/10)
-        // Power [W] = Power [mW] / 1000
-        double interfererPowerW = pow(10, interfererPower / 10) / 1000;
-        // Energy [J] = Time [s] * Power [W]
-        double interferenceEnergy = overlap.GetSeconds() * interfererPowerW;
-        cumulativeInterferenceEnergy.at(unsigned(interfererSf) - 7) += interferenceEnergy;
-        NS_LOG_DEBUG("Interferer power in W: " << interfererPowerW);
-        NS_LOG_DEBUG("Interference energy: " << interferenceEnergy);
-        it++;
     }
 
+    // Signal energy, from the linear power precomputed by the Event constructor
+    double signalEnergy = duration.GetSeconds() * event->GetRxPowerWatts();
+    NS_LOG_DEBUG("Signal energy: " << signalEnergy);
+
     // For each spreading factor, check if there was destructive interference
+    uint8_t destroyedBySf = 0;
+    double minRatioLinear = std::numeric_limits<double>::infinity();
     for (auto currentSf = uint8_t(7); currentSf <= uint8_t(12); currentSf++)
     {
-        NS_LOG_DEBUG("Cumulative Interference Energy: "
-                     << cumulativeInterferenceEnergy.at(unsigned(currentSf) - 7));
-
-        // Use the computed cumulativeInterferenceEnergy to determine whether the
-        // interference with this spreading factor destroys the packet
-        double signalPowerW = pow(10, rxPowerDbm / 10) / 1000;
-        double signalEnergy = duration.GetSeconds() * signalPowerW;
-        NS_LOG_DEBUG("Signal power in W: " << signalPowerW);
-        NS_LOG_DEBUG("Signal energy: " << signalEnergy);
-
-        // Check whether the packet survives the interference of this spreading factor
-        double snirIsolation = m_collisionSnir[unsigned(sf) - 7][unsigned(currentSf) - 7];
-        NS_LOG_DEBUG("The needed isolation to survive is " << snirIsolation << " dB");
-        double snir =
-            10 * log10(signalEnergy / cumulativeInterferenceEnergy.at(unsigned(currentSf) - 7));
-        NS_LOG_DEBUG("The current SNIR is " << snir << " dB");
-
-        if (snir >= snirIsolation)
+        double interferenceEnergy = cumulativeInterferenceEnergy.at(unsigned(currentSf) - 7);
+        NS_LOG_DEBUG("Cumulative Interference Energy: " << interferenceEnergy);
+
+        // Check whether the packet survives the interference of this
+        // spreading factor. The comparison snir >= isolation is performed in
+        // the linear energy domain to avoid transcendental calls:
+        // 10 log10(S/I) >= iso  <=>  S >= I * 10^(iso/10)
+        double snirIsolationLinear =
+            m_collisionSnirLinear[unsigned(sf) - 7][unsigned(currentSf) - 7];
+        NS_LOG_DEBUG("The needed isolation to survive is "
+                     << m_collisionSnir[unsigned(sf) - 7][unsigned(currentSf) - 7] << " dB");
+
+        if (interferenceEnergy == 0 || signalEnergy >= interferenceEnergy * snirIsolationLinear)
         {
             // Move on and check the rest of the interferers
             NS_LOG_DEBUG("Packet survived interference with SF " << currentSf);
@@ -351,9 +594,34 @@ LoraInterferenceHelper::IsDestroyedByInterference(Ptr<LoraInterferenceHelper::Ev
         {
             NS_LOG_DEBUG("Packet destroyed by interference with SF" << unsigned(currentSf));
 
-            return currentSf;
+            if (!m_splittingEnabled)
+            {
+                return currentSf;
+            }
+            if (destroyedBySf == 0)
+            {
+                destroyedBySf = currentSf;
+            }
+        }
+
+        // The splitting estimator needs the margin of the tightest
+        // constraint, so keep scanning the remaining spreading factors
+        if (m_splittingEnabled && interferenceEnergy > 0)
+        {
+            minRatioLinear = std::min(minRatioLinear,
+                                      signalEnergy / (interferenceEnergy * snirIsolationLinear));
         }
     }
+
+    if (m_splittingEnabled)
+    {
+        ReportWeightedOutcome(sf, minRatioLinear);
+        if (destroyedBySf != 0)
+        {
+            return destroyedBySf;
+        }
+    }
+
     // If we get to here, it means that the packet survived all interference
     NS_LOG_DEBUG("Packet survived all interference");
 
@@ -367,6 +635,8 @@ LoraInterferenceHelper::ClearAllEvents()
     NS_LOG_FUNCTION_NOARGS();
 
     m_events.clear();
+    m_timelines.clear();
+    m_energySnapshots.clear();
 }
 
 Time
@@ -101,26 +101,6 @@ LoraNetDevice::CompleteConfig()
     m_configComplete = true;
 }
 
-void
-LoraNetDevice::Send(Ptr<Packet> packet)
-{
-    NS_LOG_FUNCTION(this << packet);
-
-    // Send the packet to the MAC layer, if it exists
-    NS_ASSERT(m_mac);
-    m_mac->Send(packet);
-}
-
-void
-LoraNetDevice::Receive(Ptr<Packet> packet)
-{
-    NS_LOG_FUNCTION(this << packet);
-
-    // Fill protocol and address with empty stuff
-    NS_LOG_DEBUG("Calling receiveCallback");
-    m_receiveCallback(this, packet, 0, Address());
-}
-
 /******************************************
  *    Methods inherited from NetDevice    *
  ******************************************/
@@ -84,6 +84,9 @@ class LoraNetDevice : public NetDevice
     /**
      * Send a packet through the LoRaWAN stack.
      *
+     * This is on the per-packet fast path, so it is defined inline below the
+     * class definition.
+     *
      * @param packet The packet to send.
      */
     void Send(Ptr<Packet> packet);
@@ -100,6 +103,9 @@ class LoraNetDevice : public NetDevice
      * Callback the Mac layer calls whenever a packet arrives and needs to be
      * forwarded up the stack.
      *
+     * This is on the per-packet fast path, so it is defined inline below the
+     * class definition.
+     *
      * @param packet The packet that was received.
      */
     void Receive(Ptr<Packet> packet);
@@ -173,6 +179,26 @@ class LoraNetDevice : public NetDevice
     NetDevice::ReceiveCallback m_receiveCallback;
 };
 
+// The device is a pure pass-through between applications and the MAC: these
+// two methods run once per packet, so they are defined inline here to spare
+// callers a cross-translation-unit call. Per-call logging is intentionally
+// omitted; the MAC and the receive callback both log the same packet.
+
+inline void
+LoraNetDevice::Send(Ptr<Packet> packet)
+{
+    // Send the packet to the MAC layer, if it exists
+    NS_ASSERT(m_mac);
+    m_mac->Send(packet);
+}
+
+inline void
+LoraNetDevice::Receive(Ptr<Packet> packet)
+{
+    // Fill protocol and address with empty stuff
+    m_receiveCallback(this, packet, 0, Address());
+}
+
 } // namespace lorawan
 
 } // namespace ns3
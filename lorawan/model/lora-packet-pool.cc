@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#include "lora-packet-pool.h"
+
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+std::vector<uint8_t> LoraPacketPool::m_zeroes;
+bool LoraPacketPool::m_clearScheduled = false;
+
+Ptr<Packet>
+LoraPacketPool::CreatePacket(uint32_t size)
+{
+    if (size == 0)
+    {
+        return Create<Packet>();
+    }
+    if (m_zeroes.size() < size)
+    {
+        m_zeroes.resize(size, 0);
+        if (!m_clearScheduled)
+        {
+            Simulator::ScheduleDestroy(&LoraPacketPool::Clear);
+            m_clearScheduled = true;
+        }
+    }
+    // Construct a new packet over the shared zero source rather than copying
+    // a cached template: Packet::Copy() preserves the UID, and UID-keyed
+    // consumers (the packet tracker, the server's uplink deduplication)
+    // depend on distinct transmissions having distinct UIDs
+    return Create<Packet>(m_zeroes.data(), size);
+}
+
+void
+LoraPacketPool::Clear()
+{
+    m_zeroes.clear();
+    m_zeroes.shrink_to_fit();
+    m_clearScheduled = false;
+}
+
+} // namespace lorawan
+} // namespace ns3
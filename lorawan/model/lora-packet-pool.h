@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef LORA_PACKET_POOL_H
+#define LORA_PACKET_POOL_H
+
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * A pooled factory for the dummy application payloads generated by the
+ * sender applications.
+ *
+ * Application payloads in this module are zero-filled buffers of at most a
+ * few tens of bytes (LoRaWAN payloads are limited to 51 bytes at SF12), so
+ * all packets of the same size are identical byte-wise. This factory keeps
+ * one shared zero source buffer and constructs each payload over it, so
+ * the zero bytes are never re-materialized per uplink.
+ *
+ * Every packet handed out is a freshly constructed ns-3 packet with its
+ * own unique UID. This is a correctness requirement, not an optimization
+ * detail: the packet tracker and the network server's uplink
+ * deduplication key their records on the UID, relying on it being shared
+ * only among copies of one transmission. Handing out Copy()s of a cached
+ * template packet would preserve the template's UID and alias every
+ * same-size payload in the simulation.
+ */
+class LoraPacketPool
+{
+  public:
+    /**
+     * Create a zero-filled packet of the given size.
+     *
+     * Equivalent to Create<Packet>(size): the returned packet has its own
+     * fresh UID and owns its buffer.
+     *
+     * @param size The payload size in bytes.
+     * @return A packet of the requested size.
+     */
+    static Ptr<Packet> CreatePacket(uint32_t size);
+
+    /**
+     * Drop the shared zero source buffer. Scheduled at Simulator::Destroy
+     * the first time the buffer grows, so long campaigns running several
+     * simulations in one process release it between runs.
+     */
+    static void Clear();
+
+  private:
+    /**
+     * The shared zero source buffer, grown to the largest size seen so far.
+     */
+    static std::vector<uint8_t> m_zeroes;
+
+    /**
+     * Whether Clear() is already scheduled at Simulator::Destroy.
+     */
+    static bool m_clearScheduled;
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* LORA_PACKET_POOL_H */
@@ -12,6 +12,7 @@
 #include "ns3/simulator.h"
 
 #include <algorithm>
+#include <unordered_map>
 
 namespace ns3
 {
@@ -112,6 +113,14 @@ LoraPhy::GetMobility()
     }
 }
 
+LoraInterferenceHelper&
+LoraPhy::GetInterferenceHelper()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    return m_interference;
+}
+
 void
 LoraPhy::SetMobility(Ptr<MobilityModel> mobility)
 {
@@ -157,6 +166,37 @@ LoraPhy::GetOnAirTime(Ptr<Packet> packet, LoraTxParameters txParams)
 {
     NS_LOG_FUNCTION(packet << txParams);
 
+    // The parameter space is tiny (a handful of SFs, bandwidths and payload
+    // sizes), and this function sits on the uplink, duty-cycle and ADR paths,
+    // so results are memoized. The key packs all inputs exactly; parameter
+    // combinations that do not fit the packing are computed directly.
+    static std::unordered_map<uint64_t, Time> onAirTimeCache;
+
+    uint32_t pl = packet->GetSize();
+    uint32_t bandwidthKhz = txParams.bandwidthHz / 1000;
+    if (pl <= 0xFFFF && txParams.nPreamble <= 0xFFFF && txParams.bandwidthHz % 1000 == 0 &&
+        bandwidthKhz <= 0x7FF)
+    {
+        uint64_t key = uint64_t(pl) | (uint64_t(txParams.nPreamble) << 16) |
+                       (uint64_t(bandwidthKhz) << 32) | (uint64_t(txParams.sf) << 43) |
+                       (uint64_t(txParams.codingRate) << 51) |
+                       (uint64_t(txParams.headerDisabled) << 59) |
+                       (uint64_t(txParams.crcEnabled) << 60) |
+                       (uint64_t(txParams.lowDataRateOptimizationEnabled) << 61);
+        auto it = onAirTimeCache.find(key);
+        if (it == onAirTimeCache.end())
+        {
+            it = onAirTimeCache.emplace(key, ComputeOnAirTime(pl, txParams)).first;
+        }
+        return it->second;
+    }
+
+    return ComputeOnAirTime(pl, txParams);
+}
+
+Time
+LoraPhy::ComputeOnAirTime(uint32_t pl, LoraTxParameters txParams)
+{
     // The contents of this function are based on [1].
     // [1] SX1272 LoRa modem designer's guide.
 
@@ -167,8 +207,6 @@ LoraPhy::GetOnAirTime(Ptr<Packet> packet, LoraTxParameters txParams)
     // Compute the preamble duration
     double tPreamble = (double(txParams.nPreamble) + 4.25) * tSym;
 
-    // Payload size
-    uint32_t pl = packet->GetSize(); // Size in bytes
     NS_LOG_DEBUG("Packet of size " << pl << " bytes");
 
     // This step is needed since the formula deals with double values.
@@ -21,6 +21,33 @@
 
 #include <list>
 
+/**
+ * @ingroup lorawan
+ *
+ * Fire a per-packet trace source on the PHY/channel hot path.
+ *
+ * When the module is built with the NS3_LORAWAN_LEAN_PHY_TRACING CMake option
+ * the invocation (including the evaluation of its arguments, e.g. node id
+ * lookups) is compiled out entirely. In regular builds the callback chain is
+ * only invoked when something is actually connected, so unhooked trace
+ * sources cost a single empty check.
+ */
+#ifdef LORAWAN_LEAN_PHY_TRACING
+#define LORAWAN_PHY_TRACE(trace, ...)                                                              \
+    do                                                                                             \
+    {                                                                                              \
+    } while (false)
+#else
+#define LORAWAN_PHY_TRACE(trace, ...)                                                              \
+    do                                                                                             \
+    {                                                                                              \
+        if (!trace.IsEmpty())                                                                      \
+        {                                                                                          \
+            trace(__VA_ARGS__);                                                                    \
+        }                                                                                          \
+    } while (false)
+#endif
+
 namespace ns3
 {
 namespace lorawan
@@ -197,6 +224,16 @@ class LoraPhy : public Object
      */
     Ptr<MobilityModel> GetMobility();
 
+    /**
+     * Get the interference helper of this PHY.
+     *
+     * Exposed so analytic load models can register synthetic interference
+     * events at this receiver without a transmitting device behind them.
+     *
+     * @return Reference to the LoraInterferenceHelper.
+     */
+    LoraInterferenceHelper& GetInterferenceHelper();
+
     /**
      * Set the mobility model associated to this PHY.
      *
@@ -257,6 +294,19 @@ class LoraPhy : public Object
     static Time GetOnAirTime(Ptr<Packet> packet, LoraTxParameters txParams);
 
   private:
+    /**
+     * Evaluate the on-air time formula for a payload size.
+     *
+     * This is the uncached computation behind GetOnAirTime, which memoizes
+     * its results since the (SF, bandwidth, payload size, flags) space seen
+     * during a simulation is tiny.
+     *
+     * @param pl The payload size in bytes, including headers and trailers.
+     * @param txParams The set of parameters that will be used for transmission.
+     * @return The time necessary to transmit the packet.
+     */
+    static Time ComputeOnAirTime(uint32_t pl, LoraTxParameters txParams);
+
     /**
      * Internal call when transmission of a packet finishes.
      *
@@ -8,9 +8,13 @@
 
 #include "lora-radio-energy-model.h"
 
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/energy-source.h"
 #include "ns3/log.h"
+#include "ns3/nstime.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
 #include "ns3/simulator.h"
 
 namespace ns3
@@ -59,6 +63,32 @@ LoraRadioEnergyModel::GetTypeId()
                           PointerValue(),
                           MakePointerAccessor(&LoraRadioEnergyModel::m_txCurrentModel),
                           MakePointerChecker<LoraTxCurrentModel>())
+            .AddAttribute("LazyAccounting",
+                          "Whether to defer energy total updates and energy source "
+                          "notifications to reads and periodic flushes instead of "
+                          "performing them on every radio state transition.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&LoraRadioEnergyModel::m_lazyAccounting),
+                          MakeBooleanChecker())
+            .AddAttribute("TraceEnergyDeltaJ",
+                          "Minimum accumulated energy in Joules between firings of the "
+                          "TotalEnergyConsumption trace; zero fires on every update.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&LoraRadioEnergyModel::m_traceEnergyDeltaJ),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("TraceEveryNUpdates",
+                          "Fire the TotalEnergyConsumption trace only every Nth energy "
+                          "update; one fires on every update.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&LoraRadioEnergyModel::m_traceEveryNUpdates),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("SourceUpdateInterval",
+                          "Minimum spacing between energy source notifications in lazy "
+                          "accounting mode; zero notifies only on explicit flushes and "
+                          "at disposal.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&LoraRadioEnergyModel::m_sourceUpdateInterval),
+                          MakeTimeChecker())
             .AddTraceSource(
                 "TotalEnergyConsumption",
                 "Total energy consumption of the radio device.",
@@ -72,6 +102,10 @@ LoraRadioEnergyModel::LoraRadioEnergyModel()
     NS_LOG_FUNCTION(this);
     m_currentState = EndDeviceLoraPhy::SLEEP; // initially STANDBY
     m_lastUpdateTime = Seconds(0.0);
+    m_pendingEnergyJ = 0.0;
+    m_stateEnergyJ[0] = m_stateEnergyJ[1] = m_stateEnergyJ[2] = m_stateEnergyJ[3] = 0.0;
+    m_updatesSinceTrace = 0;
+    m_lastSourceUpdate = Seconds(0.0);
     m_nPendingChangeState = 0;
     m_isSupersededChangeState = false;
     m_energyDepletionCallback.Nullify();
@@ -102,7 +136,51 @@ double
 LoraRadioEnergyModel::GetTotalEnergyConsumption() const
 {
     NS_LOG_FUNCTION(this);
-    return m_totalEnergyConsumption;
+
+    if (m_lazyAccounting)
+    {
+        // Integrate on demand: the deferred closed intervals plus the
+        // interval currently in progress
+        return m_totalEnergyConsumption + m_pendingEnergyJ +
+               ComputeStateEnergy(Now() - m_lastUpdateTime);
+    }
+
+    // m_pendingEnergyJ holds what trace decimation has not folded yet
+    return m_totalEnergyConsumption + m_pendingEnergyJ;
+}
+
+double
+LoraRadioEnergyModel::GetStateEnergyConsumption(EndDeviceLoraPhy::State state) const
+{
+    NS_LOG_FUNCTION(this << state);
+
+    double energy = m_stateEnergyJ[state];
+    if (state == m_currentState)
+    {
+        energy += ComputeStateEnergy(Now() - m_lastUpdateTime);
+    }
+    return energy;
+}
+
+void
+LoraRadioEnergyModel::FlushEnergy()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_pendingEnergyJ > 0)
+    {
+        // A single traced-value update covers all deferred transitions
+        m_totalEnergyConsumption += m_pendingEnergyJ;
+        m_pendingEnergyJ = 0;
+        m_updatesSinceTrace = 0;
+    }
+
+    m_lastSourceUpdate = Now();
+
+    if (m_source)
+    {
+        m_source->UpdateEnergySource();
+    }
 }
 
 double
@@ -201,7 +279,9 @@ LoraRadioEnergyModel::SetTxCurrentFromModel(double txPowerDbm)
 {
     if (m_txCurrentModel)
     {
-        m_txCurrentA = m_txCurrentModel->CalcTxCurrent(txPowerDbm);
+        // Memoized over the discrete LoRaWAN power grid: no per-packet
+        // dBm-to-Watt conversion
+        m_txCurrentA = m_txCurrentModel->GetTxCurrentForPower(txPowerDbm);
     }
 }
 
@@ -214,36 +294,46 @@ LoraRadioEnergyModel::ChangeState(int newState)
     NS_ASSERT(duration.IsPositive()); // check if duration is valid
 
     // energy to decrease = current * voltage * time
-    double energyToDecrease = 0.0;
-    double supplyVoltage = m_source->GetSupplyVoltage();
-    switch (m_currentState)
+    double energyToDecrease = ComputeStateEnergy(duration);
+
+    // keep the per-state breakdown in both modes
+    m_stateEnergyJ[m_currentState] += energyToDecrease;
+
+    // update total energy consumption; in lazy mode the closed interval is
+    // only recorded, and folded into the traced total at the next flush
+    m_pendingEnergyJ += energyToDecrease;
+    if (!m_lazyAccounting)
     {
-    case EndDeviceLoraPhy::STANDBY:
-        energyToDecrease = duration.GetSeconds() * m_idleCurrentA * supplyVoltage;
-        break;
-    case EndDeviceLoraPhy::TX:
-        energyToDecrease = duration.GetSeconds() * m_txCurrentA * supplyVoltage;
-        break;
-    case EndDeviceLoraPhy::RX:
-        energyToDecrease = duration.GetSeconds() * m_rxCurrentA * supplyVoltage;
-        break;
-    case EndDeviceLoraPhy::SLEEP:
-        energyToDecrease = duration.GetSeconds() * m_sleepCurrentA * supplyVoltage;
-        break;
-    default:
-        NS_FATAL_ERROR("LoraRadioEnergyModel:Undefined radio state: " << m_currentState);
+        // Decimation: the trace only fires on every Nth update or once
+        // enough energy accumulated, whichever policy is configured. With
+        // the default settings it fires on every update as it always has
+        m_updatesSinceTrace++;
+        if ((m_traceEnergyDeltaJ == 0 && m_traceEveryNUpdates == 1) ||
+            (m_traceEnergyDeltaJ > 0 && m_pendingEnergyJ >= m_traceEnergyDeltaJ) ||
+            (m_traceEveryNUpdates > 1 && m_updatesSinceTrace >= m_traceEveryNUpdates))
+        {
+            m_totalEnergyConsumption += m_pendingEnergyJ;
+            m_pendingEnergyJ = 0;
+            m_updatesSinceTrace = 0;
+        }
     }
 
-    // update total energy consumption
-    m_totalEnergyConsumption += energyToDecrease;
-
     // update last update time stamp
     m_lastUpdateTime = Now();
 
     m_nPendingChangeState++;
 
-    // notify energy source
-    m_source->UpdateEnergySource();
+    // notify energy source; in lazy mode notifications are batched on the
+    // SourceUpdateInterval grid instead of being issued per transition
+    if (!m_lazyAccounting)
+    {
+        m_source->UpdateEnergySource();
+    }
+    else if (m_sourceUpdateInterval.IsStrictlyPositive() &&
+             Now() - m_lastSourceUpdate >= m_sourceUpdateInterval)
+    {
+        FlushEnergy();
+    }
 
     // in case the energy source is found to be depleted during the last update, a callback might be
     // invoked that might cause a change in the Lora PHY state (e.g., the PHY is put into SLEEP
@@ -313,6 +403,12 @@ void
 LoraRadioEnergyModel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    if (m_lazyAccounting || m_pendingEnergyJ > 0)
+    {
+        // Make sure energy deferred by lazy accounting or trace decimation
+        // reaches the traced total and the source
+        FlushEnergy();
+    }
     m_source = nullptr;
     m_energyDepletionCallback.Nullify();
 }
@@ -336,6 +432,25 @@ LoraRadioEnergyModel::DoGetCurrentA() const
     }
 }
 
+double
+LoraRadioEnergyModel::ComputeStateEnergy(Time duration) const
+{
+    double supplyVoltage = m_source ? m_source->GetSupplyVoltage() : 0.0;
+    switch (m_currentState)
+    {
+    case EndDeviceLoraPhy::STANDBY:
+        return duration.GetSeconds() * m_idleCurrentA * supplyVoltage;
+    case EndDeviceLoraPhy::TX:
+        return duration.GetSeconds() * m_txCurrentA * supplyVoltage;
+    case EndDeviceLoraPhy::RX:
+        return duration.GetSeconds() * m_rxCurrentA * supplyVoltage;
+    case EndDeviceLoraPhy::SLEEP:
+        return duration.GetSeconds() * m_sleepCurrentA * supplyVoltage;
+    default:
+        NS_FATAL_ERROR("LoraRadioEnergyModel:Undefined radio state: " << m_currentState);
+    }
+}
+
 void
 LoraRadioEnergyModel::SetLoraRadioState(const EndDeviceLoraPhy::State state)
 {
@@ -153,10 +153,32 @@ class LoraRadioEnergyModel : public DeviceEnergyModel
     /**
      * @return Total energy consumption of the wifi device.
      *
+     * In lazy accounting mode this integrates the deferred and in-progress
+     * state intervals on demand, so reads are always up to date even though
+     * transitions no longer update the total.
+     *
      * Implements DeviceEnergyModel::GetTotalEnergyConsumption.
      */
     double GetTotalEnergyConsumption() const override;
 
+    /**
+     * Get the energy consumed while in one radio state, including the
+     * interval currently in progress when the radio is in that state.
+     *
+     * @param state The radio state of interest.
+     * @return The consumed energy in Joules.
+     */
+    double GetStateEnergyConsumption(EndDeviceLoraPhy::State state) const;
+
+    /**
+     * Fold the energy deferred by lazy accounting into the traced total and
+     * notify the energy source once.
+     *
+     * Called automatically every SourceUpdateInterval (when set) and at
+     * disposal; call it manually before reading traced totals mid-run.
+     */
+    void FlushEnergy();
+
     // Setter & getters for state power consumption.
     /**
      * Gets idle current.
@@ -294,6 +316,15 @@ class LoraRadioEnergyModel : public DeviceEnergyModel
      */
     void SetLoraRadioState(const EndDeviceLoraPhy::State state);
 
+    /**
+     * Compute the energy consumed by staying in the current state for a
+     * duration, at the current supply voltage.
+     *
+     * @param duration The time spent in the current state.
+     * @return The consumed energy in Joules.
+     */
+    double ComputeStateEnergy(Time duration) const;
+
     Ptr<EnergySource> m_source; ///< energy source
 
     // Member variables for current draw in different radio modes.
@@ -311,6 +342,44 @@ class LoraRadioEnergyModel : public DeviceEnergyModel
     EndDeviceLoraPhy::State m_currentState; ///< current state the radio is in
     Time m_lastUpdateTime;                  ///< time stamp of previous energy update
 
+    /**
+     * Whether to defer total updates and energy source notifications to
+     * reads and periodic flushes instead of performing them on every state
+     * transition. Off by default: transitions then behave exactly as they
+     * always have. With many devices the per-transition source updates are
+     * pure overhead when totals are only read at report intervals.
+     */
+    bool m_lazyAccounting;
+
+    double m_pendingEnergyJ; ///< energy integrated but not yet folded into the traced total
+
+    double m_stateEnergyJ[4]; ///< energy breakdown per radio state, indexed by the state enum
+
+    /**
+     * Trace decimation by energy: the TotalEnergyConsumption trace only
+     * fires once at least this much energy has accumulated since the last
+     * firing. Zero (the default) leaves the trace firing on every update.
+     */
+    double m_traceEnergyDeltaJ;
+
+    /**
+     * Trace decimation by count: the TotalEnergyConsumption trace only
+     * fires every Nth update. One (the default) leaves the trace firing on
+     * every update. When both decimation policies are set, crossing either
+     * threshold fires the trace.
+     */
+    uint32_t m_traceEveryNUpdates;
+
+    uint32_t m_updatesSinceTrace; ///< updates accumulated since the trace last fired
+
+    /**
+     * Minimum spacing between energy source notifications in lazy mode;
+     * zero notifies only on explicit flushes and at disposal.
+     */
+    Time m_sourceUpdateInterval;
+
+    Time m_lastSourceUpdate; ///< time stamp of previous energy source notification
+
     uint8_t m_nPendingChangeState;  ///< pending state change
     bool m_isSupersededChangeState; ///< superseded change state
 
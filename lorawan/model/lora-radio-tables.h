@@ -0,0 +1,72 @@
+// model/lora-radio-tables.h
+
+#ifndef LORA_RADIO_TABLES_H
+#define LORA_RADIO_TABLES_H
+
+#include <array>
+#include <cstdint>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @defgroup lora-radio-tables LoRa radio constant tables
+ * @ingroup lorawan
+ *
+ * The module-wide source of truth for the per-SF radio limits that both
+ * the PHY models and the ADR components depend on. Keeping them in one
+ * constexpr header means threshold checks compile to indexed loads and
+ * the PHY and ADR logic can never drift apart.
+ *
+ * All tables are indexed by spreading factor minus 7, i.e. index 0 is
+ * SF7 and index 5 is SF12.
+ *
+ * @{
+ */
+
+/// End device downlink sensitivity per SF [dBm] (source: SX1272 datasheet).
+inline constexpr std::array<double, 6> END_DEVICE_SENSITIVITY_DBM =
+    {-124, -127, -130, -133, -135, -137};
+
+/// Gateway uplink sensitivity per SF [dBm] (source: SX1301 datasheet).
+inline constexpr std::array<double, 6> GATEWAY_SENSITIVITY_DBM =
+    {-130.0, -132.5, -135.0, -137.5, -140.0, -142.5};
+
+/// Demodulation SNR threshold per SF [dB].
+inline constexpr std::array<double, 6> SNR_THRESHOLD_DB =
+    {-7.5, -10.0, -12.5, -15.0, -17.5, -20.0};
+
+/**
+ * Get the demodulation SNR threshold for a spreading factor.
+ *
+ * @param sf The spreading factor, in [7, 12].
+ * @return The required SNR [dB].
+ */
+constexpr double
+SnrThresholdForSf(uint8_t sf)
+{
+    return SNR_THRESHOLD_DB[sf - 7];
+}
+
+/**
+ * Get the demodulation SNR threshold for a data rate.
+ *
+ * Uses the EU868 mapping DR0 -> SF12 ... DR5 -> SF7.
+ *
+ * @param dataRate The data rate, in [0, 5].
+ * @return The required SNR [dB].
+ */
+constexpr double
+SnrThresholdForDr(uint8_t dataRate)
+{
+    return SNR_THRESHOLD_DB[5 - dataRate];
+}
+
+/** @} */
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif /* LORA_RADIO_TABLES_H */
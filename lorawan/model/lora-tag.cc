@@ -33,11 +33,7 @@ LoraTag::GetInstanceTypeId() const
 }
 
 LoraTag::LoraTag(uint8_t sf, uint8_t destroyedBy)
-    : m_sf(sf),
-      m_destroyedBy(destroyedBy),
-      m_receivePower(0),
-      m_dataRate(0),
-      m_frequencyHz(0)
+    : m_fields{sf, destroyedBy, 0, 0, 0, 0, 0xFFFFFFFF, 0}
 {
 }
 
@@ -48,95 +44,99 @@ LoraTag::~LoraTag()
 uint32_t
 LoraTag::GetSerializedSize() const
 {
-    // Each datum about a spreading factor is 1 byte + receivePower (the size of a double) +
-    // frequency (4 bytes)
-    return 3 + sizeof(double) + 4;
+    // All fields packed into one trivially-copyable block
+    return sizeof(Fields);
 }
 
 void
 LoraTag::Serialize(TagBuffer i) const
 {
-    i.WriteU8(m_sf);
-    i.WriteU8(m_destroyedBy);
-    i.WriteDouble(m_receivePower);
-    i.WriteU8(m_dataRate);
-    i.WriteU32(m_frequencyHz);
+    i.Write(reinterpret_cast<const uint8_t*>(&m_fields), sizeof(Fields));
 }
 
 void
 LoraTag::Deserialize(TagBuffer i)
 {
-    m_sf = i.ReadU8();
-    m_destroyedBy = i.ReadU8();
-    m_receivePower = i.ReadDouble();
-    m_dataRate = i.ReadU8();
-    m_frequencyHz = i.ReadU32();
+    i.Read(reinterpret_cast<uint8_t*>(&m_fields), sizeof(Fields));
 }
 
 void
 LoraTag::Print(std::ostream& os) const
 {
-    os << m_sf << " " << m_destroyedBy << " " << m_receivePower << " " << m_dataRate;
+    os << unsigned(m_fields.sf) << " " << unsigned(m_fields.destroyedBy) << " "
+       << m_fields.receivePower << " " << unsigned(m_fields.dataRate);
 }
 
 uint8_t
 LoraTag::GetSpreadingFactor() const
 {
-    return m_sf;
+    return m_fields.sf;
 }
 
 uint8_t
 LoraTag::GetDestroyedBy() const
 {
-    return m_destroyedBy;
+    return m_fields.destroyedBy;
 }
 
 double
 LoraTag::GetReceivePower() const
 {
-    return m_receivePower;
+    return m_fields.receivePower;
 }
 
 void
 LoraTag::SetDestroyedBy(uint8_t sf)
 {
-    m_destroyedBy = sf;
+    m_fields.destroyedBy = sf;
 }
 
 void
 LoraTag::SetSpreadingFactor(uint8_t sf)
 {
-    m_sf = sf;
+    m_fields.sf = sf;
 }
 
 void
 LoraTag::SetReceivePower(double receivePower)
 {
-    m_receivePower = receivePower;
+    m_fields.receivePower = receivePower;
 }
 
 void
 LoraTag::SetFrequency(uint32_t frequencyHz)
 {
-    m_frequencyHz = frequencyHz;
+    m_fields.frequencyHz = frequencyHz;
 }
 
 uint32_t
 LoraTag::GetFrequency() const
 {
-    return m_frequencyHz;
+    return m_fields.frequencyHz;
 }
 
 uint8_t
 LoraTag::GetDataRate() const
 {
-    return m_dataRate;
+    return m_fields.dataRate;
 }
 
 void
 LoraTag::SetDataRate(uint8_t dataRate)
 {
-    m_dataRate = dataRate;
+    m_fields.dataRate = dataRate;
+}
+
+uint32_t
+LoraTag::GetDeviceIndex() const
+{
+    return m_fields.deviceIndex;
+}
+
+void
+LoraTag::SetDeviceIndex(uint32_t deviceIndex)
+{
+    m_fields.deviceIndex = deviceIndex;
 }
 
 } // namespace lorawan
@@ -11,6 +11,9 @@
 
 #include "ns3/tag.h"
 
+#include <cstring>
+#include <type_traits>
+
 namespace ns3
 {
 namespace lorawan
@@ -129,12 +132,47 @@ class LoraTag : public Tag
      */
     void SetDataRate(uint8_t dataRate);
 
+    /**
+     * Get the sender's dense device index, see DeviceRegistry.
+     *
+     * @return The index, or DeviceRegistry::INVALID_INDEX when the sender
+     * is not a registered end device (e.g. a downlink).
+     */
+    uint32_t GetDeviceIndex() const;
+
+    /**
+     * Set the sender's dense device index, see DeviceRegistry.
+     *
+     * @param deviceIndex The index.
+     */
+    void SetDeviceIndex(uint32_t deviceIndex);
+
   private:
-    uint8_t m_sf;           //!< The Spreading Factor used by the packet.
-    uint8_t m_destroyedBy;  //!< The Spreading Factor that destroyed the packet.
-    double m_receivePower;  //!< The reception power of this packet.
-    uint8_t m_dataRate;     //!< The data rate that needs to be used to send this packet.
-    uint32_t m_frequencyHz; //!< The frequency [Hz] of this packet
+    /**
+     * All tag data packed into a single 16-byte trivially-copyable block.
+     *
+     * The tag travels with every packet along the PHY -> MAC -> server path
+     * and is serialized into a TagBuffer at each copy, so a fixed layout lets
+     * Serialize and Deserialize be a single memcpy instead of five field-wise
+     * writes and reads.
+     */
+    struct Fields
+    {
+        uint8_t sf;           //!< The Spreading Factor used by the packet.
+        uint8_t destroyedBy;  //!< The Spreading Factor that destroyed the packet.
+        uint8_t dataRate;     //!< The data rate that needs to be used to send this packet.
+        uint8_t pad;          //!< Explicit padding, keeps the block fully initialized.
+        uint32_t frequencyHz; //!< The frequency [Hz] of this packet.
+        double receivePower;  //!< The reception power of this packet.
+        uint32_t deviceIndex; //!< The sender's dense device index, see DeviceRegistry.
+        uint32_t pad2;        //!< Explicit padding, keeps the block fully initialized.
+    };
+
+    static_assert(sizeof(Fields) == 24, "LoraTag fields expected to pack into 192 bits");
+    static_assert(std::is_trivially_copyable_v<Fields>,
+                  "LoraTag fields must support raw memcpy (de)serialization");
+
+    Fields m_fields; //!< The packed tag data.
 };
 } // namespace lorawan
 } // namespace ns3
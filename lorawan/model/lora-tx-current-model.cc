@@ -13,6 +13,8 @@
 #include "ns3/double.h"
 #include "ns3/log.h"
 
+#include <cmath>
+
 namespace ns3
 {
 namespace lorawan
@@ -31,12 +33,38 @@ LoraTxCurrentModel::GetTypeId()
 
 LoraTxCurrentModel::LoraTxCurrentModel()
 {
+    m_txCurrentLutValid.fill(false);
 }
 
 LoraTxCurrentModel::~LoraTxCurrentModel()
 {
 }
 
+double
+LoraTxCurrentModel::GetTxCurrentForPower(double txPowerDbm) const
+{
+    double steps = (txPowerDbm - LUT_MIN_DBM) * 2;
+    auto index = static_cast<int64_t>(std::lround(steps));
+    if (index < 0 || index >= LUT_ENTRIES || std::abs(steps - index) > 1e-9)
+    {
+        // Off the half-dB grid: no memoization
+        return CalcTxCurrent(txPowerDbm);
+    }
+
+    if (!m_txCurrentLutValid[index])
+    {
+        m_txCurrentLut[index] = CalcTxCurrent(txPowerDbm);
+        m_txCurrentLutValid[index] = true;
+    }
+    return m_txCurrentLut[index];
+}
+
+void
+LoraTxCurrentModel::InvalidateTxCurrentLut()
+{
+    m_txCurrentLutValid.fill(false);
+}
+
 // Similarly to the wifi case
 NS_OBJECT_ENSURE_REGISTERED(LinearLoraTxCurrentModel);
 
@@ -84,6 +112,7 @@ LinearLoraTxCurrentModel::SetEta(double eta)
 {
     NS_LOG_FUNCTION(this << eta);
     m_eta = eta;
+    InvalidateTxCurrentLut();
 }
 
 void
@@ -91,6 +120,7 @@ LinearLoraTxCurrentModel::SetVoltage(double voltage)
 {
     NS_LOG_FUNCTION(this << voltage);
     m_voltage = voltage;
+    InvalidateTxCurrentLut();
 }
 
 void
@@ -98,6 +128,7 @@ LinearLoraTxCurrentModel::SetStandbyCurrent(double idleCurrent)
 {
     NS_LOG_FUNCTION(this << idleCurrent);
     m_idleCurrent = idleCurrent;
+    InvalidateTxCurrentLut();
 }
 
 double
@@ -122,7 +153,8 @@ double
 LinearLoraTxCurrentModel::CalcTxCurrent(double txPowerDbm) const
 {
     NS_LOG_FUNCTION(this << txPowerDbm);
-    return DbmToW(txPowerDbm) / (m_voltage * m_eta) + m_idleCurrent;
+    // Quantized conversion: TX power settings are far coarser than 0.1 dB
+    return DbmToWQuantized(txPowerDbm) / (m_voltage * m_eta) + m_idleCurrent;
 }
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantLoraTxCurrentModel);
@@ -159,6 +191,7 @@ ConstantLoraTxCurrentModel::SetTxCurrent(double txCurrent)
 {
     NS_LOG_FUNCTION(this << txCurrent);
     m_txCurrent = txCurrent;
+    InvalidateTxCurrentLut();
 }
 
 double
@@ -12,6 +12,8 @@
 
 #include "ns3/object.h"
 
+#include <array>
+
 namespace ns3
 {
 namespace lorawan
@@ -42,6 +44,37 @@ class LoraTxCurrentModel : public Object
      * @return The transmit current (in Ampere).
      */
     virtual double CalcTxCurrent(double txPowerDbm) const = 0;
+
+    /**
+     * Get the current for transmission at this power, served from a lookup
+     * table when possible.
+     *
+     * LoRaWAN tx powers are a small discrete set on a half-dB grid, so the
+     * dBm-to-Watt conversion inside CalcTxCurrent is computed once per
+     * distinct power and then memoized. Powers off the grid fall back to
+     * CalcTxCurrent. This is the accessor the energy path should use.
+     *
+     * @param txPowerDbm The nominal tx power in dBm.
+     * @return The transmit current (in Ampere).
+     */
+    double GetTxCurrentForPower(double txPowerDbm) const;
+
+  protected:
+    /**
+     * Drop all memoized currents. Parameter setters of subclasses must call
+     * this so cached entries never outlive the parameters they were
+     * computed from.
+     */
+    void InvalidateTxCurrentLut();
+
+  private:
+    static constexpr double LUT_MIN_DBM = -30;  //!< Lowest power on the memoized grid.
+    static constexpr uint32_t LUT_ENTRIES = 121; //!< Grid entries, half-dB steps up to +30 dBm.
+
+    /// Memoized currents per grid entry, filled on first use (CalcTxCurrent
+    /// is virtual, so the table cannot be built in this constructor).
+    mutable std::array<double, LUT_ENTRIES> m_txCurrentLut;
+    mutable std::array<bool, LUT_ENTRIES> m_txCurrentLutValid; //!< Which entries are filled.
 };
 
 /**
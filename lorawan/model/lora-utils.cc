@@ -8,38 +8,19 @@
 
 #include "lora-utils.h"
 
-#include <cmath>
-
 namespace ns3
 {
 namespace lorawan
 {
 
-double
-DbToRatio(double dB)
-{
-    double ratio = std::pow(10.0, dB / 10.0);
-    return ratio;
-}
-
-double
-DbmToW(double dBm)
-{
-    double mW = std::pow(10.0, dBm / 10.0);
-    return mW / 1000.0;
-}
-
-double
-WToDbm(double w)
-{
-    return 10.0 * std::log10(w * 1000.0);
-}
-
-double
-RatioToDb(double ratio)
-{
-    return 10.0 * std::log10(ratio);
-}
+const std::array<double, QUANTIZED_DB_STEPS> QUANTIZED_DB_TO_RATIO = [] {
+    std::array<double, QUANTIZED_DB_STEPS> table{};
+    for (std::size_t i = 0; i < QUANTIZED_DB_STEPS; i++)
+    {
+        table[i] = std::pow(10.0, (QUANTIZED_DB_MIN + 0.1 * i) / 10.0);
+    }
+    return table;
+}();
 
 } // namespace lorawan
 } // namespace ns3
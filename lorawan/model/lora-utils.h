@@ -12,6 +12,10 @@
 #include "ns3/nstime.h"
 #include "ns3/uinteger.h"
 
+#include <array>
+#include <cmath>
+#include <cstddef>
+
 namespace ns3
 {
 namespace lorawan
@@ -24,7 +28,12 @@ namespace lorawan
  *
  * @return The equivalent Watts for the given dBm value.
  */
-double DbmToW(double dbm);
+inline double
+DbmToW(double dbm)
+{
+    return std::pow(10.0, dbm / 10.0) / 1000.0;
+}
+
 /**
  * Convert from dB to ratio.
  *
@@ -32,7 +41,12 @@ double DbmToW(double dbm);
  *
  * @return The equivalent ratio from the given dB value.
  */
-double DbToRatio(double db);
+inline double
+DbToRatio(double db)
+{
+    return std::pow(10.0, db / 10.0);
+}
+
 /**
  * Convert from Watts to dBm.
  *
@@ -40,7 +54,12 @@ double DbToRatio(double db);
  *
  * @return The equivalent dBm for the given Watts.
  */
-double WToDbm(double w);
+inline double
+WToDbm(double w)
+{
+    return 10.0 * std::log10(w * 1000.0);
+}
+
 /**
  * Convert from ratio to dB.
  *
@@ -48,7 +67,68 @@ double WToDbm(double w);
  *
  * @return The equivalent dB from the given ratio value.
  */
-double RatioToDb(double ratio);
+inline double
+RatioToDb(double ratio)
+{
+    return 10.0 * std::log10(ratio);
+}
+
+/**
+ * @{
+ * @name Quantized dB/linear conversions
+ *
+ * Table-driven variants of DbToRatio and DbmToW for hot paths (interference
+ * bookkeeping, energy accounting) where exactness below the 0.1 dB
+ * quantization step is irrelevant. Inputs are rounded to the nearest 0.1 dB
+ * over [-200, +30] dB(m); values outside that range fall back to the exact
+ * computation.
+ */
+
+/// Lowest dB value covered by the quantized conversion table.
+constexpr double QUANTIZED_DB_MIN = -200.0;
+/// Highest dB value covered by the quantized conversion table.
+constexpr double QUANTIZED_DB_MAX = 30.0;
+/// Number of 0.1 dB steps in the quantized conversion table.
+constexpr std::size_t QUANTIZED_DB_STEPS = 2301;
+
+/**
+ * The 10^(x/10) table at 0.1 dB steps backing the quantized conversions,
+ * filled once at program start.
+ */
+extern const std::array<double, QUANTIZED_DB_STEPS> QUANTIZED_DB_TO_RATIO;
+
+/**
+ * Convert from dB to ratio, quantized to 0.1 dB steps.
+ *
+ * @param db The dB value.
+ *
+ * @return The ratio for the input rounded to the nearest 0.1 dB.
+ */
+inline double
+DbToRatioQuantized(double db)
+{
+    if (db < QUANTIZED_DB_MIN || db > QUANTIZED_DB_MAX)
+    {
+        return DbToRatio(db);
+    }
+    auto i = static_cast<std::size_t>((db - QUANTIZED_DB_MIN) * 10.0 + 0.5);
+    return QUANTIZED_DB_TO_RATIO[i];
+}
+
+/**
+ * Convert from dBm to Watts, quantized to 0.1 dBm steps.
+ *
+ * @param dbm The power in dBm.
+ *
+ * @return The power in Watts for the input rounded to the nearest 0.1 dBm.
+ */
+inline double
+DbmToWQuantized(double dbm)
+{
+    return DbToRatioQuantized(dbm) / 1000.0;
+}
+
+/** @} */
 
 } // namespace lorawan
 
@@ -55,16 +55,8 @@ LorawanMacHeader::Serialize(Buffer::Iterator start) const
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    // The header we need to fill
-    uint8_t header = 0;
-
-    // The MType
-    header |= m_mtype << 5;
-
-    // Do nothing for the bits that are RFU
-
-    // The major version bits
-    header |= m_major;
+    // Pack MType and Major in one byte; the RFU bits stay zero
+    uint8_t header = EncodeMhdr(m_mtype, m_major);
 
     // Write the byte
     start.WriteU8(header);
@@ -81,16 +73,21 @@ LorawanMacHeader::Deserialize(Buffer::Iterator start)
     uint8_t byte;
     byte = start.ReadU8();
 
-    // Get the 2 least significant bits to have the Major
-    m_major = byte & 0b11;
-
-    // Move the three most significant bits to the least significant positions
-    // to get the MType
-    m_mtype = byte >> 5;
+    m_major = DecodeMajor(byte);
+    m_mtype = DecodeMType(byte);
 
     return 1; // the number of bytes consumed.
 }
 
+uint8_t
+LorawanMacHeader::PeekMType(Ptr<const Packet> packet)
+{
+    uint8_t mhdr;
+    uint32_t read = packet->CopyData(&mhdr, 1);
+    NS_ASSERT_MSG(read == 1, "Packet too short to hold the MAC header");
+    return DecodeMType(mhdr);
+}
+
 void
 LorawanMacHeader::Print(std::ostream& os) const
 {
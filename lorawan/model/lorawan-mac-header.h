@@ -10,6 +10,7 @@
 #define LORAWAN_MAC_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/packet.h"
 
 namespace ns3
 {
@@ -107,6 +108,55 @@ class LorawanMacHeader : public Header
      */
     uint8_t GetMajor() const;
 
+    /**
+     * Pack a message type and major version into the single MHDR byte.
+     *
+     * The header is one byte by specification, so the whole codec is a pair
+     * of shifts that the compiler can fold into surrounding code.
+     *
+     * @param mtype The message type value.
+     * @param major The major version value.
+     * @return The MHDR byte.
+     */
+    static constexpr uint8_t EncodeMhdr(uint8_t mtype, uint8_t major)
+    {
+        return uint8_t(mtype << 5) | (major & 0b11);
+    }
+
+    /**
+     * Extract the message type from an MHDR byte.
+     *
+     * @param mhdr The MHDR byte.
+     * @return The message type value.
+     */
+    static constexpr uint8_t DecodeMType(uint8_t mhdr)
+    {
+        return mhdr >> 5;
+    }
+
+    /**
+     * Extract the major version from an MHDR byte.
+     *
+     * @param mhdr The MHDR byte.
+     * @return The major version value.
+     */
+    static constexpr uint8_t DecodeMajor(uint8_t mhdr)
+    {
+        return mhdr & 0b11;
+    }
+
+    /**
+     * Read the message type of a complete LoRaWAN packet in place.
+     *
+     * Like LoraFrameHeader::PeekFields, this avoids copying the packet or
+     * deserializing its headers into objects; server-side receive paths that
+     * only branch on confirmed vs unconfirmed traffic need nothing more.
+     *
+     * @param packet The packet, with the MAC header still in place.
+     * @return The message type value.
+     */
+    static uint8_t PeekMType(Ptr<const Packet> packet);
+
     /**
      * Check whether this header is for an uplink message.
      *
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Inline helpers to estimate the heap footprint of the standard containers
+ * held by the module's long-lived state owners.
+ *
+ * The estimates are deliberately simple: element count times stored type
+ * size, plus a fixed per-node overhead for node-based containers. They are
+ * meant for attributing memory between subsystems during a run, not for
+ * exact accounting — allocator padding and small-object optimizations are
+ * ignored.
+ */
+
+/**
+ * Per-node bookkeeping of node-based containers (tree/list pointers, color
+ * bit, allocator rounding), counted once per element.
+ */
+constexpr uint64_t MEMORY_NODE_OVERHEAD = 32;
+
+/**
+ * Estimate the heap bytes of a map, counting stored pairs and node
+ * overhead but not memory owned through the values.
+ *
+ * @param map The map to estimate.
+ * @return The estimated heap bytes.
+ */
+template <typename K, typename V, typename C>
+uint64_t
+EstimateMemory(const std::map<K, V, C>& map)
+{
+    return map.size() * (sizeof(std::pair<const K, V>) + MEMORY_NODE_OVERHEAD);
+}
+
+/**
+ * Estimate the heap bytes of an unordered map, counting stored pairs, node
+ * overhead and the bucket array, but not memory owned through the values.
+ *
+ * @param map The map to estimate.
+ * @return The estimated heap bytes.
+ */
+template <typename K, typename V, typename H, typename E>
+uint64_t
+EstimateMemory(const std::unordered_map<K, V, H, E>& map)
+{
+    return map.size() * (sizeof(std::pair<const K, V>) + MEMORY_NODE_OVERHEAD) +
+           map.bucket_count() * sizeof(void*);
+}
+
+/**
+ * Estimate the heap bytes of a set.
+ *
+ * @param set The set to estimate.
+ * @return The estimated heap bytes.
+ */
+template <typename T, typename C>
+uint64_t
+EstimateMemory(const std::set<T, C>& set)
+{
+    return set.size() * (sizeof(T) + MEMORY_NODE_OVERHEAD);
+}
+
+/**
+ * Estimate the heap bytes of a vector, counting the full capacity since
+ * that is what is actually allocated.
+ *
+ * @param vector The vector to estimate.
+ * @return The estimated heap bytes.
+ */
+template <typename T>
+uint64_t
+EstimateMemory(const std::vector<T>& vector)
+{
+    return vector.capacity() * sizeof(T);
+}
+
+/**
+ * Estimate the heap bytes of a deque.
+ *
+ * @param deque The deque to estimate.
+ * @return The estimated heap bytes.
+ */
+template <typename T>
+uint64_t
+EstimateMemory(const std::deque<T>& deque)
+{
+    return deque.size() * sizeof(T);
+}
+
+/**
+ * Estimate the heap bytes of a list.
+ *
+ * @param list The list to estimate.
+ * @return The estimated heap bytes.
+ */
+template <typename T>
+uint64_t
+EstimateMemory(const std::list<T>& list)
+{
+    return list.size() * (sizeof(T) + MEMORY_NODE_OVERHEAD);
+}
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* MEMORY_REPORT_H */
@@ -33,6 +33,12 @@ NetworkControllerComponent::~NetworkControllerComponent()
 {
 }
 
+uint8_t
+NetworkControllerComponent::GetUplinkInterest() const
+{
+    return ALL_UPLINKS;
+}
+
 ////////////////////////////////
 // ConfirmedMessagesComponent //
 ////////////////////////////////
@@ -61,27 +67,17 @@ ConfirmedMessagesComponent::OnReceivedPacket(Ptr<const Packet> packet,
 {
     NS_LOG_FUNCTION(this->GetTypeId() << packet << networkStatus);
 
-    // Check whether the received packet requires an acknowledgment.
-    LorawanMacHeader mHdr;
-    LoraFrameHeader fHdr;
-    fHdr.SetAsUplink();
-    Ptr<Packet> myPacket = packet->Copy();
-    myPacket->RemoveHeader(mHdr);
-    myPacket->RemoveHeader(fHdr);
-
-    NS_LOG_INFO("Received packet Mac Header: " << mHdr);
-    NS_LOG_INFO("Received packet Frame Header: " << fHdr);
-
-    if (mHdr.GetMType() == LorawanMacHeader::CONFIRMED_DATA_UP)
+    // Check whether the received packet requires an acknowledgment. Most
+    // traffic is unconfirmed, so branch on a one-byte peek instead of
+    // copying the packet and deserializing both headers
+    if (LorawanMacHeader::PeekMType(packet) == LorawanMacHeader::CONFIRMED_DATA_UP)
     {
         NS_LOG_INFO("Packet requires confirmation");
 
-        // Set up the ACK bit on the reply
-        status->m_reply.frameHeader.SetAsDownlink();
-        status->m_reply.frameHeader.SetAck(true);
-        status->m_reply.frameHeader.SetAddress(fHdr.GetAddress());
-        status->m_reply.macHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
-        status->m_reply.needsReply = true;
+        // Arm the ACK from the skeleton cached on the device status, which
+        // also marks the device as a confirmed-traffic sender and saves the
+        // second peek into the packet for the address
+        status->PrimeAckReply();
 
         // Note that the acknowledgment procedure dies here: "Acknowledgments
         // are only snt in response to the latest message received and are never
@@ -109,6 +105,13 @@ ConfirmedMessagesComponent::OnFailedReply(Ptr<EndDeviceStatus> status,
 
     // Empty the Ack bit.
     status->m_reply.frameHeader.SetAck(false);
+    status->MarkReplyDirty();
+}
+
+uint8_t
+ConfirmedMessagesComponent::GetUplinkInterest() const
+{
+    return CONFIRMED_DATA_UPLINKS;
 }
 
 ////////////////////////
@@ -163,7 +166,7 @@ LinkCheckComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status,
     {
         status->m_reply.needsReply = true;
 
-        auto info = status->GetLastReceivedPacketInfo();
+        const auto& info = status->GetLastReceivedPacketInfo();
 
         // Adapted from: github.com/chirpstack/chirpstack v4.9.0
 
@@ -188,7 +191,8 @@ LinkCheckComponent::BeforeSendingReply(Ptr<EndDeviceStatus> status,
 
         auto replyCommand = Create<LinkCheckAns>(margin, gwCount);
         status->m_reply.frameHeader.SetAsDownlink();
-        status->m_reply.frameHeader.AddCommand(replyCommand);
+        // Queued, so it can share the downlink's FOpts with other components
+        status->AddMACCommand(replyCommand);
         status->m_reply.macHeader.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_DOWN);
     }
     else
@@ -202,5 +206,11 @@ LinkCheckComponent::OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus
 {
     NS_LOG_FUNCTION(this->GetTypeId() << networkStatus);
 }
+
+uint8_t
+LinkCheckComponent::GetUplinkInterest() const
+{
+    return NO_UPLINKS;
+}
 } // namespace lorawan
 } // namespace ns3
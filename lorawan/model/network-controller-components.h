@@ -47,6 +47,34 @@ class NetworkControllerComponent : public Object
     NetworkControllerComponent();           //!< Default constructor
     ~NetworkControllerComponent() override; //!< Destructor
 
+    /**
+     * Classes of uplink message a component can subscribe to.
+     *
+     * The NetworkController queries each component's subscription once, when
+     * it is installed, and then only dispatches OnReceivedPacket calls for
+     * the message types the component declared interest in.
+     */
+    enum UplinkInterest : uint8_t
+    {
+        NO_UPLINKS = 0,                    //!< Never act on uplink arrival.
+        JOIN_REQUEST_UPLINKS = 1 << 0,     //!< Join request messages.
+        UNCONFIRMED_DATA_UPLINKS = 1 << 1, //!< Unconfirmed data uplinks.
+        CONFIRMED_DATA_UPLINKS = 1 << 2,   //!< Confirmed data uplinks.
+        ALL_UPLINKS = 0xFF                 //!< Every uplink message.
+    };
+
+    /**
+     * Declare which uplink message classes this component acts on in
+     * OnReceivedPacket.
+     *
+     * The base class subscribes to every uplink; components that filter
+     * internally by message type can override this and have the dispatch
+     * loop skip them instead.
+     *
+     * @return A bitwise OR of UplinkInterest values.
+     */
+    virtual uint8_t GetUplinkInterest() const;
+
     // Virtual methods whose implementation is left to child classes
     /**
      * Function called as a new uplink packet is received by the NetworkServer application.
@@ -107,6 +135,13 @@ class ConfirmedMessagesComponent : public NetworkControllerComponent
     void BeforeSendingReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
 
     void OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
+
+    /**
+     * Only confirmed data uplinks can require an acknowledgment.
+     *
+     * @return The CONFIRMED_DATA_UPLINKS interest bit.
+     */
+    uint8_t GetUplinkInterest() const override;
 };
 
 /**
@@ -142,6 +177,14 @@ class LinkCheckComponent : public NetworkControllerComponent
 
     void OnFailedReply(Ptr<EndDeviceStatus> status, Ptr<NetworkStatus> networkStatus) override;
 
+    /**
+     * This component only acts just before a reply is sent, so it does not
+     * need to see uplink arrivals at all.
+     *
+     * @return NO_UPLINKS.
+     */
+    uint8_t GetUplinkInterest() const override;
+
   private:
 };
 } // namespace lorawan
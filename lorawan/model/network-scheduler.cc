@@ -1,5 +1,7 @@
 #include "network-scheduler.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 namespace lorawan
@@ -20,17 +22,37 @@ NetworkScheduler::GetTypeId()
                             "Trace source that is fired when a receive window opportunity happens.",
                             MakeTraceSourceAccessor(&NetworkScheduler::m_receiveWindowOpened),
                             "ns3::Packet::TracedCallback")
+            .AddAttribute("ReplyWheelTick",
+                          "Tick duration of the reply timer wheel. Zero disables the "
+                          "wheel and keeps one simulator event per pending reply. A "
+                          "positive value buckets pending RX1/RX2 opportunities and "
+                          "services each tick in batch, delaying each opportunity by up "
+                          "to one tick: keep it well below the receive window duration",
+                          TimeValue(Time(0)),
+                          MakeTimeAccessor(&NetworkScheduler::m_replyTickDuration),
+                          MakeTimeChecker())
+            .AddAttribute("ReplyWheelSize",
+                          "Number of buckets in the reply timer wheel",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&NetworkScheduler::m_wheelSize),
+                          MakeUintegerChecker<uint32_t>(1))
             .SetGroupName("lorawan");
     return tid;
 }
 
 NetworkScheduler::NetworkScheduler()
+    : m_replyTickDuration(Time(0)),
+      m_wheelSize(1024),
+      m_currentTick(0)
 {
 }
 
 NetworkScheduler::NetworkScheduler(Ptr<NetworkStatus> status, Ptr<NetworkController> controller)
     : m_status(status),
-      m_controller(controller)
+      m_controller(controller),
+      m_replyTickDuration(Time(0)),
+      m_wheelSize(1024),
+      m_currentTick(0)
 {
 }
 
@@ -43,27 +65,142 @@ NetworkScheduler::OnReceivedPacket(Ptr<const Packet> packet)
 {
     NS_LOG_FUNCTION(packet);
 
-    // Get the current packet's frame counter
-    Ptr<Packet> packetCopy = packet->Copy();
-    LorawanMacHeader receivedMacHdr;
-    packetCopy->RemoveHeader(receivedMacHdr);
-    LoraFrameHeader receivedFrameHdr;
-    receivedFrameHdr.SetAsUplink();
-    packetCopy->RemoveHeader(receivedFrameHdr);
+    // Extract the address and frame counter without copying the packet or
+    // deserializing the headers into objects
+    LoraFrameHeader::FieldView fields = LoraFrameHeader::PeekFields(packet);
+    LoraDeviceAddress deviceAddress = fields.address;
 
-    // Need to decide whether to schedule a receive window
-    if (!m_status->GetEndDeviceStatus(packet)->HasReceiveWindowOpportunityScheduled())
+    // Each gateway in range delivers its own copy of this uplink: absorb
+    // every copy after the first with one hash lookup, before touching the
+    // device status at all
+    auto [slot, inserted] = m_pendingReplyFCnt.try_emplace(deviceAddress.Get(), fields.fCnt);
+    if (!inserted)
     {
-        // Extract the address
-        LoraDeviceAddress deviceAddress = receivedFrameHdr.GetAddress();
+        if (slot->second == fields.fCnt)
+        {
+            NS_LOG_DEBUG("Duplicate copy of FCnt " << fields.fCnt << " from device "
+                                                   << deviceAddress << ", reply already pending");
+            m_stats.duplicateTriggersAbsorbed++;
+            return;
+        }
+        // A new uplink arrived while a reply was still pending: keep the
+        // pending opportunity, but track the new FCnt so its own duplicate
+        // copies are absorbed too
+        slot->second = fields.fCnt;
+    }
 
+    // Need to decide whether to schedule a receive window
+    if (!HasPendingReply(m_status->GetEndDeviceStatus(deviceAddress)))
+    {
         // Schedule OnReceiveWindowOpportunity event
-        m_status->GetEndDeviceStatus(packet)->SetReceiveWindowOpportunity(
-            Simulator::Schedule(Seconds(1),
-                                &NetworkScheduler::OnReceiveWindowOpportunity,
-                                this,
-                                deviceAddress,
-                                1)); // This will be the first receive window
+        ScheduleReplyOpportunity(deviceAddress, 1); // This will be the first receive window
+    }
+}
+
+bool
+NetworkScheduler::HasPendingReply(Ptr<EndDeviceStatus> edStatus) const
+{
+    if (m_replyTickDuration.IsZero())
+    {
+        return edStatus->HasReceiveWindowOpportunityScheduled();
+    }
+    return m_pendingReplies.count(edStatus->m_endDeviceAddress.Get());
+}
+
+void
+NetworkScheduler::ScheduleReplyOpportunity(LoraDeviceAddress deviceAddress, int window)
+{
+    NS_LOG_FUNCTION(this << deviceAddress << window);
+
+    if (m_replyTickDuration.IsZero())
+    {
+        m_status->GetEndDeviceStatus(deviceAddress)
+            ->SetReceiveWindowOpportunity(
+                Simulator::Schedule(Seconds(1),
+                                    &NetworkScheduler::OnReceiveWindowOpportunity,
+                                    this,
+                                    deviceAddress,
+                                    window));
+        return;
+    }
+
+    if (m_wheel.empty())
+    {
+        m_wheel.resize(m_wheelSize);
+        m_currentTick = uint64_t(Now() / m_replyTickDuration);
+    }
+
+    // Round the due time up so the opportunity never fires early
+    Time dueTime = Now() + Seconds(1);
+    uint64_t dueTick = uint64_t((dueTime + m_replyTickDuration - TimeStep(1)) / m_replyTickDuration);
+    dueTick = std::max(dueTick, m_currentTick + 1);
+
+    m_pendingReplies.insert(deviceAddress.Get());
+    m_wheel[dueTick % m_wheelSize].push_back(PendingReply{deviceAddress, window, dueTick});
+
+    ScheduleNextTick();
+}
+
+void
+NetworkScheduler::Tick()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_currentTick = uint64_t(Now() / m_replyTickDuration);
+    auto& bucket = m_wheel[m_currentTick % m_wheelSize];
+
+    // Collect the opportunities that are due in this tick; entries hashed to
+    // this bucket but due on a later lap stay where they are
+    std::vector<PendingReply> due;
+    for (auto it = bucket.begin(); it != bucket.end();)
+    {
+        if (it->dueTick <= m_currentTick)
+        {
+            due.push_back(*it);
+            it = bucket.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    NS_LOG_DEBUG("Tick " << m_currentTick << ": " << due.size() << " reply opportunities due");
+
+    // Stage the tick's downlinks and dispatch them grouped by gateway, so a
+    // tick releasing many replies touches each gateway's state in one pass
+    m_status->BeginDownlinkBatch();
+    for (const auto& reply : due)
+    {
+        // The opportunity fires now: the device is no longer pending, though
+        // OnReceiveWindowOpportunity may re-register it for the second window
+        m_pendingReplies.erase(reply.deviceAddress.Get());
+        OnReceiveWindowOpportunity(reply.deviceAddress, reply.window);
+    }
+    m_status->EndDownlinkBatch();
+
+    ScheduleNextTick();
+}
+
+void
+NetworkScheduler::ScheduleNextTick()
+{
+    if (m_tickEvent.IsPending())
+    {
+        return;
+    }
+
+    // Find the next non-empty bucket; a hit may still be a later-lap entry,
+    // in which case Tick simply reschedules, at most once per lap
+    for (uint32_t offset = 1; offset <= m_wheelSize; offset++)
+    {
+        if (!m_wheel[(m_currentTick + offset) % m_wheelSize].empty())
+        {
+            Time delay =
+                Time((m_currentTick + offset) * m_replyTickDuration.GetTimeStep()) - Now();
+            m_tickEvent = Simulator::Schedule(Max(delay, Time(0)), &NetworkScheduler::Tick, this);
+            return;
+        }
     }
 }
 
@@ -74,6 +211,8 @@ NetworkScheduler::OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, in
 
     NS_LOG_DEBUG("Opening receive window number " << window << " for device " << deviceAddress);
 
+    m_stats.replyOpportunities++;
+
     // Check whether we can send a reply to the device, again by using
     // NetworkStatus
     Address gwAddress = m_status->GetBestGatewayForDevice(deviceAddress, window);
@@ -85,13 +224,7 @@ NetworkScheduler::OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, in
         // No suitable gateway was found, but there's still hope to find one for the
         // second window.
         // Schedule another OnReceiveWindowOpportunity event
-        m_status->GetEndDeviceStatus(deviceAddress)
-            ->SetReceiveWindowOpportunity(
-                Simulator::Schedule(Seconds(1),
-                                    &NetworkScheduler::OnReceiveWindowOpportunity,
-                                    this,
-                                    deviceAddress,
-                                    2)); // This will be the second receive window
+        ScheduleReplyOpportunity(deviceAddress, 2); // This will be the second receive window
     }
     else if (gwAddress == Address() && window == 2)
     {
@@ -104,6 +237,10 @@ NetworkScheduler::OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, in
         // XXX Should we reset it here or keep it for the next opportunity?
         m_status->GetEndDeviceStatus(deviceAddress)->RemoveReceiveWindowOpportunity();
         m_status->GetEndDeviceStatus(deviceAddress)->InitializeReply();
+
+        // The windows lapsed: a later copy or retransmission of this uplink
+        // may trigger a fresh reply
+        m_pendingReplyFCnt.erase(deviceAddress.Get());
     }
     else
     {
@@ -111,6 +248,7 @@ NetworkScheduler::OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, in
 
         NS_LOG_DEBUG("Found available gateway with address: " << gwAddress);
 
+        m_stats.controllerEvaluations++;
         m_controller->BeforeSendingReply(m_status->GetEndDeviceStatus(deviceAddress));
 
         // Check whether this device needs a response by querying m_status
@@ -120,6 +258,8 @@ NetworkScheduler::OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, in
         {
             NS_LOG_INFO("A reply is needed");
 
+            m_stats.repliesSent++;
+
             // Send the reply through that gateway
             m_status->SendThroughGateway(m_status->GetReplyForDevice(deviceAddress, window),
                                          gwAddress);
@@ -128,7 +268,17 @@ NetworkScheduler::OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, in
             m_status->GetEndDeviceStatus(deviceAddress)->RemoveReceiveWindowOpportunity();
             m_status->GetEndDeviceStatus(deviceAddress)->InitializeReply();
         }
+
+        // The reply has been handled either way: release the pending slot so
+        // the device's next uplink is processed from scratch
+        m_pendingReplyFCnt.erase(deviceAddress.Get());
     }
 }
+
+NetworkScheduler::Stats
+NetworkScheduler::GetStats() const
+{
+    return m_stats;
+}
 } // namespace lorawan
 } // namespace ns3
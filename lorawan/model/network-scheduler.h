@@ -19,6 +19,10 @@
 #include "ns3/object.h"
 #include "ns3/packet.h"
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 namespace ns3
 {
 namespace lorawan
@@ -74,12 +78,120 @@ class NetworkScheduler : public Object
      */
     void OnReceiveWindowOpportunity(LoraDeviceAddress deviceAddress, int window);
 
+    /**
+     * Plain counters incremented on the reply scheduling hot path.
+     *
+     * Cheap enough to stay enabled unconditionally; the ratio between
+     * opportunities and replies actually sent tells how much of the
+     * scheduling work is wasted on devices that end up needing no downlink.
+     */
+    struct Stats
+    {
+        uint64_t replyOpportunities = 0;    //!< Receive window opportunities serviced.
+        uint64_t controllerEvaluations = 0; //!< BeforeSendingReply runs on the controller.
+        uint64_t repliesSent = 0;           //!< Replies actually sent through a gateway.
+        uint64_t duplicateTriggersAbsorbed = 0; //!< Extra gateway copies of an uplink dropped
+                                                //!< by the pending-reply slot.
+    };
+
+    /**
+     * Get a snapshot of the scheduling counters.
+     *
+     * @return The current counter values.
+     */
+    Stats GetStats() const;
+
   private:
+    /**
+     * A pending reply opportunity held in the timer wheel.
+     */
+    struct PendingReply
+    {
+        LoraDeviceAddress deviceAddress; //!< The device the reply is intended for.
+        int window;                      //!< The reception window number (1 or 2).
+        uint64_t dueTick;                //!< The absolute tick the opportunity is due at.
+    };
+
+    /**
+     * Record a reply opportunity due one second from now.
+     *
+     * Uses an individual simulator event unless the timer wheel is enabled
+     * through the ReplyWheelTick attribute, in which case the opportunity is
+     * bucketed in the wheel and the device is marked as having a pending
+     * reply.
+     *
+     * @param deviceAddress The Address of the end device.
+     * @param window The reception window number (1 or 2).
+     */
+    void ScheduleReplyOpportunity(LoraDeviceAddress deviceAddress, int window);
+
+    /**
+     * Whether a reply opportunity is already pending for a device, in either
+     * scheduling mode.
+     *
+     * @param edStatus The status of the end device.
+     * @return True if an opportunity is pending.
+     */
+    bool HasPendingReply(Ptr<EndDeviceStatus> edStatus) const;
+
+    /**
+     * Service all reply opportunities due in the current wheel bucket.
+     */
+    void Tick();
+
+    /**
+     * Schedule the Tick event for the next non-empty bucket, if any.
+     */
+    void ScheduleNextTick();
+
     TracedCallback<Ptr<const Packet>>
         m_receiveWindowOpened;           //!< Trace callback source for reception windows openings.
                                          //!< \todo Never called. Place calls in the right places.
     Ptr<NetworkStatus> m_status;         //!< A pointer to the NetworkStatus object.
     Ptr<NetworkController> m_controller; //!< A pointer to the NetworkController object.
+
+    /**
+     * Tick duration of the reply timer wheel. Zero (the default) disables the
+     * wheel and keeps one simulator event per pending reply; a positive value
+     * buckets replies and services each tick in batch, delaying each
+     * opportunity by up to one tick. Keep it well below the devices' receive
+     * window duration.
+     */
+    Time m_replyTickDuration;
+
+    uint32_t m_wheelSize; //!< Number of buckets in the reply timer wheel.
+
+    /**
+     * The reply timer wheel. Bucket i holds the opportunities whose due tick
+     * is congruent to i modulo m_wheelSize; entries due on a later lap are
+     * left in place when their bucket is processed.
+     */
+    std::vector<std::vector<PendingReply>> m_wheel;
+
+    uint64_t m_currentTick; //!< The tick the wheel has been advanced to.
+    EventId m_tickEvent;    //!< The single pending Tick event.
+
+    /**
+     * The devices with a reply opportunity currently held in the wheel,
+     * taking the place of the per-device EventId bookkeeping of the
+     * individual-event mode.
+     */
+    std::unordered_set<uint32_t> m_pendingReplies;
+
+    /**
+     * Per-device pending-reply slot, keyed by raw device address and holding
+     * the FCnt of the uplink whose reply is being handled.
+     *
+     * Every gateway in range delivers its own copy of an uplink to the
+     * server, and each copy fires OnReceivedPacket. The slot lets all copies
+     * after the first be dropped with a single hash lookup, before any
+     * device status lookup happens. Entries are erased when the reply is
+     * sent or the second receive window lapses, so a genuine retransmission
+     * reusing the same FCnt is handled again.
+     */
+    std::unordered_map<uint32_t, uint16_t> m_pendingReplyFCnt;
+
+    Stats m_stats; //!< Scheduling counters.
 };
 
 } // namespace lorawan
@@ -20,6 +20,7 @@
 #include "ns3/node-container.h"
 #include "ns3/packet.h"
 #include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
 #include "fec-component.h"
 
 namespace ns3
@@ -43,6 +44,25 @@ NetworkServer::GetTypeId()
                 "Trace source that is fired when a packet arrives at the network server",
                 MakeTraceSourceAccessor(&NetworkServer::m_receivedPacket),
                 "ns3::Packet::TracedCallback")
+            .AddAttribute("UplinkDedupCacheSize",
+                          "Number of recently seen uplink identities (packet UID plus "
+                          "device address) remembered for "
+                          "deduplication. Zero disables the cache; a positive value lets "
+                          "copies of an uplink already relayed by another gateway skip "
+                          "the scheduler and controller dispatch, and only record the "
+                          "additional gateway measurement",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&NetworkServer::m_dedupCacheSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("StagingQueueCapacity",
+                          "Capacity of the single-producer single-consumer staging ring "
+                          "between reception callbacks and server processing. Zero "
+                          "processes each uplink inline in the reception callback; a "
+                          "positive value parks compact descriptors in the ring and "
+                          "batch-drains them at the same simulated time",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&NetworkServer::m_stagingCapacity),
+                          MakeUintegerChecker<uint32_t>())
             .SetGroupName("lorawan");
     return tid;
 }
@@ -50,7 +70,9 @@ NetworkServer::GetTypeId()
 NetworkServer::NetworkServer()
     : m_status(Create<NetworkStatus>()),
       m_controller(Create<NetworkController>(m_status)),
-      m_scheduler(Create<NetworkScheduler>(m_status, m_controller))
+      m_scheduler(Create<NetworkScheduler>(m_status, m_controller)),
+      m_dedupCacheSize(0),
+      m_stagingCapacity(0)
 {
     NS_LOG_FUNCTION_NOARGS();
     
@@ -98,10 +120,16 @@ NetworkServer::AddGateway(Ptr<Node> gateway, Ptr<NetDevice> netDevice)
         }
     }
 
-    // Get the gateway's LoRa MAC layer (assumes gateway's MAC is configured as first device)
-    Ptr<GatewayLorawanMac> gwMac =
-        DynamicCast<GatewayLorawanMac>(DynamicCast<LoraNetDevice>(gateway->GetDevice(0))->GetMac());
-    NS_ASSERT(gwMac);
+    // Get the gateway's LoRa MAC layer (assumes gateway's MAC is configured as first device).
+    // In a distributed run only local-rank gateways can be queried directly: remote ones are
+    // registered address-only and reached exclusively through messages on the P2P link
+    Ptr<GatewayLorawanMac> gwMac;
+    if (gateway->GetSystemId() == Simulator::GetSystemId())
+    {
+        gwMac = DynamicCast<GatewayLorawanMac>(
+            DynamicCast<LoraNetDevice>(gateway->GetDevice(0))->GetMac());
+        NS_ASSERT(gwMac);
+    }
 
     // Get the Address
     Address gatewayAddress = p2pNetDevice->GetAddress();
@@ -117,12 +145,27 @@ NetworkServer::AddNodes(NodeContainer nodes)
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    // For each node in the container, call the function to add that single node
-    NodeContainer::Iterator it;
-    for (it = nodes.Begin(); it != nodes.End(); it++)
+    // Collect the MAC layers first and register them in one pass, so the
+    // NetworkStatus can size its device table for the whole batch
+    std::vector<Ptr<ClassAEndDeviceLorawanMac>> edMacs;
+    edMacs.reserve(nodes.GetN());
+    for (auto it = nodes.Begin(); it != nodes.End(); it++)
     {
-        AddNode(*it);
+        Ptr<Node> node = *it;
+        Ptr<LoraNetDevice> loraNetDevice;
+        for (uint32_t i = 0; i < node->GetNDevices(); i++)
+        {
+            loraNetDevice = DynamicCast<LoraNetDevice>(node->GetDevice(i));
+            if (loraNetDevice)
+            {
+                break;
+            }
+        }
+        Ptr<ClassAEndDeviceLorawanMac> edLorawanMac =
+            DynamicCast<ClassAEndDeviceLorawanMac>(loraNetDevice->GetMac());
+        edMacs.push_back(edLorawanMac);
     }
+    m_status->AddNodes(edMacs);
 }
 
 void
@@ -172,15 +215,98 @@ NetworkServer::Receive(Ptr<NetDevice> device,
 {
     NS_LOG_FUNCTION(this << packet << protocol << address);
 
+    m_stats.uplinksReceived++;
+
     // Fire the trace source
     m_receivedPacket(packet);
 
+    if (m_uplinkTraceWriter.IsOpen())
+    {
+        // Capture before deduplication so the replay sees every gateway copy
+        m_uplinkTraceWriter.Record(packet, address);
+    }
+
+    if (m_stagingCapacity != 0)
+    {
+        if (m_stagingRing.empty())
+        {
+            m_stagingRing.resize(m_stagingCapacity);
+        }
+        uint64_t head = m_stagingHead.load(std::memory_order_relaxed);
+        uint64_t tail = m_stagingTail.load(std::memory_order_acquire);
+        if (head - tail < m_stagingRing.size())
+        {
+            m_stagingRing[head % m_stagingRing.size()] = {packet, address};
+            m_stagingHead.store(head + 1, std::memory_order_release);
+            if (!m_stagingDrainEvent.IsPending())
+            {
+                m_stagingDrainEvent =
+                    Simulator::Schedule(Seconds(0), &NetworkServer::DrainStagedUplinks, this);
+            }
+            return true;
+        }
+        // Ring full: fall back to inline processing rather than losing the uplink
+        m_stats.stagingOverflows++;
+    }
+
+    ProcessUplink(packet, address);
+
+    return true;
+}
+
+void
+NetworkServer::DrainStagedUplinks()
+{
+    NS_LOG_FUNCTION(this);
+
+    uint64_t head = m_stagingHead.load(std::memory_order_acquire);
+    uint64_t tail = m_stagingTail.load(std::memory_order_relaxed);
+    NS_LOG_DEBUG("Draining " << head - tail << " staged uplinks");
+    while (tail != head)
+    {
+        StagedUplink& slot = m_stagingRing[tail % m_stagingRing.size()];
+        ProcessUplink(slot.packet, slot.address);
+        slot = StagedUplink{};
+        tail++;
+    }
+    m_stagingTail.store(tail, std::memory_order_release);
+}
+
+void
+NetworkServer::ProcessUplink(Ptr<const Packet> packet, const Address& address)
+{
+    if (m_dedupCacheSize != 0)
+    {
+        // Copies of the same uplink relayed by several gateways share the
+        // original packet's UID and device address; the pair identifies one
+        // transmission even if unrelated payloads were to share a UID. If a
+        // copy was already processed, only record this gateway's
+        // measurement: the scheduler and controller were already run for
+        // the first copy
+        LoraFrameHeader::FieldView fields = LoraFrameHeader::PeekFields(packet);
+        UplinkId uplinkId{packet->GetUid(), fields.address.Get()};
+        if (m_recentUplinkIdSet.count(uplinkId))
+        {
+            m_stats.duplicatesShortCircuited++;
+            NS_LOG_DEBUG("Duplicate copy of uplink " << uplinkId.first << " from device "
+                                                     << fields.address
+                                                     << ", recording gateway measurement only");
+            m_status->OnReceivedPacket(packet, address);
+            return;
+        }
+        m_recentUplinkIdSet.insert(uplinkId);
+        m_recentUplinkIds.push_back(uplinkId);
+        while (m_recentUplinkIds.size() > m_dedupCacheSize)
+        {
+            m_recentUplinkIdSet.erase(m_recentUplinkIds.front());
+            m_recentUplinkIds.pop_front();
+        }
+    }
+
     // *** CLEAN: Only normal processing - FEC handled by FecComponent ***
     m_scheduler->OnReceivedPacket(packet);
     m_status->OnReceivedPacket(packet, address);
     m_controller->OnNewPacket(packet);  // ← This calls FecComponent automatically
-
-    return true;
 }
 
 
@@ -198,6 +324,38 @@ NetworkServer::GetNetworkStatus()
     return m_status;
 }
 
+Ptr<NetworkScheduler>
+NetworkServer::GetNetworkScheduler()
+{
+    return m_scheduler;
+}
+
+Ptr<NetworkController>
+NetworkServer::GetNetworkController()
+{
+    return m_controller;
+}
+
+NetworkServer::Stats
+NetworkServer::GetStats() const
+{
+    return m_stats;
+}
+
+void
+NetworkServer::EnableUplinkCapture(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    m_uplinkTraceWriter.Open(filename);
+}
+
+void
+NetworkServer::DisableUplinkCapture()
+{
+    NS_LOG_FUNCTION(this);
+    m_uplinkTraceWriter.Close();
+}
+
 // =====================================================
 // *** FEC IMPLEMENTATION METHODS ***
 // =====================================================
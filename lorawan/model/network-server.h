@@ -16,6 +16,7 @@
 #include "network-controller.h"
 #include "network-scheduler.h"
 #include "network-status.h"
+#include "uplink-trace.h"
 
 #include "ns3/application.h"
 #include "ns3/log.h"
@@ -26,10 +27,14 @@
 #include "ns3/point-to-point-net-device.h"
 
 // *** ADD INCLUDES FOR FEC ***
+#include <atomic>
 #include <map>
 #include <vector>
 #include <queue>
 #include <set>
+#include <deque>
+#include <unordered_set>
+#include <utility>
 
 namespace ns3
 {
@@ -124,6 +129,55 @@ class NetworkServer : public Application
      */
     Ptr<NetworkStatus> GetNetworkStatus();
 
+    /**
+     * Get the NetworkScheduler object of this NetworkServer application.
+     *
+     * @return A pointer to the NetworkScheduler object.
+     */
+    Ptr<NetworkScheduler> GetNetworkScheduler();
+
+    /**
+     * Get the NetworkController object of this NetworkServer application.
+     *
+     * @return A pointer to the NetworkController object.
+     */
+    Ptr<NetworkController> GetNetworkController();
+
+    /**
+     * Capture every uplink handled by Receive() to a binary trace that
+     * UplinkTraceReplayer can later feed back into the network controller
+     * without re-simulating the channel.
+     *
+     * @param filename The trace file to write.
+     */
+    void EnableUplinkCapture(const std::string& filename);
+
+    /**
+     * Stop capturing uplinks and close the trace file.
+     */
+    void DisableUplinkCapture();
+
+    /**
+     * Plain counters incremented on the receive hot path.
+     *
+     * These are cheap enough (single integer increments) to stay enabled
+     * unconditionally; read them through GetStats() at any point during or
+     * after the simulation.
+     */
+    struct Stats
+    {
+        uint64_t uplinksReceived = 0; //!< Gateway copies handed to Receive().
+        uint64_t duplicatesShortCircuited = 0; //!< Copies absorbed by the dedup cache.
+        uint64_t stagingOverflows = 0; //!< Uplinks processed inline because the ring was full.
+    };
+
+    /**
+     * Get a snapshot of the receive-path counters.
+     *
+     * @return The current counter values.
+     */
+    Stats GetStats() const;
+
     // *** ADD FEC PUBLIC METHODS ***
     void EnableFec(bool enable) { m_fecConfig.enabled = enable; }
     void SetFecGenerationSize(uint32_t size) { m_fecConfig.generationSize = size; }
@@ -137,6 +191,86 @@ class NetworkServer : public Application
     TracedCallback<Ptr<const Packet>> m_receivedPacket; //!< The `ReceivedPacket` trace source.
 
   private:
+    /**
+     * How many recently seen uplink identities (packet UID plus device
+     * address) to remember for
+     * deduplication. Zero (the default) disables the cache and runs the full
+     * receive path for every gateway copy of an uplink; a positive value
+     * short-circuits copies of an already-seen uplink into the gateway
+     * measurement update alone, skipping the scheduler and controller
+     * dispatch that the first copy already triggered.
+     */
+    uint32_t m_dedupCacheSize;
+
+    /**
+     * Run the deduplication check and the scheduler, status, and controller
+     * dispatch for one uplink copy. Shared by the inline receive path and the
+     * staging drain.
+     *
+     * @param packet The received packet.
+     * @param address The address of the gateway that relayed the packet.
+     */
+    void ProcessUplink(Ptr<const Packet> packet, const Address& address);
+
+    /// A reception descriptor parked in the staging ring.
+    struct StagedUplink
+    {
+        Ptr<const Packet> packet; //!< The received packet.
+        Address address;          //!< The relaying gateway's address.
+    };
+
+    /**
+     * Dispatch every descriptor currently staged through ProcessUplink in one
+     * batch. Runs at the same simulated time as the receptions it drains.
+     */
+    void DrainStagedUplinks();
+
+    /**
+     * Capacity of the staging ring between reception callbacks and server
+     * processing. Zero (the default) keeps the legacy behavior of running the
+     * full processing chain inline in the reception callback.
+     */
+    uint32_t m_stagingCapacity;
+
+    /**
+     * Fixed-capacity single-producer single-consumer ring of staged
+     * receptions. The receive callback only writes at the head, the drain
+     * event only reads at the tail, so the two sides never contend: the
+     * indices below are the only shared state, ordered by release/acquire.
+     */
+    std::vector<StagedUplink> m_stagingRing;
+
+    std::atomic<uint64_t> m_stagingHead{0}; //!< Count of descriptors ever staged.
+    std::atomic<uint64_t> m_stagingTail{0}; //!< Count of descriptors ever drained.
+
+    EventId m_stagingDrainEvent; //!< The pending drain event, if any.
+
+    /**
+     * Identity of one uplink transmission for deduplication: the packet UID
+     * combined with the sending device's raw address. Gateway copies of one
+     * transmission share both; including the address guarantees that
+     * payloads which happen to share a UID (e.g. from a buggy packet
+     * factory) can never alias uplinks of different devices.
+     */
+    typedef std::pair<uint64_t, uint32_t> UplinkId;
+
+    /// Hasher for UplinkId; equality on the full pair resolves collisions.
+    struct UplinkIdHash
+    {
+        std::size_t operator()(const UplinkId& id) const
+        {
+            return std::hash<uint64_t>()(id.first ^ (uint64_t(id.second) << 32));
+        }
+    };
+
+    std::deque<UplinkId> m_recentUplinkIds; //!< Seen uplink identities, oldest first.
+    /// The same identities, for O(1) lookup.
+    std::unordered_set<UplinkId, UplinkIdHash> m_recentUplinkIdSet;
+
+    UplinkTraceWriter m_uplinkTraceWriter; //!< Capture sink for the record-and-replay mode.
+
+    Stats m_stats; //!< Receive-path counters.
+
     // *** ADD FEC DECODER FUNCTIONALITY ***
     
     // FEC Configuration
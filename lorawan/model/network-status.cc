@@ -12,12 +12,18 @@
 #include "end-device-status.h"
 #include "gateway-status.h"
 #include "lora-device-address.h"
+#include "lora-phy.h"
+#include "lora-tag.h"
+#include "memory-report.h"
 
 #include "ns3/log.h"
 #include "ns3/net-device.h"
 #include "ns3/node-container.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
 
 namespace ns3
 {
@@ -39,6 +45,7 @@ NetworkStatus::GetTypeId()
 }
 
 NetworkStatus::NetworkStatus()
+    : m_denseBaseAddress(0)
 {
     NS_LOG_FUNCTION_NOARGS();
 }
@@ -65,7 +72,107 @@ NetworkStatus::AddNode(Ptr<ClassAEndDeviceLorawanMac> edMac)
         m_endDeviceStatuses.insert(
             std::pair<LoraDeviceAddress, Ptr<EndDeviceStatus>>(edAddress, edStatus));
         NS_LOG_DEBUG("Added to the list a device with address " << edAddress.Print());
+
+        // Also index it in the dense table if its address fits; addresses
+        // from LoraDeviceAddressGenerator are sequential, so normally they
+        // all do
+        uint32_t rawAddress = edAddress.Get();
+        if (m_endDeviceStatuses.size() == 1)
+        {
+            m_denseBaseAddress = rawAddress;
+        }
+        IndexInDenseTable(rawAddress, edStatus);
+    }
+}
+
+void
+NetworkStatus::AddNodes(const std::vector<Ptr<ClassAEndDeviceLorawanMac>>& edMacs)
+{
+    NS_LOG_FUNCTION(this << edMacs.size());
+
+    if (edMacs.empty())
+    {
+        return;
+    }
+
+    // Size the dense table once for the whole batch instead of growing it
+    // one resize per device
+    uint32_t minAddress = 0xFFFFFFFF;
+    uint32_t maxAddress = 0;
+    for (const auto& edMac : edMacs)
+    {
+        uint32_t rawAddress = edMac->GetDeviceAddress().Get();
+        minAddress = std::min(minAddress, rawAddress);
+        maxAddress = std::max(maxAddress, rawAddress);
+    }
+    if (m_endDeviceStatuses.empty())
+    {
+        m_denseBaseAddress = minAddress;
+    }
+    if (maxAddress >= m_denseBaseAddress)
+    {
+        uint64_t lastSlot = maxAddress - m_denseBaseAddress;
+        uint64_t wantedSlots = std::min(lastSlot + 1, MAX_DENSE_SLOTS);
+        if (wantedSlots > m_denseDeviceTable.size())
+        {
+            m_denseDeviceTable.resize(wantedSlots);
+        }
+    }
+
+    // Reserve for the whole batch up front so the device table rehashes at
+    // most once instead of repeatedly while registering large populations
+    m_endDeviceStatuses.reserve(m_endDeviceStatuses.size() + edMacs.size());
+    for (const auto& edMac : edMacs)
+    {
+        LoraDeviceAddress edAddress = edMac->GetDeviceAddress();
+        if (m_endDeviceStatuses.find(edAddress) != m_endDeviceStatuses.end())
+        {
+            continue;
+        }
+
+        Ptr<EndDeviceStatus> edStatus =
+            CreateObject<EndDeviceStatus>(edAddress, DynamicCast<ClassAEndDeviceLorawanMac>(edMac));
+        m_endDeviceStatuses.emplace(edAddress, edStatus);
+        IndexInDenseTable(edAddress.Get(), edStatus);
     }
+
+    NS_LOG_DEBUG("Bulk-registered " << edMacs.size() << " devices; network now tracks "
+                                    << m_endDeviceStatuses.size());
+}
+
+void
+NetworkStatus::IndexInDenseTable(uint32_t rawAddress, Ptr<EndDeviceStatus> edStatus)
+{
+    if (rawAddress < m_denseBaseAddress)
+    {
+        return;
+    }
+    uint64_t slot = rawAddress - m_denseBaseAddress;
+    if (slot >= MAX_DENSE_SLOTS)
+    {
+        return;
+    }
+    if (slot >= m_denseDeviceTable.size())
+    {
+        m_denseDeviceTable.resize(slot + 1);
+    }
+    m_denseDeviceTable[slot] = edStatus;
+}
+
+Ptr<EndDeviceStatus>
+NetworkStatus::Lookup(LoraDeviceAddress address) const
+{
+    uint32_t rawAddress = address.Get();
+    if (rawAddress >= m_denseBaseAddress)
+    {
+        uint64_t slot = rawAddress - m_denseBaseAddress;
+        if (slot < m_denseDeviceTable.size() && m_denseDeviceTable[slot])
+        {
+            return m_denseDeviceTable[slot];
+        }
+    }
+    auto it = m_endDeviceStatuses.find(address);
+    return (it != m_endDeviceStatuses.end()) ? it->second : nullptr;
 }
 
 void
@@ -74,49 +181,60 @@ NetworkStatus::AddGateway(Address& address, Ptr<GatewayStatus> gwStatus)
     NS_LOG_FUNCTION(this);
 
     // Check whether this device already exists in the list
-    if (m_gatewayStatuses.find(address) == m_gatewayStatuses.end())
+    if (m_gatewayIdByAddress.find(address) == m_gatewayIdByAddress.end())
     {
-        // The device doesn't exist.
-
-        // Add it to the map
-        m_gatewayStatuses.insert(std::pair<Address, Ptr<GatewayStatus>>(address, gwStatus));
-        NS_LOG_DEBUG("Added to the list a gateway with address " << address);
+        // The device doesn't exist: assign the next dense id and register it
+        NS_ASSERT_MSG(m_gatewayStatusById.size() < UNKNOWN_GATEWAY,
+                      "Too many gateways for the 16-bit id space");
+        uint16_t gatewayId = static_cast<uint16_t>(m_gatewayStatusById.size());
+        m_gatewayIdByAddress.insert(std::pair<Address, uint16_t>(address, gatewayId));
+        m_gatewayStatusById.push_back(gwStatus);
+        NS_LOG_DEBUG("Added to the list a gateway with address " << address << " as id "
+                                                                 << gatewayId);
     }
 }
 
+uint16_t
+NetworkStatus::GetGatewayId(const Address& address) const
+{
+    auto it = m_gatewayIdByAddress.find(address);
+    return (it != m_gatewayIdByAddress.end()) ? it->second : UNKNOWN_GATEWAY;
+}
+
+Ptr<GatewayStatus>
+NetworkStatus::GetGatewayStatus(uint16_t gatewayId) const
+{
+    return (gatewayId < m_gatewayStatusById.size()) ? m_gatewayStatusById[gatewayId] : nullptr;
+}
+
 void
 NetworkStatus::OnReceivedPacket(Ptr<const Packet> packet, const Address& gwAddress)
 {
     NS_LOG_FUNCTION(this << packet << gwAddress);
 
-    // Create a copy of the packet
-    Ptr<Packet> myPacket = packet->Copy();
-
-    // Extract the headers
-    LorawanMacHeader macHdr;
-    myPacket->RemoveHeader(macHdr);
-    LoraFrameHeader frameHdr;
-    frameHdr.SetAsUplink();
-    myPacket->RemoveHeader(frameHdr);
-
-    // Update the correct EndDeviceStatus object
-    LoraDeviceAddress edAddr = frameHdr.GetAddress();
+    // Update the correct EndDeviceStatus object. Peeking the address in
+    // place avoids copying the packet and deserializing its headers
+    LoraDeviceAddress edAddr = LoraFrameHeader::PeekFields(packet).address;
     NS_LOG_DEBUG("Node address: " << edAddr);
-    m_endDeviceStatuses.at(edAddr)->InsertReceivedPacket(packet, gwAddress);
+    Ptr<EndDeviceStatus> edStatus = Lookup(edAddr);
+    NS_ASSERT_MSG(edStatus, "Received a packet from an unknown device");
+    edStatus->InsertReceivedPacket(packet, gwAddress);
 }
 
 bool
 NetworkStatus::NeedsReply(LoraDeviceAddress deviceAddress)
 {
-    // Throws out of range if no device is found
-    return m_endDeviceStatuses.at(deviceAddress)->NeedsReply();
+    Ptr<EndDeviceStatus> edStatus = Lookup(deviceAddress);
+    NS_ASSERT_MSG(edStatus, "No device found for this address");
+    return edStatus->NeedsReply();
 }
 
 Address
 NetworkStatus::GetBestGatewayForDevice(LoraDeviceAddress deviceAddress, int window)
 {
     // Get the endDeviceStatus we are interested in
-    Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.at(deviceAddress);
+    Ptr<EndDeviceStatus> edStatus = Lookup(deviceAddress);
+    NS_ASSERT_MSG(edStatus, "No device found for this address");
     uint32_t replyFrequency;
     if (window == 1)
     {
@@ -134,18 +252,26 @@ NetworkStatus::GetBestGatewayForDevice(LoraDeviceAddress deviceAddress, int wind
     // Get the list of gateways that this device can reach
     // NOTE: At this point, we could also take into account the whole network to
     // identify the best gateway according to various metrics. For now, we just
-    // ask the EndDeviceStatus to pick the best gateway for us via its method.
-    std::map<double, Address> gwAddresses = edStatus->GetPowerGatewayMap();
+    // ask the EndDeviceStatus for its by-power gateway index, maintained
+    // incrementally as receptions are recorded.
+    const auto& gwAddresses = edStatus->GetGatewaysByPower();
 
-    // By iterating on the map in reverse, we go from the 'best'
+    // By iterating on the index in reverse, we go from the 'best'
     // gateway, i.e. the one with the highest received power, to the
     // worst.
     Address bestGwAddress;
     for (auto it = gwAddresses.rbegin(); it != gwAddresses.rend(); it++)
     {
-        bool isAvailable =
-            m_gatewayStatuses.find(it->second)->second->IsAvailableForTransmission(replyFrequency);
-        if (isAvailable)
+        Ptr<GatewayStatus> gwStatus = m_gatewayStatusById[GetGatewayId(it->second)];
+
+        // Skip gateways known to be busy without the full availability
+        // check, which involves a duty cycle computation in their MAC
+        if (gwStatus->GetNextFreeTime(replyFrequency) > Now())
+        {
+            continue;
+        }
+
+        if (gwStatus->IsAvailableForTransmission(replyFrequency))
         {
             bestGwAddress = it->second;
             break;
@@ -160,14 +286,92 @@ NetworkStatus::SendThroughGateway(Ptr<Packet> packet, Address gwAddress)
 {
     NS_LOG_FUNCTION(packet << gwAddress);
 
-    m_gatewayStatuses.find(gwAddress)->second->GetNetDevice()->Send(packet, gwAddress, 0x0800);
+    uint16_t gatewayId = GetGatewayId(gwAddress);
+    if (m_batchingDownlinks)
+    {
+        m_downlinkBatch.push_back({gatewayId, packet, gwAddress});
+        return;
+    }
+    Ptr<GatewayStatus> gwStatus = m_gatewayStatusById[gatewayId];
+    BookDownlinkAirtime(gwStatus, packet);
+    gwStatus->GetNetDevice()->Send(packet, gwAddress, 0x0800);
+}
+
+void
+NetworkStatus::BookDownlinkAirtime(Ptr<GatewayStatus> gwStatus, Ptr<const Packet> packet)
+{
+    LoraTag tag;
+    if (!packet->PeekPacketTag(tag))
+    {
+        return; // Nothing to price the transmission with
+    }
+
+    uint8_t dataRate = tag.GetDataRate();
+    Ptr<GatewayLorawanMac> gwMac = gwStatus->GetGatewayMac();
+    // For a remote (MPI) gateway the MAC cannot be queried, so fall back to
+    // the EU868 data rate mapping
+    uint8_t sf = gwMac ? gwMac->GetSfFromDataRate(dataRate)
+                       : uint8_t(12 - std::min<uint8_t>(dataRate, 5));
+
+    LoraTxParameters txParams;
+    txParams.sf = sf;
+    txParams.lowDataRateOptimizationEnabled = LoraPhy::GetTSym(txParams) > MilliSeconds(16);
+    gwStatus->BookTransmission(tag.GetFrequency(), LoraPhy::GetOnAirTime(packet->Copy(), txParams));
+}
+
+void
+NetworkStatus::BeginDownlinkBatch()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_batchingDownlinks = true;
+}
+
+void
+NetworkStatus::EndDownlinkBatch()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_batchingDownlinks = false;
+
+    if (m_downlinkBatch.empty())
+    {
+        return;
+    }
+
+    // Group the staged downlinks by gateway; the stable sort keeps each
+    // gateway's sends in staging order
+    std::stable_sort(m_downlinkBatch.begin(),
+                     m_downlinkBatch.end(),
+                     [](const StagedDownlink& a, const StagedDownlink& b) {
+                         return a.gatewayId < b.gatewayId;
+                     });
+
+    NS_LOG_DEBUG("Dispatching a batch of " << m_downlinkBatch.size() << " downlinks");
+
+    uint16_t currentGateway = UNKNOWN_GATEWAY;
+    Ptr<GatewayStatus> gwStatus;
+    Ptr<NetDevice> device;
+    for (const auto& staged : m_downlinkBatch)
+    {
+        if (staged.gatewayId != currentGateway)
+        {
+            currentGateway = staged.gatewayId;
+            gwStatus = m_gatewayStatusById[currentGateway];
+            device = gwStatus->GetNetDevice();
+        }
+        BookDownlinkAirtime(gwStatus, staged.packet);
+        device->Send(staged.packet, staged.gwAddress, 0x0800);
+    }
+    m_downlinkBatch.clear();
 }
 
 Ptr<Packet>
 NetworkStatus::GetReplyForDevice(LoraDeviceAddress edAddress, int windowNumber)
 {
     // Get the reply packet
-    Ptr<EndDeviceStatus> edStatus = m_endDeviceStatuses.find(edAddress)->second;
+    Ptr<EndDeviceStatus> edStatus = Lookup(edAddress);
+    NS_ASSERT_MSG(edStatus, "No device found for this address");
     Ptr<Packet> packet = edStatus->GetCompleteReplyPacket();
 
     // Apply the appropriate tag
@@ -193,22 +397,13 @@ NetworkStatus::GetEndDeviceStatus(Ptr<const Packet> packet)
 {
     NS_LOG_FUNCTION(this << packet);
 
-    // Get the address
-    LorawanMacHeader mHdr;
-    LoraFrameHeader fHdr;
-    Ptr<Packet> myPacket = packet->Copy();
-    myPacket->RemoveHeader(mHdr);
-    myPacket->RemoveHeader(fHdr);
-    auto it = m_endDeviceStatuses.find(fHdr.GetAddress());
-    if (it != m_endDeviceStatuses.end())
-    {
-        return (*it).second;
-    }
-    else
+    // Get the address with an in-place peek of the frame header
+    Ptr<EndDeviceStatus> edStatus = Lookup(LoraFrameHeader::PeekFields(packet).address);
+    if (!edStatus)
     {
         NS_LOG_ERROR("EndDeviceStatus not found");
-        return nullptr;
     }
+    return edStatus;
 }
 
 Ptr<EndDeviceStatus>
@@ -216,16 +411,12 @@ NetworkStatus::GetEndDeviceStatus(LoraDeviceAddress address)
 {
     NS_LOG_FUNCTION(this << address);
 
-    auto it = m_endDeviceStatuses.find(address);
-    if (it != m_endDeviceStatuses.end())
-    {
-        return (*it).second;
-    }
-    else
+    Ptr<EndDeviceStatus> edStatus = Lookup(address);
+    if (!edStatus)
     {
         NS_LOG_ERROR("EndDeviceStatus not found");
-        return nullptr;
     }
+    return edStatus;
 }
 
 int
@@ -235,5 +426,32 @@ NetworkStatus::CountEndDevices()
 
     return m_endDeviceStatuses.size();
 }
+
+uint64_t
+NetworkStatus::MemoryReport() const
+{
+    uint64_t bytes = EstimateMemory(m_endDeviceStatuses) + EstimateMemory(m_gatewayIdByAddress) +
+                     EstimateMemory(m_gatewayStatusById) + EstimateMemory(m_denseDeviceTable);
+
+    bytes += m_gatewayStatusById.size() * sizeof(GatewayStatus);
+
+    for (const auto& [address, edStatus] : m_endDeviceStatuses)
+    {
+        bytes += sizeof(EndDeviceStatus);
+
+        const EndDeviceStatus::ReceivedPacketList& history = edStatus->GetReceivedPacketList();
+        bytes += EstimateMemory(history);
+        for (const auto& [packet, info] : history)
+        {
+            bytes += EstimateMemory(info.gwList);
+            if (packet)
+            {
+                bytes += packet->GetSize();
+            }
+        }
+    }
+
+    return bytes;
+}
 } // namespace lorawan
 } // namespace ns3
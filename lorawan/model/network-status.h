@@ -17,6 +17,8 @@
 #include "network-scheduler.h"
 
 #include <iterator>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -53,6 +55,18 @@ class NetworkStatus : public Object
      */
     void AddNode(Ptr<ClassAEndDeviceLorawanMac> edMac);
 
+    /**
+     * Add a batch of devices in one pass.
+     *
+     * Equivalent to calling AddNode once per MAC, but sizes the dense device
+     * table and the device map once for the whole batch, which makes
+     * registering large sequentially-addressed populations linear instead of
+     * paying a possible rehash and table resize per device.
+     *
+     * @param edMacs The MAC layer objects of the devices to be tracked.
+     */
+    void AddNodes(const std::vector<Ptr<ClassAEndDeviceLorawanMac>>& edMacs);
+
     /**
      * Add a new gateway to the list of gateways connected to the network.
      *
@@ -64,6 +78,26 @@ class NetworkStatus : public Object
      */
     void AddGateway(Address& address, Ptr<GatewayStatus> gwStatus);
 
+    /**
+     * Get the dense id assigned to a gateway at registration time.
+     *
+     * @param address The gateway's NetDevice Address.
+     * @return The gateway's id, or UNKNOWN_GATEWAY if the address was never
+     * registered.
+     */
+    uint16_t GetGatewayId(const Address& address) const;
+
+    /**
+     * Get the status of a gateway by its dense id.
+     *
+     * @param gatewayId The id assigned at registration time.
+     * @return A pointer to the gateway status, nullptr for an invalid id.
+     */
+    Ptr<GatewayStatus> GetGatewayStatus(uint16_t gatewayId) const;
+
+    /// Id returned for addresses that were never registered as gateways.
+    static constexpr uint16_t UNKNOWN_GATEWAY = 0xFFFF;
+
     /**
      * Update network status on a received packet.
      *
@@ -103,6 +137,27 @@ class NetworkStatus : public Object
      */
     void SendThroughGateway(Ptr<Packet> packet, Address gwAddress);
 
+    /**
+     * Start staging downlinks instead of sending them immediately.
+     *
+     * Between BeginDownlinkBatch and EndDownlinkBatch, SendThroughGateway
+     * stages its packet instead of touching the gateway's NetDevice. Meant
+     * to bracket a scheduler tick that releases many replies at the same
+     * simulated instant: since no simulator event runs in between, deferral
+     * to the end of the tick is observationally equivalent to immediate
+     * dispatch, apart from the intra-tick send order.
+     */
+    void BeginDownlinkBatch();
+
+    /**
+     * Dispatch the staged downlinks, grouped by gateway.
+     *
+     * Each gateway's group goes out in one pass with its GatewayStatus and
+     * NetDevice resolved once, so the per-gateway state is touched
+     * contiguously instead of interleaved across devices.
+     */
+    void EndDownlinkBatch();
+
     /**
      * Get the reply packet prepared for a reception window of a device.
      *
@@ -135,11 +190,96 @@ class NetworkStatus : public Object
      */
     int CountEndDevices();
 
+    /**
+     * Estimate the heap bytes held by this object, including the per-device
+     * EndDeviceStatus objects and their received packet histories.
+     *
+     * @return The estimated heap bytes.
+     */
+    uint64_t MemoryReport() const;
+
   public:
-    std::map<LoraDeviceAddress, Ptr<EndDeviceStatus>>
-        m_endDeviceStatuses; //!< Map tracking the state of devices connected to this network server
-    std::map<Address, Ptr<GatewayStatus>>
-        m_gatewayStatuses; //!< Map tracking the state of gateways connected to this network server
+    /**
+     * Map tracking the state of devices connected to this network server.
+     *
+     * Hashed rather than ordered: device lookups happen on every uplink and
+     * nothing iterates this container in address order.
+     */
+    std::unordered_map<LoraDeviceAddress, Ptr<EndDeviceStatus>> m_endDeviceStatuses;
+    /**
+     * One-time mapping from a gateway's NetDevice Address to the dense id
+     * assigned at registration. Only consulted when an Address needs
+     * translating; all per-gateway state is indexed by id.
+     */
+    std::map<Address, uint16_t> m_gatewayIdByAddress;
+
+    /**
+     * State of the gateways connected to this network server, indexed by
+     * the dense registration-time gateway id. Keying by id turns the
+     * per-uplink gateway bookkeeping into vector indexing instead of map
+     * operations on heavyweight Address comparisons.
+     */
+    std::vector<Ptr<GatewayStatus>> m_gatewayStatusById;
+
+  private:
+    /**
+     * Book a downlink's time on air against its gateway's sub-band token
+     * bucket, pricing it from the packet's LoraTag. Keeps the server-side
+     * capacity model current before the packet has even crossed the
+     * backhaul link.
+     *
+     * @param gwStatus The gateway the downlink was committed to.
+     * @param packet The downlink, already tagged for transmission.
+     */
+    void BookDownlinkAirtime(Ptr<GatewayStatus> gwStatus, Ptr<const Packet> packet);
+
+    /**
+     * Get the EndDeviceStatus of a device by address, using the dense table
+     * when the address falls into it.
+     *
+     * @param address The LoraDeviceAddress of the end device.
+     * @return A pointer to the end device status, nullptr if unknown.
+     */
+    Ptr<EndDeviceStatus> Lookup(LoraDeviceAddress address) const;
+
+    /**
+     * Store a device in the dense table if its address falls into it,
+     * growing the table as needed up to MAX_DENSE_SLOTS.
+     *
+     * @param rawAddress The device address as a raw integer.
+     * @param edStatus The status object to index.
+     */
+    void IndexInDenseTable(uint32_t rawAddress, Ptr<EndDeviceStatus> edStatus);
+
+    /**
+     * Cap on the dense table size, so a single far-off address cannot blow
+     * up memory: outliers are simply served by the map.
+     */
+    static constexpr uint64_t MAX_DENSE_SLOTS = 1 << 22;
+
+    /**
+     * Devices indexed by their address offset from m_denseBaseAddress.
+     *
+     * LoraDeviceAddressGenerator hands out sequential addresses, so in the
+     * common case all devices fall into this table and the per-uplink device
+     * lookup is an array access instead of a tree search. Sparse or foreign
+     * addresses are only held by m_endDeviceStatuses, which stays the
+     * authoritative container.
+     */
+    std::vector<Ptr<EndDeviceStatus>> m_denseDeviceTable;
+
+    uint32_t m_denseBaseAddress; //!< The address stored in slot 0 of the dense table.
+
+    /// One downlink staged during a batch.
+    struct StagedDownlink
+    {
+        uint16_t gatewayId; //!< Dense id of the target gateway
+        Ptr<Packet> packet; //!< The downlink, already tagged for transmission
+        Address gwAddress;  //!< The gateway's NetDevice Address
+    };
+
+    bool m_batchingDownlinks = false;           //!< Whether sends are being staged
+    std::vector<StagedDownlink> m_downlinkBatch; //!< Downlinks staged this batch
 };
 
 } // namespace lorawan
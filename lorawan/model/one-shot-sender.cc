@@ -10,6 +10,7 @@
 
 #include "class-a-end-device-lorawan-mac.h"
 #include "lora-net-device.h"
+#include "lora-packet-pool.h"
 
 #include "ns3/double.h"
 #include "ns3/log.h"
@@ -36,12 +37,14 @@ OneShotSender::GetTypeId()
 }
 
 OneShotSender::OneShotSender()
+    : m_externallyTriggered(false)
 {
     NS_LOG_FUNCTION_NOARGS();
 }
 
 OneShotSender::OneShotSender(Time sendTime)
-    : m_sendTime(sendTime)
+    : m_sendTime(sendTime),
+      m_externallyTriggered(false)
 {
     NS_LOG_FUNCTION_NOARGS();
 }
@@ -60,21 +63,16 @@ OneShotSender::SetSendTime(Time sendTime)
 }
 
 void
-OneShotSender::SendPacket()
+OneShotSender::SetExternallyTriggered()
 {
     NS_LOG_FUNCTION(this);
 
-    // Create and send a new packet
-    Ptr<Packet> packet = Create<Packet>(10);
-    m_mac->Send(packet);
+    m_externallyTriggered = true;
 }
 
 void
-OneShotSender::StartApplication()
+OneShotSender::EnsureMac()
 {
-    NS_LOG_FUNCTION(this);
-
-    // Make sure we have a MAC layer
     if (!m_mac)
     {
         // Assumes there's only one device
@@ -83,6 +81,34 @@ OneShotSender::StartApplication()
         m_mac = loraNetDevice->GetMac();
         NS_ASSERT(m_mac);
     }
+}
+
+void
+OneShotSender::SendPacket()
+{
+    NS_LOG_FUNCTION(this);
+
+    // An external dispatcher may fire before StartApplication has run
+    EnsureMac();
+
+    // Create and send a new packet, recycling the pooled payload buffer
+    Ptr<Packet> packet = LoraPacketPool::CreatePacket(10);
+    m_mac->Send(packet);
+}
+
+void
+OneShotSender::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Make sure we have a MAC layer
+    EnsureMac();
+
+    if (m_externallyTriggered)
+    {
+        // The dispatcher owns the timing
+        return;
+    }
 
     // Schedule the next SendPacket event
     Simulator::Cancel(m_sendEvent);
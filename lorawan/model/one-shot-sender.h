@@ -56,6 +56,16 @@ class OneShotSender : public Application
      */
     void SetSendTime(Time sendTime);
 
+    /**
+     * Hand send scheduling over to an external dispatcher.
+     *
+     * StartApplication will still wire up the MAC layer but will not
+     * schedule a send event; whoever installed the application is expected
+     * to call SendPacket at the right time. Used by the batch install path
+     * of OneShotSenderHelper to keep one timer for thousands of senders.
+     */
+    void SetExternallyTriggered();
+
     /**
      * Start the application by scheduling the first SendPacket event.
      */
@@ -67,9 +77,15 @@ class OneShotSender : public Application
     void StopApplication() override;
 
   private:
+    /**
+     * Look the MAC layer up from the node's device, if not done yet.
+     */
+    void EnsureMac();
+
     Time m_sendTime;       //!< The time at which to send the packet.
     EventId m_sendEvent;   //!< The sending event.
     Ptr<LorawanMac> m_mac; //!< The MAC layer of this node.
+    bool m_externallyTriggered; //!< Whether an external dispatcher drives the send.
 };
 
 } // namespace lorawan
@@ -9,6 +9,7 @@
 #include "periodic-sender.h"
 
 #include "lora-net-device.h"
+#include "lora-packet-pool.h"
 
 #include "ns3/double.h"
 #include "ns3/log.h"
@@ -98,16 +99,16 @@ PeriodicSender::SendPacket()
 {
     NS_LOG_FUNCTION(this);
 
-    // Create and send a new packet
+    // Create and send a new packet, recycling the pooled payload buffer
     Ptr<Packet> packet;
     if (m_pktSizeRV)
     {
         int randomsize = m_pktSizeRV->GetInteger();
-        packet = Create<Packet>(m_basePktSize + randomsize);
+        packet = LoraPacketPool::CreatePacket(m_basePktSize + randomsize);
     }
     else
     {
-        packet = Create<Packet>(m_basePktSize);
+        packet = LoraPacketPool::CreatePacket(m_basePktSize);
     }
     m_mac->Send(packet);
 
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#include "periodic-traffic-engine.h"
+
+#include "lora-net-device.h"
+#include "lora-packet-pool.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("PeriodicTrafficEngine");
+
+NS_OBJECT_ENSURE_REGISTERED(PeriodicTrafficEngine);
+
+TypeId
+PeriodicTrafficEngine::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PeriodicTrafficEngine")
+            .SetParent<Object>()
+            .AddConstructor<PeriodicTrafficEngine>()
+            .SetGroupName("lorawan")
+            .AddAttribute("TickDuration",
+                          "Duration of one timer wheel tick. Send times are"
+                          "quantized to this resolution",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&PeriodicTrafficEngine::m_tickDuration),
+                          MakeTimeChecker())
+            .AddAttribute("WheelSize",
+                          "Number of buckets in the timer wheel",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&PeriodicTrafficEngine::m_wheelSize),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+PeriodicTrafficEngine::PeriodicTrafficEngine()
+    : m_tickDuration(Seconds(1)),
+      m_wheelSize(1024),
+      m_currentTick(0),
+      m_nDevices(0)
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+PeriodicTrafficEngine::~PeriodicTrafficEngine()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+void
+PeriodicTrafficEngine::Register(Ptr<Node> node,
+                                Time initialDelay,
+                                Time interval,
+                                uint8_t packetSize,
+                                Ptr<RandomVariableStream> packetSizeRV)
+{
+    NS_LOG_FUNCTION(this << node << initialDelay << interval << unsigned(packetSize));
+
+    if (m_wheel.empty())
+    {
+        m_wheel.resize(m_wheelSize);
+        m_currentTick = uint64_t(Now() / m_tickDuration);
+    }
+
+    Entry entry;
+    entry.node = node;
+    entry.mac = nullptr;
+    entry.nextTick = uint64_t((Now() + initialDelay) / m_tickDuration);
+    entry.intervalTicks = std::max<uint64_t>(uint64_t(interval / m_tickDuration), 1);
+    entry.packetSize = packetSize;
+    entry.packetSizeRV = packetSizeRV;
+
+    // Never schedule in the past with respect to the wheel position
+    entry.nextTick = std::max(entry.nextTick, m_currentTick + 1);
+
+    Insert(entry);
+    m_nDevices++;
+
+    ScheduleNextTick();
+}
+
+uint32_t
+PeriodicTrafficEngine::GetNDevices() const
+{
+    return m_nDevices;
+}
+
+void
+PeriodicTrafficEngine::Insert(Entry entry)
+{
+    m_wheel[entry.nextTick % m_wheelSize].emplace_back(std::move(entry));
+}
+
+void
+PeriodicTrafficEngine::Tick()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_currentTick = uint64_t(Now() / m_tickDuration);
+    auto& bucket = m_wheel[m_currentTick % m_wheelSize];
+
+    // Collect the entries that are due in this tick; entries hashed to this
+    // bucket but due on a later lap stay where they are
+    std::vector<Entry> due;
+    for (auto it = bucket.begin(); it != bucket.end();)
+    {
+        if (it->nextTick <= m_currentTick)
+        {
+            due.emplace_back(std::move(*it));
+            it = bucket.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    NS_LOG_DEBUG("Tick " << m_currentTick << ": " << due.size() << " sends due");
+
+    for (auto& entry : due)
+    {
+        if (!entry.mac)
+        {
+            // Assumes there's only one device, like PeriodicSender does
+            Ptr<LoraNetDevice> loraNetDevice =
+                DynamicCast<LoraNetDevice>(entry.node->GetDevice(0));
+            entry.mac = loraNetDevice->GetMac();
+            NS_ASSERT(entry.mac);
+        }
+
+        // Create and send a new packet, recycling the pooled payload buffer
+        Ptr<Packet> packet;
+        if (entry.packetSizeRV)
+        {
+            int randomsize = entry.packetSizeRV->GetInteger();
+            packet = LoraPacketPool::CreatePacket(entry.packetSize + randomsize);
+        }
+        else
+        {
+            packet = LoraPacketPool::CreatePacket(entry.packetSize);
+        }
+        entry.mac->Send(packet);
+
+        entry.nextTick = m_currentTick + entry.intervalTicks;
+        Insert(std::move(entry));
+    }
+
+    ScheduleNextTick();
+}
+
+void
+PeriodicTrafficEngine::ScheduleNextTick()
+{
+    if (m_tickEvent.IsPending())
+    {
+        return;
+    }
+
+    // Find the next non-empty bucket; a hit may still be a later-lap entry,
+    // in which case Tick simply reschedules, at most once per lap
+    for (uint32_t offset = 1; offset <= m_wheelSize; offset++)
+    {
+        if (!m_wheel[(m_currentTick + offset) % m_wheelSize].empty())
+        {
+            Time delay = Time((m_currentTick + offset) * m_tickDuration.GetTimeStep()) - Now();
+            m_tickEvent =
+                Simulator::Schedule(Max(delay, Time(0)), &PeriodicTrafficEngine::Tick, this);
+            return;
+        }
+    }
+}
+
+} // namespace lorawan
+} // namespace ns3
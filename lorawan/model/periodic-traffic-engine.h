@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2017 University of Padova
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Author: Davide Magrin <magrinda@dei.unipd.it>
+ */
+
+#ifndef PERIODIC_TRAFFIC_ENGINE_H
+#define PERIODIC_TRAFFIC_ENGINE_H
+
+#include "lorawan-mac.h"
+
+#include "ns3/event-id.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * An aggregated periodic traffic generator for large topologies.
+ *
+ * Instead of installing one PeriodicSender application per node, each keeping
+ * its own entry in the simulator event heap, a single PeriodicTrafficEngine
+ * owns a hashed timer wheel of upcoming sends across all registered devices.
+ * One simulator event per wheel tick delivers all packets due in that tick
+ * directly to the devices' MAC layers, so the global event heap holds at most
+ * one entry for application traffic regardless of the number of devices.
+ *
+ * The price is that send times are quantized to the wheel tick duration,
+ * which is configurable through the TickDuration attribute. With the default
+ * of one second this is negligible against typical LoRaWAN send intervals.
+ *
+ * Devices are registered through PeriodicSenderHelper::SetTrafficEngine, or
+ * directly with Register.
+ */
+class PeriodicTrafficEngine : public Object
+{
+  public:
+    /**
+     *  Register this type.
+     *  @return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    PeriodicTrafficEngine();           //!< Default constructor
+    ~PeriodicTrafficEngine() override; //!< Destructor
+
+    /**
+     * Register a node for periodic packet generation.
+     *
+     * The node's MAC layer is resolved lazily at the first send, so devices
+     * may be registered before their LoraNetDevice is fully wired up.
+     *
+     * @param node The node whose MAC will receive the generated packets.
+     * @param initialDelay The delay before the first packet, from now.
+     * @param interval The interval between two packet sends.
+     * @param packetSize The base packet size in bytes.
+     * @param packetSizeRV An optional random variable adding bytes to the
+     * base packet size on each send, may be nullptr.
+     */
+    void Register(Ptr<Node> node,
+                  Time initialDelay,
+                  Time interval,
+                  uint8_t packetSize,
+                  Ptr<RandomVariableStream> packetSizeRV);
+
+    /**
+     * Get the number of devices registered with this engine.
+     *
+     * @return The number of registered devices.
+     */
+    uint32_t GetNDevices() const;
+
+  private:
+    /**
+     * An upcoming send of one registered device.
+     */
+    struct Entry
+    {
+        Ptr<Node> node;        //!< The node to generate traffic for.
+        Ptr<LorawanMac> mac;   //!< The node's MAC layer, resolved at first send.
+        uint64_t nextTick;     //!< The absolute tick of the next send.
+        uint64_t intervalTicks; //!< The send interval, in ticks (at least 1).
+        uint8_t packetSize;    //!< The base packet size in bytes.
+        Ptr<RandomVariableStream> packetSizeRV; //!< Optional random packet size addition.
+    };
+
+    /**
+     * Process all sends due in the current bucket and advance the wheel.
+     */
+    void Tick();
+
+    /**
+     * Schedule the Tick event for the next non-empty bucket, if any.
+     */
+    void ScheduleNextTick();
+
+    /**
+     * Insert an entry into the bucket its next send tick hashes to.
+     *
+     * @param entry The entry to insert.
+     */
+    void Insert(Entry entry);
+
+    Time m_tickDuration;   //!< Duration of one wheel tick.
+    uint32_t m_wheelSize;  //!< Number of buckets in the wheel.
+
+    /**
+     * The timer wheel. Bucket i holds the entries whose next send tick is
+     * congruent to i modulo m_wheelSize; entries due on a later lap are left
+     * in place when their bucket is processed.
+     */
+    std::vector<std::vector<Entry>> m_wheel;
+
+    uint64_t m_currentTick; //!< The tick the wheel has been advanced to.
+    uint32_t m_nDevices;    //!< Number of registered devices.
+    EventId m_tickEvent;    //!< The single pending Tick event.
+};
+
+} // namespace lorawan
+
+} // namespace ns3
+#endif /* PERIODIC_TRAFFIC_ENGINE_H */
@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "position-snapshot.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("PositionSnapshot");
+
+std::vector<PositionSnapshot::Entry> PositionSnapshot::m_entries;
+bool PositionSnapshot::m_clearScheduled = false;
+
+void
+PositionSnapshot::Capture(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    for (auto node = nodes.Begin(); node != nodes.End(); ++node)
+    {
+        Ptr<MobilityModel> mobility = (*node)->GetObject<MobilityModel>();
+        if (!mobility)
+        {
+            continue;
+        }
+        uint32_t nodeId = (*node)->GetId();
+        if (nodeId >= m_entries.size())
+        {
+            m_entries.resize(nodeId + 1);
+        }
+        Entry& entry = m_entries[nodeId];
+        entry.position = mobility->GetPosition();
+        entry.valid = true;
+        if (!entry.hooked)
+        {
+            mobility->TraceConnectWithoutContext("CourseChange",
+                                                 MakeCallback(&PositionSnapshot::OnCourseChange));
+            entry.hooked = true;
+        }
+    }
+
+    if (!m_clearScheduled)
+    {
+        Simulator::ScheduleDestroy(&PositionSnapshot::Clear);
+        m_clearScheduled = true;
+    }
+}
+
+bool
+PositionSnapshot::Covers(uint32_t nodeId)
+{
+    return nodeId < m_entries.size() && m_entries[nodeId].valid;
+}
+
+void
+PositionSnapshot::Clear()
+{
+    m_entries.clear();
+    m_entries.shrink_to_fit();
+    m_clearScheduled = false;
+}
+
+void
+PositionSnapshot::OnCourseChange(Ptr<const MobilityModel> model)
+{
+    Ptr<Node> node = model->GetObject<Node>();
+    if (!node)
+    {
+        return;
+    }
+    uint32_t nodeId = node->GetId();
+    if (nodeId < m_entries.size())
+    {
+        NS_LOG_DEBUG("Node " << nodeId << " moved, dropping its snapshot entry");
+        m_entries[nodeId].valid = false;
+    }
+}
+
+} // namespace lorawan
+} // namespace ns3
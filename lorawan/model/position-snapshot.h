@@ -0,0 +1,106 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef POSITION_SNAPSHOT_H
+#define POSITION_SNAPSHOT_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include "ns3/vector.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Flat position cache for the static nodes of a scenario.
+ *
+ * Positions are fetched all over the module — the channel's spatial index,
+ * the helpers' periodic status printers, setup loops — and every fetch is
+ * a virtual MobilityModel::GetPosition call behind an aggregation lookup.
+ * In the all-static scenarios this module simulates, the answer never
+ * changes, so LoraHelper::Install snapshots it once into a plain array
+ * indexed by node id and Get() becomes two loads and a bounds check.
+ *
+ * Correctness does not rely on nodes actually being static: Capture()
+ * subscribes to each mobility model's CourseChange trace and the first
+ * movement permanently invalidates that node's entry, after which Get()
+ * falls back to the virtual call. The cache is cleared at
+ * Simulator::Destroy so consecutive runs in one process (e.g. the test
+ * suites, which restart node ids from zero) never see stale entries.
+ */
+class PositionSnapshot
+{
+  public:
+    /**
+     * Snapshot the current position of each node and hook its CourseChange
+     * trace. Nodes without a mobility model are skipped; capturing the same
+     * node again refreshes its entry.
+     *
+     * @param nodes The nodes to capture.
+     */
+    static void Capture(NodeContainer nodes);
+
+    /**
+     * Get a node's position, from the snapshot when it is covered and
+     * still valid, through its mobility model otherwise.
+     *
+     * @param node The node.
+     * @return The node's current position.
+     */
+    static Vector Get(Ptr<Node> node)
+    {
+        uint32_t nodeId = node->GetId();
+        if (nodeId < m_entries.size() && m_entries[nodeId].valid)
+        {
+            return m_entries[nodeId].position;
+        }
+        return node->GetObject<MobilityModel>()->GetPosition();
+    }
+
+    /**
+     * Check whether a node has a valid snapshot entry.
+     *
+     * @param nodeId The node id.
+     * @return True if Get() would be answered from the snapshot.
+     */
+    static bool Covers(uint32_t nodeId);
+
+    /**
+     * Drop the whole snapshot. Scheduled at Simulator::Destroy by
+     * Capture(); callers rebuilding a topology mid-run can also invoke it
+     * directly.
+     */
+    static void Clear();
+
+  private:
+    /**
+     * CourseChange sink: the node moved, so stop answering for it.
+     *
+     * @param model The mobility model that fired.
+     */
+    static void OnCourseChange(Ptr<const MobilityModel> model);
+
+    /// One cached position and its bookkeeping flags.
+    struct Entry
+    {
+        Vector position;     //!< Position at capture time
+        bool valid = false;  //!< Whether the cached position may be served
+        bool hooked = false; //!< Whether CourseChange is already connected
+    };
+
+    static std::vector<Entry> m_entries; //!< Cache, indexed by node id
+    static bool m_clearScheduled;        //!< Whether Clear() is pending at destroy time
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif /* POSITION_SNAPSHOT_H */
@@ -8,6 +8,7 @@
 
 #include "simple-end-device-lora-phy.h"
 
+#include "device-registry.h"
 #include "lora-tag.h"
 
 #include "ns3/log.h"
@@ -68,10 +69,16 @@ SimpleEndDeviceLoraPhy::Send(Ptr<Packet> packet,
     // We can send the packet: switch to the TX state
     SwitchToTx(txPowerDbm);
 
-    // Tag the packet with information about its Spreading Factor
+    // Tag the packet with information about its Spreading Factor and the
+    // sender's dense device index, so downstream consumers translate the
+    // sender identity with a flat array load instead of a map lookup
     LoraTag tag;
     packet->RemovePacketTag(tag);
     tag.SetSpreadingFactor(txParams.sf);
+    if (m_device)
+    {
+        tag.SetDeviceIndex(DeviceRegistry::IndexOfNode(m_device->GetNode()->GetId()));
+    }
     packet->AddPacketTag(tag);
 
     // Send the packet over the channel
@@ -82,14 +89,9 @@ SimpleEndDeviceLoraPhy::Send(Ptr<Packet> packet,
     Simulator::Schedule(duration, &SimpleEndDeviceLoraPhy::TxFinished, this, packet);
 
     // Call the trace source
-    if (m_device)
-    {
-        m_startSending(packet, m_device->GetNode()->GetId());
-    }
-    else
-    {
-        m_startSending(packet, 0);
-    }
+    LORAWAN_PHY_TRACE(m_startSending,
+                      packet,
+                      m_device ? m_device->GetNode()->GetId() : 0);
 }
 
 void
@@ -153,14 +155,9 @@ SimpleEndDeviceLoraPhy::StartReceive(Ptr<Packet> packet,
                         << frequencyHz << " Hz and we are listening at " << m_frequencyHz << " Hz");
 
             // Fire the trace source for this event.
-            if (m_device)
-            {
-                m_wrongFrequency(packet, m_device->GetNode()->GetId());
-            }
-            else
-            {
-                m_wrongFrequency(packet, 0);
-            }
+            LORAWAN_PHY_TRACE(m_wrongFrequency,
+                              packet,
+                              m_device ? m_device->GetNode()->GetId() : 0);
 
             canLockOnPacket = false;
         }
@@ -173,14 +170,9 @@ SimpleEndDeviceLoraPhy::StartReceive(Ptr<Packet> packet,
                         << unsigned(sf) << ", while we are listening for SF" << unsigned(m_sf));
 
             // Fire the trace source for this event.
-            if (m_device)
-            {
-                m_wrongSf(packet, m_device->GetNode()->GetId());
-            }
-            else
-            {
-                m_wrongSf(packet, 0);
-            }
+            LORAWAN_PHY_TRACE(m_wrongSf,
+                              packet,
+                              m_device ? m_device->GetNode()->GetId() : 0);
 
             canLockOnPacket = false;
         }
@@ -194,14 +186,9 @@ SimpleEndDeviceLoraPhy::StartReceive(Ptr<Packet> packet,
                         << " dBm");
 
             // Fire the trace source for this event.
-            if (m_device)
-            {
-                m_underSensitivity(packet, m_device->GetNode()->GetId());
-            }
-            else
-            {
-                m_underSensitivity(packet, 0);
-            }
+            LORAWAN_PHY_TRACE(m_underSensitivity,
+                              packet,
+                              m_device ? m_device->GetNode()->GetId() : 0);
 
             canLockOnPacket = false;
         }
@@ -220,7 +207,7 @@ SimpleEndDeviceLoraPhy::StartReceive(Ptr<Packet> packet,
             Simulator::Schedule(duration, &LoraPhy::EndReceive, this, packet, event);
 
             // Fire the beginning of reception trace source
-            m_phyRxBeginTrace(packet);
+            LORAWAN_PHY_TRACE(m_phyRxBeginTrace, packet);
         }
     }
     }
@@ -235,7 +222,7 @@ SimpleEndDeviceLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelpe
     SwitchToStandby();
 
     // Fire the trace source
-    m_phyRxEndTrace(packet);
+    LORAWAN_PHY_TRACE(m_phyRxEndTrace, packet);
 
     // Call the LoraInterferenceHelper to determine whether there was destructive
     // interference on this event.
@@ -246,14 +233,9 @@ SimpleEndDeviceLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelpe
     {
         NS_LOG_INFO("Packet destroyed by interference");
 
-        if (m_device)
-        {
-            m_interferedPacket(packet, m_device->GetNode()->GetId());
-        }
-        else
-        {
-            m_interferedPacket(packet, 0);
-        }
+        LORAWAN_PHY_TRACE(m_interferedPacket,
+                          packet,
+                          m_device ? m_device->GetNode()->GetId() : 0);
 
         // If there is one, perform the callback to inform the upper layer of the
         // lost packet
@@ -266,14 +248,9 @@ SimpleEndDeviceLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelpe
     {
         NS_LOG_INFO("Packet received correctly");
 
-        if (m_device)
-        {
-            m_successfullyReceivedPacket(packet, m_device->GetNode()->GetId());
-        }
-        else
-        {
-            m_successfullyReceivedPacket(packet, 0);
-        }
+        LORAWAN_PHY_TRACE(m_successfullyReceivedPacket,
+                          packet,
+                          m_device ? m_device->GetNode()->GetId() : 0);
 
         // If there is one, perform the callback to inform the upper layer
         if (!m_rxOkCallback.IsNull())
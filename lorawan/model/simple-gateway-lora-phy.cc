@@ -13,6 +13,8 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 
+#include <bit>
+
 namespace ns3
 {
 namespace lorawan
@@ -61,24 +63,17 @@ SimpleGatewayLoraPhy::Send(Ptr<Packet> packet,
     NS_LOG_DEBUG("Duration of packet: " << duration << ", SF" << unsigned(txParams.sf));
 
     // Interrupt all receive operations
-    std::list<Ptr<SimpleGatewayLoraPhy::ReceptionPath>>::iterator it;
-    for (it = m_receptionPaths.begin(); it != m_receptionPaths.end(); ++it)
+    for (uint32_t i = 0; i < m_nReceptionPaths; i++)
     {
-        Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = *it;
+        Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = m_receptionPaths[i];
 
         if (!currentPath->IsAvailable()) // Reception path is occupied
         {
             // Call the callback for reception interrupted by transmission
             // Fire the trace source
-            if (m_device)
-            {
-                m_noReceptionBecauseTransmitting(currentPath->GetEvent()->GetPacket(),
-                                                 m_device->GetNode()->GetId());
-            }
-            else
-            {
-                m_noReceptionBecauseTransmitting(currentPath->GetEvent()->GetPacket(), 0);
-            }
+            LORAWAN_PHY_TRACE(m_noReceptionBecauseTransmitting,
+                              currentPath->GetEvent()->GetPacket(),
+                              m_device ? m_device->GetNode()->GetId() : 0);
 
             // Cancel the scheduled EndReceive call
             Simulator::Cancel(currentPath->GetEndReceive());
@@ -86,6 +81,7 @@ SimpleGatewayLoraPhy::Send(Ptr<Packet> packet,
             // Free it
             // This also resets all parameters like packet and endReceive call
             currentPath->Free();
+            m_freeReceptionPathsMask |= uint8_t(1 << i);
         }
     }
 
@@ -97,14 +93,9 @@ SimpleGatewayLoraPhy::Send(Ptr<Packet> packet,
     m_isTransmitting = true;
 
     // Fire the trace source
-    if (m_device)
-    {
-        m_startSending(packet, m_device->GetNode()->GetId());
-    }
-    else
-    {
-        m_startSending(packet, 0);
-    }
+    LORAWAN_PHY_TRACE(m_startSending,
+                      packet,
+                      m_device ? m_device->GetNode()->GetId() : 0);
 }
 
 void
@@ -117,7 +108,7 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
     NS_LOG_FUNCTION(this << packet << rxPowerDbm << duration << frequencyHz);
 
     // Fire the trace source
-    m_phyRxBeginTrace(packet);
+    LORAWAN_PHY_TRACE(m_phyRxBeginTrace, packet);
 
     if (m_isTransmitting)
     {
@@ -125,17 +116,12 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
         NS_LOG_INFO("Dropping packet reception of packet with sf = "
                     << unsigned(sf) << " because we are in TX mode");
 
-        m_phyRxEndTrace(packet);
+        LORAWAN_PHY_TRACE(m_phyRxEndTrace, packet);
 
         // Fire the trace source
-        if (m_device)
-        {
-            m_noReceptionBecauseTransmitting(packet, m_device->GetNode()->GetId());
-        }
-        else
-        {
-            m_noReceptionBecauseTransmitting(packet, 0);
-        }
+        LORAWAN_PHY_TRACE(m_noReceptionBecauseTransmitting,
+                          packet,
+                          m_device ? m_device->GetNode()->GetId() : 0);
 
         return;
     }
@@ -144,80 +130,62 @@ SimpleGatewayLoraPhy::StartReceive(Ptr<Packet> packet,
     Ptr<LoraInterferenceHelper::Event> event;
     event = m_interference.Add(duration, rxPowerDbm, sf, packet, frequencyHz);
 
-    // Cycle over the receive paths to check availability to receive the packet
-    std::list<Ptr<SimpleGatewayLoraPhy::ReceptionPath>>::iterator it;
-
-    for (it = m_receptionPaths.begin(); it != m_receptionPaths.end(); ++it)
+    // Check the occupancy bitmask for an available demodulator
+    if (m_freeReceptionPathsMask == 0)
     {
-        Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = *it;
+        // If we get to this point, there are no demodulators we can use
+        NS_LOG_INFO("Dropping packet reception of packet with sf = "
+                    << unsigned(sf) << " and frequency " << frequencyHz
+                    << "Hz because no suitable demodulator was found");
 
-        // If the receive path is available and listening on the channel of
-        // interest, we have a candidate
-        if (currentPath->IsAvailable())
-        {
-            // See whether the reception power is above or below the sensitivity
-            // for that spreading factor
-            double sensitivity = SimpleGatewayLoraPhy::sensitivity[unsigned(sf) - 7];
-
-            if (rxPowerDbm < sensitivity) // Packet arrived below sensitivity
-            {
-                NS_LOG_INFO("Dropping packet reception of packet with sf = "
-                            << unsigned(sf) << " because under the sensitivity of " << sensitivity
-                            << " dBm");
-
-                if (m_device)
-                {
-                    m_underSensitivity(packet, m_device->GetNode()->GetId());
-                }
-                else
-                {
-                    m_underSensitivity(packet, 0);
-                }
-
-                // Since the packet is below sensitivity, it makes no sense to
-                // search for another ReceivePath
-                return;
-            }
-            else // We have sufficient sensitivity to start receiving
-            {
-                NS_LOG_INFO("Scheduling reception of a packet, occupying one demodulator");
-
-                // Block this resource
-                currentPath->LockOnEvent(event);
-                m_occupiedReceptionPaths++;
-
-                // Schedule the end of the reception of the packet
-                EventId endReceiveEventId =
-                    Simulator::Schedule(duration, &LoraPhy::EndReceive, this, packet, event);
-
-                currentPath->SetEndReceive(endReceiveEventId);
-
-                // Make sure we don't go on searching for other ReceivePaths
-                return;
-            }
-        }
-    }
-    // If we get to this point, there are no demodulators we can use
-    NS_LOG_INFO("Dropping packet reception of packet with sf = "
-                << unsigned(sf) << " and frequency " << frequencyHz
-                << "Hz because no suitable demodulator was found");
+        // Fire the trace source
+        LORAWAN_PHY_TRACE(m_noMoreDemodulators,
+                          packet,
+                          m_device ? m_device->GetNode()->GetId() : 0);
 
-    // Fire the trace source
-    if (m_device)
-    {
-        m_noMoreDemodulators(packet, m_device->GetNode()->GetId());
+        return;
     }
-    else
+
+    // See whether the reception power is above or below the sensitivity
+    // for that spreading factor
+    double sensitivity = SimpleGatewayLoraPhy::sensitivity[unsigned(sf) - 7];
+
+    if (rxPowerDbm < sensitivity) // Packet arrived below sensitivity
     {
-        m_noMoreDemodulators(packet, 0);
+        NS_LOG_INFO("Dropping packet reception of packet with sf = "
+                    << unsigned(sf) << " because under the sensitivity of " << sensitivity
+                    << " dBm");
+
+        LORAWAN_PHY_TRACE(m_underSensitivity,
+                          packet,
+                          m_device ? m_device->GetNode()->GetId() : 0);
+
+        return;
     }
+
+    NS_LOG_INFO("Scheduling reception of a packet, occupying one demodulator");
+
+    // The first free demodulator is the lowest set bit of the mask
+    auto slot = uint32_t(std::countr_zero(m_freeReceptionPathsMask));
+    Ptr<SimpleGatewayLoraPhy::ReceptionPath> currentPath = m_receptionPaths[slot];
+
+    // Block this resource
+    currentPath->LockOnEvent(event);
+    m_freeReceptionPathsMask &= uint8_t(~(1 << slot));
+    m_occupiedReceptionPaths++;
+
+    // Schedule the end of the reception of the packet
+    EventId endReceiveEventId =
+        Simulator::Schedule(duration, &LoraPhy::EndReceive, this, packet, event);
+
+    currentPath->SetEndReceive(endReceiveEventId);
 }
 
 void
 SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper::Event> event)
 {
     NS_LOG_FUNCTION(this << packet << *event);
-    m_phyRxEndTrace(packet);
+    LORAWAN_PHY_TRACE(m_phyRxEndTrace, packet);
 
     uint8_t packetDestroyed = m_interference.IsDestroyedByInterference(event);
 
@@ -230,7 +198,7 @@ SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper:
         packet->AddPacketTag(tag);
         if (m_device)
         {
-            m_interferedPacket(packet, m_device->GetNode()->GetId());
+            LORAWAN_PHY_TRACE(m_interferedPacket, packet, m_device->GetNode()->GetId());
         }
     }
     else // Reception was correct
@@ -240,7 +208,7 @@ SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper:
         // Fire original trace
         if (m_device)
         {
-            m_successfullyReceivedPacket(packet, m_device->GetNode()->GetId());
+            LORAWAN_PHY_TRACE(m_successfullyReceivedPacket, packet, m_device->GetNode()->GetId());
         }
 
         // --- CORRECTED TRACE FIRING ---
@@ -254,7 +222,7 @@ SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper:
         // Fire the new trace with all four arguments
         if (m_device)
         {
-             m_phyRxOkRssiSnir(packet, rssi, snir, m_device->GetNode()->GetId());
+            LORAWAN_PHY_TRACE(m_phyRxOkRssiSnir, packet, rssi, snir, m_device->GetNode()->GetId());
         }
         // --- END CORRECTION ---
 
@@ -270,12 +238,13 @@ SimpleGatewayLoraPhy::EndReceive(Ptr<Packet> packet, Ptr<LoraInterferenceHelper:
         }
     }
 
-    // Free the demodulator
-    for (auto it = m_receptionPaths.begin(); it != m_receptionPaths.end(); ++it)
+    // Free the demodulator that was locked on this event
+    for (uint32_t i = 0; i < m_nReceptionPaths; i++)
     {
-        if ((*it)->GetEvent() == event)
+        if (m_receptionPaths[i]->GetEvent() == event)
         {
-            (*it)->Free();
+            m_receptionPaths[i]->Free();
+            m_freeReceptionPathsMask |= uint8_t(1 << i);
             m_occupiedReceptionPaths--;
             return;
         }
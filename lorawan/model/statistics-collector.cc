@@ -3,13 +3,16 @@
 // =====================================================
 
 #include "statistics-collector.h"
+#include "ns3/device-registry.h"
 #include "ns3/log.h"
 #include "ns3/end-device-lorawan-mac.h"
 #include "ns3/simulator.h"
 #include "ns3/lorawan-mac-header.h"
 #include "ns3/lora-frame-header.h"
 #include "ns3/address.h"
+#include "ns3/memory-report.h"
 #include <iomanip>
+#include <sstream>
 #include <numeric>
 #include <algorithm>
 #include <cmath>
@@ -66,6 +69,10 @@ StatisticsCollectorComponent::StatisticsCollectorComponent()
 StatisticsCollectorComponent::~StatisticsCollectorComponent()
 {
     NS_LOG_FUNCTION(this);
+    m_csvWriter.Stop();
+    m_radioMeasurementCsvWriter.Stop();
+    m_binaryExportWriter.Stop();
+    DisableReceptionEventSpill();
 }
 
 // *** FIXED: Radio measurement recording ***
@@ -88,30 +95,32 @@ void StatisticsCollectorComponent::RecordRadioMeasurement(uint32_t deviceAddr, u
     measurement.txPower = txPower;
     measurement.frequency = frequency;
     
-    // Update device statistics
+    // Update device statistics: streaming aggregates are always on, the raw
+    // ring only when a history depth was opted into
     auto& devStats = m_deviceStats[deviceAddr];
-    devStats.rssiHistory.push_back(measurement);
-    devStats.snrHistory.push_back(measurement);
-    
-    // Limit history size to prevent memory issues
-    const uint32_t maxHistorySize = 1000;
-    if (devStats.rssiHistory.size() > maxHistorySize) {
-        devStats.rssiHistory.pop_front();
-        devStats.snrHistory.pop_front();
+    devStats.rssiAgg.Push(rssi);
+    devStats.snrAgg.Push(snr);
+    devStats.rssiSketch.Push(rssi);
+    devStats.snrSketch.Push(snr);
+    if (m_rawHistoryDepth > 0 && ShouldExportMeasurement(devStats, snr)) {
+        devStats.rawHistory.push_back(measurement);
+        while (devStats.rawHistory.size() > m_rawHistoryDepth) {
+            devStats.rawHistory.pop_front();
+        }
     }
-    
+
     // Update gateway statistics
-    auto& gwStats = m_gatewayStats[gatewayId];
-    gwStats.measurementHistory.push_back(measurement);
+    auto& gwStats = GatewayStatsFor(gatewayId);
+    gwStats.rssiAgg.Push(rssi);
+    gwStats.snrAgg.Push(snr);
+    gwStats.rssiSketch.Push(rssi);
+    gwStats.snrSketch.Push(snr);
     gwStats.totalMeasurements++;
-    
-    if (gwStats.measurementHistory.size() > maxHistorySize) {
-        gwStats.measurementHistory.pop_front();
-    }
-    
+
     // Update packet tracking stats
     auto& pktStats = m_packetTrackingStats[deviceAddr];
-    pktStats.perGatewayMeasurements[gatewayId].push_back(measurement);
+    pktStats.perGatewayRssi[gatewayId].Push(rssi);
+    pktStats.perGatewaySnr[gatewayId].Push(snr);
     
     // Update running averages and extremes
     UpdateRadioStatistics(deviceAddr);
@@ -132,77 +141,122 @@ void StatisticsCollectorComponent::RecordPacketReception(const PacketReceptionEv
     m_packetReceptionHistory.push_back(event);
     
     // Limit history size
-    if (m_packetReceptionHistory.size() > m_maxHistorySize) {
+    while (m_packetReceptionHistory.size() > m_maxHistorySize) {
         m_packetReceptionHistory.pop_front();
     }
+
+    // Spill the full event to disk, one row per gateway measurement, so the
+    // ring bound costs no forensic detail
+    if (m_spillEnabled) {
+        double eventTime = event.timestamp.GetSeconds();
+        for (const auto& m : event.gatewayMeasurements) {
+            m_spillFormatter.AppendRow({eventTime,
+                                        static_cast<double>(event.deviceAddr),
+                                        static_cast<double>(m.gatewayId),
+                                        m.rssi,
+                                        m.snr,
+                                        m.snir,
+                                        static_cast<double>(event.spreadingFactor),
+                                        event.txPower,
+                                        static_cast<double>(m.frequency),
+                                        event.successful ? 1.0 : 0.0});
+        }
+        if (++m_spillRowsBuffered >= SPILL_BLOCK_ROWS) {
+            m_spillWriter.Submit(m_spillFormatter.SerializeBlock());
+            m_spillRowsBuffered = 0;
+        }
+    }
     
     NS_LOG_DEBUG("Recorded packet reception event for device " << event.deviceAddr 
                 << " with " << event.gatewayMeasurements.size() << " gateway measurements");
 }
 
+void StatisticsCollectorComponent::SetPacketReceptionHistoryDepth(uint32_t depth)
+{
+    NS_LOG_FUNCTION(this << depth);
+
+    m_maxHistorySize = depth;
+    while (m_packetReceptionHistory.size() > m_maxHistorySize) {
+        m_packetReceptionHistory.pop_front();
+    }
+}
+
+void StatisticsCollectorComponent::EnableReceptionEventSpill(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    if (m_spillEnabled) {
+        DisableReceptionEventSpill();
+    }
+
+    m_spillFormatter.SetColumns({"Time", "DeviceAddr", "GatewayID", "RSSI", "SNR", "SNIR",
+                                 "SF", "TxPower", "Frequency", "Successful"});
+    m_spillWriter.Start(filename, true);
+    m_spillWriter.Submit(m_spillFormatter.SerializeHeader());
+    m_spillRowsBuffered = 0;
+    m_spillEnabled = true;
+
+    NS_LOG_INFO("Reception event spill enabled: " << filename);
+}
+
+void StatisticsCollectorComponent::DisableReceptionEventSpill()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_spillEnabled) {
+        return;
+    }
+    m_spillEnabled = false;
+    std::string lastBlock = m_spillFormatter.SerializeBlock();
+    if (!lastBlock.empty()) {
+        m_spillWriter.Submit(std::move(lastBlock));
+    }
+    m_spillWriter.Stop(); // Flushes whatever is still buffered
+    NS_LOG_INFO("Reception event spill disabled");
+}
+
 void StatisticsCollectorComponent::UpdateRadioStatistics(uint32_t deviceAddr)
 {
     auto& devStats = m_deviceStats[deviceAddr];
-    
-    if (devStats.rssiHistory.empty()) {
+
+    if (devStats.rssiAgg.count == 0) {
         return;
     }
-    
-    // Calculate averages
-    double rssiSum = 0.0, snrSum = 0.0;
-    uint32_t count = 0;
-    
-    // Initialize extremes with first measurement
-    double bestRssi = devStats.rssiHistory.front().rssi;
-    double worstRssi = devStats.rssiHistory.front().rssi;
-    double bestSnr = devStats.snrHistory.front().snr;
-    double worstSnr = devStats.snrHistory.front().snr;
-    
-    for (const auto& measurement : devStats.rssiHistory) {
-        rssiSum += measurement.rssi;
-        snrSum += measurement.snr;
-        count++;
-        
-        // Update extremes
-        if (measurement.rssi > bestRssi) bestRssi = measurement.rssi;
-        if (measurement.rssi < worstRssi) worstRssi = measurement.rssi;
-        if (measurement.snr > bestSnr) bestSnr = measurement.snr;
-        if (measurement.snr < worstSnr) worstSnr = measurement.snr;
-    }
-    
-    if (count > 0) {
-        devStats.averageRssi = rssiSum / count;
-        devStats.averageSnr = snrSum / count;
-        devStats.bestRssi = bestRssi;
-        devStats.worstRssi = worstRssi;
-        devStats.bestSnr = bestSnr;
-        devStats.worstSnr = worstSnr;
-        
-        // Fire link quality trace
-        m_linkQualityTrace(deviceAddr, devStats.averageRssi, devStats.averageSnr);
-    }
+
+    // The streaming aggregates were advanced when the measurement was
+    // recorded; just publish them
+    devStats.averageRssi = devStats.rssiAgg.mean;
+    devStats.averageSnr = devStats.snrAgg.mean;
+    devStats.bestRssi = devStats.rssiAgg.max;
+    devStats.worstRssi = devStats.rssiAgg.min;
+    devStats.bestSnr = devStats.snrAgg.max;
+    devStats.worstSnr = devStats.snrAgg.min;
+
+    // Fire link quality trace
+    m_linkQualityTrace(deviceAddr, devStats.averageRssi, devStats.averageSnr);
 }
 
 void StatisticsCollectorComponent::UpdateGatewayStatistics(uint32_t gatewayId)
 {
-    auto& gwStats = m_gatewayStats[gatewayId];
-    
-    if (gwStats.measurementHistory.empty()) {
+    auto& gwStats = GatewayStatsFor(gatewayId);
+
+    if (gwStats.rssiAgg.count == 0) {
         return;
     }
-    
-    double rssiSum = 0.0, snrSum = 0.0;
-    uint32_t count = 0;
-    
-    for (const auto& measurement : gwStats.measurementHistory) {
-        rssiSum += measurement.rssi;
-        snrSum += measurement.snr;
-        count++;
-    }
-    
-    if (count > 0) {
-        gwStats.averageRssi = rssiSum / count;
-        gwStats.averageSnr = snrSum / count;
+
+    gwStats.averageRssi = gwStats.rssiAgg.mean;
+    gwStats.averageSnr = gwStats.snrAgg.mean;
+}
+
+void StatisticsCollectorComponent::SetRawMeasurementHistoryDepth(uint32_t depth)
+{
+    NS_LOG_FUNCTION(this << depth);
+
+    m_rawHistoryDepth = depth;
+    if (depth == 0) {
+        for (auto& devicePair : m_deviceStats) {
+            devicePair.second.rawHistory.clear();
+        }
     }
 }
 
@@ -223,13 +277,16 @@ void StatisticsCollectorComponent::EnableRadioMeasurementCsv(const std::string&
     m_radioMeasurementCsvFilename = filename;
     m_radioMeasurementCsvIntervalSeconds = intervalSeconds;
     m_radioMeasurementCsvHeaderWritten = false;
-    
-    // Initialize the CSV file
-    std::ofstream csvFile(m_radioMeasurementCsvFilename, std::ios::trunc);
-    if (csvFile.is_open()) {
-        csvFile.close();
+
+    // The per-measurement export needs raw rows; opt into a bounded ring if
+    // the caller has not chosen a depth already
+    if (m_rawHistoryDepth == 0) {
+        m_rawHistoryDepth = 1000;
     }
     
+    // Hand the file to the background writer
+    m_radioMeasurementCsvWriter.Start(m_radioMeasurementCsvFilename);
+
     // Schedule the first write
     ScheduleNextRadioMeasurementWrite();
     
@@ -240,22 +297,82 @@ void StatisticsCollectorComponent::DisableRadioMeasurementCsv()
 {
     NS_LOG_FUNCTION(this);
     m_radioMeasurementCsvEnabled = false;
+    m_radioMeasurementCsvWriter.Stop(); // Flushes whatever is still buffered
     NS_LOG_INFO("Radio measurement CSV export disabled");
 }
 
+void StatisticsCollectorComponent::SetAdaptiveRadioSampling(uint32_t decimation,
+                                                            double stableSnrStdDevDb,
+                                                            double resumeSnrDeltaDb)
+{
+    NS_LOG_FUNCTION(this << decimation << stableSnrStdDevDb << resumeSnrDeltaDb);
+    m_adaptiveSamplingDecimation = decimation;
+    m_stableSnrStdDevDb = stableSnrStdDevDb;
+    m_resumeSnrDeltaDb = resumeSnrDeltaDb;
+}
+
+bool StatisticsCollectorComponent::ShouldExportMeasurement(DeviceStats& devStats, double snr)
+{
+    if (m_adaptiveSamplingDecimation <= 1) {
+        return true;
+    }
+
+    // Short-window EWMAs of the SNR and of its squared deviation: a cheap
+    // per-measurement proxy for "is this link still moving"
+    constexpr double ALPHA = 0.125;
+    if (!devStats.snrEwmaSeeded) {
+        devStats.snrEwma = snr;
+        devStats.snrEwmaVar = 0.0;
+        devStats.snrEwmaSeeded = true;
+        return true;
+    }
+    double deviation = snr - devStats.snrEwma;
+    devStats.snrEwma += ALPHA * deviation;
+    devStats.snrEwmaVar = (1.0 - ALPHA) * (devStats.snrEwmaVar + ALPHA * deviation * deviation);
+
+    // Change-triggered resumption: an SNR jump away from the running mean
+    // puts the device back on the full rate (ADR adjustments do the same
+    // from RecordAdrAdjustment)
+    double stableVariance = m_stableSnrStdDevDb * m_stableSnrStdDevDb;
+    if (std::abs(deviation) > m_resumeSnrDeltaDb ||
+        (devStats.samplingStable && devStats.snrEwmaVar > 4.0 * stableVariance)) {
+        devStats.samplingStable = false;
+        devStats.decimationPhase = 0;
+        return true;
+    }
+
+    if (!devStats.samplingStable) {
+        if (devStats.snrEwmaVar < stableVariance) {
+            devStats.samplingStable = true;
+            devStats.decimationPhase = 0;
+        }
+        // Full rate while unstable, including the transition measurement
+        return true;
+    }
+
+    // Stable: keep one measurement per decimation cycle
+    if (++devStats.decimationPhase >= m_adaptiveSamplingDecimation) {
+        devStats.decimationPhase = 0;
+        return true;
+    }
+    m_measurementsDecimated++;
+    return false;
+}
+
+uint64_t StatisticsCollectorComponent::GetMeasurementsDecimated() const
+{
+    return m_measurementsDecimated;
+}
+
 void StatisticsCollectorComponent::WriteRadioMeasurementCsv()
 {
     if (!m_radioMeasurementCsvEnabled) {
         return;
     }
-    
-    std::ofstream csvFile(m_radioMeasurementCsvFilename, std::ios::app);
-    
-    if (!csvFile.is_open()) {
-        NS_LOG_ERROR("Could not open radio measurement CSV file: " << m_radioMeasurementCsvFilename);
-        return;
-    }
-    
+
+    // Format into a memory buffer; see WriteCsvData
+    std::ostringstream csvFile;
+
     // Write header once
     if (!m_radioMeasurementCsvHeaderWritten) {
         csvFile << "Time,DeviceAddr,GatewayID,RSSI_dBm,SNR_dB,SNIR_dB,SpreadingFactor,TxPower_dBm,Frequency_Hz,GatewayPosition,PacketSuccess" << std::endl;
@@ -267,34 +384,40 @@ void StatisticsCollectorComponent::WriteRadioMeasurementCsv()
         uint32_t deviceAddr = devicePair.first;
         const auto& devStats = devicePair.second;
         
-        // Export recent measurements (last interval)
+        // Export recent measurements (last interval); binary search the
+        // time-ordered ring for the start of the window
         Time cutoffTime = Simulator::Now() - Seconds(m_radioMeasurementCsvIntervalSeconds);
-        
-        for (const auto& measurement : devStats.rssiHistory) {
-            if (measurement.timestamp >= cutoffTime) {
-                // Get gateway position
-                std::string gwPosition = "Unknown";
-                auto gwIt = m_gatewayStats.find(measurement.gatewayId);
-                if (gwIt != m_gatewayStats.end()) {
-                    gwPosition = gwIt->second.position;
-                }
-                
-                csvFile << std::fixed << std::setprecision(1) << measurement.timestamp.GetSeconds() << ","
-                        << deviceAddr << ","
-                        << measurement.gatewayId << ","
-                        << std::setprecision(2) << measurement.rssi << ","
-                        << std::setprecision(2) << measurement.snr << ","
-                        << std::setprecision(2) << measurement.snir << ","
-                        << static_cast<uint32_t>(measurement.spreadingFactor) << ","
-                        << std::setprecision(1) << measurement.txPower << ","
-                        << measurement.frequency << ","
-                        << "\"" << gwPosition << "\","
-                        << "1" << std::endl; // Assuming successful if we have measurement
+
+        auto first = std::lower_bound(
+            devStats.rawHistory.begin(),
+            devStats.rawHistory.end(),
+            cutoffTime,
+            [](const RadioMeasurement& m, const Time& t) { return m.timestamp < t; });
+        for (auto measurementIt = first; measurementIt != devStats.rawHistory.end();
+             ++measurementIt) {
+            const auto& measurement = *measurementIt;
+
+            // Get gateway position
+            std::string gwPosition = "Unknown";
+            if (measurement.gatewayId < m_gatewayStats.size()) {
+                gwPosition = m_gatewayStats[measurement.gatewayId].position;
             }
+
+            csvFile << std::fixed << std::setprecision(1) << measurement.timestamp.GetSeconds() << ","
+                    << deviceAddr << ","
+                    << measurement.gatewayId << ","
+                    << std::setprecision(2) << measurement.rssi << ","
+                    << std::setprecision(2) << measurement.snr << ","
+                    << std::setprecision(2) << measurement.snir << ","
+                    << static_cast<uint32_t>(measurement.spreadingFactor) << ","
+                    << std::setprecision(1) << measurement.txPower << ","
+                    << measurement.frequency << ","
+                    << "\"" << gwPosition << "\","
+                    << "1" << std::endl; // Assuming successful if we have measurement
         }
     }
-    
-    csvFile.close();
+
+    m_radioMeasurementCsvWriter.Submit(csvFile.str());
 }
 
 void StatisticsCollectorComponent::ScheduleNextRadioMeasurementWrite()
@@ -315,15 +438,19 @@ StatisticsCollectorComponent::GetRecentMeasurements(uint32_t deviceAddr, Time ti
     
     auto it = m_deviceStats.find(deviceAddr);
     if (it != m_deviceStats.end()) {
+        const auto& history = it->second.rawHistory;
         Time cutoffTime = Simulator::Now() - timeWindow;
-        
-        for (const auto& measurement : it->second.rssiHistory) {
-            if (measurement.timestamp >= cutoffTime) {
-                recentMeasurements.push_back(measurement);
-            }
-        }
+
+        // Measurements are appended in nondecreasing timestamp order, so the
+        // window is the suffix starting at the binary-searched cutoff
+        auto first = std::lower_bound(
+            history.begin(),
+            history.end(),
+            cutoffTime,
+            [](const RadioMeasurement& m, const Time& t) { return m.timestamp < t; });
+        recentMeasurements.assign(first, history.end());
     }
-    
+
     return recentMeasurements;
 }
 
@@ -362,20 +489,13 @@ StatisticsCollectorComponent::GetPerGatewayAverageRssi(uint32_t deviceAddr) cons
     
     auto it = m_packetTrackingStats.find(deviceAddr);
     if (it != m_packetTrackingStats.end()) {
-        for (const auto& gwPair : it->second.perGatewayMeasurements) {
-            uint32_t gatewayId = gwPair.first;
-            const auto& measurements = gwPair.second;
-            
-            if (!measurements.empty()) {
-                double sum = 0.0;
-                for (const auto& measurement : measurements) {
-                    sum += measurement.rssi;
-                }
-                perGatewayRssi[gatewayId] = sum / measurements.size();
+        for (const auto& gwPair : it->second.perGatewayRssi) {
+            if (gwPair.second.count > 0) {
+                perGatewayRssi[gwPair.first] = gwPair.second.mean;
             }
         }
     }
-    
+
     return perGatewayRssi;
 }
 
@@ -386,20 +506,13 @@ StatisticsCollectorComponent::GetPerGatewayAverageSnr(uint32_t deviceAddr) const
     
     auto it = m_packetTrackingStats.find(deviceAddr);
     if (it != m_packetTrackingStats.end()) {
-        for (const auto& gwPair : it->second.perGatewayMeasurements) {
-            uint32_t gatewayId = gwPair.first;
-            const auto& measurements = gwPair.second;
-            
-            if (!measurements.empty()) {
-                double sum = 0.0;
-                for (const auto& measurement : measurements) {
-                    sum += measurement.snr;
-                }
-                perGatewaySnr[gatewayId] = sum / measurements.size();
+        for (const auto& gwPair : it->second.perGatewaySnr) {
+            if (gwPair.second.count > 0) {
+                perGatewaySnr[gwPair.first] = gwPair.second.mean;
             }
         }
     }
-    
+
     return perGatewaySnr;
 }
 
@@ -432,7 +545,7 @@ void StatisticsCollectorComponent::OnReceivedPacket(Ptr<const Packet> packet,
     devicePackets.push_back(std::make_pair(packetId, currentTime));
     
     // Process radio measurements from received packet list
-    auto receivedPacketList = status->GetReceivedPacketList();
+    const auto& receivedPacketList = status->GetReceivedPacketList();
     if (!receivedPacketList.empty()) {
         const auto& latestPacket = receivedPacketList.back().second;
         
@@ -512,6 +625,11 @@ void StatisticsCollectorComponent::RecordAdrAdjustment(uint32_t deviceAddr, uint
         devStats.currentNbTrans = newNbTrans;
         devStats.adrAdjustmentCount++;
         devStats.lastNbTransChange = Simulator::Now();
+
+        // *** NEW: The ADR state changed: put the device back on the
+        // full-rate measurement export until its link settles again ***
+        devStats.samplingStable = false;
+        devStats.decimationPhase = 0;
         
         // Fire trace
         m_nbTransChangedTrace(deviceAddr, oldNbTrans, newNbTrans);
@@ -526,7 +644,7 @@ void StatisticsCollectorComponent::RecordGatewayReception(uint32_t gatewayId, co
 {
     NS_LOG_FUNCTION(this << gatewayId << position);
     
-    auto& gwStats = m_gatewayStats[gatewayId];
+    auto& gwStats = GatewayStatsFor(gatewayId);
     gwStats.packetsReceived++;
     gwStats.lastReceptionTime = Simulator::Now();
     
@@ -552,7 +670,10 @@ void StatisticsCollectorComponent::EnableAutomaticCsvExport(const std::string& f
     m_csvFilename = filename;
     m_csvIntervalSeconds = intervalSeconds;
     m_csvHeaderWritten = false;
-    
+
+    // Hand the file to the background writer
+    m_csvWriter.Start(m_csvFilename);
+
     // Schedule the first write
     ScheduleNextCsvWrite();
     
@@ -563,9 +684,42 @@ void StatisticsCollectorComponent::DisableAutomaticCsvExport()
 {
     NS_LOG_FUNCTION(this);
     m_csvExportEnabled = false;
+    m_csvWriter.Stop(); // Flushes whatever is still buffered
     NS_LOG_INFO("Automatic CSV export disabled");
 }
 
+void StatisticsCollectorComponent::EnableAutomaticBinaryExport(const std::string& filename, uint32_t intervalSeconds)
+{
+    NS_LOG_FUNCTION(this << filename << intervalSeconds);
+
+    m_binaryExportEnabled = true;
+    m_binaryFilename = filename;
+    m_binaryIntervalSeconds = intervalSeconds;
+    m_binaryHeaderWritten = false;
+
+    // Same numeric content as the CSV export; the string distribution columns
+    // (SF/TxPower breakdown, position labels) stay CSV-only
+    m_binaryFormatter.SetColumns({"Time", "DeviceType", "DeviceID", "NodeID",
+                                  "PacketsSent", "PacketsReceived", "PDR", "NbTrans",
+                                  "Efficiency", "AdrAdjustments", "GatewayDiversity",
+                                  "AvgRSSI", "AvgSNR", "BestRSSI", "WorstRSSI",
+                                  "BestSNR", "WorstSNR"});
+
+    m_binaryExportWriter.Start(m_binaryFilename, true);
+
+    ScheduleNextBinaryWrite();
+
+    NS_LOG_INFO("Automatic binary export enabled: " << filename << " every " << intervalSeconds << " seconds");
+}
+
+void StatisticsCollectorComponent::DisableAutomaticBinaryExport()
+{
+    NS_LOG_FUNCTION(this);
+    m_binaryExportEnabled = false;
+    m_binaryExportWriter.Stop(); // Flushes whatever is still buffered
+    NS_LOG_INFO("Automatic binary export disabled");
+}
+
 uint8_t StatisticsCollectorComponent::GetCurrentNbTrans(uint32_t deviceAddr) const
 {
     auto it = m_deviceStats.find(deviceAddr);
@@ -607,12 +761,75 @@ StatisticsCollectorComponent::GetDeviceStats(uint32_t deviceAddr) const
 std::vector<uint32_t> StatisticsCollectorComponent::GetTrackedDevices() const
 {
     std::vector<uint32_t> devices;
+    devices.reserve(m_deviceStats.size());
     for (const auto& pair : m_deviceStats) {
         devices.push_back(pair.first);
     }
+    // Keep the API output stable now that the underlying map is unordered
+    std::sort(devices.begin(), devices.end());
     return devices;
 }
 
+double StatisticsCollectorComponent::GetDeviceRssiQuantile(uint32_t deviceAddr, double quantile) const
+{
+    auto it = m_deviceStats.find(deviceAddr);
+    return (it != m_deviceStats.end()) ? it->second.rssiSketch.Quantile(quantile) : -999.0;
+}
+
+double StatisticsCollectorComponent::GetDeviceSnrQuantile(uint32_t deviceAddr, double quantile) const
+{
+    auto it = m_deviceStats.find(deviceAddr);
+    return (it != m_deviceStats.end()) ? it->second.snrSketch.Quantile(quantile) : -999.0;
+}
+
+double StatisticsCollectorComponent::GetGatewayRssiQuantile(uint32_t gatewayId, double quantile) const
+{
+    return (gatewayId < m_gatewayStats.size())
+               ? m_gatewayStats[gatewayId].rssiSketch.Quantile(quantile)
+               : -999.0;
+}
+
+double StatisticsCollectorComponent::GetGatewaySnrQuantile(uint32_t gatewayId, double quantile) const
+{
+    return (gatewayId < m_gatewayStats.size())
+               ? m_gatewayStats[gatewayId].snrSketch.Quantile(quantile)
+               : -999.0;
+}
+
+StatisticsCollectorComponent::QuantileSketch
+StatisticsCollectorComponent::ComputeNetworkRssiSketch() const
+{
+    QuantileSketch sketch{-150.0, 0.0};
+    for (const auto& pair : m_deviceStats) {
+        sketch.Merge(pair.second.rssiSketch);
+    }
+    return sketch;
+}
+
+StatisticsCollectorComponent::QuantileSketch
+StatisticsCollectorComponent::ComputeNetworkSnrSketch() const
+{
+    QuantileSketch sketch{-30.0, 25.0};
+    for (const auto& pair : m_deviceStats) {
+        sketch.Merge(pair.second.snrSketch);
+    }
+    return sketch;
+}
+
+StatisticsCollectorComponent::QuantileSketch
+StatisticsCollectorComponent::ComputeNetworkPerSketch() const
+{
+    // PER is not sketched per measurement: each device's current error rate
+    // is one sample of the cross-device distribution, pushed at query time
+    QuantileSketch sketch{0.0, 1.0};
+    for (const auto& pair : m_packetTrackingStats) {
+        if (pair.second.totalPacketsSent > 0) {
+            sketch.Push(pair.second.endToEndErrorRate);
+        }
+    }
+    return sketch;
+}
+
 uint32_t StatisticsCollectorComponent::GetNetworkTotalPacketsSent() const
 {
     uint32_t total = 0;
@@ -642,23 +859,25 @@ double StatisticsCollectorComponent::GetNetworkPacketDeliveryRate() const
 
 uint32_t StatisticsCollectorComponent::ExtractGatewayId(const Address& gwAddr)
 {
-    // Simple and robust approach: use address bytes for hashing
-    uint8_t buffer[Address::MAX_SIZE];
-    uint32_t size = gwAddr.CopyTo(buffer);  // CopyTo only takes one argument
-    
-    // Create a simple hash from the address bytes
-    uint32_t hash = 0;
-    for (uint32_t i = 0; i < size; ++i) {
-        hash = (hash * 31) + buffer[i];
+    // Assign dense ids at first sight: no hashing (and no hash collisions),
+    // and the id indexes m_gatewayStats directly
+    auto it = m_gatewayIdByAddress.find(gwAddr);
+    if (it != m_gatewayIdByAddress.end()) {
+        return it->second;
     }
-    
-    // Return gateway ID in reasonable range (0-999)
-    uint32_t gatewayId = hash % 1000;
-    
-    NS_LOG_DEBUG("Extracted gateway ID " << gatewayId << " from address (size: " << size << ")");
+    uint32_t gatewayId = static_cast<uint32_t>(m_gatewayIdByAddress.size());
+    m_gatewayIdByAddress.insert(std::pair<Address, uint32_t>(gwAddr, gatewayId));
     return gatewayId;
 }
 
+StatisticsCollectorComponent::GatewayStats& StatisticsCollectorComponent::GatewayStatsFor(uint32_t gatewayId)
+{
+    if (gatewayId >= m_gatewayStats.size()) {
+        m_gatewayStats.resize(gatewayId + 1);
+    }
+    return m_gatewayStats[gatewayId];
+}
+
 void StatisticsCollectorComponent::CalculateErrorRates(uint32_t deviceAddr)
 {
     auto& pktStats = m_packetTrackingStats[deviceAddr];
@@ -684,14 +903,11 @@ void StatisticsCollectorComponent::WriteCsvData()
     if (!m_csvExportEnabled) {
         return;
     }
-    
-    std::ofstream csvFile(m_csvFilename, std::ios::app);
-    
-    if (!csvFile.is_open()) {
-        NS_LOG_ERROR("Could not open CSV file for statistics: " << m_csvFilename);
-        return;
-    }
-    
+
+    // Format into a memory buffer; the string is the snapshot handed to the
+    // background writer, so the event loop never waits on the disk
+    std::ostringstream csvFile;
+
     // Write header once
     if (!m_csvHeaderWritten) {
         csvFile << "Time,DeviceType,DeviceID,NodeID,Role,PacketsSent,PacketsReceived,PDR,NbTrans,Efficiency,AdrAdjustments,SF_Distribution,TxPower_Distribution,GatewayDiversity,Position,AvgRSSI,AvgSNR,BestRSSI,WorstRSSI,BestSNR,WorstSNR" << std::endl;
@@ -753,9 +969,8 @@ void StatisticsCollectorComponent::WriteCsvData()
     }
     
     // Write GATEWAY statistics with radio measurements
-    for (const auto& gwPair : m_gatewayStats) {
-        uint32_t gatewayId = gwPair.first;
-        const auto& gwStats = gwPair.second;
+    for (uint32_t gatewayId = 0; gatewayId < m_gatewayStats.size(); gatewayId++) {
+        const auto& gwStats = m_gatewayStats[gatewayId];
         
         std::string position = "Position_" + std::to_string(gatewayId);
         if (gwStats.position != "Unknown") {
@@ -781,8 +996,8 @@ void StatisticsCollectorComponent::WriteCsvData()
                 << std::setprecision(2) << gwStats.averageSnr << ","
                 << "N/A,N/A,N/A,N/A" << std::endl;
     }
-    
-    csvFile.close();
+
+    m_csvWriter.Submit(csvFile.str());
 }
 
 void StatisticsCollectorComponent::ScheduleNextCsvWrite()
@@ -795,8 +1010,98 @@ void StatisticsCollectorComponent::ScheduleNextCsvWrite()
     }
 }
 
+void StatisticsCollectorComponent::WriteBinaryData()
+{
+    if (!m_binaryExportEnabled) {
+        return;
+    }
+
+    if (!m_binaryHeaderWritten) {
+        m_binaryExportWriter.Submit(m_binaryFormatter.SerializeHeader());
+        m_binaryHeaderWritten = true;
+    }
+
+    double currentTime = Simulator::Now().GetSeconds();
+
+    // DeviceType codes: 0 = end device, 1 = gateway. Gateway rows carry -1 in
+    // the end-device-only columns where the CSV writes "N/A"
+    for (uint32_t deviceAddr : GetTrackedDevices()) {
+        auto pktStats = GetPacketTrackingStats(deviceAddr);
+        auto devStats = GetDeviceStats(deviceAddr);
+
+        double pdr = (pktStats.totalPacketsSent > 0) ?
+                     (1.0 - pktStats.endToEndErrorRate) : 0.0;
+
+        m_binaryFormatter.AppendRow({currentTime,
+                                     0.0,
+                                     static_cast<double>(deviceAddr),
+                                     static_cast<double>(FindNodeIdForDeviceAddr(deviceAddr)),
+                                     static_cast<double>(pktStats.totalPacketsSent),
+                                     static_cast<double>(pktStats.packetsReceivedByNetworkServer),
+                                     pdr,
+                                     static_cast<double>(devStats.currentNbTrans),
+                                     devStats.averageTransmissionsPerPacket,
+                                     static_cast<double>(devStats.adrAdjustmentCount),
+                                     static_cast<double>(pktStats.perGatewayReceptions.size()),
+                                     devStats.averageRssi,
+                                     devStats.averageSnr,
+                                     devStats.bestRssi,
+                                     devStats.worstRssi,
+                                     devStats.bestSnr,
+                                     devStats.worstSnr});
+    }
+
+    for (uint32_t gatewayId = 0; gatewayId < m_gatewayStats.size(); gatewayId++) {
+        const auto& gwStats = m_gatewayStats[gatewayId];
+        m_binaryFormatter.AppendRow({currentTime,
+                                     1.0,
+                                     static_cast<double>(gatewayId),
+                                     static_cast<double>(gatewayId),
+                                     -1.0,
+                                     static_cast<double>(gwStats.packetsReceived),
+                                     -1.0,
+                                     -1.0,
+                                     -1.0,
+                                     -1.0,
+                                     -1.0,
+                                     gwStats.averageRssi,
+                                     gwStats.averageSnr,
+                                     -1.0,
+                                     -1.0,
+                                     -1.0,
+                                     -1.0});
+    }
+
+    // The serialized block is the snapshot handed to the background writer,
+    // mirroring the CSV path
+    m_binaryExportWriter.Submit(m_binaryFormatter.SerializeBlock());
+}
+
+void StatisticsCollectorComponent::ScheduleNextBinaryWrite()
+{
+    if (m_binaryExportEnabled) {
+        Simulator::Schedule(Seconds(m_binaryIntervalSeconds),
+                           &StatisticsCollectorComponent::WriteBinaryData, this);
+        Simulator::Schedule(Seconds(m_binaryIntervalSeconds),
+                           &StatisticsCollectorComponent::ScheduleNextBinaryWrite, this);
+    }
+}
+
+uint64_t StatisticsCollectorComponent::GetCsvBackpressureDrops() const
+{
+    return m_csvWriter.GetDroppedChunks() + m_radioMeasurementCsvWriter.GetDroppedChunks() +
+           m_binaryExportWriter.GetDroppedChunks();
+}
+
 uint32_t StatisticsCollectorComponent::FindNodeIdForDeviceAddr(uint32_t deviceAddr) const
 {
+    // Devices registered at install time are answered by the shared
+    // registry in O(1); the local map only serves explicit SetNodeIdMapping
+    // overrides for unregistered addresses
+    uint32_t index = DeviceRegistry::IndexOfAddress(deviceAddr);
+    if (index != DeviceRegistry::INVALID_INDEX) {
+        return DeviceRegistry::NodeOf(index);
+    }
     for (const auto& pair : m_nodeIdToDeviceAddr) {
         if (pair.second == deviceAddr) {
             return pair.first;
@@ -805,5 +1110,28 @@ uint32_t StatisticsCollectorComponent::FindNodeIdForDeviceAddr(uint32_t deviceAd
     return 0; // Default if not found
 }
 
+uint64_t StatisticsCollectorComponent::MemoryReport() const
+{
+    uint64_t bytes = EstimateMemory(m_deviceStats) + EstimateMemory(m_packetTrackingStats) +
+                     EstimateMemory(m_gatewayStats) + EstimateMemory(m_gatewayIdByAddress) +
+                     EstimateMemory(m_nodeIdToDeviceAddr) +
+                     EstimateMemory(m_packetReceptionHistory);
+
+    for (const auto& pair : m_deviceStats) {
+        bytes += EstimateMemory(pair.second.rawHistory);
+    }
+    for (const auto& pair : m_packetTrackingStats) {
+        const PacketTrackingStats& stats = pair.second;
+        bytes += EstimateMemory(stats.sfDistribution) + EstimateMemory(stats.txPowerDistribution) +
+                 EstimateMemory(stats.perGatewayReceptions) + EstimateMemory(stats.perGatewayRssi) +
+                 EstimateMemory(stats.perGatewaySnr);
+    }
+    for (const auto& event : m_packetReceptionHistory) {
+        bytes += EstimateMemory(event.gatewayMeasurements);
+    }
+
+    return bytes;
+}
+
 } // namespace lorawan
 } // namespace ns3
\ No newline at end of file
@@ -5,13 +5,20 @@
 #ifndef STATISTICS_COLLECTOR_H
 #define STATISTICS_COLLECTOR_H
 
+#include "async-trace-sink.h"
+#include "columnar-export.h"
+
 #include "ns3/network-controller-components.h"
 #include "ns3/network-status.h"
 #include "ns3/nstime.h"
 #include "ns3/traced-callback.h"
+#include <algorithm>
+#include <array>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <list>
+#include <deque>
 #include <string>
 #include <fstream>
 
@@ -33,6 +40,75 @@ public:
         uint32_t frequency = 868100000;
     };
 
+    // *** NEW: Streaming aggregate (Welford) replacing raw history scans ***
+    struct StreamingAggregate {
+        uint64_t count = 0;
+        double mean = 0.0;
+        double m2 = 0.0;       // Sum of squared deviations from the mean
+        double min = 999.0;
+        double max = -999.0;
+
+        void Push(double value) {
+            count++;
+            double delta = value - mean;
+            mean += delta / count;
+            m2 += delta * (value - mean);
+            if (value < min) min = value;
+            if (value > max) max = value;
+        }
+        double Variance() const {
+            return (count > 1) ? m2 / (count - 1) : 0.0;
+        }
+    };
+
+    // *** NEW: Mergeable fixed-bin quantile sketch for interval reports ***
+    // Values are clamped into a known plausible range and counted in equal
+    // width bins, so updates are O(1), merging is a vector add, and a
+    // quantile query interpolates inside one bin. With 64 bins the estimate
+    // is accurate to about 1/64th of the range, plenty for p5/p50/p95/p99
+    // reporting, at 256 bytes per sketch ***
+    struct QuantileSketch {
+        static constexpr uint32_t BIN_COUNT = 64;
+        double lo;
+        double hi;
+        uint64_t count = 0;
+        std::array<uint32_t, BIN_COUNT> bins{};
+
+        QuantileSketch(double rangeLo, double rangeHi) : lo(rangeLo), hi(rangeHi) {}
+
+        void Push(double value) {
+            double clamped = std::min(std::max(value, lo), hi);
+            auto bin = static_cast<uint32_t>((clamped - lo) / (hi - lo) * BIN_COUNT);
+            bins[std::min(bin, BIN_COUNT - 1)]++;
+            count++;
+        }
+
+        void Merge(const QuantileSketch& other) {
+            for (uint32_t i = 0; i < BIN_COUNT; i++) {
+                bins[i] += other.bins[i];
+            }
+            count += other.count;
+        }
+
+        // Returns -999.0 when empty, matching the other sentinel defaults
+        double Quantile(double q) const {
+            if (count == 0) {
+                return -999.0;
+            }
+            double target = q * count;
+            double cumulative = 0;
+            double binWidth = (hi - lo) / BIN_COUNT;
+            for (uint32_t i = 0; i < BIN_COUNT; i++) {
+                if (cumulative + bins[i] >= target && bins[i] > 0) {
+                    double frac = (target - cumulative) / bins[i];
+                    return lo + (i + frac) * binWidth;
+                }
+                cumulative += bins[i];
+            }
+            return hi;
+        }
+    };
+
     // *** NEW: Packet reception event for advanced tracking ***
     struct PacketReceptionEvent {
         uint32_t deviceAddr;
@@ -54,10 +130,26 @@ public:
         uint32_t adrAdjustmentCount = 0;
         double averageTransmissionsPerPacket = 1.0;
         Time lastNbTransChange = Time(0);
+
+        // *** NEW: Adaptive sampling state for the measurement export.
+        // Short-window EWMAs of the SNR and its squared deviation, plus the
+        // stable/decimating flag and the phase within the decimation cycle ***
+        double snrEwma = 0.0;
+        double snrEwmaVar = 0.0;
+        bool snrEwmaSeeded = false;
+        bool samplingStable = false;
+        uint32_t decimationPhase = 0;
         
         // *** NEW: Radio measurement fields ***
-        std::list<RadioMeasurement> rssiHistory;
-        std::list<RadioMeasurement> snrHistory;
+        // Streaming aggregates updated in O(1) per measurement; the raw ring
+        // is only populated when a history depth is opted into
+        StreamingAggregate rssiAgg;
+        StreamingAggregate snrAgg;
+        // Quantile sketches updated alongside the aggregates, so percentile
+        // reports never need the raw history
+        QuantileSketch rssiSketch{-150.0, 0.0};
+        QuantileSketch snrSketch{-30.0, 25.0};
+        std::deque<RadioMeasurement> rawHistory;
         double averageRssi = -999.0;
         double averageSnr = -999.0;
         double bestRssi = -999.0;
@@ -77,8 +169,9 @@ public:
         Time firstPacketTime = Time::Max();
         Time lastPacketTime = Time(0);
         
-        // *** NEW: Per-gateway radio measurements ***
-        std::map<uint32_t, std::vector<RadioMeasurement>> perGatewayMeasurements;
+        // *** NEW: Per-gateway radio aggregates ***
+        std::map<uint32_t, StreamingAggregate> perGatewayRssi;
+        std::map<uint32_t, StreamingAggregate> perGatewaySnr;
     };
 
     // *** ENHANCED: Gateway stats with radio measurements ***
@@ -89,7 +182,10 @@ public:
         Time lastReceptionTime = Time(0);
         
         // *** NEW: Radio measurement fields ***
-        std::list<RadioMeasurement> measurementHistory;
+        StreamingAggregate rssiAgg;
+        StreamingAggregate snrAgg;
+        QuantileSketch rssiSketch{-150.0, 0.0};
+        QuantileSketch snrSketch{-30.0, 25.0};
         double averageRssi = -999.0;
         double averageSnr = -999.0;
     };
@@ -114,14 +210,46 @@ public:
                                double rssi, double snr, double snir,
                                uint8_t sf, double txPower, uint32_t frequency);
     void RecordPacketReception(const PacketReceptionEvent& event);
+
+    // *** NEW: Opt-in raw measurement ring (0 = aggregates only, the default).
+    // Needed by the per-measurement CSV export and GetRecentMeasurements ***
+    void SetRawMeasurementHistoryDepth(uint32_t depth);
+
+    // *** NEW: Bound of the in-RAM reception event ring ***
+    void SetPacketReceptionHistoryDepth(uint32_t depth);
+
+    // *** NEW: Background spill of every reception event to a binary
+    // columnar file (one row per gateway measurement), so full-run
+    // forensics survive the in-RAM ring bound. Blocks are handed to the
+    // shared background writer, so the event loop never touches the disk ***
+    void EnableReceptionEventSpill(const std::string& filename = "reception_events.lwcb");
+    void DisableReceptionEventSpill();
     
     // Automatic CSV export control
     void EnableAutomaticCsvExport(const std::string& filename = "adr_statistics.csv", uint32_t intervalSeconds = 300);
     void DisableAutomaticCsvExport();
+
+    // *** NEW: Binary columnar export. Same cadence and numeric content as the
+    // CSV export but serialized as raw per-column doubles, which skips the
+    // double-to-text formatting entirely. Convert offline with the
+    // columnar-to-csv example (BinaryColumnarWriter::ConvertToCsv) ***
+    void EnableAutomaticBinaryExport(const std::string& filename = "adr_statistics.lwcb", uint32_t intervalSeconds = 300);
+    void DisableAutomaticBinaryExport();
     
     // *** NEW: Radio measurement CSV export ***
     void EnableRadioMeasurementCsv(const std::string& filename = "radio_measurements.csv", uint32_t intervalSeconds = 60);
     void DisableRadioMeasurementCsv();
+
+    // *** NEW: Adaptive decimation of the per-measurement export. A device
+    // stays at the full rate while its short-window SNR variance is above
+    // stableSnrStdDevDb squared or ADR is still adjusting it; once stable,
+    // only one measurement in `decimation` is kept. An SNR jump of more than
+    // resumeSnrDeltaDb away from the running mean, or an ADR adjustment,
+    // resumes the full rate immediately. A decimation of 0 or 1 disables
+    // the feature (the default: every measurement is kept) ***
+    void SetAdaptiveRadioSampling(uint32_t decimation,
+                                  double stableSnrStdDevDb = 1.0,
+                                  double resumeSnrDeltaDb = 3.0);
     
     // Getters for statistics
     uint8_t GetCurrentNbTrans(uint32_t deviceAddr) const;
@@ -140,14 +268,45 @@ public:
     
     // Get all device addresses being tracked
     std::vector<uint32_t> GetTrackedDevices() const;
+
+    // *** NEW: Quantile sketch access. Per-entity quantiles read one sketch
+    // in place; the network-wide sketches merge the per-device sketches (or,
+    // for PER, push each device's current error rate), so a p5/p50/p95/p99
+    // interval report costs one pass over the devices and no raw history ***
+    double GetDeviceRssiQuantile(uint32_t deviceAddr, double quantile) const;
+    double GetDeviceSnrQuantile(uint32_t deviceAddr, double quantile) const;
+    double GetGatewayRssiQuantile(uint32_t gatewayId, double quantile) const;
+    double GetGatewaySnrQuantile(uint32_t gatewayId, double quantile) const;
+    QuantileSketch ComputeNetworkRssiSketch() const;
+    QuantileSketch ComputeNetworkSnrSketch() const;
+    QuantileSketch ComputeNetworkPerSketch() const;
+
+    // *** NEW: Chunks dropped by the async CSV writers under backpressure ***
+    uint64_t GetCsvBackpressureDrops() const;
+
+    // *** NEW: Measurements withheld from the export by adaptive sampling ***
+    uint64_t GetMeasurementsDecimated() const;
     
     // Network-wide statistics
     uint32_t GetNetworkTotalPacketsSent() const;
     uint32_t GetNetworkTotalPacketsReceived() const;
     double GetNetworkPacketDeliveryRate() const;
 
+    // *** NEW: Estimated heap bytes held by the stats containers ***
+    uint64_t MemoryReport() const;
+
 private:
+    // *** NEW: Background CSV writing now goes through the module-wide
+    // AsyncTraceSink: the simulation thread submits formatted chunks (that
+    // string IS the snapshot of the stats) and a worker thread does the
+    // file I/O. Chunks over the pending cap are dropped and counted rather
+    // than blocking the simulation ***
+    using AsyncCsvWriter = AsyncTraceSink;
+
+    // Dense gateway id, assigned at first sight of an address; indexes
+    // m_gatewayStats directly
     uint32_t ExtractGatewayId(const Address& gwAddr);
+    GatewayStats& GatewayStatsFor(uint32_t gatewayId);
     void CalculateErrorRates(uint32_t deviceAddr);
     double CalculateTransmissionEfficiency(const DeviceStats& deviceStats) const;
     
@@ -165,15 +324,40 @@ private:
     void WriteRadioMeasurementCsv();
     void ScheduleNextRadioMeasurementWrite();
 
-    // Core data storage
-    std::map<uint32_t, DeviceStats> m_deviceStats;
-    std::map<uint32_t, PacketTrackingStats> m_packetTrackingStats;
-    std::map<uint32_t, GatewayStats> m_gatewayStats;
-    std::map<uint32_t, uint32_t> m_nodeIdToDeviceAddr;
+    // *** NEW: Adaptive sampling decision, updating the device's EWMAs and
+    // stability state as a side effect ***
+    bool ShouldExportMeasurement(DeviceStats& devStats, double snr);
 
-    // *** NEW: Packet reception history for advanced analysis ***
-    std::list<PacketReceptionEvent> m_packetReceptionHistory;
+    // *** NEW: Binary columnar export methods ***
+    void WriteBinaryData();
+    void ScheduleNextBinaryWrite();
+
+    // Core data storage; the per-device maps are hashed since they are hit
+    // on every uplink, and gateway state is a plain vector indexed by the
+    // dense id that ExtractGatewayId assigns at first sight
+    std::unordered_map<uint32_t, DeviceStats> m_deviceStats;
+    std::unordered_map<uint32_t, PacketTrackingStats> m_packetTrackingStats;
+    std::vector<GatewayStats> m_gatewayStats;
+    std::map<Address, uint32_t> m_gatewayIdByAddress;
+    std::unordered_map<uint32_t, uint32_t> m_nodeIdToDeviceAddr;
+
+    // *** NEW: Packet reception history for advanced analysis; a bounded
+    // ring, oldest events evicted (and still on disk if spill is enabled) ***
+    std::deque<PacketReceptionEvent> m_packetReceptionHistory;
     uint32_t m_maxHistorySize = 1000;
+    uint32_t m_rawHistoryDepth = 0;
+
+    // *** NEW: Reception event spill state ***
+    static constexpr uint32_t SPILL_BLOCK_ROWS = 512;
+    BinaryColumnarWriter m_spillFormatter;
+    AsyncTraceSink m_spillWriter;
+    uint32_t m_spillRowsBuffered = 0;
+    bool m_spillEnabled = false;
+
+    // *** NEW: Background writers, one per export file ***
+    AsyncCsvWriter m_csvWriter;
+    AsyncCsvWriter m_radioMeasurementCsvWriter;
+    AsyncCsvWriter m_binaryExportWriter;
 
     // CSV export control
     bool m_csvExportEnabled;
@@ -181,12 +365,25 @@ private:
     uint32_t m_csvIntervalSeconds;
     bool m_csvHeaderWritten;
 
+    // *** NEW: Binary columnar export control ***
+    BinaryColumnarWriter m_binaryFormatter;
+    bool m_binaryExportEnabled = false;
+    std::string m_binaryFilename;
+    uint32_t m_binaryIntervalSeconds = 300;
+    bool m_binaryHeaderWritten = false;
+
     // *** NEW: Radio measurement CSV export control ***
     bool m_radioMeasurementCsvEnabled;
     std::string m_radioMeasurementCsvFilename;
     uint32_t m_radioMeasurementCsvIntervalSeconds;
     bool m_radioMeasurementCsvHeaderWritten;
 
+    // *** NEW: Adaptive sampling control (0/1 = keep every measurement) ***
+    uint32_t m_adaptiveSamplingDecimation = 0;
+    double m_stableSnrStdDevDb = 1.0;
+    double m_resumeSnrDeltaDb = 3.0;
+    uint64_t m_measurementsDecimated = 0;
+
     // Trace sources for real-time monitoring
     TracedCallback<uint32_t, uint8_t, uint8_t> m_nbTransChangedTrace;
     TracedCallback<uint32_t, double> m_transmissionEfficiencyTrace;
@@ -0,0 +1,295 @@
+// model/uplink-trace.cc
+
+#include "uplink-trace.h"
+
+#include "lora-frame-header.h"
+#include "lora-tag.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+NS_LOG_COMPONENT_DEFINE("UplinkTrace");
+
+namespace
+{
+
+const char UPLINK_TRACE_MAGIC[4] = {'L', 'W', 'U', 'T'};
+
+template <typename T>
+void
+AppendValue(std::string& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool
+ReadValue(std::ifstream& in, T& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return in.gcount() == static_cast<std::streamsize>(sizeof(value));
+}
+
+} // namespace
+
+bool
+UplinkTraceWriter::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    Close();
+    // A capture is only replayable if it is complete, so block the
+    // simulation under backpressure instead of dropping records
+    m_sink.SetBlockWhenFull(true);
+    m_sink.Start(filename, true);
+    if (!m_sink.IsOpen())
+    {
+        NS_LOG_ERROR("Could not open uplink trace file: " << filename);
+        return false;
+    }
+    std::string header(UPLINK_TRACE_MAGIC, sizeof(UPLINK_TRACE_MAGIC));
+    AppendValue(header, FORMAT_VERSION);
+    m_sink.Submit(std::move(header));
+    return true;
+}
+
+void
+UplinkTraceWriter::Record(Ptr<const Packet> packet, const Address& gwAddress)
+{
+    if (!m_sink.IsOpen())
+    {
+        return;
+    }
+
+    uint64_t uid = packet->GetUid();
+    uint8_t firstCopy = m_seenUids.insert(uid).second ? 1 : 0;
+
+    LoraTag tag;
+    packet->PeekPacketTag(tag);
+    LoraFrameHeader::FieldView fields = LoraFrameHeader::PeekFields(packet);
+
+    // Serialize the whole record into one chunk so the background writer
+    // appends it atomically
+    std::string record;
+    AppendValue(record, static_cast<uint64_t>(Simulator::Now().GetNanoSeconds()));
+    AppendValue(record, uid);
+    AppendValue(record, firstCopy);
+    AppendValue(record, fields.address.Get());
+    AppendValue(record, fields.fCnt);
+    AppendValue(record, tag.GetSpreadingFactor());
+    AppendValue(record, tag.GetDataRate());
+    AppendValue(record, tag.GetFrequency());
+    AppendValue(record, tag.GetReceivePower());
+
+    uint8_t gwBuffer[Address::MAX_SIZE + 2];
+    uint8_t gwLen = static_cast<uint8_t>(gwAddress.CopyAllTo(gwBuffer, sizeof(gwBuffer)));
+    AppendValue(record, gwLen);
+    record.append(reinterpret_cast<const char*>(gwBuffer), gwLen);
+
+    if (firstCopy)
+    {
+        uint16_t payloadLen = static_cast<uint16_t>(packet->GetSize());
+        std::vector<uint8_t> payload(payloadLen);
+        packet->CopyData(payload.data(), payloadLen);
+        AppendValue(record, payloadLen);
+        record.append(reinterpret_cast<const char*>(payload.data()), payloadLen);
+    }
+
+    m_sink.Submit(std::move(record));
+}
+
+void
+UplinkTraceWriter::Close()
+{
+    m_sink.Stop(); // Flushes whatever is still buffered
+    m_seenUids.clear();
+}
+
+bool
+UplinkTraceWriter::IsOpen() const
+{
+    return m_sink.IsOpen();
+}
+
+UplinkTraceReplayer::UplinkTraceReplayer()
+    : m_status(Create<NetworkStatus>()),
+      m_controller(Create<NetworkController>(m_status))
+{
+    NS_LOG_FUNCTION(this);
+}
+
+bool
+UplinkTraceReplayer::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    m_file.open(filename, std::ios::binary);
+    if (!m_file.is_open())
+    {
+        NS_LOG_ERROR("Could not open uplink trace file: " << filename);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    m_file.read(magic, sizeof(magic));
+    if (m_file.gcount() != sizeof(magic) ||
+        std::memcmp(magic, UPLINK_TRACE_MAGIC, sizeof(magic)) != 0 ||
+        !ReadValue(m_file, version) || version != UplinkTraceWriter::FORMAT_VERSION)
+    {
+        NS_LOG_ERROR(filename << " is not a version " << UplinkTraceWriter::FORMAT_VERSION
+                              << " uplink trace");
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void
+UplinkTraceReplayer::Install(Ptr<NetworkControllerComponent> component)
+{
+    m_controller->Install(component);
+}
+
+uint32_t
+UplinkTraceReplayer::Replay()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_file.is_open())
+    {
+        return 0;
+    }
+
+    uint32_t scheduled = 0;
+    while (true)
+    {
+        TraceRecord record;
+        uint64_t timeNs = 0;
+        uint8_t firstCopy = 0;
+        uint16_t fCnt = 0;
+        if (!ReadValue(m_file, timeNs))
+        {
+            break; // Clean end of trace
+        }
+        if (!ReadValue(m_file, record.uid) || !ReadValue(m_file, firstCopy) ||
+            !ReadValue(m_file, record.deviceAddr) || !ReadValue(m_file, fCnt) ||
+            !ReadValue(m_file, record.sf) || !ReadValue(m_file, record.dataRate) ||
+            !ReadValue(m_file, record.frequencyHz) || !ReadValue(m_file, record.rxPowerDbm))
+        {
+            NS_LOG_ERROR("Truncated uplink trace record after " << scheduled << " records");
+            break;
+        }
+        record.time = NanoSeconds(timeNs);
+        record.firstCopy = (firstCopy != 0);
+
+        uint8_t gwLen = 0;
+        uint8_t gwBuffer[Address::MAX_SIZE + 2];
+        if (!ReadValue(m_file, gwLen) || gwLen > sizeof(gwBuffer))
+        {
+            NS_LOG_ERROR("Malformed gateway address in uplink trace");
+            break;
+        }
+        m_file.read(reinterpret_cast<char*>(gwBuffer), gwLen);
+        if (m_file.gcount() != gwLen)
+        {
+            NS_LOG_ERROR("Truncated gateway address in uplink trace");
+            break;
+        }
+        record.gwAddress.CopyAllFrom(gwBuffer, gwLen);
+
+        if (record.firstCopy)
+        {
+            uint16_t payloadLen = 0;
+            if (!ReadValue(m_file, payloadLen))
+            {
+                NS_LOG_ERROR("Truncated payload length in uplink trace");
+                break;
+            }
+            std::vector<uint8_t> payload(payloadLen);
+            m_file.read(reinterpret_cast<char*>(payload.data()), payloadLen);
+            if (m_file.gcount() != payloadLen)
+            {
+                NS_LOG_ERROR("Truncated payload in uplink trace");
+                break;
+            }
+
+            // Rebuild the packet and its radio metadata tag. Copies relayed
+            // by other gateways reuse this packet, so they share a UID just
+            // like in the captured run
+            Ptr<Packet> packet = Create<Packet>(payload.data(), payloadLen);
+            LoraTag tag;
+            tag.SetSpreadingFactor(record.sf);
+            tag.SetDataRate(record.dataRate);
+            tag.SetFrequency(record.frequencyHz);
+            tag.SetReceivePower(record.rxPowerDbm);
+            packet->AddPacketTag(tag);
+            m_packets[record.uid] = packet;
+
+            // Register the device on first sight: an address-only MAC is
+            // enough for the status bookkeeping, no PHY or node behind it
+            if (m_knownDevices.insert(record.deviceAddr).second)
+            {
+                Ptr<ClassAEndDeviceLorawanMac> mac =
+                    CreateObject<ClassAEndDeviceLorawanMac>();
+                mac->SetDeviceAddress(LoraDeviceAddress(record.deviceAddr));
+                m_status->AddNode(mac);
+            }
+        }
+
+        auto packetIt = m_packets.find(record.uid);
+        if (packetIt == m_packets.end())
+        {
+            NS_LOG_ERROR("Uplink trace copy references unknown packet UID " << record.uid);
+            continue;
+        }
+        record.packet = packetIt->second;
+
+        Simulator::Schedule(record.time - Simulator::Now(),
+                            &UplinkTraceReplayer::DeliverRecord,
+                            this,
+                            record);
+        scheduled++;
+    }
+
+    m_file.close();
+    NS_LOG_INFO("Scheduled " << scheduled << " uplink trace records for replay");
+    return scheduled;
+}
+
+Ptr<NetworkStatus>
+UplinkTraceReplayer::GetNetworkStatus()
+{
+    return m_status;
+}
+
+Ptr<NetworkController>
+UplinkTraceReplayer::GetNetworkController()
+{
+    return m_controller;
+}
+
+void
+UplinkTraceReplayer::DeliverRecord(TraceRecord record)
+{
+    NS_LOG_FUNCTION(this << record.uid);
+
+    // Per-gateway reception information goes to the status for every copy;
+    // the controller runs once per uplink, as in NetworkServer::Receive
+    m_status->OnReceivedPacket(record.packet, record.gwAddress);
+    if (record.firstCopy)
+    {
+        m_controller->OnNewPacket(record.packet);
+    }
+}
+
+} // namespace lorawan
+} // namespace ns3
@@ -0,0 +1,181 @@
+// model/uplink-trace.h
+
+#ifndef UPLINK_TRACE_H
+#define UPLINK_TRACE_H
+
+#include "async-trace-sink.h"
+#include "class-a-end-device-lorawan-mac.h"
+#include "network-controller.h"
+#include "network-status.h"
+
+#include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+
+namespace ns3
+{
+namespace lorawan
+{
+
+/**
+ * @ingroup lorawan
+ *
+ * Capture side of the uplink record-and-replay mode.
+ *
+ * When iterating on ADR parameters the PHY/channel behavior is identical
+ * every run. This writer logs each uplink exactly as NetworkServer::Receive
+ * sees it — timestamp, packet UID, the LoraTag radio metadata (SF, data
+ * rate, frequency, rx power), the relaying gateway address and, for the
+ * first copy of each uplink, the raw packet bytes — to a compact binary
+ * trace that UplinkTraceReplayer can feed back into the network server
+ * stack without channel, PHYs or devices.
+ *
+ * Records are written through an AsyncTraceSink so the file I/O happens on
+ * a background thread. The sink runs in blocking mode: a capture must be
+ * complete to be replayable, so under backpressure the simulation waits
+ * for the disk rather than dropping records.
+ *
+ * File layout (version 1): magic "LWUT", uint32 version, then one record
+ * per gateway copy: uint64 timeNs, uint64 uid, uint8 firstCopy,
+ * uint32 deviceAddr, uint16 fCnt, uint8 sf, uint8 dataRate,
+ * uint32 frequencyHz, double rxPowerDbm, uint8 gwAddrLen + address bytes,
+ * and for first copies uint16 payloadLen + packet bytes.
+ */
+class UplinkTraceWriter
+{
+  public:
+    static const uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * Open the trace file, truncating any existing content.
+     *
+     * @param filename The output file name. Avoid a ".zst" name when the
+     * capture is meant for UplinkTraceReplayer, which reads the file
+     * uncompressed.
+     * @return True if the file was opened.
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * Append one gateway copy of an uplink to the trace.
+     *
+     * @param packet The packet as seen by NetworkServer::Receive.
+     * @param gwAddress The address of the relaying gateway.
+     */
+    void Record(Ptr<const Packet> packet, const Address& gwAddress);
+
+    /**
+     * Flush and close the trace file.
+     */
+    void Close();
+
+    /**
+     * Whether the trace file is open.
+     *
+     * @return True if recording is active.
+     */
+    bool IsOpen() const;
+
+  private:
+    AsyncTraceSink m_sink;         //!< Background writer for the trace file
+    std::set<uint64_t> m_seenUids; //!< Uplinks whose payload was already stored
+};
+
+/**
+ * @ingroup lorawan
+ *
+ * Replay driver for uplink traces captured by UplinkTraceWriter.
+ *
+ * Owns a bare NetworkStatus/NetworkController pair; ADR components under
+ * test are added with Install(). Replay() registers every device seen in
+ * the trace (as an address-only MAC, with no PHY, channel or node behind
+ * it) and schedules each record at its captured timestamp, so components
+ * observe the same packets, gateway measurements and clock as in the
+ * original run. Replaying a long capture is then limited only by event
+ * processing, not channel simulation.
+ */
+class UplinkTraceReplayer
+{
+  public:
+    UplinkTraceReplayer();
+
+    /**
+     * Open a captured trace.
+     *
+     * @param filename The trace file name.
+     * @return True if the file was opened and the header is valid.
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * Add a network controller component to run against the replay.
+     *
+     * @param component The component under test.
+     */
+    void Install(Ptr<NetworkControllerComponent> component);
+
+    /**
+     * Read the whole trace, register its devices and schedule every record
+     * at its captured timestamp. Run the simulator afterwards.
+     *
+     * @return The number of scheduled records.
+     */
+    uint32_t Replay();
+
+    /**
+     * Access the replayed network status, e.g. to inspect device state
+     * after Simulator::Run().
+     *
+     * @return The network status fed by the replay.
+     */
+    Ptr<NetworkStatus> GetNetworkStatus();
+
+    /**
+     * Access the network controller driving the installed components.
+     *
+     * @return The network controller.
+     */
+    Ptr<NetworkController> GetNetworkController();
+
+  private:
+    /**
+     * One parsed trace record.
+     */
+    struct TraceRecord
+    {
+        Time time;             //!< Capture timestamp
+        uint64_t uid;          //!< UID of the captured packet
+        bool firstCopy;        //!< Whether this record carries the payload
+        uint32_t deviceAddr;   //!< Sending device address
+        uint8_t sf;            //!< Spreading factor from the LoraTag
+        uint8_t dataRate;      //!< Data rate from the LoraTag
+        uint32_t frequencyHz;  //!< Frequency from the LoraTag
+        double rxPowerDbm;     //!< Reception power at this gateway
+        Address gwAddress;     //!< The relaying gateway
+        Ptr<Packet> packet;    //!< Reconstructed packet (first copies only)
+    };
+
+    /**
+     * Deliver one scheduled record to the status and, for first copies,
+     * the controller.
+     *
+     * @param record The record to deliver.
+     */
+    void DeliverRecord(TraceRecord record);
+
+    std::ifstream m_file;                        //!< The trace file
+    Ptr<NetworkStatus> m_status;                 //!< Replayed network status
+    Ptr<NetworkController> m_controller;         //!< Controller under test
+    std::map<uint64_t, Ptr<Packet>> m_packets;   //!< Reconstructed packets by captured UID
+    std::set<uint32_t> m_knownDevices;           //!< Devices already registered
+};
+
+} // namespace lorawan
+} // namespace ns3
+
+#endif // UPLINK_TRACE_H
@@ -6,18 +6,32 @@
  * Author: Davide Magrin <magrinda@dei.unipd.it>
  */
 
+#include "utilities.h"
+
 // Include headers of classes to test
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/fec-component.h"
+#include "ns3/forwarder-helper.h"
+#include "ns3/hex-grid-position-allocator.h"
 #include "ns3/log.h"
 #include "ns3/lora-helper.h"
 #include "ns3/mobility-helper.h"
+#include "ns3/network-server-helper.h"
 #include "ns3/one-shot-sender-helper.h"
+#include "ns3/periodic-sender-helper.h"
+#include "ns3/point-to-point-module.h"
 #include "ns3/simple-end-device-lora-phy.h"
 #include "ns3/simple-gateway-lora-phy.h"
+#include "ns3/statistics-collector.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cmath>
+
 using namespace ns3;
 using namespace lorawan;
 
@@ -423,6 +437,557 @@ HeaderTest::DoRun()
                           "Removed header's MAC command contents don't match");
 }
 
+/**
+ * @ingroup lorawan
+ *
+ * It verifies that the byte-level fast paths of LoraFrameHeader -- the 8-byte
+ * command-free Serialize path and the PeekFields views -- agree with the
+ * general serialization and deserialization code on the FHDR wire format
+ */
+class FrameHeaderWireFormatTest : public TestCase
+{
+  public:
+    FrameHeaderWireFormatTest();           //!< Default constructor
+    ~FrameHeaderWireFormatTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+FrameHeaderWireFormatTest::FrameHeaderWireFormatTest()
+    : TestCase("Verify the fast serialization and peek paths of LoraFrameHeader")
+{
+}
+
+FrameHeaderWireFormatTest::~FrameHeaderWireFormatTest()
+{
+}
+
+void
+FrameHeaderWireFormatTest::DoRun()
+{
+    NS_LOG_DEBUG("FrameHeaderWireFormatTest");
+
+    //////////////////////////////////////////////////////////////////////
+    // Command-free header: the 8-byte fast path must emit exactly the  //
+    // bytes the general path would write                               //
+    //////////////////////////////////////////////////////////////////////
+    LoraFrameHeader frameHdr;
+    frameHdr.SetAsUplink();
+    frameHdr.SetAddress(LoraDeviceAddress(0x12, 0x345678));
+    frameHdr.SetAdr(true);
+    frameHdr.SetAdrAckReq(true);
+    frameHdr.SetAck(true);
+    frameHdr.SetFPending(false);
+    frameHdr.SetFCnt(0xABCD);
+    frameHdr.SetFPort(42);
+
+    NS_TEST_EXPECT_MSG_EQ(frameHdr.GetSerializedSize(),
+                          8,
+                          "Command-free frame header should serialize to 8 bytes");
+
+    Buffer fastBuf;
+    fastBuf.AddAtStart(8);
+    frameHdr.Serialize(fastBuf.Begin());
+
+    // Reference bytes written with the same Buffer calls the general
+    // serialization path uses: WriteU32 address, WriteU8 FCtrl, WriteU16
+    // FCnt, then FPort
+    uint8_t fCtrl = (1 << 7) | (1 << 6) | (1 << 5); // ADR, ADRACKReq, ACK; FOptsLen = 0
+    Buffer refBuf;
+    refBuf.AddAtStart(8);
+    Buffer::Iterator ref = refBuf.Begin();
+    ref.WriteU32(LoraDeviceAddress(0x12, 0x345678).Get());
+    ref.WriteU8(fCtrl);
+    ref.WriteU16(0xABCD);
+    ref.WriteU8(42);
+
+    Buffer::Iterator fastIt = fastBuf.Begin();
+    Buffer::Iterator refIt = refBuf.Begin();
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(fastIt.ReadU8(),
+                              refIt.ReadU8(),
+                              "Fast-path byte " << i << " differs from the general layout");
+    }
+
+    // The fast-path output must round-trip through Deserialize
+    LoraFrameHeader roundTrip;
+    roundTrip.SetAsUplink();
+    roundTrip.Deserialize(fastBuf.Begin());
+    NS_TEST_EXPECT_MSG_EQ((roundTrip.GetAddress() == frameHdr.GetAddress()),
+                          true,
+                          "Address does not survive the fast-path round trip");
+    NS_TEST_EXPECT_MSG_EQ(roundTrip.GetAdr(),
+                          frameHdr.GetAdr(),
+                          "ADR bit does not survive the fast-path round trip");
+    NS_TEST_EXPECT_MSG_EQ(roundTrip.GetAdrAckReq(),
+                          frameHdr.GetAdrAckReq(),
+                          "ADRACKReq bit does not survive the fast-path round trip");
+    NS_TEST_EXPECT_MSG_EQ(roundTrip.GetAck(),
+                          frameHdr.GetAck(),
+                          "ACK bit does not survive the fast-path round trip");
+    NS_TEST_EXPECT_MSG_EQ(roundTrip.GetFCnt(),
+                          frameHdr.GetFCnt(),
+                          "FCnt does not survive the fast-path round trip");
+    NS_TEST_EXPECT_MSG_EQ(roundTrip.GetFPort(),
+                          frameHdr.GetFPort(),
+                          "FPort does not survive the fast-path round trip");
+
+    // PeekFields on the same buffer must agree with Deserialize
+    LoraFrameHeader::FieldView view = LoraFrameHeader::PeekFields(fastBuf.Begin());
+    NS_TEST_EXPECT_MSG_EQ((view.address == frameHdr.GetAddress()),
+                          true,
+                          "PeekFields address disagrees with Deserialize");
+    NS_TEST_EXPECT_MSG_EQ(view.adr, frameHdr.GetAdr(), "PeekFields ADR bit disagrees");
+    NS_TEST_EXPECT_MSG_EQ(view.adrAckReq,
+                          frameHdr.GetAdrAckReq(),
+                          "PeekFields ADRACKReq bit disagrees");
+    NS_TEST_EXPECT_MSG_EQ(view.ack, frameHdr.GetAck(), "PeekFields ACK bit disagrees");
+    NS_TEST_EXPECT_MSG_EQ(view.fOptsLen, 0, "PeekFields FOptsLen disagrees");
+    NS_TEST_EXPECT_MSG_EQ(view.fCnt, frameHdr.GetFCnt(), "PeekFields FCnt disagrees");
+    NS_TEST_EXPECT_MSG_EQ(view.fPort, frameHdr.GetFPort(), "PeekFields FPort disagrees");
+
+    //////////////////////////////////////////////////////////////////////
+    // Header with FOpts: PeekFields must skip the MAC commands and     //
+    // still agree with Deserialize on every fixed field                //
+    //////////////////////////////////////////////////////////////////////
+    LoraFrameHeader cmdHdr;
+    cmdHdr.SetAsDownlink();
+    cmdHdr.SetAddress(LoraDeviceAddress(0x7F, 0x123456));
+    cmdHdr.SetAck(true);
+    cmdHdr.SetFCnt(7);
+    cmdHdr.SetFPort(1);
+    cmdHdr.AddLinkCheckAns(20, 3); // 3 bytes of FOpts
+
+    Buffer cmdBuf;
+    cmdBuf.AddAtStart(cmdHdr.GetSerializedSize());
+    cmdHdr.Serialize(cmdBuf.Begin());
+
+    LoraFrameHeader cmdRoundTrip;
+    cmdRoundTrip.SetAsDownlink();
+    cmdRoundTrip.Deserialize(cmdBuf.Begin());
+    LoraFrameHeader::FieldView cmdView = LoraFrameHeader::PeekFields(cmdBuf.Begin());
+    NS_TEST_EXPECT_MSG_EQ((cmdView.address == cmdRoundTrip.GetAddress()),
+                          true,
+                          "PeekFields address disagrees with Deserialize with FOpts present");
+    NS_TEST_EXPECT_MSG_EQ(cmdView.ack,
+                          cmdRoundTrip.GetAck(),
+                          "PeekFields ACK bit disagrees with FOpts present");
+    NS_TEST_EXPECT_MSG_EQ(cmdView.fOptsLen, 3, "PeekFields FOptsLen disagrees with FOpts present");
+    NS_TEST_EXPECT_MSG_EQ(cmdView.fCnt,
+                          cmdRoundTrip.GetFCnt(),
+                          "PeekFields FCnt disagrees with FOpts present");
+    NS_TEST_EXPECT_MSG_EQ(cmdView.fPort,
+                          cmdRoundTrip.GetFPort(),
+                          "PeekFields FPort disagrees with FOpts present");
+
+    //////////////////////////////////////////////////////////////////////
+    // Packet-level PeekFields must skip the MHDR byte and agree with   //
+    // header removal, with and without FOpts                           //
+    //////////////////////////////////////////////////////////////////////
+    LorawanMacHeader macHdr;
+    macHdr.SetMType(LorawanMacHeader::UNCONFIRMED_DATA_UP);
+    macHdr.SetMajor(0);
+
+    Ptr<Packet> pkt = Create<Packet>(10);
+    pkt->AddHeader(frameHdr);
+    pkt->AddHeader(macHdr);
+    LoraFrameHeader::FieldView pktView = LoraFrameHeader::PeekFields(pkt);
+    NS_TEST_EXPECT_MSG_EQ((pktView.address == frameHdr.GetAddress()),
+                          true,
+                          "Packet-level PeekFields address disagrees");
+    NS_TEST_EXPECT_MSG_EQ(pktView.fCnt, frameHdr.GetFCnt(), "Packet-level PeekFields FCnt disagrees");
+    NS_TEST_EXPECT_MSG_EQ(pktView.fPort,
+                          frameHdr.GetFPort(),
+                          "Packet-level PeekFields FPort disagrees");
+
+    Ptr<Packet> cmdPkt = Create<Packet>(10);
+    cmdPkt->AddHeader(cmdHdr);
+    cmdPkt->AddHeader(macHdr);
+    LoraFrameHeader::FieldView cmdPktView = LoraFrameHeader::PeekFields(cmdPkt);
+    NS_TEST_EXPECT_MSG_EQ((cmdPktView.address == cmdHdr.GetAddress()),
+                          true,
+                          "Packet-level PeekFields address disagrees with FOpts present");
+    NS_TEST_EXPECT_MSG_EQ(cmdPktView.fOptsLen,
+                          3,
+                          "Packet-level PeekFields FOptsLen disagrees with FOpts present");
+    NS_TEST_EXPECT_MSG_EQ(cmdPktView.fCnt,
+                          cmdHdr.GetFCnt(),
+                          "Packet-level PeekFields FCnt disagrees with FOpts present");
+    NS_TEST_EXPECT_MSG_EQ(cmdPktView.fPort,
+                          cmdHdr.GetFPort(),
+                          "Packet-level PeekFields FPort disagrees with FOpts present");
+}
+
+/**
+ * @ingroup lorawan
+ *
+ * It tests the whole-row GF(256) kernels of FecComponent (split-nibble tables,
+ * SIMD body and scalar tail) against the single-byte GfMultiply reference
+ */
+class FecGfKernelTest : public TestCase
+{
+  public:
+    FecGfKernelTest();           //!< Default constructor
+    ~FecGfKernelTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+FecGfKernelTest::FecGfKernelTest()
+    : TestCase("Verify the GF(256) row kernels against the byte-wise reference")
+{
+}
+
+FecGfKernelTest::~FecGfKernelTest()
+{
+}
+
+void
+FecGfKernelTest::DoRun()
+{
+    NS_LOG_DEBUG("FecGfKernelTest");
+
+    Ptr<FecComponent> fec = CreateObject<FecComponent>();
+
+    // Small deterministic generator so failures are reproducible
+    uint32_t state = 0x12345678;
+    auto nextByte = [&state]() {
+        state = state * 1664525 + 1013904223;
+        return static_cast<uint8_t>(state >> 24);
+    };
+
+    // Lengths straddling the 16-byte SIMD block size, so both the vector body
+    // and the scalar tail are exercised, plus pure-tail and pure-body cases
+    std::vector<size_t> lengths = {1, 5, 15, 16, 17, 31, 32, 45, 64, 100};
+    // Factors covering the early-return paths (0 and 1), a fixed value and
+    // randomized ones
+    std::vector<uint8_t> coeffs = {0, 1, 2, 0x53, nextByte(), nextByte()};
+
+    for (size_t len : lengths)
+    {
+        for (uint8_t coeff : coeffs)
+        {
+            std::vector<uint8_t> src(len);
+            std::vector<uint8_t> dst(len);
+            for (size_t i = 0; i < len; i++)
+            {
+                src[i] = nextByte();
+                dst[i] = nextByte();
+            }
+
+            // dst ^= coeff * src, expected via the reference multiply
+            std::vector<uint8_t> expectedAdd(len);
+            for (size_t i = 0; i < len; i++)
+            {
+                expectedAdd[i] = dst[i] ^ fec->GfMultiply(coeff, src[i]);
+            }
+            std::vector<uint8_t> actualAdd = dst;
+            fec->GfMulAddRow(actualAdd.data(), src.data(), len, coeff);
+            NS_TEST_EXPECT_MSG_EQ((actualAdd == expectedAdd),
+                                  true,
+                                  "GfMulAddRow disagrees with the GfMultiply reference (len="
+                                      << len << ", coeff=" << +coeff << ")");
+
+            // row *= coeff, expected via the reference multiply
+            std::vector<uint8_t> expectedMul(len);
+            for (size_t i = 0; i < len; i++)
+            {
+                expectedMul[i] = fec->GfMultiply(coeff, src[i]);
+            }
+            std::vector<uint8_t> actualMul = src;
+            fec->GfMulRow(actualMul.data(), len, coeff);
+            NS_TEST_EXPECT_MSG_EQ((actualMul == expectedMul),
+                                  true,
+                                  "GfMulRow disagrees with the GfMultiply reference (len="
+                                      << len << ", coeff=" << +coeff << ")");
+        }
+    }
+}
+
+/**
+ * @ingroup lorawan
+ *
+ * It tests the alias-table sampling in
+ * LorawanMacHelper::SetSpreadingFactorsGivenDistribution: empirical data rate
+ * frequencies must follow the requested distribution, including degenerate ones
+ */
+class SpreadingFactorDistributionTest : public TestCase
+{
+  public:
+    SpreadingFactorDistributionTest();           //!< Default constructor
+    ~SpreadingFactorDistributionTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+SpreadingFactorDistributionTest::SpreadingFactorDistributionTest()
+    : TestCase("Verify that data rates are assigned following the given distribution")
+{
+}
+
+SpreadingFactorDistributionTest::~SpreadingFactorDistributionTest()
+{
+}
+
+void
+SpreadingFactorDistributionTest::DoRun()
+{
+    NS_LOG_DEBUG("SpreadingFactorDistributionTest");
+
+    Ptr<LoraChannel> channel = CreateChannel();
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    int nDevices = 2400;
+    NodeContainer endDevices = CreateEndDevices(nDevices, mobility, channel);
+    NodeContainer gateways; // Unused by the distribution-based assignment
+
+    // With 2400 devices, the standard deviation of an empirical frequency is
+    // at most sqrt(0.25 / 2400) ~ 0.0102, so 0.04 is a 4-sigma tolerance
+    double tolerance = 0.04;
+
+    // Skewed distribution: every bucket frequency must match its probability
+    std::vector<double> skewed = {0.5, 0.25, 0.12, 0.08, 0.04, 0.01};
+    std::vector<int> counts =
+        LorawanMacHelper::SetSpreadingFactorsGivenDistribution(endDevices, gateways, skewed);
+    int total = 0;
+    for (int k = 0; k < 6; k++)
+    {
+        total += counts[k];
+    }
+    NS_TEST_EXPECT_MSG_EQ(total, nDevices, "Devices lost or duplicated during assignment");
+    for (int k = 0; k < 6; k++)
+    {
+        NS_TEST_EXPECT_MSG_EQ_TOL(counts[k] / double(nDevices),
+                                  skewed[k],
+                                  tolerance,
+                                  "Empirical frequency of bucket " << k
+                                                                   << " far from its probability");
+    }
+
+    // Single non-zero bucket: the assignment must be deterministic
+    std::vector<double> degenerate = {0, 0, 1, 0, 0, 0};
+    counts = LorawanMacHelper::SetSpreadingFactorsGivenDistribution(endDevices, gateways, degenerate);
+    for (int k = 0; k < 6; k++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(counts[k],
+                              (k == 2 ? nDevices : 0),
+                              "Single non-zero bucket " << k << " not assigned deterministically");
+    }
+    Ptr<EndDeviceLorawanMac> mac = GetMacLayerFromNode<EndDeviceLorawanMac>(endDevices.Get(0));
+    NS_TEST_EXPECT_MSG_EQ(unsigned(mac->GetDataRate()),
+                          3,
+                          "Bucket 2 expected to map to data rate 3");
+
+    // All-equal, unnormalized weights: uniform frequencies after normalization
+    std::vector<double> equal = {2, 2, 2, 2, 2, 2};
+    counts = LorawanMacHelper::SetSpreadingFactorsGivenDistribution(endDevices, gateways, equal);
+    for (int k = 0; k < 6; k++)
+    {
+        NS_TEST_EXPECT_MSG_EQ_TOL(counts[k] / double(nDevices),
+                                  1.0 / 6,
+                                  tolerance,
+                                  "Equal-weight bucket " << k << " frequency not uniform");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup lorawan
+ *
+ * It tests HexGridPositionAllocator's closed-form GetPosition against an
+ * independent spiral walk of the grid, with explicit checks at ring boundaries
+ * where the ring inversion is most fragile
+ */
+class HexGridPositionTest : public TestCase
+{
+  public:
+    HexGridPositionTest();           //!< Default constructor
+    ~HexGridPositionTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+HexGridPositionTest::HexGridPositionTest()
+    : TestCase("Verify the closed-form hex grid positions against a spiral walk")
+{
+}
+
+HexGridPositionTest::~HexGridPositionTest()
+{
+}
+
+void
+HexGridPositionTest::DoRun()
+{
+    NS_LOG_DEBUG("HexGridPositionTest");
+
+    const double radius = 1000;
+    const double pi = std::acos(-1);
+    Ptr<HexGridPositionAllocator> allocator = CreateObject<HexGridPositionAllocator>(radius);
+
+    // The same corner directions the allocator uses, recomputed here so the
+    // reference does not depend on the code under test
+    auto direction = [radius, pi](uint32_t k) {
+        double angle = (k % 6) * pi / 3;
+        return Vector(-2 * radius * std::sin(angle), 2 * radius * std::cos(angle), 0.0);
+    };
+    auto combine = [](double a, Vector u, double b, Vector v) {
+        return Vector(a * u.x + b * v.x, a * u.y + b * v.y, 0.0);
+    };
+    const double tolerance = 1e-6;
+
+    // Independent spiral walk: origin first, then each ring r covered one
+    // side at a time with r unit steps per side. The first few thousand
+    // indices include every boundary between consecutive rings up to r = 31
+    const uint32_t nIndices = 3000;
+    std::vector<Vector> reference;
+    reference.emplace_back(0.0, 0.0, 0.0);
+    for (uint32_t r = 1; reference.size() < nIndices; r++)
+    {
+        Vector pos = combine(r, direction(0), 0.0, direction(0));
+        for (uint32_t side = 0; side < 6; side++)
+        {
+            Vector u = combine(1.0, direction(side + 1), -1.0, direction(side));
+            for (uint32_t step = 0; step < r && reference.size() < nIndices; step++)
+            {
+                reference.push_back(pos);
+                pos = combine(1.0, pos, 1.0, u);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < nIndices; i++)
+    {
+        NS_TEST_EXPECT_MSG_LT(CalculateDistance(allocator->GetPosition(i), reference[i]),
+                              tolerance,
+                              "Closed-form position disagrees with the spiral walk at index "
+                                  << i);
+    }
+
+    // GetNext must hand out the same sequence
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        NS_TEST_EXPECT_MSG_LT(CalculateDistance(allocator->GetNext(), reference[i]),
+                              tolerance,
+                              "GetNext disagrees with GetPosition at index " << i);
+    }
+
+    // Large rings, where sqrt rounding in the ring inversion could land the
+    // boundary indices f(r) = 3r(r-1)+1 and their neighbors in the wrong ring
+    for (uint32_t r : {1000u, 1234u})
+    {
+        uint32_t first = 3 * r * (r - 1) + 1;
+        // Last cell of ring r-1 is one step short of closing that ring:
+        // (r-2) * D(0) + D(5)
+        NS_TEST_EXPECT_MSG_LT(CalculateDistance(allocator->GetPosition(first - 1),
+                                                combine(r - 2, direction(0), 1.0, direction(5))),
+                              tolerance,
+                              "Last cell of ring " << r - 1 << " misplaced");
+        // Ring r opens at its top corner r * D(0) and then steps toward D(1)
+        NS_TEST_EXPECT_MSG_LT(CalculateDistance(allocator->GetPosition(first),
+                                                combine(r, direction(0), 0.0, direction(0))),
+                              tolerance,
+                              "First cell of ring " << r << " misplaced");
+        NS_TEST_EXPECT_MSG_LT(CalculateDistance(allocator->GetPosition(first + 1),
+                                                combine(r - 1, direction(0), 1.0, direction(1))),
+                              tolerance,
+                              "Second cell of ring " << r << " misplaced");
+    }
+}
+
+/**
+ * @ingroup lorawan
+ *
+ * It tests the fixed-bin QuantileSketch of StatisticsCollectorComponent:
+ * quantile estimates on known distributions, clamping of out-of-range values,
+ * the empty sentinel and the merge operation
+ */
+class QuantileSketchTest : public TestCase
+{
+  public:
+    QuantileSketchTest();           //!< Default constructor
+    ~QuantileSketchTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+};
+
+QuantileSketchTest::QuantileSketchTest()
+    : TestCase("Verify quantile estimates, clamping and merging of QuantileSketch")
+{
+}
+
+QuantileSketchTest::~QuantileSketchTest()
+{
+}
+
+void
+QuantileSketchTest::DoRun()
+{
+    NS_LOG_DEBUG("QuantileSketchTest");
+
+    using Sketch = StatisticsCollectorComponent::QuantileSketch;
+
+    // One value per bin center over [0, 64] (bin width 1), so the exact
+    // quantile is known and the estimate must land within one bin width
+    Sketch uniform(0.0, 64.0);
+    for (uint32_t i = 0; i < Sketch::BIN_COUNT; i++)
+    {
+        uniform.Push(i + 0.5);
+    }
+    for (double q : {0.0, 0.1, 0.25, 0.5, 0.75, 0.9, 1.0})
+    {
+        NS_TEST_EXPECT_MSG_EQ_TOL(uniform.Quantile(q),
+                                  64.0 * q,
+                                  1.0,
+                                  "Uniform quantile " << q << " off by more than one bin width");
+    }
+
+    // Out-of-range pushes must clamp into the first and last bins
+    Sketch clamped(0.0, 64.0);
+    clamped.Push(-100.0);
+    clamped.Push(1000.0);
+    NS_TEST_EXPECT_MSG_EQ(clamped.count, 2, "Clamped pushes not counted");
+    NS_TEST_EXPECT_MSG_EQ(clamped.bins[0], 1, "Low outlier not clamped into the first bin");
+    NS_TEST_EXPECT_MSG_EQ(clamped.bins[Sketch::BIN_COUNT - 1],
+                          1,
+                          "High outlier not clamped into the last bin");
+
+    // The empty sketch must return the sentinel, not a range endpoint
+    Sketch empty(0.0, 64.0);
+    NS_TEST_EXPECT_MSG_EQ(empty.Quantile(0.5), -999.0, "Empty sketch did not return the sentinel");
+
+    // Merging two sketches must equal the sketch of the concatenated stream
+    Sketch first(-30.0, 25.0);
+    Sketch second(-30.0, 25.0);
+    Sketch concatenated(-30.0, 25.0);
+    uint32_t state = 0xCAFEBABE;
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        state = state * 1664525 + 1013904223;
+        // Spread over [-40, 40] so some values exercise clamping too
+        double value = -40.0 + (state >> 8) % 8000 / 100.0;
+        (i % 2 ? first : second).Push(value);
+        concatenated.Push(value);
+    }
+    first.Merge(second);
+    NS_TEST_EXPECT_MSG_EQ(first.count, concatenated.count, "Merged count differs");
+    NS_TEST_EXPECT_MSG_EQ((first.bins == concatenated.bins),
+                          true,
+                          "Merged bins differ from the concatenated stream's");
+    for (double q : {0.05, 0.5, 0.95})
+    {
+        NS_TEST_EXPECT_MSG_EQ(first.Quantile(q),
+                              concatenated.Quantile(q),
+                              "Merged quantile " << q << " differs from the concatenated stream's");
+    }
+}
+
 /**
  * @ingroup lorawan
  *
@@ -2037,6 +2602,142 @@ MacCommandTest::DoRun()
     }
 }
 
+/**
+ * @ingroup lorawan
+ *
+ * Scalability regression test: builds a parametrized topology, simulates a
+ * fixed hour of traffic and asserts wall-clock and peak-RSS budgets.
+ *
+ * The budgets are deliberately generous — they are not throughput targets
+ * but tripwires, sized so that an accidental O(n²) scan in a per-packet
+ * structure (EndDeviceStatus, LoraPacketTracker, the channel) blows through
+ * them at 10k devices while ordinary machine-to-machine variance does not.
+ */
+class ScalabilityTest : public TestCase
+{
+  public:
+    /**
+     * Construct a scalability test for a given population.
+     *
+     * @param nDevices The number of end devices to simulate.
+     * @param wallTimeBudget The maximum allowed wall-clock run time.
+     * @param peakRssBudgetMb The maximum allowed process peak RSS, in MiB.
+     */
+    ScalabilityTest(uint32_t nDevices, Time wallTimeBudget, uint64_t peakRssBudgetMb);
+    ~ScalabilityTest() override; //!< Destructor
+
+  private:
+    void DoRun() override;
+
+    uint32_t m_nDevices;       //!< Number of end devices to simulate.
+    Time m_wallTimeBudget;     //!< Wall-clock budget for the simulated hour.
+    uint64_t m_peakRssBudgetMb; //!< Peak resident set budget, in MiB.
+};
+
+ScalabilityTest::ScalabilityTest(uint32_t nDevices, Time wallTimeBudget, uint64_t peakRssBudgetMb)
+    : TestCase("Scalability budgets at " + std::to_string(nDevices) + " devices"),
+      m_nDevices(nDevices),
+      m_wallTimeBudget(wallTimeBudget),
+      m_peakRssBudgetMb(peakRssBudgetMb)
+{
+}
+
+ScalabilityTest::~ScalabilityTest()
+{
+}
+
+void
+ScalabilityTest::DoRun()
+{
+    NS_LOG_DEBUG("ScalabilityTest");
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    // One gateway at the center of a device disc, with a network server
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(3.76);
+    loss->SetReference(1, 7.7);
+    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+
+    LoraPhyHelper phyHelper = LoraPhyHelper();
+    phyHelper.SetChannel(channel);
+    LorawanMacHelper macHelper = LorawanMacHelper();
+    LoraHelper helper = LoraHelper();
+    helper.EnablePacketTracking();
+
+    NodeContainer gateways;
+    gateways.Create(1);
+    MobilityHelper mobilityGw;
+    mobilityGw.SetPositionAllocator("ns3::GridPositionAllocator");
+    mobilityGw.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobilityGw.Install(gateways);
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    helper.Install(phyHelper, macHelper, gateways);
+
+    NodeContainer endDevices;
+    endDevices.Create(m_nDevices);
+    MobilityHelper mobilityEd;
+    mobilityEd.SetPositionAllocator("ns3::UniformDiscPositionAllocator",
+                                    "rho",
+                                    DoubleValue(5000));
+    mobilityEd.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobilityEd.Install(endDevices);
+
+    Ptr<LoraDeviceAddressGenerator> addrGen = CreateObject<LoraDeviceAddressGenerator>(54, 1864);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    macHelper.SetAddressGenerator(addrGen);
+    macHelper.SetRegion(LorawanMacHelper::EU);
+    helper.Install(phyHelper, macHelper, endDevices);
+    LorawanMacHelper::SetSpreadingFactorsUp(endDevices, gateways, channel);
+
+    PeriodicSenderHelper appHelper = PeriodicSenderHelper();
+    appHelper.SetPeriod(Seconds(600));
+    appHelper.Install(endDevices);
+
+    Ptr<Node> networkServer = CreateObject<Node>();
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+    P2PGwRegistration_t gwRegistration;
+    for (auto gw = gateways.Begin(); gw != gateways.End(); ++gw)
+    {
+        auto container = p2p.Install(networkServer, *gw);
+        auto serverP2PNetDev = DynamicCast<PointToPointNetDevice>(container.Get(0));
+        gwRegistration.emplace_back(serverP2PNetDev, *gw);
+    }
+    NetworkServerHelper networkServerHelper;
+    networkServerHelper.SetGatewaysP2P(gwRegistration);
+    networkServerHelper.SetEndDevices(endDevices);
+    networkServerHelper.Install(networkServer);
+    ForwarderHelper forwarderHelper;
+    forwarderHelper.Install(gateways);
+
+    // One simulated hour of periodic traffic
+    Simulator::Stop(Hours(1));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    double wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    uint64_t peakRssMb = uint64_t(usage.ru_maxrss) / 1024; // ru_maxrss is in KiB on Linux
+
+    NS_LOG_INFO("Simulated one hour at " << m_nDevices << " devices in " << wallSeconds
+                                         << " s, peak RSS " << peakRssMb << " MiB");
+
+    NS_TEST_EXPECT_MSG_LT(wallSeconds,
+                          m_wallTimeBudget.GetSeconds(),
+                          "Wall-clock budget exceeded at " << m_nDevices << " devices");
+    NS_TEST_EXPECT_MSG_LT(peakRssMb,
+                          m_peakRssBudgetMb,
+                          "Peak RSS budget exceeded at " << m_nDevices << " devices");
+}
+
 /**
  * @ingroup lorawan
  *
@@ -2068,6 +2769,11 @@ LorawanTestSuite::LorawanTestSuite()
     AddTestCase(new InterferenceTest, Duration::QUICK);
     AddTestCase(new AddressTest, Duration::QUICK);
     AddTestCase(new HeaderTest, Duration::QUICK);
+    AddTestCase(new FrameHeaderWireFormatTest, Duration::QUICK);
+    AddTestCase(new FecGfKernelTest, Duration::QUICK);
+    AddTestCase(new SpreadingFactorDistributionTest, Duration::QUICK);
+    AddTestCase(new HexGridPositionTest, Duration::QUICK);
+    AddTestCase(new QuantileSketchTest, Duration::QUICK);
     AddTestCase(new ReceivePathTest, Duration::QUICK);
     AddTestCase(new LogicalLoraChannelTest, Duration::QUICK);
     AddTestCase(new TimeOnAirTest, Duration::QUICK);
@@ -2077,3 +2783,26 @@ LorawanTestSuite::LorawanTestSuite()
 
 // Do not forget to allocate an instance of this TestSuite
 static LorawanTestSuite lorawanTestSuite;
+
+/**
+ * @ingroup lorawan
+ *
+ * Performance suite holding the scalability regression tests, separate from
+ * the unit suite so quick test runs are unaffected.
+ */
+class LorawanPerformanceTestSuite : public TestSuite
+{
+  public:
+    LorawanPerformanceTestSuite(); //!< Default constructor
+};
+
+LorawanPerformanceTestSuite::LorawanPerformanceTestSuite()
+    : TestSuite("lorawan-performance", Type::PERFORMANCE)
+{
+    // Budgets are tripwires with generous margins, not throughput targets
+    AddTestCase(new ScalabilityTest(1000, Minutes(2), 2048), Duration::EXTENSIVE);
+    AddTestCase(new ScalabilityTest(10000, Minutes(15), 4096), Duration::TAKES_FOREVER);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static LorawanPerformanceTestSuite lorawanPerformanceTestSuite;